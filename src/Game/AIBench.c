@@ -0,0 +1,309 @@
+// =============================================================================
+//  AIBench.c
+//  - headless computer player benchmark, runs a skirmish of computer
+//    players on the biggest map and times their updates
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "AIBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "AIPlayer.h"
+#include "AISchedule.h"
+#include "AIThreat.h"
+#include "File.h"
+#include "Globals.h"
+#include "main.h"
+#include "mainswitches.h"
+#include "MultiplayerGame.h"
+#include "ScenPick.h"
+#include "SinglePlayer.h"
+#include "StringSupport.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "UnivUpdate.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool aiBenchEnabled = FALSE;
+char aiBenchMapName[AIBENCH_MAPNAME_LEN] = "";      // empty picks the map with the most players
+static udword aiBenchFrames = AIBENCH_DEFAULT_FRAMES;
+static udword aiBenchQuota = AISCH_WorkQuota;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchSet
+    Description : Command-line handler for /aiBench <nFrames>
+    Inputs      : string - number of universe updates to run
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool aiBenchSet(char *string)
+{
+    sscanf(string, "%u", &aiBenchFrames);
+    if (aiBenchFrames == 0)
+    {
+        aiBenchFrames = AIBENCH_DEFAULT_FRAMES;
+    }
+    aiBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchMapSet
+    Description : Command-line handler for /aiBenchMap <map>
+    Inputs      : string - file name of the scenario to play on
+    Outputs     :
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool aiBenchMapSet(char *string)
+{
+    memStrncpy(aiBenchMapName, string, AIBENCH_MAPNAME_LEN - 1);
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchQuotaSet
+    Description : Command-line handler for /aiBenchQuota <n>.  Only the
+                  benchmark uses it; skirmish and network games always run
+                  with AISCH_WorkQuota.
+    Inputs      : string - work units a frame, 0 for no limit
+    Outputs     :
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool aiBenchQuotaSet(char *string)
+{
+    sscanf(string, "%u", &aiBenchQuota);
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchScenarioSelect
+    Description : Picks the scenario named on the command line, or else the
+                  first one that takes the most players.
+    Inputs      :
+    Outputs     : sets spCurrentSelected
+    Return      : FALSE if no usable scenario is available
+----------------------------------------------------------------------------*/
+static bool aiBenchScenarioSelect(void)
+{
+    sdword index, best = -1;
+
+    for (index = 0; index < spScenarioListLength; index++)
+    {
+        if (aiBenchMapName[0] != 0)
+        {
+            if (!strcasecmp(spScenarios[index].fileSpec, aiBenchMapName))
+            {
+                best = index;
+                break;
+            }
+        }
+        else if ((best < 0) || (spScenarios[index].maxplayers > spScenarios[best].maxplayers))
+        {
+            best = index;
+        }
+    }
+
+    if ((best < 0) || (spScenarios[best].maxplayers < AIBENCH_NUM_COMPUTERS + 1))
+    {
+        return FALSE;
+    }
+    spCurrentSelected = best;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchGameStart
+    Description : Starts a skirmish with one idle human player and
+                  AIBENCH_NUM_COMPUTERS computer players, following the
+                  skirmish path of utyNewGameStart.
+    Inputs      :
+    Outputs     :
+    Return      : FALSE if the game could not be set up
+----------------------------------------------------------------------------*/
+static bool aiBenchGameStart(void)
+{
+    udword i;
+
+    if (!aiBenchScenarioSelect())
+    {
+        printf("AIBench: no %d player map%s%s\n", AIBENCH_NUM_COMPUTERS + 1,
+               aiBenchMapName[0] ? " called " : "", aiBenchMapName);
+        return FALSE;
+    }
+
+    multiPlayerGame = FALSE;
+    singlePlayerGame = FALSE;
+    determCompPlayer = TRUE;                                //same game every run, so checksums can be compared
+
+    tpGameCreated.numPlayers = 1;
+    tpGameCreated.numComputers = AIBENCH_NUM_COMPUTERS;
+    numPlayers = 1 + AIBENCH_NUM_COMPUTERS;
+    curPlayer = 0;
+    for (i = 0; i < numPlayers; i++)
+    {
+        ComputerPlayerEnabled[i] = (i != 0);
+        if (ComputerPlayerEnabled[i])
+        {
+            sprintf(playerNames[i], "%s %i", strGetString(strComputerName), i);
+        }
+        else
+        {
+            strcpy(playerNames[i], utyName);
+        }
+    }
+
+    singlePlayerInit();
+    gameStart(NULL);
+
+    return gameIsRunning;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchReport
+    Description : Prints the benchmark results to stdout.
+    Inputs      : frames - universe updates run
+                  updateTime - time spent in univUpdate
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void aiBenchReport(udword frames, sqword updateTime)
+{
+    real64 aiMs = (real64)aiplayerUpdateTime / 1000.0;
+    udword i, nTicks = 0;
+    Player *player;
+    aischownerstats *stats;
+
+    for (i = 0; i < universe.numPlayers; i++)
+    {
+        if (universe.players[i].aiPlayer != NULL)
+        {
+            nTicks += universe.players[i].aiPlayer->aiplayerFrameCount;
+        }
+    }
+
+    printf("AIBench: %s, %d computer players\n", spScenarios[spCurrentSelected].fileSpec, AIBENCH_NUM_COMPUTERS);
+    printf("  %u frames in %.3f s, %d ships at the end\n", frames, (real64)updateTime / 1000000.0, universe.ShipList.num);
+    printf("  computer players %.3f ms, %.4f ms/frame, %.4f ms per player update (%u updates)\n",
+           aiMs, frames ? aiMs / frames : 0.0, nTicks ? aiMs / nTicks : 0.0, nTicks);
+    printf("  threat grid %s: %u builds, %.4f ms/build, %.1f%% of computer player time, %u near-queries, %u (%.1f%%) answered without a scan, %u fire power and value lookups\n",
+           aithEnabled ? "on" : "off (/noAIGrid)",
+           aithStats.nBuilds, aithStats.nBuilds ? (real64)aithStats.buildTime / 1000.0 / aithStats.nBuilds : 0.0,
+           aiplayerUpdateTime ? 100.0 * aithStats.buildTime / aiplayerUpdateTime : 0.0,
+           aithStats.nQueries, aithStats.nEarlyOuts,
+           aithStats.nQueries ? 100.0 * aithStats.nEarlyOuts / aithStats.nQueries : 0.0, aithStats.nLayerQueries);
+    printf("  run again with%s /noAIGrid and compare the ms per player update for the grid's effect on AI update cost\n",
+           aithEnabled ? "" : "out");
+
+    printf("  work quota %u units/frame%s: %u frames with work, %u left some for the next frame, %.1f mean / %u max units a frame\n",
+           aischQuotaGet(), aischQuotaGet() ? "" : " (no limit)", aischStats.nFrames, aischStats.nFramesDeferred,
+           aischStats.nFrames ? (real64)aischStats.workTotal / aischStats.nFrames : 0.0, aischStats.workMax);
+    for (i = 0; i < universe.numPlayers; i++)
+    {
+        stats = &aischStats.owner[i];
+        if (stats->nPasses == 0)
+        {
+            continue;
+        }
+        printf("  player %u: %u updates, %.1f mean / %u max units, up to %u frames and %u late, %.4f ms mean / %.4f ms max a frame\n",
+               i, stats->nPasses, (real64)stats->workTotal / stats->nPasses, stats->workMax, stats->slicesMax, stats->lateMax,
+               (real64)stats->timeTotal / 1000.0 / stats->nSlices, (real64)stats->timeMax / 1000.0);
+    }
+
+    //what each player's mothership is up against, as a sanity check of the grid
+    for (i = 0; i < universe.numPlayers; i++)
+    {
+        player = &universe.players[i];
+        if (player->PlayerMothership == NULL)
+        {
+            continue;
+        }
+        printf("  player %u mothership: enemy fire power %u value %u, friendly fire power %u\n", i,
+               aithEnemyFirePower(player, &player->PlayerMothership->posinfo.position, 0.0f),
+               aithEnemyValue(player, &player->PlayerMothership->posinfo.position, 0.0f),
+               aithFriendlyFirePower(player, &player->PlayerMothership->posinfo.position, 0.0f));
+    }
+
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aiBenchRun
+    Description : Runs the skirmish through univUpdate in a tight loop with
+                  no rendering, sound or frame pacing.  Called from main
+                  instead of the event loop when /aiBench is given.
+    Inputs      :
+    Outputs     : writes per-frame checksums to AIBENCH_CHECKSUMFILE
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword aiBenchRun(void)
+{
+    FILE *checksumFile = NULL;
+    char *fileNameFull;
+    sqword timeStart, timeStop, updateTime = 0;
+    udword frames;
+    sdword numShips;
+    union
+    {
+        real32 f;
+        udword u;
+    } checksum;
+
+    aischQuota = aiBenchQuota;
+    if (!aiBenchGameStart())
+    {
+        return -1;
+    }
+
+    fileNameFull = filePathPrepend(AIBENCH_CHECKSUMFILE, FF_UserSettingsPath);
+    if (fileMakeDestinationDirectory(fileNameFull))
+    {
+        checksumFile = fopen(fileNameFull, "wt");
+    }
+
+    aiplayerUpdateTime = 0;
+    memset(&aithStats, 0, sizeof(aithStats));
+    memset(&aischStats, 0, sizeof(aischStats));
+
+    for (frames = 0; frames < aiBenchFrames; )
+    {
+        GetRawTime(&timeStart);
+        univUpdate(UNIVERSE_UPDATE_PERIOD);
+        GetRawTime(&timeStop);
+        updateTime += timeStop - timeStart;
+        frames++;
+
+        //with /noAIGrid, and on any machine with the same quota, these
+        //should come out the same
+        if (checksumFile != NULL)
+        {
+            checksum.f = univGetChecksum(&numShips);
+            fprintf(checksumFile, "%u\t%08x\t%d\t%08x\n",
+                    universe.univUpdateCounter, checksum.u, numShips, univCalcShipChecksum());
+        }
+
+        if (!gameIsRunning)
+        {
+            break;
+        }
+    }
+
+    if (checksumFile != NULL)
+    {
+        fclose(checksumFile);
+    }
+
+    aiBenchReport(frames, updateTime);
+
+    return 0;
+}
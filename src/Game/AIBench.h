@@ -0,0 +1,40 @@
+// =============================================================================
+//  AIBench.h
+//  - headless computer player benchmark, runs a skirmish of computer
+//    players on the biggest map and times their updates
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___AIBENCH_H
+#define ___AIBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define AIBENCH_CHECKSUMFILE        "AIBenchChecksums.txt"
+#define AIBENCH_DEFAULT_FRAMES      9600        // 10 minutes of game time
+#define AIBENCH_NUM_COMPUTERS       7
+#define AIBENCH_MAPNAME_LEN         50
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool aiBenchEnabled;
+extern char aiBenchMapName[AIBENCH_MAPNAME_LEN];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool aiBenchSet(char *string);
+bool aiBenchMapSet(char *string);
+bool aiBenchQuotaSet(char *string);
+
+sdword aiBenchRun(void);
+
+#endif
@@ -13,6 +13,7 @@
 #include "AIFeatures.h"
 #include "Alliance.h"
 #include "AIResourceMan.h"
+#include "AISchedule.h"
 #include "CommandWrap.h"
 #include "MultiplayerGame.h"
 #include "Randy.h"
@@ -1214,103 +1215,151 @@ void aifFindAllies(void)
 /*=============================================================================
     Fleet Commands:
 =============================================================================*/
+
+//the parts of a fleet command update, in the order they run; the update
+//can stop after any of them and carry on from there next time
+typedef enum
+{
+    AIF_StageFleet,
+    AIF_StageAttack,
+    AIF_StageDefense,
+    AIF_StageResource,
+    AIF_StageTeams,
+    AIF_StageBuild
+} aifstage;
+
 /*-----------------------------------------------------------------------------
-    Name        : aifP2FleetCommand
-    Description : Logic for fleet command for the P2 pirates
+    Name        : aifFleetCommandStart
+    Description : First part of the fleet command update; takes stock of
+                  the enemy and hands new ships out.
     Inputs      :
     Outputs     :
-    Return      : void
+    Return      : the stage to carry on with
 ----------------------------------------------------------------------------*/
-void aifP2FleetCommand(void)
+static aifstage aifFleetCommandStart(void)
 {
     Player *player = aiCurrentAIPlayer->player;
+    bool hasFleetControl = (singlePlayerGame) ? singlePlayerGameInfo.giveComputerFleetControl : TRUE;
 
-    aiuCreateBlobArrays(player);
     aiuUpdateKnowledgeOfEnemyShips(aiCurrentAIPlayer);
     aidClearDistressSignal(aiCurrentAIPlayer);
 
     aifAssignNewShips();
 
-    aiaP2AttackManager();
-    aitExecute();
+    //temporary - fleet command for the P2 pirates
+    if (player->race == P2)
+    {
+        aiaP2AttackManager();
+        return AIF_StageTeams;
+    }
 
-    aifProcessShipBuildRequests();
+    if (aiCurrentAIPlayer->firstTurn)
+    {
+        if (hasFleetControl)
+        {
+            aiaProcessSpecialTeams();
+//        airProcessSpecialTeams();
+        }
+        aiCurrentAIPlayer->firstTurn = FALSE;
+        return AIF_StageTeams;
+    }
 
-    aiuDeleteBlobArrays();
-}
+    if (!hasFleetControl)
+    {
+        return AIF_StageTeams;
+    }
 
+    if (aiuResourceFeatureEnabled(AIF_HYPERSPACING))
+    {
+        aifSkimHyperspaceRUs();
+    }
 
+    aiCurrentAIPlayer->ResourceManRequestShips.num_ships = 0;
 
+    return AIF_StageAttack;
+}
 
 /*-----------------------------------------------------------------------------
     Name        : aifFleetCommand
-    Description : Logic for the top of the computer player command structure
-    Inputs      : aiplayer - the computer player structure
+    Description : Logic for the top of the computer player command structure.
+                  Runs the stages of the update in order until it's done or
+                  the frame's AI work quota runs out; the next call carries
+                  on from the stage it stopped at.
+    Inputs      :
     Outputs     : lotsa stuff
-    Return      : void
+    Return      : TRUE when the whole update has been done
 ----------------------------------------------------------------------------*/
-void aifFleetCommand(void)
+bool aifFleetCommand(void)
 {
     Player *player = aiCurrentAIPlayer->player;
-    bool hasFleetControl = (singlePlayerGame) ? singlePlayerGameInfo.giveComputerFleetControl : TRUE;
+    aischowner *sched = &aischOwners[player->playerIndex];
+    bool done = FALSE;
 
     aiIndex = aiCurrentAIPlayer->player->playerIndex;
 
-    //temporary
-    if (player->race == P2)
-    {
-        aifP2FleetCommand();
-        return;
-    }
-
-    if (aiCurrentAIPlayer->recalculateAllies)
+    if ((sched->stage == AIF_StageFleet) && (player->race != P2) && (aiCurrentAIPlayer->recalculateAllies))
     {
         aifFindAllies();
     }
 
+    //the blobs change every frame so these are made again whenever the
+    //update carries on
     aiuCreateBlobArrays(player);
-    aiuUpdateKnowledgeOfEnemyShips(aiCurrentAIPlayer);
-    aidClearDistressSignal(aiCurrentAIPlayer);
-
-    aifAssignNewShips();
 
-    if (aiCurrentAIPlayer->firstTurn)
+    while (!done && !aischOutOfWork())
     {
-        if (hasFleetControl)
+        switch (sched->stage)
         {
-            aiaProcessSpecialTeams();
-//        airProcessSpecialTeams();
-        }
-        aiCurrentAIPlayer->firstTurn = FALSE;
-    }
-    else
-    {
-        if (hasFleetControl)
-        {
-            if (aiuResourceFeatureEnabled(AIF_HYPERSPACING))
-            {
-                aifSkimHyperspaceRUs();
-            }
-
-            aiCurrentAIPlayer->ResourceManRequestShips.num_ships = 0;
-
-            //call AttackMan - any ships requested will result in call to aifAttackManRequestsShipsCB
-            aiaAttackManager();
-
-            //call DefenseMan - any ships requested will result in call to aifDefenseManRequestsShipsCB
-            aidDefenseManager();
-
-            //call Resource Manager - any ships requested will result in call to aifResourceManRequestsShipsCB
-            airResourceManager();
+            case AIF_StageFleet:
+                sched->stage = aifFleetCommandStart();
+                aischSpend(AISCH_FleetWork);
+                break;
+
+            case AIF_StageAttack:
+                //call AttackMan - any ships requested will result in call to aifAttackManRequestsShipsCB
+                aiaAttackManager();
+                sched->stage = AIF_StageDefense;
+                aischSpend(AISCH_ManagerWork);
+                break;
+
+            case AIF_StageDefense:
+                //call DefenseMan - any ships requested will result in call to aifDefenseManRequestsShipsCB
+                aidDefenseManager();
+                sched->stage = AIF_StageResource;
+                aischSpend(AISCH_ManagerWork);
+                break;
+
+            case AIF_StageResource:
+                //call Resource Manager - any ships requested will result in call to aifResourceManRequestsShipsCB
+                airResourceManager();
+                sched->stage = AIF_StageTeams;
+                aischSpend(AISCH_ManagerWork);
+                break;
+
+            case AIF_StageTeams:
+                // call Team Manager - any ships requested will result in call to aifAttackManRequestsShipsCB or aifDefenseManRequestsShipsCB
+                if (aitExecute())
+                {
+                    sched->stage = AIF_StageBuild;
+                }
+                break;
+
+            case AIF_StageBuild:
+            default:
+                aifProcessShipBuildRequests();
+                aischSpend(AISCH_BuildWork);
+                sched->stage = AIF_StageFleet;
+                done = TRUE;
+                break;
         }
     }
 
-    // call Team Manager - any ships requested will result in call to aifAttackManRequestsShipsCB or aifDefenseManRequestsShipsCB
-    aitExecute();
+    aiuDeleteBlobArrays();
 
-    aifProcessShipBuildRequests();
+    //counted last so it can't stop the update before it gets anywhere
+    aischSpend(AISCH_BlobWork);
 
-    aiuDeleteBlobArrays();
+    return done;
 }
 
 
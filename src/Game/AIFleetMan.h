@@ -11,7 +11,7 @@
 
 #include "AIPlayer.h"
 
-void aifFleetCommand(void);
+bool aifFleetCommand(void);
 
 void aifInit(AIPlayer *aiplayer);
 void aifClose(void);
@@ -12,13 +12,17 @@
 #include "AIDefenseMan.h"
 #include "AIFleetMan.h"
 #include "AIResourceMan.h"
+#include "AISchedule.h"
+#include "AIThreat.h"
 #include "File.h"
 #include "NIS.h"
 #include "Randy.h"
 #include "SaveGame.h"
 #include "SinglePlayer.h"
 #include "Stats.h"
+#include "TimeoutTimer.h"
 #include "Tweak.h"
+#include "UnivUpdate.h"
 
 
 #define AIPLAYER_LOG_FILE_NAME "aiplayerlog.txt"
@@ -26,6 +30,7 @@
 bool aiplayerLogEnable = FALSE;
 AIPlayer *aiCurrentAIPlayer;
 uword aiIndex;
+sqword aiplayerUpdateTime = 0;      // time spent in aiplayerUpdateAll, for /aiBench
 
 udword AIPLAYER_UPDATE_RATE[AI_NUM_LEVELS] = { 63, 31, 15 };
 real32 ATTMAN_BUILDPRIORITY_RATIO = 0.3f;
@@ -676,6 +681,8 @@ void aiplayerStartup(udword num_players, udword num_human_players, udword num_co
         logfileClear(AIPLAYER_LOG_FILE_NAME);
     }
     aivarStartup();
+    aithReset();
+    aischReset();
 
     if (!determCompPlayer)
         ranRandomize(RANDOM_AI_PLAYER);     // randomize the AIPlayer random number stream
@@ -803,8 +810,10 @@ void aiplayerClose(AIPlayer *aiplayer)
     memFree(aiplayer);
 }
 
-void aiplayerPlay(AIPlayer *aiplayer)
+bool aiplayerPlay(AIPlayer *aiplayer)
 {
+    bool done = TRUE;
+
 //    if (!singlePlayerGame)
         aiCurrentAIPlayer = aiplayer;
 
@@ -813,14 +822,19 @@ void aiplayerPlay(AIPlayer *aiplayer)
     if (!nisIsRunning)
     {
         statsSetOverkillfactor(AIPLAYER_OVERKILL_FACTOR);
-        aifFleetCommand();
-        aiplayer->aiplayerFrameCount++;
+        done = aifFleetCommand();
+        if (done)
+        {
+            aiplayer->aiplayerFrameCount++;
+        }
     }
 
     if (!singlePlayerGame)
         aiCurrentAIPlayer = NULL;
 
     universe.aiplayerProcessing = FALSE;
+
+    return done;
 }
 
 extern bool mrNoAI;
@@ -829,9 +843,12 @@ void aiplayerUpdateAll(void)
 {
     uword i;
     AIPlayer *aiplayer;
+    sqword timeStart, timeStop;
 
     if (gameIsRunning)
     {
+        GetRawTime(&timeStart);
+
         if (singlePlayerGame)
         {
             if (singlePlayerGameInfo.hyperspaceState != NO_HYPERSPACE)
@@ -845,9 +862,7 @@ void aiplayerUpdateAll(void)
                 dbgAssertOrIgnore(aiCurrentAIPlayer);
                 if ((universe.univUpdateCounter & aiCurrentAIPlayer->aiplayerUpdateRate) == (SP_KAS_UPDATE_FRAME & aiCurrentAIPlayer->aiplayerUpdateRate))
                 {
-                    universe.aiplayerProcessing = TRUE;
-                    kasExecute();
-                    universe.aiplayerProcessing = FALSE;
+                    aischDue(AISCH_Kas);
                 }
             }
         }
@@ -862,18 +877,26 @@ void aiplayerUpdateAll(void)
                         (aiplayer->player->playerState != PLAYER_DEAD) &&
                         (!mrNoAI))
                     {
-                        aiplayerPlay(aiplayer);
+                        aischDue(i);
                     }
                 }
             }
         }
 
+        //run what's due, up to this frame's work quota
+        aithFrameStart();
+        aischRun();
+        aithFrameEnd();
+
         if(tutorial==TUTORIAL_ONLY)
         {
             // In the tutorial, execute Kas script every other frame - we want REALTIME Kas.
             if( (universe.univUpdateCounter & TUTORIAL_KAS_UPDATE_MASK) == TUTORIAL_KAS_UPDATE_FRAME)
                 kasExecute();
         }
+
+        GetRawTime(&timeStop);
+        aiplayerUpdateTime += timeStop - timeStart;
     }
 }
 
@@ -952,8 +975,8 @@ void aiplayerPlayerDied(Player *player)
 //    udword DeadPlayerIndex = player->playerIndex, tempIndex,loop,
 //           DeadPlayersEnemy = universe.aiplayerEnemy[DeadPlayerIndex], i,j;
     sdword players[MAX_MULTIPLAYER_PLAYERS][MAX_MULTIPLAYER_PLAYERS];
-    Node *shipnode = universe.ShipList.head;
-    Ship *ship;
+    Ship **playerShips;
+    sdword numPlayerShips;
     udword DeadPlayerIndex = player->playerIndex, num_living_humans=0, num_humans=0, maxopponents=0, tempcnt=0, num_remaining_players=0;
     udword slot, newslot, i, j;
     bool done;
@@ -1207,17 +1230,11 @@ void aiplayerPlayerDied(Player *player)
     }
 
 shipdiedstuff:
-    //go through the entire shiplist and run the ship died
-    //function for every ship belonging to the dead player
-    while (shipnode != NULL)
+    //run the ship died function for every ship belonging to the dead player
+    numPlayerShips = univShipsOfPlayer(DeadPlayerIndex, &playerShips);
+    for (i = 0; i < (udword)numPlayerShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(shipnode);
-
-        if (ship->playerowner == player)
-        {
-            aiplayerShipDied(ship);
-        }
-        shipnode = shipnode->next;
+        aiplayerShipDied(playerShips[i]);
     }
 
     for (i=0;i<MAX_MULTIPLAYER_PLAYERS;i++)
@@ -1256,20 +1273,19 @@ static int ShipNotOnTeam(AIPlayer *aiplayer, Ship *ship)
 ----------------------------------------------------------------------------*/
 void BuildShipList(AIPlayer *aiplayer)
 {
-    Node *shipnode = universe.ShipList.head;
-    Ship *ship;
+    Ship *ship, **playerShips;
+    sdword i, numPlayerShips;
 
-    while (shipnode != NULL)
+    numPlayerShips = univShipsOfPlayer(aiplayer->player->playerIndex, &playerShips);
+    for (i = 0; i < numPlayerShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(shipnode);
+        ship = playerShips[i];
 
-        if (((ship->flags & SOF_NISShip) == 0) &&
-            (ship->playerowner == aiplayer->player) && ShipNotOnTeam(aiplayer, ship))
+        if (((ship->flags & SOF_NISShip) == 0) && ShipNotOnTeam(aiplayer, ship))
         {
             growSelectAddShip(&aiplayer->newships, ship);
             ThisAIPlayerShipCreatedCB(aiplayer,ship);
         }
-        shipnode = shipnode->next;
     }
 }
 
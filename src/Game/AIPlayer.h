@@ -201,6 +201,7 @@ extern bool aiplayerLogEnable;
 
 extern AIPlayer *aiCurrentAIPlayer;
 extern uword    aiIndex;
+extern sqword   aiplayerUpdateTime;
 
 /*=============================================================================
     Multiplayer Defines:
@@ -394,7 +395,7 @@ extern real32          AIU_FIGHTER_VULNERABLE_MODIFIER;
 
 AIPlayer *aiplayerInit(Player *player,AIPlayerLevel aiplayerLevel);
 void aiplayerClose(AIPlayer *aiplayer);
-void aiplayerPlay(AIPlayer *aiplayer);
+bool aiplayerPlay(AIPlayer *aiplayer);
 void aiplayerUpdateAll(void);
 void aiplayerGameStart(AIPlayer *aiplayer);
 
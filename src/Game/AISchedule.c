@@ -0,0 +1,313 @@
+// =============================================================================
+//  AISchedule.c
+//  - spreads computer player and KAS updates over frames, running a fixed
+//    number of work units each frame so heavy updates don't all land on
+//    the same one
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "AISchedule.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "AIPlayer.h"
+#include "AIThreat.h"
+#include "Debug.h"
+#include "Globals.h"
+#include "KAS.h"
+#include "mainswitches.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+udword aischQuota = AISCH_WorkQuota;
+aischstats aischStats;
+aischowner aischOwners[AISCH_NumberOwners];
+
+//updates that are due, in the order they fell due; each owner is in at
+//most once so it never overflows
+static sdword aischQueue[AISCH_NumberOwners];
+static sdword aischQueueHead = 0;
+static sdword aischQueueLength = 0;
+
+static bool aischRunning = FALSE;               // inside aischRun, so work is being counted
+static udword aischFrameQuota;                  // aischQuotaGet for this frame
+static udword aischFrameWork;                   // work done so far this frame
+static udword aischSliceWork;                   // work done so far by the owner being run
+
+extern bool mrNoAI;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : aischReset
+    Description : Drops any unfinished updates, for a new or loaded game.
+                  None of this is saved; a loaded game starts every update
+                  from the beginning.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aischReset(void)
+{
+    memset(aischOwners, 0, sizeof(aischOwners));
+    memset(&aischStats, 0, sizeof(aischStats));
+    aischQueueHead = 0;
+    aischQueueLength = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischQuotaGet
+    Description : Gets the work quota frames of the current game run with.
+                  Single player games and packet playback don't get one:
+                  KAS watch functions and the recordings played back expect
+                  each update to finish on the frame it fell due.
+    Inputs      :
+    Outputs     :
+    Return      : work units a frame, 0 for no limit
+----------------------------------------------------------------------------*/
+udword aischQuotaGet(void)
+{
+    if (singlePlayerGame || playPackets)
+    {
+        return(0);
+    }
+    return(aischQuota);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischDue
+    Description : Queues an owner's update to run.  If its last update
+                  hasn't finished yet it carries on with that one instead.
+    Inputs      : owner - player index or AISCH_Kas
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aischDue(sdword owner)
+{
+    dbgAssertOrIgnore(owner >= 0 && owner < AISCH_NumberOwners);
+
+    if (aischOwners[owner].queued)
+    {
+        return;
+    }
+    aischOwners[owner].queued = TRUE;
+    aischOwners[owner].dueCounter = universe.univUpdateCounter;
+    aischOwners[owner].passWork = 0;
+    aischOwners[owner].passSlices = 0;
+
+    aischQueue[(aischQueueHead + aischQueueLength) % AISCH_NumberOwners] = owner;
+    aischQueueLength++;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischState
+    Description : Gets where an owner's update is up to.  Called from
+                  outside aischRun, as the tutorial calls kasExecute, it
+                  gets a blank state instead so the call makes a full pass
+                  of its own and leaves the scheduled update alone.
+    Inputs      : owner - player index or AISCH_Kas
+    Outputs     :
+    Return      : the state to use and update
+----------------------------------------------------------------------------*/
+aischowner *aischState(sdword owner)
+{
+    static aischowner unscheduled;
+
+    dbgAssertOrIgnore(owner >= 0 && owner < AISCH_NumberOwners);
+
+    if (aischRunning)
+    {
+        return(&aischOwners[owner]);
+    }
+    memset(&unscheduled, 0, sizeof(unscheduled));
+    return(&unscheduled);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischTeamResume
+    Description : Gets the team a pass over aiplayer->teams should carry on
+                  from.  aitDestroy moves the last team into the slot it
+                  frees, so if the teams have changed since the pass
+                  stopped the index doesn't mean anything any more and the
+                  pass starts over.
+    Inputs      : state - from aischState
+                  aiplayer - whose teams are being gone through
+    Outputs     :
+    Return      : index of the team to do next
+----------------------------------------------------------------------------*/
+sdword aischTeamResume(aischowner *state, struct AIPlayer *aiplayer)
+{
+    if ((state->cursor != 0) &&
+        ((state->cursorTeams != aiplayer->teamsUsed) || (state->cursor >= aiplayer->teamsUsed) ||
+         (aiplayer->teams[state->cursor] != state->cursorTeam)))
+    {
+        state->cursor = 0;
+    }
+    return(state->cursor);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischTeamStop
+    Description : Remembers where a pass over aiplayer->teams stopped, for
+                  aischTeamResume.
+    Inputs      : state - from aischState
+                  aiplayer - whose teams are being gone through
+                  index - the team to do next
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aischTeamStop(aischowner *state, struct AIPlayer *aiplayer, sdword index)
+{
+    state->cursor = index;
+    state->cursorTeam = (index < aiplayer->teamsUsed) ? aiplayer->teams[index] : NULL;
+    state->cursorTeams = aiplayer->teamsUsed;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischSpend
+    Description : Counts work done by the update being run.
+    Inputs      : work - work units
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aischSpend(udword work)
+{
+    aischFrameWork += work;
+    aischSliceWork += work;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischOutOfWork
+    Description : Says whether the update being run should stop where it is
+                  and carry on next frame.  Each update gets to do at least
+                  one unit of work a frame so it always gets somewhere, and
+                  outside aischRun nothing is ever cut short.
+    Inputs      :
+    Outputs     :
+    Return      : TRUE if the frame's quota is used up
+----------------------------------------------------------------------------*/
+bool aischOutOfWork(void)
+{
+    return(aischRunning && (aischFrameQuota != 0) && (aischSliceWork != 0) && (aischFrameWork >= aischFrameQuota));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischOwnerSlice
+    Description : Runs as much of an owner's update as the quota allows.
+    Inputs      : owner - player index or AISCH_Kas
+    Outputs     :
+    Return      : TRUE if the update finished, or was dropped because its
+                  player is gone
+----------------------------------------------------------------------------*/
+static bool aischOwnerSlice(sdword owner)
+{
+    AIPlayer *aiplayer;
+    bool done;
+
+    if (owner == AISCH_Kas)
+    {
+        aiCurrentAIPlayer = universe.players[1].aiPlayer;
+        dbgAssertOrIgnore(aiCurrentAIPlayer);
+
+        //KAS can make ships and change their owners, so the threat grid
+        //is left out of it and rebuilt afterwards
+        aithFrameEnd();
+        universe.aiplayerProcessing = TRUE;
+        done = kasExecute();
+        universe.aiplayerProcessing = FALSE;
+        aithFrameStart();
+        return(done);
+    }
+
+    aiplayer = universe.players[owner].aiPlayer;
+    if ((aiplayer == NULL) || (aiplayer->player->playerState == PLAYER_DEAD) || mrNoAI)
+    {
+        aischOwners[owner].stage = 0;
+        aischOwners[owner].cursor = 0;
+        return(TRUE);
+    }
+    return(aiplayerPlay(aiplayer));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aischRun
+    Description : Runs the queued updates in order until this frame's quota
+                  is used up.  The update that runs out part way through
+                  stays at the front of the queue and carries on next frame.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aischRun(void)
+{
+    sdword owner;
+    bool done;
+    sqword timeStart, timeStop;
+    aischowner *state;
+    aischownerstats *stats;
+
+    if (aischQueueLength == 0)
+    {
+        return;
+    }
+
+    aischRunning = TRUE;
+    aischFrameQuota = aischQuotaGet();
+    aischFrameWork = 0;
+
+    while ((aischQueueLength != 0) && ((aischFrameQuota == 0) || (aischFrameWork < aischFrameQuota)))
+    {
+        owner = aischQueue[aischQueueHead];
+        state = &aischOwners[owner];
+        stats = &aischStats.owner[owner];
+
+        aischSliceWork = 0;
+        GetRawTime(&timeStart);
+        done = aischOwnerSlice(owner);
+        GetRawTime(&timeStop);
+
+        state->passWork += aischSliceWork;
+        state->passSlices++;
+        stats->nSlices++;
+        stats->timeTotal += timeStop - timeStart;
+        stats->timeMax = max(stats->timeMax, timeStop - timeStart);
+
+        if (!done)
+        {                                                   //out of work, carry on next frame
+            break;
+        }
+
+        stats->nPasses++;
+        stats->workLast = state->passWork;
+        stats->workMax = max(stats->workMax, state->passWork);
+        stats->workTotal += state->passWork;
+        stats->slicesMax = max(stats->slicesMax, state->passSlices);
+        stats->lateMax = max(stats->lateMax, universe.univUpdateCounter - state->dueCounter);
+        if (owner != AISCH_Kas)
+        {
+            aiplayerLog((owner, "Update done, %u work units over %u frames", state->passWork, state->passSlices));
+        }
+
+        state->queued = FALSE;
+        aischQueueHead = (aischQueueHead + 1) % AISCH_NumberOwners;
+        aischQueueLength--;
+    }
+
+    aischRunning = FALSE;
+
+    aischStats.nFrames++;
+    if (aischQueueLength != 0)
+    {
+        aischStats.nFramesDeferred++;
+    }
+    aischStats.workMax = max(aischStats.workMax, aischFrameWork);
+    aischStats.workTotal += aischFrameWork;
+}
@@ -0,0 +1,107 @@
+// =============================================================================
+//  AISchedule.h
+//  - spreads computer player and KAS updates over frames, running a fixed
+//    number of work units each frame so heavy updates don't all land on
+//    the same one
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___AISCHEDULE_H
+#define ___AISCHEDULE_H
+
+#include "MaxMultiplayer.h"
+#include "Types.h"
+
+struct AIPlayer;
+struct AITeam;
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+//work is counted in units rather than time so every machine splits the
+//updates up the same way, which keeps network players in step.  Single
+//player games, whose KAS scripts and recordings were all made with every
+//update finishing on the frame it fell due, run with no limit.
+#define AISCH_WorkQuota         128             // work units a frame
+
+#define AISCH_BlobWork          4               // the blob arrays, made each frame an update runs on
+#define AISCH_FleetWork         8               // enemy knowledge and handing out new ships
+#define AISCH_ManagerWork       8               // one pass of the attack, defense or resource manager
+#define AISCH_TeamWork          2               // one team's events and move
+#define AISCH_BuildWork         2               // passing on ship build requests
+#define AISCH_KasWatchWork      1               // one mission, FSM or state watch function
+
+//who the work is for; players by index, then the single player mission script
+#define AISCH_Kas               MAX_MULTIPLAYER_PLAYERS
+#define AISCH_NumberOwners      (MAX_MULTIPLAYER_PLAYERS + 1)
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//where an owner's unfinished update is up to
+typedef struct
+{
+    bool queued;                                // update is due and not finished
+    ubyte stage;                                // aifFleetCommand stage, or KAS mission watch done
+    sdword cursor;                              // next team for aitExecute or kasExecute
+    struct AITeam *cursorTeam;                  // the team that was at the cursor
+    sdword cursorTeams;                         // teamsUsed when the cursor was set
+    udword dueCounter;                          // univUpdateCounter when the update fell due
+    udword passWork;                            // work done on the update so far
+    udword passSlices;                          // frames the update has had so far
+}
+aischowner;
+
+typedef struct
+{
+    udword nPasses;                             // updates finished
+    udword nSlices;                             // frames spent on them
+    udword slicesMax;                           // most frames one update was spread over
+    udword workLast;                            // work units of the last update
+    udword workMax;
+    udword workTotal;
+    udword lateMax;                             // most frames an update finished after falling due
+    sqword timeTotal;                           // time spent, in GetRawTime units; reporting only
+    sqword timeMax;                             // longest single frame's share
+}
+aischownerstats;
+
+typedef struct
+{
+    udword nFrames;                             // frames with AI work to do
+    udword nFramesDeferred;                     // frames that left work for the next one
+    udword workMax;                             // most work done in one frame
+    udword workTotal;
+    aischownerstats owner[AISCH_NumberOwners];
+}
+aischstats;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern udword aischQuota;                       // AISCH_WorkQuota; only /aiBenchQuota changes it, 0 for no limit
+                                                // aischQuotaGet says what a frame actually gets
+extern aischstats aischStats;
+extern aischowner aischOwners[AISCH_NumberOwners];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void aischReset(void);
+udword aischQuotaGet(void);
+void aischDue(sdword owner);
+void aischRun(void);
+
+aischowner *aischState(sdword owner);
+sdword aischTeamResume(aischowner *state, struct AIPlayer *aiplayer);
+void aischTeamStop(aischowner *state, struct AIPlayer *aiplayer, sdword index);
+
+void aischSpend(udword work);
+bool aischOutOfWork(void);
+
+#endif
@@ -12,6 +12,7 @@
 #include "AIHandler.h"
 #include "AIMoves.h"
 #include "AIPlayer.h"
+#include "AISchedule.h"
 #include "CommandDefs.h"
 #include "GravWellGenerator.h"
 #include "SaveGame.h"
@@ -2093,14 +2094,27 @@ AITeam *aitFindGoodCoopTeam(ShipType type)
 //
 //  process current move for each team
 //
-void aitExecute(void)
+//  stops when the frame's AI work quota runs out and returns FALSE, the
+//  next call carries on with the team after the last one done, or starts
+//  over if the teams have changed in between
+//
+bool aitExecute(void)
 {
     sdword i;
     AITeam *team;
     AITeamMove *lastMove, *thisMove;
+    aischowner *sched = aischState(aiCurrentAIPlayer->player->playerIndex);
 
-    for (i = 0; i < aiCurrentAIPlayer->teamsUsed; ++i)
+    //carry on from the team the last call stopped at
+    for (i = aischTeamResume(sched, aiCurrentAIPlayer); i < aiCurrentAIPlayer->teamsUsed; ++i)
     {
+        if (aischOutOfWork())
+        {
+            aischTeamStop(sched, aiCurrentAIPlayer, i);
+            return FALSE;
+        }
+        aischSpend(AISCH_TeamWork);
+
         team = aiCurrentAIPlayer->teams[i];
 
         // handle any events, if applicable first
@@ -2203,6 +2217,9 @@ void aitExecute(void)
             }
         }
     }
+
+    sched->cursor = 0;
+    return TRUE;
 }
 
 //
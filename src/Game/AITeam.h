@@ -588,7 +588,7 @@ void GenericCooperatingTeamDiedCB(AITeam *team);
 bool aitRemoveShip(AITeam *team, ShipPtr ship);
 
 //process current move for each team
-void aitExecute(void);
+bool aitExecute(void);
 
 
 void aitShipDied(struct AIPlayer *aiplayer,ShipPtr ship);
@@ -0,0 +1,476 @@
+// =============================================================================
+//  AIThreat.c
+//  - coarse threat grid for the computer players, built once per AI frame
+//    from the collision blobs so the AI can ask where enemy strength is
+//    without walking ship lists
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "AIThreat.h"
+
+#include <string.h>
+
+#include "AIUtilities.h"
+#include "Gun.h"
+#include "ObjTypes.h"
+#include "RaceDefs.h"
+#include "Sensors.h"
+#include "ShipDefs.h"
+#include "TimeoutTimer.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define AITH_AllOwners          ((1 << AITH_NumberOwners) - 1)
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool aithEnabled = TRUE;
+aithstats aithStats;
+
+//the grid covers the mission sphere's bounding box; each cell holds what
+//every owner has in it, so each player's view is just a mask of owners
+static struct
+{
+    bool active;                                // inside the AI players' update
+    bool built;                                 // cells reflect the ships of this AI frame
+    udword numShips;                            // universe.ShipList.num when built
+    vector low;                                 // corner of cell 0
+    vector scale;                               // cells per unit along each axis
+    aithcell cells[AITH_NumberCells];
+    udword numOccupied;                         // cells with ships in them, cleared on the next build
+    uword occupied[AITH_NumberCells];
+}
+aithGrid;
+
+//ratings of each static info, and its gunShipFirePower at each tactics
+//scaled and plus one so zero means not worked out yet
+static aithrating aithRatings[NUM_RACES][TOTAL_NUM_SHIPS];
+static udword aithFirePowerCache[NUM_RACES][TOTAL_NUM_SHIPS][NUM_TACTICS_TYPES];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : aithReset
+    Description : Forgets the grid and the cached ship ratings, for a new or
+                  loaded game, since the ship statics may have been reloaded.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aithReset(void)
+{
+    memset(aithRatings, 0, sizeof(aithRatings));
+    memset(aithFirePowerCache, 0, sizeof(aithFirePowerCache));
+    aithGrid.built = FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithFrameStart
+    Description : Called before the computer players are updated.  The grid
+                  is rebuilt the first time it's asked for after this.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aithFrameStart(void)
+{
+    aithGrid.active = TRUE;
+    aithGrid.built = FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithFrameEnd
+    Description : Called after the computer players are updated.  Ships move
+                  once the AI is done, so near-queries go back to scanning.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void aithFrameEnd(void)
+{
+    aithGrid.active = FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithShipRating
+    Description : Returns the aiuRateShip and aiuIsShipDangerous answers for
+                  a kind of ship, working them out the first time it's
+                  asked about each game.
+    Inputs      : info - static info of the ship
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+aithrating *aithShipRating(ShipStaticInfo *info)
+{
+    static aithrating uncached;
+    aithrating *rating;
+
+    if ((udword)info->shiprace >= NUM_RACES ||
+        (udword)info->shiptype >= TOTAL_NUM_SHIPS)
+    {
+        rating = &uncached;
+        rating->rated = FALSE;
+    }
+    else
+    {
+        rating = &aithRatings[info->shiprace][info->shiptype];
+    }
+
+    if (!rating->rated)
+    {
+        aiuRateShipStatic(&rating->strength, &rating->value, info);
+        rating->dangerous = aiuIsShipStaticDangerous(info);
+        rating->rated = TRUE;
+    }
+    return(rating);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithShipFirePower
+    Description : Returns the ship's gunShipFirePower, scaled, from the cache.
+    Inputs      : ship - ship to rate
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static udword aithShipFirePower(Ship *ship)
+{
+    udword *cached;
+
+    if ((udword)ship->shiprace >= NUM_RACES ||
+        (udword)ship->shiptype >= TOTAL_NUM_SHIPS ||
+        (udword)ship->tacticstype >= NUM_TACTICS_TYPES)
+    {
+        return((udword)(gunShipFirePower(ship->staticinfo, ship->tacticstype) * AITH_FirePowerScale));
+    }
+
+    cached = &aithFirePowerCache[ship->shiprace][ship->shiptype][ship->tacticstype];
+    if (*cached == 0)
+    {
+        *cached = (udword)(gunShipFirePower(ship->staticinfo, ship->tacticstype) * AITH_FirePowerScale) + 1;
+    }
+    return(*cached - 1);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithCellCoord
+    Description : Returns the cell a coordinate falls in along one axis.
+                  Never decreases as coord increases, so the cells spanned
+                  by a query box contain every point inside it.
+    Inputs      : coord - world coordinate
+                  low - coordinate of the grid's first edge on this axis
+                  scale - cells per world unit on this axis
+                  nCells - cells on this axis
+    Outputs     :
+    Return      : 0..nCells-1, clamped at the edges
+----------------------------------------------------------------------------*/
+static sdword aithCellCoord(real32 coord, real32 low, real32 scale, sdword nCells)
+{
+    real32 cell = (coord - low) * scale;
+
+    if (!(cell >= 0.0f))
+    {                                                       //also catches NaN
+        return(0);
+    }
+    if (cell >= (real32)nCells)
+    {
+        return(nCells - 1);
+    }
+    return((sdword)cell);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithCellIndex
+    Description : Returns the index of the cell a point falls in.
+    Inputs      : position - point in world space
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static sdword aithCellIndex(vector *position)
+{
+    sdword x = aithCellCoord(position->x, aithGrid.low.x, aithGrid.scale.x, AITH_CellsX);
+    sdword y = aithCellCoord(position->y, aithGrid.low.y, aithGrid.scale.y, AITH_CellsY);
+    sdword z = aithCellCoord(position->z, aithGrid.low.z, aithGrid.scale.z, AITH_CellsZ);
+
+    return(x + AITH_CellsX * (y + AITH_CellsY * z));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithBuild
+    Description : Rebuilds the grid from the ships in the collision blobs,
+                  which are the ships getShipNearObjTok can find.  Only the
+                  cells that had ships last time are cleared.  Drones mark
+                  their owner as present, so near-queries stay exact, but
+                  don't add to the layers; the AI doesn't count them as
+                  ships.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void aithBuild(void)
+{
+    Node *blobnode;
+    blob *thisBlob;
+    Ship *ship;
+    aithcell *cell;
+    aithrating *rating;
+    sdword i, index, owner;
+    udword ownerBit, numOccupied;
+    real32 sizeX, sizeY, sizeZ;
+    sqword timeStart, timeStop;
+
+    GetRawTime(&timeStart);
+
+    for (numOccupied = 0; numOccupied < aithGrid.numOccupied; numOccupied++)
+    {
+        memset(&aithGrid.cells[aithGrid.occupied[numOccupied]], 0, sizeof(aithcell));
+    }
+    aithGrid.numOccupied = 0;
+
+    sizeX = max(smUniverseSizeX, 1.0f);
+    sizeY = max(smUniverseSizeY, 1.0f);
+    sizeZ = max(smUniverseSizeZ, 1.0f);
+    aithGrid.low.x = -sizeX;
+    aithGrid.low.y = -sizeY;
+    aithGrid.low.z = -sizeZ;
+    aithGrid.scale.x = (real32)AITH_CellsX / (sizeX * 2.0f);
+    aithGrid.scale.y = (real32)AITH_CellsY / (sizeY * 2.0f);
+    aithGrid.scale.z = (real32)AITH_CellsZ / (sizeZ * 2.0f);
+
+    for (blobnode = universe.collBlobList.head; blobnode != NULL; blobnode = blobnode->next)
+    {
+        thisBlob = (blob *)listGetStructOfNode(blobnode);
+        if (thisBlob->blobShips == NULL)
+        {
+            continue;
+        }
+
+        for (i = 0; i < thisBlob->blobShips->numShips; i++)
+        {
+            ship = thisBlob->blobShips->ShipPtr[i];
+
+            if ((ship->playerowner == NULL) || (ship->playerowner->playerIndex >= MAX_MULTIPLAYER_PLAYERS))
+            {
+                owner = AITH_NoOwner;
+            }
+            else
+            {
+                owner = ship->playerowner->playerIndex;
+            }
+
+            index = aithCellIndex(&ship->posinfo.position);
+            cell = &aithGrid.cells[index];
+            if (cell->owners == 0)
+            {
+                aithGrid.occupied[aithGrid.numOccupied++] = (uword)index;
+            }
+            ownerBit = 1 << owner;
+            cell->owners |= ownerBit;
+            if (ship->shiptype == Drone)
+            {                                               //drones don't count as ships to the AI
+                continue;
+            }
+
+            rating = aithShipRating(ship->staticinfo);
+            if (rating->dangerous)
+            {
+                cell->dangerousOwners |= ownerBit;
+            }
+            cell->firePower[owner] += aithShipFirePower(ship);
+            cell->value[owner] += rating->value;
+        }
+    }
+
+    aithGrid.numShips = universe.ShipList.num;
+    aithGrid.built = TRUE;
+
+    GetRawTime(&timeStop);
+    aithStats.nBuilds++;
+    aithStats.buildTime += timeStop - timeStart;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithGridReady
+    Description : Makes sure the grid is up to date, building it if this is
+                  the first use this AI frame or ships have come or gone
+                  since it was built.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void aithGridReady(void)
+{
+    if (!aithGrid.active || !aithGrid.built || (aithGrid.numShips != universe.ShipList.num))
+    {
+        aithBuild();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithFriendMask/aithEnemyMask
+    Description : Returns the owners that are player's enemies/friends, the
+                  same way MakeTargetsOnlyEnemyShips decides.
+    Inputs      : player - player asking
+    Outputs     :
+    Return      : bit per owner
+----------------------------------------------------------------------------*/
+static udword aithFriendMask(Player *player)
+{
+    return(((1 << player->playerIndex) | player->Allies) & ((1 << MAX_MULTIPLAYER_PLAYERS) - 1));
+}
+
+static udword aithEnemyMask(Player *player)
+{
+    return(AITH_AllOwners & ~aithFriendMask(player));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithEnemyPossiblyNear
+    Description : Says whether there may be enemy ships of player within
+                  range of position along every axis, as
+                  MakeTargetsOnlyBeWithinRangeAndNotIncludeMe measures it.
+                  A FALSE answer is exact, so callers can skip their ship
+                  scan and get the same (empty) result.
+    Inputs      : player - player asking
+                  position - centre of the query
+                  range - half size of the query box
+                  dangerous - only count aiuIsShipDangerous ships
+    Outputs     :
+    Return      : FALSE if there are certainly none, TRUE if there may be
+----------------------------------------------------------------------------*/
+bool aithEnemyPossiblyNear(Player *player, vector *position, real32 range, bool dangerous)
+{
+    sdword x, y, z, x0, x1, y0, y1, z0, z1;
+    udword enemies, ownerMask;
+    aithcell *cell;
+
+    //only trusted inside the AI update, while nothing moves
+    if (!aithEnabled || !aithGrid.active)
+    {
+        return(TRUE);
+    }
+    aithGridReady();
+    aithStats.nQueries++;
+
+    range += AITH_QueryMargin;
+    x0 = aithCellCoord(position->x - range, aithGrid.low.x, aithGrid.scale.x, AITH_CellsX);
+    x1 = aithCellCoord(position->x + range, aithGrid.low.x, aithGrid.scale.x, AITH_CellsX);
+    y0 = aithCellCoord(position->y - range, aithGrid.low.y, aithGrid.scale.y, AITH_CellsY);
+    y1 = aithCellCoord(position->y + range, aithGrid.low.y, aithGrid.scale.y, AITH_CellsY);
+    z0 = aithCellCoord(position->z - range, aithGrid.low.z, aithGrid.scale.z, AITH_CellsZ);
+    z1 = aithCellCoord(position->z + range, aithGrid.low.z, aithGrid.scale.z, AITH_CellsZ);
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > AITH_MaxQueryCells)
+    {
+        return(TRUE);
+    }
+
+    enemies = aithEnemyMask(player);
+    for (z = z0; z <= z1; z++)
+    {
+        for (y = y0; y <= y1; y++)
+        {
+            cell = &aithGrid.cells[x0 + AITH_CellsX * (y + AITH_CellsY * z)];
+            for (x = x0; x <= x1; x++, cell++)
+            {
+                ownerMask = dangerous ? cell->dangerousOwners : cell->owners;
+                if (ownerMask & enemies)
+                {
+                    return(TRUE);
+                }
+            }
+        }
+    }
+
+    aithStats.nEarlyOuts++;
+    return(FALSE);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithSum
+    Description : Sums one of the per owner layers over a set of owners in
+                  the cells a query box spans.
+    Inputs      : value - add up value instead of fire power
+                  owners - bit per owner to add up
+                  position - centre of the query
+                  range - half size of the query box, 0 for just the cell
+                          position is in
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static udword aithSum(bool value, udword owners, vector *position, real32 range)
+{
+    sdword x, y, z, x0, x1, y0, y1, z0, z1, owner;
+    aithcell *cell;
+    udword *cellLayer;
+    udword sum = 0;
+
+    aithGridReady();
+    aithStats.nLayerQueries++;
+
+    x0 = aithCellCoord(position->x - range, aithGrid.low.x, aithGrid.scale.x, AITH_CellsX);
+    x1 = aithCellCoord(position->x + range, aithGrid.low.x, aithGrid.scale.x, AITH_CellsX);
+    y0 = aithCellCoord(position->y - range, aithGrid.low.y, aithGrid.scale.y, AITH_CellsY);
+    y1 = aithCellCoord(position->y + range, aithGrid.low.y, aithGrid.scale.y, AITH_CellsY);
+    z0 = aithCellCoord(position->z - range, aithGrid.low.z, aithGrid.scale.z, AITH_CellsZ);
+    z1 = aithCellCoord(position->z + range, aithGrid.low.z, aithGrid.scale.z, AITH_CellsZ);
+
+    for (z = z0; z <= z1; z++)
+    {
+        for (y = y0; y <= y1; y++)
+        {
+            cell = &aithGrid.cells[x0 + AITH_CellsX * (y + AITH_CellsY * z)];
+            for (x = x0; x <= x1; x++, cell++)
+            {
+                if (!(cell->owners & owners))
+                {
+                    continue;
+                }
+                cellLayer = value ? cell->value : cell->firePower;
+                for (owner = 0; owner < AITH_NumberOwners; owner++)
+                {
+                    if (owners & (1 << owner))
+                    {
+                        sum += cellLayer[owner];
+                    }
+                }
+            }
+        }
+    }
+    return(sum);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : aithEnemyFirePower/aithEnemyValue/aithFriendlyFirePower
+    Description : Returns the fire power or value of player's enemies, or
+                  the fire power of player and its allies, in the grid cells
+                  within range of position.  Cells are whole, so this counts
+                  ships up to a cell beyond range.  Meant to be called from
+                  the AI update; the grid is rebuilt for every call made
+                  outside it.
+    Inputs      : player - player asking
+                  position - centre of the query
+                  range - half size of the query box, 0 for just the cell
+                          position is in
+    Outputs     :
+    Return      : fire power in 1/AITH_FirePowerScale units, or value in RU
+----------------------------------------------------------------------------*/
+udword aithEnemyFirePower(Player *player, vector *position, real32 range)
+{
+    return(aithSum(FALSE, aithEnemyMask(player), position, range));
+}
+
+udword aithEnemyValue(Player *player, vector *position, real32 range)
+{
+    return(aithSum(TRUE, aithEnemyMask(player), position, range));
+}
+
+udword aithFriendlyFirePower(Player *player, vector *position, real32 range)
+{
+    return(aithSum(FALSE, aithFriendMask(player), position, range));
+}
@@ -0,0 +1,92 @@
+// =============================================================================
+//  AIThreat.h
+//  - coarse threat grid for the computer players, built once per AI frame
+//    from the collision blobs so the AI can ask where enemy strength is
+//    without walking ship lists
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___AITHREAT_H
+#define ___AITHREAT_H
+
+#include "MaxMultiplayer.h"
+#include "SpaceObj.h"
+#include "Types.h"
+#include "Universe.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define AITH_CellsX             16
+#define AITH_CellsY             16
+#define AITH_CellsZ             8
+#define AITH_NumberCells        (AITH_CellsX * AITH_CellsY * AITH_CellsZ)
+
+//one layer per player plus one for ships without a usable owner, which
+//are treated as everyone's enemy
+#define AITH_NumberOwners       (MAX_MULTIPLAYER_PLAYERS + 1)
+#define AITH_NoOwner            MAX_MULTIPLAYER_PLAYERS
+
+#define AITH_FirePowerScale     16.0f           // gunShipFirePower is kept in 1/16ths
+#define AITH_QueryMargin        16.0f           // query boxes are grown by this to cover float rounding at cell edges
+#define AITH_MaxQueryCells      512             // bigger near-queries aren't worth answering from the grid
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+typedef struct
+{
+    udword owners;                              // bit per owner with ships in this cell
+    udword dangerousOwners;                     // bit per owner with aiuIsShipDangerous ships here
+    udword firePower[AITH_NumberOwners];        // sum of gunShipFirePower * AITH_FirePowerScale
+    udword value[AITH_NumberOwners];            // sum of the aiuRateShip values
+}
+aithcell;
+
+//aiuRateShip and aiuIsShipDangerous of a ship type, worked out once a game
+typedef struct
+{
+    bool rated;                                 // the rest has been filled in
+    bool dangerous;
+    udword strength;
+    udword value;
+}
+aithrating;
+
+typedef struct
+{
+    udword nBuilds;                             // times the grid was rebuilt
+    udword nQueries;                            // near-queries asked of the grid
+    udword nEarlyOuts;                          // near-queries answered without a ship scan
+    udword nLayerQueries;                       // fire power and value lookups
+    sqword buildTime;                           // time spent building, in GetRawTime units
+}
+aithstats;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool aithEnabled;
+extern aithstats aithStats;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void aithReset(void);
+void aithFrameStart(void);
+void aithFrameEnd(void);
+
+aithrating *aithShipRating(ShipStaticInfo *info);
+
+bool aithEnemyPossiblyNear(Player *player, vector *position, real32 range, bool dangerous);
+
+udword aithEnemyFirePower(Player *player, vector *position, real32 range);
+udword aithEnemyValue(Player *player, vector *position, real32 range);
+udword aithFriendlyFirePower(Player *player, vector *position, real32 range);
+
+#endif
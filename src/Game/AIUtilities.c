@@ -12,6 +12,7 @@
 #include "AIMoves.h"
 #include "AIPlayer.h"
 #include "AIShip.h"
+#include "AIThreat.h"
 #include "Alliance.h"
 #include "Collision.h"
 #include "CommandDefs.h"
@@ -825,15 +826,27 @@ bool aiuShipsArentTargetable(SelectCommand *selection)
 
 /*-----------------------------------------------------------------------------
     Name        : aiuIsShipDangerous
-    Description : Returns TRUE if ship is a dangerous ship
+    Description : Returns TRUE if ship is a dangerous ship, from the threat
+                  grid's ratings
     Inputs      : ship
     Outputs     :
     Return      : Returns TRUE if ship is a dangerous ship
 ----------------------------------------------------------------------------*/
 bool aiuIsShipDangerous(Ship *ship)
 {
-    ShipStaticInfo *shipstatic = ship->staticinfo;
+    return aithShipRating(ship->staticinfo)->dangerous;
+}
+
 
+/*-----------------------------------------------------------------------------
+    Name        : aiuIsShipStaticDangerous
+    Description : Returns TRUE if ships of this kind are dangerous ships
+    Inputs      : shipstatic - the static info of the ships
+    Outputs     :
+    Return      : Returns TRUE if it's a dangerous ship
+----------------------------------------------------------------------------*/
+bool aiuIsShipStaticDangerous(ShipStaticInfo *shipstatic)
+{
     switch (shipstatic->shipclass)
     {
         case CLASS_Mothership:
@@ -903,14 +916,32 @@ bool aiuIsShipPrimaryEnemy(Ship *ship)
 /*-----------------------------------------------------------------------------
     Name        : aiuRateShip
     Description : Rates a ship based on overall strength (from stats.c) and
-                  value (based on scriptset values)
+                  value (based on scriptset values), from the threat grid's
+                  ratings
     Inputs      : strength, value
     Outputs     : fills in strength and value
     Return      : void
 ----------------------------------------------------------------------------*/
 void aiuRateShip(udword *strength, udword *value, ShipPtr ship)
 {
-    if (ship->shiptype == FloatingCity)
+    aithrating *rating = aithShipRating(ship->staticinfo);
+
+    *strength = rating->strength;
+    *value    = rating->value;
+}
+
+
+/*-----------------------------------------------------------------------------
+    Name        : aiuRateShipStatic
+    Description : Rates a kind of ship based on overall strength (from stats.c)
+                  and value (based on scriptset values)
+    Inputs      : strength, value, shipstatic - the static info of the ship
+    Outputs     : fills in strength and value
+    Return      : void
+----------------------------------------------------------------------------*/
+void aiuRateShipStatic(udword *strength, udword *value, ShipStaticInfo *shipstatic)
+{
+    if (shipstatic->shiptype == FloatingCity)
     {
         //may need to put in a value for this at some point
         // if the trader ship ever battles with the computer player
@@ -918,17 +949,17 @@ void aiuRateShip(udword *strength, udword *value, ShipPtr ship)
     }
     else
     {
-        *strength = (udword)(statsGetOverallKillRating(ship->staticinfo));
+        *strength = (udword)(statsGetOverallKillRating(shipstatic));
     }
 
-    if ((ship->shiptype == Mothership) ||
-        (ship->shiptype == FloatingCity))
+    if ((shipstatic->shiptype == Mothership) ||
+        (shipstatic->shiptype == FloatingCity))
     {
         *value = AIU_MOTHERSHIP_VALUE;
     }
     else
     {
-        *value = ship->staticinfo->buildCost;
+        *value = shipstatic->buildCost;
     }
 
 /*    switch (ship->shiptype)
@@ -2049,7 +2080,16 @@ SelectCommand *aiuFindNearbyEnemyShips(Ship *primarytarget,real32 range)
 {
     SelectCommand *enemyShips;
     MaxSelection tempShips;
-    Ship *ship = getShipNearObjTok((SpaceObjRotImpTarg *)primarytarget, range);
+    Ship *ship;
+
+    //the threat grid knows when there's nothing to find
+    if (!aithEnemyPossiblyNear(aiCurrentAIPlayer->player, &primarytarget->posinfo.position, range, FALSE))
+    {
+        aiuNewSelection(enemyShips, 1, "fnes");
+        return enemyShips;
+    }
+
+    ship = getShipNearObjTok((SpaceObjRotImpTarg *)primarytarget, range);
 
     tempShips.numShips = 0;
 
@@ -2088,7 +2128,15 @@ SelectCommand *aiuFindNearbyEnemyShips(Ship *primarytarget,real32 range)
 ----------------------------------------------------------------------------*/
 SelectCommand *aiuFindNearbyDangerousEnemyShips(Ship *primarytarget,real32 range)
 {
-    SelectCommand *dangerousShips = aiuFindNearbyEnemyShips(primarytarget,range);
+    SelectCommand *dangerousShips;
+
+    if (!aithEnemyPossiblyNear(aiCurrentAIPlayer->player, &primarytarget->posinfo.position, range, TRUE))
+    {
+        aiuNewSelection(dangerousShips, 1, "fnds");
+        return dangerousShips;
+    }
+
+    dangerousShips = aiuFindNearbyEnemyShips(primarytarget,range);
 
     if (dangerousShips)
     {
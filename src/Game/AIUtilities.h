@@ -188,11 +188,13 @@ bool aiuShipsArentTargetable(SelectCommand *selection);
 
 //returns TRUE if ship is a dangerous ship
 bool aiuIsShipDangerous(Ship *ship);
+bool aiuIsShipStaticDangerous(ShipStaticInfo *shipstatic);
 
 //returns TRUE if the ship is a primary enemy
 bool aiuIsShipPrimaryEnemy(Ship *ship);
 
 void aiuRateShip(udword *strength, udword *value, ShipPtr ship);
+void aiuRateShipStatic(udword *strength, udword *value, ShipStaticInfo *shipstatic);
 
 //Returns the enemy ships found in the mothership blob
 SelectCommand *aiuEnemyShipsInMothershipBlob(void);
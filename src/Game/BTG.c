@@ -539,7 +539,7 @@ void btgLoad(char* filename)
 #endif
 
 
-    fileLoadAlloc(filename, (void**)&btgData, 0);
+    fileLoadMapped(filename, (void**)&btgData, 0);
     btgDataOffset=btgData;
 
     memStrncpy(btgLastBackground, filename, 127);
@@ -872,7 +872,7 @@ void btgLoad(char* filename)
 #endif
     }
 
-    memFree(btgData);
+    fileLoadRelease(btgData);
 
     btgIndices = (uword*)memAlloc(3 * btgHead->numPolys * sizeof(uword), "btg indices", NonVolatile);
     if (useVBO) glGenBuffers(1, &vboIndices);
@@ -11,13 +11,20 @@
    POSIX-compatible. */
 #include <fnmatch.h>
 #include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #else
 #include <sys/stat.h>
+#include <io.h>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 #endif
 
 #include "BigFile.h"
 
 #include "BitIO.h"
+#include "LZFast.h"
 #include "LZSS.h"
 #include "standard_library.h"
 
@@ -34,8 +41,6 @@
 // files don't compress well enough to bother.  Files with compression ratios below
 // (better than) or equal to this value will be compressed.
 //
-// BUG: at present, BigFileAdd compresses everything or nothing, and ignores this define
-//
 
 #define MINIMUM_COMPRESSION_RATIO 0.950f
 
@@ -63,6 +68,10 @@ bool IgnoreBigfiles = FALSE;
 //  (useful for ordering or creating a bigfile)
 bool LogFileLoads = FALSE;
 
+//  map each opened bigfile read-only and serve loads straight
+//  out of the mapping instead of seeking and reading the FILE *
+bool MapBigfiles = FALSE;
+
 #endif
 
 
@@ -73,6 +82,10 @@ bigFileConfiguration bigFilePrecedence[] = {
         NULL,                       // filePtr
         UNINITIALISED_BIG_TOC,      // tableOfContents
         NULL,                       // localFileRelativeAge
+        NULL,                       // mapBase
+        0,                          // mapLength
+        0,                          // mapRefs
+        NULL,                       // tocIndex
     },
     {
 #if defined(HW_GAME_RAIDER_RETREAT) && defined(_MACOSX)
@@ -85,6 +98,10 @@ bigFileConfiguration bigFilePrecedence[] = {
         NULL,
         UNINITIALISED_BIG_TOC,
         NULL,
+        NULL,
+        0,
+        0,
+        NULL,
     },
     {
 #ifdef HW_GAME_DEMO
@@ -96,6 +113,10 @@ bigFileConfiguration bigFilePrecedence[] = {
         NULL,
         UNINITIALISED_BIG_TOC,
         NULL,
+        NULL,
+        0,
+        0,
+        NULL,
     },
 };
 
@@ -156,6 +177,23 @@ static void filenameSlashMassage(char *filename, bool bLocalPath)
     }
 }
 
+//
+//  Put a filename into the form its TOC CRC was computed from: lowercase,
+//  backslashes, no repeated slashes.  Returns the length of the result.
+//
+static udword bigFilenameNormalize(char *dest, char *src)
+{
+    udword i;
+
+    // pretend the filename is in lowercase
+    for (i = 0; (dest[i] = tolower(src[i])); i++) { }
+
+    // convert all slashes to backslashes and whittle multiple slashes down to a single one
+    filenameSlashMassage(dest, FALSE);
+
+    return strlen(dest);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : PrettyFilesize
     Description : Format a file size (in bytes) attractively)
@@ -491,6 +529,386 @@ static int bigHeaderVerify(FILE *fp)
     return !strcmp(headerHave, headerNeed);
 }
 
+/*-----------------------------------------------------------------------------
+    Compression for fast-create and add.  Files are queued in the order they
+    will be written to the bigfile, compressed into memory by a thread per
+    core and handed back to the writer in that order.  The threads never get
+    more than BF_COMPRESS_AHEAD jobs ahead of the writer, which keeps memory
+    use bounded on big archives.
+-----------------------------------------------------------------------------*/
+
+#define BF_COMPRESS_AHEAD (BF_MAX_COMPRESS_THREADS * 4)
+
+typedef struct
+{
+    char filename[BF_MAX_FILENAME_LENGTH+1];
+    char *data;                 // data to store (compressed or not)
+    udword storedLength;
+    udword realLength;
+    char compressionType;       // what the data ended up as
+    int done;
+    int failed;                 // couldn't read the file
+} bigCompressJob;
+
+typedef struct
+{
+    int compressionType;
+    bigCompressJob *jobs;
+    int numJobs, maxJobs;
+    int nextJob;                // next job for a thread to take
+    int nextWrite;              // next job the writer wants
+    int aborting;
+    int numThreads;
+#ifdef _WIN32
+    HANDLE threads[BF_MAX_COMPRESS_THREADS];
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE wake;
+#else
+    pthread_t threads[BF_MAX_COMPRESS_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+#endif
+} bigCompressor;
+
+#ifdef _WIN32
+#define bigCompressorLock(c)    EnterCriticalSection(&(c)->lock)
+#define bigCompressorUnlock(c)  LeaveCriticalSection(&(c)->lock)
+#define bigCompressorSleep(c)   SleepConditionVariableCS(&(c)->wake, &(c)->lock, INFINITE)
+#define bigCompressorWake(c)    WakeAllConditionVariable(&(c)->wake)
+#else
+#define bigCompressorLock(c)    pthread_mutex_lock(&(c)->lock)
+#define bigCompressorUnlock(c)  pthread_mutex_unlock(&(c)->lock)
+#define bigCompressorSleep(c)   pthread_cond_wait(&(c)->wake, &(c)->lock)
+#define bigCompressorWake(c)    pthread_cond_broadcast(&(c)->wake)
+#endif
+
+//
+//  Expand compressed file data that's already in memory.
+//  returns the expanded size, or -1 on failure
+//
+static int bigExpandBuffer(int compressionType, char *input, int inputSize, char *output, int outputSize)
+{
+    switch (compressionType)
+    {
+        case BF_COMPRESSION_LZSS:
+            return lzssExpandBuffer(input, inputSize, output, outputSize);
+        case BF_COMPRESSION_LZFAST:
+            return lzfExpandBuffer(input, inputSize, output, outputSize);
+        default:
+            return -1;
+    }
+}
+
+//
+//  Read a file into memory and compress it, falling back to storing it
+//  uncompressed if compression doesn't buy us enough.  Safe to call from
+//  several threads at once.
+//
+static void bigCompressJobRun(bigCompressJob *job, int compressionType)
+{
+    FILE *fp;
+    char *raw, *packed;
+    long length;
+    int packedSize, packedMax;
+
+    job->data = NULL;
+    job->storedLength = job->realLength = 0;
+    job->compressionType = BF_COMPRESSION_NONE;
+    job->failed = 1;
+
+    fp = fopen(job->filename, "rb");
+    if (!fp)
+    {
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    raw = (char *)malloc(length + 1);
+    if (raw == NULL || (long)fread(raw, 1, length, fp) != length)
+    {
+        free(raw);
+        fclose(fp);
+        return;
+    }
+    fclose(fp);
+
+    job->data = raw;
+    job->storedLength = job->realLength = length;
+    job->failed = 0;
+
+    if (compressionType == BF_COMPRESSION_NONE || length == 0)
+    {
+        return;
+    }
+
+    // LZSS doesn't check its output size, so give it room for the worst case
+    // (9 bits a byte) and check the ratio afterwards
+    packedMax = (compressionType == BF_COMPRESSION_LZSS) ? length + length / 8 + 16
+                                                         : (int)(length * MINIMUM_COMPRESSION_RATIO);
+    packed = (char *)malloc(packedMax + 1);
+    if (packed == NULL)
+    {
+        return;
+    }
+
+    if (compressionType == BF_COMPRESSION_LZSS)
+    {
+        packedSize = lzssCompressBuffer(raw, length, packed, packedMax);
+    }
+    else
+    {
+        packedSize = lzfCompressBuffer(raw, length, packed, packedMax);
+    }
+
+    if (packedSize < 0 || (float)packedSize/(float)length > MINIMUM_COMPRESSION_RATIO)
+    {
+        free(packed);
+        return;
+    }
+
+    free(raw);
+    job->data = packed;
+    job->storedLength = packedSize;
+    job->compressionType = compressionType;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI bigCompressorThread(void *param)
+#else
+static void *bigCompressorThread(void *param)
+#endif
+{
+    bigCompressor *comp = (bigCompressor *)param;
+    int index;
+
+    bigCompressorLock(comp);
+    for (;;)
+    {
+        while (!comp->aborting && comp->nextJob < comp->numJobs &&
+               comp->nextJob >= comp->nextWrite + BF_COMPRESS_AHEAD)
+        {
+            bigCompressorSleep(comp);
+        }
+        if (comp->aborting || comp->nextJob >= comp->numJobs)
+        {
+            break;
+        }
+        index = comp->nextJob++;
+        bigCompressorUnlock(comp);
+
+        bigCompressJobRun(comp->jobs + index, comp->compressionType);
+
+        bigCompressorLock(comp);
+        comp->jobs[index].done = 1;
+        bigCompressorWake(comp);
+    }
+    bigCompressorUnlock(comp);
+
+    return 0;
+}
+
+static int bigCompressorThreadCount(void)
+{
+    int count;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    count = info.dwNumberOfProcessors;
+#else
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return (count < 1) ? 1 : (count > BF_MAX_COMPRESS_THREADS) ? BF_MAX_COMPRESS_THREADS : count;
+}
+
+static bigCompressor *bigCompressorCreate(int compressionType)
+{
+    bigCompressor *comp = (bigCompressor *)calloc(1, sizeof(bigCompressor));
+
+    comp->compressionType = compressionType;
+#ifdef _WIN32
+    InitializeCriticalSection(&comp->lock);
+    InitializeConditionVariable(&comp->wake);
+#else
+    pthread_mutex_init(&comp->lock, NULL);
+    pthread_cond_init(&comp->wake, NULL);
+#endif
+    return comp;
+}
+
+//
+//  Queue a file to compress.  Only before bigCompressorStart.
+//
+static void bigCompressorAdd(bigCompressor *comp, char *filename)
+{
+    if (comp->numJobs == comp->maxJobs)
+    {
+        comp->maxJobs = comp->maxJobs ? comp->maxJobs * 2 : 256;
+        comp->jobs = (bigCompressJob *)realloc(comp->jobs, comp->maxJobs * sizeof(bigCompressJob));
+    }
+    memset(comp->jobs + comp->numJobs, 0, sizeof(bigCompressJob));
+    strncpy(comp->jobs[comp->numJobs].filename, filename, BF_MAX_FILENAME_LENGTH);
+    comp->numJobs++;
+}
+
+static void bigCompressorStart(bigCompressor *comp)
+{
+    int i, count = bigCompressorThreadCount();
+
+    for (i = 0; i < count; i++)
+    {
+#ifdef _WIN32
+        comp->threads[comp->numThreads] = CreateThread(NULL, 0, bigCompressorThread, comp, 0, NULL);
+        if (comp->threads[comp->numThreads] == NULL)
+#else
+        if (pthread_create(&comp->threads[comp->numThreads], NULL, bigCompressorThread, comp) != 0)
+#endif
+        {
+            break;
+        }
+        comp->numThreads++;
+    }
+}
+
+//
+//  Wait for a queued file to be compressed.  Files must be asked for in the
+//  order they were queued, and given back with bigCompressorRelease.
+//
+static bigCompressJob *bigCompressorWait(bigCompressor *comp, int index)
+{
+    bigCompressJob *job = comp->jobs + index;
+
+    if (comp->numThreads == 0)
+    {
+        // couldn't start any threads, do it here
+        bigCompressJobRun(job, comp->compressionType);
+        job->done = 1;
+        return job;
+    }
+
+    bigCompressorLock(comp);
+    while (!job->done)
+    {
+        bigCompressorSleep(comp);
+    }
+    bigCompressorUnlock(comp);
+
+    return job;
+}
+
+static void bigCompressorRelease(bigCompressor *comp, int index)
+{
+    free(comp->jobs[index].data);
+    comp->jobs[index].data = NULL;
+
+    bigCompressorLock(comp);
+    comp->nextWrite = index + 1;
+    bigCompressorWake(comp);
+    bigCompressorUnlock(comp);
+}
+
+static void bigCompressorDestroy(bigCompressor *comp)
+{
+    int i;
+
+    if (comp == NULL)
+    {
+        return;
+    }
+
+    bigCompressorLock(comp);
+    comp->aborting = 1;
+    bigCompressorWake(comp);
+    bigCompressorUnlock(comp);
+
+    for (i = 0; i < comp->numThreads; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(comp->threads[i], INFINITE);
+        CloseHandle(comp->threads[i]);
+#else
+        pthread_join(comp->threads[i], NULL);
+#endif
+    }
+
+    for (i = 0; i < comp->numJobs; i++)
+    {
+        free(comp->jobs[i].data);
+    }
+#ifdef _WIN32
+    DeleteCriticalSection(&comp->lock);
+#else
+    pthread_mutex_destroy(&comp->lock);
+    pthread_cond_destroy(&comp->wake);
+#endif
+    free(comp->jobs);
+    free(comp);
+}
+
+//
+//  Queue everything bigAdd is going to add, in the order it'll add it,
+//  going through filelists the same way.
+//  returns 1 on success, 0 if a filelist can't be opened
+//
+static int bigCompressorAddFiles(bigCompressor *comp, int numFiles, char *filenames[])
+{
+    FILE *filelistFP = NULL;
+    char filelistLine[BF_MAX_FILENAME_LENGTH+1];
+    char filename[BF_MAX_FILENAME_LENGTH+1];
+    int f, filelist;
+
+    for (f = 0; f < numFiles; ++f)
+    {
+        filelist = (filenames[f][0] == '@');
+        if (filelist)
+        {
+            strcpy(filename, filenames[f] + 1);
+            filenameSlashMassage(filename, TRUE);
+            filelistFP = fopen(filename, "r");
+            if (!filelistFP)
+            {
+                return 0;
+            }
+        }
+
+        do
+        {
+            if (filelist)
+            {
+                if (feof(filelistFP))
+                {
+                    break;
+                }
+                fgets(filelistLine, BF_MAX_FILENAME_LENGTH, filelistFP);
+                filelistLine[BF_MAX_FILENAME_LENGTH] = 0;
+                if (sscanf(filelistLine, "%s", filename) != 1 || !strlen(filename))
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                strcpy(filename, filenames[f]);
+            }
+
+            filenameSlashMassage(filename, TRUE);
+            bigCompressorAdd(comp, filename);
+        } while (filelist && !feof(filelistFP));
+
+        if (filelist)
+        {
+            fclose(filelistFP);
+        }
+    }
+
+    return 1;
+}
+
+static int bigAddFileData(char *bigFilename, char *filename, char *storedFilename, bigCompressJob *job, int optNewer, int consoleOutput);
+
 //
 //  sorts given bigfile
 //  returns 1 on success
@@ -534,7 +952,6 @@ bool bigTOCFileExists(bigTOC *toc, char *filename, udword *fileNum)
     char filenamei[PATH_MAX] = "";
     bigTOCFileEntry target;
     int numFiles = toc->numFiles;
-    unsigned int i;
     uword halfFilenameLength = 0;
 
     if (!numFiles)
@@ -547,11 +964,7 @@ bool bigTOCFileExists(bigTOC *toc, char *filename, udword *fileNum)
         return FALSE;
     }
 
-    // pretend the filename is in lowercase
-    for (i = 0; (filenamei[i] = tolower(filename[i])); i++) { }
-
-    // convert all slashes to backslashes and whittle multiple slashes down to a single one
-    filenameSlashMassage(filenamei, FALSE);
+    bigFilenameNormalize(filenamei, filename);
 
     // There's a bug here - can you see it? See later if not. Unfortunately,
     // since the shipped .big files have this problem we can't fix it without
@@ -1033,7 +1446,7 @@ int bigPatch(char *oldfilename, char *newfilename, char *patchfilename, int cons
     Inputs      : bigfilename - filename of bigfile (to add or append to)
                   numFiles - # of filenames in following array
                   filenames - names of files to add
-                  optCompression - 1|0 compress
+                  optCompression - BF_COMPRESSION_ type to use
                   optNewer - 1|0 add files only if newer
                   optMove - 1|0 move (not just copy) files
                   optPathnames - 1|0 store full pathnames
@@ -1061,6 +1474,8 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
     char *filelistName = NULL;
     char filelistLine[BF_MAX_FILENAME_LENGTH+1];
     char filename[BF_MAX_FILENAME_LENGTH+1];
+    bigCompressor *compressor = NULL;
+    int fileIndex = 0;
 
     // temp file in case we need to abort
 #ifdef _WIN32
@@ -1128,6 +1543,22 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
     // keep track of files that need to be moved/deleted
     moveFiles = (int *)malloc(sizeof(int) * numFiles);
 
+    // compress everything up front on all cores, while we add in order
+    if (optCompression)
+    {
+        compressor = bigCompressorCreate(optCompression);
+        if (bigCompressorAddFiles(compressor, numFiles, filenames))
+        {
+            bigCompressorStart(compressor);
+        }
+        else
+        {
+            // the loop below will complain about the filelist
+            bigCompressorDestroy(compressor);
+            compressor = NULL;
+        }
+    }
+
     // add each file
     for (f = 0; f < numFiles; ++f)
     {
@@ -1144,6 +1575,7 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
                 if (consoleOutput)
                     printf("ERROR: Can't open filelist: %s\n", filelistName);
                 unlink(tempfilename);
+                bigCompressorDestroy(compressor);
                 free(moveFiles);
                 return 0;
             }
@@ -1186,12 +1618,23 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
             if (consoleOutput)
                 printf("  %s ", filename);
 
-            res = bigAddFile(tempfilename, filename, tempshortfilename, optCompression, optNewer, consoleOutput);
+            if (compressor)
+            {
+                res = bigAddFileData(tempfilename, filename, tempshortfilename,
+                                     bigCompressorWait(compressor, fileIndex), optNewer, consoleOutput);
+                bigCompressorRelease(compressor, fileIndex);
+                ++fileIndex;
+            }
+            else
+            {
+                res = bigAddFile(tempfilename, filename, tempshortfilename, optCompression, optNewer, consoleOutput);
+            }
             if (!res)
             {
                 //if (consoleOutput)
                 //  printf("\nERROR: Can't add %s\n", filename);
                 unlink(tempfilename);
+                bigCompressorDestroy(compressor);
                 free(moveFiles);
                 return 0;
             }
@@ -1235,6 +1678,8 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
             fclose(filelistFP);
     }
 
+    bigCompressorDestroy(compressor);
+
     // "move" (delete) files if necessary
     for (f = 0; f < numFiles; ++f)
         if (moveFiles[f])
@@ -1299,7 +1744,7 @@ int bigAdd(char *bigfilename, int numFiles, char *filenames[], int optCompressio
     Inputs      : bigfilename - filename of bigfile to create
                   numFiles - # of filenames in following array
                   filenames - names of files to add
-                  optCompression - 1|0 compress
+                  optCompression - BF_COMPRESSION_ type to use
                   optNewer - 1|0 add files only if newer
                   optMove - 1|0 move (not just copy) files
                   optPathnames - 1|0 store full pathnames
@@ -1331,6 +1776,8 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
     crc32 *crcAdded1 = NULL, *crcAdded2 = NULL;
     int dupe = 0;
     uword halfFilenameLength = 0;
+    bigCompressor *compressor = NULL;
+    bigCompressJob *job;
 
     // either update or create
     if (bigFileExists(bigfilename))
@@ -1375,6 +1822,12 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
     // keep track of files that need to be moved/deleted
     moveFiles = (int *)malloc(sizeof(int) * numFiles);
 
+    // files get queued for compression in pass 1, and picked up in pass 2
+    if (optCompression)
+    {
+        compressor = bigCompressorCreate(optCompression);
+    }
+
     //  do 4 passes : count files, write filecount, TOC headers, data
     for (pass = -1; pass < 3; ++pass)
     {
@@ -1395,6 +1848,7 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                         printf("ERROR: Can't open filelist: %s\n", filelistName);
                     }
                     
+                    bigCompressorDestroy(compressor);
                     free(moveFiles);
                     return 0;
                 }
@@ -1504,6 +1958,10 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                         {
                             continue;
                         }
+                        if (compressor)
+                        {
+                            bigCompressorAdd(compressor, filename);
+                        }
                         break;
                         
                     case 2:
@@ -1528,6 +1986,7 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                             
                             fclose(bigFP);
                             unlink(bigfilename);
+                            bigCompressorDestroy(compressor);
                             free(moveFiles);
                             return 0;
                         }
@@ -1539,36 +1998,42 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                         bigFilenameEncrypt(tempshortfilename);
                         fwrite((void *)(tempshortfilename), 1, fileEntry.nameLength+1, bigFP);
                         bigFilenameDecrypt(tempshortfilename, fileEntry.nameLength);
-                        dataFP = fopen(filename, "rb");
-                        if (!dataFP)
+                        if (compressor)
                         {
-                            if (consoleOutput)
+                            // compressed (or not) by now, or soon
+                            job = bigCompressorWait(compressor, filesAdded);
+                            if (job->failed)
                             {
-                                printf("ERROR: Can't read %s\n", filename);
+                                if (consoleOutput)
+                                {
+                                    printf("ERROR: Can't read %s\n", filename);
+                                }
+                                fclose(bigFP);
+                                unlink(bigfilename);
+                                bigCompressorDestroy(compressor);
+                                free(moveFiles);
+                                return 0;
                             }
-                            fclose(bigFP);
-                            unlink(bigfilename);
-                            free(moveFiles);
-                            return 0;
+                            fwrite(job->data, 1, job->storedLength, bigFP);
+                            fileEntry.compressionType = job->compressionType;
+                            fileEntry.realLength = job->realLength;
+                            compressedSize = job->storedLength;
+                            bigCompressorRelease(compressor, filesAdded);
                         }
-                        if (fileEntry.compressionType)
+                        else
                         {
-                            // compress and append
-                            BitFile *bitFile;
-                            bitFile = bitioFileAppendStart(bigFP);
-                            lzssCompressFile(dataFP, bitFile);
-                            compressedSize = bitioFileAppendStop(bitFile);
-                            //  revert to uncompressed if the file won't compress
-                            if ((float)compressedSize/(float)fileEntry.realLength > MINIMUM_COMPRESSION_RATIO)
+                            dataFP = fopen(filename, "rb");
+                            if (!dataFP)
                             {
-                                fileEntry.compressionType = 0;
-                                // theoretically, this could leave some harmless data at the end of a bigfile
-                                fseek(bigFP, curOffset + strlen(tempshortfilename)+1, SEEK_SET);
-                                fseek(dataFP, 0, SEEK_SET);
+                                if (consoleOutput)
+                                {
+                                    printf("ERROR: Can't read %s\n", filename);
+                                }
+                                fclose(bigFP);
+                                unlink(bigfilename);
+                                free(moveFiles);
+                                return 0;
                             }
-                        }
-                        if (!fileEntry.compressionType)
-                        {
                             // raw, uncompressed copy
                             while (1)
                             {
@@ -1580,8 +2045,8 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                                 }
                                 putc(ch, bigFP);
                             }
+                            fclose(dataFP);
                         }
-                        fclose(dataFP);
 
                         // TOC header entry
                         fseek(bigFP,   // overwrite placeholder from previous step
@@ -1590,7 +2055,7 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                                 sizeof(toc.flags) +
                                 (filesAdded * sizeof(bigTOCFileEntry)), SEEK_SET);
 
-                        fileEntry.storedLength = fileEntry.compressionType ? compressedSize : findData.st_size;
+                        fileEntry.storedLength = compressor ? compressedSize : findData.st_size;
                         fileEntry.offset = curOffset;
 
                         bigTOCFileEntryWrite(&fileEntry, bigFP);
@@ -1666,11 +2131,16 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                         + sizeof(toc.flags)
                         + (filesAdded * sizeof(bigTOCFileEntry));
                 filesAdded = 0;  // reset for final pass, to keep track of dupes
+                if (compressor)
+                {
+                    bigCompressorStart(compressor);
+                }
                 break;
         }
     }
 
     fclose(bigFP);
+    bigCompressorDestroy(compressor);
 
     if (consoleOutput)
     {
@@ -1739,7 +2209,7 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
                   storedFilename - name to store (could be shortr, with no path)
                                    (this will have its slashes massaged in place -- possibly
                                     resulting in a shorter name)
-                  optCompression - 1|0 compress
+                  optCompression - BF_COMPRESSION_ type to use
                   optNewer - 1|0 add file only if newer
                   consoleOutput - 1|0 = output to stdout (yes/no)
     Outputs     : Updated bigfile.
@@ -1752,33 +2222,57 @@ int bigFastCreate(char *bigfilename, int numFiles, char *filenames[], int optCom
 ----------------------------------------------------------------------------*/
 int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optCompression, int optNewer, int consoleOutput)
 {
-    char tempshortfilenamei[BF_MAX_FILENAME_LENGTH+1];
-    FILE *oldfp, *newfp, *datafp;
-    bigTOC oldtoc, newtoc;
-    bigTOCFileEntry fileEntry;
-#ifdef _WIN32
-    char tempFilename[L_tmpnam], compressedTempFilename[L_tmpnam];
-#else
-    char tempFilename[PATH_MAX], compressedTempFilename[PATH_MAX];
+    bigCompressJob job;
+    int res;
+
+    if (!optCompression)
+    {
+        return bigAddFileData(bigFilename, filename, storedFilename, NULL, optNewer, consoleOutput);
+    }
+
+    filenameSlashMassage(filename, TRUE);
+    memset(&job, 0, sizeof(job));
+    strncpy(job.filename, filename, BF_MAX_FILENAME_LENGTH);
+    bigCompressJobRun(&job, optCompression);
+
+    res = bigAddFileData(bigFilename, filename, storedFilename, &job, optNewer, consoleOutput);
+    free(job.data);
+    return res;
+}
+
+//
+//  Does the work for bigAddFile.  If job isn't NULL, it's the file data
+//  already read (and likely compressed) by bigCompressJobRun, otherwise
+//  the file is copied in uncompressed.
+//
+static int bigAddFileData(char *bigFilename, char *filename, char *storedFilename, bigCompressJob *job, int optNewer, int consoleOutput)
+{
+    char tempshortfilenamei[BF_MAX_FILENAME_LENGTH+1];
+    FILE *oldfp, *newfp, *datafp;
+    bigTOC oldtoc, newtoc;
+    bigTOCFileEntry fileEntry;
+#ifdef _WIN32
+    char tempFilename[L_tmpnam];
+#else
+    char tempFilename[PATH_MAX];
 #endif
     udword fileNum;
     int res = 0;
     sdword i;
     sdword offsetDelta;
     udword oldStoredLength;
-    struct stat findData, findDataCompressed;
+    struct stat findData;
     uword halfFilenameLength = 0;
 
     newtoc.fileEntries = (bigTOCFileEntry *)0;
 
     // temp file in case we need to abort
 #ifdef _WIN32
-    if (!tmpnam(tempFilename) || (optCompression && !tmpnam(compressedTempFilename)))
+    if (!tmpnam(tempFilename))
 #else
     strcpy(tempFilename, P_tmpdir);
     strcat(tempFilename, "/hwXXXXXX");
-    strcpy(compressedTempFilename, tempFilename);
-    if ((mkstemp(tempFilename) == -1) || (optCompression && (mkstemp(compressedTempFilename) == -1)))
+    if (mkstemp(tempFilename) == -1)
 #endif
     {
         if (consoleOutput)
@@ -1827,32 +2321,11 @@ int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optC
         goto abort;
     }
 
-    // compress file to temp file if required
-    if (optCompression)
+    if (job && job->failed)
     {
-        BitFile *bf = bitioFileOpenOutput(compressedTempFilename);
-        if (!bf)
-        {
-            if (consoleOutput)
-                printf("\nERROR: Can't create temporary file %s\n", compressedTempFilename);
-            goto abort;
-        }
-        datafp = fopen(filename, "rb");
-        if (!datafp)
-        {
-            if (consoleOutput)
-                printf("\nERROR: Can't open %s\n", filename);
-            goto abort;
-        }
-        lzssCompressFile(datafp, bf);
-        fclose(datafp);
-        bitioFileCloseOutput(bf);
-        if (stat(compressedTempFilename, &findDataCompressed) == -1)
-        {
-            if (consoleOutput)
-                printf("\nERROR: Can't find %s\n", filename);
-            goto abort;
-        }
+        if (consoleOutput)
+            printf("\nERROR: Can't open %s\n", filename);
+        goto abort;
     }
 
     // pretend name is lowercase for consistent CRCs
@@ -1868,10 +2341,10 @@ int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optC
     fileEntry.nameCRC1 = crc32Compute((ubyte *)tempshortfilenamei, halfFilenameLength);
     fileEntry.nameCRC2 = crc32Compute((ubyte *)tempshortfilenamei + halfFilenameLength,
                                       (fileEntry.nameLength - halfFilenameLength));
-    fileEntry.storedLength = optCompression ? findDataCompressed.st_size : findData.st_size;
-    fileEntry.realLength = findData.st_size;
+    fileEntry.storedLength = job ? job->storedLength : findData.st_size;
+    fileEntry.realLength = job ? job->realLength : findData.st_size;
     fileEntry.timeStamp = findData.st_mtime;
-    fileEntry.compressionType = optCompression;
+    fileEntry.compressionType = job ? job->compressionType : BF_COMPRESSION_NONE;
     // fileEntry.offset will be calculated later
 
     // update existing file
@@ -1928,20 +2401,25 @@ int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optC
         }
 
         // write new file data
-        datafp = fopen(optCompression ? compressedTempFilename : filename, "rb");
-        if (!datafp)
-        {
-            if (consoleOutput)
-                printf("\nERROR: Can't open %s\n", optCompression ? compressedTempFilename : filename);
-            goto abort;
-        }
         bigFilenameEncrypt(storedFilename);
         fwrite(storedFilename, 1, fileEntry.nameLength+1, newfp); // filename
         bigFilenameDecrypt(storedFilename, fileEntry.nameLength);
-        i = fileEntry.storedLength;
-        while (i--)
-            fputc(fgetc(datafp), newfp);
-        fclose(datafp);
+        if (job)
+            fwrite(job->data, 1, fileEntry.storedLength, newfp);
+        else
+        {
+            datafp = fopen(filename, "rb");
+            if (!datafp)
+            {
+                if (consoleOutput)
+                    printf("\nERROR: Can't open %s\n", filename);
+                goto abort;
+            }
+            i = fileEntry.storedLength;
+            while (i--)
+                fputc(fgetc(datafp), newfp);
+            fclose(datafp);
+        }
 
         // skip old data
         fseek(oldfp, oldStoredLength + fileEntry.nameLength + 1, SEEK_CUR);
@@ -2006,25 +2484,32 @@ int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optC
         }
 
         // write the new file data
-        datafp = fopen(optCompression ? compressedTempFilename : filename, "rb");
-        if (!datafp)
-        {
-            if (consoleOutput)
-            {
-                printf("\nERROR: Can't open %s\n", optCompression ? compressedTempFilename : filename);
-            }
-            
-            goto abort;
-        }
         bigFilenameEncrypt(storedFilename);
         fwrite(storedFilename, 1, fileEntry.nameLength+1, newfp); // filename
         bigFilenameDecrypt(storedFilename, fileEntry.nameLength);
-        i = fileEntry.storedLength;
-        while (i--)
+        if (job)
         {
-            fputc(fgetc(datafp), newfp);
+            fwrite(job->data, 1, fileEntry.storedLength, newfp);
+        }
+        else
+        {
+            datafp = fopen(filename, "rb");
+            if (!datafp)
+            {
+                if (consoleOutput)
+                {
+                    printf("\nERROR: Can't open %s\n", filename);
+                }
+                
+                goto abort;
+            }
+            i = fileEntry.storedLength;
+            while (i--)
+            {
+                fputc(fgetc(datafp), newfp);
+            }
+            fclose(datafp);
         }
-        fclose(datafp);
 
         res = BF_ADD_RES_ADDED;
     }
@@ -2065,19 +2550,6 @@ int bigAddFile(char *bigFilename, char *filename, char *storedFilename, int optC
         return 0;
     }
 
-    if (optCompression)
-    {
-        if(unlink(compressedTempFilename) == -1)
-        {
-            if (consoleOutput)
-            {
-                printf("\nERROR: Can't remove temporary file %s\n", compressedTempFilename);
-            }
-            
-            return 0;
-        }
-    }
-
     return res;
 
 abort:
@@ -2335,7 +2807,7 @@ int bigExtract(char *bigFilename, int numFiles, char *filenames[], int optFreshe
             printf("Extracting: %s", filename);
             
             // uncompress file if necessary
-            if (fileEntry->compressionType == '\1')
+            if (fileEntry->compressionType != BF_COMPRESSION_NONE)
             {
                 compressedFile   = (char *) malloc(fileEntry->storedLength);
                 uncompressedFile = (char *) malloc(fileEntry->realLength);
@@ -2343,8 +2815,8 @@ int bigExtract(char *bigFilename, int numFiles, char *filenames[], int optFreshe
                 if (compressedFile != NULL && uncompressedFile != NULL)
                 {
                     fread(compressedFile, 1, fileEntry->storedLength, extractFp);
-                    if (lzssExpandBuffer(compressedFile, fileEntry->storedLength,
-                                         uncompressedFile, fileEntry->realLength) == -1)
+                    if (bigExpandBuffer(fileEntry->compressionType, compressedFile, fileEntry->storedLength,
+                                        uncompressedFile, fileEntry->realLength) != (int)fileEntry->realLength)
                     {
                         printf(" - DECOMPRESSION FAILED!\n");
                         
@@ -2483,6 +2955,205 @@ abort:
 //
 #ifdef BF_HOMEWORLD
 
+//
+//  Map a whole opened bigfile read-only.  If the mapping can't be made the
+//  archive is just read through its FILE * as usual.
+//
+static void bigFileMap(bigFileConfiguration *bigFile)
+{
+    long length;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+
+    fseek(bigFile->filePtr, 0, SEEK_END);
+    length = ftell(bigFile->filePtr);
+    if (length <= 0)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    mapping = CreateFileMapping((HANDLE)_get_osfhandle(_fileno(bigFile->filePtr)), NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        bigFile->mapBase = (ubyte *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);                               // the view keeps the mapping alive
+    }
+#else
+    bigFile->mapBase = (ubyte *)mmap(NULL, length, PROT_READ, MAP_SHARED, fileno(bigFile->filePtr), 0);
+    if (bigFile->mapBase == (ubyte *)MAP_FAILED)
+    {
+        bigFile->mapBase = NULL;
+    }
+#endif
+
+    if (bigFile->mapBase == NULL)
+    {
+        dbgMessagef("Unable to map %s, reading it through stdio", bigFile->bigFileName);
+        return;
+    }
+    bigFile->mapLength = (udword)length;
+    bigFile->mapRefs   = 0;
+}
+
+//
+//  Undo bigFileMap.  Anything still pointing into the mapping is left dangling,
+//  so complain about it.
+//
+static void bigFileUnmap(bigFileConfiguration *bigFile)
+{
+    if (bigFile->mapBase == NULL)
+    {
+        return;
+    }
+
+    if (bigFile->mapRefs != 0)
+    {
+        dbgMessagef("%s unmapped with %d references outstanding", bigFile->bigFileName, bigFile->mapRefs);
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(bigFile->mapBase);
+#else
+    munmap(bigFile->mapBase, bigFile->mapLength);
+#endif
+    bigFile->mapBase   = NULL;
+    bigFile->mapLength = 0;
+    bigFile->mapRefs   = 0;
+}
+
+//
+//  Build the filename hash for an opened bigfile.  The names stored in front
+//  of each file's data are read once, normalized and checked against their
+//  TOC CRCs; if anything doesn't add up the archive is left without an index
+//  and lookups fall back to searching the TOC by CRC.
+//
+static bigTOCIndex *bigTOCIndexBuild(bigFileConfiguration *bigFile)
+{
+    bigTOC *toc = &bigFile->tableOfContents;
+    bigTOCFileEntry *entry;
+    bigTOCIndex *index;
+    udword numSlots, namesLength, slot, hash, length, half;
+    char storedName[BF_MAX_FILENAME_LENGTH + 1];
+    char *name;
+    sdword fileNum;
+
+    if (toc->numFiles <= 0)
+    {
+        return NULL;
+    }
+
+    for (numSlots = 16; numSlots < (udword)toc->numFiles * 2; numSlots <<= 1) { }
+
+    namesLength = 0;
+    for (fileNum = 0; fileNum < toc->numFiles; fileNum++)
+    {
+        namesLength += toc->fileEntries[fileNum].nameLength + 1;
+    }
+
+    index = memAlloc(sizeof(bigTOCIndex) + toc->numFiles * sizeof(char *) +
+                     numSlots * (sizeof(udword) + sizeof(sdword)) + namesLength,
+                     "bigTOCIndex", NonVolatile);
+    index->numSlots = numSlots;
+    index->fileName = (char **)(index + 1);
+    index->slotHash = (udword *)(index->fileName + toc->numFiles);
+    index->slotFile = (sdword *)(index->slotHash + numSlots);
+    name            = (char *)(index->slotFile + numSlots);
+    memset(index->slotFile, 0xff, numSlots * sizeof(sdword));  // -1 = empty
+
+    for (fileNum = 0; fileNum < toc->numFiles; fileNum++)
+    {
+        entry = &toc->fileEntries[fileNum];
+
+        if (entry->nameLength > BF_MAX_FILENAME_LENGTH)
+        {
+            goto failed;
+        }
+        if (bigFile->mapBase != NULL)
+        {
+            if (entry->offset + entry->nameLength > bigFile->mapLength)
+            {
+                goto failed;
+            }
+            memcpy(storedName, bigFile->mapBase + entry->offset, entry->nameLength);
+        }
+        else
+        {
+            fseek(bigFile->filePtr, entry->offset, SEEK_SET);
+            if (fread(storedName, 1, entry->nameLength, bigFile->filePtr) != entry->nameLength)
+            {
+                goto failed;
+            }
+        }
+        bigFilenameDecrypt(storedName, entry->nameLength);
+        storedName[entry->nameLength] = 0;
+
+        length = bigFilenameNormalize(name, storedName);
+
+        // the name has to be the one the CRC was made from (either way of computing it)
+        half = length / 2;
+        if (length != entry->nameLength ||
+            entry->nameCRC1 != crc32Compute((ubyte *)name, half) ||
+            (entry->nameCRC2 != crc32Compute((ubyte *)name + half, half) &&
+             entry->nameCRC2 != crc32Compute((ubyte *)name + half, length - half)))
+        {
+            goto failed;
+        }
+
+        index->fileName[fileNum] = name;
+
+        hash = crc32Compute((ubyte *)name, length);
+        for (slot = hash & (numSlots - 1); index->slotFile[slot] != -1; slot = (slot + 1) & (numSlots - 1))
+        {
+            if (index->slotHash[slot] == hash && !strcmp(index->fileName[index->slotFile[slot]], name))
+            {
+                break;                                      // duplicate entry, first one wins
+            }
+        }
+        if (index->slotFile[slot] == -1)
+        {
+            index->slotHash[slot] = hash;
+            index->slotFile[slot] = fileNum;
+        }
+
+        name += length + 1;
+    }
+
+    return index;
+
+failed:
+    dbgMessagef("Unable to index the filenames of %s, searching its TOC instead", bigFile->bigFileName);
+    memFree(index);
+    return NULL;
+}
+
+//
+//  Look up a normalized filename (see bigFilenameNormalize) in one opened
+//  bigfile.  hash is crc32Compute of the normalized name.
+//
+static bool bigFileLookup(bigFileConfiguration *bigFile, char *filenamei, udword hash, udword *fileNum)
+{
+    bigTOCIndex *index = bigFile->tocIndex;
+    udword slot;
+
+    if (index == NULL)
+    {
+        return bigTOCFileExists(&bigFile->tableOfContents, filenamei, fileNum);
+    }
+
+    for (slot = hash & (index->numSlots - 1); index->slotFile[slot] != -1; slot = (slot + 1) & (index->numSlots - 1))
+    {
+        if (index->slotHash[slot] == hash && !strcmp(index->fileName[index->slotFile[slot]], filenamei))
+        {
+            *fileNum = index->slotFile[slot];
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 bool bigOpenAllBigFiles(void)
 {
     udword bigfile_i = 0;
@@ -2541,6 +3212,13 @@ bool bigOpenAllBigFiles(void)
                            
             memset(bigFilePrecedence[bigfile_i].localFileRelativeAge,
                 0, bigFilePrecedence[bigfile_i].tableOfContents.numFiles);  // 0 = LOCAL_FILE_DOES_NOT_EXIST
+
+            if (MapBigfiles)
+            {
+                bigFileMap(&bigFilePrecedence[bigfile_i]);
+            }
+
+            bigFilePrecedence[bigfile_i].tocIndex = bigTOCIndexBuild(&bigFilePrecedence[bigfile_i]);
         }
     }
     
@@ -2554,24 +3232,19 @@ bool bigOpenAllBigFiles(void)
 //  If there's any other problem, return -1.  Otherwise, return
 //  the number of bytes allocated and loaded.
 //
-sdword bigFileLoadAlloc(bigTOC *toc, FILE *bigFP, char *filename, udword fileNum, void **address)
+sdword bigFileLoadAlloc(bigFileConfiguration *bigFile, char *filename, udword fileNum, void **address)
 {
     sdword length;
     bigTOCFileEntry *entry;
     char *memoryName;
-    int expandedSize, storedSize;
-    BitFile *bitFile;
 
     if (IgnoreBigfiles)
     {
         return -1;
     }
     
-    // go there
-    entry = toc->fileEntries + fileNum;
-    fseek(bigFP, entry->offset + entry->nameLength+1, SEEK_SET);
-
     // allocate
+    entry = bigFile->tableOfContents.fileEntries + fileNum;
     length = entry->realLength;
     dbgAssertOrIgnore(length > 0);
     if (entry->nameLength > MEM_NameLength)
@@ -2589,11 +3262,67 @@ sdword bigFileLoadAlloc(bigTOC *toc, FILE *bigFP, char *filename, udword fileNum
         dbgFatalf(DBG_Loc, "bigFileLoadAlloc: couldn't allocate %d bytes for %s", length, filename);
     }
     
-    if (entry->compressionType)
+    return bigFileLoad(bigFile, fileNum, *address);
+}
+
+//
+//  Load a file into memory.
+//  If there's any problem, return -1.  Otherwise, return
+//  the number of bytes loaded.
+//
+sdword bigFileLoad(bigFileConfiguration *bigFile, udword fileNum, void *address)
+{
+    sdword length;
+    bigTOCFileEntry *entry;
+    int expandedSize;
+    udword storedSize;
+    BitFile *bitFile;
+    ubyte *data;
+
+    if (IgnoreBigfiles)
+    {
+        return -1;
+    }
+    
+    entry = bigFile->tableOfContents.fileEntries + fileNum;
+    length = entry->realLength;
+    dbgAssertOrIgnore(length > 0);
+
+    if (bigFile->mapBase != NULL)
+    {
+        // straight out of the mapping
+        data = bigFile->mapBase + entry->offset + entry->nameLength + 1;
+        dbgAssertOrIgnore(data + entry->storedLength <= bigFile->mapBase + bigFile->mapLength);
+
+        if (entry->compressionType)
+        {
+            expandedSize = bigExpandBuffer(entry->compressionType, (char *)data, entry->storedLength, address, length);
+            dbgAssertOrIgnore(expandedSize == length);
+        }
+        else
+        {
+            memcpy(address, data, length);
+        }
+        return length;
+    }
+
+    // go there
+    fseek(bigFile->filePtr, entry->offset + entry->nameLength+1, SEEK_SET);
+
+    if (entry->compressionType == BF_COMPRESSION_LZFAST)
+    {
+        // decodes from memory, so stage the compressed data
+        data = memAlloc(entry->storedLength, "bigLZFast", 0);
+        fread(data, 1, entry->storedLength, bigFile->filePtr);
+        expandedSize = lzfExpandBuffer((char *)data, entry->storedLength, address, length);
+        memFree(data);
+        dbgAssertOrIgnore(expandedSize == length);
+    }
+    else if (entry->compressionType)
     {
         // expand compressed file data directly into memory
-        bitFile = bitioFileInputStart(bigFP);
-        expandedSize = lzssExpandFileToBuffer(bitFile, *address, length);
+        bitFile = bitioFileInputStart(bigFile->filePtr);
+        expandedSize = lzssExpandFileToBuffer(bitFile, address, length);
         storedSize = bitioFileInputStop(bitFile);
         dbgAssertOrIgnore(expandedSize == length);
         dbgAssertOrIgnore(storedSize == entry->storedLength);
@@ -2601,52 +3330,160 @@ sdword bigFileLoadAlloc(bigTOC *toc, FILE *bigFP, char *filename, udword fileNum
     else
     {
         // load uncompressed file data
-        fread(*address, 1, length, bigFP);
+        fread(address, 1, length, bigFile->filePtr);
     }
 
     return length;
 }
 
 //
-//  Load a file into memory.
-//  If there's any problem, return -1.  Otherwise, return
-//  the number of bytes loaded.
+//  Thread-safe version of bigFileLoad for the prefetch workers.  Reads
+//  from the mapping when there is one, otherwise with positional reads
+//  that leave the shared FILE * alone, and never touches the memory
+//  module (compressed data is staged in a malloc'd buffer).  Returns -1
+//  if the file can't be loaded this way and must go through bigFileLoad
+//  on the main thread.
 //
-sdword bigFileLoad(bigTOC *toc, FILE *bigFP, udword fileNum, void *address)
+sdword bigFileLoadConcurrent(bigFileConfiguration *bigFile, udword fileNum, void *address)
 {
     sdword length;
     bigTOCFileEntry *entry;
-    int expandedSize, storedSize;
-    BitFile *bitFile;
+    ubyte *data;
+    sdword result;
+#ifndef _WIN32
+    off_t offset;
+    ssize_t bytesRead;
+    udword bytesTotal;
+#endif
 
     if (IgnoreBigfiles)
     {
         return -1;
     }
-    
-    // go there
-    entry = toc->fileEntries + fileNum;
-    fseek(bigFP, entry->offset + entry->nameLength+1, SEEK_SET);
 
+    entry = bigFile->tableOfContents.fileEntries + fileNum;
     length = entry->realLength;
-    dbgAssertOrIgnore(length > 0);
+    if (length <= 0)
+    {
+        return -1;
+    }
+
+    if (bigFile->mapBase != NULL)
+    {
+        data = bigFile->mapBase + entry->offset + entry->nameLength + 1;
+        if (data + entry->storedLength > bigFile->mapBase + bigFile->mapLength)
+        {
+            return -1;
+        }
+        if (entry->compressionType)
+        {
+            result = bigExpandBuffer(entry->compressionType, (char *)data, entry->storedLength, address, length);
+            return (result == length) ? length : -1;
+        }
+        memcpy(address, data, length);
+        return length;
+    }
 
+#ifdef _WIN32
+    // no pread; ReadFile on the CRT handle would move the position
+    // bigFileLoad relies on, so unmapped bigfiles load on the main thread
+    return -1;
+#else
     if (entry->compressionType)
     {
-        // expand compressed file data directly into memory
-        bitFile = bitioFileInputStart(bigFP);
-        expandedSize = lzssExpandFileToBuffer(bitFile, address, length);
-        storedSize = bitioFileInputStop(bitFile);
-        dbgAssertOrIgnore(expandedSize == length);
-        dbgAssertOrIgnore(storedSize == entry->storedLength);
+        data = malloc(entry->storedLength);
+        if (data == NULL)
+        {
+            return -1;
+        }
     }
     else
     {
-        // load uncompressed file data
-        fread(address, 1, length, bigFP);
+        data = address;
     }
 
-    return length;
+    offset = entry->offset + entry->nameLength + 1;
+    for (bytesTotal = 0; bytesTotal < entry->storedLength; bytesTotal += bytesRead)
+    {
+        bytesRead = pread(fileno(bigFile->filePtr), data + bytesTotal,
+                          entry->storedLength - bytesTotal, offset + bytesTotal);
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+    }
+
+    result = length;
+    if (bytesTotal != entry->storedLength)
+    {
+        result = -1;
+    }
+    else if (entry->compressionType)
+    {
+        if (bigExpandBuffer(entry->compressionType, (char *)data, entry->storedLength, address, length) != length)
+        {
+            result = -1;
+        }
+    }
+
+    if (data != address)
+    {
+        free(data);
+    }
+    return result;
+#endif
+}
+
+//
+//  Return a pointer to an uncompressed file's data inside the bigfile
+//  mapping, taking a reference on the mapping.  The data is read-only and
+//  must be handed back with bigFileMapRelease.  Returns NULL if the bigfile
+//  isn't mapped or the file is compressed.
+//
+ubyte *bigFileMapAcquire(bigFileConfiguration *bigFile, udword fileNum)
+{
+    bigTOCFileEntry *entry;
+
+    if (IgnoreBigfiles || bigFile->mapBase == NULL)
+    {
+        return NULL;
+    }
+
+    entry = bigFile->tableOfContents.fileEntries + fileNum;
+    if (entry->compressionType)
+    {
+        return NULL;
+    }
+    dbgAssertOrIgnore(entry->offset + entry->nameLength + 1 + entry->realLength <= bigFile->mapLength);
+
+    bigFile->mapRefs++;
+    return bigFile->mapBase + entry->offset + entry->nameLength + 1;
+}
+
+//
+//  Drop a reference taken by bigFileMapAcquire.  Returns FALSE if the
+//  address isn't inside any bigfile mapping (so it must be a memAlloc'd
+//  block).
+//
+bool bigFileMapRelease(void *address)
+{
+    udword bigfile_i = 0;
+    bigFileConfiguration *bigFile;
+
+    for (bigfile_i = 0; bigfile_i < NUMBER_CONFIGURED_BIG_FILES; ++bigfile_i)
+    {
+        bigFile = &bigFilePrecedence[bigfile_i];
+        if (bigFile->mapBase != NULL &&
+            (ubyte *)address >= bigFile->mapBase &&
+            (ubyte *)address <  bigFile->mapBase + bigFile->mapLength)
+        {
+            dbgAssertOrIgnore(bigFile->mapRefs > 0);
+            bigFile->mapRefs--;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
 }
 
 //
@@ -2690,6 +3527,7 @@ void bigFilesystemCompare(char *baseDirectory, char *directory)
 #endif  // _WIN32
     char filespec[PATH_MAX];
     char subpath[PATH_MAX];
+    char subpathi[PATH_MAX];
     udword fileNum;
     udword bigfile_i = 0;
     static udword compared = 0;
@@ -2731,11 +3569,13 @@ void bigFilesystemCompare(char *baseDirectory, char *directory)
         else
         {
             udword bigfile_i = 0;
-            
+            udword hash;
+
+            hash = crc32Compute((ubyte *)subpathi, bigFilenameNormalize(subpathi, subpath));
+
             for (bigfile_i = 0; bigfile_i < NUMBER_CONFIGURED_BIG_FILES; ++bigfile_i)
             {
-                if (bigTOCFileExists(&bigFilePrecedence[bigfile_i].tableOfContents,
-                                     subpath, &fileNum))
+                if (bigFileLookup(&bigFilePrecedence[bigfile_i], subpathi, hash, &fileNum))
                 {
                     bigFilePrecedence[bigfile_i].localFileRelativeAge[fileNum]
                         = (bigFilePrecedence[bigfile_i].tableOfContents.fileEntries[fileNum].timeStamp < findData.time_write)
@@ -2796,11 +3636,13 @@ void bigFilesystemCompare(char *baseDirectory, char *directory)
         else
         {
             udword bigfile_i = 0;
-            
+            udword hash;
+
+            hash = crc32Compute((ubyte *)subpathi, bigFilenameNormalize(subpathi, subpath));
+
             for (bigfile_i = 0; bigfile_i < NUMBER_CONFIGURED_BIG_FILES; ++bigfile_i)
             {
-                if (bigTOCFileExists(&bigFilePrecedence[bigfile_i].tableOfContents,
-                                     subpath, &fileNum))
+                if (bigFileLookup(&bigFilePrecedence[bigfile_i], subpathi, hash, &fileNum))
                 {
                     bigFilePrecedence[bigfile_i].localFileRelativeAge[fileNum]
                         = (bigFilePrecedence[bigfile_i].tableOfContents.fileEntries[fileNum].timeStamp < file_stat.st_mtime)
@@ -2846,15 +3688,20 @@ void bigFilesystemCompare(char *baseDirectory, char *directory)
 bool bigFindFile(char *filename, bigFileConfiguration **whereFound, udword *fileIndex)
 {
     udword bigfile_i = 0;
+    char filenamei[PATH_MAX];
+    udword hash;
     
-    if (IgnoreBigfiles)
+    if (IgnoreBigfiles || filename == NULL || filename[0] == 0)
     {
         return FALSE;
     }
+
+    // normalize and hash once for all the bigfiles
+    hash = crc32Compute((ubyte *)filenamei, bigFilenameNormalize(filenamei, filename));
     
     for (bigfile_i = 0; bigfile_i < NUMBER_CONFIGURED_BIG_FILES; ++bigfile_i)
     {
-        if (bigTOCFileExists(&(bigFilePrecedence[bigfile_i].tableOfContents), filename, fileIndex))
+        if (bigFileLookup(&bigFilePrecedence[bigfile_i], filenamei, hash, fileIndex))
         {
             if (bigFilePrecedence[bigfile_i].localFileRelativeAge[*fileIndex] != LOCAL_FILE_IS_NEWER)
             {
@@ -2876,6 +3723,14 @@ void bigCloseAllBigFiles(void)
     
     for (bigfile_i = 0; bigfile_i < NUMBER_CONFIGURED_BIG_FILES; ++bigfile_i)
     {
+        bigFileUnmap(&bigFilePrecedence[bigfile_i]);
+
+        if (bigFilePrecedence[bigfile_i].tocIndex != NULL)
+        {
+            memFree(bigFilePrecedence[bigfile_i].tocIndex);
+            bigFilePrecedence[bigfile_i].tocIndex = NULL;
+        }
+
         if (bigFilePrecedence[bigfile_i].filePtr != NULL)
         {
             fclose(bigFilePrecedence[bigfile_i].filePtr);
@@ -62,6 +62,11 @@
 //  1.23    1998/11/23  Darren Stone
 //          Fixed fast-create sorting bug.
 // Gary changed interface of bigCRC function
+//          2026/10/16
+//          Added LZFast compression type (byte-aligned, fast in-memory decode).
+//          Fast-create and add now compress files on all cores.
+//          (File layout unchanged, so the version stays; archives using LZFast
+//          need a game that knows compression type 2.)
 
 // keep these strings the same length
 #define BF_VERSION     "1.23"   // increment this when the file format changes
@@ -78,6 +83,14 @@
 #define BF_MAX_FILENAME_LENGTH 128
 #define BF_FLAG_TOC_SORTED       1
 
+// bigTOCFileEntry.compressionType
+#define BF_COMPRESSION_NONE      0
+#define BF_COMPRESSION_LZSS      1   // bit-oriented LZSS (LZSS.c)
+#define BF_COMPRESSION_LZFAST    2   // byte-aligned LZ77 (LZFast.c)
+#define BF_COMPRESSION_MAX       BF_COMPRESSION_LZFAST
+
+#define BF_MAX_COMPRESS_THREADS  16
+
 #define bigCRC64EQ(a, b)  (((a)->nameCRC1 == (b)->nameCRC1) && ((a)->nameCRC2 == (b)->nameCRC2))
 #define bigCRC64GT(a, b)  (((a)->nameCRC1 > (b)->nameCRC1) || ((a)->nameCRC1 == (b)->nameCRC1 && (a)->nameCRC2 > (b)->nameCRC2))
 #define bigCRC64LT(a, b)  (((a)->nameCRC1 < (b)->nameCRC1) || ((a)->nameCRC1 == (b)->nameCRC1 && (a)->nameCRC2 < (b)->nameCRC2))
@@ -98,7 +111,7 @@ typedef struct
     udword offset;
 //    time_t timeStamp;
     udword timeStamp;
-    char compressionType;  // 0/1
+    char compressionType;  // BF_COMPRESSION_
 } bigTOCFileEntry;
 
 typedef struct {
@@ -117,6 +130,17 @@ typedef enum
 }
 bigLocalFileAgeComparison;
 
+//  in-game lookup table for an opened bigfile: an open-addressing hash of the
+//  stored filenames (lowercase, backslashed), built once when the file is opened
+typedef struct
+{
+    udword  numSlots;                                    // power of two, at least twice the number of files
+    char  **fileName;                                    // normalized name of each file, by TOC file number
+    udword *slotHash;                                    // CRC of the name in each slot
+    sdword *slotFile;                                    // TOC file number in each slot, or -1 if empty
+}
+bigTOCIndex;
+
 typedef struct 
 {
     char   *bigFileName;
@@ -124,6 +148,10 @@ typedef struct
     FILE   *filePtr;
     bigTOC  tableOfContents;
     bigLocalFileAgeComparison  *localFileRelativeAge;   // array with TOC file number as index
+    ubyte  *mapBase;                                     // read-only mapping of the whole archive (/mapBigfiles), or NULL
+    udword  mapLength;
+    sdword  mapRefs;                                     // pointers into the mapping that haven't been released
+    bigTOCIndex *tocIndex;                               // filename hash, or NULL to search the TOC by CRC
 }
 bigFileConfiguration;
 
@@ -158,8 +186,12 @@ crc32 bigTOCCRC(bigTOC *toc);
     void bigFilesystemCompare(char *baseDirectory, char *directory);
     bool bigFindFile(char *filename, bigFileConfiguration **whereFound, udword *fileIndex);
 
-    sdword bigFileLoadAlloc(bigTOC *toc, FILE *bigFP, char *filename, udword fileNum, void **address);
-    sdword bigFileLoad(bigTOC *toc, FILE *bigFP, udword fileNum, void *address);
+    sdword bigFileLoadAlloc(bigFileConfiguration *bigFile, char *filename, udword fileNum, void **address);
+    sdword bigFileLoad(bigFileConfiguration *bigFile, udword fileNum, void *address);
+    sdword bigFileLoadConcurrent(bigFileConfiguration *bigFile, udword fileNum, void *address);
+
+    ubyte *bigFileMapAcquire(bigFileConfiguration *bigFile, udword fileNum);
+    bool bigFileMapRelease(void *address);
 #endif
 
 #endif
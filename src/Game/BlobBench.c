@@ -0,0 +1,210 @@
+// =============================================================================
+//  BlobBench.c
+//  - headless blob clustering benchmark, fills a mission with asteroids and
+//    times full rebuilds of the collision blobs with and without the k-d tree
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "BlobBench.h"
+
+#include <stdio.h>
+
+#include "Blobs.h"
+#include "Collision.h"
+#include "CRC32.h"
+#include "Globals.h"
+#include "main.h"
+#include "Sensors.h"
+#include "SimBench.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "UnivUpdate.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool blobBenchEnabled = FALSE;
+static udword blobBenchObjects = BLOBBENCH_DEFAULT_OBJECTS;
+
+//own random numbers so the layout is the same every run and the game's
+//random number streams aren't disturbed
+static udword blobBenchSeed = 0x1234567;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchSet
+    Description : Command-line handler for /blobBench <nObjects>
+    Inputs      : string - number of asteroids to add
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool blobBenchSet(char *string)
+{
+    sscanf(string, "%u", &blobBenchObjects);
+    if (blobBenchObjects == 0)
+    {
+        blobBenchObjects = BLOBBENCH_DEFAULT_OBJECTS;
+    }
+    blobBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchRandom
+    Description : Returns a random number from low to high
+    Inputs      : low, high - range of the number
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static real32 blobBenchRandom(real32 low, real32 high)
+{
+    blobBenchSeed = blobBenchSeed * 1664525 + 1013904223;
+    return(low + (high - low) * (real32)(blobBenchSeed >> 8) / (real32)(1 << 24));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchPopulate
+    Description : Adds asteroids to the universe, half of them in clumps and
+                  the rest scattered over the whole mission sphere, like a
+                  big resource field.
+    Inputs      :
+    Outputs     :
+    Return      : number of asteroids added
+----------------------------------------------------------------------------*/
+static udword blobBenchPopulate(void)
+{
+    vector clusters[BLOBBENCH_CLUSTERS];
+    vector position;
+    udword index, nAdded = 0;
+
+    for (index = 0; index < BLOBBENCH_CLUSTERS; index++)
+    {
+        clusters[index].x = blobBenchRandom(-smUniverseSizeX, smUniverseSizeX) * 0.8f;
+        clusters[index].y = blobBenchRandom(-smUniverseSizeY, smUniverseSizeY) * 0.8f;
+        clusters[index].z = blobBenchRandom(-smUniverseSizeZ, smUniverseSizeZ) * 0.8f;
+    }
+
+    for (index = 0; index < blobBenchObjects; index++)
+    {
+        if (index & 1)
+        {
+            position = clusters[index / 2 % BLOBBENCH_CLUSTERS];
+            position.x += blobBenchRandom(-BLOBBENCH_CLUSTER_SIZE, BLOBBENCH_CLUSTER_SIZE);
+            position.y += blobBenchRandom(-BLOBBENCH_CLUSTER_SIZE, BLOBBENCH_CLUSTER_SIZE);
+            position.z += blobBenchRandom(-BLOBBENCH_CLUSTER_SIZE, BLOBBENCH_CLUSTER_SIZE);
+        }
+        else
+        {
+            position.x = blobBenchRandom(-smUniverseSizeX, smUniverseSizeX) * 0.9f;
+            position.y = blobBenchRandom(-smUniverseSizeY, smUniverseSizeY) * 0.9f;
+            position.z = blobBenchRandom(-smUniverseSizeZ, smUniverseSizeZ) * 0.9f;
+        }
+        if (univAddAsteroid(Asteroid1 + index % (NUM_ASTEROIDTYPES - Asteroid1), &position) != NULL)
+        {
+            nAdded++;
+        }
+    }
+    return(nAdded);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchChecksum
+    Description : Computes a checksum of the collision blobs' positions and
+                  sizes so the two ways of building them can be compared.
+    Inputs      :
+    Outputs     :
+    Return      : the checksum
+----------------------------------------------------------------------------*/
+static udword blobBenchChecksum(void)
+{
+    Node *node;
+    blob *thisBlob;
+    udword checksum = 0;
+
+    for (node = universe.collBlobList.head; node != NULL; node = node->next)
+    {
+        thisBlob = (blob *)listGetStructOfNode(node);
+        checksum = checksum * 31 + crc32Compute((ubyte *)&thisBlob->centre, sizeof(vector) + sizeof(real32));
+        checksum = checksum * 31 + (udword)thisBlob->maxNumObjects;
+    }
+    return(checksum);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchRebuild
+    Description : Times full rebuilds of the collision blobs, like the spike
+                  the first frame of a mission or a saved game load costs.
+    Inputs      : kdTree - whether bobListUpdate may use a k-d tree
+                  average, worst - where to return the times, in microseconds
+    Outputs     :
+    Return      : checksum of the last blobs built
+----------------------------------------------------------------------------*/
+static udword blobBenchRebuild(bool kdTree, sqword *average, sqword *worst)
+{
+    sqword timeStart, timeStop, total = 0;
+    udword rebuild;
+
+    bobKdTreeEnabled = kdTree;
+    *worst = 0;
+    for (rebuild = 0; rebuild < BLOBBENCH_REBUILDS; rebuild++)
+    {
+        universe.collUpdateAllBlobs = TRUE;
+        GetRawTime(&timeStart);
+        collUpdateCollBlobs();
+        GetRawTime(&timeStop);
+
+        total += timeStop - timeStart;
+        *worst = max(*worst, timeStop - timeStart);
+    }
+    *average = total / BLOBBENCH_REBUILDS;
+    bobKdTreeEnabled = TRUE;
+
+    return(blobBenchChecksum());
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : blobBenchRun
+    Description : Fills the first mission with asteroids and times rebuilding
+                  the collision blobs from scratch by walking the sorted list
+                  and with the k-d tree.  The two should build the same
+                  blobs.  Called from main instead of the event loop when
+                  /blobBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword blobBenchRun(void)
+{
+    sqword walkAverage, walkWorst, treeAverage, treeWorst;
+    udword nAdded, walkChecksum, treeChecksum;
+
+    if (!benchSinglePlayerStart())
+    {
+        printf("BlobBench: mission didn't start\n");
+        return -1;
+    }
+
+    nAdded = blobBenchPopulate();
+
+    walkChecksum = blobBenchRebuild(FALSE, &walkAverage, &walkWorst);
+    treeChecksum = blobBenchRebuild(TRUE, &treeAverage, &treeWorst);
+
+    printf("BlobBench: %u asteroids added, %d objects, %d collision blobs, %d rebuilds each way\n",
+           nAdded, universe.SpaceObjList.num, universe.collBlobList.num, BLOBBENCH_REBUILDS);
+    printf("  list walk: %8.2f ms average, %8.2f ms worst\n", (real64)walkAverage / 1000.0, (real64)walkWorst / 1000.0);
+    printf("  k-d tree:  %8.2f ms average, %8.2f ms worst%s\n", (real64)treeAverage / 1000.0, (real64)treeWorst / 1000.0,
+           universe.SpaceObjList.num < BOB_KdTreeMinimum ? " (too few objects, tree not used)" : "");
+    printf("  blobs %s\n", walkChecksum == treeChecksum ? "identical" : "DIFFER");
+
+    gameEnd();
+    gameIsRunning = FALSE;
+
+    return (walkChecksum == treeChecksum) ? 0 : -1;
+}
@@ -0,0 +1,37 @@
+// =============================================================================
+//  BlobBench.h
+//  - headless blob clustering benchmark, fills a mission with asteroids and
+//    times full rebuilds of the collision blobs with and without the k-d tree
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___BLOBBENCH_H
+#define ___BLOBBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define BLOBBENCH_DEFAULT_OBJECTS   5000
+#define BLOBBENCH_CLUSTERS          40              // clumps half the asteroids are put in
+#define BLOBBENCH_CLUSTER_SIZE      4000.0f         // radius of a clump
+#define BLOBBENCH_REBUILDS          10              // full rebuilds timed each way
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool blobBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool blobBenchSet(char *string);
+
+sdword blobBenchRun(void);
+
+#endif
@@ -65,12 +65,38 @@ void bobListUpdateStatsCloseFunc()
 
 #endif
 
+/*=============================================================================
+    Private types:
+=============================================================================*/
+
+//k-d tree over the blob centres for the first pass of bobListUpdate
+typedef struct bobkdnode
+{
+    vector min, max;                            //bounds of the blob centres in this subtree
+    real32 maxRadius;                           //biggest blob radius in this subtree
+    sdword minOrdinal, maxOrdinal;              //range of list positions in this subtree
+} bobkdnode;
+
+typedef struct bobkdtree
+{
+    sdword nBlobs;
+    sdword nLeaves;                             //power of 2 at least as big as nBlobs
+    bobkdnode *nodes;                           //node for the range lo..hi-1 of order is at (lo+hi)/2
+    blob **blobs;                               //by list position
+    real32 *sqrtSortDistance;                   //by list position
+    real32 *farthest;                           //biggest sqrtSortDistance of the remaining blobs, binary tree over list positions
+    sdword *order;                              //list positions in tree order
+    ubyte *absorbed;                            //by list position, TRUE once combined into another blob
+} bobkdtree;
+
 /*=============================================================================
     Data:
 =============================================================================*/
 
 static BlobProperties *BlobPropertiesPtr;
 
+bool bobKdTreeEnabled = TRUE;                   //FALSE to always walk the list in bobListUpdate
+
 real32 bobUpdateRadiusThreshold = BOB_UpdateRadiusThreshold;
 real32 bobUpdateCentreThreshold = BOB_UpdateCentreThreshold;
 //vector bobOriginVector = {0.0f, 0.0f, 0.0f};
@@ -569,8 +595,8 @@ void bobSubBlobListCreate(BlobProperties *blobProperties, LinkedList *list, blob
     }
 
     //first pass: create a sphere structure for each ship
-    preallocBlobs = memAlloc(bobBlobSize(1)*superBlob->blobObjects->numSpaceObjs,"MassAllocBlobs",0);
-    preallocObjSelection = memAlloc(sizeof(SelectCommand)*superBlob->blobObjects->numSpaceObjs,"MassAllocSel",0);
+    preallocBlobs = memFrameAlloc(bobBlobSize(1)*superBlob->blobObjects->numSpaceObjs,"MassAllocBlobs");
+    preallocObjSelection = memFrameAlloc(sizeof(SelectCommand)*superBlob->blobObjects->numSpaceObjs,"MassAllocSel");
 
     for (index = 0; index < superBlob->blobObjects->numSpaceObjs; index++)
     {                                                       //for all blobs in this big fat blob
@@ -688,8 +714,8 @@ void bobSubBlobListCreate(BlobProperties *blobProperties, LinkedList *list, blob
         node = nextnode;
     }
 
-    memFree(preallocBlobs);
-    memFree(preallocObjSelection);
+    memFrameFree(preallocBlobs);
+    memFrameFree(preallocObjSelection);
 }
 
 /*-----------------------------------------------------------------------------
@@ -871,8 +897,8 @@ void bobListCreate(BlobProperties *blobProperties, LinkedList *list, udword play
     //first pass: create a sphere structure for each ship
 
     // mass preallocate everything
-    preallocBlobs = memAlloc(bobBlobSize(1)*universe.SpaceObjList.num,"MAB(MassAllocBlobs)",Pyrophoric);
-    preallocObjSelection = memAlloc(sizeof(SelectCommand)*universe.SpaceObjList.num,"MAS(MassAllocSel)",Pyrophoric);
+    preallocBlobs = memFrameAlloc(bobBlobSize(1)*universe.SpaceObjList.num,"MAB(MassAllocBlobs)");
+    preallocObjSelection = memFrameAlloc(sizeof(SelectCommand)*universe.SpaceObjList.num,"MAS(MassAllocSel)");
 
     node = universe.SpaceObjList.head;                      //get first node in universe list
     while (node != NULL)
@@ -1004,8 +1030,8 @@ void bobListCreate(BlobProperties *blobProperties, LinkedList *list, udword play
         node = nextnode;
     }
 
-    memFree(preallocBlobs);
-    memFree(preallocObjSelection);
+    memFrameFree(preallocBlobs);
+    memFrameFree(preallocObjSelection);
 
     //next pass: do blob itemizing needed only for collisions
     bobUpdateExtraCollBobInfo(list);
@@ -1177,6 +1203,465 @@ Node *bobBlobCombine(blob *thisBlob, blob *otherBlob, real32 newRadius, real32 n
     return(nextNode);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : bobBlobsShouldCombine
+    Description : Checks if two blobs overlap enough to be combined and if the
+                    combination would be dense enough.
+    Inputs      : thisBlob - the blob to be retained
+                  otherBlob - the blob to be absorbed
+                  checkdist - difference in the blobs' sqrtSortDistance
+    Outputs     : newRadius, newVolume - size of the combined blob
+    Return      : TRUE if the blobs should be combined
+----------------------------------------------------------------------------*/
+static bool bobBlobsShouldCombine(blob *thisBlob, blob *otherBlob, real32 checkdist, real32 *newRadius, real32 *newVolume)
+{
+    real32 distance, radius, checkradius, newDensity;
+    vector difference;
+
+    radius = thisBlob->radius + otherBlob->radius;
+    checkradius = radius * BlobPropertiesPtr->bobSqrtOverlapFactor;
+    if (checkdist > checkradius)
+    {
+        return(FALSE);
+    }
+
+    bobStatsCheck();
+
+    vecSub(difference, thisBlob->centre, otherBlob->centre);
+
+    if (!isBetweenInclusive(difference.x,-checkradius,checkradius))
+    {
+        return(FALSE);
+    }
+
+    if (!isBetweenInclusive(difference.y,-checkradius,checkradius))
+    {
+        return(FALSE);
+    }
+
+    if (!isBetweenInclusive(difference.z,-checkradius,checkradius))
+    {
+        return(FALSE);
+    }
+
+    distance = vecMagnitudeSquared(difference);
+    radius *= radius;                                       //combined radii^2
+
+    if (distance > (radius*BlobPropertiesPtr->bobOverlapFactor))
+    {                                                       //if these blobs aren't sufficiently overlapping
+        return(FALSE);
+    }
+
+    //determine if the new sphere would match density criteria
+    bobStatsCombine();
+    *newRadius = (((real32)fsqrt(distance)) + thisBlob->radius + otherBlob->radius) * 0.5f;
+    *newVolume = sphereVolume(*newRadius);
+    newDensity = (thisBlob->totalMass + otherBlob->totalMass) / *newVolume;
+
+    if (newDensity > max(thisBlob->totalMass * thisBlob->oneOverVolume, otherBlob->totalMass * otherBlob->oneOverVolume))
+    {                                                       //if new sphere is denser than the greater of the two spheres
+        return(TRUE);
+    }
+    if (newDensity > BlobPropertiesPtr->bobDensityHigh && *newRadius < BlobPropertiesPtr->bobBiggestRadius)
+    {                                                       //if combination will increase density
+        return(TRUE);
+    }
+    return(FALSE);                                          //else we're not to combine them
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdCoordinate
+    Description : Gets one coordinate of a blob's centre
+    Inputs      : thisBlob - blob, axis - 0, 1 or 2 for x, y or z
+    Outputs     :
+    Return      : the coordinate
+----------------------------------------------------------------------------*/
+static real32 bobKdCoordinate(blob *thisBlob, sdword axis)
+{
+    switch (axis)
+    {
+        case 0:
+            return(thisBlob->centre.x);
+        case 1:
+            return(thisBlob->centre.y);
+        default:
+            return(thisBlob->centre.z);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdSelect
+    Description : Partially sorts part of the tree order so the blob at position
+                    nth is the one that would be there if it was sorted along
+                    the axis, with none bigger before it and none smaller after.
+    Inputs      : tree - tree being built
+                  lo, hi - range of tree order to partition
+                  nth - position to select
+                  axis - axis to sort on
+    Outputs     : reorders tree->order[lo..hi-1]
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdSelect(bobkdtree *tree, sdword lo, sdword hi, sdword nth, sdword axis)
+{
+    sdword *order = tree->order;
+    sdword left, right, swap;
+    real32 pivot;
+
+    hi--;
+    while (lo < hi)
+    {
+        pivot = bobKdCoordinate(tree->blobs[order[(lo + hi) / 2]], axis);
+        left = lo;
+        right = hi;
+        while (left <= right)
+        {
+            while (bobKdCoordinate(tree->blobs[order[left]], axis) < pivot)
+            {
+                left++;
+            }
+            while (bobKdCoordinate(tree->blobs[order[right]], axis) > pivot)
+            {
+                right--;
+            }
+            if (left <= right)
+            {
+                swap = order[left];
+                order[left] = order[right];
+                order[right] = swap;
+                left++;
+                right--;
+            }
+        }
+        if (nth <= right)
+        {
+            hi = right;
+        }
+        else if (nth >= left)
+        {
+            lo = left;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdNodeMerge
+    Description : Grows a node's bounds to include a child's
+    Inputs      : node - node to grow, child - child node
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdNodeMerge(bobkdnode *node, bobkdnode *child)
+{
+    node->min.x = min(node->min.x, child->min.x);
+    node->min.y = min(node->min.y, child->min.y);
+    node->min.z = min(node->min.z, child->min.z);
+    node->max.x = max(node->max.x, child->max.x);
+    node->max.y = max(node->max.y, child->max.y);
+    node->max.z = max(node->max.z, child->max.z);
+    node->maxRadius = max(node->maxRadius, child->maxRadius);
+    node->minOrdinal = min(node->minOrdinal, child->minOrdinal);
+    node->maxOrdinal = max(node->maxOrdinal, child->maxOrdinal);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdBuild
+    Description : Builds the k-d tree for part of the tree order.  The node for
+                    the range lo..hi-1 is at the middle of the range with the
+                    left and right halves as its children.
+    Inputs      : tree - tree to build
+                  lo, hi - range of tree order
+                  axis - axis to split this range on
+    Outputs     : fills in tree->order and tree->nodes
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdBuild(bobkdtree *tree, sdword lo, sdword hi, sdword axis)
+{
+    sdword mid = (lo + hi) / 2;
+    bobkdnode *node = &tree->nodes[mid];
+    blob *thisBlob;
+
+    if (lo >= hi)
+    {
+        return;
+    }
+
+    bobKdSelect(tree, lo, hi, mid, axis);
+    bobKdBuild(tree, lo, mid, (axis + 1) % 3);
+    bobKdBuild(tree, mid + 1, hi, (axis + 1) % 3);
+
+    thisBlob = tree->blobs[tree->order[mid]];
+    node->min = node->max = thisBlob->centre;
+    node->maxRadius = thisBlob->radius;
+    node->minOrdinal = node->maxOrdinal = tree->order[mid];
+    if (lo < mid)
+    {
+        bobKdNodeMerge(node, &tree->nodes[(lo + mid) / 2]);
+    }
+    if (mid + 1 < hi)
+    {
+        bobKdNodeMerge(node, &tree->nodes[(mid + 1 + hi) / 2]);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdFirstCombine
+    Description : Finds the first blob in list order (within a range) that
+                    thisBlob would combine with.  Subtrees that are out of the
+                    range, can't beat the best found so far or are too far away
+                    to pass the overlap test in bobBlobsShouldCombine are
+                    skipped.
+    Inputs      : tree - k-d tree of the blobs
+                  lo, hi - range of tree order to search
+                  thisBlob - blob looking for others to combine with
+                  thisSortDistance - thisBlob's sqrtSortDistance before any
+                    combining this pass
+                  after - only look at list positions after this
+                  best - only look at list positions before this
+    Outputs     :
+    Return      : list position of the blob to combine with, or best if none
+----------------------------------------------------------------------------*/
+static sdword bobKdFirstCombine(bobkdtree *tree, sdword lo, sdword hi, blob *thisBlob, real32 thisSortDistance, sdword after, sdword best)
+{
+    sdword mid = (lo + hi) / 2, ordinal;
+    bobkdnode *node = &tree->nodes[mid];
+    real32 reach, newRadius, newVolume;
+
+    if (lo >= hi || node->minOrdinal >= best || node->maxOrdinal <= after)
+    {
+        return(best);
+    }
+
+    //no blob in here can be within checkradius on all 3 axes
+    reach = (thisBlob->radius + node->maxRadius) * BlobPropertiesPtr->bobSqrtOverlapFactor;
+    if (thisBlob->centre.x - node->max.x > reach || thisBlob->centre.x - node->min.x < -reach ||
+        thisBlob->centre.y - node->max.y > reach || thisBlob->centre.y - node->min.y < -reach ||
+        thisBlob->centre.z - node->max.z > reach || thisBlob->centre.z - node->min.z < -reach)
+    {
+        return(best);
+    }
+
+    ordinal = tree->order[mid];
+    if (ordinal > after && ordinal < best && !tree->absorbed[ordinal] &&
+        bobBlobsShouldCombine(thisBlob, tree->blobs[ordinal], tree->sqrtSortDistance[ordinal] - thisSortDistance, &newRadius, &newVolume))
+    {
+        best = ordinal;
+    }
+
+    //the child with the earlier blobs first, so more of the other one can be skipped
+    if (mid + 1 < hi && (lo == mid || tree->nodes[(mid + 1 + hi) / 2].minOrdinal < tree->nodes[(lo + mid) / 2].minOrdinal))
+    {
+        best = bobKdFirstCombine(tree, mid + 1, hi, thisBlob, thisSortDistance, after, best);
+        best = bobKdFirstCombine(tree, lo, mid, thisBlob, thisSortDistance, after, best);
+    }
+    else
+    {
+        best = bobKdFirstCombine(tree, lo, mid, thisBlob, thisSortDistance, after, best);
+        best = bobKdFirstCombine(tree, mid + 1, hi, thisBlob, thisSortDistance, after, best);
+    }
+    return(best);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdTreeCreate
+    Description : Allocates a k-d tree big enough for a blob list
+    Inputs      : tree - tree to allocate
+                  nBlobs - most blobs it will hold
+    Outputs     : allocates the tree's arrays in one block
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdTreeCreate(bobkdtree *tree, sdword nBlobs)
+{
+    ubyte *block;
+
+    for (tree->nLeaves = 1; tree->nLeaves < nBlobs; tree->nLeaves <<= 1)
+        ;
+    tree->nBlobs = 0;
+    block = memFrameAlloc((sizeof(bobkdnode) + sizeof(blob *) + sizeof(real32) + sizeof(sdword) + sizeof(ubyte)) * nBlobs +
+                          sizeof(real32) * 2 * tree->nLeaves, "BKD(BlobKdTree)");
+    tree->nodes = (bobkdnode *)block;
+    tree->blobs = (blob **)(tree->nodes + nBlobs);
+    tree->sqrtSortDistance = (real32 *)(tree->blobs + nBlobs);
+    tree->farthest = tree->sqrtSortDistance + nBlobs;
+    tree->order = (sdword *)(tree->farthest + 2 * tree->nLeaves);
+    tree->absorbed = (ubyte *)(tree->order + nBlobs);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdTreeDelete
+    Description : Frees a k-d tree allocated by bobKdTreeCreate
+    Inputs      : tree - tree to free
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdTreeDelete(bobkdtree *tree)
+{
+    memFrameFree(tree->nodes);
+    tree->nodes = NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdTreeBuild
+    Description : Fills in a k-d tree from the current state of a blob list
+    Inputs      : tree - tree allocated big enough for the list
+                  list - list of blobs
+    Outputs     : caches the blobs' sqrtSortDistance like the list walk does
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdTreeBuild(bobkdtree *tree, LinkedList *list)
+{
+    Node *node;
+    blob *thisBlob;
+    sdword index;
+
+    for (node = list->head, index = 0; node != NULL; node = node->next, index++)
+    {
+        thisBlob = (blob *)listGetStructOfNode(node);
+        if (thisBlob->sqrtSortDistance == 0.0f)
+        {
+            thisBlob->sqrtSortDistance = fsqrt(thisBlob->sortDistance);
+        }
+        tree->blobs[index] = thisBlob;
+        tree->sqrtSortDistance[index] = thisBlob->sqrtSortDistance;
+        tree->farthest[tree->nLeaves + index] = thisBlob->sqrtSortDistance;
+        tree->order[index] = index;
+        tree->absorbed[index] = FALSE;
+    }
+    tree->nBlobs = index;
+    for (index += tree->nLeaves; index < 2 * tree->nLeaves; index++)
+    {
+        tree->farthest[index] = REALlyNegative;
+    }
+    for (index = tree->nLeaves - 1; index > 0; index--)
+    {
+        tree->farthest[index] = max(tree->farthest[index * 2], tree->farthest[index * 2 + 1]);
+    }
+
+    bobKdBuild(tree, 0, tree->nBlobs, 0);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdAbsorbed
+    Description : Marks a blob as combined into another one
+    Inputs      : tree - k-d tree of the blobs
+                  ordinal - list position of the blob
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void bobKdAbsorbed(bobkdtree *tree, sdword ordinal)
+{
+    sdword index = tree->nLeaves + ordinal;
+
+    tree->absorbed[ordinal] = TRUE;
+    tree->farthest[index] = REALlyNegative;
+    for (index >>= 1; index > 0; index >>= 1)
+    {
+        tree->farthest[index] = max(tree->farthest[index * 2], tree->farthest[index * 2 + 1]);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobKdFirstBeyond
+    Description : Finds where the list walk would give up looking for blobs to
+                    combine with: the first remaining blob after a list
+                    position that is more than reach further from the origin.
+    Inputs      : tree - k-d tree of the blobs
+                  after - list position to start after
+                  thisSortDistance - sqrtSortDistance to measure from
+                  reach - thisBlob->radius + bobBiggestRadius
+    Outputs     :
+    Return      : list position of that blob, or the number of blobs if none
+----------------------------------------------------------------------------*/
+static sdword bobKdFirstBeyond(bobkdtree *tree, sdword after, real32 thisSortDistance, real32 reach)
+{
+    sdword index = tree->nLeaves + after + 1;
+    real32 checkdist;
+
+    if (after + 1 >= tree->nBlobs)
+    {
+        return(tree->nBlobs);
+    }
+
+    for (;;)
+    {
+        checkdist = tree->farthest[index] - thisSortDistance;
+        if (checkdist > reach)
+        {                                                   //it's in this subtree, find the leftmost one
+            while (index < tree->nLeaves)
+            {
+                index *= 2;
+                checkdist = tree->farthest[index] - thisSortDistance;
+                if (!(checkdist > reach))
+                {
+                    index++;
+                }
+            }
+            return(index - tree->nLeaves);
+        }
+        while (index & 1)
+        {                                                   //go up past the subtrees already looked at
+            index >>= 1;
+            if (index == 0)
+            {
+                return(tree->nBlobs);
+            }
+        }
+        index++;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : bobListUpdateKdPass
+    Description : Does one combining pass of bobListUpdate using a k-d tree to
+                    find the blobs to combine with, instead of walking the
+                    list.  It combines exactly the same blobs in the same
+                    order as the list walk, so the results don't depend on
+                    bobKdTreeEnabled.  This works because the blobs after
+                    thisBlob in the list haven't been changed yet this pass,
+                    so the tree built at the start of the pass is still good
+                    for them.
+    Inputs      : tree - k-d tree allocated big enough for the list
+                  list - list of blobs
+    Outputs     : combines blobs
+    Return      : number of blobs combined
+----------------------------------------------------------------------------*/
+static sdword bobListUpdateKdPass(bobkdtree *tree, LinkedList *list)
+{
+    blob *thisBlob;
+    sdword index, after, limit, nHits = 0;
+    real32 thisSortDistance, newRadius, newVolume;
+
+    bobKdTreeBuild(tree, list);
+
+    for (index = 0; index < tree->nBlobs; index++)
+    {
+        if (tree->absorbed[index])
+        {
+            continue;
+        }
+        thisBlob = tree->blobs[index];
+        thisSortDistance = tree->sqrtSortDistance[index];
+        after = index;
+        for (;;)
+        {
+            limit = bobKdFirstBeyond(tree, after, thisSortDistance, thisBlob->radius + BlobPropertiesPtr->bobBiggestRadius);
+            after = bobKdFirstCombine(tree, 0, tree->nBlobs, thisBlob, thisSortDistance, after, limit);
+            if (after >= limit)
+            {
+                break;
+            }
+            bobBlobsShouldCombine(thisBlob, tree->blobs[after], tree->sqrtSortDistance[after] - thisSortDistance, &newRadius, &newVolume);
+            bobBlobCombine(thisBlob, tree->blobs[after], newRadius, newVolume);
+            bobKdAbsorbed(tree, after);
+            nHits++;
+        }
+    }
+    return(nHits);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : bobBlobItemize
     Description : Perform analiysis of a blob for current sensors level.  This
@@ -1346,26 +1831,34 @@ void bobListUpdate(LinkedList *list)
     Node *thisNode, *otherNode;
     blob *thisBlob, *otherBlob;
     sdword nHits;
-    real32 distance, radius, checkradius, newRadius, newVolume, newDensity;
-    vector difference;
+    real32 newRadius, newVolume;
     real32 thisblobSortDistance;
     real32 otherblobSortDistance;
+    bobkdtree tree;
 
-    real32 bobOverlapFactor = BlobPropertiesPtr->bobOverlapFactor;
-    real32 bobSqrtOverlapFactor = BlobPropertiesPtr->bobSqrtOverlapFactor;
-    real32 bobDensityHigh = BlobPropertiesPtr->bobDensityHigh;
     real32 bobBiggestRadius = BlobPropertiesPtr->bobBiggestRadius;
 
     real32 checkdist;
 
     bobStatsInitialBlobs(list->num);
 
+    tree.nodes = NULL;
+    if (bobKdTreeEnabled && list->num >= BOB_KdTreeMinimum)
+    {
+        bobKdTreeCreate(&tree, list->num);
+    }
+
     //first pass: go through list repeatedly until there are no more spheres to combine
     do
     {
+        bobStatsPass();
+        if (tree.nodes != NULL && list->num >= BOB_KdTreeMinimum)
+        {                                                   //search a tree rather than walking the list
+            nHits = bobListUpdateKdPass(&tree, list);
+            continue;
+        }
         nHits = 0;
         thisNode = list->head;
-        bobStatsPass();
         while (thisNode != NULL)
         {
             thisBlob = (blob *)listGetStructOfNode(thisNode);
@@ -1397,61 +1890,13 @@ void bobListUpdate(LinkedList *list)
                     break;
                 }
 
-                radius = thisBlob->radius + otherBlob->radius;
-                checkradius = radius * bobSqrtOverlapFactor;
-                if (checkdist > checkradius)
+                if (bobBlobsShouldCombine(thisBlob, otherBlob, checkdist, &newRadius, &newVolume))
                 {
-                    goto nextnode;
-                }
-
-                bobStatsCheck();
-
-                vecSub(difference, thisBlob->centre, otherBlob->centre);
-
-                if (!isBetweenInclusive(difference.x,-checkradius,checkradius))
-                {
-                    goto nextnode;
-                }
-
-                if (!isBetweenInclusive(difference.y,-checkradius,checkradius))
-                {
-                    goto nextnode;
-                }
-
-                if (!isBetweenInclusive(difference.z,-checkradius,checkradius))
-                {
-                    goto nextnode;
-                }
-
-                distance = vecMagnitudeSquared(difference);
-                radius *= radius;                           //combined radii^2
-
-                if (distance <= (radius*bobOverlapFactor))
-                {                                           //if these blobs are sufficiently overlapping
-                    //determine if the new sphere would match density criteria
-                    bobStatsCombine();
-                    newRadius = (((real32)fsqrt(distance)) + thisBlob->radius + otherBlob->radius) * 0.5f;
-                    newVolume = sphereVolume(newRadius);
-                    newDensity = (thisBlob->totalMass + otherBlob->totalMass) / newVolume;
-
-                    if (newDensity > max(thisBlob->totalMass * thisBlob->oneOverVolume, otherBlob->totalMass * otherBlob->oneOverVolume))
-                    {                                       //if new sphere is denser than the greater of the two spheres
-                        otherNode = bobBlobCombine(thisBlob, otherBlob, newRadius, newVolume);
-                        nHits++;
-                    }
-                    else if (newDensity > bobDensityHigh && newRadius < bobBiggestRadius)
-                    {                                       //if combination will increase density
-                        otherNode = bobBlobCombine(thisBlob, otherBlob, newRadius, newVolume);
-                        nHits++;
-                    }
-                    else
-                    {                                       //else we're not to combine them
-                        otherNode = otherNode->next;
-                    }
+                    otherNode = bobBlobCombine(thisBlob, otherBlob, newRadius, newVolume);
+                    nHits++;
                 }
                 else
                 {
-nextnode:
                     otherNode = otherNode->next;
                 }
             }
@@ -1460,6 +1905,11 @@ nextnode:
     }
     while (nHits > 0);
 
+    if (tree.nodes != NULL)
+    {
+        bobKdTreeDelete(&tree);
+    }
+
     bobStatsFinalBlobs(list->num);
 
     //do a pass over all the final nodes to determine how to render them
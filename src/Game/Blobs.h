@@ -62,6 +62,8 @@
 #define BOB_UpdateRadiusThreshold   1.00f       //can grow by 2%
 #define BOB_UpdateCentreThreshold   0.10f       //can move by 10% of radius
 
+#define BOB_KdTreeMinimum           2048        //fewest blobs worth building a k-d tree for in bobListUpdate
+
 /*=============================================================================
     Type definitions:
 =============================================================================*/
@@ -160,6 +162,12 @@ typedef bool (*subblobcallback)(blob *superblob, SpaceObj *obj);
 #define blobAnalVerify(thisBlob)
 #endif
 
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool bobKdTreeEnabled;
+
 /*=============================================================================
     Functions:
 =============================================================================*/
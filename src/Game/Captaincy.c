@@ -317,7 +317,6 @@ void TransferCaptaincyUpdate(void)
 
     TimeoutTimerUpdateAll();
 
-    LockQueue(&ProcessCaptaincyPktQ);
     numPackets = queueNumberEntries(ProcessCaptaincyPktQ);
 
     while (numPackets > 0)
@@ -326,17 +325,14 @@ void TransferCaptaincyUpdate(void)
         dbgAssertOrIgnore(sizeofPacket > 0);
         copypacket = memAlloc(sizeofPacket,"cp(miscpacket)",Pyrophoric);
         memcpy(copypacket,packet,sizeofPacket);
-        UnLockQueue(&ProcessCaptaincyPktQ);
+        HWDequeueDone(&ProcessCaptaincyPktQ);
 
         dbgAssertOrIgnore(((HWPacketHeader *)copypacket)->type == PACKETTYPE_TRANSFERCAPTAINCY);
         ProcessTransferCaptaincyPacket((TransferCaptaincyPacket *)copypacket);
         memFree(copypacket);
 
-        LockQueue(&ProcessCaptaincyPktQ);
         numPackets = queueNumberEntries(ProcessCaptaincyPktQ);
     }
-
-    UnLockQueue(&ProcessCaptaincyPktQ);
 }
 
 void ProposeNewCaptain(void)
@@ -8,9 +8,13 @@
 
 #include "Collision.h"
 
+#include <math.h>
+#include <string.h>
+
 #include "Alliance.h"
 #include "Debug.h"
 #include "FastMath.h"
+#include "Memory.h"
 #include "NIS.h"
 #include "prim3d.h"
 #include "Ships.h"
@@ -46,6 +50,310 @@ udword minechecks;
 
 #endif
 
+/*=============================================================================
+    Broadphase grid:
+        Big blobs are binned into a hashed uniform grid on collPosition so the
+    bump checks only walk objects that can pass the narrow phase box test,
+    instead of every object in the blob's radial (collOptimizeDist) window.
+    Objects much bigger than the rest (motherships among frigates, say) are
+    kept out of the grid and tested directly so they don't blow up the cell
+    size.  Candidates come back in ascending list index, so pairs are still
+    handled in exactly the same order as the plain sweep and the results stay
+    bit-identical.
+=============================================================================*/
+
+#define COLL_GRID_MIN_OBJS      24      // below this the plain sweep beats building a grid
+#define COLL_GRID_OVERSIZE      4.0f    // objects this many times the mean size are kept out of the grid
+#define COLL_GRID_SLACK         1.01f   // query padding, covers rounding in the narrow phase
+#define COLL_GRID_SLACK_ABS     1.0f
+
+#define collGridHash(grid,cx,cy,cz) \
+    ((((udword)(cx) * 73856093) ^ ((udword)(cy) * 19349663) ^ ((udword)(cz) * 83492791)) & (grid)->hashMask)
+
+#define collGridCoord(grid,x)   ((sdword)floor((real64)(x) * (grid)->oneOverCellSize))
+
+typedef struct CollGrid
+{
+    sdword numObjs;
+    SpaceObjRotImp **objs;
+    real32 maxRadius;                   // biggest collspheresize in the grid proper
+    real64 oneOverCellSize;
+    udword hashMask;
+    sdword maxObjs;                     // allocated sizes
+    sdword maxHash;
+    sdword *cell;                       // [maxObjs*4] cell coordinates of each object, then TRUE if oversize
+    sdword *bucketStart;                // [maxHash+1]
+    sdword *bucketObj;                  // [maxObjs] object indices, ascending within a bucket
+    sdword *oversizeObj;                // [maxObjs] ascending indices of objects not in the grid
+    sdword numOversize;
+    sdword *candidate;                  // [maxObjs] result of the last query
+    sdword numCandidates;
+    sdword curCandidate;
+} CollGrid;
+
+static CollGrid collSmallShipGrid;
+static CollGrid collBigShipGrid;
+static CollGrid collResourceGrid;
+
+/*-----------------------------------------------------------------------------
+    Name        : collGridFree
+    Description : frees the buffers of a broadphase grid
+    Inputs      : grid
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void collGridFree(CollGrid *grid)
+{
+    if (grid->cell != NULL)
+    {
+        memFree(grid->cell);
+        memFree(grid->bucketStart);
+        memFree(grid->bucketObj);
+        memFree(grid->oversizeObj);
+        memFree(grid->candidate);
+    }
+    memset(grid, 0, sizeof(CollGrid));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : collGridBuild
+    Description : bins a sorted blob object list into a broadphase grid
+    Inputs      : grid, objs, numObjs
+    Outputs     :
+    Return      : grid, or NULL if the list is small enough that the caller
+                  should just do a plain sweep
+----------------------------------------------------------------------------*/
+static CollGrid *collGridBuild(CollGrid *grid,SpaceObjRotImp **objs,sdword numObjs)
+{
+    sdword i, hashSize;
+    sdword *cell;
+    real32 size, oversize;
+    udword hash;
+
+    if (numObjs < COLL_GRID_MIN_OBJS)
+    {
+        return NULL;
+    }
+
+    hashSize = 64;
+    while (hashSize < numObjs * 2)
+    {
+        hashSize <<= 1;
+    }
+
+    if ((numObjs > grid->maxObjs) || (hashSize > grid->maxHash))
+    {
+        collGridFree(grid);
+        grid->maxObjs = max(numObjs, COLL_GRID_MIN_OBJS * 4);
+        grid->maxHash = max(hashSize, 256);
+        grid->cell = memAlloc(grid->maxObjs * 4 * sizeof(sdword), "collGridCell", NonVolatile);
+        grid->bucketStart = memAlloc((grid->maxHash + 1) * sizeof(sdword), "collGridBucket", NonVolatile);
+        grid->bucketObj = memAlloc(grid->maxObjs * sizeof(sdword), "collGridObj", NonVolatile);
+        grid->oversizeObj = memAlloc(grid->maxObjs * sizeof(sdword), "collGridOversize", NonVolatile);
+        grid->candidate = memAlloc(grid->maxObjs * sizeof(sdword), "collGridCand", NonVolatile);
+    }
+
+    grid->objs = objs;
+    grid->numObjs = numObjs;
+    grid->hashMask = hashSize - 1;
+
+    // split off the oversize objects, and size the cells so that any pair
+    // that can touch is at most one cell apart on each axis
+    oversize = 0.0f;
+    for (i = 0; i < numObjs; i++)
+    {
+        oversize += objs[i]->staticinfo->staticheader.staticCollInfo.collspheresize;
+    }
+    oversize = oversize / numObjs * COLL_GRID_OVERSIZE;
+
+    grid->maxRadius = 0.0f;
+    grid->numOversize = 0;
+    for (i = 0, cell = grid->cell; i < numObjs; i++, cell += 4)
+    {
+        size = objs[i]->staticinfo->staticheader.staticCollInfo.collspheresize;
+        if (size > oversize)
+        {
+            cell[3] = TRUE;
+            grid->oversizeObj[grid->numOversize++] = i;
+        }
+        else
+        {
+            cell[3] = FALSE;
+            if (size > grid->maxRadius)
+            {
+                grid->maxRadius = size;
+            }
+        }
+    }
+    grid->oneOverCellSize = 1.0 / ((real64)grid->maxRadius * 2.0 * COLL_GRID_SLACK + COLL_GRID_SLACK_ABS);
+
+    // counting sort of the objects into their hash buckets
+    memset(grid->bucketStart, 0, (hashSize + 1) * sizeof(sdword));
+    for (i = 0, cell = grid->cell; i < numObjs; i++, cell += 4)
+    {
+        if (cell[3])
+        {
+            continue;
+        }
+        cell[0] = collGridCoord(grid, objs[i]->collInfo.collPosition.x);
+        cell[1] = collGridCoord(grid, objs[i]->collInfo.collPosition.y);
+        cell[2] = collGridCoord(grid, objs[i]->collInfo.collPosition.z);
+        grid->bucketStart[collGridHash(grid, cell[0], cell[1], cell[2]) + 1]++;
+    }
+    for (i = 0; i < hashSize; i++)
+    {
+        grid->bucketStart[i + 1] += grid->bucketStart[i];
+    }
+    for (i = 0, cell = grid->cell; i < numObjs; i++, cell += 4)
+    {
+        if (!cell[3])
+        {
+            hash = collGridHash(grid, cell[0], cell[1], cell[2]);
+            grid->bucketObj[grid->bucketStart[hash]++] = i;
+        }
+    }
+    for (i = hashSize; i > 0; i--)                          // filling shifted the starts up one bucket
+    {
+        grid->bucketStart[i] = grid->bucketStart[i - 1];
+    }
+    grid->bucketStart[0] = 0;
+
+    return grid;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : collGridAddCandidate
+    Description : inserts an object index into the sorted candidate list
+    Inputs      : grid, index
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void collGridAddCandidate(CollGrid *grid,sdword index)
+{
+    sdword j;
+
+    for (j = grid->numCandidates; (j > 0) && (grid->candidate[j - 1] > index); j--)
+    {                                                       //insertion sort, the lists are short
+        grid->candidate[j] = grid->candidate[j - 1];
+    }
+    grid->candidate[j] = index;
+    grid->numCandidates++;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : collGridQuery
+    Description : finds all objects in the grid, from firstIndex on, that
+                  could pass the narrow phase box test against a sphere at
+                  position
+    Inputs      : grid, position, radius (collspheresize of the querying
+                  object), firstIndex
+    Outputs     : fills in the candidate list in ascending index order
+    Return      : first candidate index, grid->numObjs if there are none
+----------------------------------------------------------------------------*/
+static sdword collGridQuery(CollGrid *grid,vector *position,real32 radius,sdword firstIndex)
+{
+    real32 reach = (radius + grid->maxRadius) * COLL_GRID_SLACK + COLL_GRID_SLACK_ABS;
+    sdword lo[3], hi[3];
+    sdword cx, cy, cz, i, index;
+    sdword *cell;
+    udword hash;
+    sqword numCells;
+    vector *other;
+
+    lo[0] = collGridCoord(grid, position->x - reach);
+    lo[1] = collGridCoord(grid, position->y - reach);
+    lo[2] = collGridCoord(grid, position->z - reach);
+    hi[0] = collGridCoord(grid, position->x + reach);
+    hi[1] = collGridCoord(grid, position->y + reach);
+    hi[2] = collGridCoord(grid, position->z + reach);
+
+    grid->numCandidates = 0;
+    grid->curCandidate = 0;
+
+    numCells = (sqword)(hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1);
+    if (numCells >= grid->numObjs - firstIndex)
+    {                                                       //big query; cheaper to test every object's cell directly
+        for (index = firstIndex, cell = grid->cell + firstIndex * 4; index < grid->numObjs; index++, cell += 4)
+        {
+            if ((!cell[3]) &&
+                isBetweenInclusive(cell[0], lo[0], hi[0]) &&
+                isBetweenInclusive(cell[1], lo[1], hi[1]) &&
+                isBetweenInclusive(cell[2], lo[2], hi[2]))
+            {
+                grid->candidate[grid->numCandidates++] = index;
+            }
+        }
+    }
+    else
+    {
+        for (cx = lo[0]; cx <= hi[0]; cx++)
+        {
+            for (cy = lo[1]; cy <= hi[1]; cy++)
+            {
+                for (cz = lo[2]; cz <= hi[2]; cz++)
+                {
+                    hash = collGridHash(grid, cx, cy, cz);
+                    for (i = grid->bucketStart[hash]; i < grid->bucketStart[hash + 1]; i++)
+                    {
+                        index = grid->bucketObj[i];
+                        cell = grid->cell + index * 4;
+                        if ((index < firstIndex) || (cell[0] != cx) || (cell[1] != cy) || (cell[2] != cz))
+                        {                                   //already walked, or another cell sharing the bucket
+                            continue;
+                        }
+                        collGridAddCandidate(grid, index);
+                    }
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < grid->numOversize; i++)
+    {
+        index = grid->oversizeObj[i];
+        if (index < firstIndex)
+        {
+            continue;
+        }
+        reach = (radius + grid->objs[index]->staticinfo->staticheader.staticCollInfo.collspheresize) * COLL_GRID_SLACK + COLL_GRID_SLACK_ABS;
+        other = &grid->objs[index]->collInfo.collPosition;
+        if (isBetweenInclusive(other->x - position->x, -reach, reach) &&
+            isBetweenInclusive(other->y - position->y, -reach, reach) &&
+            isBetweenInclusive(other->z - position->z, -reach, reach))
+        {
+            collGridAddCandidate(grid, index);
+        }
+    }
+
+    return (grid->numCandidates > 0) ? grid->candidate[grid->curCandidate++] : grid->numObjs;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : collGridNext
+    Description : steps to the next candidate of the last collGridQuery
+    Inputs      : grid
+    Outputs     :
+    Return      : next candidate index, grid->numObjs when exhausted
+----------------------------------------------------------------------------*/
+static sdword collGridNext(CollGrid *grid)
+{
+    return (grid->curCandidate < grid->numCandidates) ? grid->candidate[grid->curCandidate++] : grid->numObjs;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : collReset
+    Description : frees the collision broadphase buffers
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void collReset(void)
+{
+    collGridFree(&collSmallShipGrid);
+    collGridFree(&collBigShipGrid);
+    collGridFree(&collResourceGrid);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : RangeToTarget
     Description : Returns range from ship to target, taking into account collision
@@ -677,11 +985,12 @@ bool kamikazeCheck(SpaceObjRotImpTarg *obj1, SpaceObjRotImpTarg *obj2)
     Name        : collCheckShipShipColl
     Description : checks collisions between ships and ships, and impacts a force
                   on each one (equal and opposite forces)
-    Inputs      : thisBlob
+    Inputs      : thisBlob, checkSmallShips, grid (broadphase of the same
+                  ship list, or NULL to sweep)
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
-void collCheckShipShipColl(blob *thisBlob,bool checkSmallShips)
+void collCheckShipShipColl(blob *thisBlob,bool checkSmallShips,CollGrid *grid)
 {
     sdword obj1index = 0;
     Ship *obj1;
@@ -722,7 +1031,14 @@ void collCheckShipShipColl(blob *thisBlob,bool checkSmallShips)
         obj1collspheresize = obj1->staticinfo->staticheader.staticCollInfo.collspheresize;
         maxdistCollPossible = obj1collspheresize + maxShipCollSphereSize;
 
-        obj2index = obj1index + 1;
+        if (grid != NULL)
+        {
+            obj2index = collGridQuery(grid,&obj1->collInfo.collPosition,obj1collspheresize,obj1index + 1);
+        }
+        else
+        {
+            obj2index = obj1index + 1;
+        }
         while (obj2index < numShips)
         {
             obj2 = selection->ShipPtr[obj2index];
@@ -960,7 +1276,7 @@ dontapplydamage:
                 }
             }
 nocollision:
-            obj2index++;
+            obj2index = (grid != NULL) ? collGridNext(grid) : obj2index + 1;
         }
 nextobj1:
         obj1index++;
@@ -971,11 +1287,11 @@ nextobj1:
     Name        : collCheckBigShipSmallShipColl
     Description : checks collisions between bigships and smallships, and impacts a force
                   on each one (equal and opposite forces)
-    Inputs      : thisBlob
+    Inputs      : thisBlob, grid (broadphase of the small ships, or NULL to sweep)
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
-void collCheckBigShipSmallShipColl(blob *thisBlob)
+void collCheckBigShipSmallShipColl(blob *thisBlob,CollGrid *grid)
 {
     sdword obj1index = 0;
     Ship *obj1;
@@ -1035,6 +1351,11 @@ void collCheckBigShipSmallShipColl(blob *thisBlob)
         dbgAssertOrIgnore(obj2index >= 0);
         dbgAssertOrIgnore(obj2index < numShips2);
 
+        if (grid != NULL)
+        {
+            obj2index = collGridQuery(grid,&obj1->collInfo.collPosition,obj1collspheresize,obj2index);
+        }
+
         while (obj2index < numShips2)
         {
             obj2 = selection2->ShipPtr[obj2index];
@@ -1271,7 +1592,7 @@ dontapplydamage:
                 }
             }
 nocollision:
-            obj2index++;
+            obj2index = (grid != NULL) ? collGridNext(grid) : obj2index + 1;
         }
 nextobj1:
         obj1index++;
@@ -1281,11 +1602,11 @@ nextobj1:
 /*-----------------------------------------------------------------------------
     Name        : collCheckShipResourceColl
     Description : checks collisions between ships and resources
-    Inputs      : thisBlob
+    Inputs      : thisBlob, grid (broadphase of the resources, or NULL to sweep)
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
-void collCheckShipResourceColl(blob *thisBlob)
+void collCheckShipResourceColl(blob *thisBlob,CollGrid *grid)
 {
     sdword obj1index = 0;
     Ship *obj1;
@@ -1348,6 +1669,11 @@ void collCheckShipResourceColl(blob *thisBlob)
         dbgAssertOrIgnore(obj2index >= 0);
         dbgAssertOrIgnore(obj2index < numResources);
 
+        if (grid != NULL)
+        {
+            obj2index = collGridQuery(grid,&obj1->collInfo.collPosition,obj1collspheresize,obj2index);
+        }
+
         while (obj2index < numResources)
         {
             obj2 = resselection->ResourcePtr[obj2index];
@@ -1434,7 +1760,7 @@ void collCheckShipResourceColl(blob *thisBlob)
                 }
             }
 nocollision:
-            obj2index++;
+            obj2index = (grid != NULL) ? collGridNext(grid) : obj2index + 1;
         }
 nextobj1:
         obj1index++;
@@ -2858,6 +3184,7 @@ void collCheckAllBumpCollisions(void)
 {
     Node *blobnode = universe.collBlobList.head;
     blob *thisBlob;
+    CollGrid *smallShipGrid, *bigShipGrid, *resourceGrid;
 
 #if COLLISION_CHECK_STATS
     shipshipwalks = 0;
@@ -2876,10 +3203,15 @@ void collCheckAllBumpCollisions(void)
             thisBlob = (blob *)listGetStructOfNode(blobnode);
             blobnode = blobnode->next;
 
-            collCheckShipShipColl(thisBlob,TRUE);       // check smallship-smallship collisions
-            collCheckShipShipColl(thisBlob,FALSE);      // check bigship-bigship collisions
-            collCheckBigShipSmallShipColl(thisBlob);    // check bigship-smallship collisions
-            collCheckShipResourceColl(thisBlob);
+            // nothing moves during the bump checks, so the grids hold for the whole blob
+            smallShipGrid = collGridBuild(&collSmallShipGrid,(SpaceObjRotImp **)thisBlob->blobSmallShips->ShipPtr,thisBlob->blobSmallShips->numShips);
+            bigShipGrid = collGridBuild(&collBigShipGrid,(SpaceObjRotImp **)thisBlob->blobBigShips->ShipPtr,thisBlob->blobBigShips->numShips);
+            resourceGrid = collGridBuild(&collResourceGrid,(SpaceObjRotImp **)thisBlob->blobResources->ResourcePtr,thisBlob->blobResources->numResources);
+
+            collCheckShipShipColl(thisBlob,TRUE,smallShipGrid);     // check smallship-smallship collisions
+            collCheckShipShipColl(thisBlob,FALSE,bigShipGrid);      // check bigship-bigship collisions
+            collCheckBigShipSmallShipColl(thisBlob,smallShipGrid);  // check bigship-smallship collisions
+            collCheckShipResourceColl(thisBlob,resourceGrid);
             collCheckShipDerelictColl(thisBlob);
         }
     }
@@ -2891,9 +3223,12 @@ void collCheckAllBumpCollisions(void)
             thisBlob = (blob *)listGetStructOfNode(blobnode);
             blobnode = blobnode->next;
 
+            smallShipGrid = collGridBuild(&collSmallShipGrid,(SpaceObjRotImp **)thisBlob->blobSmallShips->ShipPtr,thisBlob->blobSmallShips->numShips);
+            bigShipGrid = collGridBuild(&collBigShipGrid,(SpaceObjRotImp **)thisBlob->blobBigShips->ShipPtr,thisBlob->blobBigShips->numShips);
+
             // in case Bentusi traders run into some ships...
-            collCheckShipShipColl(thisBlob,FALSE);      // check bigship-bigship collisions
-            collCheckBigShipSmallShipColl(thisBlob);    // check bigship-smallship collisions
+            collCheckShipShipColl(thisBlob,FALSE,bigShipGrid);      // check bigship-bigship collisions
+            collCheckBigShipSmallShipColl(thisBlob,smallShipGrid);  // check bigship-smallship collisions
         }
     }
 }
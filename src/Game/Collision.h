@@ -26,6 +26,7 @@ bool collCheckLineOfSight(Ship* source, Ship* target, vector* sourcePosition, ve
 
 void collUpdateCollBlobs(void);
 void collUpdateObjsInCollBlobs(void);
+void collReset(void);
 
 void collCheckAllBumpCollisions(void);
 void collCheckAllBulletMissileCollisions(void);
@@ -4603,7 +4603,7 @@ void clMoveThese(CommandLayer *comlayer,SelectCommand *selectcom,vector from,vec
         SelectCommand *copycom;
         CommandToDo *currentShipCommand;
         sizeofcopycom = sizeofSelectCommand(selectcom->numShips);
-        copycom = memAlloc(sizeofcopycom,"cc1(copycom)", Pyrophoric);
+        copycom = memFrameAlloc(sizeofcopycom,"cc1(copycom)");
         memcpy(copycom,selectcom,sizeofcopycom);
 
 
@@ -4663,7 +4663,7 @@ void clMoveThese(CommandLayer *comlayer,SelectCommand *selectcom,vector from,vec
         }
         sizeofcopycom = sizeofSelectCommand(copycom->numShips);
         memcpy(selectcom,copycom,sizeofcopycom);
-        memFree(copycom);
+        memFrameFree(copycom);
         numShips = selectcom->numShips;
         if(numShips == 0)
             return;
@@ -4737,7 +4737,7 @@ void clMove(CommandLayer *comlayer,SelectCommand *selectcom,vector from,vector t
     }
 
     sizeofcopycom = sizeofSelectCommand(selectcom->numShips);
-    copycom = memAlloc(sizeofcopycom,"cc2(copycom)", Pyrophoric);
+    copycom = memFrameAlloc(sizeofcopycom,"cc2(copycom)");
     memcpy(copycom,selectcom,sizeofcopycom);
 
     // Now see if the selected ships are already in the command layer, and if so, individually order these groups
@@ -4776,7 +4776,7 @@ void clMove(CommandLayer *comlayer,SelectCommand *selectcom,vector from,vector t
         clMoveThese(comlayer,copycom,from,to);
     }
 
-    memFree(copycom);
+    memFrameFree(copycom);
 }
 
 
@@ -5015,7 +5015,7 @@ void clMpHyperspace(CommandLayer *comlayer,SelectCommand *selectcom,vector from,
         RemoveShipFromBeingTargeted(comlayer,selectcom->ShipPtr[i],REMOVE_PROTECT|REMOVE_HYPERSPACING);
     }
     sizeofcopycom = sizeofSelectCommand(selectcom->numShips);
-    copycom = memAlloc(sizeofcopycom,"cc3(copycom)", Pyrophoric);
+    copycom = memFrameAlloc(sizeofcopycom,"cc3(copycom)");
     memcpy(copycom,selectcom,sizeofcopycom);
 
     // Now see if the selected ships are already in the command layer, and if so, individually order these groups
@@ -5057,7 +5057,7 @@ void clMpHyperspace(CommandLayer *comlayer,SelectCommand *selectcom,vector from,
         clMpHyperspaceThese(comlayer,copycom,from,newTo);
     }
 
-    memFree(copycom);
+    memFrameFree(copycom);
 }
 
 
@@ -5454,7 +5454,7 @@ void pickMultipleAttackTargets(Ship *ship,AttackCommand *attack)
     dbgAssertOrIgnore(numAttackTargets > 0);
     dbgAssertOrIgnore(numAttackTargets == gunInfo->numGuns);
 
-    multipleTargetsInfo = memAlloc(sizeof(PickMultipleTargetsInfo)*numShipsToAttack,"mTI(multTargInfo)",Pyrophoric);
+    multipleTargetsInfo = memFrameAlloc(sizeof(PickMultipleTargetsInfo)*numShipsToAttack,"mTI(multTargInfo)");
 
     for (i=0,thisTargetInfo=multipleTargetsInfo;i<numShipsToAttack;i++,thisTargetInfo++)
     {
@@ -5551,7 +5551,7 @@ void pickMultipleAttackTargets(Ship *ship,AttackCommand *attack)
         }
     }
 
-    memFree(multipleTargetsInfo);
+    memFrameFree(multipleTargetsInfo);
 }
 
 #define WINGMANSHIP_USED       1
@@ -5798,7 +5798,7 @@ void InitExtraAttackInfo(SelectCommand *selection,AttackCommand *attack,bool fin
     else
     {
         sizeofAssigntargets = sizeofAssignTargetsInfo(numTargetsToAttack);
-        assigntargets = memAlloc(sizeofAssigntargets,"assigntargets",Pyrophoric);
+        assigntargets = memFrameAlloc(sizeofAssigntargets,"assigntargets");
         memset(assigntargets,0,sizeofAssigntargets);
 
         for (i=0;i<numShips;i++)
@@ -5862,7 +5862,7 @@ void InitExtraAttackInfo(SelectCommand *selection,AttackCommand *attack,bool fin
 
         }
 
-        memFree(assigntargets);
+        memFrameFree(assigntargets);
     }
 }
 
@@ -6071,7 +6071,7 @@ void clAttack(CommandLayer *comlayer,SelectCommand *selectcom,AttackCommand *att
     salCapExtraSpecialOrderCleanUp(selectcom,COMMAND_ATTACK,NULL,NULL);
 
     sizeofcopycom = sizeofSelectCommand(selectcom->numShips);
-    copycom = memAlloc(sizeofcopycom,"cc2(copycom)", Pyrophoric);
+    copycom = memFrameAlloc(sizeofcopycom,"cc2(copycom)");
     memcpy(copycom,selectcom,sizeofcopycom);
 
     // Now see if the selected ships are already in the command layer, and if so, individually order these groups
@@ -6116,7 +6116,7 @@ void clAttack(CommandLayer *comlayer,SelectCommand *selectcom,AttackCommand *att
         clAttackThese(comlayer,copycom,attackcom);
     }
 
-    memFree(copycom);
+    memFrameFree(copycom);
 }
 /*-----------------------------------------------------------------------------
     Name        : canChangeOrderToPassiveAttack
@@ -6872,7 +6872,7 @@ void clHalt(CommandLayer *comlayer,SelectCommand *selectcom)
     }
 
     sizeofcopycom = sizeofSelectCommand(selectcom->numShips);
-    copycom = memAlloc(sizeofcopycom,"cc2(copycom)", Pyrophoric);
+    copycom = memFrameAlloc(sizeofcopycom,"cc2(copycom)");
     memcpy(copycom,selectcom,sizeofcopycom);
 
     // Now see if the selected ships are already in the command layer, and if so, individually order these groups
@@ -6912,7 +6912,7 @@ void clHalt(CommandLayer *comlayer,SelectCommand *selectcom)
         clHaltThese(comlayer,copycom);
     }
 
-    memFree(copycom);
+    memFrameFree(copycom);
 }
 
 /*-----------------------------------------------------------------------------
@@ -7050,42 +7050,38 @@ void clLaunchMultipleShips(CommandLayer *comlayer,SelectCommand *selectcom,ShipP
 ----------------------------------------------------------------------------*/
 void LaunchAllInternalShipsOfPlayerThatMustBeLaunched(struct Player *player)
 {
-    Node *objnode = universe.ShipList.head;
-    Ship *ship;
+    Ship *ship, **playerShips;
+    sdword i, numPlayerShips;
 
-    while (objnode != NULL)
+    numPlayerShips = univShipsOfPlayer(player->playerIndex, &playerShips);
+    for (i = 0; i < numPlayerShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(objnode);
+        ship = playerShips[i];
         dbgAssertOrIgnore(ship->objtype == OBJ_ShipType);
 
-        if (ship->playerowner == player)
+        if ((ship->shipsInsideMe) && (ship->shiptype != DDDFrigate))
         {
-            if ((ship->shipsInsideMe) && (ship->shiptype != DDDFrigate))
+            Node *insidenode = ship->shipsInsideMe->insideList.head;
+            InsideShip *insideship;
+            SelectCommand selectone;
+
+            while (insidenode != NULL)
             {
-                Node *insidenode = ship->shipsInsideMe->insideList.head;
-                InsideShip *insideship;
-                SelectCommand selectone;
+                insideship = (InsideShip *)listGetStructOfNode(insidenode);
+                dbgAssertOrIgnore(insideship->ship->objtype == OBJ_ShipType);
 
-                while (insidenode != NULL)
+                    // make defector launch
+                if ((insideship->ship->attributes & ATTRIBUTES_Defector) || (ShipHasToLaunch(ship,insideship->ship)))
                 {
-                    insideship = (InsideShip *)listGetStructOfNode(insidenode);
-                    dbgAssertOrIgnore(insideship->ship->objtype == OBJ_ShipType);
+                    selectone.numShips = 1;
+                    selectone.ShipPtr[0] = insideship->ship;
 
-                        // make defector launch
-                    if ((insideship->ship->attributes & ATTRIBUTES_Defector) || (ShipHasToLaunch(ship,insideship->ship)))
-                    {
-                        selectone.numShips = 1;
-                        selectone.ShipPtr[0] = insideship->ship;
-
-                        clLaunchShip(&universe.mainCommandLayer,&selectone,ship);
-                    }
-
-                    insidenode = insidenode->next;
+                    clLaunchShip(&universe.mainCommandLayer,&selectone,ship);
                 }
+
+                insidenode = insidenode->next;
             }
         }
-
-        objnode = objnode->next;
     }
 }
 
@@ -7131,56 +7127,52 @@ void FillInCarrierMothershipInfo(struct Player *player,Ship **mothership,Ship *c
 ----------------------------------------------------------------------------*/
 sdword LaunchAllInternalShipsOfPlayer(struct Player *player, udword carriermask)
 {
-    Node *objnode = universe.ShipList.head;
-    Ship *ship;
+    Ship *ship, **playerShips;
     Ship *mothership;
     Ship *carriers[4];
+    sdword i, numPlayerShips;
     sdword numShips = 0;
 
     FillInCarrierMothershipInfo(player,&mothership,carriers);
 
-    while (objnode != NULL)
+    numPlayerShips = univShipsOfPlayer(player->playerIndex, &playerShips);
+    for (i = 0; i < numPlayerShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(objnode);
+        ship = playerShips[i];
         dbgAssertOrIgnore(ship->objtype == OBJ_ShipType);
 
-        if (ship->playerowner == player)
+        if ((ship->shipsInsideMe) && (ship->shiptype != DDDFrigate))
         {
-            if ((ship->shipsInsideMe) && (ship->shiptype != DDDFrigate))
+            if ( ((carriermask & BIT0) && (ship == mothership)) ||
+                 ((carriermask & BIT1) && (ship == carriers[0])) ||
+                 ((carriermask & BIT2) && (ship == carriers[1])) ||
+                 ((carriermask & BIT3) && (ship == carriers[2])) ||
+                 ((carriermask & BIT4) && (ship == carriers[3])) )
             {
-                if ( ((carriermask & BIT0) && (ship == mothership)) ||
-                     ((carriermask & BIT1) && (ship == carriers[0])) ||
-                     ((carriermask & BIT2) && (ship == carriers[1])) ||
-                     ((carriermask & BIT3) && (ship == carriers[2])) ||
-                     ((carriermask & BIT4) && (ship == carriers[3])) )
+                Node *insidenode = ship->shipsInsideMe->insideList.head;
+                InsideShip *insideship;
+                SelectCommand selectone;
+
+                while (insidenode != NULL)
                 {
-                    Node *insidenode = ship->shipsInsideMe->insideList.head;
-                    InsideShip *insideship;
-                    SelectCommand selectone;
+                    insideship = (InsideShip *)listGetStructOfNode(insidenode);
+                    dbgAssertOrIgnore(insideship->ship->objtype == OBJ_ShipType);
 
-                    while (insidenode != NULL)
+                    if (!(insideship->ship->attributes & ATTRIBUTES_Defector))      // don't let the defector launch
                     {
-                        insideship = (InsideShip *)listGetStructOfNode(insidenode);
-                        dbgAssertOrIgnore(insideship->ship->objtype == OBJ_ShipType);
-
-                        if (!(insideship->ship->attributes & ATTRIBUTES_Defector))      // don't let the defector launch
-                        {
-                            selectone.numShips = 1;
-                            selectone.ShipPtr[0] = insideship->ship;
-
-                            clLaunchShip(&universe.mainCommandLayer,&selectone,ship);
-                            numShips++;
-                        }
+                        selectone.numShips = 1;
+                        selectone.ShipPtr[0] = insideship->ship;
 
-                        insidenode = insidenode->next;
+                        clLaunchShip(&universe.mainCommandLayer,&selectone,ship);
+                        numShips++;
                     }
 
+                    insidenode = insidenode->next;
                 }
 
             }
-        }
 
-        objnode = objnode->next;
+        }
     }
 
     return (numShips);
@@ -7794,27 +7786,21 @@ void AddShipToFormationGroup(ShipPtr ship,CommandToDo *group)
 ----------------------------------------------------------------------------*/
 bool thereareothercompatibleresearchships(Ship *ship)
 {
-    Node *resnode;
-    Ship *resship;
+    Ship **resships;
+    sdword i, numResShips;
 
     dbgAssertOrIgnore(ship->shiptype == ResearchShip);
 
-    resnode = universe.ShipList.head;
-
     if(((ResearchShipSpec *)ship->ShipSpecifics)->master)
         return FALSE;
 
-    while(resnode != NULL)
+    numResShips = univShipsOfPlayerType(ship->playerowner->playerIndex, ResearchShip, &resships);
+    for (i = 0; i < numResShips; i++)
     {
-        resship = (Ship *) listGetStructOfNode(resnode);
-        if(resship->shiptype == ResearchShip && resship->playerowner == ship->playerowner)
+        if(resships[i] != ship)
         {    //there exists a ship to dock with...
-            if(resship != ship)
-            {
-                return TRUE;
-            }
+            return TRUE;
         }
-        resnode = resnode->next;
     }
 
     return FALSE;
@@ -45,6 +45,8 @@ udword syncpkts = 0;
 udword cmdpkts = 0;
 udword syncoverruns = 0;
 udword cmdoverruns = 0;
+udword syncsegments = 0;
+udword cmdsegments = 0;
 
 // Keep Alive variables
 
@@ -112,6 +114,8 @@ void CommandNetworkReset(void)
     cmdpkts = 0;
     syncoverruns = 0;
     cmdoverruns = 0;
+    syncsegments = 0;
+    cmdsegments = 0;
 
     printCaptainMessage = FALSE;
     numPlayerDropped = 0;
@@ -1898,11 +1902,9 @@ WaitPacketStatus clWaitSyncPacket(CommandLayer *comlayer)
 
     if (explicitlyRequestingPackets)
     {
-        LockQueue(&ProcessRequestedSyncPktQ);
         numPackets = queueNumberEntries(ProcessRequestedSyncPktQ);
         if (numPackets == 0)
         {
-            UnLockQueue(&ProcessRequestedSyncPktQ);
             return NO_PACKET;
         }
         else
@@ -1911,7 +1913,7 @@ WaitPacketStatus clWaitSyncPacket(CommandLayer *comlayer)
             dbgAssertOrIgnore(sizeofPacket > 0);
             copypacket = memAlloc(sizeofPacket,"cp(copypacket)",Pyrophoric);
             memcpy(copypacket,packet,sizeofPacket);
-            UnLockQueue(&ProcessRequestedSyncPktQ);
+            HWDequeueDone(&ProcessRequestedSyncPktQ);
 
             dbgAssertOrIgnore(((HWPacketHeader *)copypacket)->type == PACKETTYPE_REQUESTEDSYNC);
             ((HWPacketHeader *)copypacket)->type = PACKETTYPE_SYNC;
@@ -1930,11 +1932,9 @@ WaitPacketStatus clWaitSyncPacket(CommandLayer *comlayer)
         }
     }
 
-    LockQueue(&ProcessSyncPktQ);
     numPackets = queueNumberEntries(ProcessSyncPktQ);
     if (numPackets == 0)
     {
-        UnLockQueue(&ProcessSyncPktQ);
         return NO_PACKET;
     }
     else
@@ -1967,14 +1967,14 @@ WaitPacketStatus clWaitSyncPacket(CommandLayer *comlayer)
                 explicitlyRequestingFrom = receivedPacketNumber;
                 explicitlyRequestingTo = ((HWPacketHeader *)packet)->frame - 1;
 
-                UnLockQueue(&ProcessSyncPktQ);
+                HWDequeueDone(&ProcessSyncPktQ);
 
                 SendRequestSyncPkts(explicitlyRequestingFrom,explicitlyRequestingTo);
                 explicitlyRequestingPackets = TRUE;
             }
             else
             {
-                UnLockQueue(&ProcessSyncPktQ);
+                HWDequeueDone(&ProcessSyncPktQ);
             }
             return NO_PACKET;
 
@@ -1984,7 +1984,7 @@ getnextpacket:
             numPackets = queueNumberEntries(ProcessSyncPktQ);
             if (numPackets == 0)
             {
-                UnLockQueue(&ProcessSyncPktQ);
+                HWDequeueDone(&ProcessSyncPktQ);
                 return NO_PACKET;
             }
             sizeofPacket = Peekqueue(&ProcessSyncPktQ,&packet);
@@ -1993,7 +1993,7 @@ getnextpacket:
 
         copypacket = memAlloc(sizeofPacket,"cp(copypacket)",Pyrophoric);
         memcpy(copypacket,packet,sizeofPacket);
-        UnLockQueue(&ProcessSyncPktQ);
+        HWDequeueDone(&ProcessSyncPktQ);
 gotsyncpkt:
         clProcessSyncPacket(comlayer,copypacket,sizeofPacket);
         EnterIntoLastSyncPktsQ(((HWPacketHeader *)copypacket)->frame,(HWPacketHeader *)copypacket,sizeofPacket);  // last sync packets may be used to recover game if this player takes over as captain
@@ -2056,7 +2056,6 @@ DEFINE_TASK(captainServerTask)
 
             numCommands = 0;
 
-            LockQueue(&ProcessCmdPktQ);
             qTotalNumberEntries = queueNumberEntries(ProcessCmdPktQ);
             if (qTotalNumberEntries == 0)
             {
@@ -2067,7 +2066,7 @@ DEFINE_TASK(captainServerTask)
                 qinfos = memAlloc(sizeof(QInfo)*qTotalNumberEntries,"qinfos",0);
             }
 
-            while (queueNumberEntries(ProcessCmdPktQ) > 0)
+            while (numCommands < qTotalNumberEntries)      // more may arrive meanwhile, they wait for the next sync packet
             {
                 curqinfo = &qinfos[numCommands];
                 curqinfo->qsizeof = HWDequeue(&ProcessCmdPktQ,(ubyte **)&curqinfo->qdata);
@@ -2131,7 +2130,7 @@ DEFINE_TASK(captainServerTask)
             {
                 memFree(qinfos);
             }
-            UnLockQueue(&ProcessCmdPktQ);
+            HWDequeueDone(&ProcessCmdPktQ);
 
             packet->type = PACKETTYPE_SYNC;
             packet->from = (uword)sigsPlayerIndex;
@@ -2445,6 +2444,8 @@ void netCheck(void)
     udword rcmdpkts;
     udword rsyncoverruns;
     udword rcmdoverruns;
+    udword rsyncsegments;
+    udword rcmdsegments;
 
     if (unknownPackets != printedUnknownPackets)
     {
@@ -2456,6 +2457,8 @@ void netCheck(void)
     rcmdpkts = queueNumberEntries(ProcessCmdPktQ);
     rsyncoverruns = queueNumberOverruns(ProcessSyncPktQ);
     rcmdoverruns = queueNumberOverruns(ProcessCmdPktQ);
+    rsyncsegments = queueNumberSegments(ProcessSyncPktQ);
+    rcmdsegments = queueNumberSegments(ProcessCmdPktQ);
 
     if (syncpkts != rsyncpkts)
     {
@@ -2478,6 +2481,18 @@ void netCheck(void)
         cmdoverruns = rcmdoverruns;
         dbgMessagef("Cmd Q Overruns: %d",cmdoverruns);
     }
+
+    if (syncsegments != rsyncsegments)
+    {
+        syncsegments = rsyncsegments;
+        dbgMessagef("Sync Q grew, high water %d packets %d bytes",queueHighWaterEntries(ProcessSyncPktQ),queueHighWaterSize(ProcessSyncPktQ));
+    }
+
+    if (cmdsegments != rcmdsegments)
+    {
+        cmdsegments = rcmdsegments;
+        dbgMessagef("Cmd Q grew, high water %d packets %d bytes",queueHighWaterEntries(ProcessCmdPktQ),queueHighWaterSize(ProcessCmdPktQ));
+    }
 }
 
 void CaptaincyChangedNotify(void)
@@ -0,0 +1,579 @@
+// =============================================================================
+//  Cull.c
+//  - view frustum and LOD distance pass over the render list, done for all
+//    objects at once on packed arrays so the renderer can skip most of its
+//    per-object box tests
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "Cull.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "FastMath.h"
+#include "Memory.h"
+#include "SSE.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool cullEnabled = TRUE;
+cullstats cullStats;
+
+//the last pass, in render list order.  Arrays are padded to a multiple of
+//4 so the SSE loops can run off the end.
+static sdword cullCapacity = 0;
+static sdword cullNumberObjects = 0;
+static sdword cullCursor = 0;                   // where the next lookup starts
+static SpaceObj **cullObj = NULL;
+static real32 *cullX = NULL;                    // origin of the object's model transform
+static real32 *cullY = NULL;
+static real32 *cullZ = NULL;
+static real32 *cullRadius = NULL;               // around the origin, including any scaling
+static real32 *cullLodX = NULL;                 // point lodLevelGet measures to
+static real32 *cullLodY = NULL;
+static real32 *cullLodZ = NULL;
+static real32 *cullDX = NULL;                   // eye - LOD point
+static real32 *cullDY = NULL;
+static real32 *cullDZ = NULL;
+static real32 *cullDistanceSquared = NULL;
+static ubyte *cullVerdict = NULL;
+
+//the last pass over the minor render list, in list order, padded the same way
+static sdword cullMinorCapacity = 0;
+static sdword cullMinorNumberObjects = 0;
+static real32 *cullMinorX = NULL;
+static real32 *cullMinorY = NULL;
+static real32 *cullMinorZ = NULL;
+static real32 *cullMinorRadius = NULL;
+static ubyte *cullMinorVerdict = NULL;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : cullFrustumMake
+    Description : Gets the six clip planes of a camera in world space.  They
+                  are the same half-spaces clipProjectPoints tests against.
+    Inputs      : camera, projection - GL modelview and projection matrices
+    Outputs     : frustum - normalized planes
+    Return      :
+----------------------------------------------------------------------------*/
+void cullFrustumMake(cullfrustum *frustum, hmatrix *camera, hmatrix *projection)
+{
+    hmatrix clip;
+    real32 *c = (real32 *)&clip;
+    real32 sign, length;
+    sdword plane, axis;
+
+    hmatMultiplyHMatByHMat(&clip, projection, camera);
+
+    //left/right from row 0, bottom/top from row 1, near/far from row 2,
+    //each added to or taken from the w row
+    for (plane = 0; plane < CULL_NumberPlanes; plane++)
+    {
+        axis = plane / 2;
+        sign = (plane & 1) ? -1.0f : 1.0f;
+        frustum->x[plane] = c[3] + sign * c[axis];
+        frustum->y[plane] = c[7] + sign * c[4 + axis];
+        frustum->z[plane] = c[11] + sign * c[8 + axis];
+        frustum->d[plane] = c[15] + sign * c[12 + axis];
+
+        length = fsqrt(frustum->x[plane] * frustum->x[plane] +
+                       frustum->y[plane] * frustum->y[plane] +
+                       frustum->z[plane] * frustum->z[plane]);
+        if (length > 0.0f)
+        {
+            length = 1.0f / length;
+            frustum->x[plane] *= length;
+            frustum->y[plane] *= length;
+            frustum->z[plane] *= length;
+            frustum->d[plane] *= length;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBoxRadius
+    Description : Radius around the object's origin of the box that
+                  clipBBoxIsClipped tests, so it holds whatever the rotation.
+    Inputs      : collrectoffset, uplength, rightlength, forwardlength - the
+                    box, as in the static collision info
+                  scale - scaling the renderer applies to the object
+    Outputs     :
+    Return      : radius, grown by CULL_RadiusSlack and CULL_RadiusPad
+----------------------------------------------------------------------------*/
+real32 cullBoxRadius(vector *collrectoffset, real32 uplength, real32 rightlength, real32 forwardlength, real32 scale)
+{
+    vector centre;
+    real32 halfDiagonal;
+
+    centre.x = collrectoffset->x + uplength * 0.5f;
+    centre.y = collrectoffset->y + rightlength * 0.5f;
+    centre.z = collrectoffset->z + forwardlength * 0.5f;
+    halfDiagonal = 0.5f * fsqrt(uplength * uplength + rightlength * rightlength + forwardlength * forwardlength);
+
+    return((fsqrt(vecMagnitudeSquared(centre)) + halfDiagonal) * (real32)fabs(scale) * CULL_RadiusSlack + CULL_RadiusPad);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullSpheres
+    Description : Tests spheres against a frustum
+    Inputs      : frustum - planes from cullFrustumMake
+                  n - number of spheres
+                  x, y, z, radius - the spheres.  With SSE the arrays are
+                    read in fours, so must have room up to the next
+                    multiple of 4.
+    Outputs     : verdict - CULL_Outside, CULL_Inside or CULL_Partial for
+                    each sphere, same padding
+    Return      :
+----------------------------------------------------------------------------*/
+void cullSpheres(cullfrustum *frustum, sdword n, real32 *x, real32 *y, real32 *z, real32 *radius, ubyte *verdict)
+{
+    sdword index, plane;
+#if HW_SSE
+    __m128 px, py, pz, r, negR, distance, outside, straddle;
+    sdword outsideBits, straddleBits, lane;
+
+    for (index = 0; index < n; index += 4)
+    {
+        px = _mm_loadu_ps(x + index);
+        py = _mm_loadu_ps(y + index);
+        pz = _mm_loadu_ps(z + index);
+        r = _mm_loadu_ps(radius + index);
+        negR = _mm_sub_ps(_mm_setzero_ps(), r);
+        outside = _mm_setzero_ps();
+        straddle = _mm_setzero_ps();
+
+        for (plane = 0; plane < CULL_NumberPlanes; plane++)
+        {
+            distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(frustum->x[plane])),
+                                             _mm_mul_ps(py, _mm_set1_ps(frustum->y[plane]))),
+                                  _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(frustum->z[plane])),
+                                             _mm_set1_ps(frustum->d[plane])));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negR));
+            straddle = _mm_or_ps(straddle, _mm_cmplt_ps(distance, r));
+        }
+
+        outsideBits = _mm_movemask_ps(outside);
+        straddleBits = _mm_movemask_ps(straddle);
+        for (lane = 0; lane < 4; lane++)
+        {
+            verdict[index + lane] = (outsideBits & (1 << lane)) ? CULL_Outside :
+                                    (straddleBits & (1 << lane)) ? CULL_Partial : CULL_Inside;
+        }
+    }
+#else
+    real32 distance;
+    bool outside, straddle;
+
+    for (index = 0; index < n; index++)
+    {
+        outside = straddle = FALSE;
+        for (plane = 0; plane < CULL_NumberPlanes; plane++)
+        {
+            distance = x[index] * frustum->x[plane] + y[index] * frustum->y[plane] +
+                       z[index] * frustum->z[plane] + frustum->d[plane];
+            outside |= (distance < -radius[index]);
+            straddle |= (distance < radius[index]);
+        }
+        verdict[index] = outside ? CULL_Outside : (straddle ? CULL_Partial : CULL_Inside);
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullDistances
+    Description : Gets the vector and distance squared from points to the eye,
+                  as lodLevelGet works them out.
+    Inputs      : eye - camera position
+                  n, x, y, z - the points, padded as for cullSpheres
+    Outputs     : dx, dy, dz - eye - point
+                  distanceSquared
+    Return      :
+----------------------------------------------------------------------------*/
+void cullDistances(vector *eye, sdword n, real32 *x, real32 *y, real32 *z,
+                   real32 *dx, real32 *dy, real32 *dz, real32 *distanceSquared)
+{
+    sdword index;
+#if HW_SSE
+    __m128 ex = _mm_set1_ps(eye->x), ey = _mm_set1_ps(eye->y), ez = _mm_set1_ps(eye->z);
+    __m128 vx, vy, vz;
+
+    for (index = 0; index < n; index += 4)
+    {
+        vx = _mm_sub_ps(ex, _mm_loadu_ps(x + index));
+        vy = _mm_sub_ps(ey, _mm_loadu_ps(y + index));
+        vz = _mm_sub_ps(ez, _mm_loadu_ps(z + index));
+        _mm_storeu_ps(dx + index, vx);
+        _mm_storeu_ps(dy + index, vy);
+        _mm_storeu_ps(dz + index, vz);
+        _mm_storeu_ps(distanceSquared + index,
+                      _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+    }
+#else
+    for (index = 0; index < n; index++)
+    {
+        dx[index] = eye->x - x[index];
+        dy[index] = eye->y - y[index];
+        dz[index] = eye->z - z[index];
+        distanceSquared[index] = dx[index] * dx[index] + dy[index] * dy[index] + dz[index] * dz[index];
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullGrow
+    Description : Makes room in the packed arrays
+    Inputs      : number - objects to make room for
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void cullGrow(sdword number)
+{
+    number = (number + CULL_GrowBatch - 1) / CULL_GrowBatch * CULL_GrowBatch;
+    if (number <= cullCapacity)
+    {
+        return;
+    }
+
+    if (cullObj != NULL)
+    {
+        memFree(cullObj);
+        memFree(cullX);
+        memFree(cullVerdict);
+    }
+    cullCapacity = number;
+    cullObj = memAlloc(sizeof(SpaceObj *) * number, "CullObjects", NonVolatile);
+    cullX = memAlloc(sizeof(real32) * number * 11, "CullArrays", NonVolatile);
+    cullY = cullX + number;
+    cullZ = cullY + number;
+    cullRadius = cullZ + number;
+    cullLodX = cullRadius + number;
+    cullLodY = cullLodX + number;
+    cullLodZ = cullLodY + number;
+    cullDX = cullLodZ + number;
+    cullDY = cullDX + number;
+    cullDZ = cullDY + number;
+    cullDistanceSquared = cullDZ + number;
+    cullVerdict = memAlloc(number, "CullVerdicts", NonVolatile);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullPack
+    Description : Copies an object's sphere and LOD point into the arrays.
+                  Objects rndShipVisible tests with a box get a sphere that
+                  holds the box after the scaling the renderer does;
+                  everything else gets one that always comes out partial.
+    Inputs      : index - where to put it
+                  obj - object
+                  camera - GL modelview matrix of the camera
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void cullPack(sdword index, SpaceObj *obj, hmatrix *camera)
+{
+    StaticCollInfo *sinfo;
+    vector *lodPoint = &obj->posinfo.position;
+    real32 scale = 1.0f, eyeZ;
+
+    cullObj[index] = obj;
+    cullX[index] = obj->posinfo.position.x;
+    cullY[index] = obj->posinfo.position.y;
+    cullZ[index] = obj->posinfo.position.z;
+    cullRadius[index] = CULL_Untested;
+
+    if (bitTest(obj->flags, SOF_Impactable))
+    {
+        lodPoint = &((SpaceObjRotImp *)obj)->collInfo.collPosition;
+    }
+    cullLodX[index] = lodPoint->x;
+    cullLodY[index] = lodPoint->y;
+    cullLodZ[index] = lodPoint->z;
+
+    if (!bitTest(obj->flags, SOF_Rotatable) || !bitTest(obj->flags, SOF_Impactable) || obj->staticinfo == NULL)
+    {
+        return;
+    }
+
+    //same scaling the renderer applies before its box test
+    if (obj->objtype == OBJ_ShipType)
+    {
+        ShipStaticInfo *shipStatic = (ShipStaticInfo *)obj->staticinfo;
+
+        if (shipStatic->scaleCap != 0.0f)
+        {
+            if (bitTest(obj->flags, SOF_Slaveable))
+            {                                               //scaled by where the whole group is; leave it to the box test
+                return;
+            }
+            //depth of the point selCircleCompute puts in selCameraSpace
+            eyeZ = camera->m31 * lodPoint->x + camera->m32 * lodPoint->y + camera->m33 * lodPoint->z + camera->m34;
+            if (eyeZ < 0.0f)
+            {
+                scale = 1.0f - eyeZ * shipStatic->scaleCap;
+            }
+        }
+#if SO_CLOOGE_SCALE
+        scale *= shipStatic->scaleFactor;
+#endif
+    }
+    else if (obj->objtype == OBJ_AsteroidType)
+    {
+        scale = ((Asteroid *)obj)->scaling;
+    }
+
+    sinfo = &((SpaceObjRotImp *)obj)->staticinfo->staticheader.staticCollInfo;
+    cullRadius[index] = cullBoxRadius(&sinfo->collrectoffset, sinfo->uplength, sinfo->rightlength,
+                                      sinfo->forwardlength, scale);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullRenderList
+    Description : Runs the frustum and LOD distance pass over the render
+                  list for the camera about to be drawn.  The results are
+                  good until the list or the camera changes.
+    Inputs      : camera, projection - GL modelview and projection matrices
+                  eye - camera position
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void cullRenderList(hmatrix *camera, hmatrix *projection, vector *eye)
+{
+    cullfrustum frustum;
+    Node *node;
+    sdword index, padded;
+    sqword timeStart, timeStop;
+
+    cullNumberObjects = 0;
+    cullCursor = 0;
+    if (!cullEnabled)
+    {
+        return;
+    }
+
+    GetRawTime(&timeStart);
+
+    padded = (universe.RenderList.num + 3) & ~3;
+    cullGrow(padded);
+
+    for (node = universe.RenderList.head, index = 0; node != NULL; node = node->next, index++)
+    {
+        cullPack(index, (SpaceObj *)listGetStructOfNode(node), camera);
+    }
+    dbgAssertOrIgnore((udword)index == universe.RenderList.num);
+    for (cullNumberObjects = index; index < padded; index++)
+    {
+        cullX[index] = cullY[index] = cullZ[index] = 0.0f;
+        cullLodX[index] = cullLodY[index] = cullLodZ[index] = 0.0f;
+        cullRadius[index] = CULL_Untested;
+    }
+
+    cullFrustumMake(&frustum, camera, projection);
+    cullSpheres(&frustum, cullNumberObjects, cullX, cullY, cullZ, cullRadius, cullVerdict);
+    cullDistances(eye, cullNumberObjects, cullLodX, cullLodY, cullLodZ, cullDX, cullDY, cullDZ, cullDistanceSquared);
+
+    GetRawTime(&timeStop);
+
+    cullStats.nPasses++;
+    cullStats.nObjects += cullNumberObjects;
+    cullStats.passTime += timeStop - timeStart;
+    for (index = 0; index < cullNumberObjects; index++)
+    {
+        switch (cullVerdict[index])
+        {
+            case CULL_Outside:
+                cullStats.nOutside++;
+                break;
+            case CULL_Inside:
+                cullStats.nInside++;
+                break;
+            default:
+                cullStats.nPartial++;
+                break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullResultFind
+    Description : Finds an object's results from the last pass.  Meant to be
+                  called for each object while walking the render list in
+                  order, which makes it a compare or two.
+    Inputs      : obj - object being drawn
+    Outputs     :
+    Return      : index of the results, or CULL_NoResult if the object
+                    wasn't in the pass
+----------------------------------------------------------------------------*/
+sdword cullResultFind(SpaceObj *obj)
+{
+    sdword index;
+
+    for (index = cullCursor; index < cullNumberObjects && index < cullCursor + CULL_FindWindow; index++)
+    {
+        if (cullObj[index] == obj)
+        {
+            cullCursor = index + 1;
+            cullStats.nLookups++;
+            return(index);
+        }
+    }
+    return(CULL_NoResult);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullVerdictGet
+    Description : Gets what the pass found out about an object
+    Inputs      : index - from cullResultFind
+    Outputs     :
+    Return      : CULL_Outside, CULL_Inside or CULL_Partial
+----------------------------------------------------------------------------*/
+ubyte cullVerdictGet(sdword index)
+{
+    dbgAssertOrIgnore(index >= 0 && index < cullNumberObjects);
+    return(cullVerdict[index]);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullCameraDistanceGet
+    Description : Gets the vector from an object's LOD point to the eye
+    Inputs      : index - from cullResultFind
+    Outputs     : distanceVector - eye - LOD point
+    Return      : distance squared
+----------------------------------------------------------------------------*/
+real32 cullCameraDistanceGet(sdword index, vector *distanceVector)
+{
+    dbgAssertOrIgnore(index >= 0 && index < cullNumberObjects);
+    distanceVector->x = cullDX[index];
+    distanceVector->y = cullDY[index];
+    distanceVector->z = cullDZ[index];
+    return(cullDistanceSquared[index]);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullMinorRenderList
+    Description : Runs the frustum pass over the minor render list, which is
+                  drawn as single points.  GL drops a point whose centre is
+                  clipped, so each one is tested as a sphere just big enough
+                  to cover rounding.
+    Inputs      : camera, projection - GL modelview and projection matrices
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void cullMinorRenderList(hmatrix *camera, hmatrix *projection)
+{
+    cullfrustum frustum;
+    Node *node;
+    SpaceObj *obj;
+    sdword index, padded;
+    sqword timeStart, timeStop;
+
+    cullMinorNumberObjects = 0;
+    if (!cullEnabled)
+    {
+        return;
+    }
+
+    GetRawTime(&timeStart);
+
+    padded = (universe.MinorRenderList.num + 3) & ~3;
+    if (padded > cullMinorCapacity)
+    {
+        if (cullMinorX != NULL)
+        {
+            memFree(cullMinorX);
+            memFree(cullMinorVerdict);
+        }
+        cullMinorCapacity = (padded + CULL_GrowBatch - 1) / CULL_GrowBatch * CULL_GrowBatch;
+        cullMinorX = memAlloc(sizeof(real32) * cullMinorCapacity * 4, "CullMinorArrays", NonVolatile);
+        cullMinorY = cullMinorX + cullMinorCapacity;
+        cullMinorZ = cullMinorY + cullMinorCapacity;
+        cullMinorRadius = cullMinorZ + cullMinorCapacity;
+        cullMinorVerdict = memAlloc(cullMinorCapacity, "CullMinorVerdicts", NonVolatile);
+    }
+
+    for (node = universe.MinorRenderList.head, index = 0; node != NULL; node = node->next, index++)
+    {
+        obj = (SpaceObj *)listGetStructOfNode(node);
+        cullMinorX[index] = obj->posinfo.position.x;
+        cullMinorY[index] = obj->posinfo.position.y;
+        cullMinorZ[index] = obj->posinfo.position.z;
+        cullMinorRadius[index] = CULL_RadiusPad;
+    }
+    dbgAssertOrIgnore((udword)index == universe.MinorRenderList.num);
+    for (cullMinorNumberObjects = index; index < padded; index++)
+    {
+        cullMinorX[index] = cullMinorY[index] = cullMinorZ[index] = 0.0f;
+        cullMinorRadius[index] = CULL_Untested;
+    }
+
+    cullFrustumMake(&frustum, camera, projection);
+    cullSpheres(&frustum, cullMinorNumberObjects, cullMinorX, cullMinorY, cullMinorZ, cullMinorRadius, cullMinorVerdict);
+
+    GetRawTime(&timeStop);
+
+    cullStats.nMinorObjects += cullMinorNumberObjects;
+    cullStats.passTime += timeStop - timeStart;
+    for (index = 0; index < cullMinorNumberObjects; index++)
+    {
+        if (cullMinorVerdict[index] == CULL_Outside)
+        {
+            cullStats.nMinorOutside++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullMinorVisible
+    Description : Says if a minor render list point needs drawing
+    Inputs      : index - place of the object in the minor render list
+    Outputs     :
+    Return      : FALSE if the last pass found it outside the frustum
+----------------------------------------------------------------------------*/
+bool cullMinorVisible(sdword index)
+{
+    if (index >= cullMinorNumberObjects)
+    {                                                       //pass was off, or the list grew since
+        return(TRUE);
+    }
+    return(cullMinorVerdict[index] != CULL_Outside);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullClose
+    Description : Frees the packed arrays
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void cullClose(void)
+{
+    if (cullObj != NULL)
+    {
+        memFree(cullObj);
+        memFree(cullX);
+        memFree(cullVerdict);
+        cullObj = NULL;
+        cullX = NULL;
+        cullVerdict = NULL;
+    }
+    if (cullMinorX != NULL)
+    {
+        memFree(cullMinorX);
+        memFree(cullMinorVerdict);
+        cullMinorX = NULL;
+        cullMinorVerdict = NULL;
+    }
+    cullCapacity = 0;
+    cullNumberObjects = 0;
+    cullCursor = 0;
+    cullMinorCapacity = 0;
+    cullMinorNumberObjects = 0;
+}
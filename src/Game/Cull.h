@@ -0,0 +1,91 @@
+// =============================================================================
+//  Cull.h
+//  - view frustum and LOD distance pass over the render list, done for all
+//    objects at once on packed arrays so the renderer can skip most of its
+//    per-object box tests
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___CULL_H
+#define ___CULL_H
+
+#include "Matrix.h"
+#include "SpaceObj.h"
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+//what the pass found out about an object
+#define CULL_Outside            0               // bounding sphere is all outside one frustum plane
+#define CULL_Inside             1               // bounding sphere is inside every plane
+#define CULL_Partial            2               // straddles a plane, or can't be tested; use the box test
+
+#define CULL_NumberPlanes       6
+#define CULL_GrowBatch          256             // packed arrays grow by this many objects
+#define CULL_FindWindow         8               // how far ahead of the last lookup to look for an object
+#define CULL_NoResult           -1
+
+//spheres are grown a little so float rounding never gives a different
+//answer than the box test would
+#define CULL_RadiusSlack        1.01f
+#define CULL_RadiusPad          1.0f
+#define CULL_Untested           1.0e30f         // radius that always comes out CULL_Partial
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//frustum planes in world space, normalized.  A point is inside a plane when
+//x * px + y * py + z * pz + d >= 0.
+typedef struct
+{
+    real32 x[CULL_NumberPlanes];
+    real32 y[CULL_NumberPlanes];
+    real32 z[CULL_NumberPlanes];
+    real32 d[CULL_NumberPlanes];
+}
+cullfrustum;
+
+typedef struct
+{
+    udword nPasses;
+    udword nObjects;                            // objects packed, over all passes
+    udword nOutside;
+    udword nInside;
+    udword nPartial;
+    udword nLookups;                            // renderer lookups answered from a pass
+    udword nMinorObjects;                       // minor render list points tested, over all passes
+    udword nMinorOutside;
+    sqword passTime;                            // time spent in passes, in GetRawTime units
+}
+cullstats;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool cullEnabled;
+extern cullstats cullStats;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void cullFrustumMake(cullfrustum *frustum, hmatrix *camera, hmatrix *projection);
+real32 cullBoxRadius(vector *collrectoffset, real32 uplength, real32 rightlength, real32 forwardlength, real32 scale);
+void cullSpheres(cullfrustum *frustum, sdword n, real32 *x, real32 *y, real32 *z, real32 *radius, ubyte *verdict);
+void cullDistances(vector *eye, sdword n, real32 *x, real32 *y, real32 *z,
+                   real32 *dx, real32 *dy, real32 *dz, real32 *distanceSquared);
+
+void cullRenderList(hmatrix *camera, hmatrix *projection, vector *eye);
+sdword cullResultFind(SpaceObj *obj);
+ubyte cullVerdictGet(sdword index);
+real32 cullCameraDistanceGet(sdword index, vector *distanceVector);
+void cullMinorRenderList(hmatrix *camera, hmatrix *projection);
+bool cullMinorVisible(sdword index);
+void cullClose(void);
+
+#endif
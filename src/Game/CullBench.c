@@ -0,0 +1,385 @@
+// =============================================================================
+//  CullBench.c
+//  - headless culling benchmark, flies a camera out of a synthetic battle
+//    and times the batched cull pass against a box test of every object
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "CullBench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Clipper.h"
+#include "Cull.h"
+#include "FastMath.h"
+#include "main.h"
+#include "Matrix.h"
+#include "TimeoutTimer.h"
+#include "Vector.h"
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//a ship's worth of what the renderer looks at
+typedef struct
+{
+    hmatrix model;                              // coordsys and position, as glMultMatrixf'd
+    vector position;
+    vector collrectoffset;                      // collision box, as in StaticCollInfo
+    real32 uplength;
+    real32 rightlength;
+    real32 forwardlength;
+}
+cullbenchobj;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool cullBenchEnabled = FALSE;
+static udword cullBenchFrames = CULLBENCH_DEFAULT_FRAMES;
+
+//own random numbers so the battle is the same every run
+static udword cullBenchSeed = 0x7654321;
+
+static cullbenchobj cullBenchObjects[CULLBENCH_OBJECTS];
+
+//packed the way the cull pass wants them
+static real32 cullBenchX[CULLBENCH_OBJECTS];
+static real32 cullBenchY[CULLBENCH_OBJECTS];
+static real32 cullBenchZ[CULLBENCH_OBJECTS];
+static real32 cullBenchRadius[CULLBENCH_OBJECTS];
+static real32 cullBenchDX[CULLBENCH_OBJECTS];
+static real32 cullBenchDY[CULLBENCH_OBJECTS];
+static real32 cullBenchDZ[CULLBENCH_OBJECTS];
+static real32 cullBenchDistanceSquared[CULLBENCH_OBJECTS];
+static ubyte cullBenchVerdict[CULLBENCH_OBJECTS];
+static real32 cullBenchBoxDistanceSquared[CULLBENCH_OBJECTS];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchSet
+    Description : Command-line handler for /cullBench <nFrames>
+    Inputs      : string - number of camera positions to cull from
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool cullBenchSet(char *string)
+{
+    sscanf(string, "%u", &cullBenchFrames);
+    if (cullBenchFrames == 0)
+    {
+        cullBenchFrames = CULLBENCH_DEFAULT_FRAMES;
+    }
+    cullBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchRandom
+    Description : Returns a random number from low to high
+    Inputs      : low, high - range of the number
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static real32 cullBenchRandom(real32 low, real32 high)
+{
+    cullBenchSeed = cullBenchSeed * 1664525 + 1013904223;
+    return(low + (high - low) * (real32)(cullBenchSeed >> 8) / (real32)(1 << 24));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchBattleMake
+    Description : Scatters fighters, frigates and capital ships around a
+                  sphere, pointing every which way
+    Inputs      :
+    Outputs     : fills in cullBenchObjects and the packed spheres
+    Return      :
+----------------------------------------------------------------------------*/
+static void cullBenchBattleMake(void)
+{
+    sdword index;
+    real32 size, kind;
+    vector position, heading;
+    matrix coordsys;
+    cullbenchobj *obj;
+
+    for (index = 0; index < CULLBENCH_OBJECTS; index++)
+    {
+        obj = &cullBenchObjects[index];
+
+        kind = cullBenchRandom(0.0f, 1.0f);
+        size = kind < 0.7f ? 40.0f : (kind < 0.9f ? 300.0f : 1500.0f);
+
+        do
+        {
+            position.x = cullBenchRandom(-CULLBENCH_BATTLE_SIZE, CULLBENCH_BATTLE_SIZE);
+            position.y = cullBenchRandom(-CULLBENCH_BATTLE_SIZE, CULLBENCH_BATTLE_SIZE);
+            position.z = cullBenchRandom(-CULLBENCH_BATTLE_SIZE, CULLBENCH_BATTLE_SIZE);
+        }
+        while (vecMagnitudeSquared(position) > CULLBENCH_BATTLE_SIZE * CULLBENCH_BATTLE_SIZE);
+
+        do
+        {
+            heading.x = cullBenchRandom(-1.0f, 1.0f);
+            heading.y = cullBenchRandom(-1.0f, 1.0f);
+            heading.z = cullBenchRandom(-1.0f, 1.0f);
+        }
+        while (vecMagnitudeSquared(heading) < 0.01f);
+        vecNormalize(&heading);
+        matCreateCoordSysFromHeading(&coordsys, &heading);
+        hmatMakeHMatFromMat(&obj->model, &coordsys);
+        hmatPutVectIntoHMatrixCol4(position, obj->model);
+        obj->position = position;
+
+        //boxes are longest along the heading and a little off centre, like the real ones
+        obj->uplength = size * cullBenchRandom(0.3f, 0.6f);
+        obj->rightlength = size * cullBenchRandom(0.5f, 1.0f);
+        obj->forwardlength = size * cullBenchRandom(1.0f, 1.5f);
+        obj->collrectoffset.x = -obj->uplength * 0.5f + size * cullBenchRandom(-0.1f, 0.1f);
+        obj->collrectoffset.y = -obj->rightlength * 0.5f + size * cullBenchRandom(-0.1f, 0.1f);
+        obj->collrectoffset.z = -obj->forwardlength * 0.5f + size * cullBenchRandom(-0.1f, 0.1f);
+
+        cullBenchX[index] = position.x;
+        cullBenchY[index] = position.y;
+        cullBenchZ[index] = position.z;
+        cullBenchRadius[index] = cullBoxRadius(&obj->collrectoffset, obj->uplength, obj->rightlength,
+                                               obj->forwardlength, 1.0f);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchCameraMake
+    Description : Builds the matrices rgluLookAt and rgluPerspective would
+                  leave in the GL, without a GL
+    Inputs      : eye, lookat, up - as for rgluLookAt
+    Outputs     : camera - modelview matrix
+                  projection - projection matrix
+    Return      :
+----------------------------------------------------------------------------*/
+static void cullBenchCameraMake(hmatrix *camera, hmatrix *projection, vector *eye, vector *lookat, vector *up)
+{
+    vector forward, side, upTrue;
+    real32 f;
+
+    vecSub(forward, *lookat, *eye);
+    vecNormalize(&forward);
+    vecCrossProduct(side, forward, *up);
+    vecNormalize(&side);
+    vecCrossProduct(upTrue, side, forward);
+
+    memset(camera, 0, sizeof(hmatrix));
+    camera->m11 = side.x;       camera->m12 = side.y;       camera->m13 = side.z;
+    camera->m21 = upTrue.x;     camera->m22 = upTrue.y;     camera->m23 = upTrue.z;
+    camera->m31 = -forward.x;   camera->m32 = -forward.y;   camera->m33 = -forward.z;
+    camera->m14 = -vecDotProduct(side, *eye);
+    camera->m24 = -vecDotProduct(upTrue, *eye);
+    camera->m34 = vecDotProduct(forward, *eye);
+    camera->m44 = 1.0f;
+
+    f = 1.0f / (real32)tan(DEG_TO_RAD(CULLBENCH_FIELD_OF_VIEW) * 0.5f);
+    memset(projection, 0, sizeof(hmatrix));
+    projection->m11 = f / CULLBENCH_ASPECT;
+    projection->m22 = f;
+    projection->m33 = (CULLBENCH_CLIP_FAR + CULLBENCH_CLIP_NEAR) / (CULLBENCH_CLIP_NEAR - CULLBENCH_CLIP_FAR);
+    projection->m34 = 2.0f * CULLBENCH_CLIP_FAR * CULLBENCH_CLIP_NEAR / (CULLBENCH_CLIP_NEAR - CULLBENCH_CLIP_FAR);
+    projection->m43 = -1.0f;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchBoxClipped
+    Description : What clipBBoxIsClipped works out for an object, less the
+                  two glGetFloatv round trips it makes to get the matrices
+    Inputs      : obj - object to test
+                  camera, projection - camera matrices
+    Outputs     : ormask - planes any corner is outside of
+                  vbClip - the corners in clip space
+    Return      : TRUE if the clip masks have every corner outside the same
+                    plane
+----------------------------------------------------------------------------*/
+static bool cullBenchBoxClipped(cullbenchobj *obj, hmatrix *camera, hmatrix *projection, ubyte *ormask, hvector *vbClip)
+{
+    hvector rectpos[8], vbEye[8];
+    ubyte clipmask[8];
+    ubyte clipandmask = 0xff;                   // ANDed down to the planes every corner is outside
+    hmatrix modelview;
+    sdword i;
+
+    for (i = 0; i < 8; i++)
+    {
+        rectpos[i].x = obj->collrectoffset.x + ((i & 4) ? obj->uplength : 0.0f);
+        rectpos[i].y = obj->collrectoffset.y + ((i & 1) ? obj->rightlength : 0.0f);
+        rectpos[i].z = obj->collrectoffset.z + ((i & 2) ? obj->forwardlength : 0.0f);
+        rectpos[i].w = 1.0f;
+        clipmask[i] = 0;
+    }
+
+    hmatMultiplyHMatByHMat(&modelview, camera, &obj->model);
+
+    *ormask = 0;
+    clipTransformPoints(8, (real32 *)rectpos, (real32 *)vbEye, (real32 *)&modelview);
+    clipProjectPoints(8, (real32 *)vbEye, (real32 *)vbClip, clipmask, ormask, &clipandmask, (real32 *)projection);
+
+    return(clipandmask != 0);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchBoxOutside
+    Description : Checks whether clip space corners are all outside one
+                  plane, testing each plane on its own.  The clip masks
+                  can't always say: they record only one plane of each
+                  opposite pair, and behind the eye a corner can be outside
+                  both.
+    Inputs      : vbClip - the 8 corners
+    Outputs     :
+    Return      : TRUE if every corner is outside the same plane
+----------------------------------------------------------------------------*/
+static bool cullBenchBoxOutside(hvector *vbClip)
+{
+    sdword plane, i;
+    real32 side;
+
+    for (plane = 0; plane < CULL_NumberPlanes; plane++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            side = plane & 1 ? -((real32 *)&vbClip[i])[plane / 2] : ((real32 *)&vbClip[i])[plane / 2];
+            if (side >= -vbClip[i].w)
+            {
+                break;
+            }
+        }
+        if (i == 8)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : cullBenchRun
+    Description : Pulls a camera back from the middle of the battle to far
+                  outside it while circling, and at each position culls
+                  the battle both ways:
+                    - box test of every object, as the renderer did before
+                    - the cull pass, with the box test only for objects it
+                      couldn't decide
+                  Both also get the LOD distance of every object.  Then
+                  checks every answer the pass gave against the box test.
+                  Called from main instead of the event loop when
+                  /cullBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword cullBenchRun(void)
+{
+    cullfrustum frustum;
+    hmatrix camera, projection;
+    vector eye, lookat, up = {0.0f, 0.0f, 1.0f}, distanceVector;
+    udword frame, nOutside = 0, nInside = 0, nPartial = 0, nWrong = 0;
+    udword nVisibleBox = 0, nVisibleCull = 0, nDistanceDiffers = 0, nBehind = 0;
+    sdword index;
+    real32 t, distance, angle;
+    sqword timeStart, timeStop, boxTime = 0, cullTime = 0;
+    hvector vbClip[8];
+    ubyte ormask;
+    bool drawn;
+
+    cullBenchBattleMake();
+
+    for (frame = 0; frame < cullBenchFrames; frame++)
+    {
+        t = cullBenchFrames > 1 ? (real32)frame / (real32)(cullBenchFrames - 1) : 0.0f;
+        distance = CULLBENCH_CAMERA_NEAR * (real32)pow(CULLBENCH_CAMERA_FAR / CULLBENCH_CAMERA_NEAR, t);
+        angle = t * 2.0f * TWOPI;
+        eye.x = distance * (real32)cos(angle);
+        eye.y = distance * (real32)sin(angle);
+        eye.z = distance * 0.3f;
+        lookat.x = CULLBENCH_BATTLE_SIZE * 0.5f * (real32)cos(angle * 3.0f);
+        lookat.y = CULLBENCH_BATTLE_SIZE * 0.5f * (real32)sin(angle * 3.0f);
+        lookat.z = 0.0f;
+        cullBenchCameraMake(&camera, &projection, &eye, &lookat, &up);
+
+        //every object gets the box test
+        GetRawTime(&timeStart);
+        for (index = 0; index < CULLBENCH_OBJECTS; index++)
+        {
+            vecSub(distanceVector, eye, cullBenchObjects[index].position);
+            cullBenchBoxDistanceSquared[index] = vecMagnitudeSquared(distanceVector);
+            if (!cullBenchBoxClipped(&cullBenchObjects[index], &camera, &projection, &ormask, vbClip))
+            {
+                nVisibleBox++;
+            }
+        }
+        GetRawTime(&timeStop);
+        boxTime += timeStop - timeStart;
+
+        //the pass, then the box test for what it couldn't decide
+        GetRawTime(&timeStart);
+        cullFrustumMake(&frustum, &camera, &projection);
+        cullSpheres(&frustum, CULLBENCH_OBJECTS, cullBenchX, cullBenchY, cullBenchZ, cullBenchRadius, cullBenchVerdict);
+        cullDistances(&eye, CULLBENCH_OBJECTS, cullBenchX, cullBenchY, cullBenchZ,
+                      cullBenchDX, cullBenchDY, cullBenchDZ, cullBenchDistanceSquared);
+        for (index = 0; index < CULLBENCH_OBJECTS; index++)
+        {
+            if (cullBenchVerdict[index] == CULL_Inside ||
+                (cullBenchVerdict[index] == CULL_Partial &&
+                 !cullBenchBoxClipped(&cullBenchObjects[index], &camera, &projection, &ormask, vbClip)))
+            {
+                nVisibleCull++;
+            }
+        }
+        GetRawTime(&timeStop);
+        cullTime += timeStop - timeStart;
+
+        //the pass may only say outside when every corner of the box is
+        //outside one plane, and inside when no corner is outside anything
+        for (index = 0; index < CULLBENCH_OBJECTS; index++)
+        {
+            nDistanceDiffers += (cullBenchDistanceSquared[index] != cullBenchBoxDistanceSquared[index]);
+            drawn = !cullBenchBoxClipped(&cullBenchObjects[index], &camera, &projection, &ormask, vbClip);
+            switch (cullBenchVerdict[index])
+            {
+                case CULL_Outside:
+                    nOutside++;
+                    nBehind += drawn;
+                    nWrong += !cullBenchBoxOutside(vbClip);
+                    break;
+                case CULL_Inside:
+                    nInside++;
+                    nWrong += (ormask != 0);
+                    break;
+                default:
+                    nPartial++;
+                    break;
+            }
+        }
+    }
+
+    printf("CullBench: %d objects, %u camera positions from %.0f to %.0f out\n",
+           CULLBENCH_OBJECTS, cullBenchFrames, CULLBENCH_CAMERA_NEAR, CULLBENCH_CAMERA_FAR);
+    printf("  pass verdicts: %.1f%% outside, %.1f%% inside, %.1f%% partial (box tested)\n",
+           100.0 * nOutside / (cullBenchFrames * CULLBENCH_OBJECTS),
+           100.0 * nInside / (cullBenchFrames * CULLBENCH_OBJECTS),
+           100.0 * nPartial / (cullBenchFrames * CULLBENCH_OBJECTS));
+    printf("  box test of every object: %.4f ms/frame, %u visible\n",
+           (real64)boxTime / 1000.0 / cullBenchFrames, nVisibleBox);
+    printf("  cull pass and box test of partials: %.4f ms/frame, %u visible, %.2fx faster\n",
+           (real64)cullTime / 1000.0 / cullBenchFrames, nVisibleCull,
+           cullTime ? (real64)boxTime / (real64)cullTime : 0.0);
+    printf("  (the renderer's box test also reads both GL matrices back for every object; not counted here)\n");
+    printf("  %u culled objects the box test would still have drawn, with corners behind the eye its clip masks miss\n", nBehind);
+    printf("  %u wrong verdicts, %u LOD distances not the same as lodLevelGet's\n", nWrong, nDistanceDiffers);
+
+    return((nWrong == 0 && nVisibleBox == nVisibleCull + nBehind) ? 0 : -1);
+}
@@ -0,0 +1,42 @@
+// =============================================================================
+//  CullBench.h
+//  - headless culling benchmark, flies a camera out of a synthetic battle
+//    and times the batched cull pass against a box test of every object
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___CULLBENCH_H
+#define ___CULLBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define CULLBENCH_DEFAULT_FRAMES    1000
+#define CULLBENCH_OBJECTS           600             // a multiple of 4, as the cull pass wants
+#define CULLBENCH_BATTLE_SIZE       6000.0f         // radius of the battle
+#define CULLBENCH_CAMERA_NEAR       1500.0f         // camera distance from the battle centre at the start
+#define CULLBENCH_CAMERA_FAR        60000.0f        // and at the end
+#define CULLBENCH_FIELD_OF_VIEW     90.0f
+#define CULLBENCH_ASPECT            (4.0f / 3.0f)
+#define CULLBENCH_CLIP_NEAR         1.0f
+#define CULLBENCH_CLIP_FAR          100000.0f
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool cullBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool cullBenchSet(char *string);
+
+sdword cullBenchRun(void);
+
+#endif
@@ -2381,6 +2381,7 @@ void dockPutShipOutside(Ship *ship,Ship *creator,vector *createat,udword heading
     }
     listAddNode(&universe.SpaceObjList,&(ship->objlink),ship);
     listAddNode(&universe.ShipList,&(ship->shiplink),ship);
+    univShipIndexDirty();
     listAddNode(&universe.ImpactableList,&(ship->impactablelink),ship);
 
     if (creator->flags & SOF_Hide)      // if creator is hidden, ship coming out should be hidden too
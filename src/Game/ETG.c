@@ -859,10 +859,43 @@ bool   etgHitEffectsEnabled = TRUE;             //hit effects on
 bool   etgFireEffectsEnabled = TRUE;            //muzzle flash effects on
 bool   etgBulletEffectsEnabled = TRUE;          //bullet effects on
 
+//effects are made and deleted all the time, so the common sizes get pools.
+//Bigger ones come from the small block heaps or the main heap.
+memobjpool etgEffectPool[ETG_NumberEffectPools] =
+{
+    memObjPoolDefine(256, "Effect256"),
+    memObjPoolDefine(512, "Effect512"),
+    memObjPoolDefine(1024, "Effect1024"),
+    memObjPoolDefine(2048, "Effect2048")
+};
+
 /*=============================================================================
     Functions:
 =============================================================================*/
 
+/*-----------------------------------------------------------------------------
+    Name        : etgEffectAlloc
+    Description : Allocates an effect from the smallest pool it fits in.
+    Inputs      : length - size of the effect, from the effect static
+    Outputs     :
+    Return      : newly allocated effect, to be freed with memFree
+----------------------------------------------------------------------------*/
+static Effect *etgEffectAlloc(sdword length)
+{
+    sdword index;
+    Effect *effect;
+
+    for (index = 0; index < ETG_NumberEffectPools; index++)
+    {
+        if (length <= etgEffectPool[index].objectLength)
+        {
+            return(memObjAlloc(&etgEffectPool[index]));
+        }
+    }
+    effect = memAlloc(length, "Ef(Effect)", Pyrophoric);
+    return(effect);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : etgLODLoad
     Description : Loads in an effect into a LOD structure, growing or creating
@@ -1919,15 +1952,6 @@ void etgReset(void)
     }
 }
 
-/*-----------------------------------------------------------------------------
-    Name        : etgEffectCodeExecute
-    Description : Execute a block of code.
-    Inputs      : stat - static info for the effect
-                  effect - local effect who has all the goods
-                  codeBlock - which code block to execute
-    Outputs     : Executes the specified p-code
-    Return      : void
-----------------------------------------------------------------------------*/
 //#define ETG_ExecStackDepth   4
 //global variables for execution of a chunk of code
 typedef struct
@@ -1943,15 +1967,144 @@ typedef struct
 etgeffectstack;
 etgeffectstack etgExecStack;//[ETG_ExecStackDepth];
 //sdword etgExecStackIndex = -1;
-void etgEffectCodeExecute(etgeffectstatic *stat, Effect *effect, udword codeBlock)
+
+/*-----------------------------------------------------------------------------
+    Name        : etgOpcodeLength
+    Description : Get the length of an opcode in a code block.
+    Inputs      : pOpcode - opcode structure
+    Outputs     :
+    Return      : length of opcode structure, in bytes
+----------------------------------------------------------------------------*/
+udword etgOpcodeLength(ubyte *pOpcode)
+{
+    if (*((udword *)pOpcode) == EOP_Function)
+    {                                                       //function calls have a ragged parameter list
+        return(etgFunctionSize(((etgfunctioncall *)pOpcode)->nParameters));
+    }
+    return(etgHandleTable[*((udword *)pOpcode)].length);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : etgInstructionIndex
+    Description : Find the pre-decoded instruction at an offset of a code block.
+    Inputs      : stat - static info for the effect (for error reporting)
+                  block - code block
+                  offset - offset in block, no greater than its length
+    Outputs     :
+    Return      : index of instruction, or block->nInstructions at the end
+                    of the block.
+----------------------------------------------------------------------------*/
+udword etgInstructionIndex(etgeffectstatic *stat, etgcodeblock *block, udword offset)
+{
+#if ETG_ERROR_CHECKING
+    if ((offset & (sizeof(udword) - 1)) != 0 || offset > block->length ||
+        block->instructionIndex[offset / sizeof(udword)] == ETG_NoInstruction)
+    {
+        dbgFatalf(DBG_Loc, "Effect '%s' branches to offset %d, which is not the start of an opcode", stat->name, offset);
+    }
+#endif
+    return(block->instructionIndex[offset / sizeof(udword)]);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : etgCodeInterpret
+    Description : Execute the pre-decoded code of the current code block until
+                    an end or delete or until it runs off the end of a block.
+    Inputs      : stat - static info for the effect
+                  effect - local effect who has all the goods
+                  offset - offset to start at in the current code block
+                    (etgExecStack.etgCodeBlockIndex)
+    Outputs     : Executes the p-code
+    Return      : void
+    Notes       : The simple and control-flow opcodes are executed in place;
+                    the rest go to their handler.  Handlers return the number
+                    of bytes to advance, which is the opcode length unless
+                    they skipped a block, or 0 if they changed
+                    etgExecStack.etgCodeBlockIndex/offset themselves.
+----------------------------------------------------------------------------*/
+static void etgCodeInterpret(etgeffectstatic *stat, Effect *effect, udword offset)
 {
-    udword opcode;
+    etgcodeblock *block = &etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex];
+    etginstruction *instruction;
+    etgvariablecopy *copy;
+    udword index;
     sdword size;
-    ubyte *pOpcode;
 
+    if (offset >= block->length)
+    {
+        return;
+    }
+    index = etgInstructionIndex(stat, block, offset);
 
-	//this function does not interface well with optimized code which assumes 
-	//certain variables will not get stomped, hence the pushes
+    while (index < block->nInstructions)
+    {
+        instruction = &block->instruction[index];
+        switch (instruction->opcode)
+        {
+            case EOP_Nop:
+                index++;
+                continue;
+            case EOP_VariableCopy:
+                copy = (etgvariablecopy *)instruction->pOpcode;
+                *((udword *)(effect->variable + copy->dest)) = *((udword *)(effect->variable + copy->source));
+                index++;
+                continue;
+            case EOP_VariableAssign:
+                copy = (etgvariablecopy *)instruction->pOpcode;
+                *((udword *)(effect->variable + copy->dest)) = copy->source;
+                index++;
+                continue;
+            case EOP_Goto:
+                etgExecStack.etgCodeBlockIndex = ((etgbranch *)instruction->pOpcode)->codeBlock;
+                block = &etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex];
+                index = instruction->target;
+                continue;
+            case EOP_End:
+                return;
+            case EOP_Delete:
+                etgExecStack.etgDeleteFlag = TRUE;                 //make it delete itself
+                return;
+            default:
+                break;
+        }
+        //call, return and alternate need the current offset
+        block->offset = instruction->offset;
+        size = instruction->function(effect, stat, instruction->pOpcode);
+        if ((udword)size == instruction->length)
+        {                                                   //on to the next opcode
+            index++;
+            continue;
+        }
+        if (size == 0)
+        {                                                   //handler branched
+            block = &etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex];
+            offset = block->offset;
+        }
+        else
+        {                                                   //handler skipped some code
+            offset = instruction->offset + size;
+        }
+        if (offset >= block->length)
+        {
+            break;
+        }
+        index = etgInstructionIndex(stat, block, offset);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : etgCodeRun
+    Description : Execute the current code block from a given offset.
+    Inputs      : stat - static info for the effect
+                  effect - local effect who has all the goods
+                  offset - offset to start at in the current code block
+    Outputs     : Executes the p-code
+    Return      : void
+----------------------------------------------------------------------------*/
+void etgCodeRun(etgeffectstatic *stat, Effect *effect, udword offset)
+{
+	//the non-generic etgFunctionCall does not interface well with optimized
+	//code which assumes certain variables will not get stomped, hence the pushes
 #ifndef GENERIC_ETGCALLFUNCTION
 #if defined (_MSC_VER)
 	_asm
@@ -1983,59 +2136,17 @@ void etgEffectCodeExecute(etgeffectstatic *stat, Effect *effect, udword codeBloc
 		"movq %%rcx, %2\n\t"
 		"movq %%rdx, %3\n\t"
 		"movq %%rsi, %4\n\t"
-		"movq %%rdi, %5\n\t" 
+		"movq %%rdi, %5\n\t"
 		"movq %%r8,  %6\n\t"
 		"movq %%r9,  %7\n\t" : :
 		"m" (savedreg[0]), "m" (savedreg[1]), "m" (savedreg[2]),
 		"m" (savedreg[3]), "m" (savedreg[4]), "m" (savedreg[5]),
 		"m" (savedreg[6]), "m" (savedreg[7]));
-#elif !defined(_MACOSX)
-    // We know x86 instructions won't work on a PowerPC, thanks. We've coded around it.
-	#error Opcode-handler functions currently only supported on x86 platforms.
 #endif
 #endif
-/*
-#if ETG_ERROR_CHECKING
-    if (etgExecStackIndex >= ETG_ExecStackDepth - 1)
-    {
-        dbgFatalf(ETG, "Overflowed exec stack of depth %d", ETG_ExecStackDepth);
-    }
-#endif
-    etgExecStackIndex++;
-*/
 
-    etgExecStack.etgCodeBlockIndex = codeBlock;
-    //set the proper code block and code length
-    //start at beginning of code.  !!!We may want to implement the yield() function.
-//    etgCodeOffset = 0;
-    //!!! this does not support the yield function
-    etgExecStack.etgCodeBlock[EPM_Startup].offset = etgExecStack.etgCodeBlock[EPM_EachFrame].offset = etgExecStack.etgCodeBlock[EPM_TimeIndex].offset = 0;
-    etgExecStack.etgVariables = effect->variable;
+    etgCodeInterpret(stat, effect, offset);
 
-    while (etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset <
-           etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].length)
-    {
-		
-        pOpcode = etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].code + etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset;
-        opcode = *((udword *)pOpcode);                      //get an opcode
-#if ETG_ERROR_CHECKING
-        if (opcode < 0 || opcode >= EOP_LastOp)
-        {
-            dbgFatalf(DBG_Loc, "Effect '%s' has a bad opcode in code segment %d offset %d", stat->name, etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].code, etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset);
-        }
-        if (etgHandleTable[opcode].function == NULL)
-        {
-            dbgFatalf(DBG_Loc, "etgEffectCodeExecute: NULL opcode %d", opcode);
-        }
-#endif
-        //execute the opcode
-        size = etgHandleTable[opcode].function(effect, stat, pOpcode);
-        etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset += size;
-		
-    }
-//    etgExecStackIndex--;
-	//this function does not interface well with optimized code which assumes 
-	//certain variables will not get stomped, hence the pushes
 #ifndef GENERIC_ETGCALLFUNCTION
 #if defined (_MSC_VER)
 	_asm
@@ -2058,7 +2169,6 @@ void etgEffectCodeExecute(etgeffectstatic *stat, Effect *effect, udword codeBloc
 		"movl %5, %%edi\n\t" : :
 		"m" (savedreg[0]), "m" (savedreg[1]), "m" (savedreg[2]),
 		"m" (savedreg[3]), "m" (savedreg[4]), "m" (savedreg[5]));
-
 #elif defined (__GNUC__) && defined (__x86_64__)
  	__asm__ __volatile__ (
 		"movq %0, %%rax\n\t"
@@ -2066,17 +2176,35 @@ void etgEffectCodeExecute(etgeffectstatic *stat, Effect *effect, udword codeBloc
 		"movq %2, %%rcx\n\t"
 		"movq %3, %%rdx\n\t"
 		"movq %4, %%rsi\n\t"
-		"movq %5, %%rdi\n\t" 
+		"movq %5, %%rdi\n\t"
 		"movq %6, %%r8\n\t"
 		"movq %7, %%r9\n\t" : :
 		"m" (savedreg[0]), "m" (savedreg[1]), "m" (savedreg[2]),
 		"m" (savedreg[3]), "m" (savedreg[4]), "m" (savedreg[5]),
 		"m" (savedreg[6]), "m" (savedreg[7]));
-
 #endif
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : etgEffectCodeExecute
+    Description : Execute a block of code.
+    Inputs      : stat - static info for the effect
+                  effect - local effect who has all the goods
+                  codeBlock - which code block to execute
+    Outputs     : Executes the specified p-code
+    Return      : void
+----------------------------------------------------------------------------*/
+void etgEffectCodeExecute(etgeffectstatic *stat, Effect *effect, udword codeBlock)
+{
+    etgExecStack.etgCodeBlockIndex = codeBlock;
+    //!!! this does not support the yield function
+    etgExecStack.etgCodeBlock[EPM_Startup].offset = etgExecStack.etgCodeBlock[EPM_EachFrame].offset = etgExecStack.etgCodeBlock[EPM_TimeIndex].offset = 0;
+    etgExecStack.etgVariables = effect->variable;
+
+    etgCodeRun(stat, effect, 0);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : etgCodeMakeCurrent
     Description : Make a particular efect static's code blocks current
@@ -2174,6 +2302,33 @@ void etgEffectDelete(Effect *effect)
     listRemoveNode(&effect->effectLink);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : etgCodeBlocksDecodedDelete
+    Description : Free the pre-decoded code of an effect static.
+    Inputs      : stat - effect static
+    Outputs     :
+    Return      : void
+----------------------------------------------------------------------------*/
+void etgCodeBlocksDecodedDelete(etgeffectstatic *stat)
+{
+    sdword block;
+
+    for (block = 0; block < ETG_NumberCodeBlocks; block++)
+    {
+        if (stat->codeBlock[block].instruction != NULL)
+        {
+            memFree(stat->codeBlock[block].instruction);
+            stat->codeBlock[block].instruction = NULL;
+        }
+        if (stat->codeBlock[block].instructionIndex != NULL)
+        {
+            memFree(stat->codeBlock[block].instructionIndex);
+            stat->codeBlock[block].instructionIndex = NULL;
+        }
+        stat->codeBlock[block].nInstructions = 0;
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : etgEffectCodeDelete
     Description : Deletes an effect static
@@ -2236,6 +2391,7 @@ void etgEffectCodeDelete(etgeffectstatic *stat, bool bFullDelete)
         memFree(stat->codeBlock[EPM_TimeIndex].code);
         stat->codeBlock[EPM_TimeIndex].code = 0;
     }
+    etgCodeBlocksDecodedDelete(stat);
     if (stat->nHistoryList > 0)
     {
         memFree(stat->historyList);
@@ -3428,6 +3584,111 @@ sdword etgCodeBlockDistill(ubyte *codeBlock, sdword codeLength, ubyte **newCode)
     return(codeLength);                                     //length of new block
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : etgCodeBlockDecode
+    Description : Pre-decode a distilled code block into an instruction array
+                    for etgCodeRun.
+    Inputs      : stat - effect static the code block belongs to
+                  block - code block to decode
+    Outputs     : Allocates and fills in block->instruction and
+                    block->instructionIndex.  Branch targets are resolved
+                    later by etgCodeBlocksDecode.
+    Return      : void
+----------------------------------------------------------------------------*/
+void etgCodeBlockDecode(etgeffectstatic *stat, etgcodeblock *block)
+{
+    udword offset, opcode, index, nInstructions, nSlots;
+    etginstruction *instruction;
+
+    block->instruction = NULL;
+    block->instructionIndex = NULL;
+    block->nInstructions = 0;
+    if (block->length == 0)
+    {
+        return;
+    }
+    dbgAssertOrIgnore((block->length & (sizeof(udword) - 1)) == 0);
+
+    //count the opcodes
+    for (offset = 0, nInstructions = 0; offset < block->length; nInstructions++)
+    {
+        opcode = *((udword *)(block->code + offset));
+#if ETG_ERROR_CHECKING
+        if (opcode >= EOP_LastOp)
+        {
+            dbgFatalf(DBG_Loc, "Effect '%s' has a bad opcode %d at offset %d", stat->name, opcode, offset);
+        }
+        if (etgHandleTable[opcode].function == NULL)
+        {
+            dbgFatalf(DBG_Loc, "Effect '%s' has unhandled opcode %d at offset %d", stat->name, opcode, offset);
+        }
+#endif
+        offset += etgOpcodeLength(block->code + offset);
+    }
+
+    nSlots = block->length / sizeof(udword) + 1;
+    block->instruction = memAlloc(sizeof(etginstruction) * nInstructions, "EffectInstructions", NonVolatile);
+    block->instructionIndex = memAlloc(sizeof(udword) * nSlots, "EffectInstructionIndex", NonVolatile);
+    memset(block->instructionIndex, 0xff, sizeof(udword) * nSlots);//ETG_NoInstruction
+
+    for (offset = 0, index = 0; index < nInstructions; index++)
+    {
+        instruction = &block->instruction[index];
+        instruction->opcode = *((udword *)(block->code + offset));
+        instruction->function = etgHandleTable[instruction->opcode].function;
+        instruction->pOpcode = block->code + offset;
+        instruction->offset = offset;
+        instruction->length = etgOpcodeLength(block->code + offset);
+        instruction->target = 0;
+        block->instructionIndex[offset / sizeof(udword)] = index;
+        offset += instruction->length;
+    }
+    block->instructionIndex[nSlots - 1] = nInstructions;    //falling off the end
+    block->nInstructions = nInstructions;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : etgCodeBlocksDecode
+    Description : Pre-decode all the code blocks of an effect static.
+    Inputs      : stat - newly loaded effect static
+    Outputs     : Decodes each block and resolves the goto's to instruction
+                    indices.
+    Return      : void
+----------------------------------------------------------------------------*/
+void etgCodeBlocksDecode(etgeffectstatic *stat)
+{
+    sdword block;
+    udword index;
+    etginstruction *instruction;
+    etgcodeblock *dest;
+    etgbranch *branch;
+
+    for (block = 0; block < ETG_NumberCodeBlocks; block++)
+    {
+        etgCodeBlockDecode(stat, &stat->codeBlock[block]);
+    }
+    for (block = 0; block < ETG_NumberCodeBlocks; block++)
+    {
+        for (index = 0; index < stat->codeBlock[block].nInstructions; index++)
+        {
+            instruction = &stat->codeBlock[block].instruction[index];
+            if (instruction->opcode == EOP_Goto)
+            {
+                branch = (etgbranch *)instruction->pOpcode;
+                dest = &stat->codeBlock[branch->codeBlock];
+                if (branch->branchTo >= dest->length)
+                {                                           //branch to the end
+                    instruction->target = dest->nInstructions;
+                }
+                else
+                {
+                    instruction->target = etgInstructionIndex(stat, dest, (udword)branch->branchTo);
+                }
+            }
+        }
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : etgForwardReferenceFix
     Description : Fix all the forward references in a code block.
@@ -3663,6 +3924,8 @@ foundThisNewEffect:;
     newStatic->codeBlock[EPM_Startup].length = etgCodeBlockDistill(etgExecStack.etgCodeBlock[EPM_Startup].code, etgExecStack.etgCodeBlock[EPM_Startup].offset, &newStatic->codeBlock[EPM_Startup].code);
     newStatic->codeBlock[EPM_EachFrame].length = etgCodeBlockDistill(etgExecStack.etgCodeBlock[EPM_EachFrame].code, etgExecStack.etgCodeBlock[EPM_EachFrame].offset, &newStatic->codeBlock[EPM_EachFrame].code);
     newStatic->codeBlock[EPM_TimeIndex].length = etgCodeBlockDistill(etgExecStack.etgCodeBlock[EPM_TimeIndex].code, etgExecStack.etgCodeBlock[EPM_TimeIndex].offset, &newStatic->codeBlock[EPM_TimeIndex].code);
+    //pre-decode them for execution
+    etgCodeBlocksDecode(newStatic);
 
     //distill the constant data
     if (newStatic->constLength > 0)
@@ -5491,37 +5754,14 @@ sdword etgSpawnParse(struct etgeffectstatic *stat, ubyte *dest, char *opcodeStri
 void etgCreationCallback(sdword userValue, ubyte *userData)
 {
     sdword codeBlock, offset;
-    udword opcode;
-    sdword size;
-    ubyte *pOpcode;
 #define effect          ((Effect *)userData)
     etgeffectstatic *stat = (etgeffectstatic *)effect->staticinfo;
 
     //save the code block info for later restoration
     codeBlock = etgExecStack.etgCodeBlockIndex;
     offset = etgExecStack.etgCodeBlock[codeBlock].offset;
-    //set the current code offset to the start of the callback code block
-    etgExecStack.etgCodeBlock[codeBlock].offset = (udword)userValue;
     //execute this little chunk of code until we find an end code
-    while (etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset <
-           etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].length)
-    {
-        pOpcode = etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].code + etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset;
-        opcode = *((udword *)pOpcode);                      //get an opcode
-#if ETG_ERROR_CHECKING
-        if (opcode < 0 || opcode >= EOP_LastOp)
-        {
-            dbgFatalf(DBG_Loc, "Effect '%s' has a bad opcode in code segment %d offset %d", stat->name, etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].code, etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset);
-        }
-        if (etgHandleTable[opcode].function == NULL)
-        {
-            dbgFatalf(DBG_Loc, "etgEffectCodeExecute: NULL opcode %d", opcode);
-        }
-#endif
-        //execute the opcode
-        size = etgHandleTable[opcode].function(effect, stat, pOpcode);
-        etgExecStack.etgCodeBlock[etgExecStack.etgCodeBlockIndex].offset += size;
-    }
+    etgCodeRun(stat, effect, (udword)userValue);
     //restore the code block info
     etgExecStack.etgCodeBlockIndex = codeBlock;
     etgExecStack.etgCodeBlock[codeBlock].offset = offset;
@@ -7632,7 +7872,7 @@ void etgCreateEffects(Effect *effect, etgeffectstatic *stat, sdword number, sdwo
             continue;
         }
         size = stat->effectSize;
-        newEffect = memAlloc(size, "Ef(Effect)", Pyrophoric);   //allocate the new effect
+        newEffect = etgEffectAlloc(size);   //allocate the new effect
         newEffect->objtype = OBJ_EffectType;
         newEffect->flags = SOF_Rotatable;
         newEffect->staticinfo = (StaticInfo *)stat;
@@ -7740,7 +7980,7 @@ void *etgEffectCreate(etgeffectstatic *stat, void *owner, vector *pos, vector *v
     smemsize arg[ETG_NumberParameters];
     Effect *newEffect;
 
-    newEffect = memAlloc(stat->effectSize, "GE(GenEffect)", Pyrophoric);//allocate the new effect
+    newEffect = etgEffectAlloc(stat->effectSize);//allocate the new effect
 
     newEffect->objtype = OBJ_EffectType;                    //type of spaceobj
     newEffect->flags = SOF_Rotatable | flags;               //basic flags
@@ -7950,7 +8190,7 @@ memsize etgSpawnNewEffect(Effect *effect, etgeffectstatic *stat, sdword nParams,
 
 //    size = etgEffectSize(stat->nParticleBlocks);            //compute size of effect
     size = stat->effectSize;
-    newEffect = memAlloc(size, "Ef(Effect)", Pyrophoric);       //allocate the new effect
+    newEffect = etgEffectAlloc(size);       //allocate the new effect
     newEffect->objtype = OBJ_EffectType;
     if (etgEffOffset.attachParent && effect->owner != NULL)
     {
@@ -180,6 +180,7 @@ etgopcode;
 #define ETG_VarTableParseLength     256
 #define ETG_NewParticleLength       8
 #define ETG_ConstDataPool           32768
+#define ETG_NoInstruction           0xffffffff  //instructionIndex entry for the middle of an opcode
 
 //parser modes
 #define EPM_Startup                 0           //defining startup code block
@@ -202,6 +203,7 @@ etgopcode;
 #define ETG_EventListLength         256         //max number of effect events
 #define ETG_DecisionMax             128         //max size of an alternate opcode's offset table
 #define ETG_NumberMeshes            128         //number of ETG-specific meshes
+#define ETG_NumberEffectPools       4           //effect sizes with a pool of their own
 
 //etg script file
 #ifdef _WIN32
@@ -506,12 +508,28 @@ typedef struct
 }
 etgcondentry;
 
+//pre-decoded instruction, built from a code block after it is loaded so the
+//executor doesn't have to look up handlers or opcode sizes as it goes
+typedef struct
+{
+    udword opcode;                              //EOP_ opcode number
+    ophandlefunction function;                  //handler function
+    ubyte *pOpcode;                             //opcode structure in the code block
+    udword offset;                              //offset of opcode in code block
+    udword length;                              //length of opcode (what the handler returns to fall through)
+    udword target;                              //instruction index of branch destination (EOP_Goto only)
+}
+etginstruction;
+
 //structure for a code block within an effect's static info block
 typedef struct
 {
     ubyte *code;                                //actual code block
     udword length;                              //length of code block
     udword offset;                              //current offset in code block (if applicable)
+    etginstruction *instruction;                //pre-decoded code block
+    udword nInstructions;                       //number of pre-decoded instructions
+    udword *instructionIndex;                   //instruction at each udword-aligned offset of code
 }
 etgcodeblock;
 
@@ -599,6 +617,7 @@ etgratergba;
     Data:
 =============================================================================*/
 //dispatch tables for standard events
+extern etgevent etgEventTable[ETG_EventListLength];
 extern etgeffectstatic *etgDefaultBoom;
 extern etgeffectstatic *etgDefaultBlast;
 extern etglod *etgDeathEventTable[NUM_RACES][NUM_CLASSES][EDT_NumberExplosionTypes];
@@ -0,0 +1,127 @@
+// =============================================================================
+//  EffectBench.c
+//  - headless effect script benchmark, spawns every loaded effect over and
+//    over and runs their scripts without rendering
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "EffectBench.h"
+
+#include <stdio.h>
+
+#include "ETG.h"
+#include "Globals.h"
+#include "main.h"
+#include "Matrix.h"
+#include "SimBench.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "UnivUpdate.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool effectBenchEnabled = FALSE;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : effectBenchSet
+    Description : Command-line handler for /effectBench
+    Inputs      :
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool effectBenchSet(char *string)
+{
+    effectBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : effectBenchSpawn
+    Description : Creates one of each loaded effect at the origin.
+    Inputs      :
+    Outputs     :
+    Return      : number of effects created
+----------------------------------------------------------------------------*/
+static udword effectBenchSpawn(void)
+{
+    vector origin = {0.0f, 0.0f, 0.0f};
+    matrix coordsys = IdentityMatrix;
+    etgeffectstatic *stat;
+    sdword index;
+    udword nSpawned = 0;
+
+    for (index = 0; index < ETG_EventListLength; index++)
+    {
+        stat = etgEventTable[index].effectStatic;
+        if (stat == NULL || stat->nParticleBlocks == 0xffffffff)
+        {                                                   //not loaded, or didn't load properly
+            continue;
+        }
+        etgEffectCreate(stat, NULL, &origin, &origin, &coordsys, 1.0f, 0, 0);
+        nSpawned++;
+    }
+    return nSpawned;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : effectBenchRun
+    Description : Spawns every loaded effect EFFECTBENCH_ROUNDS times and runs
+                  the effect updates (and so their scripts) for
+                  EFFECTBENCH_FRAMES universe ticks each time, with no
+                  rendering.  Called from main instead of the event loop
+                  when /effectBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword effectBenchRun(void)
+{
+    sqword timeStart, timeStop, updateTime = 0;
+    udword round, frame, nSpawned = 0, nUpdates = 0;
+    real64 seconds;
+
+    if (!benchSinglePlayerStart())
+    {
+        printf("EffectBench: mission didn't start\n");
+        return -1;
+    }
+
+    for (round = 0; round < EFFECTBENCH_ROUNDS; round++)
+    {
+        nSpawned += effectBenchSpawn();
+
+        for (frame = 0; frame < EFFECTBENCH_FRAMES; frame++)
+        {
+            universe.phystimeelapsed = UNIVERSE_UPDATE_PERIOD;
+            nUpdates += universe.effectList.num;
+
+            GetRawTime(&timeStart);
+            univUpdateAllPosVelEffects();
+            GetRawTime(&timeStop);
+
+            updateTime += timeStop - timeStart;
+            universe.totaltimeelapsed += UNIVERSE_UPDATE_PERIOD;
+        }
+    }
+
+    seconds = (real64)updateTime / 1000000.0;
+    printf("EffectBench: %u effects spawned, %u rounds of %u frames\n", nSpawned, EFFECTBENCH_ROUNDS, EFFECTBENCH_FRAMES);
+    printf("  %u effect updates in %.3f s\n", nUpdates, seconds);
+    printf("  %.0f effect updates/sec, %.3f us/update\n",
+           (seconds > 0.0) ? (real64)nUpdates / seconds : 0.0,
+           nUpdates ? (real64)updateTime / (real64)nUpdates : 0.0);
+
+    gameEnd();
+    gameIsRunning = FALSE;
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+// =============================================================================
+//  EffectBench.h
+//  - headless effect script benchmark, spawns every loaded effect over and
+//    over and runs their scripts without rendering
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___EFFECTBENCH_H
+#define ___EFFECTBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define EFFECTBENCH_ROUNDS          20              // times every effect is spawned
+#define EFFECTBENCH_FRAMES          64              // updates each round runs for
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool effectBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool effectBenchSet(char *string);
+
+sdword effectBenchRun(void);
+
+#endif
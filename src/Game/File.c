@@ -12,11 +12,11 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-#include "BitIO.h"
+#include "CRC32.h"
 #include "Debug.h"
 #include "File.h"
-#include "LZSS.h"
 #include "Memory.h"
+#include "Prefetch.h"
 
 #ifdef _WIN32
     #define WIN32_LEAN_AND_MEAN
@@ -91,6 +91,22 @@ static char  *decompWorkspaceP     = NULL;
 static sdword decompWorkspaceSize  = 0;
 static sdword decompWorkspaceInUse = FALSE;
 
+//  full paths fileExists has already failed to find on disk, so asking again
+//  doesn't stat the filesystem.  Open addressing on the path CRC; the whole
+//  cache is dropped when it fills up or whenever we create files/directories.
+#define FILE_MISS_CACHE_SLOTS   1024                // power of two
+#define FILE_MISS_CACHE_MAX     (FILE_MISS_CACHE_SLOTS * 3 / 4)
+
+typedef struct
+{
+    udword hash;
+    char  *path;                                    // NULL if the slot is empty
+}
+filemissentry;
+
+static filemissentry fileMissCache[FILE_MISS_CACHE_SLOTS];
+static sdword fileMissCacheUsed = 0;
+
 
 /*=============================================================================
     Functions:
@@ -340,7 +356,7 @@ static void fileNameReducePath (char* pathName)
 ----------------------------------------------------------------------------*/
 #if FILE_CASE_INSENSITIVE_SEARCH
 
-static bool8 fileNameCorrectCase (char* fileName)
+bool8 fileNameCorrectCase (char* fileName)
 {
 	char fileNameCopy[PATH_MAX + 1];
 	char* pChar;
@@ -628,7 +644,7 @@ static bool8 fileNameCorrectCase (char* fileName)
    when we don't want to manually perform case-insensitive searches yet still
    give the same results on platforms that use case-insensitive file
    systems. */
-static bool8 fileNameCorrectCase (char* fileName)
+bool8 fileNameCorrectCase (char* fileName)
 {
 	char fileNameCopy[PATH_MAX + 1];
 	struct stat fileInfo;
@@ -661,6 +677,100 @@ static bool8 fileNameCorrectCase (char* fileName)
 #endif  /* FILE_CASE_INSENSITIVE_SEARCH */
 
 
+/*-----------------------------------------------------------------------------
+    Name        : fileMissCacheFlush
+    Description : Forget every path remembered as missing.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void fileMissCacheFlush(void)
+{
+    sdword slot;
+
+    if (fileMissCacheUsed == 0)
+    {
+        return;
+    }
+    for (slot = 0; slot < FILE_MISS_CACHE_SLOTS; slot++)
+    {
+        if (fileMissCache[slot].path != NULL)
+        {
+            free(fileMissCache[slot].path);
+            fileMissCache[slot].path = NULL;
+        }
+    }
+    fileMissCacheUsed = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : fileMissCacheCheck
+    Description : See if a path is known not to exist, optionally remembering
+                  it if it isn't in the cache yet.
+    Inputs      : fileName - full path as probed on disk
+                  add - TRUE to add the path to the cache
+    Outputs     :
+    Return      : TRUE if the path was already in the cache
+    Note        : the cache is plain malloc memory since this is used before
+                  the memory module starts.
+----------------------------------------------------------------------------*/
+static bool fileMissCacheCheck(char *fileName, bool add)
+{
+    udword length = strlen(fileName);
+    udword hash = crc32Compute((ubyte *)fileName, length);
+    udword slot;
+
+    for (slot = hash & (FILE_MISS_CACHE_SLOTS - 1); fileMissCache[slot].path != NULL; slot = (slot + 1) & (FILE_MISS_CACHE_SLOTS - 1))
+    {
+        if (fileMissCache[slot].hash == hash && !strcmp(fileMissCache[slot].path, fileName))
+        {
+            return TRUE;
+        }
+    }
+
+    if (add)
+    {
+        if (fileMissCacheUsed >= FILE_MISS_CACHE_MAX)
+        {
+            fileMissCacheFlush();
+            slot = hash & (FILE_MISS_CACHE_SLOTS - 1);
+        }
+        fileMissCache[slot].path = malloc(length + 1);
+        if (fileMissCache[slot].path != NULL)
+        {
+            memcpy(fileMissCache[slot].path, fileName, length + 1);
+            fileMissCache[slot].hash = hash;
+            fileMissCacheUsed++;
+        }
+    }
+    return FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : fileMissCacheable
+    Description : Decide if a missing path may be cached.  The user settings
+                  area is written to directly by other modules (screenshots,
+                  logs, saved games) so misses there are never cached.
+    Inputs      : fileName - full path as probed on disk
+                  flags - flags fileExists was called with
+    Outputs     :
+    Return      : TRUE if it's safe to cache a miss of this path
+----------------------------------------------------------------------------*/
+static bool fileMissCacheable(char *fileName, udword flags)
+{
+    if (bitTest(flags, FF_UserSettingsPath|FF_CDROM))
+    {
+        return FALSE;
+    }
+    if (fileUserSettingsPath[0] != 0 &&
+        !strncmp(fileName, fileUserSettingsPath, strlen(fileUserSettingsPath)))
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
 /*-----------------------------------------------------------------------------
     Name        : fileMakeDirectory
     Description : Creates the specified directory, creating parent directories
@@ -678,6 +788,9 @@ bool8 fileMakeDirectory (const char* directoryName)
 	dbgAssertOrIgnore(directoryName != NULL);
 	dbgAssertOrIgnore(strlen(directoryName) <= PATH_MAX);
 
+	/* Anything we're about to write may have been cached as missing. */
+	fileMissCacheFlush();
+
 	/* Make a copy of the directory name with which we can modify as
 	   needed. */
 	strncpy(directoryCopy, directoryName, PATH_MAX);
@@ -840,7 +953,11 @@ sdword fileLoadAlloc(char *_fileName, void **address, udword flags)
     {
         if (bigFindFile(_fileName, &whereFound, &bigFileIndex))
         {
-            bigfileResult = bigFileLoadAlloc(&(whereFound->tableOfContents), whereFound->filePtr, _fileName, bigFileIndex, address);
+            bigfileResult = pfClaim(whereFound, bigFileIndex, PF_LoadAlloc, address);
+            if (bigfileResult == -1)
+            {
+                bigfileResult = bigFileLoadAlloc(whereFound, _fileName, bigFileIndex, address);
+            }
             if (bigfileResult != -1)
             {
                 if (LogFileLoads)
@@ -933,7 +1050,7 @@ sdword fileLoad(char *_fileName, void *address, udword flags)
     {
         if (bigFindFile(_fileName, &whereFound, &bigFileIndex))
         {
-            bigfileResult = bigFileLoad(&(whereFound->tableOfContents), whereFound->filePtr, bigFileIndex, address);
+            bigfileResult = bigFileLoad(whereFound, bigFileIndex, address);
             if (bigfileResult != -1)
             {
                 if (LogFileLoads)
@@ -979,6 +1096,63 @@ sdword fileLoad(char *_fileName, void *address, udword flags)
     return(length);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : fileLoadMapped
+    Description : Loads a file for reading only.  If the file is stored
+                  uncompressed in a mapped .BIG file, no memory is allocated
+                  and the pointer returned is straight into the mapping.
+    Inputs      : fileName - path/name of file to load
+                  address - location to store the data pointer
+                  flags - NonVolatile, Pyrophoric or file access flags
+    Outputs     : *address - pointer to the file's data.  The data must not
+                  be written to and must be given back with fileLoadRelease.
+    Return      : number of bytes loaded
+    Note        : Generates a fatal error if file doesn't exist.
+----------------------------------------------------------------------------*/
+sdword fileLoadMapped(char *_fileName, void **address, udword flags)
+{
+    bigFileConfiguration *whereFound = NULL;
+    udword bigFileIndex = 0;
+    ubyte *data;
+
+    dbgAssertOrIgnore(address != NULL);
+
+    if (!IgnoreBigfiles && !bitTest(flags, FF_CDROM|FF_IgnoreBIG|FF_UserSettingsPath))
+    {
+        if (bigFindFile(_fileName, &whereFound, &bigFileIndex))
+        {
+            data = bigFileMapAcquire(whereFound, bigFileIndex);
+            if (data != NULL)
+            {
+                if (LogFileLoads)
+                {
+                    logfileLogf(FILELOADSLOG, "%s | %s (mapped)\n", whereFound->bigFileName, _fileName);
+                }
+
+                *address = data;
+                return whereFound->tableOfContents.fileEntries[bigFileIndex].realLength;
+            }
+        }
+    }
+
+    return fileLoadAlloc(_fileName, address, flags);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : fileLoadRelease
+    Description : Gives back data loaded with fileLoadMapped.
+    Inputs      : address - pointer returned by fileLoadMapped
+    Outputs     : drops the mapping reference or frees the loaded copy
+    Return      :
+----------------------------------------------------------------------------*/
+void fileLoadRelease(void *address)
+{
+    if (!bigFileMapRelease(address))
+    {
+        memFree(address);
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : fileSave
     Description : Saves data of length, address to fileName
@@ -1053,6 +1227,7 @@ bool fileExistsInBigFile(char *fileName)
 bool fileExists(char *_fileName, udword flags)
 {
     char *fileName;
+    bool cacheable;
 
     if (!IgnoreBigfiles && !bitTest(flags, FF_CDROM|FF_IgnoreBIG|FF_UserSettingsPath))
     {
@@ -1063,12 +1238,22 @@ bool fileExists(char *_fileName, udword flags)
     }
 
     fileName = filePathPrepend(_fileName, flags);            //get full path
+    cacheable = fileMissCacheable(fileName, flags);
+
+    if (cacheable && fileMissCacheCheck(fileName, FALSE))
+    {
+        return FALSE;
+    }
 
     if (fileNameCorrectCase(fileName))
     {
         return TRUE;
     }
 
+    if (cacheable)
+    {
+        fileMissCacheCheck(fileName, TRUE);
+    }
     return FALSE;
 }
 
@@ -1121,6 +1306,71 @@ sdword fileSizeGet(char *_fileName, udword flags)
     return(length);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : fileStampGet
+    Description : Identifies the version of a file that fileOpen would open,
+                  without opening it: the size and modification time of a
+                  file on disk or the location, size and timestamp of its
+                  entry in a .BIG file.
+    Inputs      : fileName - name of file, as it would be passed to fileOpen
+                  flags - same flags as would be passed to fileOpen
+    Outputs     :
+    Return      : CRC of the file's identity, or 0 if it can't be found.
+----------------------------------------------------------------------------*/
+udword fileStampGet(char *_fileName, udword flags)
+{
+    char localPath[PATH_MAX];
+    char *fileName;
+    struct stat fileInfo;
+    udword stamp[5];
+    crc32 crc;
+
+    if (_fileName[0] == '\\' || _fileName[0] == '/')
+    {
+        strcpy(localPath, _fileName);
+    }
+    else
+    {
+        filePathPrepend(_fileName, FF_NoModifers);
+        strcpy(localPath, filePathTempBuffer);
+    }
+
+    //same search order as fileOpen
+    if (!fileExists(localPath, FF_IgnorePrepend) && !IgnoreBigfiles && !bitTest(flags, FF_CDROM|FF_IgnoreBIG|FF_UserSettingsPath))
+    {
+        bigFileConfiguration *whereFound = NULL;
+        udword fileIndex = 0;
+        bigTOCFileEntry *entry;
+
+        if (bigFindFile(_fileName, &whereFound, &fileIndex))
+        {
+            entry = whereFound->tableOfContents.fileEntries + fileIndex;
+            stamp[0] = crc32Compute((ubyte *)whereFound->bigFileName, strlen(whereFound->bigFileName));
+            stamp[1] = entry->offset;
+            stamp[2] = entry->storedLength;
+            stamp[3] = entry->realLength;
+            stamp[4] = entry->timeStamp;
+            crc = crc32Compute((ubyte *)stamp, sizeof(stamp));
+            return (crc != 0) ? crc : 1;
+        }
+    }
+
+    fileName = filePathPrepend(_fileName, flags);
+    fileNameCorrectCase(fileName);
+
+    if (stat(fileName, &fileInfo) != 0)
+    {
+        return 0;
+    }
+    stamp[0] = 0;
+    stamp[1] = (udword)fileInfo.st_size;
+    stamp[2] = (udword)((uqword)fileInfo.st_size >> 32);
+    stamp[3] = (udword)fileInfo.st_mtime;
+    stamp[4] = (udword)((uqword)fileInfo.st_mtime >> 32);
+    crc = crc32Compute((ubyte *)stamp, sizeof(stamp));
+    return (crc != 0) ? crc : 1;
+}
+
 void fileDelete(char *_fileName)
 {
     char *fileName;
@@ -1149,8 +1399,7 @@ filehandle fileOpen(char *_fileName, udword flags)
     bool usingBigfile    = FALSE;
     bool firstBufUse     = FALSE;
     bool localFileExists = FALSE;
-    int expandedSize, storedSize;
-    BitFile *bitFile;
+    int expandedSize;
 
     //  find next available filehandle
     fh = 1;
@@ -1213,7 +1462,27 @@ filehandle fileOpen(char *_fileName, udword flags)
 
         if (usingBigfile)  // common stuff, whether it's in the main or update bigfile
         {
-            if ((filesOpen[fh].bigTOC->fileEntries + fileIndex)->compressionType)
+            filesOpen[fh].mappedBuf = FALSE;
+            if (pfClaim(whereFound, fileIndex, PF_Open, (void **)&filesOpen[fh].decompBuf) != -1)
+            {
+                // streamed in ahead of time; freed in fileClose like any temporary buffer
+                if (LogFileLoads)
+                {
+                    logfileLogf(FILELOADSLOG, "%-80s", _fileName);
+                    logfileLogf(FILELOADSLOG, "(prefetched file)\n");
+                }
+            }
+            else if ((filesOpen[fh].decompBuf = (char *)bigFileMapAcquire(whereFound, fileIndex)) != NULL)
+            {
+                // uncompressed and the bigfile is mapped: read straight from the mapping
+                filesOpen[fh].mappedBuf = TRUE;
+                if (LogFileLoads)
+                {
+                    logfileLogf(FILELOADSLOG, "%-80s", _fileName);
+                    logfileLogf(FILELOADSLOG, "(mapped file)\n");
+                }
+            }
+            else if ((filesOpen[fh].bigTOC->fileEntries + fileIndex)->compressionType)
             {
                 // compressed file
                 if (!decompWorkspaceInUse)
@@ -1268,13 +1537,9 @@ filehandle fileOpen(char *_fileName, udword flags)
                                     decompWorkspaceSize/1024);
                     }
                 }
-                // decompress from file directly into workspace
-                fseek(filesOpen[fh].bigFP, filesOpen[fh].offsetStart, SEEK_SET);
-                bitFile = bitioFileInputStart(filesOpen[fh].bigFP);
-                expandedSize = lzssExpandFileToBuffer(bitFile, filesOpen[fh].decompBuf, filesOpen[fh].length);
-                storedSize = bitioFileInputStop(bitFile);
+                // decompress from file (or its mapping) directly into workspace
+                expandedSize = bigFileLoad(whereFound, fileIndex, filesOpen[fh].decompBuf);
                 dbgAssertOrIgnore(expandedSize == filesOpen[fh].length);
-                dbgAssertOrIgnore(storedSize == (filesOpen[fh].bigTOC->fileEntries + fileIndex)->storedLength);
             }
             else
             {
@@ -1381,7 +1646,9 @@ void fileClose(filehandle handle)
         fclose(filesOpen[handle].fileP);
     else if (filesOpen[handle].decompBuf)
     {
-        if (filesOpen[handle].decompBuf == decompWorkspaceP)
+        if (filesOpen[handle].mappedBuf)
+            bigFileMapRelease(filesOpen[handle].decompBuf);
+        else if (filesOpen[handle].decompBuf == decompWorkspaceP)
             decompWorkspaceInUse = FALSE;
         else
             // free decompression buffer if it was in use and not the stock workspace
@@ -1922,17 +2189,20 @@ bool fileCDROMPathSet(char *path)
 
 void fileHomeworldDataPathSet(char *path)
 {
+    fileMissCacheFlush();
     filePathMaxBufferSet(fileHomeworldDataPath, path);
 }
 
 bool fileOverrideBigPathSet(char *path)
 {
+    fileMissCacheFlush();
     filePathMaxBufferSet(fileOverrideBigPath, path);
     return TRUE;
 }
 
 bool fileUserSettingsPathSet(char *path)
 {
+    fileMissCacheFlush();
     filePathMaxBufferSet(fileUserSettingsPath, path);
     return TRUE;
 }
@@ -92,6 +92,8 @@ typedef struct {
                             // If possible this will either point to an existing workspace that persists between file loads
                             //  (to avoid extra allocs/deallocs), or else to a newly allocated buffer that will be freed upon
                             //  "closing" the current file).
+                            // If the bigfile is mapped, an uncompressed file's decompBuf points straight into the mapping.
+    sdword mappedBuf;       // true if decompBuf is in a bigfile mapping, to be released rather than freed
     long offsetVirtual;     // this tracks the virtual stream offset (from offsetStart), like stdio (0 = start, etc.)
     long length;            // length of file in bigfile (uncompressed length)
 } fileOpenInfo;
@@ -109,6 +111,7 @@ extern char filePathTempBuffer    [];
 
 char *filePathPrepend(char *fileName, udword flags);
 void fileNameReplaceSlashesInPlace(char *fileName);
+bool8 fileNameCorrectCase(char *fileName);
 
 bool fileCDROMPathSet(char *path);
 void fileHomeworldDataPathSet(char *path);
@@ -120,6 +123,10 @@ bool fileUserSettingsPathSet(char *path);
 sdword fileLoadAlloc(char *fileName, void **address, udword flags);
 sdword fileLoad(char *fileName, void *address, udword flags);
 
+//load files for reading only, possibly straight out of a mapped .BIG file
+sdword fileLoadMapped(char *fileName, void **address, udword flags);
+void fileLoadRelease(void *address);
+
 //save files, if you want stream saving, use the ANSI C stream functions
 sdword fileSave(char *fileName, void *address, sdword length);
 
@@ -145,6 +152,7 @@ bool8 fileMakeDestinationDirectory(const char *fileName);
 bool fileExistsInBigFile(char *fileName);
 bool fileExists(char *fileName, udword flags);
 sdword fileSizeGet(char *fileName, udword flags);
+udword fileStampGet(char *fileName, udword flags);
 
 void logfileClear(char *logfile);
 void logfileLog(char *logfile,char *str);
@@ -1105,6 +1105,7 @@ void gpDeleteGame(char *name, featom *atom)
 
     char *tmpFilePath = filePathPrepend(filename, FF_UserSettingsPath);
     strcpy(filename, tmpFilePath);
+    SaveGameWait();                                         //don't race a save still being written
     fileDelete(filename);
 
     if (SavedGamesPath == RecordedGamesPath)
@@ -517,7 +517,7 @@ void missileShoot(Ship *ship,Gun *gun,SpaceObjRotImpTarg *target)
     gun->numMissiles--;
     gun->lasttimefired = universe.totaltimeelapsed;
 
-    missile = memAlloc(sizeof(Missile),"Missile",0);
+    missile = memObjAlloc(&univMissilePool);
     memset(missile,0,sizeof(Missile));
 
     missile->objtype = OBJ_MissileType;
@@ -895,7 +895,7 @@ void gunShoot(Ship *ship, Gun *gun, SpaceObjRotImpTarg *target)
 
     gun->lasttimefired = universe.totaltimeelapsed;
 
-    bullet = memAlloc(sizeof(Bullet),"Bu(Bullet)",Pyrophoric);
+    bullet = memObjAlloc(&univBulletPool);
 
     bullet->objtype = OBJ_BulletType;
     bullet->flags = 0;
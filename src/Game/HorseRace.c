@@ -1468,6 +1468,11 @@ bool HorseRaceNext(real32 percent)
 //    static real32 lastper = 0.0f;
     static sdword modulusCounter = 0;
 
+    if (mainHeadless)
+    {                                                   //nothing to draw the bars on
+        return FALSE;
+    }
+
     if (percent > 1.0f) percent = 1.0f;
 //    if(utyTeaserHeader)  return TRUE;
 
@@ -0,0 +1,290 @@
+// =============================================================================
+//  Jobs.c
+//  - pool of worker threads that split loops over independent objects
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "Jobs.h"
+
+#include <SDL.h>
+
+#include "Debug.h"
+#include "ProfileTimers.h"
+
+/*=============================================================================
+    Overview:
+
+    jobParallelFor publishes a loop, wakes the workers and then works on it
+    itself.  Everyone takes grainSize items at a time off a shared counter
+    until the loop is used up; the thread that finishes the last batch
+    posts jobDoneSem.  Results can't depend on how the batches were shared
+    out, because the items are independent and any merging of their side
+    effects is left to the caller, who does it in a fixed order.
+
+    A worker only joins a loop while jobOpen is set, and the caller closes
+    it and sleeps on jobIdleCond until jobActive drains before returning,
+    so no straggler can pull a batch from the next loop's counter with
+    this loop's limits.
+=============================================================================*/
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool jobEnabled = TRUE;
+
+//the loop being run
+static jobfunction jobFunction = NULL;
+static void *jobContext = NULL;
+static sdword jobNumberItems = 0;
+static sdword jobGrainSize = 1;
+static sdword jobNumberBatches = 0;
+static SDL_atomic_t jobNextBatch;
+static SDL_atomic_t jobBatchesLeft;
+static SDL_sem *jobDoneSem = NULL;
+
+//waking the workers, and waiting for them to leave the loop; all under jobMutex
+static udword jobGeneration = 0;
+static bool jobOpen = FALSE;
+static bool jobQuit = FALSE;
+static sdword jobActive = 0;                    // workers inside jobBatchesRun
+static SDL_mutex *jobMutex = NULL;
+static SDL_cond *jobCond = NULL;
+static SDL_cond *jobIdleCond = NULL;            // signalled when jobActive drops to 0
+
+static SDL_Thread *jobWorkers[JOB_MaxWorkers];
+static udword jobNumWorkers = 0;
+
+/*=============================================================================
+    Private functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : jobBatchesRun
+    Description : Does batches of the current loop until there are none left
+    Inputs      :
+    Outputs     : posts jobDoneSem if it finishes the last batch
+    Return      :
+----------------------------------------------------------------------------*/
+static void jobBatchesRun(void)
+{
+    sdword batch, first;
+
+    for (;;)
+    {
+        batch = SDL_AtomicAdd(&jobNextBatch, 1);
+        if (batch >= jobNumberBatches)
+        {
+            break;
+        }
+        first = batch * jobGrainSize;
+        jobFunction(jobContext, first, min(first + jobGrainSize, jobNumberItems));
+        if (SDL_AtomicAdd(&jobBatchesLeft, -1) == 1)
+        {
+            SDL_SemPost(jobDoneSem);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : jobWorker
+    Description : Worker thread: helps with each loop as it's published until
+                  told to quit.
+    Inputs      : data - unused
+    Outputs     :
+    Return      : 0
+----------------------------------------------------------------------------*/
+static int jobWorker(void *data)
+{
+    udword seen = 0;
+
+    (void)data;
+
+    profTraceThreadName("jobs");
+
+    for (;;)
+    {
+        dbgAssertAlwaysDo(SDL_mutexP(jobMutex) != -1);
+        while (jobGeneration == seen && !jobQuit)
+        {
+            SDL_CondWait(jobCond, jobMutex);
+        }
+        if (jobQuit)
+        {
+            dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+            break;
+        }
+        seen = jobGeneration;
+        if (!jobOpen)
+        {                                                   //woke up too late for it
+            dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+            continue;
+        }
+        jobActive++;
+        dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+
+        PTSCOPE("jobs");
+        jobBatchesRun();
+        PTSCOPEEND();
+
+        dbgAssertAlwaysDo(SDL_mutexP(jobMutex) != -1);
+        jobActive--;
+        if (jobActive == 0)
+        {
+            SDL_CondSignal(jobIdleCond);
+        }
+        dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+    }
+    profTraceThreadRelease();
+    return 0;
+}
+
+/*=============================================================================
+    Public functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : jobStartup
+    Description : Starts the worker pool, one thread per spare CPU up to
+                  JOB_MaxWorkers.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void jobStartup(void)
+{
+    sdword nWorkers;
+
+    if (!jobEnabled)
+    {
+        return;
+    }
+
+    nWorkers = min(SDL_GetCPUCount() - 1, JOB_MaxWorkers);
+    if (nWorkers <= 0)
+    {
+        return;
+    }
+
+    jobActive = 0;
+    jobGeneration = 0;
+    jobOpen = FALSE;
+    jobQuit = FALSE;
+    jobMutex = SDL_CreateMutex();
+    jobCond = SDL_CreateCond();
+    jobIdleCond = SDL_CreateCond();
+    jobDoneSem = SDL_CreateSemaphore(0);
+    dbgAssertOrIgnore(jobMutex != NULL && jobCond != NULL && jobIdleCond != NULL && jobDoneSem != NULL);
+
+    for (jobNumWorkers = 0; jobNumWorkers < (udword)nWorkers; jobNumWorkers++)
+    {
+        jobWorkers[jobNumWorkers] = SDL_CreateThread(jobWorker, "jobs", NULL);
+        if (jobWorkers[jobNumWorkers] == NULL)
+        {
+            break;
+        }
+    }
+    dbgMessagef("jobStartup: %d job workers", jobNumWorkers);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : jobShutdown
+    Description : Stops the worker pool
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void jobShutdown(void)
+{
+    udword index;
+
+    if (jobMutex == NULL)
+    {
+        return;
+    }
+
+    dbgAssertAlwaysDo(SDL_mutexP(jobMutex) != -1);
+    jobQuit = TRUE;
+    SDL_CondBroadcast(jobCond);
+    dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+
+    for (index = 0; index < jobNumWorkers; index++)
+    {
+        SDL_WaitThread(jobWorkers[index], NULL);
+    }
+    jobNumWorkers = 0;
+
+    SDL_DestroySemaphore(jobDoneSem);
+    SDL_DestroyCond(jobIdleCond);
+    SDL_DestroyCond(jobCond);
+    SDL_DestroyMutex(jobMutex);
+    jobDoneSem = NULL;
+    jobIdleCond = NULL;
+    jobCond = NULL;
+    jobMutex = NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : jobParallelFor
+    Description : Runs a loop over independent items on the worker pool and
+                  the calling thread.  Small loops, or any loop when there are
+                  no workers or jobEnabled is off, are just run here.
+    Inputs      : nItems - number of items
+                  grainSize - number of items to hand out at a time
+                  function - does a range of items
+                  context - passed to function
+    Outputs     :
+    Return      : when all the items are done
+----------------------------------------------------------------------------*/
+void jobParallelFor(sdword nItems, sdword grainSize, jobfunction function, void *context)
+{
+    dbgAssertOrIgnore(grainSize > 0);
+
+    if (nItems <= 0)
+    {
+        return;
+    }
+    if (nItems <= grainSize || jobNumWorkers == 0 || !jobEnabled)
+    {
+        function(context, 0, nItems);
+        return;
+    }
+
+    jobFunction = function;
+    jobContext = context;
+    jobNumberItems = nItems;
+    jobGrainSize = grainSize;
+    jobNumberBatches = (nItems + grainSize - 1) / grainSize;
+    SDL_AtomicSet(&jobBatchesLeft, jobNumberBatches);
+    SDL_AtomicSet(&jobNextBatch, 0);
+
+    dbgAssertAlwaysDo(SDL_mutexP(jobMutex) != -1);
+    jobGeneration++;
+    jobOpen = TRUE;
+    SDL_CondBroadcast(jobCond);
+    dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+
+    jobBatchesRun();
+    SDL_SemWait(jobDoneSem);
+
+    dbgAssertAlwaysDo(SDL_mutexP(jobMutex) != -1);
+    jobOpen = FALSE;
+    while (jobActive != 0)
+    {                                                       //wait for stragglers to see the loop is used up
+        SDL_CondWait(jobIdleCond, jobMutex);
+    }
+    dbgAssertAlwaysDo(SDL_mutexV(jobMutex) != -1);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : jobNumberWorkers
+    Description : Returns the number of worker threads running
+    Inputs      :
+    Outputs     :
+    Return      : number of workers, not counting the game thread
+----------------------------------------------------------------------------*/
+udword jobNumberWorkers(void)
+{
+    return jobNumWorkers;
+}
@@ -0,0 +1,46 @@
+// =============================================================================
+//  Jobs.h
+//  - pool of worker threads that split loops over independent objects
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___JOBS_H
+#define ___JOBS_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define JOB_MaxWorkers          7
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//does items first through last - 1 of a loop
+typedef void (*jobfunction)(void *context, sdword first, sdword last);
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool jobEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void jobStartup(void);
+void jobShutdown(void);
+
+//Runs function over nItems items, grainSize at a time, on the workers and the
+//calling thread, and returns when they're all done.  The items must be
+//independent of each other; which thread does which ones isn't defined.
+void jobParallelFor(sdword nItems, sdword grainSize, jobfunction function, void *context);
+
+udword jobNumberWorkers(void);
+
+#endif
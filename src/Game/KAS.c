@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "AIPlayer.h"
+#include "AISchedule.h"
 #include "AITeam.h"
 #include "AIVar.h"
 #include "CommandWrap.h"
@@ -189,20 +190,38 @@ void kasFSMCreate(char *fsmName, KASInitFunction initFunction, KASWatchFunction
 //
 //  must be called once per AI cycle
 //
-void kasExecute(void)
+//  stops when the frame's AI work quota runs out and returns FALSE, the
+//  next call carries on with the team after the last one watched, or
+//  starts over if the teams have changed in between; called from outside
+//  the AI update, or in single player games, which run without a quota,
+//  it always does a full pass
+//
+bool kasExecute(void)
 {
     sdword i;
+    aischowner *sched = aischState(AISCH_Kas);
 
     // no current mission?
     if (!CurrentMissionName[0] || !CurrentMissionWatchFunction)
-        return;
+        return TRUE;
 
     if (kasUnpausedTeam == NULL)
     {                                                       //if KAS is not paused
-        CurrentMissionWatchFunction();          // watch at the mission level
+        if (!sched->stage)
+        {
+            CurrentMissionWatchFunction();          // watch at the mission level
+            aischSpend(AISCH_KasWatchWork);
+            sched->stage = TRUE;
+        }
 
-        for (i = 0; i < aiCurrentAIPlayer->teamsUsed; i++)
+        for (i = aischTeamResume(sched, aiCurrentAIPlayer); i < aiCurrentAIPlayer->teamsUsed; i++)
         {
+            if (aischOutOfWork())
+            {
+                aischTeamStop(sched, aiCurrentAIPlayer, i);
+                return FALSE;
+            }
+
             CurrentTeamP = aiCurrentAIPlayer->teams[i];
             if (CurrentTeamP->teamType == ScriptTeam)
             {
@@ -210,6 +229,7 @@ void kasExecute(void)
                     CurrentTeamP->kasFSMWatchFunction();
                 if (CurrentTeamP->kasStateWatchFunction) // watch at the state level
                     CurrentTeamP->kasStateWatchFunction();
+                aischSpend(AISCH_KasWatchWork);
             }
         }
     }
@@ -224,6 +244,10 @@ void kasExecute(void)
                 CurrentTeamP->kasStateWatchFunction();
         }
     }
+
+    sched->stage = FALSE;
+    sched->cursor = 0;
+    return TRUE;
 }
 
 //
@@ -235,6 +259,10 @@ void kasMissionStart(char *name, KASInitFunction initFunction, KASWatchFunction
     memStrncpy(CurrentMissionName, name, KAS_MISSION_NAME_MAX_LENGTH);
     CurrentMissionWatchFunction = watchFunction;
 
+    //a new mission's watches start from the top
+    aischOwners[AISCH_Kas].stage = FALSE;
+    aischOwners[AISCH_Kas].cursor = 0;
+
     //hyperspace init
     hsStaticInit(LabelledVectorsUsed);
 
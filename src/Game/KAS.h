@@ -58,7 +58,7 @@ hvector *kasLabelledVectorAdd(char *label, real32 x, real32 y, real32 z,real32 w
 Volume *kasLabelledVolumeAdd(char *label);
 
 void kasMissionStart(char *name, KASInitFunction initFunction, KASWatchFunction watchFunction);
-void kasExecute(void);
+bool kasExecute(void);
 
 // keywords of KAS language
 void kasJump(char *stateName, KASInitFunction initFunction, KASWatchFunction watchFunction);
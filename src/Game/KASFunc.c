@@ -44,6 +44,7 @@
 #include "SinglePlayer.h"
 #include "SoundEvent.h"
 #include "SoundEventDefs.h"
+#include "SpaceQuery.h"
 #include "SpeechEvent.h"
 #include "StringsOnly.h"
 #include "Subtitle.h"
@@ -762,8 +763,9 @@ sdword kasfPointInside(Volume *volume, hvector *location)
 //
 sdword kasfFindShipsInside(Volume *volume, GrowSelection *ships)
 {
-    Ship *ship;
-    Node *node;
+    spqshipfilter filter = { SOF_Dead|SOF_Hide, NULL, NULL, NULL };
+    SpaceObj **found;
+    sdword i, numFound;
 
     if (ships == NULL)
         return 0;
@@ -771,21 +773,9 @@ sdword kasfFindShipsInside(Volume *volume, GrowSelection *ships)
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
-    {
-        ship = (Ship *)listGetStructOfNode(node);
-
-        if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            if (volPointInside(volume, &(ship->posinfo.position)))
-                // add it
-                growSelectAddShip(ships, ship);
-        }
-
-        node = node->next;
-    }
+    numFound = spqVolume(SPQ_Ships, volume, spqShipFilter, &filter, &found);
+    for (i = 0; i < numFound; i++)
+        growSelectAddShip(ships, (Ship *)found[i]);
 
     return ships->selection->numShips;
 }
@@ -796,8 +786,9 @@ sdword kasfFindShipsInside(Volume *volume, GrowSelection *ships)
 //
 sdword kasfFindEnemyShipsInside(Volume *volume, GrowSelection *ships)
 {
-    Ship *ship;
-    Node *node;
+    spqshipfilter filter = { SOF_Dead|SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled, NULL, NULL, NULL };
+    SpaceObj **found;
+    sdword i, numFound;
 
     if (ships == NULL)
         return 0;
@@ -805,21 +796,11 @@ sdword kasfFindEnemyShipsInside(Volume *volume, GrowSelection *ships)
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
-    {
-        ship = (Ship *)listGetStructOfNode(node);
-
-        if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            if (!ship->playerowner->playerIndex && (!bitTest(ship->flags,SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled)) && volPointInside(volume, &(ship->posinfo.position)))
-                // add it
-                growSelectAddShip(ships, ship);
-        }
-
-        node = node->next;
-    }
+    //  the human's ships (enemy == human)
+    filter.owner = &universe.players[0];
+    numFound = spqVolume(SPQ_Ships, volume, spqShipFilter, &filter, &found);
+    for (i = 0; i < numFound; i++)
+        growSelectAddShip(ships, (Ship *)found[i]);
 
     return ships->selection->numShips;
 }
@@ -831,10 +812,10 @@ sdword kasfFindEnemyShipsInside(Volume *volume, GrowSelection *ships)
 //
 sdword kasfFindEnemiesNearby(GrowSelection *ships, sdword radius)
 {
-    Ship *medianShip, *ship;
-    real32 rangeSquared = (real32)radius*(real32)radius;
-    Node *node;
-    sdword i;
+    spqshipfilter filter = { SOF_Dead|SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled, NULL, NULL, NULL };
+    Ship *medianShip;
+    SpaceObj **found;
+    sdword i, numFound;
 
     if (ships == NULL || ships->selection == NULL || !(ships->selection->numShips))
         return 0;
@@ -856,28 +837,11 @@ sdword kasfFindEnemiesNearby(GrowSelection *ships, sdword radius)
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
-    {
-        ship = (Ship *)listGetStructOfNode(node);
-
-        if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            // is it an enemy?  (simplifying assumption: "is it the human"?)
-            if ((!ship->playerowner->playerIndex) && (!bitTest(ship->flags,SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled)))
-            {
-                // within the radius?
-                if (medianShip == ship || aiuFindDistanceSquared(medianShip->posinfo.position, ship->posinfo.position) <= rangeSquared)
-                {
-                    // add it
-                    growSelectAddShip(ships, ship);
-                }
-            }
-        }
-
-        node = node->next;
-    }
+    //  the human's ships (enemy == human) within the radius
+    filter.owner = &universe.players[0];
+    numFound = spqSphere(SPQ_Ships, &medianShip->posinfo.position, (real32)radius, spqShipFilter, &filter, &found);
+    for (i = 0; i < numFound; i++)
+        growSelectAddShip(ships, (Ship *)found[i]);
 
     return ships->selection->numShips;
 }
@@ -888,9 +852,10 @@ sdword kasfFindEnemiesNearby(GrowSelection *ships, sdword radius)
 //
 sdword kasfFindEnemiesNearTeam(GrowSelection *ships, sdword radius)
 {
-    Ship *medianShip, *ship;
-    real32 rangeSquared = (real32)radius*(real32)radius;
-    Node *node;
+    spqshipfilter filter = { SOF_Dead|SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled, NULL, NULL, NULL };
+    Ship *medianShip;
+    SpaceObj **found;
+    sdword i, numFound;
 
     if (ships == NULL || ships->selection == NULL)
         return 0;
@@ -906,28 +871,11 @@ sdword kasfFindEnemiesNearTeam(GrowSelection *ships, sdword radius)
     //
     medianShip = CurrentTeamP->shipList.selection->ShipPtr[0];
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
-    {
-        ship = (Ship *)listGetStructOfNode(node);
-
-        if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            // is it an enemy?  (simplifying assumption: "is it the human"?)
-            if (!ship->playerowner->playerIndex && (!bitTest(ship->flags,SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled)))
-            {
-                // within the radius?
-                if (medianShip == ship || aiuFindDistanceSquared(medianShip->posinfo.position, ship->posinfo.position) <= rangeSquared)
-                {
-                    // add it
-                    growSelectAddShip(ships, ship);
-                }
-            }
-        }
-
-        node = node->next;
-    }
+    //  the human's ships (enemy == human) within the radius
+    filter.owner = &universe.players[0];
+    numFound = spqSphere(SPQ_Ships, &medianShip->posinfo.position, (real32)radius, spqShipFilter, &filter, &found);
+    for (i = 0; i < numFound; i++)
+        growSelectAddShip(ships, (Ship *)found[i]);
 
     return ships->selection->numShips;
 }
@@ -937,10 +885,10 @@ sdword kasfFindEnemiesNearTeam(GrowSelection *ships, sdword radius)
 //
 sdword kasfFindShipsNearPoint(GrowSelection *ships, hvector *location, sdword radius)
 {
-    Ship *ship;
-    real32 rangeSquared = (real32)radius*(real32)radius;
+    spqshipfilter filter = { SOF_Dead|SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled, NULL, NULL, NULL };
     vector position;
-    Node *node;
+    SpaceObj **found;
+    sdword i, numFound;
 
     if (ships == NULL || ships->selection == NULL || location == NULL)
         return 0;
@@ -950,28 +898,9 @@ sdword kasfFindShipsNearPoint(GrowSelection *ships, hvector *location, sdword ra
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
-    {
-        ship = (Ship *)listGetStructOfNode(node);
-
-        if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            // is it an ship of some kind?
-            if (!bitTest(ship->flags,SOF_Crazy|SOF_Hide|SOF_Hyperspace|SOF_Disabled))
-            {
-                // within the radius?
-                if (aiuFindDistanceSquared(position, ship->posinfo.position) <= rangeSquared)
-                {
-                    // add it
-                    growSelectAddShip(ships, ship);
-                }
-            }
-        }
-
-        node = node->next;
-    }
+    numFound = spqSphere(SPQ_Ships, &position, (real32)radius, spqShipFilter, &filter, &found);
+    for (i = 0; i < numFound; i++)
+        growSelectAddShip(ships, (Ship *)found[i]);
 
     return ships->selection->numShips;
 }
@@ -1540,6 +1469,7 @@ void SelectionSwitchPlayerOwner(SelectCommand *selection)
             univRemoveShipFromHotkeyGroup(ship,FALSE);
 
             ship->playerowner = &universe.players[1];
+            univShipIndexDirty();
             ship->attributes |= ATTRIBUTES_Defector;
             bitClear(ship->flags,SOF_Selectable);
 
@@ -1553,6 +1483,7 @@ void SelectionSwitchPlayerOwner(SelectCommand *selection)
             // going from kas ships to human ships
             aiplayerShipDied(ship);
             ship->playerowner = &universe.players[0];
+            univShipIndexDirty();
             bitClear(ship->attributes,ATTRIBUTES_Defector);
 			bitClear(ship->flags,SOF_Disabled);
             bitSet(ship->flags,SOF_Selectable);
@@ -1922,9 +1853,9 @@ sdword kasfRUsEnemyCollected(void)
 //  serves the "friendly" and "enemy" functions below
 static sdword kasfFindPlayersShipsOfType(GrowSelection *ships, char *shipType, sdword playerIndex)
 {
-    Node *node;
     ShipType st = StrToShipType(shipType);
-    Ship *ship;
+    Ship *ship, **typeShips;
+    sdword i, numTypeShips;
 
 //    if (st < 0)
 //        return 0;
@@ -1935,21 +1866,15 @@ static sdword kasfFindPlayersShipsOfType(GrowSelection *ships, char *shipType, s
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
+    //  check all the player's ships of the right type
+    numTypeShips = univShipsOfPlayerType(playerIndex, st, &typeShips);
+    for (i = 0; i < numTypeShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(node);
+        ship = typeShips[i];
 
         if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            //  1. is it an enemy?  (simplifying assumption: "is it the human"?)
-            //  2. is the right type?
-            if (ship->playerowner->playerIndex == playerIndex && ship->shiptype == st)
-                // add it
-                growSelectAddShip(ships, ship);
-        }
-        node = node->next;
+            // add it
+            growSelectAddShip(ships, ship);
     }
 
     return ships->selection->numShips;
@@ -1970,9 +1895,9 @@ sdword kasfFindFriendlyShipsOfType(GrowSelection *ships, char *shipType)
 //  serves the "friendly" and "enemy" functions below
 static sdword kasfFindPlayersShipsOfClass(GrowSelection *ships, char *shipClass, sdword playerIndex)
 {
-    Node *node;
     ShipClass sc = StrToShipClass(shipClass);
-    Ship *ship;
+    Ship *ship, **classShips;
+    sdword i, numClassShips;
 
 //    if (sc < 0)
 //        return 0;
@@ -1983,21 +1908,15 @@ static sdword kasfFindPlayersShipsOfClass(GrowSelection *ships, char *shipClass,
     //  wipe the selection clean
     ships->selection->numShips = 0;
 
-    //  check all ships in the damn universe
-    node = universe.ShipList.head;
-    while (node != NULL)
+    //  check all the player's ships of the right class
+    numClassShips = univShipsOfPlayerClass(playerIndex, sc, &classShips);
+    for (i = 0; i < numClassShips; i++)
     {
-        ship = (Ship *)listGetStructOfNode(node);
+        ship = classShips[i];
 
         if ((ship->flags & (SOF_Dead|SOF_Hide)) == 0)
-        {
-            //  1. is it an enemy?  (simplifying assumption: "is it the human"?)
-            //  2. is the right class?
-            if (ship->playerowner->playerIndex == playerIndex && ship->staticinfo->shipclass == sc)
-                // add it
-                growSelectAddShip(ships, ship);
-        }
-        node = node->next;
+            // add it
+            growSelectAddShip(ships, ship);
     }
 
     return ships->selection->numShips;
@@ -20,6 +20,7 @@
 #include "Key.h"
 #include "texreg.h"
 #include "LOD.h"
+#include "Prefetch.h"
 
 extern meshdata *defaultmesh;          // hack for now.  remove later when defaults no longer needed
 
@@ -29,6 +30,7 @@ extern meshdata *defaultmesh;          // hack for now.  remove later when defau
 //script-parsing function for LOD files
 static void lodTypeRead(char *directory,char *field,void *dataToFillIn);
 static void lodMeshFileLoad(char *directory,char *field,void *dataToFillIn);
+static void lodMeshLoad(char *fullfilename, meshdata **dest);
 static void lodSpriteFileRead(char *directory,char *field,void *dataToFillIn);
 static void lodColorScalarRead(char *directory,char *field,void *dataToFillIn);
 static lodinfo lodStaticInfo;
@@ -83,6 +85,15 @@ scriptStructEntry lodScriptTable[] =
     END_SCRIPT_STRUCT_ENTRY
 };
 
+//meshes named by the LOD file being read, loaded once the whole file has
+//been read so they can all be streaming in the meantime
+static struct
+{
+    char fileName[80];                          //empty if none for this level
+    real32 baseScalar, stripeScalar;            //texture colour scalars in effect when it was named
+}
+lodMeshPending[LOD_NumberLevels];
+
 //scaling factor for the LOD's
 real32 lodScaleFactor = LOD_ScaleFactor;
 
@@ -112,10 +123,21 @@ lodinfo *lodTableReadScript(char *directory, char *fileName)
     {                                                       //initialize the lodmaxinfo structure
         lodMaxInfo.level[index].flags = LT_Invalid;
         lodMaxInfo.level[index].pData = NULL;
+        lodMeshPending[index].fileName[0] = 0;
     }
 
     trBaseColorScalar = trStripeColorScalar = 0.0f;
     scriptSetStruct(directory, fileName, lodScriptTable, (ubyte *)&lodMaxInfo);//read the script file
+
+    for (index = 0; index < LOD_NumberLevels; index++)
+    {                                                       //now load the meshes it named
+        if (lodMeshPending[index].fileName[0] != 0)
+        {
+            trBaseColorScalar = lodMeshPending[index].baseScalar;
+            trStripeColorScalar = lodMeshPending[index].stripeScalar;
+            lodMeshLoad(lodMeshPending[index].fileName, (meshdata **)&lodMaxInfo.level[index].pData);
+        }
+    }
     trBaseColorScalar = trStripeColorScalar = 0.0f;
 
     for (index = 0; index < LOD_NumberLevels; index++)
@@ -217,13 +239,24 @@ static void lodTypeRead(char *directory,char *field,void *dataToFillIn)
     }
 #endif
 }
-//load in a mesh
+//note a mesh to load once the LOD file has been read and start it streaming in
 static void lodMeshFileLoad(char *directory,char *field,void *dataToFillIn)
 {
-    char fullfilename[80];
+    char *fullfilename;
+    sdword index;
 #if LOD_VERBOSE_LEVEL >= 1
 //    dbgMessagef("lodMeshFileLoad: %s", field);
 #endif
+    for (index = 0; index < LOD_NumberLevels; index++)
+    {
+        if (dataToFillIn == (void *)&lodMaxInfo.level[index].pData)
+        {
+            break;
+        }
+    }
+    dbgAssertOrIgnore(index < LOD_NumberLevels);
+
+    fullfilename = lodMeshPending[index].fileName;
     if (directory != NULL)
     {
         strcpy(fullfilename,directory);
@@ -233,14 +266,24 @@ static void lodMeshFileLoad(char *directory,char *field,void *dataToFillIn)
     {
         strcpy(fullfilename,field);
     }
+    lodMeshPending[index].baseScalar = trBaseColorScalar;
+    lodMeshPending[index].stripeScalar = trStripeColorScalar;
 
+    if (pfNumberWorkers() > 0)
+    {                                                       //get it streaming while the rest of the file is read
+        meshPrefetch(fullfilename);
+    }
+}
+//load in a mesh
+static void lodMeshLoad(char *fullfilename, meshdata **dest)
+{
     if (fileExists(fullfilename,0) || meshPagedVersionExists(fullfilename))
     {
-        *((meshdata **)dataToFillIn) = meshLoad(fullfilename);
+        *dest = meshLoad(fullfilename);
     }
     else
     {
-        *((meshdata **)dataToFillIn) = defaultmesh;
+        *dest = defaultmesh;
     }
 }
 //load in a tiny sprite file
@@ -267,15 +310,31 @@ sdword lodDrawingMode = FALSE;
 #endif
 lod *lodLevelGet(void *spaceObj, vector *camera, vector *ship)
 {
-    real32 distance;
+    SpaceObj *obj = (SpaceObj *)spaceObj;
+
+    vecSub(obj->cameraDistanceVector,*camera,*ship);
+    obj->cameraDistanceSquared = vecMagnitudeSquared(obj->cameraDistanceVector);
+
+    return(lodLevelGetAtDistance(spaceObj));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : lodLevelGetAtDistance
+    Description : Get level of detail for specified ship, with the distance
+                    to the camera already worked out (as by the cull pass)
+    Inputs      : spaceObj - space object to get, with cameraDistanceVector
+                    and cameraDistanceSquared set
+    Outputs     : updates the currentLOD of the specified space object.
+    Return      : lod structure for current level of detail
+----------------------------------------------------------------------------*/
+lod *lodLevelGetAtDistance(void *spaceObj)
+{
     SpaceObj *obj = (SpaceObj *)spaceObj;
     lodinfo *info = obj->staticinfo->staticheader.LOD;
+    real32 distance = obj->cameraDistanceSquared;
 
     dbgAssertOrIgnore(info != NULL);                                //verify the LOD table exists
 
-    vecSub(obj->cameraDistanceVector,*camera,*ship);
-    obj->cameraDistanceSquared = distance = vecMagnitudeSquared(obj->cameraDistanceVector);
-
 #if LOD_SCALE_DEBUG
     if (lodDebugScaleFactor != 0.0f)
     {
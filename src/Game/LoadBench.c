@@ -0,0 +1,196 @@
+// =============================================================================
+//  LoadBench.c
+//  - headless level load benchmark, loads every single player mission in
+//    turn and reports where the time goes
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "LoadBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "Globals.h"
+#include "main.h"
+#include "Prefetch.h"
+#include "SinglePlayer.h"
+#include "texreg.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool loadBenchEnabled = FALSE;
+
+static char *loadBenchStageName[LB_NumberStages] =
+{
+    "pre-init",
+    "static info",
+    "level init",
+    "effects",
+    "textures",
+    "other",
+    "unload",
+};
+
+static sqword loadBenchStageStart = 0;
+static sqword loadBenchLevelTime[LB_NumberStages];
+static sqword loadBenchTotalTime[LB_NumberStages];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : loadBenchSet
+    Description : Command-line handler for /loadBench
+    Inputs      :
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool loadBenchSet(char *string)
+{
+    loadBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadBenchStage
+    Description : Charges the time since the last call to a load stage.
+                  Called at the stage boundaries in gameStart.
+    Inputs      : stage - LB_ stage that just finished
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void loadBenchStage(sdword stage)
+{
+    sqword now;
+
+    if (!loadBenchEnabled)
+    {
+        return;
+    }
+
+    dbgAssertOrIgnore(stage >= 0 && stage < LB_NumberStages);
+    GetRawTime(&now);
+    loadBenchLevelTime[stage] += now - loadBenchStageStart;
+    loadBenchStageStart = now;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadBenchLevel
+    Description : Loads and unloads one single player mission the way a new
+                  game would, warping there if it's not the first one.
+    Inputs      : mission - mission to load
+                  first - TRUE for the first mission of the sequence
+    Outputs     : fills in loadBenchLevelTime
+    Return      : FALSE if the mission didn't start
+----------------------------------------------------------------------------*/
+static bool loadBenchLevel(MissionEnum mission, bool first)
+{
+    bool started;
+
+    memset(loadBenchLevelTime, 0, sizeof(loadBenchLevelTime));
+
+    singlePlayerGame = TRUE;
+    tutorial = TUTORIAL_SINGLEPLAYER;
+    numPlayers = 2;
+    curPlayer = 0;
+    strcpy(playerNames[0], "Player");
+
+    spSetCurrentMission(mission);
+    spWarpLevelOverride = first ? 0 : mission;
+
+    GetRawTime(&loadBenchStageStart);
+    singlePlayerInit();
+    gameStart(NULL);
+    started = gameIsRunning;
+
+    //no GL, so gameStart leaves the textures pending; read them anyway
+    trRegistryFilesRead();
+    loadBenchStage(LB_Textures);
+    pfFlush();
+
+    gameEnd();
+    gameIsRunning = FALSE;
+    loadBenchStage(LB_Unload);
+
+    spWarpLevelOverride = 0;
+    return started;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadBenchRun
+    Description : Loads every mission of the single player sequence in turn
+                  with no rendering or sound and prints the time taken by
+                  each load stage.  Called from main instead of the event
+                  loop when /loadBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword loadBenchRun(void)
+{
+    MissionEnum mission, next;
+    sdword stage, nLevels = 0, nFailed = 0;
+    sqword total, grandTotal = 0;
+    bool first = TRUE;
+    char name[16];
+
+    memset(loadBenchTotalTime, 0, sizeof(loadBenchTotalTime));
+    pfStatsReset();
+
+    printf("LoadBench: %u prefetch workers\n", pfNumberWorkers());
+    printf("  %-12s", "mission");
+    for (stage = 0; stage < LB_NumberStages; stage++)
+    {
+        printf(" %11s", loadBenchStageName[stage]);
+    }
+    printf(" %11s\n", "total");
+
+    spResetMissionSequenceToBeginning();
+    for (mission = spGetCurrentMission(); mission != MISSION_ENUM_NOT_INITIALISED; mission = next)
+    {
+        if (!loadBenchLevel(mission, first))
+        {
+            nFailed++;
+        }
+        first = FALSE;
+        nLevels++;
+
+        sprintf(name, "mission %d", mission);
+        printf("  %-12s", name);
+        for (stage = 0, total = 0; stage < LB_NumberStages; stage++)
+        {
+            printf(" %8.1f ms", (real64)loadBenchLevelTime[stage] / 1000.0);
+            loadBenchTotalTime[stage] += loadBenchLevelTime[stage];
+            total += loadBenchLevelTime[stage];
+        }
+        printf(" %8.1f ms\n", (real64)total / 1000.0);
+        grandTotal += total;
+
+        spSetCurrentMission(mission);
+        next = spGetNextMission();
+    }
+
+    printf("  %-12s", "all");
+    for (stage = 0; stage < LB_NumberStages; stage++)
+    {
+        printf(" %8.1f ms", (real64)loadBenchTotalTime[stage] / 1000.0);
+    }
+    printf(" %8.1f ms\n", (real64)grandTotal / 1000.0);
+
+    printf("  %d missions loaded, %d failed to start\n", nLevels, nFailed);
+    printf("  prefetch: %u requested, %u claimed, %u missed, %u wasted, %u failed\n",
+           pfStats.nRequested, pfStats.nClaimed, pfStats.nMissed, pfStats.nWasted, pfStats.nFailed);
+    printf("  prefetch: %.1f MB streamed, %.1f ms waiting on workers\n",
+           (real64)pfStats.bytesLoaded / (1024.0 * 1024.0), (real64)pfStats.waitTime / 1000.0);
+
+    return (nFailed == 0) ? 0 : -1;
+}
@@ -0,0 +1,44 @@
+// =============================================================================
+//  LoadBench.h
+//  - headless level load benchmark, loads every single player mission in
+//    turn and reports where the time goes
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___LOADBENCH_H
+#define ___LOADBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+//load stages, in the order gameStart goes through them
+#define LB_PreInit              0               // mission pre-pass, AI startup
+#define LB_StaticInfo           1               // ships, meshes and texture registration
+#define LB_LevelInit            2               // players, research, mission start
+#define LB_Effects              3
+#define LB_Textures             4
+#define LB_Other                5               // the rest of gameStart
+#define LB_Unload               6               // gameEnd
+#define LB_NumberStages         7
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool loadBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool loadBenchSet(char *string);
+
+void loadBenchStage(sdword stage);
+
+sdword loadBenchRun(void);
+
+#endif
@@ -10,6 +10,7 @@
 #include "Key.h"
 #include "File.h"
 #include "Memory.h"
+#include "TimeoutTimer.h"
 #if MEM_VOLATILE_CLEARING
 #include <time.h>
 #include "CRC32.h"
@@ -52,6 +53,12 @@ memcookiename memStatsCookieNames[MS_NumberCookieNames];
 FILE *memNonVolatileFile;
 #endif
 
+//alloc/free trace log
+#if MEM_TRACE
+bool memTraceEnabled = FALSE;
+FILE *memTraceFile = NULL;
+#endif
+
 memsmallheapinfo memSmallHeapInfo[] =
 {
     {64, 3072},     //192k
@@ -68,6 +75,17 @@ sdword memSmallBlockHeapMaxSize = 0;
 volatilestat memVolatileStat[MEM_NumberVolatileStats];
 #endif
 
+//per-frame arena
+memframechunk *memFrameChunk = NULL;                    //newest chunk, blocks come off its top
+memframechunk *memFrameSpare = NULL;                    //chunk kept from the last reset for reuse
+#if MEM_ERROR_CHECKING
+static const udword memFrameGuardValue = MEM_FrameGuard;
+#endif
+
+//typed object pools
+memobjslab **memObjSlabs = NULL;                        //slabs of all pools, sorted by address
+sdword memObjNumberSlabs = 0;
+
 #if MEM_VOLATILE_CLEARING
 udword memClearSetting = MEM_ClearSetting;
 udword memFreeSetting = MEM_FreeSetting;
@@ -213,6 +231,9 @@ sdword memStartup(void *heapStart, sdword heapSize, memgrowcallback grow)
 #if MEM_FILE_NV
     char *memNonVolatileFileName;
 #endif
+#if MEM_TRACE
+    char *memTraceFileName;
+#endif
 
 #ifdef _X86_64
     if ((sizeof(mbhcookie) != 64) || (sizeof(memcookie) != 64))
@@ -256,6 +277,20 @@ sdword memStartup(void *heapStart, sdword heapSize, memgrowcallback grow)
             dbgMessage("Error creating log file mem.nv.");
         }
     }
+#endif
+#if MEM_TRACE
+    if (memTraceEnabled)
+    {
+        memTraceFileName = filePathPrepend(MEM_TraceFileName, FF_UserSettingsPath);
+        if (fileMakeDestinationDirectory(memTraceFileName))
+        {
+            memTraceFile = fopen(memTraceFileName, "wt");
+        }
+        if (memTraceFile == NULL)
+        {
+            dbgMessagef("Error creating trace file %s.", MEM_TraceFileName);
+        }
+    }
 #endif
     memGrowthAllocate = grow;
 
@@ -284,6 +319,204 @@ sdword memStartup(void *heapStart, sdword heapSize, memgrowcallback grow)
     return(memReset());
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : memBitHighest
+    Description : Finds the highest set bit of a non-zero dword
+    Inputs      : bits - dword to search
+    Outputs     :
+    Return      : index of the highest bit set
+----------------------------------------------------------------------------*/
+static sdword memBitHighest(udword bits)
+{
+    sdword bit = 0;
+
+    dbgAssertOrIgnore(bits != 0);
+    if (bits & 0xffff0000)
+    {
+        bits >>= 16;
+        bit += 16;
+    }
+    if (bits & 0xff00)
+    {
+        bits >>= 8;
+        bit += 8;
+    }
+    if (bits & 0xf0)
+    {
+        bits >>= 4;
+        bit += 4;
+    }
+    if (bits & 0xc)
+    {
+        bits >>= 2;
+        bit += 2;
+    }
+    if (bits & 0x2)
+    {
+        bit += 1;
+    }
+    return(bit);
+}
+
+#define memBitLowest(bits)      memBitHighest((bits) & (~(bits) + 1))
+
+/*-----------------------------------------------------------------------------
+    Name        : memFreeListMapping
+    Description : Finds what free list a block of a given length lives in
+    Inputs      : blocks - length of the block, in blocks
+    Outputs     : firstLevel, secondLevel - indices of the free list
+    Return      :
+----------------------------------------------------------------------------*/
+static void memFreeListMapping(sdword blocks, sdword *firstLevel, sdword *secondLevel)
+{
+    sdword bit;
+
+    if (blocks < MEM_SLCount)
+    {                                                       //small sizes get a list each
+        *firstLevel = 0;
+        *secondLevel = blocks;
+    }
+    else
+    {
+        bit = memBitHighest((udword)blocks);
+        *firstLevel = bit - MEM_SLLog + 1;
+        *secondLevel = (blocks >> (bit - MEM_SLLog)) - MEM_SLCount;
+    }
+    dbgAssertOrIgnore(*firstLevel < MEM_FLCount);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFreeListInsert
+    Description : Adds a free cookie to the head of its free list
+    Inputs      : pool - pool the cookie is in
+                  cookie - free cookie, with at least one block of body
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void memFreeListInsert(mempool *pool, memcookie *cookie)
+{
+    sdword firstLevel, secondLevel;
+    memfreelink *link = memFreeLink(cookie);
+
+    dbgAssertOrIgnore(cookie->blocksNext > 0);
+    dbgAssertOrIgnore(!bitTest(cookie->flags, MBF_AllocatedNext));
+
+    memFreeListMapping(cookie->blocksNext, &firstLevel, &secondLevel);
+    link->prev = NULL;
+    link->next = pool->freeList[firstLevel][secondLevel];
+    if (link->next != NULL)
+    {
+        memFreeLink(link->next)->prev = cookie;
+    }
+    pool->freeList[firstLevel][secondLevel] = cookie;
+    pool->freeFirstLevel |= 1 << firstLevel;
+    pool->freeSecondLevel[firstLevel] |= 1 << secondLevel;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFreeListRemove
+    Description : Takes a free cookie out of its free list
+    Inputs      : pool - pool the cookie is in
+                  cookie - free cookie
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void memFreeListRemove(mempool *pool, memcookie *cookie)
+{
+    sdword firstLevel, secondLevel;
+    memfreelink *link = memFreeLink(cookie);
+
+    memFreeListMapping(cookie->blocksNext, &firstLevel, &secondLevel);
+    if (link->next != NULL)
+    {
+        memFreeLink(link->next)->prev = link->prev;
+    }
+    if (link->prev != NULL)
+    {
+        memFreeLink(link->prev)->next = link->next;
+    }
+    else
+    {                                                       //it was the head of the list
+        dbgAssertOrIgnore(pool->freeList[firstLevel][secondLevel] == cookie);
+        pool->freeList[firstLevel][secondLevel] = link->next;
+        if (link->next == NULL)
+        {                                                   //list is now empty
+            bitClear(pool->freeSecondLevel[firstLevel], 1 << secondLevel);
+            if (pool->freeSecondLevel[firstLevel] == 0)
+            {
+                bitClear(pool->freeFirstLevel, 1 << firstLevel);
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFreeListFind
+    Description : Finds a free cookie at least a given length.  The length is
+                    rounded up to the next list boundary so that the head of
+                    any list found is big enough, which makes this a constant
+                    time search at the cost of a slightly looser fit.
+    Inputs      : pool - pool to search
+                  blocks - length needed, in blocks
+    Outputs     :
+    Return      : free cookie or NULL if there's nothing big enough
+----------------------------------------------------------------------------*/
+static memcookie *memFreeListFind(mempool *pool, sdword blocks)
+{
+    sdword firstLevel, secondLevel;
+    udword levelBits;
+
+    if (blocks >= MEM_SLCount)
+    {
+        blocks += (1 << (memBitHighest((udword)blocks) - MEM_SLLog)) - 1;
+    }
+    memFreeListMapping(blocks, &firstLevel, &secondLevel);
+
+    levelBits = pool->freeSecondLevel[firstLevel] & (0xffffffff << secondLevel);
+    if (levelBits == 0)
+    {                                                       //nothing in this level, try the bigger ones
+        if (firstLevel + 1 >= MEM_FLCount)
+        {
+            return(NULL);
+        }
+        levelBits = pool->freeFirstLevel & (0xffffffff << (firstLevel + 1));
+        if (levelBits == 0)
+        {
+            return(NULL);
+        }
+        firstLevel = memBitLowest(levelBits);
+        levelBits = pool->freeSecondLevel[firstLevel];
+    }
+    secondLevel = memBitLowest(levelBits);
+    return(pool->freeList[firstLevel][secondLevel]);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFreeListFindLargest
+    Description : Finds a free cookie from the list of biggest free blocks
+    Inputs      : pool - pool to search
+                  blocks - length needed, in blocks
+    Outputs     :
+    Return      : free cookie or NULL if there's nothing big enough
+----------------------------------------------------------------------------*/
+static memcookie *memFreeListFindLargest(mempool *pool, sdword blocks)
+{
+    sdword firstLevel;
+    memcookie *cookie;
+
+    if (pool->freeFirstLevel == 0)
+    {
+        return(NULL);
+    }
+    firstLevel = memBitHighest(pool->freeFirstLevel);
+    cookie = pool->freeList[firstLevel][memBitHighest(pool->freeSecondLevel[firstLevel])];
+    if (cookie->blocksNext >= blocks)
+    {
+        return(cookie);
+    }
+    return(memFreeListFind(pool, blocks));                  //head of that list is too small; any fit will do
+}
+
 /*-----------------------------------------------------------------------------
     Name        : memPoolReset
     Description : Reset the specified pool.  Clears everything out.
@@ -361,29 +594,28 @@ void memPoolReset(mempool *pool, void *heapStart, sdword heapSize, bool bSmallHe
         }
 #endif //MEM_SMALL_BLOCK_HEAP
     }
-    //set pointer to first free memory cookie
-    pool->first = pool->firstFree = (memcookie *)memRoundUp((memsize)poolData);
+    //set pointer to first memory cookie
+    pool->first = (memcookie *)memRoundUp((memsize)poolData);
     //get length of newly sized pool
     pool->heapLength = memRoundDown(pool->pool + pool->poolLength - (ubyte *)pool->first);
     dbgAssertOrIgnore(pool->heapLength > 1);
 
     //set pointer to end of pool
-    pool->lastFree = pool->last = (memcookie *)((ubyte *)pool->first + pool->heapLength - sizeof(memcookie) * 2);
+    pool->last = (memcookie *)((ubyte *)pool->first + pool->heapLength - sizeof(memcookie) * 2);
 
     //init first free cookie
-    pool->firstFree->flags = MBF_VerifyValue;
-    pool->firstFree->blocksNext = memBlocksCompute(pool->firstFree, pool->last) - 1;
-    pool->firstFree->blocksPrevious = -1;
-    memNameSet(pool->firstFree, MEM_NameHeap);
-    pool->last->blocksPrevious = memBlocksCompute(pool->firstFree, pool->last) - 1;
+    pool->first->flags = MBF_VerifyValue;
+    pool->first->blocksNext = memBlocksCompute(pool->first, pool->last) - 1;
+    pool->first->blocksPrevious = -1;
+    memNameSet(pool->first, MEM_NameHeap);
+    pool->last->blocksPrevious = memBlocksCompute(pool->first, pool->last) - 1;
     pool->last->flags = MBF_VerifyValue;
 
-    //clear out all the cookie size pointers
-    memset(pool->firstSize, 0, sizeof(pool->firstSize));
-    for (index = 0; index < MSB_NumberSizes + 1; index++)
-    {                                                       //check all the min size pointers
-        pool->lastSize[index] = pool->last;
-    }
+    //clear out the free lists and file the whole heap as one free block
+    pool->freeFirstLevel = 0;
+    memset(pool->freeSecondLevel, 0, sizeof(pool->freeSecondLevel));
+    memset(pool->freeList, 0, sizeof(pool->freeList));
+    memFreeListInsert(pool, pool->first);
 }
 
 /*-----------------------------------------------------------------------------
@@ -472,11 +704,20 @@ sdword memClose(memgrowthfreecallback freeMem)
         fclose(memNonVolatileFile);
     }
 #endif
+#if MEM_TRACE
+    if (memTraceFile)
+    {
+        fclose(memTraceFile);
+        memTraceFile = NULL;
+    }
+#endif
 
     for (index = 0; index < memNumberGrowthPools; index++)
     {
         freeMem(memGrowthPool[index].wholePool);
     }
+    memFrameClose();
+    memObjClose();
     memModuleInit = FALSE;
     return(OKAY);
 }
@@ -618,15 +859,23 @@ void memRename(void *pointer, char *newName)
 ----------------------------------------------------------------------------*/
 void memPoolAnalCheck(mempool *pool)
 {
-    sdword index;
+    sdword firstLevel, secondLevel;
+    memcookie *cookie;
 
-    for (index = 0; index < MSB_NumberSizes + 1; index++)
+    for (firstLevel = 0; firstLevel < MEM_FLCount; firstLevel++)
     {
-        if (pool->firstSize[index] != NULL)
+        dbgAssertOrIgnore((bitTest(pool->freeFirstLevel, 1 << firstLevel) != 0) == (pool->freeSecondLevel[firstLevel] != 0));
+        for (secondLevel = 0; secondLevel < MEM_SLCount; secondLevel++)
         {
-            memCookieVerify(pool->firstSize[index]);
+            cookie = pool->freeList[firstLevel][secondLevel];
+            dbgAssertOrIgnore((bitTest(pool->freeSecondLevel[firstLevel], 1 << secondLevel) != 0) == (cookie != NULL));
+            if (cookie != NULL)
+            {
+                memCookieVerify(cookie);
+                dbgAssertOrIgnore(!bitTest(cookie->flags, MBF_AllocatedNext));
+                dbgAssertOrIgnore(memFreeLink(cookie)->prev == NULL);
+            }
         }
-        memCookieVerify(pool->lastSize[index]);
     }
 }
 #endif
@@ -754,186 +1003,13 @@ void *memAllocFunctionSBH(sdword length, udword flags)
 }
 #endif //MEM_SMALL_BLOCK_HEAP
 
-/*-----------------------------------------------------------------------------
-    Name        : memAllocFunctionANV
-    Description : Allocates a block of RAM
-    Inputs      : length - length of requested block in bytes, rounded to a block length
-                  name(optional) - name of block
-                  flags - allocation control flags
-                  pool - pool to allocate from
-    Outputs     : Newly allocated block may be cleared.
-    Return      : Pointer to newly allocated block, or NULL if failure.
-----------------------------------------------------------------------------*/
-#if MEM_USE_NAMES
-void *memAllocFunctionANV(sdword length, char *name, udword flags, mempool *pool)
-#else
-void *memAllocFunctionANV(sdword length, udword flags, mempool *pool)
-#endif
-{
-    ubyte *newPointer = NULL;
-    memcookie *cookie, *newCookie, *nextCookie;
-
-    memCookieVerify(pool->lastFree);
-
-    if (length <= MSB_SizeMax && mslSizeBytes(length) < pool->lastFree)
-    {
-        cookie = mslSizeBytes(length) - mslSizeBytes(length)->blocksPrevious - 1;
-        memCookieVerify(cookie);                            //make sure cookie is valid
-    }
-    else
-    {
-        cookie = pool->lastFree - pool->lastFree->blocksPrevious - 1;
-        memCookieVerify(cookie);                            //make sure cookie is valid
-    }
-
-    while (cookie >= pool->firstFree)
-    {
-#if MEM_STATISTICS
-        memNumberWalks++;
-#endif
-        memCookieVerify(cookie);                            //make sure cookie is valid
-
-        if (!bitTest(cookie->flags, MBF_AllocatedNext))     //if this block free
-        {
-            if (memBlocksToBytes(cookie->blocksNext) >= length)//if block bigger or equal to size needed
-            {
-                if (memBlocksToBytes(cookie->blocksNext) > length)//if block bigger size
-                {
-                    nextCookie = (memcookie *)((ubyte *)cookie +//next cookie
-                            sizeof(memcookie) + memBlocksToBytes(cookie->blocksNext));
-                    memCookieVerify(nextCookie);            //make sure next cookie valid
-                    dbgAssertOrIgnore(nextCookie->blocksPrevious == nextCookie - cookie - 1);
-                    nextCookie->blocksPrevious =            //next cookie has fewer
-                        length / MEM_BlockSize;             //bytes previous to it
-                    newCookie = (memcookie *)((ubyte *)nextCookie - sizeof(memcookie) - length);
-                    newCookie->blocksNext = length / MEM_BlockSize;
-                    newCookie->blocksPrevious = cookie->blocksNext - length / MEM_BlockSize - memBytesToBlocks(sizeof(memcookie));
-                    cookie->blocksNext -= length / MEM_BlockSize + 1;
-/*
-                    if (newCookie->blocksNext * MEM_BlockSize <= MSB_SizeMax &&
-                        mslSizeBlocks(newCookie->blocksNext) - mslSizeBlocks(newCookie->blocksNext)->blocksPrevious - 1 > newCookie)
-                    {   //set the min size block to applicable value
-                        mslSizeBlocks(newCookie->blocksNext) = newCookie + newCookie->blocksNext + 1;
-                    }
-*/
-#if MEM_VERBOSE_LEVEL >= 3
-                    dbgMessagef("memAllocFunctionANV: found free block of size %d at 0x%x, made new cookie at 0x%x of size %d",
-                               memBlocksToBytes(cookie->blocksNext),
-                               cookie, newCookie,
-                               memBlocksToBytes(newCookie->blocksNext));
-#endif
-                }
-                else
-                {                                           //else block is just the right length
-#if MEM_VERBOSE_LEVEL >= 3
-                    dbgMessagef("memAllocFunctionANV: found free same-size block at 0x%x", cookie);
-#endif
-                    newCookie = cookie;
-                }
-                newCookie->flags = MBF_VerifyValue | MBF_AllocatedNext | (flags & MBF_ParameterMask);
-                memNameSet(newCookie, name);
-#if MEM_DETECT_VOLATILE
-                newCookie->timeAllocated = taskTimeElapsed; //remember when cookie was allocated
-#endif
-                newPointer = (ubyte *)(newCookie + 1);      //set return pointer
-                if (length <= MSB_SizeMax)
-                {                                           //if this was a small block allocation
-                    //while this is not the first free block in the specified
-                    //size, it'll sure reduce the number of walks a lot.
-                    mslSizeBytes(length) = cookie + cookie->blocksNext + 1;
-                }
-                if ((memcookie *)((ubyte *)newCookie + length + sizeof(memcookie)) == pool->lastFree)
-                {                                           //if just allocated the last free cookie
-                    nextCookie = newCookie;
-                    do
-                    {                                       //find new last free cookie
-                        pool->lastFree = nextCookie;
-                        nextCookie = (memcookie *)((ubyte *)pool->lastFree - sizeof(memcookie) - memBlocksToBytes(pool->lastFree->blocksPrevious));
-                        memCookieVerify(nextCookie);
-                        if (nextCookie <= pool->firstFree)
-                        {
-                            break;
-                        }
-                    }
-                    while (bitTest(nextCookie->flags, MBF_AllocatedNext));
-//                    memNameSet(pool->lastFree, MEM_NameHeapLast);
-                }
-                break;                                          //found free cookie, stop searching
-            }
-#if MEM_VERBOSE_LEVEL >= 4
-            dbgMessagef("memAllocFunctionANV: skipping free block of size %d at 0x%x - too small", memBlocksToBytes(cookie->blocksNext), cookie);
-#endif
-        }
-        else
-        {
-#if MEM_VERBOSE_LEVEL >= 4
-            dbgMessagef("memAllocFunctionANV: skipping block of size %d at 0x%x - already allocated", memBlocksToBytes(cookie->blocksNext), cookie);
-#endif
-        }
-        if (cookie->blocksPrevious == -1)
-        {                                                   //if reached bottom of heap
-            break;
-        }
-        dbgAssertOrIgnore(memBlocksToBytes(cookie->blocksPrevious) >= 0 && memBlocksToBytes(cookie->blocksPrevious) < pool->heapLength);
-        cookie = (memcookie *)((ubyte *)cookie -            //next cookie
-                            sizeof(memcookie) - memBlocksToBytes(cookie->blocksPrevious));
-    }
-
-    if (newPointer == NULL)
-    {                                                       //if allocation failed
-        if (length > MSB_SizeMax)
-        {                                                   //if we were searching from the beginning
-#if MEM_VERBOSE_LEVEL >= 1
-            dbgMessagef("memAllocFunctionANV: failed to find block of length %d", length);
-#endif
-        }
-        else if (mslSizeBytes(length) != pool->lastFree && (mslSizeBytes(length) != pool->lastFree))
-        {                                                   //set this block to last free block and try again
-#if MEM_VERBOSE_LEVEL >= 1
-            dbgMessagef("memAllocFunctionANV: failed to find MSL block of length %d", length);
-#endif
-            //mslSizeBytes(length) = (memcookie *)((ubyte *)pool->lastFree - sizeof(memcookie));
-            mslSizeBytes(length) = pool->lastFree;
-#if MEM_USE_NAMES
-            newPointer = memAllocFunctionANV(length, name, flags, pool); //try to allocate again
-#else
-            newPointer = memAllocFunctionANV(length, flags, pool);
-#endif
-            return(newPointer);
-        }
-    }
-    else
-    {
-#if MEM_CLEAR_MEM                                           //clear the new block
-        memClearDword(newPointer, memClearSetting, length / sizeof(udword));
-#endif
-    }
-#if MEM_STATISTICS
-    if (keyIsStuck(MEM_StatsKey) && keyIsHit(CONTROLKEY))
-    {
-        keyClearSticky(MEM_StatsKey);
-        memStatsLogging ^= TRUE;
-    }
-    memNumberAllocs++;
-    memCookieNameAdd(name, length);
-#endif
-#if MEM_ANALYSIS_KEY
-    if (keyIsHit(SHIFTKEY) && keyIsStuck(MEM_ANALYSIS_KEY))
-    {
-        keyClearSticky(MEM_ANALYSIS_KEY);
-        memAnalysisCreate();
-    }
-#endif
-#if MEM_ANAL_CHECKING
-    memPoolAnalCheck(pool);
-#endif
-
-    return(newPointer);
-}
-
 /*-----------------------------------------------------------------------------
     Name        : memAllocFunctionA
-    Description : Allocates a block of volatile RAM, that is a block to be freed soon.
+    Description : Allocates a block of RAM from a specified pool.  Volatile
+                    blocks are taken from the bottom of the best fitting free
+                    block.  Non-volatile blocks are taken from the top of the
+                    biggest free block, which keeps them stacked down from
+                    the top of the heap, away from the volatile churn.
     Inputs      : length - length of requested block in bytes
                   name(optional) - name of block
                   flags - allocation control flags
@@ -949,6 +1025,7 @@ void *memAllocFunctionA(sdword length, udword flags, mempool *pool)
 {
     ubyte *newPointer = NULL;
     memcookie *cookie, *newCookie, *nextCookie;
+    sdword blocks;
 
     memInitCheck();
 
@@ -977,146 +1054,79 @@ void *memAllocFunctionA(sdword length, udword flags, mempool *pool)
 #endif
 
     length = memRoundUp(length);                            //round length up to block size
+    blocks = memBytesToBlocks(length);
 
-    //nonvolatile allocation scheme, if applicable
-    if (bitTest(flags, MBF_NonVolatile))
-    {
-#if MEM_USE_NAMES
-        return(memAllocFunctionANV(length, name, flags, pool));
-#else
-        return(memAllocFunctionANV(length, flags, pool));
+#if MEM_STATISTICS
+    memNumberWalks++;
 #endif
-    }
-
-    //regular volatile allocation, choose small or large blocks
-    if (length > MSB_SizeMax)
+    if (bitTest(flags, MBF_NonVolatile))
     {
-        cookie = pool->firstFree;                              //start at beginning of free list for large allocations
+        cookie = memFreeListFindLargest(pool, blocks);
     }
     else
     {
-        cookie = max(pool->firstFree, msbSizeBytes(length));   //start at first free block of a given size
+        cookie = memFreeListFind(pool, blocks);
     }
 
-    while (cookie < pool->lastFree)
-    {                                                       //walk through entire list
-#if MEM_STATISTICS
-        memNumberWalks++;
-#endif
+    if (cookie != NULL)
+    {
         memCookieVerify(cookie);                            //make sure cookie is valid
+        dbgAssertOrIgnore(!bitTest(cookie->flags, MBF_AllocatedNext));
+        dbgAssertOrIgnore(cookie->blocksNext >= blocks);
+        memFreeListRemove(pool, cookie);
 
-        if (!bitTest(cookie->flags, MBF_AllocatedNext))     //if this block free
-        {
-            if (memBlocksToBytes(cookie->blocksNext) >= length)//if block bigger or equal
-            {
-                if (memBlocksToBytes(cookie->blocksNext) > length)//if block bigger size
-                {
-                    nextCookie = (memcookie *)((ubyte *)cookie +//next cookie
-                            sizeof(memcookie) + memBlocksToBytes(cookie->blocksNext));
-                    memCookieVerify(nextCookie);            //make sure next cookie valid
-                    dbgAssertOrIgnore(nextCookie->blocksPrevious == nextCookie - cookie - 1);
-                    nextCookie->blocksPrevious -=           //next cookie has fewer
-                        length / MEM_BlockSize + 1;         //bytes previous to it
-                    newCookie = (memcookie *)((ubyte *)cookie + sizeof(memcookie) + length);
-                    newCookie->flags = MBF_VerifyValue;     //init the new cookie
-                    newCookie->blocksNext = cookie->blocksNext - length / MEM_BlockSize - memBytesToBlocks(sizeof(memcookie));
-                    newCookie->blocksPrevious = length / MEM_BlockSize;
-                    memNameSet(newCookie, MEM_HeapFree);        //set the name of new cookie
-                    //set min size pointer for newly created block if applicable
-/*
-                    if (newCookie->blocksNext * MEM_BlockSize <= MSB_SizeMax &&
-                        msbSizeBlocks(newCookie->blocksNext) < newCookie)
-                    {   //set the min size block to applicable value
-                        msbSizeBlocks(newCookie->blocksNext) = newCookie;
-                    }
-*/
-#if MEM_VERBOSE_LEVEL >= 3
-                    dbgMessagef("memAllocFunctionA: found free block of size %d at 0x%x, made new cookie at 0x%x of size %d",
-                               memBlocksToBytes(cookie->blocksNext),
-                               cookie, newCookie,
-                               memBlocksToBytes(newCookie->blocksNext));
-#endif
-                    cookie->blocksNext = length / MEM_BlockSize;//set new block size
-                }
-                else
-                {
-#if MEM_VERBOSE_LEVEL >= 3
-                    dbgMessagef("memAllocFunctionA: found free same-size block at 0x%x", cookie);
-#endif
-                }
-                memNameSet(cookie, name);                   //set new name
-                cookie->flags = MBF_VerifyValue | MBF_AllocatedNext | (flags & MBF_ParameterMask);
-#if MEM_DETECT_VOLATILE
-                cookie->timeAllocated = taskTimeElapsed;    //remember when cookie was allocated
-#endif
-                newPointer = (ubyte *)(cookie + 1);         //set return pointer
-
-                if (length <= MSB_SizeMax)
-                {                                           //if this was a small block allocation
-                    //while this is not the first free block in the specified
-                    //size, it'll sure reduce the number of walks a lot.
-                    msbSizeBytes(length) = cookie;
-                }
-                if (cookie == pool->firstFree)                 //if allocating first free block
-                {                                           //find next free cookie
-                    while (bitTest(pool->firstFree->flags, MBF_AllocatedNext))
-                    {
-                        memCookieVerify(pool->firstFree);      //verify this cookie
-                        nextCookie = (memcookie *)((ubyte *)pool->firstFree +//next cookie
-                                sizeof(memcookie) + memBlocksToBytes(pool->firstFree->blocksNext));
-                        if (nextCookie >= pool->lastFree)      //if cookie pointed past end of heap
-                        {
-                            goto noMoreFree;                //no more free structures
-                        }
-                        pool->firstFree = nextCookie;
-                    }
-                    memNameSet(pool->firstFree, MEM_NameHeapFirst);
-noMoreFree:;
-                }
-                break;
+        if (cookie->blocksNext > blocks + MEM_BlocksPerCookie)
+        {                                                   //if there's room to split off a free block
+            nextCookie = cookie + cookie->blocksNext + 1;
+            memCookieVerify(nextCookie);                    //make sure next cookie valid
+            dbgAssertOrIgnore(nextCookie->blocksPrevious == nextCookie - cookie - 1);
+            if (bitTest(flags, MBF_NonVolatile))
+            {                                               //allocate from the top, leave the bottom free
+                newCookie = nextCookie - blocks - 1;
+                newCookie->blocksNext = blocks;
+                newCookie->blocksPrevious = cookie->blocksNext - blocks - MEM_BlocksPerCookie;
+                nextCookie->blocksPrevious = blocks;
+                cookie->blocksNext = newCookie->blocksPrevious;
+                memFreeListInsert(pool, cookie);
+            }
+            else
+            {                                               //allocate from the bottom, leave the top free
+                newCookie = cookie + blocks + 1;
+                newCookie->flags = MBF_VerifyValue;         //init the new cookie
+                newCookie->blocksNext = cookie->blocksNext - blocks - MEM_BlocksPerCookie;
+                newCookie->blocksPrevious = blocks;
+                memNameSet(newCookie, MEM_HeapFree);        //set the name of new cookie
+                nextCookie->blocksPrevious = newCookie->blocksNext;
+                cookie->blocksNext = blocks;
+                memFreeListInsert(pool, newCookie);
+                newCookie = cookie;
             }
-#if MEM_VERBOSE_LEVEL >= 4
-            dbgMessagef("memAllocFunctionA: skipping free block of size %d at 0x%x - too small", memBlocksToBytes(cookie->blocksNext), cookie);
+#if MEM_VERBOSE_LEVEL >= 3
+            dbgMessagef("memAllocFunctionA: split free block at 0x%x, allocated 0x%x of size %d",
+                       cookie, newCookie, memBlocksToBytes(newCookie->blocksNext));
 #endif
         }
         else
-        {
-#if MEM_VERBOSE_LEVEL >= 4
-            dbgMessagef("memAllocFunctionA: skipping block of size %d at 0x%x - already allocated", memBlocksToBytes(cookie->blocksNext), cookie);
-#endif
-        }
-
-        dbgAssertOrIgnore(memBlocksToBytes(cookie->blocksNext) >= 0 && memBlocksToBytes(cookie->blocksNext) < pool->heapLength);
-        cookie = (memcookie *)((ubyte *)cookie +            //next cookie
-                            sizeof(memcookie) + memBlocksToBytes(cookie->blocksNext));
-    }
-
-    if (newPointer == NULL)
-    {                                                       //if allocation failed
-        if (length > MSB_SizeMax)
-        {                                                   //if we were searching from the beginning
-#if MEM_VERBOSE_LEVEL >= 1
-            dbgMessagef("memAllocFunctionA: failed to find block of length %d", length);
+        {                                                   //else use the whole block
+#if MEM_VERBOSE_LEVEL >= 3
+            dbgMessagef("memAllocFunctionA: found free same-size block at 0x%x", cookie);
 #endif
+            newCookie = cookie;
         }
-        else if (msbSizeBytes(length) != pool->firstFree && (msbSizeBytes(length) != pool->firstFree))
-        {                                                   //failure may be due to small-block fragmentation
-#if MEM_VERBOSE_LEVEL >= 1
-            dbgMessagef("memAllocFunctionA: failed to find MSB block of length %d", length);
+        newCookie->flags = MBF_VerifyValue | MBF_AllocatedNext | (flags & MBF_ParameterMask);
+        memNameSet(newCookie, name);
+#if MEM_DETECT_VOLATILE
+        newCookie->timeAllocated = taskTimeElapsed;         //remember when cookie was allocated
 #endif
-            msbSizeBytes(length) = pool->firstFree;            //set this block to first free block
-#if MEM_USE_NAMES
-            newPointer = memAllocFunctionA(length, name, flags, pool); //try to allocate again
-#else
-            newPointer = memAllocFunctionA(length, flags, pool);
+        newPointer = (ubyte *)(newCookie + 1);              //set return pointer
+#if MEM_CLEAR_MEM                                           //clear the new block
+        memClearDword(newPointer, memClearSetting, length / sizeof(udword));
 #endif
-            return(newPointer);
-        }
     }
     else
-    {
-#if MEM_CLEAR_MEM                                           //clear the new block
-        memClearDword(newPointer, memClearSetting, length / sizeof(udword));
+    {                                                       //if allocation failed
+#if MEM_VERBOSE_LEVEL >= 1
+        dbgMessagef("memAllocFunctionA: failed to find block of length %d", length);
 #endif
     }
 #if MEM_STATISTICS
@@ -1138,6 +1148,12 @@ noMoreFree:;
 #if MEM_ANAL_CHECKING
     memPoolAnalCheck(pool);
 #endif
+#if MEM_TRACE
+    if (memTraceFile != NULL && newPointer != NULL)
+    {
+        fprintf(memTraceFile, "a %p %d %x\n", (void *)newPointer, length, flags);
+    }
+#endif
 
     return(newPointer);
 }
@@ -1412,20 +1428,29 @@ void memFreeSBH(mbhcookie *cookie)
 #endif
 
 /*-----------------------------------------------------------------------------
-    Name        : memFreeNV
-    Description : Free a non-volatile memory cookie (only to be called from memFree)
-    Inputs      : cookie - cookie to free
-                  pool - pool to free from
+    Name        : memFreeCookie
+    Description : Returns a cookie from the regular heap to its pool, combining
+                    it with any free neighbours and filing the result in the
+                    free lists.
+    Inputs      : cookie - allocated cookie to free
+                  pool - pool the cookie belongs to
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
-void memFreeNV(memcookie *cookie, memcookie *nextCookie, mempool *pool)
+static void memFreeCookie(memcookie *cookie, mempool *pool)
 {
-    memcookie *previousCookie;
+    memcookie *nextCookie, *previousCookie;
     memcookie *stillNextCookie;
-    udword length, index;
 
-    if (nextCookie < pool->last)                               //if not end of heap
+    bitClear(cookie->flags, MBF_AllocatedNext);             //say it's not active
+    memNameSet(cookie, MEM_HeapFree);                       //clear name of cookie
+    //clear actual memory block
+#if MEM_CLEAR_MEM_ON_FREE
+    memClearDword(cookie + 1, memFreeSetting, memBlocksToBytes(cookie->blocksNext) / 4);
+#endif
+
+    nextCookie = cookie + cookie->blocksNext + 1;
+    if (nextCookie < pool->last)                            //if not end of heap
     {
         memCookieVerify(nextCookie);                        //make sure cookie is valid
         if (!bitTest(nextCookie->flags, MBF_AllocatedNext)) //if next block also free
@@ -1433,25 +1458,12 @@ void memFreeNV(memcookie *cookie, memcookie *nextCookie, mempool *pool)
 #if MEM_VERBOSE_LEVEL >= 3
             dbgMessagef("memFree: combined blocks 0x%x(%d) and 0x%x(%d) into one.", cookie, memBlocksToBytes(cookie->blocksNext), nextCookie, memBlocksToBytes(nextCookie->blocksNext));
 #endif
+            memFreeListRemove(pool, nextCookie);
                                                             //combine sizes
             stillNextCookie = nextCookie + nextCookie->blocksNext + 1;
             memCookieVerify(stillNextCookie);
             cookie->blocksNext += nextCookie->blocksNext + MEM_BlocksPerCookie;
             stillNextCookie->blocksPrevious = cookie->blocksNext;
-            //make sure that no min size pointers are referencing lost cookie
-            for (index = 0; index < MSB_NumberSizes + 1; index++)
-            {
-                if (pool->firstSize[index] == nextCookie)
-                {
-                    pool->firstSize[index] = cookie;
-                }
-                if (pool->lastSize[index] == nextCookie)
-                {
-                    pool->lastSize[index] = cookie + cookie->blocksNext + 1;
-                    memCookieVerify(pool->lastSize[index]);
-                }
-            }
-
 #if MEM_CLEAR_MEM                                           //clear lost cookie
             memClearDword(nextCookie, memFreeSetting, sizeof(memcookie) / sizeof(udword));
 #endif
@@ -1460,8 +1472,7 @@ void memFreeNV(memcookie *cookie, memcookie *nextCookie, mempool *pool)
     //attempt to combine with previous cookie if both free
     if (cookie->blocksPrevious != -1)
     {                                                       //if there is a previous block
-        previousCookie = (memcookie *)((ubyte *)cookie -    //get previous block
-                                sizeof(memcookie) - memBlocksToBytes(cookie->blocksPrevious));
+        previousCookie = cookie - cookie->blocksPrevious - 1;
         dbgAssertOrIgnore(previousCookie >= pool->first);
         memCookieVerify(previousCookie);
         if (!bitTest(previousCookie->flags, MBF_AllocatedNext)) //if previous block also free
@@ -1469,54 +1480,577 @@ void memFreeNV(memcookie *cookie, memcookie *nextCookie, mempool *pool)
 #if MEM_VERBOSE_LEVEL >= 3
             dbgMessagef("memFree: combined blocks 0x%x(%d) and 0x%x(%d) into one.", previousCookie, memBlocksToBytes(previousCookie->blocksNext), cookie, memBlocksToBytes(cookie->blocksNext));
 #endif
+            memFreeListRemove(pool, previousCookie);
                                                             //combine sizes
             nextCookie = cookie + cookie->blocksNext + 1;
             memCookieVerify(nextCookie);
             nextCookie->blocksPrevious += cookie->blocksPrevious + 1;
             previousCookie->blocksNext = nextCookie->blocksPrevious;
-
 #if MEM_CLEAR_MEM                                           //clear lost cookie
             memClearDword(cookie, memFreeSetting, sizeof(memcookie) / sizeof(udword));
 #endif
-            //make sure that no pointers are referencing lost cookie
-            for (index = 0; index < MSB_NumberSizes + 1; index++)
-            {                                               //check all the min size pointers
-                if (pool->firstSize[index] == cookie)
-                {
-                    pool->firstSize[index] = previousCookie;
-                }
-                if (pool->lastSize[index] == cookie)
-                {
-                    pool->lastSize[index] = previousCookie + previousCookie->blocksNext + 1;
-                    memCookieVerify(pool->lastSize[index]);
-                }
-            }
-            if (pool->lastFree == cookie)
-            {                                               //check the last free pointer
-                pool->lastFree = nextCookie;
-            }
-            cookie = previousCookie;                        //make sure that the later resizing will work
+            cookie = previousCookie;
+        }
+    }
+    memFreeListInsert(pool, cookie);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameChunkFind
+    Description : Finds the frame arena chunk a pointer is in
+    Inputs      : pointer - pointer to look for
+    Outputs     :
+    Return      : chunk the pointer is in, or NULL if it's not in the arena
+----------------------------------------------------------------------------*/
+static memframechunk *memFrameChunkFind(void *pointer)
+{
+    memframechunk *chunk;
+
+    for (chunk = memFrameChunk; chunk != NULL; chunk = chunk->older)
+    {
+        if ((ubyte *)pointer > chunk->start && (ubyte *)pointer < chunk->end)
+        {
+            return(chunk);
+        }
+    }
+    return(NULL);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameOwns
+    Description : Tells if a pointer came from the frame arena
+    Inputs      : pointer - pointer to check
+    Outputs     :
+    Return      : TRUE if it's a frame block
+----------------------------------------------------------------------------*/
+bool memFrameOwns(void *pointer)
+{
+    return(memFrameChunkFind(pointer) != NULL);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameChunkRelease
+    Description : Frees a frame arena chunk, or keeps it as the spare if it's
+                    the biggest one seen so overflowing the same amount next
+                    frame doesn't have to go back to the system.
+    Inputs      : chunk - chunk to release
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void memFrameChunkRelease(memframechunk *chunk)
+{
+    if (memFrameSpare != NULL && memFrameSpare->end - memFrameSpare->start >= chunk->end - chunk->start)
+    {
+        free(chunk);
+        return;
+    }
+    if (memFrameSpare != NULL)
+    {
+        free(memFrameSpare);
+    }
+    memFrameSpare = chunk;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameBlockRelease
+    Description : Debug check of a frame block going back to the arena: makes
+                    sure nothing ran off the end of it and poisons it so
+                    anything still pointing at it will find garbage.
+    Inputs      : cookie - cookie of block being released
+                  reclaimed - TRUE if the cookie itself is going away too
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+#if MEM_ERROR_CHECKING
+static void memFrameBlockRelease(memframecookie *cookie, bool reclaimed)
+{
+    ubyte *data = (ubyte *)cookie + memFrameCookieSize;
+
+    memFrameCookieVerify(cookie);
+    if (!bitTest(cookie->flags, MFF_Freed))
+    {
+        if (memcmp(data + cookie->length, &memFrameGuardValue, sizeof(udword)) != 0)
+        {
+            dbgFatalf(DBG_Loc, "Frame block '%s' overrun", cookie->name);
+        }
+        memClearDword(data, memFreeSetting, memFrameRoundUp(cookie->length + sizeof(udword)) / sizeof(udword));
+    }
+    if (reclaimed)
+    {
+        memClearDword(cookie, memFreeSetting, memFrameCookieSize / sizeof(udword));
+    }
+}
+#else
+#define memFrameBlockRelease(c, r)
+#endif
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameAllocFunction
+    Description : Allocates a block off the top of the frame arena
+    Inputs      : length - length of block
+                  name - name of block (debug only)
+    Outputs     : grabs a new chunk if the current one is full
+    Return      : pointer to the block, aligned to MEM_FrameAlignment
+----------------------------------------------------------------------------*/
+#if MEM_USE_NAMES
+void *memFrameAllocFunction(sdword length, char *name)
+#else
+void *memFrameAllocFunction(sdword length)
+#endif
+{
+    memframechunk *chunk = memFrameChunk;
+    memframecookie *cookie;
+    sdword size;
+
+    memInitCheck();
+    dbgAssertOrIgnore(length >= 0);
+    size = memFrameBlockSize(length);
+
+    if (chunk == NULL || chunk->end - chunk->top < size)
+    {                                                       //if it won't fit in the current chunk
+        if (memFrameSpare != NULL && memFrameSpare->end - memFrameSpare->start >= size)
+        {                                                   //use the spare if it's big enough
+            chunk = memFrameSpare;
+            memFrameSpare = NULL;
         }
         else
-        {                                                   //else prev cookie in use
-            length = cookie->blocksNext * MEM_BlockSize;
-            if (length <= MSB_SizeMax && mslSizeBytes(length) < cookie + cookie->blocksNext + 1)
-            {                                               //set the new size block max
-                mslSizeBytes(length) = cookie + cookie->blocksNext + 1;
+        {                                                   //else get a new one from the system
+            sdword chunkSize = max(MEM_FrameChunkSize, size);
+
+            chunk = malloc(sizeof(memframechunk) + MEM_FrameAlignment + chunkSize);
+            if (chunk == NULL)
+            {
+                dbgFatalf(DBG_Loc, "Couldn't allocate %d bytes for the frame arena", chunkSize);
             }
+            chunk->start = (ubyte *)memFrameRoundUp((size_t)(chunk + 1));
+            chunk->end = chunk->start + chunkSize;
         }
+        chunk->top = chunk->start;
+        chunk->last = NULL;
+        chunk->older = memFrameChunk;
+        memFrameChunk = chunk;
     }
-    if (pool->lastFree <= cookie)
+
+    cookie = (memframecookie *)chunk->top;
+    cookie->previous = chunk->last;
+    cookie->length = length;
+    cookie->flags = MBF_VerifyValue;
+#if MEM_USE_NAMES
+    memStrncpy(cookie->name, name, MEM_FrameNameLength);
+#endif
+    chunk->last = cookie;
+    chunk->top += size;
+
+#if MEM_CLEAR_MEM
+    memClearDword((ubyte *)cookie + memFrameCookieSize, memClearSetting, memFrameRoundUp(length) / sizeof(udword));
+#endif
+#if MEM_ERROR_CHECKING
+    memcpy((ubyte *)cookie + memFrameCookieSize + length, &memFrameGuardValue, sizeof(udword));
+#endif
+    return((ubyte *)cookie + memFrameCookieSize);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameFreeInChunk
+    Description : Frees a frame block, reclaiming it and any freed blocks
+                    under it if it's on the top of its chunk.
+    Inputs      : pointer - block to free
+                  chunk - chunk the block is in
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void memFrameFreeInChunk(void *pointer, memframechunk *chunk)
+{
+    memframecookie *cookie = (memframecookie *)((ubyte *)pointer - memFrameCookieSize);
+
+    memFrameCookieVerify(cookie);
+#if MEM_ERROR_CHECKING
+    if (bitTest(cookie->flags, MFF_Freed))
     {
-        pool->lastFree = (memcookie *)((ubyte *)cookie + sizeof(memcookie) + memBlocksToBytes(cookie->blocksNext));
-        dbgAssertOrIgnore(pool->lastFree > pool->firstFree && pool->lastFree <= pool->last);
-        memCookieVerify(pool->lastFree);
+        dbgFatalf(DBG_Loc, "Frame block '%s' freed twice", cookie->name);
+    }
+#endif
+    memFrameBlockRelease(cookie, FALSE);
+    bitSet(cookie->flags, MFF_Freed);
+
+    while (chunk->last != NULL && bitTest(chunk->last->flags, MFF_Freed))
+    {                                                       //pop freed blocks off the top
+        cookie = chunk->last;
+        chunk->top = (ubyte *)cookie;
+        chunk->last = cookie->previous;
+        memFrameBlockRelease(cookie, TRUE);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameFree
+    Description : Frees a block allocated with memFrameAlloc.  The space is
+                    reclaimed once everything allocated after it is freed too,
+                    or at the next memFrameReset.  memFree also works.
+    Inputs      : pointer - block to free
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void memFrameFree(void *pointer)
+{
+    memframechunk *chunk = memFrameChunkFind(pointer);
+
+    dbgAssertOrIgnore(chunk != NULL);
+    memFrameFreeInChunk(pointer, chunk);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameMark
+    Description : Gets the current top of the frame arena
+    Inputs      :
+    Outputs     :
+    Return      : mark to pass to memFrameReset
+----------------------------------------------------------------------------*/
+memframemark memFrameMark(void)
+{
+    memframemark mark;
+
+    mark.chunk = memFrameChunk;
+    mark.top = memFrameChunk != NULL ? memFrameChunk->top : NULL;
+    return(mark);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameReset
+    Description : Releases everything allocated in the frame arena since a
+                    mark was taken, freed or not.
+    Inputs      : mark - mark from memFrameMark
+    Outputs     : frees or keeps as spare any chunks added since the mark
+    Return      :
+----------------------------------------------------------------------------*/
+void memFrameReset(memframemark *mark)
+{
+    memframechunk *chunk;
+    memframecookie *cookie;
+
+    while (memFrameChunk != mark->chunk)
+    {                                                       //release all chunks newer than the mark
+        dbgAssertOrIgnore(memFrameChunk != NULL);
+        chunk = memFrameChunk;
+#if MEM_ERROR_CHECKING
+        while (chunk->last != NULL)
+        {
+            cookie = chunk->last;
+            chunk->last = cookie->previous;
+            memFrameBlockRelease(cookie, TRUE);
+        }
+#endif
+        memFrameChunk = chunk->older;
+        memFrameChunkRelease(chunk);
+    }
+
+    chunk = memFrameChunk;
+    if (chunk != NULL && chunk->top > mark->top)
+    {                                                       //release the blocks above the mark
+        while (chunk->last != NULL && (ubyte *)chunk->last >= mark->top)
+        {
+            cookie = chunk->last;
+            chunk->last = cookie->previous;
+            memFrameBlockRelease(cookie, TRUE);
+        }
+        chunk->top = chunk->last != NULL ? (ubyte *)chunk->last + memFrameBlockSize(chunk->last->length) : chunk->start;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memFrameClose
+    Description : Frees all the frame arena's chunks
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void memFrameClose(void)
+{
+    memframechunk *chunk;
+
+    while (memFrameChunk != NULL)
+    {
+        chunk = memFrameChunk;
+        memFrameChunk = chunk->older;
+        free(chunk);
+    }
+    if (memFrameSpare != NULL)
+    {
+        free(memFrameSpare);
+        memFrameSpare = NULL;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjSlabFind
+    Description : Finds the object pool slab a pointer is in
+    Inputs      : pointer - pointer to look for
+    Outputs     :
+    Return      : slab the pointer is in, or NULL if it's not in any pool
+----------------------------------------------------------------------------*/
+static memobjslab *memObjSlabFind(void *pointer)
+{
+    sdword low = 0, high = memObjNumberSlabs - 1, middle;
+    memobjslab *slab;
+
+    while (low <= high)
+    {                                                       //binary search on the slab addresses
+        middle = (low + high) / 2;
+        slab = memObjSlabs[middle];
+        if ((ubyte *)pointer < slab->start)
+        {
+            high = middle - 1;
+        }
+        else if ((ubyte *)pointer >= slab->end)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            return(slab);
+        }
+    }
+    return(NULL);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjOwns
+    Description : Tells if a pointer came from an object pool
+    Inputs      : pointer - pointer to check
+    Outputs     :
+    Return      : TRUE if it's a pool object
+----------------------------------------------------------------------------*/
+bool memObjOwns(void *pointer)
+{
+    return(memObjSlabFind(pointer) != NULL);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjSlabCreate
+    Description : Adds a new slab to the end of a pool
+    Inputs      : pool - pool to grow
+    Outputs     : adds the slab to the pool and the sorted slab list
+    Return      : the new slab, all free
+----------------------------------------------------------------------------*/
+static memobjslab *memObjSlabCreate(memobjpool *pool)
+{
+    memobjslab *slab;
+    sdword index, slabLength;
+
+    if (pool->slotLength == 0)
+    {                                                       //first use of the pool
+        dbgAssertOrIgnore(pool->objectLength > 0);
+        pool->slotLength = (pool->objectLength + (MEM_ObjAlignment - 1)) & (~(MEM_ObjAlignment - 1));
+    }
+    dbgAssertOrIgnore((pool->nSlabs + 1) * MEM_ObjSlabSlots <= MEM_ObjHandleIndexMask);
+
+    slabLength = pool->slotLength * MEM_ObjSlabSlots;
+    slab = malloc(sizeof(memobjslab) + MEM_ObjAlignment + slabLength);
+    pool->slabs = realloc(pool->slabs, sizeof(memobjslab *) * (pool->nSlabs + 1));
+    memObjSlabs = realloc(memObjSlabs, sizeof(memobjslab *) * (memObjNumberSlabs + 1));
+    if (slab == NULL || pool->slabs == NULL || memObjSlabs == NULL)
+    {
+        dbgFatalf(DBG_Loc, "Couldn't allocate a slab of %d bytes for the '%s' pool", slabLength, pool->name);
+    }
+    slab->pool = pool;
+    slab->start = (ubyte *)(((size_t)(slab + 1) + (MEM_ObjAlignment - 1)) & (~(size_t)(MEM_ObjAlignment - 1)));
+    slab->end = slab->start + slabLength;
+    slab->index = pool->nSlabs;
+    slab->nFree = MEM_ObjSlabSlots;
+    for (index = 0; index < MEM_ObjSlabWords; index++)
+    {
+        slab->freeBits[index] = 0xffffffff;
+    }
+    for (index = 0; index < MEM_ObjSlabSlots; index++)
+    {
+        slab->generation[index] = 1;
+    }
+#if MEM_CLEAR_MEM_ON_FREE
+    memClearDword(slab->start, memFreeSetting, slabLength / sizeof(udword));
+#endif
+
+    pool->slabs[pool->nSlabs] = slab;
+    pool->nSlabs++;
+
+    for (index = memObjNumberSlabs; index > 0 && memObjSlabs[index - 1]->start > slab->start; index--)
+    {                                                       //insert in address order
+        memObjSlabs[index] = memObjSlabs[index - 1];
+    }
+    memObjSlabs[index] = slab;
+    memObjNumberSlabs++;
+
+    return(slab);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjAlloc
+    Description : Allocates an object from a typed object pool.  It goes in
+                    the lowest free slot, growing the pool by a slab if it's
+                    full.
+    Inputs      : pool - pool to allocate from
+    Outputs     : Newly allocated object may be cleared.
+    Return      : pointer to the object, aligned to MEM_ObjAlignment
+----------------------------------------------------------------------------*/
+void *memObjAlloc(memobjpool *pool)
+{
+    memobjslab *slab = NULL;
+    sdword index, word, slot;
+    ubyte *pointer;
+
+    memInitCheck();
+
+    for (index = pool->firstFreeSlab; index < pool->nSlabs; index++)
+    {                                                       //find the first slab with room
+        if (pool->slabs[index]->nFree != 0)
+        {
+            slab = pool->slabs[index];
+            break;
+        }
+    }
+    if (slab == NULL)
+    {
+        slab = memObjSlabCreate(pool);
+    }
+    pool->firstFreeSlab = slab->index;
+
+    for (word = 0; slab->freeBits[word] == 0; word++)
+    {
+        dbgAssertOrIgnore(word < MEM_ObjSlabWords - 1);
+    }
+    slot = word * 32 + memBitLowest(slab->freeBits[word]);
+    bitClear(slab->freeBits[word], memObjSlotBit(slot));
+    slab->nFree--;
+
+    pool->nLive++;
+    pool->nLivePeak = max(pool->nLivePeak, pool->nLive);
+    pool->nAllocs++;
+
+    pointer = slab->start + slot * pool->slotLength;
+#if MEM_CLEAR_MEM
+    memClearDword(pointer, memClearSetting, pool->slotLength / sizeof(udword));
+#endif
+    return(pointer);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjFreeInSlab
+    Description : Returns an object to its slab and bumps the slot's
+                    generation so any handles to it stop working.
+    Inputs      : pointer - object to free
+                  slab - slab it's in
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void memObjFreeInSlab(void *pointer, memobjslab *slab)
+{
+    memobjpool *pool = slab->pool;
+    sdword slot = ((ubyte *)pointer - slab->start) / pool->slotLength;
+
+#if MEM_ERROR_CHECKING
+    if (slab->start + slot * pool->slotLength != (ubyte *)pointer)
+    {
+        dbgFatalf(DBG_Loc, "0x%x is not the start of a '%s' object", pointer, pool->name);
+    }
+    if (bitTest(slab->freeBits[memObjSlotWord(slot)], memObjSlotBit(slot)))
+    {
+        dbgFatalf(DBG_Loc, "'%s' object 0x%x freed twice", pool->name, pointer);
     }
-#if MEM_ANAL_CHECKING
-    memPoolAnalCheck(pool);
+#endif
+    bitSet(slab->freeBits[memObjSlotWord(slot)], memObjSlotBit(slot));
+    slab->nFree++;
+    slab->generation[slot] = (slab->generation[slot] + 1) & MEM_ObjGenerationMask;
+    if (slab->generation[slot] == 0)
+    {                                                       //0 is for null handles
+        slab->generation[slot] = 1;
+    }
+
+    pool->nLive--;
+    pool->firstFreeSlab = min(pool->firstFreeSlab, slab->index);
+#if MEM_CLEAR_MEM_ON_FREE
+    memClearDword(pointer, memFreeSetting, pool->slotLength / sizeof(udword));
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : memObjHandle
+    Description : Makes a handle to a pool object
+    Inputs      : pointer - live object from an object pool
+    Outputs     :
+    Return      : handle that memObjFromHandle turns back into the pointer
+                    for as long as the object is allocated
+----------------------------------------------------------------------------*/
+memobjhandle memObjHandle(void *pointer)
+{
+    memobjslab *slab = memObjSlabFind(pointer);
+    sdword slot;
+
+    dbgAssertOrIgnore(slab != NULL);
+    slot = ((ubyte *)pointer - slab->start) / slab->pool->slotLength;
+    dbgAssertOrIgnore(!bitTest(slab->freeBits[memObjSlotWord(slot)], memObjSlotBit(slot)));
+    return(((udword)slab->generation[slot] << MEM_ObjHandleIndexBits) | (slab->index * MEM_ObjSlabSlots + slot));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjFromHandle
+    Description : Gets the object a handle refers to
+    Inputs      : pool - pool the object was allocated from
+                  handle - from memObjHandle
+    Outputs     :
+    Return      : the object, or NULL if it has been freed since the handle
+                    was made
+----------------------------------------------------------------------------*/
+void *memObjFromHandle(memobjpool *pool, memobjhandle handle)
+{
+    sdword index = handle & MEM_ObjHandleIndexMask;
+    sdword slot = index % MEM_ObjSlabSlots;
+    memobjslab *slab;
+
+    if (handle == MEM_ObjHandleNull || index / MEM_ObjSlabSlots >= pool->nSlabs)
+    {
+        return(NULL);
+    }
+    slab = pool->slabs[index / MEM_ObjSlabSlots];
+    if (bitTest(slab->freeBits[memObjSlotWord(slot)], memObjSlotBit(slot)) ||
+        slab->generation[slot] != (handle >> MEM_ObjHandleIndexBits))
+    {
+        return(NULL);
+    }
+    return(slab->start + slot * pool->slotLength);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memObjClose
+    Description : Frees the slabs of all the object pools
+    Inputs      :
+    Outputs     : empties all pools
+    Return      :
+----------------------------------------------------------------------------*/
+void memObjClose(void)
+{
+    sdword index;
+    memobjpool *pool;
+
+    for (index = 0; index < memObjNumberSlabs; index++)
+    {
+        pool = memObjSlabs[index]->pool;
+        if (pool->slabs != NULL)
+        {
+            free(pool->slabs);
+            pool->slabs = NULL;
+            pool->nSlabs = 0;
+            pool->firstFreeSlab = 0;
+            pool->nLive = 0;
+        }
+        free(memObjSlabs[index]);
+    }
+    if (memObjSlabs != NULL)
+    {
+        free(memObjSlabs);
+        memObjSlabs = NULL;
+    }
+    memObjNumberSlabs = 0;
+}
+
 /*-----------------------------------------------------------------------------
     Name        : memFree
     Description : Frees a block of memory
@@ -1526,13 +2060,33 @@ void memFreeNV(memcookie *cookie, memcookie *nextCookie, mempool *pool)
 ----------------------------------------------------------------------------*/
 void memFree(void *pointer)
 {
-    memcookie *cookie, *nextCookie, *previousCookie;
-    memcookie *stillNextCookie;
-    udword length, index;
+    memcookie *cookie;
+    udword index;
     mempool *pool = &memMainPool;                            //what pool does this cookie belong to?
 
     memInitCheck();
     dbgAssertOrIgnore(pointer != NULL);
+
+    if ((pointer < (void *)memMainPool.pool || pointer > (void *)memMainPool.last) && memFrameChunk != NULL)
+    {                                                       //it might be from the frame arena
+        memframechunk *chunk = memFrameChunkFind(pointer);
+        if (chunk != NULL)
+        {
+            memFrameFreeInChunk(pointer, chunk);
+            return;
+        }
+    }
+
+    if ((pointer < (void *)memMainPool.pool || pointer > (void *)memMainPool.last) && memObjNumberSlabs != 0)
+    {                                                       //it might be from an object pool
+        memobjslab *slab = memObjSlabFind(pointer);
+        if (slab != NULL)
+        {
+            memObjFreeInSlab(pointer, slab);
+            return;
+        }
+    }
+
     cookie = (memcookie *)pointer;
     cookie--;                                               //get pointer to cookie structure
 
@@ -1613,108 +2167,14 @@ foundPool:;
     dbgMessagef("memFree: freed %d bytes of '%s' from 0x%x", memBlocksToBytes(cookie->blocksNext), cookie->name, cookie);
 #endif
 
-    bitClear(cookie->flags, MBF_AllocatedNext);             //say it's not active
-    memNameSet(cookie, MEM_HeapFree);                       //clear name of cookie
-    //clear actual memory block
-#if MEM_CLEAR_MEM_ON_FREE
-    memClearDword(pointer, memFreeSetting, memBlocksToBytes(cookie->blocksNext) / 4);
-#endif
-
-    nextCookie = (memcookie *)((ubyte *)cookie +            //next cookie
-                            sizeof(memcookie) + memBlocksToBytes(cookie->blocksNext));
-    if (bitTest(cookie->flags, MBF_NonVolatile))
-    {                                                       //if allocated non-volatile
-        memFreeNV(cookie, nextCookie, pool);
-#if MEM_ANAL_CHECKING
-        memPoolAnalCheck(pool);
-#endif
-        return;
-    }
-
-    if (nextCookie < pool->last)                               //if not end of heap
+#if MEM_TRACE
+    if (memTraceFile != NULL)
     {
-        memCookieVerify(nextCookie);                        //make sure cookie is valid
-        if (!bitTest(nextCookie->flags, MBF_AllocatedNext)) //if next block also free
-        {
-#if MEM_VERBOSE_LEVEL >= 3
-            dbgMessagef("memFree: combined blocks 0x%x(%d) and 0x%x(%d) into one.", cookie, memBlocksToBytes(cookie->blocksNext), nextCookie, memBlocksToBytes(nextCookie->blocksNext));
-#endif
-                                                            //combine sizes
-            stillNextCookie = nextCookie + nextCookie->blocksNext + 1;
-            memCookieVerify(stillNextCookie);
-            cookie->blocksNext += nextCookie->blocksNext + MEM_BlocksPerCookie;
-            stillNextCookie->blocksPrevious = cookie->blocksNext;
-            //make sure that no min size pointers are referencing lost cookie
-            for (index = 0; index < MSB_NumberSizes + 1; index++)
-            {
-                if (pool->firstSize[index] == nextCookie)
-                {
-                    pool->firstSize[index] = cookie;
-                }
-                if (pool->lastSize[index] == nextCookie)
-                {
-                    pool->lastSize[index] = stillNextCookie;
-                }
-            }
-
-#if MEM_CLEAR_MEM                                           //clear lost cookie
-            memClearDword(nextCookie, memFreeSetting, sizeof(memcookie) / sizeof(udword));
-#endif
-        }
+        fprintf(memTraceFile, "f %p\n", (void *)pointer);
     }
-    //attempt to combine with previous cookie if both free
-    if (cookie->blocksPrevious != -1)
-    {                                                       //if there is a previous block
-        previousCookie = (memcookie *)((ubyte *)cookie -    //get previous block
-                                sizeof(memcookie) - memBlocksToBytes(cookie->blocksPrevious));
-        dbgAssertOrIgnore(previousCookie >= pool->first);
-        memCookieVerify(previousCookie);
-        if (!bitTest(previousCookie->flags, MBF_AllocatedNext)) //if previous block also free
-        {
-#if MEM_VERBOSE_LEVEL >= 3
-            dbgMessagef("memFree: combined blocks 0x%x(%d) and 0x%x(%d) into one.", previousCookie, memBlocksToBytes(previousCookie->blocksNext), cookie, memBlocksToBytes(cookie->blocksNext));
 #endif
-                                                            //combine sizes
-            nextCookie = cookie + cookie->blocksNext + 1;
-            memCookieVerify(nextCookie);
-            nextCookie->blocksPrevious += cookie->blocksPrevious + 1;
-            previousCookie->blocksNext = nextCookie->blocksPrevious;
 
-#if MEM_CLEAR_MEM                                           //clear lost cookie
-            memClearDword(cookie, memFreeSetting, sizeof(memcookie) / sizeof(udword));
-#endif
-            //make sure that no pointers are referencing lost cookie
-            for (index = 0; index < MSB_NumberSizes + 1; index++)
-            {                                               //check all the min size pointers
-                if (pool->firstSize[index] == cookie)
-                {
-                    pool->firstSize[index] = previousCookie;
-                }
-                if (pool->lastSize[index] == cookie)
-                {
-                    pool->lastSize[index] = nextCookie;
-                }
-            }
-            if (pool->lastFree == cookie)
-            {                                               //check the last free pointer
-                pool->lastFree = nextCookie;
-            }
-            cookie = previousCookie;                        //make sure that the later resizing will work
-        }
-        else
-        {
-            length = cookie->blocksNext * MEM_BlockSize;
-            if (length <= MSB_SizeMax && msbSizeBytes(length) > cookie)
-            {                                               //set the new size block min
-                msbSizeBytes(length) = cookie;
-            }
-        }
-    }
-    if (pool->firstFree > cookie)                              //make sure first free is the actual first free
-    {
-        pool->firstFree = cookie;
-    }
-    dbgAssertOrIgnore(pool->lastFree > pool->firstFree && pool->lastFree <= pool->last);
+    memFreeCookie(cookie, pool);
 #if MEM_ANAL_CHECKING
     memPoolAnalCheck(pool);
 #endif
@@ -2063,10 +2523,19 @@ void memAnalysisCreateForPool(mempool *pool, FILE *fpAnalysis, FILE *fpMap)
         }
     }
 #endif //MEM_SMALL_BLOCK_HEAP
-    //print values of the small block pointers
-    for (index = 0; index < MSB_NumberSizes + 1; index++)
+    //print the heads and lengths of the non-empty free lists
+    for (index = 0; index < MEM_FLCount * MEM_SLCount; index++)
     {
-        fprintf(fpAnalysis, "lowestFree 0x%x = 0x%lx\n", ((index) * MEM_BlockSize) + MEM_BlockSize, (size_t)pool->firstSize[index]);
+        thisCookie = pool->freeList[index / MEM_SLCount][index % MEM_SLCount];
+        if (thisCookie == NULL)
+        {
+            continue;
+        }
+        for (block = 0, nextCookie = thisCookie; nextCookie != NULL; block++)
+        {
+            nextCookie = memFreeLink(nextCookie)->next;
+        }
+        fprintf(fpAnalysis, "freeList %d.%d = %p, %d free blocks\n", index / MEM_SLCount, index % MEM_SLCount, (void *)thisCookie, block);
     }
     thisCookie = pool->first;                                  //start walk from very start of heap
 
@@ -2190,6 +2659,231 @@ void memAnalysisCreate(void)
 }
 #endif //MEM_ANALYSIS
 
+/*-----------------------------------------------------------------------------
+    Alloc/free trace benchmark
+-----------------------------------------------------------------------------*/
+#define MTB_HashBits            16
+#define MTB_HashSize            (1 << MTB_HashBits)
+#define MTB_Hash(a)             ((udword)(((a) >> 5) ^ ((a) >> (5 + MTB_HashBits))) & (MTB_HashSize - 1))
+
+//one event of an alloc/free trace
+typedef struct
+{
+    sdword length;                              //length of allocation, -1 for a free
+    udword flags;                               //allocation flags
+    sdword index;                               //event index of alloc this free releases
+}
+memtraceevent;
+
+/*-----------------------------------------------------------------------------
+    Name        : memTraceLoad
+    Description : Loads an alloc/free trace and pairs every free with the
+                    allocation it releases.  Frees of addresses that were
+                    never seen allocated are dropped.
+    Inputs      : fp - trace file
+    Outputs     : nEvents - number of events loaded
+                  peakLength - peak bytes allocated, including cookies
+    Return      : newly malloc'd event list or NULL on failure
+----------------------------------------------------------------------------*/
+static memtraceevent *memTraceLoad(FILE *fp, sdword *nEvents, sdword *peakLength)
+{
+    memtraceevent *events = NULL, *newEvents;
+    memsize *address = NULL, *newAddress;
+    sdword *hashNext = NULL, *newHashNext;
+    sdword *hashHead;
+    sdword nAllocated = 0, count = 0, liveLength = 0, index, *link;
+    void *pointer;
+    sdword length;
+    udword flags;
+    char type;
+
+    *peakLength = 0;
+    hashHead = malloc(sizeof(sdword) * MTB_HashSize);
+    if (hashHead == NULL)
+    {
+        return(NULL);
+    }
+    memset(hashHead, 0xff, sizeof(sdword) * MTB_HashSize);
+
+    while (fscanf(fp, " %c %p", &type, &pointer) == 2)
+    {
+        if (count == nAllocated)
+        {                                                   //grow the event lists
+            nAllocated = max(nAllocated * 2, 4096);
+            newEvents = realloc(events, sizeof(memtraceevent) * nAllocated);
+            newAddress = realloc(address, sizeof(memsize) * nAllocated);
+            newHashNext = realloc(hashNext, sizeof(sdword) * nAllocated);
+            if (newEvents != NULL)
+            {
+                events = newEvents;
+            }
+            if (newAddress != NULL)
+            {
+                address = newAddress;
+            }
+            if (newHashNext != NULL)
+            {
+                hashNext = newHashNext;
+            }
+            if (newEvents == NULL || newAddress == NULL || newHashNext == NULL)
+            {
+                free(events);
+                events = NULL;
+                break;
+            }
+        }
+        if (type == 'a')
+        {
+            if (fscanf(fp, "%d %x", &length, &flags) != 2)
+            {
+                break;
+            }
+            events[count].length = length;
+            events[count].flags = flags;
+            events[count].index = -1;
+            address[count] = (memsize)pointer;
+            hashNext[count] = hashHead[MTB_Hash(address[count])];
+            hashHead[MTB_Hash(address[count])] = count;
+            liveLength += length + sizeof(memcookie);
+            *peakLength = max(*peakLength, liveLength);
+            count++;
+        }
+        else if (type == 'f')
+        {
+            for (link = &hashHead[MTB_Hash((memsize)pointer)]; *link != -1; link = &hashNext[*link])
+            {
+                if (address[*link] == (memsize)pointer)
+                {
+                    break;
+                }
+            }
+            if (*link == -1)
+            {                                               //don't know about this block
+                continue;
+            }
+            index = *link;
+            *link = hashNext[index];                        //this address may be reused by a later alloc
+            events[count].length = -1;
+            events[count].flags = 0;
+            events[count].index = index;
+            liveLength -= events[index].length + sizeof(memcookie);
+            count++;
+        }
+    }
+    free(hashHead);
+    free(address);
+    free(hashNext);
+    *nEvents = count;
+    return(events);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : memTraceBench
+    Description : Replays an alloc/free trace recorded with /memTrace through
+                    the regular heap allocator in a scratch pool and reports
+                    how long it took.  Small block heap requests are sent to
+                    the regular heap, as are allocations that originally went
+                    to a growth heap.
+    Inputs      : fileName - name of the trace file
+    Outputs     : prints the results to stdout
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword memTraceBench(char *fileName)
+{
+    FILE *fp;
+    memtraceevent *events;
+    void **pointers;
+    void *heap;
+    mempool benchPool;
+    sdword nEvents, peakLength, heapLength, index;
+    sdword nAllocs = 0, nFrees = 0, nFailures = 0;
+    sqword timeStart, timeStop;
+    real64 milliseconds;
+#if MEM_STATISTICS
+    sdword oldWalks = memNumberWalks, oldAllocs = memNumberAllocs;
+#endif
+#if MEM_TRACE
+    FILE *oldTraceFile = memTraceFile;
+#endif
+
+    fp = fopen(fileName, "rt");
+    if (fp == NULL)
+    {
+        printf("memTraceBench: can't open '%s'\n", fileName);
+        return(-1);
+    }
+    events = memTraceLoad(fp, &nEvents, &peakLength);
+    fclose(fp);
+    if (events == NULL)
+    {
+        printf("memTraceBench: can't load '%s'\n", fileName);
+        return(-1);
+    }
+
+    //enough room for the peak usage plus plenty of fragmentation
+    heapLength = max(memMainPool.heapLength, peakLength * 2);
+    heap = malloc(heapLength);
+    pointers = malloc(sizeof(void *) * max(nEvents, 1));
+    if (heap == NULL || pointers == NULL)
+    {
+        printf("memTraceBench: can't allocate a %d byte scratch heap\n", heapLength);
+        free(heap);
+        free(pointers);
+        free(events);
+        return(-1);
+    }
+    memPoolReset(&benchPool, heap, heapLength, FALSE);
+#if MEM_TRACE
+    memTraceFile = NULL;                                    //don't trace the replay
+#endif
+#if MEM_STATISTICS
+    memNumberWalks = memNumberAllocs = 0;
+#endif
+
+    GetRawTime(&timeStart);
+    for (index = 0; index < nEvents; index++)
+    {
+        if (events[index].length >= 0)
+        {
+#if MEM_USE_NAMES
+            pointers[index] = memAllocFunctionA(events[index].length, MEM_TraceBenchName, events[index].flags & ~MBF_SmallBlockHeap, &benchPool);
+#else
+            pointers[index] = memAllocFunctionA(events[index].length, events[index].flags & ~MBF_SmallBlockHeap, &benchPool);
+#endif
+            nAllocs++;
+            if (pointers[index] == NULL)
+            {
+                nFailures++;
+            }
+        }
+        else if (pointers[events[index].index] != NULL)
+        {
+            memFreeCookie((memcookie *)pointers[events[index].index] - 1, &benchPool);
+            nFrees++;
+        }
+    }
+    GetRawTime(&timeStop);
+
+    milliseconds = (real64)(timeStop - timeStart) / 1000.0;
+    printf("memTraceBench: %s\n", fileName);
+    printf("  %d events: %d allocs (%d failed), %d frees, peak %d bytes in a %d byte heap\n",
+           nEvents, nAllocs, nFailures, nFrees, peakLength, heapLength);
+    printf("  %.3f ms, %.1f ns/op\n", milliseconds, (nAllocs + nFrees) ? milliseconds * 1000000.0 / (nAllocs + nFrees) : 0.0);
+#if MEM_STATISTICS
+    printf("  %.2f walks/alloc\n", memNumberAllocs ? (real64)memNumberWalks / (real64)memNumberAllocs : 0.0);
+    memNumberWalks = oldWalks;
+    memNumberAllocs = oldAllocs;
+#endif
+#if MEM_TRACE
+    memTraceFile = oldTraceFile;
+#endif
+
+    free(heap);
+    free(pointers);
+    free(events);
+    return(nFailures == 0 ? 0 : -1);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : memStrncpy
     Description : Line strncpy, but it copies the NULL terminator will always be appended.
@@ -36,6 +36,7 @@
 #define MEM_ANALYSIS_AUTOCREATE 1               //automatically create memory analysis if there's an allocation failure
 #define MEM_VOLATILE_CLEARING   1               //the clear dwords are volatile and unreliable
 #define MEM_ANAL_CHECKING       1               //extra hard-core debuggery action
+#define MEM_TRACE               1               //allow logging all allocs and frees to a trace file
 
 #else
 
@@ -56,6 +57,7 @@
 #define MEM_LOG_MOSTVOLATILE    0               //keep track of the most volatile types of memory
 #define MEM_ANALYSIS_AUTOCREATE 0               //automatically create memory analysis if there's an allocation failure
 #define MEM_ANAL_CHECKING       0               //extra hard-core debuggery action
+#define MEM_TRACE               0               //allow logging all allocs and frees to a trace file
 
 #endif
 
@@ -130,11 +132,15 @@
 #define MEM_AllocsPerStatPrint  100
 #define MEM_StatsKey            QKEY
 
-//small block allocation defines
-//the smallest small allocation block must be smaller than the smallest allocation
-#define MSB_SizeMin             MEM_BlockSize
-#define MSB_SizeMax             2048
-#define MSB_NumberSizes         ((MSB_SizeMax - MSB_SizeMin) / MEM_BlockSize)
+//alloc/free trace
+#define MEM_TraceFileName       "memtrace.txt"
+#define MEM_TraceBenchName      "memTraceBench"
+
+//segregated free lists.  Free blocks are binned first by the power of two of
+//their length in blocks, then linearly into MEM_SLCount lists within that
+#define MEM_SLLog               4
+#define MEM_SLCount             (1 << MEM_SLLog)
+#define MEM_FLCount             28              //enough for any positive sdword number of blocks
 #define MEM_OptCounterFreqSmall 2048
 #define MEM_OptCounterFreqBig   8192
 #define MEM_GrowFactor          96 / 256        //grow by 37.5% when a SBH pool runs out
@@ -163,6 +169,22 @@
 #define MGH_NumberGrowthHeaps   16              //maximum number of extra heaps we can grow to
 #define MGH_MinGrowthSize       (4 * 1024 * 1024 - sizeof(memcookie) * 2)//grow in 4MB increments.  That's 64MB extra heap size.  Should be sufficient.
 
+//definitions for the per-frame arena
+#define MEM_FrameChunkSize      (256 * 1024)    //frame arena is allocated in chunks of at least this size
+#define MEM_FrameAlignment      16              //frame blocks are aligned to this
+#define MEM_FrameNameLength     16              //max length of frame block names
+#define MEM_FrameGuard          0xf7a3e6a4      //written just past the end of each frame block in debug builds
+#define MFF_Freed               1               //frame block freed but not yet reclaimed
+
+//definitions for the typed object pools
+#define MEM_ObjSlabSlots        128             //objects in each slab, a multiple of 32
+#define MEM_ObjSlabWords        (MEM_ObjSlabSlots / 32)
+#define MEM_ObjAlignment        16              //objects in a slab are aligned to this
+#define MEM_ObjHandleIndexBits  20              //handles hold the slot index and its generation
+#define MEM_ObjHandleIndexMask  ((1 << MEM_ObjHandleIndexBits) - 1)
+#define MEM_ObjGenerationMask   ((1 << (32 - MEM_ObjHandleIndexBits)) - 1)
+#define MEM_ObjHandleNull       0               //never a valid handle, generations start at 1
+
 /*=============================================================================
     Type definitions:
 =============================================================================*/
@@ -258,16 +280,21 @@ typedef struct
     void *wholePool;                            //possibly non-aligned heap base
     ubyte *pool;                                //base of heap, aligned on a cookie boundary
     memcookie *first;                           //first cookie, start of heap
-    memcookie *firstFree;                       //lowest free cookie
-    memcookie *lastFree;                        //cookie AFTER last free cookie
     memcookie *last;                            //last cookie, end of heap
-    memcookie *biggestBlock;                    //biggest block in the pool
-    memcookie *biggestBlockSize;                //size of that biggest block
-    memcookie *firstSize[MSB_NumberSizes + 1];  //lowest free cookie of sizes
-    memcookie *lastSize[MSB_NumberSizes + 1];   //highest free cookie of sizes
+    udword freeFirstLevel;                      //bit set for each first level with any free blocks
+    udword freeSecondLevel[MEM_FLCount];        //bit set for each non-empty list in that level
+    memcookie *freeList[MEM_FLCount][MEM_SLCount];//free blocks, segregated by size
 }
 mempool;
 
+//stored in the body of each free block in the regular heap to link up the free lists
+typedef struct
+{
+    memcookie *next;
+    memcookie *prev;
+}
+memfreelink;
+
 //info on small block heaps.  Pretty simple
 typedef struct
 {
@@ -276,6 +303,74 @@ typedef struct
 }
 memsmallheapinfo;
 
+//cookie at the start of each block in the frame arena
+typedef struct memframecookie
+{
+    struct memframecookie *previous;            //block allocated before this one in the same chunk
+    sdword length;                              //length requested for the block
+    udword flags;                               //validation and MFF_ flags
+#if MEM_USE_NAMES
+    char name[MEM_FrameNameLength];             //name of memory block
+#endif
+}
+memframecookie;
+
+//chunk of memory the frame arena allocates from, allocated outside the memory pools
+typedef struct memframechunk
+{
+    struct memframechunk *older;                //chunk allocated before this one
+    ubyte *start;                               //first block in the chunk, aligned
+    ubyte *top;                                 //where the next block will go
+    ubyte *end;                                 //end of the chunk
+    memframecookie *last;                       //most recent block in the chunk
+}
+memframechunk;
+
+//position in the frame arena to reset back to
+typedef struct
+{
+    memframechunk *chunk;
+    ubyte *top;
+}
+memframemark;
+
+//handle to an object in an object pool.  It stops working as soon as the
+//object is freed, even if the slot gets used again.
+typedef udword memobjhandle;
+
+//slab of same-sized objects, allocated outside the memory pools
+typedef struct memobjslab
+{
+    struct memobjpool *pool;                    //pool it belongs to
+    ubyte *start;                               //first slot, aligned
+    ubyte *end;                                 //just past the last slot
+    sdword index;                               //position in the pool's slab list
+    sdword nFree;                               //free slots
+    udword freeBits[MEM_ObjSlabWords];          //bit set for each free slot
+    uword generation[MEM_ObjSlabSlots];         //bumped each time a slot is freed
+}
+memobjslab;
+
+//pool of objects of one type.  Objects always go in the lowest free slot of
+//the lowest slab with one, so live objects stay packed together at the
+//start of the pool and slabs are never handed back while the game runs.
+typedef struct memobjpool
+{
+    char *name;                                 //what's in it
+    sdword objectLength;                        //length of each object
+    sdword slotLength;                          //length rounded up to MEM_ObjAlignment
+    sdword nSlabs;
+    memobjslab **slabs;                         //in the order they were made
+    sdword firstFreeSlab;                       //no slab before this one has a free slot
+    sdword nLive;                               //objects allocated now
+    sdword nLivePeak;                           //most objects allocated at once
+    udword nAllocs;                             //objects ever allocated
+}
+memobjpool;
+
+//static initializer for a pool of objects of a given length
+#define memObjPoolDefine(length, name)  {(name), (sdword)(length), 0, 0, NULL, 0, 0, 0, 0}
+
 typedef void *(*memgrowcallback)(sdword heapSize);//callback for growing memory
 typedef void (memgrowthfreecallback)(void *heap);//callback for freeing growth heaps
 
@@ -293,6 +388,9 @@ DECLARE_TASK(memStatsTaskFunction);
 extern memcookiename memStatsCookieNames[MS_NumberCookieNames];
 #endif
 extern mempool memMainPool;
+#if MEM_TRACE
+extern bool memTraceEnabled;
+#endif
 
 /*=============================================================================
     Macros:
@@ -305,6 +403,7 @@ extern mempool memMainPool;
 #define mbhNameSet(c, s)    mbhNameSetFunction((c), (s))
 #define memNameSetLong(c, s)    memNameSetFunction((c), (s))
 #define memRealloc(p, l, n, f) memReallocFunction((p), (l), (n), (f));
+#define memFrameAlloc(l, n) memFrameAllocFunction((l), (n))
 #else
 #define memAlloc(l, n, f) memAllocFunction((l), (f));
 #define memAllocAttempt(l, n, f) memAllocAttemptFunction((l), (f));
@@ -312,6 +411,7 @@ extern mempool memMainPool;
 #define mbhNameSet(c, s)
 #define memNameSetLong(c, s)
 #define memRealloc(p, l, n, f) memReallocFunction((p), (l), (f));
+#define memFrameAlloc(l, n) memFrameAllocFunction((l))
 #endif//MEM_USE_NAMES
 
 //block size macros
@@ -334,6 +434,29 @@ extern mempool memMainPool;
 #define mbhCookieVerify(c)
 #endif
 
+//frame arena block sizes
+#define memFrameRoundUp(n)      (((n) + (MEM_FrameAlignment - 1)) & (~(MEM_FrameAlignment - 1)))
+#define memFrameCookieSize      ((sdword)memFrameRoundUp(sizeof(memframecookie)))
+#if MEM_ERROR_CHECKING
+#define memFrameGuardSize       ((sdword)sizeof(udword))
+#else
+#define memFrameGuardSize       0
+#endif
+#define memFrameBlockSize(l)    (memFrameCookieSize + memFrameRoundUp((l) + memFrameGuardSize))
+
+//where a slot's bit is in an object slab's free bits
+#define memObjSlotWord(s)       ((s) / 32)
+#define memObjSlotBit(s)        ((udword)1 << ((s) & 31))
+
+//verify that a frame arena cookie is actually a cookie
+#if MEM_ERROR_CHECKING
+#define memFrameCookieVerify(c)\
+    if (((c)->flags & MBF_VerifyMask) != MBF_VerifyValue)\
+        dbgFatalf(DBG_Loc, "Corrupt frame cookie: 0x%x", (c)->flags & MBF_VerifyMask)
+#else
+#define memFrameCookieVerify(c)
+#endif
+
 //if module not started properly, generate an error
 #if MEM_ERROR_CHECKING
 #define memInitCheck()\
@@ -345,13 +468,8 @@ extern mempool memMainPool;
 #define memInitCheck()
 #endif
 
-//small block allocation
-#define msbSizeBytes(length)    (pool->firstSize[((length) / MEM_BlockSize) - 1])
-#define msbSizeBlocks(length)   (pool->firstSize[length - 1])
-#define msbSizeIndex(length)    (((length) / MEM_BlockSize) - 1)
-#define mslSizeBytes(length)    (pool->lastSize[((length) / MEM_BlockSize) - 1])
-#define mslSizeBlocks(length)   (pool->lastSize[length - 1])
-#define mslSizeIndex(length)    (((length) / MEM_BlockSize) - 1)
+//free list links of a free cookie
+#define memFreeLink(c)          ((memfreelink *)((c) + 1))
 
 #if MEM_LOG_MOSTVOLATILE
 #define memVolatilityLog(c)     memVolatilityLogFuntion(c)
@@ -385,6 +503,30 @@ void memFree(void *pointer);
 char *memStringDupe(char *string);
 char *memStringDupeNV(char *string);
 
+//per-frame arena for short-lived allocations.  Blocks come off the top of the
+//arena and are reclaimed either by memFrameFree/memFree, which pops freed
+//blocks off the top, or all at once by memFrameReset.  Blocks must not be
+//kept past the reset of a mark taken before they were allocated.  Game
+//thread only.
+#if MEM_USE_NAMES
+void *memFrameAllocFunction(sdword length, char *name);
+#else
+void *memFrameAllocFunction(sdword length);
+#endif
+void memFrameFree(void *pointer);
+bool memFrameOwns(void *pointer);
+memframemark memFrameMark(void);
+void memFrameReset(memframemark *mark);
+void memFrameClose(void);
+
+//typed object pools for objects made and destroyed many times a second.
+//memFree and listDeleteNode work on pool objects too.
+void *memObjAlloc(memobjpool *pool);
+bool memObjOwns(void *pointer);
+memobjhandle memObjHandle(void *pointer);
+void *memObjFromHandle(memobjpool *pool, memobjhandle handle);
+void memObjClose(void);
+
 //utility functions (many stubbed out in retail builds)
 #if MEM_ANALYSIS
 void memAnalysisCreate(void);
@@ -406,6 +548,9 @@ char *memStrncpy(char *dest, char *source, sdword count);
 sdword memFreeMemGet(mempool *pool);
 #endif
 
+//replay an alloc/free trace recorded with MEM_TRACE into a scratch heap
+sdword memTraceBench(char *fileName);
+
 const memsize * check_mem(const memsize * data);
 
 #endif
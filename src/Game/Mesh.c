@@ -21,6 +21,7 @@
 #endif
 
 #include <ctype.h>
+#include <stddef.h>
 #include "Debug.h"
 #include "File.h"
 #include "Memory.h"
@@ -33,6 +34,7 @@
 #include "SpaceObj.h"
 #include "Universe.h"
 #include "Mesh.h"
+#include "Prefetch.h"
 #include "Shader.h"
 #include "AutoLOD.h"
 #include "CRC32.h"
@@ -132,6 +134,72 @@ meshMorphLineColors[] =
 };
 #endif
 
+//retained geometry: each polygon object drawn from vertex and index arrays
+//built when it's loaded, one draw call per run of polygons sharing a material
+#define MESH_RETAINED_HASH_SIZE     1024            // must be a power of 2
+#define MESH_RETAINED_MAX_VERTICES  65536           // runs are split so uword indices reach
+#define meshRetainedHash(object)    ((udword)((memsize)(object) >> 6) & (MESH_RETAINED_HASH_SIZE - 1))
+
+//a polygon corner; it has both normals so the same arrays draw all poly modes
+typedef struct
+{
+    vector position;
+    vector faceNormal;
+    vector vertexNormal;
+    real32 s, t;
+}
+meshretainedvertex;
+
+//consecutive polygons with the same material, drawn in one call
+typedef struct
+{
+    sdword iMaterial;
+    sdword nPolygons;
+    sdword firstIndex;                      //first of nPolygons * 3 indices
+    sdword firstVertex;                     //indices are relative to this vertex
+    sdword nVertices;
+}
+meshretainedrun;
+
+typedef struct meshretained
+{
+    struct meshretained *next;              //next in hash bucket
+    polygonobject *object;                  //object these arrays draw
+    sdword nVertices;
+    sdword nRuns;
+    meshretainedvertex *vertices;
+    meshretainedrun *runs;
+    uword *indices;
+    udword contextSerial;                   //rndGLContextSerial when the buffers were made
+    GLuint vertexBuffer;                    //buffer objects, or 0 to draw from the arrays
+    GLuint indexBuffer;
+}
+meshretained;
+
+static meshretained *meshRetainedTable[MESH_RETAINED_HASH_SIZE];
+
+//draw objects from their retained arrays when there are some
+bool meshRetainedEnabled = TRUE;
+
+static bool useVBO = FALSE;
+
+#if MESH_GL_CALL_STATS
+//geometry calls (glBegin, glVertex, glDrawElements...) and batches sent
+udword meshGLCalls = 0;
+udword meshGLBatches = 0;
+
+//immediate mode calls per polygon in each poly mode, normal and specular
+static udword meshGLCallsPerPolygon[2][4] =
+{
+    {4, 7, 6, 9},
+    {6, 9, 6, 9}
+};
+#endif
+
+//per-vertex colours computed for specular runs
+static ubyte *meshSpecColours = NULL;
+static sdword meshSpecColoursLength = 0;
+
 /*=============================================================================
     Functions:
 =============================================================================*/
@@ -145,6 +213,7 @@ meshMorphLineColors[] =
 ----------------------------------------------------------------------------*/
 void meshStartup()
 {
+    useVBO = glCheckExtension("GL_ARB_vertex_buffer_object");
 }
 
 /*-----------------------------------------------------------------------------
@@ -156,7 +225,249 @@ void meshStartup()
 ----------------------------------------------------------------------------*/
 void meshShutdown()
 {
-    //nothing here
+    if (meshSpecColours != NULL)
+    {
+        memFree(meshSpecColours);
+        meshSpecColours = NULL;
+        meshSpecColoursLength = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshRetainedFind
+    Description : Finds the retained arrays of a polygon object
+    Inputs      : object - object to look for
+    Outputs     :
+    Return      : retained arrays or NULL if the object has none
+----------------------------------------------------------------------------*/
+static meshretained *meshRetainedFind(polygonobject *object)
+{
+    meshretained *retained;
+
+    for (retained = meshRetainedTable[meshRetainedHash(object)]; retained != NULL; retained = retained->next)
+    {
+        if (retained->object == object)
+        {
+            return(retained);
+        }
+    }
+    return(NULL);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshObjectRetainedDelete
+    Description : Frees the retained arrays and buffers of a polygon object
+    Inputs      : object - object to free them for
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void meshObjectRetainedDelete(polygonobject *object)
+{
+    meshretained **link, *retained;
+
+    for (link = &meshRetainedTable[meshRetainedHash(object)]; *link != NULL; link = &(*link)->next)
+    {
+        if ((*link)->object == object)
+        {
+            retained = *link;
+            *link = retained->next;
+            if (retained->vertexBuffer != 0 && retained->contextSerial == rndGLContextSerial)
+            {                                               //buffers from an old context went with it
+                glDeleteBuffers(1, &retained->vertexBuffer);
+                glDeleteBuffers(1, &retained->indexBuffer);
+            }
+            memFree(retained);
+            return;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshObjectRetain
+    Description : Builds the arrays meshObjectRender draws a polygon object
+                    from.  Every polygon corner becomes a vertex, shared with
+                    identical corners in the same run.  Consecutive polygons
+                    with the same material make a run, split where needed to
+                    keep the indices in a uword.
+    Inputs      : object - object to build the arrays for
+    Outputs     : replaces any arrays the object already has.  Call again
+                    if the polygons' s/t coordinates change.
+    Return      :
+----------------------------------------------------------------------------*/
+void meshObjectRetain(polygonobject *object)
+{
+    meshretained *retained;
+    meshretainedvertex *vertices, *vertex;
+    meshretainedrun *runs, *run = NULL;
+    uword *indices;
+    sdword *slots, *slotRuns, *sourceVertex, *sourceNormal;
+    sdword nCorners, hashSize, nVertices = 0, nRuns = 0;
+    sdword iPoly, corner, iVertex, iNormal, slot, nNormals;
+    polyentry *polygon;
+    normalentry *normalList = object->pNormalList;
+    real32 st[2];
+    udword stBits[2], hash;
+
+    meshObjectRetainedDelete(object);
+    if (object->nPolygons <= 0)
+    {
+        return;
+    }
+
+    nCorners = object->nPolygons * 3;
+    nNormals = object->nFaceNormals + object->nVertexNormals;
+    for (hashSize = 64; hashSize < nCorners * 2; hashSize <<= 1)
+    {
+        ;
+    }
+    vertices = memAlloc(nCorners * (sizeof(meshretainedvertex) + sizeof(sdword) * 2 + sizeof(uword)) +
+                        object->nPolygons * sizeof(meshretainedrun), "MeshRetainedBuild", Pyrophoric);
+    sourceVertex = (sdword *)(vertices + nCorners);
+    sourceNormal = sourceVertex + nCorners;
+    runs = (meshretainedrun *)(sourceNormal + nCorners);
+    indices = (uword *)(runs + object->nPolygons);
+    slots = memAlloc(hashSize * 2 * sizeof(sdword), "MeshRetainedHash", Pyrophoric);
+    slotRuns = slots + hashSize;
+    memset(slotRuns, 0xff, hashSize * sizeof(sdword));
+
+    for (iPoly = 0, polygon = object->pPolygonList; iPoly < object->nPolygons; iPoly++, polygon++)
+    {
+        if (run == NULL || polygon->iMaterial != run->iMaterial ||
+            run->nVertices + 3 > MESH_RETAINED_MAX_VERTICES)
+        {                                                   //start a new run
+            run = &runs[nRuns++];
+            run->iMaterial = polygon->iMaterial;
+            run->nPolygons = 0;
+            run->firstIndex = iPoly * 3;
+            run->firstVertex = nVertices;
+            run->nVertices = 0;
+        }
+        run->nPolygons++;
+
+        for (corner = 0; corner < 3; corner++)
+        {
+            switch (corner)
+            {
+                case 0:
+                    iVertex = polygon->iV0;
+                    st[0] = polygon->s0;
+                    st[1] = polygon->t0;
+                    break;
+                case 1:
+                    iVertex = polygon->iV1;
+                    st[0] = polygon->s1;
+                    st[1] = polygon->t1;
+                    break;
+                default:
+                    iVertex = polygon->iV2;
+                    st[0] = polygon->s2;
+                    st[1] = polygon->t2;
+                    break;
+            }
+#if MESH_ANAL_CHECKING
+            dbgAssertOrIgnore(iVertex < object->nVertices);
+#endif
+            //look for the same corner already in this run
+            memcpy(stBits, st, sizeof(stBits));
+            hash = (udword)iVertex * 2654435761u ^ (udword)polygon->iFaceNormal * 40503u ^
+                   stBits[0] * 73856093u ^ stBits[1] * 19349663u;
+            for (slot = hash & (hashSize - 1); slotRuns[slot] == nRuns; slot = (slot + 1) & (hashSize - 1))
+            {
+                vertex = &vertices[slots[slot]];
+                if (sourceVertex[slots[slot]] == iVertex && sourceNormal[slots[slot]] == polygon->iFaceNormal &&
+                    vertex->s == st[0] && vertex->t == st[1])
+                {
+                    break;
+                }
+            }
+            if (slotRuns[slot] != nRuns)
+            {                                               //not there, add it
+                slotRuns[slot] = nRuns;
+                slots[slot] = nVertices;
+                sourceVertex[nVertices] = iVertex;
+                sourceNormal[nVertices] = polygon->iFaceNormal;
+                vertex = &vertices[nVertices];
+                vertex->position.x = object->pVertexList[iVertex].x;
+                vertex->position.y = object->pVertexList[iVertex].y;
+                vertex->position.z = object->pVertexList[iVertex].z;
+                if (polygon->iFaceNormal >= 0 && polygon->iFaceNormal < nNormals)
+                {
+                    vecSet(vertex->faceNormal, normalList[polygon->iFaceNormal].x,
+                           normalList[polygon->iFaceNormal].y, normalList[polygon->iFaceNormal].z);
+                }
+                else
+                {
+                    vecZeroVector(vertex->faceNormal);
+                }
+                iNormal = object->pVertexList[iVertex].iVertexNormal;
+                if (iNormal >= 0 && iNormal < nNormals)
+                {
+                    vecSet(vertex->vertexNormal, normalList[iNormal].x, normalList[iNormal].y, normalList[iNormal].z);
+                }
+                else
+                {                                           //only drawn flat
+                    vertex->vertexNormal = vertex->faceNormal;
+                }
+                vertex->s = st[0];
+                vertex->t = st[1];
+                nVertices++;
+                run->nVertices++;
+            }
+            indices[iPoly * 3 + corner] = (uword)(slots[slot] - run->firstVertex);
+        }
+    }
+    memFree(slots);
+
+    //copy it all into one block that's just big enough
+    retained = memAlloc(sizeof(meshretained) + nVertices * sizeof(meshretainedvertex) +
+                        nRuns * sizeof(meshretainedrun) + nCorners * sizeof(uword), "MeshRetained", NonVolatile);
+    retained->object = object;
+    retained->nVertices = nVertices;
+    retained->nRuns = nRuns;
+    retained->vertices = (meshretainedvertex *)(retained + 1);
+    retained->runs = (meshretainedrun *)(retained->vertices + nVertices);
+    retained->indices = (uword *)(retained->runs + nRuns);
+    memcpy(retained->vertices, vertices, nVertices * sizeof(meshretainedvertex));
+    memcpy(retained->runs, runs, nRuns * sizeof(meshretainedrun));
+    memcpy(retained->indices, indices, nCorners * sizeof(uword));
+    retained->contextSerial = 0;
+    retained->vertexBuffer = retained->indexBuffer = 0;
+    memFree(vertices);
+
+    retained->next = meshRetainedTable[meshRetainedHash(object)];
+    meshRetainedTable[meshRetainedHash(object)] = retained;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshRetainedUpload
+    Description : Puts an object's retained arrays in buffer objects, if
+                    the driver has them and it hasn't been done for the
+                    current GL context yet.
+    Inputs      : retained - arrays to upload
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void meshRetainedUpload(meshretained *retained)
+{
+    if (retained->contextSerial == rndGLContextSerial)
+    {
+        return;
+    }
+    retained->contextSerial = rndGLContextSerial;
+    retained->vertexBuffer = retained->indexBuffer = 0;     //any old ones went with their context
+    if (!useVBO)
+    {
+        return;
+    }
+
+    glGenBuffers(1, &retained->vertexBuffer);
+    glGenBuffers(1, &retained->indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, retained->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, retained->nVertices * sizeof(meshretainedvertex), retained->vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, retained->indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, retained->object->nPolygons * 3 * sizeof(uword), retained->indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 /*-----------------------------------------------------------------------------
@@ -553,6 +864,7 @@ void meshObjectFixupPacoUV(polygonobject* object, sdword on)
             polygon->t2 -= t;
         }
     }
+    meshObjectRetain(object);
 }
 
 /*-----------------------------------------------------------------------------
@@ -605,6 +917,33 @@ void meshFixupPacoUV(meshdata* mesh, sdword on)
     }
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : meshPrefetch
+    Description : Asks for a mesh file to be streamed in before meshLoad is
+                    called on it.
+    Inputs      : inFileName - name meshLoad will be called with
+    Outputs     :
+    Return      : void
+    Note        : picks the same file meshLoad does
+----------------------------------------------------------------------------*/
+void meshPrefetch(char *inFileName)
+{
+    char fileName[1024];
+
+    if (mainAllowPacking && meshPagedVersionExists(inFileName))
+    {
+        meshPagedName(fileName, inFileName);
+    }
+    else
+    {
+        strcpy(fileName, inFileName);
+    }
+#ifdef _X86_64
+    strcat(fileName, ".64");
+#endif
+    pfRequest(fileName, PF_Open);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : meshLoad
     Description : Loads in a mesh file.
@@ -930,6 +1269,11 @@ meshdata *meshLoad(char *inFileName)
 */
     }
 
+    for (index = 0; index < mesh->nPolygonObjects; index++)
+    {                                                       //build the arrays they're drawn from
+        meshObjectRetain(&mesh->object[index]);
+    }
+
     return(mesh);
 }
 
@@ -985,6 +1329,7 @@ void meshObjectFixupUV(polygonobject* object, materialentry* materials)
             if (polygon->t2 == 1.0f) polygon->t2 = one;
         }
     }
+    meshObjectRetain(object);
 }
 
 /*-----------------------------------------------------------------------------
@@ -1189,6 +1534,10 @@ void meshFree(meshdata *mesh)
             memFree((ubyte *)mesh->localMaterial[index].texture);    //free the texture handle list
         }
     }
+    for (index = 0; index < mesh->nPolygonObjects; index++)
+    {
+        meshObjectRetainedDelete(&mesh->object[index]);
+    }
 #if MESH_RETAIN_FILENAMES
     memFree(mesh->fileName);
 #endif
@@ -1561,6 +1910,194 @@ void meshObjectPoints(polygonobject* object, materialentry* materials, sdword iC
     rndLightingEnable(lightOn);
     rndTextureEnable(texOn);
 }
+/*-----------------------------------------------------------------------------
+    Name        : meshRetainedSpecColours
+    Description : Works out the specular colour of each vertex of a run, the
+                    way meshSpecColour does for each vertex drawn.
+    Inputs      : retained, run - run to colour
+                  smooth - use the vertex normals instead of the face normals
+                  m, minv - modelview matrix and its inverse
+    Outputs     : fills in meshSpecColours
+    Return      :
+----------------------------------------------------------------------------*/
+static void meshRetainedSpecColours(meshretained *retained, meshretainedrun *run, bool smooth, real32 *m, real32 *minv)
+{
+    meshretainedvertex *vertex;
+    ubyte *colour;
+    sdword index;
+
+    if (run->nVertices > meshSpecColoursLength)
+    {
+        meshSpecColours = memRealloc(meshSpecColours, run->nVertices * 4, "MeshSpecColours", NonVolatile);
+        meshSpecColoursLength = run->nVertices;
+    }
+    vertex = &retained->vertices[run->firstVertex];
+    for (index = 0, colour = meshSpecColours; index < run->nVertices; index++, vertex++, colour += 4)
+    {
+        colour[0] = specColour[0];
+        colour[1] = specColour[1];
+        colour[2] = specColour[2];
+        colour[3] = specColour[3];
+        shSpecularColour(specIndex, 0, &vertex->position, smooth ? &vertex->vertexNormal : &vertex->faceNormal, colour, m, minv);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshRetainedRender
+    Description : Draws a polygon object from its retained arrays, one
+                    glDrawElements per run.  Looks the same as drawing it in
+                    immediate mode with meshObjectRender/meshSpecObjectRender.
+    Inputs      : retained - the object's arrays
+                  materials, iColorScheme - same as meshObjectRender
+                  spec - TRUE to draw with specular-only shading
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void meshRetainedRender(meshretained *retained, materialentry *materials, sdword iColorScheme, bool spec)
+{
+    meshretainedrun *run;
+    sdword iRun, currentMaterial = -1;
+    ubyte *vertexBase, *indexBase, *base;
+    bool smooth, textured, enableBlend;
+    sdword lightOn = FALSE;
+    real32 modelview[16], modelviewInv[16];
+
+    if (spec)
+    {
+        lightOn = rndLightingEnable(FALSE);
+        glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+        shInvertMatrix(modelviewInv, modelview);
+        enableBlend = FALSE;
+    }
+    else
+    {
+        enableBlend = bFade;
+    }
+
+    glShadeModel(GL_SMOOTH);
+
+    alodIncPolys(retained->object->nPolygons);
+
+    meshRetainedUpload(retained);
+    if (retained->vertexBuffer != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, retained->vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, retained->indexBuffer);
+        vertexBase = NULL;                                  //offsets into the buffers
+        indexBase = NULL;
+    }
+    else
+    {
+        vertexBase = (ubyte *)retained->vertices;
+        indexBase = (ubyte *)retained->indices;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(spec ? GL_COLOR_ARRAY : GL_NORMAL_ARRAY);
+#if MESH_GL_CALL_STATS
+    meshGLCalls += retained->vertexBuffer != 0 ? 4 : 2;
+#endif
+
+    for (iRun = 0, run = retained->runs; iRun < retained->nRuns; iRun++, run++)
+    {
+        if (run->iMaterial != currentMaterial)
+        {                                                   //if a new material
+            currentMaterial = run->iMaterial;
+            meshCurrentMaterial(&materials[currentMaterial], iColorScheme);//set new material
+            if (enableBlend)
+            {
+                glEnable(GL_BLEND);
+            }
+#if MESH_MATERIAL_STATS
+            nMaterialChanges++;                             //record material stats
+            iMaterialMax = max(currentMaterial, iMaterialMax);
+#endif //MESH_MATERIAL_STATS
+        }
+        if (meshPolyMode < MPM_Flat || meshPolyMode > MPM_SmoothTexture)
+        {
+#if MESH_ERROR_CHECKING
+            dbgFatalf(DBG_Loc, "meshRender: invalid meshPolyMode: 0x%x", meshPolyMode);
+#endif
+            continue;
+        }
+        smooth = (meshPolyMode == MPM_Smooth || meshPolyMode == MPM_SmoothTexture);
+        textured = (meshPolyMode == MPM_Texture || meshPolyMode == MPM_SmoothTexture);
+
+        if (spec)
+        {                                                   //colours come from memory, not the buffer
+            meshRetainedSpecColours(retained, run, smooth, modelview, modelviewInv);
+            if (retained->vertexBuffer != 0)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                glColorPointer(4, GL_UNSIGNED_BYTE, 0, meshSpecColours);
+                glBindBuffer(GL_ARRAY_BUFFER, retained->vertexBuffer);
+            }
+            else
+            {
+                glColorPointer(4, GL_UNSIGNED_BYTE, 0, meshSpecColours);
+            }
+        }
+        else
+        {
+            base = vertexBase + run->firstVertex * sizeof(meshretainedvertex);
+            glNormalPointer(GL_FLOAT, sizeof(meshretainedvertex),
+                            base + (smooth ? offsetof(meshretainedvertex, vertexNormal) : offsetof(meshretainedvertex, faceNormal)));
+        }
+        base = vertexBase + run->firstVertex * sizeof(meshretainedvertex);
+        glVertexPointer(3, GL_FLOAT, sizeof(meshretainedvertex), base + offsetof(meshretainedvertex, position));
+        if (textured)
+        {
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glTexCoordPointer(2, GL_FLOAT, sizeof(meshretainedvertex), base + offsetof(meshretainedvertex, s));
+        }
+        else
+        {
+            glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        }
+        glDrawElements(GL_TRIANGLES, run->nPolygons * 3, GL_UNSIGNED_SHORT, indexBase + run->firstIndex * sizeof(uword));
+#if MESH_GL_CALL_STATS
+        meshGLCalls += (textured ? 5 : 4) + ((spec && retained->vertexBuffer != 0) ? 2 : 0);
+        meshGLBatches++;
+#endif
+
+#if RND_POLY_STATS
+        rndNumberPolys += run->nPolygons;
+        if (textured)
+        {
+            rndNumberTextured += run->nPolygons;
+        }
+        if (smooth)
+        {
+            rndNumberSmoothed += run->nPolygons;
+        }
+#endif //RND_POLY_STATS
+    }
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(spec ? GL_COLOR_ARRAY : GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (retained->vertexBuffer != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+#if MESH_GL_CALL_STATS
+    meshGLCalls += retained->vertexBuffer != 0 ? 5 : 3;
+#endif
+
+    glShadeModel(GL_SMOOTH);
+    glLightModelf(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+
+    if (enableBlend)
+    {
+        glDisable(GL_BLEND);
+    }
+    if (spec)
+    {
+        rndLightingEnable(lightOn);
+    }
+}
+
 void meshObjectRender(polygonobject *object, materialentry *materials, sdword iColorScheme)
 {
     sdword iPoly;
@@ -1570,7 +2107,18 @@ void meshObjectRender(polygonobject *object, materialentry *materials, sdword iC
     sdword currentMaterial = -1;
     GLenum mode = GL_SMOOTH;
     sdword lightOn = FALSE;
-    bool enableBlend;
+    bool enableBlend, uvChanged = FALSE;
+    meshretained *retained;
+
+    if (meshRetainedEnabled && !g_WireframeHack && !g_SpecificPoly)
+    {
+        retained = meshRetainedFind(object);
+        if (retained != NULL)
+        {
+            meshRetainedRender(retained, materials, iColorScheme, FALSE);
+            return;
+        }
+    }
 
     glShadeModel(mode);
 
@@ -1600,6 +2148,10 @@ void meshObjectRender(polygonobject *object, materialentry *materials, sdword iC
     polygon = object->pPolygonList;                         //get first polygon list entry
 
     glBegin(g_WireframeHack ? GL_LINE_LOOP : GL_TRIANGLES);                                  //prepare to draw triangles
+#if MESH_GL_CALL_STATS
+    meshGLCalls += 2;
+    meshGLBatches++;
+#endif
 
     for (iPoly = 0; iPoly < object->nPolygons; iPoly++)
     {
@@ -1618,6 +2170,10 @@ void meshObjectRender(polygonobject *object, materialentry *materials, sdword iC
                 glEnable(GL_BLEND);
             }
             glBegin(g_WireframeHack ? GL_LINE_LOOP : GL_TRIANGLES);                          //start new run
+#if MESH_GL_CALL_STATS
+            meshGLCalls += 2;
+            meshGLBatches++;
+#endif
 #if MESH_MATERIAL_STATS
             nMaterialChanges++;                             //record material stats
             iMaterialMax = max(currentMaterial, iMaterialMax);
@@ -1682,6 +2238,7 @@ void meshObjectRender(polygonobject *object, materialentry *materials, sdword iC
                         }
                     }
                     visibleDirection = 0;
+                    uvChanged = TRUE;
                 }
             }
         }
@@ -1780,10 +2337,18 @@ void meshObjectRender(polygonobject *object, materialentry *materials, sdword iC
 #endif
                 break;
         }
+#if MESH_GL_CALL_STATS
+        meshGLCalls += meshGLCallsPerPolygon[0][meshPolyMode & 3];
+#endif
         polygon++;
     }
     glEnd();                                            //done drawing these triangles
 
+    if (uvChanged)
+    {                                                   //keep the retained arrays up to date
+        meshObjectRetain(object);
+    }
+
     glShadeModel(GL_SMOOTH);
     glLightModelf(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
 
@@ -1821,6 +2386,17 @@ void meshSpecObjectRender(polygonobject *object, materialentry *materials, sdwor
     sdword lightOn;
 
     real32 modelview[16], modelviewInv[16];
+    meshretained *retained;
+
+    if (meshRetainedEnabled)
+    {
+        retained = meshRetainedFind(object);
+        if (retained != NULL)
+        {
+            meshRetainedRender(retained, materials, iColorScheme, TRUE);
+            return;
+        }
+    }
 
     lightOn = rndLightingEnable(FALSE);
 
@@ -1836,6 +2412,10 @@ void meshSpecObjectRender(polygonobject *object, materialentry *materials, sdwor
     polygon = object->pPolygonList;                         //get first polygon list entry
 
     glBegin(GL_TRIANGLES);                                  //prepare to draw triangles
+#if MESH_GL_CALL_STATS
+    meshGLCalls += 2;
+    meshGLBatches++;
+#endif
 
     for (iPoly = 0; iPoly < object->nPolygons; iPoly++)
     {
@@ -1850,6 +2430,10 @@ void meshSpecObjectRender(polygonobject *object, materialentry *materials, sdwor
             currentMaterial = polygon->iMaterial;           //remember current material
             meshCurrentMaterial(&materials[currentMaterial], iColorScheme);//set new material
             glBegin(GL_TRIANGLES);                          //start new run
+#if MESH_GL_CALL_STATS
+            meshGLCalls += 2;
+            meshGLBatches++;
+#endif
 #if MESH_MATERIAL_STATS
             nMaterialChanges++;                             //record material stats
             iMaterialMax = max(currentMaterial, iMaterialMax);
@@ -1948,6 +2532,9 @@ void meshSpecObjectRender(polygonobject *object, materialentry *materials, sdwor
 #endif
                 break;
         }
+#if MESH_GL_CALL_STATS
+        meshGLCalls += meshGLCallsPerPolygon[1][meshPolyMode & 3];
+#endif
         polygon++;
     }
     glEnd();                                            //done drawing these triangles
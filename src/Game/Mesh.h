@@ -19,6 +19,7 @@
 #define MESH_LOAD_DUMMY_TEXTURE 0               //load in a dummy texture
 #define MESH_DUMMY_ST_COORDS    0               //compute default s/t coords
 #define MESH_MATERIAL_STATS     1               //display material statistics
+#define MESH_GL_CALL_STATS      1               //count the GL calls made drawing meshes
 #define MESH_HACK_TEAM_COLORS   0               //hack team colors
 #define MESH_TEAM_COLORS        0               //enable auto-team coloring of certain surfaces
 #define MESH_PRE_CALLBACK       0
@@ -268,6 +269,13 @@ extern bool usingShader;
 extern bool meshMorphDebug;
 #endif
 
+extern bool meshRetainedEnabled;
+
+#if MESH_GL_CALL_STATS
+extern udword meshGLCalls;
+extern udword meshGLBatches;
+#endif
+
 /*=============================================================================
     Macros:
 =============================================================================*/
@@ -283,9 +291,12 @@ void meshShutdown(void);
 
 //load in a mesh file
 meshdata *meshLoad(char *fileName);
+void meshPrefetch(char *fileName);
 void meshFree(meshdata *mesh);
 void meshRecolorize(meshdata *mesh);
 void meshFixupUV(meshdata* mesh);
+void meshObjectRetain(polygonobject *object);
+void meshObjectRetainedDelete(polygonobject *object);
 bool meshPagedVersionExists(char* fileName);
 
 //render a specific mesh
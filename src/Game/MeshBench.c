@@ -0,0 +1,259 @@
+// =============================================================================
+//  MeshBench.c
+//  - mesh rendering benchmark, draws every ship mesh in a mission in
+//    immediate mode and from the retained arrays and counts the GL calls.
+//    Needs a GL context; runs under Xvfb with Mesa's software rasterizer.
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "MeshBench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "glinc.h"
+#include "LOD.h"
+#include "main.h"
+#include "Memory.h"
+#include "Mesh.h"
+#include "render.h"
+#include "rglu.h"
+#include "SimBench.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool meshBenchEnabled = FALSE;
+static udword meshBenchFrames = MESHBENCH_DEFAULT_FRAMES;
+
+//the meshes drawn, one of each kind of ship in the mission
+static meshdata *meshBenchMesh[MESHBENCH_MAX_MESHES];
+static real32 meshBenchRadius[MESHBENCH_MAX_MESHES];
+static sdword meshBenchColorScheme[MESHBENCH_MAX_MESHES];
+static sdword meshBenchNumberMeshes = 0;
+
+//the ways of drawing timed
+typedef enum
+{
+    MBP_Immediate,
+    MBP_Retained,
+    MBP_NumberPasses
+} mbpass;
+
+static char *meshBenchPassNames[MBP_NumberPasses] = {"immediate", "retained"};
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : meshBenchSet
+    Description : Command-line handler for /meshBench <nFrames>
+    Inputs      : string - number of frames to draw each way
+    Outputs     : enables the benchmark
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool meshBenchSet(char *string)
+{
+    sscanf(string, "%u", &meshBenchFrames);
+    if (meshBenchFrames == 0)
+    {
+        meshBenchFrames = MESHBENCH_DEFAULT_FRAMES;
+    }
+    meshBenchEnabled = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshBenchMeshesFind
+    Description : Picks out the top level of detail mesh of each kind of
+                  ship in the universe.
+    Inputs      :
+    Outputs     : fills in meshBenchMesh and friends
+    Return      : total polygons in the meshes picked
+----------------------------------------------------------------------------*/
+static sdword meshBenchMeshesFind(void)
+{
+    Node *node;
+    Ship *ship;
+    lod *level;
+    meshdata *mesh;
+    sdword index, nPolygons = 0;
+
+    meshBenchNumberMeshes = 0;
+    for (node = universe.ShipList.head; node != NULL && meshBenchNumberMeshes < MESHBENCH_MAX_MESHES; node = node->next)
+    {
+        ship = (Ship *)listGetStructOfNode(node);
+        if (ship->staticinfo->staticheader.LOD == NULL)
+        {
+            continue;
+        }
+        level = &ship->staticinfo->staticheader.LOD->level[0];
+        if ((level->flags & LM_LODType) != LT_Mesh || level->pData == NULL)
+        {
+            continue;
+        }
+        mesh = (meshdata *)level->pData;
+        for (index = 0; index < meshBenchNumberMeshes; index++)
+        {
+            if (meshBenchMesh[index] == mesh)
+            {
+                break;
+            }
+        }
+        if (index < meshBenchNumberMeshes)
+        {
+            continue;
+        }
+        meshBenchMesh[meshBenchNumberMeshes] = mesh;
+        meshBenchRadius[meshBenchNumberMeshes] = max(ship->staticinfo->staticheader.staticCollInfo.collspheresize, 1.0f);
+        meshBenchColorScheme[meshBenchNumberMeshes] = ship->colorScheme;
+        meshBenchNumberMeshes++;
+        for (index = 0; index < mesh->nPolygonObjects; index++)
+        {
+            nPolygons += mesh->object[index].nPolygons;
+        }
+    }
+    return(nPolygons);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshBenchFrame
+    Description : Draws all the meshes, each in its own cell of the window.
+    Inputs      : frame - frame number, spins the meshes
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void meshBenchFrame(udword frame)
+{
+    sdword index, nColumns, cellWidth, cellHeight;
+
+    for (nColumns = 1; nColumns * nColumns < meshBenchNumberMeshes; nColumns++)
+    {
+        ;
+    }
+    cellWidth = MAIN_WindowWidth / nColumns;
+    cellHeight = MAIN_WindowHeight / nColumns;
+
+    glViewport(0, 0, MAIN_WindowWidth, MAIN_WindowHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_NORMALIZE);
+    rndLightingEnable(TRUE);
+
+    for (index = 0; index < meshBenchNumberMeshes; index++)
+    {
+        glViewport((index % nColumns) * cellWidth, (index / nColumns) * cellHeight, cellWidth, cellHeight);
+
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        rgluPerspective(45.0f, (real32)cellWidth / (real32)cellHeight,
+                        meshBenchRadius[index] * 0.5f, meshBenchRadius[index] * 6.0f);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        glTranslatef(0.0f, 0.0f, -meshBenchRadius[index] * 3.0f);
+        glRotatef(30.0f, 1.0f, 0.0f, 0.0f);
+        glRotatef((real32)(frame % 360), 0.0f, 1.0f, 0.0f);
+
+        meshRender(meshBenchMesh[index], meshBenchColorScheme[index]);
+    }
+
+    glDisable(GL_NORMALIZE);
+    rndLightingEnable(FALSE);
+    glViewport(0, 0, MAIN_WindowWidth, MAIN_WindowHeight);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshBenchPass
+    Description : Draws meshBenchFrames frames one way and reports the GL
+                  calls and time each frame takes.
+    Inputs      : pass - immediate mode or retained arrays
+    Outputs     :
+    Return      : pixels of the first frame, drawn again afterwards
+----------------------------------------------------------------------------*/
+static ubyte *meshBenchPass(mbpass pass)
+{
+    udword frame, callsStart, batchesStart;
+    sqword timeStart, timeStop;
+    ubyte *pixels;
+
+    meshRetainedEnabled = (pass == MBP_Retained);
+
+    meshBenchFrame(0);                                      //make the buffer objects before timing
+    glFinish();
+
+    callsStart = meshGLCalls;
+    batchesStart = meshGLBatches;
+    GetRawTime(&timeStart);
+    for (frame = 0; frame < meshBenchFrames; frame++)
+    {
+        meshBenchFrame(frame);
+    }
+    glFinish();
+    GetRawTime(&timeStop);
+
+    printf("  %-9s %8.0f GL calls/frame, %6.0f batches/frame, %8.3f ms/frame\n", meshBenchPassNames[pass],
+           (real64)(meshGLCalls - callsStart) / (real64)meshBenchFrames,
+           (real64)(meshGLBatches - batchesStart) / (real64)meshBenchFrames,
+           (real64)(timeStop - timeStart) / 1000.0 / (real64)meshBenchFrames);
+
+    //draw the first frame again, it should look the same both ways
+    meshBenchFrame(0);
+    pixels = memAlloc(MAIN_WindowWidth * MAIN_WindowHeight * 4, "MeshBenchPixels", Pyrophoric);
+    glReadPixels(0, 0, MAIN_WindowWidth, MAIN_WindowHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    return(pixels);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : meshBenchRun
+    Description : Runs the mesh rendering benchmark
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword meshBenchRun(void)
+{
+    ubyte *pixels[MBP_NumberPasses];
+    sdword nPolygons, pass, index, nDifferent = 0;
+    bool retainedWas = meshRetainedEnabled;
+
+    if (!benchSinglePlayerStart())
+    {
+        printf("MeshBench: mission didn't start\n");
+        return -1;
+    }
+
+    nPolygons = meshBenchMeshesFind();
+    printf("MeshBench: %d meshes, %d polygons, %u frames, %s\n", meshBenchNumberMeshes, nPolygons, meshBenchFrames,
+           glCheckExtension("GL_ARB_vertex_buffer_object") ? "buffer objects" : "client arrays");
+    for (pass = 0; pass < MBP_NumberPasses; pass++)
+    {
+        pixels[pass] = meshBenchPass((mbpass)pass);
+    }
+    //interpolated colours can round a little differently drawn from arrays
+    for (index = 0; index < MAIN_WindowWidth * MAIN_WindowHeight * 4; index++)
+    {
+        if (abs(pixels[MBP_Immediate][index] - pixels[MBP_Retained][index]) > 1)
+        {
+            nDifferent++;
+        }
+    }
+    printf("  %d colour components differ by more than 1\n", nDifferent);
+    for (pass = 0; pass < MBP_NumberPasses; pass++)
+    {
+        memFree(pixels[pass]);
+    }
+
+    meshRetainedEnabled = retainedWas;
+    gameEnd();
+    gameIsRunning = FALSE;
+
+    return (nDifferent == 0) ? 0 : -1;
+}
@@ -0,0 +1,36 @@
+// =============================================================================
+//  MeshBench.h
+//  - mesh rendering benchmark, draws every ship mesh in a mission in
+//    immediate mode and from the retained arrays and counts the GL calls.
+//    Needs a GL context; runs under Xvfb with Mesa's software rasterizer.
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___MESHBENCH_H
+#define ___MESHBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define MESHBENCH_DEFAULT_FRAMES    100
+#define MESHBENCH_MAX_MESHES        64              // most different meshes drawn each frame
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool meshBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool meshBenchSet(char *string);
+
+sdword meshBenchRun(void);
+
+#endif
@@ -0,0 +1,415 @@
+// =============================================================================
+//  MixBench.c
+//  - headless sound mixer benchmark, mixes a growing number of voices and
+//    works out how many fit in the time one block of sound lasts, then
+//    times a battle's worth of one-shots with and without the decode cache
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "MixBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "fquant.h"
+#include "main.h"
+#include "Memory.h"
+#include "soundcmn.h"
+#include "TimeoutTimer.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define MIXBENCH_BITRATE        FQ_BR88             // bits per compressed block of the test sound
+#define MIXBENCH_RUNS           (SOUND_MAX_VOICES / MIXBENCH_VOICE_STEP + 1)
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool mixBenchEnabled = FALSE;
+static udword mixBenchBlocks = MIXBENCH_DEFAULT_BLOCKS;
+
+static PATCH mixBenchPatch;
+static PATCH mixBenchShot;
+static ubyte *mixBenchData = NULL;
+
+extern CHANNEL channels[];
+extern sdword soundnumvoices;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchSet
+    Description : Command-line handler for /mixBench <nBlocks>
+    Inputs      : string - number of blocks to mix for each voice count
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool mixBenchSet(char *string)
+{
+    sscanf(string, "%u", &mixBenchBlocks);
+    if (mixBenchBlocks == 0)
+    {
+        mixBenchBlocks = MIXBENCH_DEFAULT_BLOCKS;
+    }
+    mixBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchRandom
+    Description : Steps a random number generator.
+    Inputs      : seed - generator state
+    Outputs     :
+    Return      : the next random number
+----------------------------------------------------------------------------*/
+static udword mixBenchRandom(udword *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return(*seed >> 8);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchPack
+    Description : Appends a field to a compressed block, least significant
+                  bit first as fqUnpack reads them.
+    Inputs      : block - block being written
+                  pos - bit position, moved on past the field
+                  value, nBits - the field
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void mixBenchPack(ubyte *block, udword *pos, udword value, udword nBits)
+{
+    udword i;
+
+    for (i = 0; i < nBits; i++, (*pos)++)
+    {
+        if (value & (1 << i))
+        {
+            block[*pos >> 3] |= (ubyte)(1 << (*pos & 7));
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchPatchMake
+    Description : Builds a looping test sound that needs no sound banks.
+                  Every block sets each coefficient to a small random value,
+                  which is as much work as a block can make the decoder do.
+    Inputs      :
+    Outputs     : fills in mixBenchPatch and mixBenchData
+    Return      :
+----------------------------------------------------------------------------*/
+static void mixBenchPatchMake(void)
+{
+    udword blockBytes = MIXBENCH_BITRATE >> 3;
+    udword size = MIXBENCH_PATCH_BLOCKS * blockBytes;
+    udword block, pos, seed = 1;
+    ubyte *data;
+
+    mixBenchData = memAlloc(size, "MixBenchPatch", NonVolatile);
+    memset(mixBenchData, 0, size);
+
+    for (block = 0; block < MIXBENCH_PATCH_BLOCKS; block++)
+    {
+        data = mixBenchData + block * blockBytes;
+        pos = 0;
+        mixBenchPack(data, &pos, 0, 2);             // left and right coded separately, exponents kept
+        mixBenchPack(data, &pos, 0, 3);             // no exponent bands, so they stay at 0
+        mixBenchPack(data, &pos, 0, 2);
+        mixBenchPack(data, &pos, 1, 4);             // coefficient steps are 1 bit
+        while (pos + 3 <= MIXBENCH_BITRATE)
+        {                                           //step to the next coefficient and give it a value
+            mixBenchPack(data, &pos, 1, 1);
+            mixBenchPack(data, &pos, mixBenchRandom(&seed), 2);
+        }
+    }
+
+    memset(&mixBenchPatch, 0, sizeof(mixBenchPatch));
+    mixBenchPatch.dataoffset = (smemsize)mixBenchData;
+    mixBenchPatch.datasize = mixBenchPatch.dataoffset + size;
+    mixBenchPatch.loopstart = mixBenchPatch.dataoffset;
+    mixBenchPatch.loopend = mixBenchPatch.datasize;
+    mixBenchPatch.bitrate = MIXBENCH_BITRATE;
+    mixBenchPatch.flags = SOUND_FLAGS_LOOPING;
+    mixBenchPatch.waveformat.frequency = FQ_RATE;
+
+    //the start of it again as a one-shot
+    mixBenchShot = mixBenchPatch;
+    mixBenchShot.datasize = mixBenchShot.dataoffset + MIXBENCH_SHOT_BLOCKS * blockBytes;
+    mixBenchShot.loopend = mixBenchShot.datasize;
+    mixBenchShot.flags = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchVoicesStart
+    Description : Starts the test sound on a number of voices, spread across
+                  the stereo field with some of them pitch shifted and all of
+                  them equalized, like ships at a distance.
+    Inputs      : nVoices - how many
+    Outputs     :
+    Return      : number of voices actually playing
+----------------------------------------------------------------------------*/
+static sdword mixBenchVoicesStart(sdword nVoices)
+{
+    real32 eq[SOUND_EQ_SIZE];
+    real32 freq;
+    sdword i, j, nPlaying = 0;
+
+    for (i = 0; i < nVoices; i++)
+    {
+        for (j = 0; j < SOUND_EQ_SIZE; j++)
+        {
+            eq[j] = 1.0f - 0.1f * (real32)((i + j) % 8);
+        }
+        freq = (i & 1) ? 1.0f : 0.85f + 0.1f * (real32)((i >> 1) & 3);
+
+        //priority above SOUND_PRIORITY_MAX so SNDgetchannel hands out every voice
+        if (splayFPRVL(&mixBenchPatch, SOUND_FLAGS_PATCHPOINTER, eq, freq,
+                       (sword)(SOUND_PAN_LEFT + (i * 37) % (SOUND_PAN_RIGHT - SOUND_PAN_LEFT)),
+                       SOUND_PRIORITY_MAX + 1, SOUND_VOL_MID, FALSE, FALSE, FALSE) != SOUND_ERR)
+        {
+            nPlaying++;
+        }
+    }
+
+    return nPlaying;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchVoicesStop
+    Description : Frees every channel straight away.
+    Inputs      :
+    Outputs     :
+    Return      : number of channels that were still playing
+----------------------------------------------------------------------------*/
+static sdword mixBenchVoicesStop(void)
+{
+    sdword i, nPlaying = 0;
+
+    for (i = 0; i < SOUND_MAX_VOICES; i++)
+    {
+        if (channels[i].status != SOUND_FREE)
+        {
+            if (channels[i].status >= SOUND_PLAYING)
+            {
+                nPlaying++;
+            }
+            SNDreleasebuffer(&channels[i]);
+        }
+    }
+
+    return nPlaying;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchTime
+    Description : Times mixing with a number of voices playing.
+    Inputs      : nVoices - how many
+                  buffer - a block of 16 bit stereo samples to mix into
+    Outputs     :
+    Return      : microseconds per block, or -1 if the voices didn't all
+                  play to the end
+----------------------------------------------------------------------------*/
+static real64 mixBenchTime(sdword nVoices, ubyte *buffer)
+{
+    sqword timeStart, timeStop;
+    udword i;
+
+    if (mixBenchVoicesStart(nVoices) != nVoices)
+    {
+        mixBenchVoicesStop();
+        return -1.0;
+    }
+
+    for (i = 0; i < MIXBENCH_WARMUP_BLOCKS; i++)
+    {
+        isoundmixerprocess(buffer, FQ_SIZE * sizeof(short), NULL, 0);
+    }
+
+    GetRawTime(&timeStart);
+    for (i = 0; i < mixBenchBlocks; i++)
+    {
+        isoundmixerprocess(buffer, FQ_SIZE * sizeof(short), NULL, 0);
+    }
+    GetRawTime(&timeStop);
+
+    if (mixBenchVoicesStop() != nVoices)
+    {
+        return -1.0;
+    }
+
+    return (real64)(timeStop - timeStart) / (real64)mixBenchBlocks;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchGunfire
+    Description : Times mixing a number of one-shot voices, starting the
+                  one-shot again on each voice as soon as it's finished, like
+                  a fleet firing its guns.  Only the mixing is timed.
+    Inputs      : nVoices - how many
+                  buffer - a block of 16 bit stereo samples to mix into
+    Outputs     :
+    Return      : microseconds per block
+----------------------------------------------------------------------------*/
+static real64 mixBenchGunfire(sdword nVoices, ubyte *buffer)
+{
+    sqword timeStart, timeStop, timeTotal = 0;
+    sdword i, j, nPlaying;
+
+    for (i = 0; i < (sdword)(MIXBENCH_WARMUP_BLOCKS + mixBenchBlocks); i++)
+    {
+        for (j = 0, nPlaying = 0; j < SOUND_MAX_VOICES; j++)
+        {
+            if (channels[j].status >= SOUND_PLAYING)
+            {
+                nPlaying++;
+            }
+        }
+        //stagger the first shots so they don't all start on the same block
+        for (; (nPlaying < nVoices) && ((i >= MIXBENCH_SHOT_BLOCKS) || (nPlaying * MIXBENCH_SHOT_BLOCKS <= i * nVoices)); nPlaying++)
+        {
+            splayFPRVL(&mixBenchShot, SOUND_FLAGS_PATCHPOINTER, NULL, 1.0f, SOUND_PAN_CENTER,
+                       SOUND_PRIORITY_MAX + 1, SOUND_VOL_MID, FALSE, FALSE, FALSE);
+        }
+
+        GetRawTime(&timeStart);
+        isoundmixerprocess(buffer, FQ_SIZE * sizeof(short), NULL, 0);
+        GetRawTime(&timeStop);
+        if (i >= MIXBENCH_WARMUP_BLOCKS)
+        {
+            timeTotal += timeStop - timeStart;
+        }
+    }
+
+    mixBenchVoicesStop();
+
+    return (real64)timeTotal / (real64)mixBenchBlocks;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchFit
+    Description : Fits a straight line through the times of the runs.
+    Inputs      : times - microseconds per block for 0, MIXBENCH_VOICE_STEP,
+                    ... voices
+    Outputs     : fixed - cost of a block with no voices
+                  perVoice - cost of each voice
+    Return      : number of voices that could be mixed in the time a block
+                  lasts
+----------------------------------------------------------------------------*/
+static real64 mixBenchFit(real64 *times, real64 *fixed, real64 *perVoice)
+{
+    real64 sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0, x;
+    sdword run;
+
+    for (run = 0; run < MIXBENCH_RUNS; run++)
+    {
+        x = (real64)(run * MIXBENCH_VOICE_STEP);
+        sumX += x;
+        sumY += times[run];
+        sumXX += x * x;
+        sumXY += x * times[run];
+    }
+    *perVoice = (MIXBENCH_RUNS * sumXY - sumX * sumY) / (MIXBENCH_RUNS * sumXX - sumX * sumX);
+    *fixed = (sumY - *perVoice * sumX) / MIXBENCH_RUNS;
+
+    if (*perVoice <= 0.0)
+    {
+        return 0.0;
+    }
+    return (FQ_SLICE * 1000.0 - *fixed) / *perVoice;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : mixBenchRun
+    Description : Mixes the test sound on 0 to SOUND_MAX_VOICES voices, with
+                  the scalar block loops and then the SSE ones, and reports
+                  how many voices the mixer could keep up with.  Then mixes
+                  every voice firing one-shots, decoding them each time and
+                  then from the decode cache.  Called from main instead of
+                  the event loop when /mixBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword mixBenchRun(void)
+{
+    real64 times[2][MIXBENCH_RUNS];
+    real64 fixed[2], perVoice[2], voices[2];
+    real64 gunfire[2];
+    udword hits, misses;
+    ubyte buffer[FQ_SIZE * sizeof(short) * 2];
+    sdword numVoicesSaved = soundnumvoices;
+    sdword vectorSaved = fqVector;
+    bool cacheSaved = mixCacheEnabled;
+    sdword nModes = fqVector ? 2 : 1;
+    sdword mode, run;
+
+    if (isoundmixerinit(NULL) != SOUND_OK)
+    {
+        printf("MixBench: couldn't start the mixer\n");
+        return -1;
+    }
+    mixBenchPatchMake();
+    soundnumvoices = SOUND_MAX_VOICES;
+
+    for (mode = 0; mode < nModes; mode++)
+    {
+        fqVector = mode;
+        for (run = 0; run < MIXBENCH_RUNS; run++)
+        {
+            times[mode][run] = mixBenchTime(run * MIXBENCH_VOICE_STEP, buffer);
+            if (times[mode][run] < 0.0)
+            {
+                printf("MixBench: %d voices didn't all keep playing\n", run * MIXBENCH_VOICE_STEP);
+                return -1;
+            }
+        }
+        voices[mode] = mixBenchFit(times[mode], &fixed[mode], &perVoice[mode]);
+    }
+    fqVector = vectorSaved;
+
+    mixCacheEnabled = FALSE;
+    gunfire[0] = mixBenchGunfire(SOUND_MAX_VOICES, buffer);
+    mixCacheEnabled = TRUE;
+    hits = mixCacheHits;
+    misses = mixCacheMisses;
+    gunfire[1] = mixBenchGunfire(SOUND_MAX_VOICES, buffer);
+    hits = mixCacheHits - hits;
+    misses = mixCacheMisses - misses;
+    mixCacheEnabled = cacheSaved;
+
+    soundnumvoices = numVoicesSaved;
+    memFree(mixBenchData);
+    mixBenchData = NULL;
+
+    printf("MixBench: %u blocks of %.2f ms per run\n", mixBenchBlocks, FQ_SLICE);
+    printf("  voices  scalar us/block%s\n", (nModes > 1) ? "  SSE us/block" : "");
+    for (run = 0; run < MIXBENCH_RUNS; run++)
+    {
+        printf("  %6d  %15.2f", run * MIXBENCH_VOICE_STEP, times[0][run]);
+        if (nModes > 1)
+        {
+            printf("  %12.2f", times[1][run]);
+        }
+        printf("\n");
+    }
+    for (mode = 0; mode < nModes; mode++)
+    {
+        printf("  %-6s %.2f us a block + %.2f us a voice, %.0f voices in real time (%d channels)\n",
+               mode ? "SSE" : "scalar", fixed[mode], perVoice[mode], voices[mode], SOUND_MAX_VOICES);
+    }
+    printf("  %d voices of %d block one-shots: %.2f us/block decoding, %.2f us/block cached (%.1f%% of blocks from the cache)\n",
+           SOUND_MAX_VOICES, MIXBENCH_SHOT_BLOCKS, gunfire[0], gunfire[1],
+           (hits + misses) ? 100.0 * (real64)hits / (real64)(hits + misses) : 0.0);
+
+    return 0;
+}
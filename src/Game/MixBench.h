@@ -0,0 +1,39 @@
+// =============================================================================
+//  MixBench.h
+//  - headless sound mixer benchmark, mixes a growing number of voices and
+//    works out how many fit in the time one block of sound lasts, then
+//    times a battle's worth of one-shots with and without the decode cache
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___MIXBENCH_H
+#define ___MIXBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define MIXBENCH_DEFAULT_BLOCKS     2000            // blocks mixed per run, about 23 seconds of sound
+#define MIXBENCH_WARMUP_BLOCKS      32              // mixed before the clock starts
+#define MIXBENCH_PATCH_BLOCKS       64              // length of the looping test sound
+#define MIXBENCH_VOICE_STEP         4               // voices added between runs
+#define MIXBENCH_SHOT_BLOCKS        24              // length of the one-shot test sound, about a gunshot
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool mixBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool mixBenchSet(char *string);
+
+sdword mixBenchRun(void);
+
+#endif
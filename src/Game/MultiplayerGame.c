@@ -6277,14 +6277,12 @@ DEFINE_TASK(mgProcessCallBacksTask)
 
         while (queueNumberEntries(mgThreadTransfer)!=0)
         {
-            LockQueue(&mgThreadTransfer);
-
             sizeofpacket = HWDequeue(&mgThreadTransfer, &packet);
             dbgAssertOrIgnore(sizeofpacket > 0);
             copypacket = memAlloc(sizeofpacket,"mg(mgthreadtransfer)", Pyrophoric);
             memcpy(copypacket, packet, sizeofpacket);
 
-            UnLockQueue(&mgThreadTransfer);
+            HWDequeueDone(&mgThreadTransfer);
 
             switch (((mgqueuegeneral *)copypacket)->packettype)
             {
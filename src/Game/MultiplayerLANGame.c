@@ -2727,15 +2727,13 @@ DEFINE_TASK(lgProcessCallBacksTask)
 
         while (queueNumberEntries(lgThreadTransfer)!=0)
         {
-            LockQueue(&lgThreadTransfer);
-
             sizeofpacket = HWDequeue(&lgThreadTransfer, &packet);
 //	    dbgMessagef("size of packet %d",sizeofpacket);
             dbgAssertOrIgnore(sizeofpacket > 0);
             copypacket = memAlloc(sizeofpacket,"lg(lgthreadtransfer)", Pyrophoric);
             memcpy(copypacket, packet, sizeofpacket);
 
-            UnLockQueue(&lgThreadTransfer);
+            HWDequeueDone(&lgThreadTransfer);
 
             switch (((lgqueuegeneral *)copypacket)->packettype)
             {
@@ -39,6 +39,7 @@
 #include "ShipDefs.h"
 #include "SoundEvent.h"
 #include "SoundEventDefs.h"
+#include "SpaceQuery.h"
 #include "StringSupport.h"
 #include "Tracking.h"
 #include "Universe.h"
@@ -1518,6 +1519,7 @@ void nisSeek(nisplaying *NIS, real32 seekTime)
             bitClear(path->flags, OMF_ObjectDied);
         }
     }
+    spqSetDirty(SPQ_Ships);                                 //objects have all jumped to their seek positions
     //reset all the camera motion paths
     for (index = 0; index < NIS->header->nCameraPaths; index++)
     {
@@ -1832,6 +1834,7 @@ real32 nisUpdate(nisplaying *NIS, real32 timeElapsed)
         if (path->spaceobj->objtype == OBJ_ShipType &&
             getVectDistSloppy(tempVect) >= NIS_JumpDistance)
         {
+            spqSetDirty(SPQ_Ships);                         //don't find it back where it jumped from
             for (j = 0; j < MAX_NUM_TRAILS; j++)
             {
                 if (((Ship*)path->spaceobj)->trail[j] != NULL)
@@ -31,6 +31,7 @@
 #include "AutoLOD.h"
 #include "Shader.h"
 #include "devstats.h"
+#include "SSE.h"
 
 #if defined _MSC_VER
 	#define isnan(x) _isnan(x)
@@ -47,10 +48,35 @@ extern unsigned int gDevcaps;
 
 #define MIN2(a,b) ((a) < (b) ? (a) : (b))
 
+#define PART_KIN_BATCH  256                     //packed kinematics arrays grow by this many particles
+
 /*=============================================================================
     Data:
 =============================================================================*/
 
+//packed copies of the moving particles' positions and velocities.
+//partUpdateSystem gathers them from the records, steps them all together
+//and writes them back.  World space particles use the w arrays, local
+//ones the r and LOF ones.  Padded to a multiple of 4 for the SSE loops.
+static udword partKinCapacity = 0;
+static udword *partKinIndex = NULL;             //record each entry came from
+static real32 *partKinX = NULL;                 //position
+static real32 *partKinY = NULL;
+static real32 *partKinZ = NULL;
+static real32 *partKinWVelX = NULL;             //world space velocity
+static real32 *partKinWVelY = NULL;
+static real32 *partKinWVelZ = NULL;
+static real32 *partKinWAccelX = NULL;           //world space acceleration
+static real32 *partKinWAccelY = NULL;
+static real32 *partKinWAccelZ = NULL;
+static real32 *partKinRX = NULL;                //local radial direction
+static real32 *partKinRY = NULL;
+static real32 *partKinRZ = NULL;
+static real32 *partKinVelLOF = NULL;            //local speeds and their deltas
+static real32 *partKinVelR = NULL;
+static real32 *partKinDeltaVelLOF = NULL;
+static real32 *partKinDeltaVelR = NULL;
+
 static sdword alternateIndex = 0;
 typedef struct alternate_s
 {
@@ -313,6 +339,14 @@ void partFreeAlternates(void)
 void partShutdown(void)
 {
     partFreeAlternates();
+    if (partKinIndex != NULL)
+    {
+        memFree(partKinIndex);
+        memFree(partKinX);
+        partKinIndex = NULL;
+        partKinX = NULL;
+    }
+    partKinCapacity = 0;
 }
 
 /*-----------------------------------------------------------------------------
@@ -1806,6 +1840,40 @@ void partColorDistA(real32 *out, real32 *c, real32 dr, real32 dg, real32 db, rea
     out[3] = ca;
 }
 
+#if HW_SSE
+/*-----------------------------------------------------------------------------
+    Name        : partColorDeltaSSE
+    Description : partColorDelta for all four channels at once.  Channels with
+                  no delta, and alpha unless alphaMask enables it, are left
+                  exactly as they were.
+    Inputs      : c - colour to update
+                  d - colour delta
+                  dt4 - elapsed time in all four lanes
+                  alphaMask - lanes to update, from partColorMask
+    Outputs     : c is updated and clamped to 0..1
+    Return      :
+----------------------------------------------------------------------------*/
+static void partColorDeltaSSE(real32 *c, real32 *d, __m128 dt4, __m128 alphaMask)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 color = _mm_loadu_ps(c);
+    __m128 delta = _mm_loadu_ps(d);
+    __m128 update = _mm_and_ps(_mm_cmpneq_ps(delta, zero), alphaMask);
+    __m128 result;
+
+    result = _mm_add_ps(color, _mm_mul_ps(delta, dt4));
+    result = _mm_min_ps(_mm_max_ps(result, zero), _mm_set1_ps(1.0f));
+    result = _mm_or_ps(_mm_and_ps(update, result), _mm_andnot_ps(update, color));
+    _mm_storeu_ps(c, result);
+}
+
+//lane mask for partColorDeltaSSE: r, g, b always and alpha if asked for
+static __m128 partColorMask(bool alpha)
+{
+    return _mm_cmpneq_ps(_mm_set_ps(alpha ? 1.0f : 0.0f, 1.0f, 1.0f, 1.0f), _mm_setzero_ps());
+}
+#endif
+
 real32 fracPart(real32 f)
 {
     sdword i = (sdword)f;
@@ -2151,9 +2219,265 @@ void partUpdateAnimation(billSystem* bsys, particle* part, real32 dt)
     partSetTexFromAnimation((psysPtr)bsys, part);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : partKinGrow
+    Description : makes room in the packed kinematics arrays
+    Inputs      : number - particles to make room for, a multiple of 4
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void partKinGrow(udword number)
+{
+    number = (number + PART_KIN_BATCH - 1) / PART_KIN_BATCH * PART_KIN_BATCH;
+    if (number <= partKinCapacity)
+    {
+        return;
+    }
+
+    if (partKinIndex != NULL)
+    {
+        memFree(partKinIndex);
+        memFree(partKinX);
+    }
+    partKinCapacity = number;
+    partKinIndex = memAlloc(sizeof(udword) * number, "PartKinIndex", NonVolatile);
+    partKinX = memAlloc(sizeof(real32) * number * 16, "PartKinArrays", NonVolatile);
+    partKinY = partKinX + number;
+    partKinZ = partKinY + number;
+    partKinWVelX = partKinZ + number;
+    partKinWVelY = partKinWVelX + number;
+    partKinWVelZ = partKinWVelY + number;
+    partKinWAccelX = partKinWVelZ + number;
+    partKinWAccelY = partKinWAccelX + number;
+    partKinWAccelZ = partKinWAccelY + number;
+    partKinRX = partKinWAccelZ + number;
+    partKinRY = partKinRX + number;
+    partKinRZ = partKinRY + number;
+    partKinVelLOF = partKinRZ + number;
+    partKinVelR = partKinVelLOF + number;
+    partKinDeltaVelLOF = partKinVelR + number;
+    partKinDeltaVelR = partKinDeltaVelLOF + number;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : partKinStepWorldspace
+    Description : steps world space particles in the packed arrays.  Same
+                  operations in the same order as the old per-record code,
+                  so the results don't change.
+    Inputs      : n - number of particles
+                  dt - elapsed time
+                  drag - system drag
+    Outputs     : position, velocity and acceleration arrays are updated
+    Return      :
+----------------------------------------------------------------------------*/
+static void partKinStepWorldspace(udword n, real32 dt, real32 drag)
+{
+    udword i;
+#if HW_SSE
+    __m128 dt4 = _mm_set1_ps(dt), drag4 = _mm_set1_ps(drag);
+    __m128 ax, ay, az, vx, vy, vz;
+
+    for (i = 0; i < n; i += 4)
+    {
+        ax = _mm_mul_ps(_mm_loadu_ps(partKinWAccelX + i), dt4);
+        ay = _mm_mul_ps(_mm_loadu_ps(partKinWAccelY + i), dt4);
+        az = _mm_mul_ps(_mm_loadu_ps(partKinWAccelZ + i), dt4);
+        vx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(partKinWVelX + i), dt4), ax);
+        vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(partKinWVelY + i), dt4), ay);
+        vz = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(partKinWVelZ + i), dt4), az);
+
+        _mm_storeu_ps(partKinX + i, _mm_add_ps(_mm_loadu_ps(partKinX + i), vx));
+        _mm_storeu_ps(partKinY + i, _mm_add_ps(_mm_loadu_ps(partKinY + i), vy));
+        _mm_storeu_ps(partKinZ + i, _mm_add_ps(_mm_loadu_ps(partKinZ + i), vz));
+        _mm_storeu_ps(partKinWVelX + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(partKinWVelX + i), ax), drag4));
+        _mm_storeu_ps(partKinWVelY + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(partKinWVelY + i), ay), drag4));
+        _mm_storeu_ps(partKinWVelZ + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(partKinWVelZ + i), az), drag4));
+        _mm_storeu_ps(partKinWAccelX + i, _mm_mul_ps(_mm_loadu_ps(partKinWAccelX + i), drag4));
+        _mm_storeu_ps(partKinWAccelY + i, _mm_mul_ps(_mm_loadu_ps(partKinWAccelY + i), drag4));
+        _mm_storeu_ps(partKinWAccelZ + i, _mm_mul_ps(_mm_loadu_ps(partKinWAccelZ + i), drag4));
+    }
+#else
+    real32 ax, ay, az;
+
+    for (i = 0; i < n; i++)
+    {
+        ax = partKinWAccelX[i] * dt;
+        ay = partKinWAccelY[i] * dt;
+        az = partKinWAccelZ[i] * dt;
+        partKinX[i] += partKinWVelX[i] * dt + ax;
+        partKinY[i] += partKinWVelY[i] * dt + ay;
+        partKinZ[i] += partKinWVelZ[i] * dt + az;
+        partKinWVelX[i] = (partKinWVelX[i] + ax) * drag;
+        partKinWVelY[i] = (partKinWVelY[i] + ay) * drag;
+        partKinWVelZ[i] = (partKinWVelZ[i] + az) * drag;
+        partKinWAccelX[i] *= drag;
+        partKinWAccelY[i] *= drag;
+        partKinWAccelZ[i] *= drag;
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : partKinStepLocal
+    Description : steps local space particles in the packed arrays, in the
+                  same order as the old per-record code
+    Inputs      : n - number of particles
+                  dt - elapsed time
+                  drag - system drag, only applied if draggin
+    Outputs     : position and speed arrays are updated
+    Return      :
+----------------------------------------------------------------------------*/
+static void partKinStepLocal(udword n, real32 dt, real32 drag, bool draggin)
+{
+    udword i;
+#if HW_SSE
+    __m128 dt4 = _mm_set1_ps(dt), drag4 = _mm_set1_ps(drag);
+    __m128 r, z, velLOF, velR;
+
+    for (i = 0; i < n; i += 4)
+    {
+        velLOF = _mm_loadu_ps(partKinVelLOF + i);
+        velR = _mm_loadu_ps(partKinVelR + i);
+
+        r = _mm_mul_ps(dt4, velR);
+        z = _mm_add_ps(_mm_loadu_ps(partKinZ + i), _mm_mul_ps(dt4, velLOF));
+        _mm_storeu_ps(partKinX + i, _mm_add_ps(_mm_loadu_ps(partKinX + i), _mm_mul_ps(_mm_loadu_ps(partKinRX + i), r)));
+        _mm_storeu_ps(partKinY + i, _mm_add_ps(_mm_loadu_ps(partKinY + i), _mm_mul_ps(_mm_loadu_ps(partKinRY + i), r)));
+        _mm_storeu_ps(partKinZ + i, _mm_add_ps(z, _mm_mul_ps(_mm_loadu_ps(partKinRZ + i), r)));
+
+        velLOF = _mm_add_ps(velLOF, _mm_mul_ps(dt4, _mm_loadu_ps(partKinDeltaVelLOF + i)));
+        velR = _mm_add_ps(velR, _mm_mul_ps(dt4, _mm_loadu_ps(partKinDeltaVelR + i)));
+        if (draggin)
+        {
+            velLOF = _mm_mul_ps(velLOF, drag4);
+            velR = _mm_mul_ps(velR, drag4);
+        }
+        _mm_storeu_ps(partKinVelLOF + i, velLOF);
+        _mm_storeu_ps(partKinVelR + i, velR);
+    }
+#else
+    real32 r;
+
+    for (i = 0; i < n; i++)
+    {
+        r = dt * partKinVelR[i];
+        partKinZ[i] += dt * partKinVelLOF[i];
+        partKinX[i] += partKinRX[i] * r;
+        partKinY[i] += partKinRY[i] * r;
+        partKinZ[i] += partKinRZ[i] * r;
+
+        partKinVelLOF[i] += dt * partKinDeltaVelLOF[i];
+        partKinVelR[i] += dt * partKinDeltaVelR[i];
+        if (draggin)
+        {
+            partKinVelLOF[i] *= drag;
+            partKinVelR[i] *= drag;
+        }
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : partKinUpdate
+    Description : moves the particles partUpdateSystem picked out: copies
+                  their positions and velocities into the packed arrays,
+                  steps them all at once and copies them back
+    Inputs      : p - first particle record of the system
+                  n - number of particles picked, in partKinIndex
+                  isWorldspace, dt, drag, draggin - as in partUpdateSystem
+    Outputs     : the picked particle records are moved
+    Return      :
+----------------------------------------------------------------------------*/
+static void partKinUpdate(particle *p, udword n, bool isWorldspace, real32 dt, real32 drag, bool draggin)
+{
+    udword i, padded = (n + 3) & ~3;
+    particle *part;
+
+    if (isWorldspace)
+    {
+        for (i = 0; i < n; i++)
+        {
+            part = &p[partKinIndex[i]];
+            partKinX[i] = part->position.x;
+            partKinY[i] = part->position.y;
+            partKinZ[i] = part->position.z;
+            partKinWVelX[i] = part->wVel.x;
+            partKinWVelY[i] = part->wVel.y;
+            partKinWVelZ[i] = part->wVel.z;
+            partKinWAccelX[i] = part->wAccel.x;
+            partKinWAccelY[i] = part->wAccel.y;
+            partKinWAccelZ[i] = part->wAccel.z;
+        }
+        for (; i < padded; i++)
+        {
+            partKinX[i] = partKinY[i] = partKinZ[i] = 0.0f;
+            partKinWVelX[i] = partKinWVelY[i] = partKinWVelZ[i] = 0.0f;
+            partKinWAccelX[i] = partKinWAccelY[i] = partKinWAccelZ[i] = 0.0f;
+        }
+
+        partKinStepWorldspace(n, dt, drag);
+
+        for (i = 0; i < n; i++)
+        {
+            part = &p[partKinIndex[i]];
+            part->position.x = partKinX[i];
+            part->position.y = partKinY[i];
+            part->position.z = partKinZ[i];
+            part->wVel.x = partKinWVelX[i];
+            part->wVel.y = partKinWVelY[i];
+            part->wVel.z = partKinWVelZ[i];
+            part->wAccel.x = partKinWAccelX[i];
+            part->wAccel.y = partKinWAccelY[i];
+            part->wAccel.z = partKinWAccelZ[i];
+        }
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+        {
+            part = &p[partKinIndex[i]];
+            partKinX[i] = part->position.x;
+            partKinY[i] = part->position.y;
+            partKinZ[i] = part->position.z;
+            partKinRX[i] = part->rvec.x;
+            partKinRY[i] = part->rvec.y;
+            partKinRZ[i] = part->rvec.z;
+            partKinVelLOF[i] = part->velLOF;
+            partKinVelR[i] = part->velR;
+            partKinDeltaVelLOF[i] = part->deltaVelLOF;
+            partKinDeltaVelR[i] = part->deltaVelR;
+        }
+        for (; i < padded; i++)
+        {
+            partKinX[i] = partKinY[i] = partKinZ[i] = 0.0f;
+            partKinRX[i] = partKinRY[i] = partKinRZ[i] = 0.0f;
+            partKinVelLOF[i] = partKinVelR[i] = 0.0f;
+            partKinDeltaVelLOF[i] = partKinDeltaVelR[i] = 0.0f;
+        }
+
+        partKinStepLocal(n, dt, drag, draggin);
+
+        for (i = 0; i < n; i++)
+        {
+            part = &p[partKinIndex[i]];
+            part->position.x = partKinX[i];
+            part->position.y = partKinY[i];
+            part->position.z = partKinZ[i];
+            part->velLOF = partKinVelLOF[i];
+            part->velR = partKinVelR[i];
+        }
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : partUpdateSystem
-    Description : ticks a particle system by given elapsed time
+    Description : ticks a particle system by given elapsed time.  Most
+                  of each particle is updated in its record, with the colour
+                  step in SSE.  Positions and velocities of the particles
+                  that move are stepped afterwards in packed arrays by
+                  partKinUpdate.  The records stay interleaved and
+                  memAlloc'ed with their system, since the renderers, ETG
+                  and the partModify functions all work on them in place.
     Inputs      : psys - particle system pointer
                   dt - elapsed time since last call
                   velvec - velocity vector to be added to velLOF
@@ -2164,10 +2488,13 @@ void partUpdateAnimation(billSystem* bsys, particle* part, real32 dt)
 bool8 partUpdateSystem(psysPtr psys, real32 dt, vector* velvec)
 {
     billSystem *pp;
-    particle *p = NULL;
-    udword n, i, hits;
-    vector rvec;
-    bool draggin;
+    particle *p = NULL, *first;
+    udword n, i, hits, nMoving = 0;
+    real32 drag;
+    bool draggin, isMesh, isWorldspace, alpha;
+#if HW_SSE
+    __m128 dt4, alphaMask;
+#endif
 
     pp = (billSystem*)psys;      //default assumption
     n = pp->n;
@@ -2184,12 +2511,23 @@ bool8 partUpdateSystem(psysPtr psys, real32 dt, vector* velvec)
         return TRUE;
     }
 
-    draggin = (pp->drag != 1.0f);
+    //system-wide tests, done once instead of per particle
+    drag = pp->drag;
+    draggin = (drag != 1.0f);
+    isMesh = (pp->t == PART_MESH);
+    isWorldspace = (bool)bitTest(pp->flags, PART_WORLDSPACE);
+    alpha = (bool)bitTest(pp->flags, PART_ALPHA);
+#if HW_SSE
+    dt4 = _mm_set1_ps(dt);
+    alphaMask = partColorMask(alpha);
+#endif
+    partKinGrow((n + 3) & ~3);
+    first = p;
 
     for (i = hits = 0; i < n; i++, p++)
     {
         //mesh tumble specifics
-        if (pp->t == PART_MESH)
+        if (isMesh)
         {
             p->tumble[0] += dt * p->deltaTumble[0];
             p->tumble[1] += dt * p->deltaTumble[1];
@@ -2231,45 +2569,11 @@ bool8 partUpdateSystem(psysPtr psys, real32 dt, vector* velvec)
             }
         }
 
-        //kinematics
-        if (bitTest(pp->flags, PART_WORLDSPACE))
+        //kinematics, done for all of them by partKinUpdate.  Don't update
+        //position if XYZ scaling (hyperspace effect).
+        if (!isWorldspace || !bitTest(p->flags, PART_XYZSCALE))
         {
-            vector adjWVel, adjWAccel;
-
-            //don't update position if XYZ scaling (hyperspace effect)
-            if (!bitTest(p->flags, PART_XYZSCALE))
-            {
-                //setup
-                adjWVel = p->wVel;
-                adjWAccel = p->wAccel;
-                vecMultiplyByScalar(adjWVel, dt);
-                vecMultiplyByScalar(adjWAccel, dt);
-                //velocity
-                vecAddTo(adjWVel, adjWAccel);
-                //update
-                vecAddTo(p->position, adjWVel);
-                vecAddTo(p->wVel, adjWAccel);
-                //drag
-                vecMultiplyByScalar(p->wVel, pp->drag);
-                vecMultiplyByScalar(p->wAccel, pp->drag);
-            }
-        }
-        else
-        {
-            //position
-            p->position.z += dt * p->velLOF;
-            rvec = p->rvec;
-            vecMultiplyByScalar(rvec, dt * p->velR);
-            vecAddTo(p->position, rvec);
-
-            //velocity
-            p->velLOF += dt * p->deltaVelLOF;
-            p->velR += dt * p->deltaVelR;
-            if (draggin)
-            {
-                p->velLOF *= pp->drag;
-                p->velR *= pp->drag;
-            }
+            partKinIndex[nMoving++] = i;
         }
 
         //appearance
@@ -2282,13 +2586,20 @@ bool8 partUpdateSystem(psysPtr psys, real32 dt, vector* velvec)
             }
         }
 
-        partColorDelta(p->icolor, p->deltaColor, pp->flags, dt);
+#if HW_SSE
+        partColorDeltaSSE(p->icolor, p->deltaColor, dt4, alphaMask);
+#else
+        partColorDelta(p->icolor, p->deltaColor, alpha ? PART_ALPHA : 0, dt);
+#endif
 
         //FIXME: does this make sense?
-        if (p->icolor[3] < 1.0f)
-        {
-            pointSystem* sys = (pointSystem*)psys;
-            bitSet(sys->flags, PART_ALPHA);
+        if (p->icolor[3] < 1.0f && !alpha)
+        {                                                   //the rest of the particles fade alpha too
+            bitSet(pp->flags, PART_ALPHA);
+            alpha = TRUE;
+#if HW_SSE
+            alphaMask = partColorMask(alpha);
+#endif
         }
 
         if (p->lit)
@@ -2305,6 +2616,11 @@ bool8 partUpdateSystem(psysPtr psys, real32 dt, vector* velvec)
         }
     }
 
+    if (nMoving != 0)
+    {
+        partKinUpdate(first, nMoving, isWorldspace, dt, drag, draggin);
+    }
+
     return((bool8)((hits == 0) ? TRUE : FALSE));
 }
 
@@ -0,0 +1,148 @@
+// =============================================================================
+//  ParticleBench.c
+//  - headless particle update benchmark, spawns a number of particle systems
+//    and times partUpdateSystem on them
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "ParticleBench.h"
+
+#include <stdio.h>
+
+#include "main.h"
+#include "Matrix.h"
+#include "Memory.h"
+#include "Particle.h"
+#include "SSE.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool partBenchEnabled = FALSE;
+static udword partBenchSystems = PARTBENCH_DEFAULT_SYSTEMS;
+
+//a mix of the system types effects create, roughly as often as they do
+static particleType partBenchType[] =
+{
+    PART_BILLBOARD, PART_BILLBOARD, PART_BILLBOARD, PART_MESH, PART_LINES, PART_POINTS
+};
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : partBenchSet
+    Description : Command-line handler for /particleBench <nSystems>
+    Inputs      : string - number of particle systems to update
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool partBenchSet(char *string)
+{
+    sscanf(string, "%u", &partBenchSystems);
+    if (partBenchSystems == 0)
+    {
+        partBenchSystems = PARTBENCH_DEFAULT_SYSTEMS;
+    }
+    partBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : partBenchCreate
+    Description : Creates one explosion-like particle system: moving, fading,
+                  growing particles, half of them in world space.
+    Inputs      : index - which system this is, picks the type
+    Outputs     :
+    Return      : the new system
+----------------------------------------------------------------------------*/
+static psysPtr partBenchCreate(udword index)
+{
+    vector origin = {0.0f, 0.0f, 0.0f};
+    matrix coordsys = IdentityMatrix;
+    psysPtr psys;
+
+    partSetDefaults();
+    partSetCoordSys(&coordsys);
+    partSetPosition(&origin);
+    partSetWorldVel(&origin);
+    partSetIsWorldspace((bool8)(index & 1));
+    partSetOffsetR(10.0f);
+    partSetVelLOF(50.0f);
+    partSetVelLOFDist(25.0f);
+    partSetVelR(200.0f);
+    partSetDeltaVelLOF(-5.0f);
+    partSetDrag(0.99f);
+    partSetScale(5.0f);
+    partSetScaleDist(2.0f);
+    partSetDeltaScale(10.0f);
+    partSetColorA(1.0f, 0.8f, 0.4f, 1.0f);
+    partSetDeltaColorA(-0.2f, -0.3f, -0.4f, -0.25f);
+    partSetLighting(TRUE);
+    partSetIllum(1.0f);
+    partSetDeltaIllum(-0.1f);
+    partSetLifespan(1000.0f);                               //stay alive for the whole run
+
+    psys = partCreateSystem(partBenchType[index % (sizeof(partBenchType) / sizeof(partBenchType[0]))], PARTBENCH_PARTICLES);
+    partSetDefaults();
+    return psys;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : partBenchRun
+    Description : Spawns the particle systems and updates all of them
+                  PARTBENCH_FRAMES times, with no rendering.  Called from
+                  main instead of the event loop when /particleBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword partBenchRun(void)
+{
+    psysPtr *systems;
+    vector velocity = {0.0f, 0.0f, 0.0f};
+    sqword timeStart, timeStop;
+    udword index, frame, nDead = 0;
+    real64 seconds, nParticles;
+
+    systems = memAlloc(sizeof(psysPtr) * partBenchSystems, "PartBenchSystems", NonVolatile);
+    for (index = 0; index < partBenchSystems; index++)
+    {
+        systems[index] = partBenchCreate(index);
+    }
+
+    GetRawTime(&timeStart);
+    for (frame = 0; frame < PARTBENCH_FRAMES; frame++)
+    {
+        for (index = 0; index < partBenchSystems; index++)
+        {
+            nDead += partUpdateSystem(systems[index], UNIVERSE_UPDATE_PERIOD, &velocity);
+        }
+    }
+    GetRawTime(&timeStop);
+
+    seconds = (real64)(timeStop - timeStart) / 1000000.0;
+    nParticles = (real64)partBenchSystems * PARTBENCH_PARTICLES * PARTBENCH_FRAMES;
+    printf("ParticleBench: %u systems of %u particles, %u updates, packed kinematics and colours with %s\n",
+           partBenchSystems, PARTBENCH_PARTICLES, PARTBENCH_FRAMES, HW_SSE ? "SSE" : "plain C");
+    printf("  %.3f s, %.3f ms/frame, %.1f ns/particle\n",
+           seconds, seconds * 1000.0 / PARTBENCH_FRAMES, (nParticles > 0.0) ? seconds * 1.0e9 / nParticles : 0.0);
+    if (nDead != 0)
+    {
+        printf("  (%u system updates found the system dead)\n", nDead);
+    }
+
+    for (index = 0; index < partBenchSystems; index++)
+    {
+        memFree(systems[index]);
+    }
+    memFree(systems);
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+// =============================================================================
+//  ParticleBench.h
+//  - headless particle update benchmark, spawns a number of particle systems
+//    and times partUpdateSystem on them
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___PARTICLEBENCH_H
+#define ___PARTICLEBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define PARTBENCH_DEFAULT_SYSTEMS   1000
+#define PARTBENCH_PARTICLES         64              // particles per system
+#define PARTBENCH_FRAMES            300             // updates of every system
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool partBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool partBenchSet(char *string);
+
+sdword partBenchRun(void);
+
+#endif
@@ -0,0 +1,621 @@
+// =============================================================================
+//  Prefetch.c
+//  - background streaming of bigfile contents during level loads
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "Prefetch.h"
+
+#include <string.h>
+
+#include <SDL.h>
+
+#include "Debug.h"
+#include "Memory.h"
+#include "ProfileTimers.h"
+#include "Queue.h"
+#include "TimeoutTimer.h"
+
+extern bool IgnoreBigfiles;
+
+/*=============================================================================
+    Overview:
+
+    Loaders that know ahead of time what they are going to read (the
+    texture registry, the LOD tables) call pfRequest for each file.  The
+    main thread allocates a buffer for a request once it fits in the
+    PF_MaxBytes budget and hands it to the worker pool, which reads and
+    expands the data with bigFileLoadConcurrent.  Finished jobs come back
+    through pfDoneQueue.  When the loader later gets to the file,
+    fileLoadAlloc or fileOpen calls pfClaim and takes the buffer over
+    instead of reading the bigfile itself; anything that isn't ready is
+    either waited for (already with a worker) or loaded the normal way.
+
+    Only the main thread touches the job table and the memory module; the
+    workers see nothing but the job they were given.
+=============================================================================*/
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define PF_Free                 0
+#define PF_Pending              1               // waiting for a buffer
+#define PF_Queued               2               // with the workers
+#define PF_Done                 3               // back from the workers
+#define PF_Cancelled            4               // claimed while still pending
+
+#define pfHash(b, n)            ((((udword)(size_t)(b) >> 4) ^ ((n) * 2654435761u)) & (PF_HashSize - 1))
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+typedef struct
+{
+    bigFileConfiguration *bigFile;
+    udword fileNum;
+    udword flags;
+    udword state;
+    sdword length;
+    sdword result;                              // written by the worker
+    void *buffer;
+    sdword nextHash;
+    sdword nextList;                            // pending or free list
+    char memoryName[MEM_NameLength];
+}
+pfjob;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool pfEnabled = TRUE;
+pfstats pfStats;
+
+static pfjob pfJobs[PF_MaxJobs];
+static sdword pfHashTable[PF_HashSize];
+static sdword pfFreeList = -1;
+static sdword pfPendingHead = -1;
+static sdword pfPendingTail = -1;
+static udword pfNumQueued = 0;
+static sdword pfBytesOutstanding = 0;
+
+//work ring, main thread to workers
+static sdword pfWorkRing[PF_MaxJobs];
+static udword pfWorkHead = 0;
+static udword pfWorkTail = 0;
+static udword pfWorkCount = 0;
+static bool pfQuit = FALSE;
+static SDL_mutex *pfWorkMutex = NULL;
+static SDL_cond *pfWorkCond = NULL;
+
+//completions, workers to main thread
+static Queue pfDoneQueue;
+static SDL_sem *pfDoneSem = NULL;
+
+static SDL_Thread *pfWorkers[PF_MaxWorkers];
+static udword pfNumWorkers = 0;
+
+/*=============================================================================
+    Private functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : pfWorker
+    Description : Worker thread: loads jobs from the work ring until told to
+                  quit.
+    Inputs      : data - unused
+    Outputs     :
+    Return      : 0
+----------------------------------------------------------------------------*/
+static int pfWorker(void *data)
+{
+    sdword index;
+    pfjob *job;
+
+    (void)data;
+    profTraceThreadName("prefetch");
+
+    for (;;)
+    {
+        dbgAssertAlwaysDo(SDL_mutexP(pfWorkMutex) != -1);
+        while (pfWorkCount == 0 && !pfQuit)
+        {
+            SDL_CondWait(pfWorkCond, pfWorkMutex);
+        }
+        if (pfQuit)
+        {
+            dbgAssertAlwaysDo(SDL_mutexV(pfWorkMutex) != -1);
+            break;
+        }
+        index = pfWorkRing[pfWorkTail];
+        pfWorkTail = (pfWorkTail + 1) % PF_MaxJobs;
+        pfWorkCount--;
+        dbgAssertAlwaysDo(SDL_mutexV(pfWorkMutex) != -1);
+
+        job = &pfJobs[index];
+        PTSCOPE("prefetch load");
+        job->result = bigFileLoadConcurrent(job->bigFile, job->fileNum, job->buffer);
+        PTSCOPEEND();
+
+        LockQueue(&pfDoneQueue);
+        HWEnqueue(&pfDoneQueue, (ubyte *)&index, sizeof(index));
+        UnLockQueue(&pfDoneQueue);
+        SDL_SemPost(pfDoneSem);
+    }
+    profTraceThreadRelease();
+    return 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfJobFind
+    Description : Looks up the job for a bigfile entry.
+    Inputs      : bigFile, fileNum - the entry
+    Outputs     :
+    Return      : job index or -1
+----------------------------------------------------------------------------*/
+static sdword pfJobFind(bigFileConfiguration *bigFile, udword fileNum)
+{
+    sdword index;
+
+    for (index = pfHashTable[pfHash(bigFile, fileNum)]; index != -1; index = pfJobs[index].nextHash)
+    {
+        if (pfJobs[index].bigFile == bigFile && pfJobs[index].fileNum == fileNum)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfJobUnhash
+    Description : Removes a job from the lookup table.
+    Inputs      : index - job to remove
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void pfJobUnhash(sdword index)
+{
+    sdword *link = &pfHashTable[pfHash(pfJobs[index].bigFile, pfJobs[index].fileNum)];
+
+    while (*link != index)
+    {
+        dbgAssertOrIgnore(*link != -1);
+        link = &pfJobs[*link].nextHash;
+    }
+    *link = pfJobs[index].nextHash;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfJobFree
+    Description : Returns a job to the free list.
+    Inputs      : index - job, already unhashed and off the pending list
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void pfJobFree(sdword index)
+{
+    pfJobs[index].state = PF_Free;
+    pfJobs[index].buffer = NULL;
+    pfJobs[index].nextList = pfFreeList;
+    pfFreeList = index;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfIssue
+    Description : Allocates buffers for pending jobs, in request order, and
+                  hands them to the workers until the byte budget or the
+                  heap runs out.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void pfIssue(void)
+{
+    sdword index;
+    pfjob *job;
+
+    while (pfPendingHead != -1)
+    {
+        index = pfPendingHead;
+        job = &pfJobs[index];
+
+        if (job->state == PF_Pending)
+        {
+            if (pfBytesOutstanding > 0 && pfBytesOutstanding + job->length > PF_MaxBytes)
+            {
+                break;
+            }
+            job->buffer = memAllocAttempt(job->length, job->memoryName,
+                                          job->flags == PF_Open ? 0 : NonVolatile | MBF_String);
+            if (job->buffer == NULL)
+            {
+                break;
+            }
+        }
+
+        pfPendingHead = job->nextList;
+        if (pfPendingHead == -1)
+        {
+            pfPendingTail = -1;
+        }
+
+        if (job->state == PF_Cancelled)
+        {
+            pfJobFree(index);
+            continue;
+        }
+
+        job->state = PF_Queued;
+        pfBytesOutstanding += job->length;
+        pfNumQueued++;
+
+        dbgAssertAlwaysDo(SDL_mutexP(pfWorkMutex) != -1);
+        dbgAssertOrIgnore(pfWorkCount < PF_MaxJobs);
+        pfWorkRing[pfWorkHead] = index;
+        pfWorkHead = (pfWorkHead + 1) % PF_MaxJobs;
+        pfWorkCount++;
+        SDL_CondSignal(pfWorkCond);
+        dbgAssertAlwaysDo(SDL_mutexV(pfWorkMutex) != -1);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfDrain
+    Description : Takes one finished job off the completion queue.
+    Inputs      : wait - block until a job finishes
+    Outputs     : marks the job done
+    Return      : TRUE if a job was taken
+----------------------------------------------------------------------------*/
+static bool pfDrain(bool wait)
+{
+    ubyte *packet;
+    sdword index;
+
+    if (wait)
+    {
+        SDL_SemWait(pfDoneSem);
+    }
+    else if (SDL_SemTryWait(pfDoneSem) != 0)
+    {
+        return FALSE;
+    }
+
+    dbgAssertAlwaysDo(HWDequeue(&pfDoneQueue, &packet) == sizeof(sdword));
+    memcpy(&index, packet, sizeof(index));
+    HWDequeueDone(&pfDoneQueue);
+
+    dbgAssertOrIgnore(pfJobs[index].state == PF_Queued);
+    pfJobs[index].state = PF_Done;
+    pfNumQueued--;
+    return TRUE;
+}
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : pfStartup
+    Description : Starts the prefetch worker pool, one thread per spare CPU
+                  up to PF_MaxWorkers.  Call after the bigfiles are open.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void pfStartup(void)
+{
+    sdword index, nWorkers;
+
+    if (!pfEnabled || IgnoreBigfiles)
+    {
+        return;
+    }
+
+    for (index = 0; index < PF_HashSize; index++)
+    {
+        pfHashTable[index] = -1;
+    }
+    pfFreeList = -1;
+    for (index = PF_MaxJobs - 1; index >= 0; index--)
+    {
+        pfJobFree(index);
+    }
+    pfPendingHead = pfPendingTail = -1;
+    pfNumQueued = 0;
+    pfBytesOutstanding = 0;
+    pfWorkHead = pfWorkTail = pfWorkCount = 0;
+    pfQuit = FALSE;
+    pfStatsReset();
+
+    pfWorkMutex = SDL_CreateMutex();
+    pfWorkCond = SDL_CreateCond();
+    pfDoneSem = SDL_CreateSemaphore(0);
+    dbgAssertOrIgnore(pfWorkMutex != NULL && pfWorkCond != NULL && pfDoneSem != NULL);
+    //room for every job twice over, so the completion queue can't overrun
+    InitQueue(&pfDoneQueue, PF_MaxJobs * 2 * (sizeof(udword) + sizeof(sdword)));
+
+    nWorkers = min(max(SDL_GetCPUCount() - 1, 1), PF_MaxWorkers);
+    for (pfNumWorkers = 0; pfNumWorkers < (udword)nWorkers; pfNumWorkers++)
+    {
+        pfWorkers[pfNumWorkers] = SDL_CreateThread(pfWorker, "prefetch", NULL);
+        if (pfWorkers[pfNumWorkers] == NULL)
+        {
+            break;
+        }
+    }
+    dbgMessagef("pfStartup: %d prefetch workers", pfNumWorkers);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfShutdown
+    Description : Stops the worker pool and frees anything not claimed.  Call
+                  before the bigfiles are closed.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void pfShutdown(void)
+{
+    udword index;
+
+    if (pfNumWorkers == 0)
+    {
+        return;
+    }
+
+    pfFlush();
+
+    dbgAssertAlwaysDo(SDL_mutexP(pfWorkMutex) != -1);
+    pfQuit = TRUE;
+    SDL_CondBroadcast(pfWorkCond);
+    dbgAssertAlwaysDo(SDL_mutexV(pfWorkMutex) != -1);
+
+    for (index = 0; index < pfNumWorkers; index++)
+    {
+        SDL_WaitThread(pfWorkers[index], NULL);
+    }
+    pfNumWorkers = 0;
+
+    CloseQueue(&pfDoneQueue);
+    SDL_DestroySemaphore(pfDoneSem);
+    SDL_DestroyCond(pfWorkCond);
+    SDL_DestroyMutex(pfWorkMutex);
+    pfDoneSem = NULL;
+    pfWorkCond = NULL;
+    pfWorkMutex = NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfRequest
+    Description : Asks for a file to be streamed in ahead of being loaded.
+                  Files that aren't in a bigfile, or that would be read
+                  straight out of a bigfile mapping anyway, are ignored.
+    Inputs      : fileName - name the file will be loaded by
+                  flags - PF_LoadAlloc or PF_Open, depending on how it will
+                      be loaded
+    Outputs     :
+    Return      : TRUE if the file will be streamed
+----------------------------------------------------------------------------*/
+bool pfRequest(char *fileName, udword flags)
+{
+    bigFileConfiguration *bigFile;
+    udword fileNum;
+    bigTOCFileEntry *entry;
+    sdword index, nameLength;
+    pfjob *job;
+
+    if (pfNumWorkers == 0 || IgnoreBigfiles)
+    {
+        return FALSE;
+    }
+    if (!bigFindFile(fileName, &bigFile, &fileNum))
+    {
+        return FALSE;
+    }
+    entry = bigFile->tableOfContents.fileEntries + fileNum;
+    if ((bigFile->mapBase != NULL && !entry->compressionType) || entry->realLength == 0)
+    {
+        return FALSE;
+    }
+    if (pfJobFind(bigFile, fileNum) != -1)
+    {
+        return TRUE;
+    }
+    if (pfFreeList == -1)
+    {
+        return FALSE;
+    }
+
+    index = pfFreeList;
+    job = &pfJobs[index];
+    pfFreeList = job->nextList;
+
+    job->bigFile = bigFile;
+    job->fileNum = fileNum;
+    job->flags = flags;
+    job->state = PF_Pending;
+    job->length = entry->realLength;
+    job->result = -1;
+    job->buffer = NULL;
+    if (flags == PF_Open)
+    {
+        strcpy(job->memoryName, "decompBuf");
+    }
+    else
+    {                                                       //same name bigFileLoadAlloc would use
+        nameLength = strlen(fileName);
+        memStrncpy(job->memoryName, fileName + max(nameLength - (MEM_NameLength - 1), 0), MEM_NameLength - 1);
+    }
+
+    job->nextHash = pfHashTable[pfHash(bigFile, fileNum)];
+    pfHashTable[pfHash(bigFile, fileNum)] = index;
+
+    job->nextList = -1;
+    if (pfPendingTail == -1)
+    {
+        pfPendingHead = index;
+    }
+    else
+    {
+        pfJobs[pfPendingTail].nextList = index;
+    }
+    pfPendingTail = index;
+
+    pfStats.nRequested++;
+    pfIssue();
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfClaim
+    Description : Takes over the streamed copy of a bigfile entry, waiting
+                  for it if a worker is loading it.
+    Inputs      : bigFile, fileNum - the entry being loaded
+                  flags - PF_LoadAlloc or PF_Open
+    Outputs     : *address - memAlloc'd buffer holding the file
+    Return      : number of bytes in the buffer, or -1 if the caller should
+                  load the file itself
+----------------------------------------------------------------------------*/
+sdword pfClaim(bigFileConfiguration *bigFile, udword fileNum, udword flags, void **address)
+{
+    sdword index, length;
+    pfjob *job;
+    sqword timeStart, timeStop;
+
+    if (pfNumWorkers == 0)
+    {
+        return -1;
+    }
+    index = pfJobFind(bigFile, fileNum);
+    if (index == -1)
+    {
+        return -1;
+    }
+    job = &pfJobs[index];
+
+    while (pfDrain(FALSE))
+    {
+        ;
+    }
+
+    if (job->state == PF_Pending)
+    {                                                       //too late, pfIssue will drop it
+        pfJobUnhash(index);
+        job->state = PF_Cancelled;
+        pfStats.nMissed++;
+        return -1;
+    }
+    if (job->state == PF_Queued)
+    {
+        GetRawTime(&timeStart);
+        while (job->state == PF_Queued)
+        {
+            pfDrain(TRUE);
+        }
+        GetRawTime(&timeStop);
+        pfStats.waitTime += timeStop - timeStart;
+    }
+    dbgAssertOrIgnore(job->state == PF_Done);
+
+    pfJobUnhash(index);
+    length = job->length;
+    pfBytesOutstanding -= length;
+
+    if (job->result != length || job->flags != flags)
+    {
+        if (job->result != length)
+        {
+            pfStats.nFailed++;
+        }
+        else
+        {
+            pfStats.nMissed++;
+        }
+        memFree(job->buffer);
+        pfJobFree(index);
+        pfIssue();
+        return -1;
+    }
+
+    *address = job->buffer;
+    pfStats.nClaimed++;
+    pfStats.bytesLoaded += length;
+    pfJobFree(index);
+    pfIssue();
+    return length;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfFlush
+    Description : Drops all outstanding requests, waiting for the workers to
+                  finish what they have and freeing anything not claimed.
+                  Call once a load is over.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void pfFlush(void)
+{
+    sdword index, next;
+
+    if (pfNumWorkers == 0)
+    {
+        return;
+    }
+
+    for (index = pfPendingHead; index != -1; index = next)
+    {
+        next = pfJobs[index].nextList;
+        if (pfJobs[index].state == PF_Pending)
+        {
+            pfJobUnhash(index);
+        }
+        pfJobFree(index);
+    }
+    pfPendingHead = pfPendingTail = -1;
+
+    while (pfNumQueued > 0)
+    {
+        pfDrain(TRUE);
+    }
+
+    for (index = 0; index < PF_MaxJobs; index++)
+    {
+        if (pfJobs[index].state == PF_Done)
+        {
+            pfJobUnhash(index);
+            memFree(pfJobs[index].buffer);
+            pfJobFree(index);
+            pfStats.nWasted++;
+        }
+    }
+    pfBytesOutstanding = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfStatsReset
+    Description : Clears the prefetch statistics.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void pfStatsReset(void)
+{
+    memset(&pfStats, 0, sizeof(pfStats));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : pfNumberWorkers
+    Description : Reports the size of the worker pool.
+    Inputs      :
+    Outputs     :
+    Return      : number of worker threads, 0 if prefetching is off
+----------------------------------------------------------------------------*/
+udword pfNumberWorkers(void)
+{
+    return pfNumWorkers;
+}
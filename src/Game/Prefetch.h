@@ -0,0 +1,64 @@
+// =============================================================================
+//  Prefetch.h
+//  - background streaming of bigfile contents during level loads
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___PREFETCH_H
+#define ___PREFETCH_H
+
+#include "BigFile.h"
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define PF_MaxWorkers           4
+#define PF_MaxJobs              2048
+#define PF_HashSize             1024            // must be a power of 2
+#define PF_MaxBytes             (16 * 1024 * 1024)  // loaded but unclaimed data
+
+//flags for pfRequest/pfClaim: who is going to consume the data
+#define PF_LoadAlloc            0               // fileLoadAlloc; keeps the buffer
+#define PF_Open                 1               // fileOpen; reads then frees it in fileClose
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+typedef struct
+{
+    udword nRequested;                          // jobs accepted by pfRequest
+    udword nClaimed;                            // loads satisfied by a worker
+    udword nMissed;                             // claimed before a worker got to it
+    udword nWasted;                             // loaded but never claimed
+    udword nFailed;                             // worker couldn't load it
+    udword bytesLoaded;
+    sqword waitTime;                            // microseconds spent waiting in pfClaim
+}
+pfstats;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool pfEnabled;
+extern pfstats pfStats;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void pfStartup(void);
+void pfShutdown(void);
+
+bool pfRequest(char *fileName, udword flags);
+sdword pfClaim(bigFileConfiguration *bigFile, udword fileNum, udword flags, void **address);
+void pfFlush(void);
+
+void pfStatsReset(void);
+udword pfNumberWorkers(void);
+
+#endif
@@ -3,10 +3,14 @@
 #include "TimeoutTimer.h"
 #include "Color.h"
 #include "font.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <SDL.h>
 #include "Memory.h"
 #include "Debug.h"
 #include "File.h"
+#include "Globals.h"
 
 #ifdef PROFILE_TIMERS
 
@@ -47,6 +51,7 @@ void profTimerLabelFunc(sdword timer,char *label)
 {
     if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
     memStrncpy(profileTimers.timeLabel[timer],label,PROFILE_TIMER_LABLEN-1);
+    profTraceTimerLabel(timer,label);
 }
 
 void profTimerStartLittleLabelFunc(sdword timer,char *label)
@@ -55,6 +60,7 @@ void profTimerStartLittleLabelFunc(sdword timer,char *label)
     profileTimers.profileTimerType[timer] = PROFTIMER_TYPE_ADDUPLITTLETIMES;
     if (profileTimers.timeLabel[timer][0] == 0) memStrncpy(profileTimers.timeLabel[timer],label,PROFILE_TIMER_LABLEN-1);
     profileTimers.timeTotalDuration[timer] = 0;
+    profTraceTimerLabel(timer,label);
 }
 
 void profTimerStartLabelFunc(sdword timer,char *label)
@@ -62,17 +68,20 @@ void profTimerStartLabelFunc(sdword timer,char *label)
     if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
     if (profileTimers.timeLabel[timer][0] == 0) memStrncpy(profileTimers.timeLabel[timer],label,PROFILE_TIMER_LABLEN-1);
     GetRawTime(&profileTimers.timeStart[timer]);
+    profTraceTimerStart(timer,label);
 }
 
 void profTimerStartFunc(sdword timer)
 {
     if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
     GetRawTime(&profileTimers.timeStart[timer]);
+    profTraceTimerStart(timer,NULL);
 }
 
 void profTimerStopFunc(sdword timer)
 {
     if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
+    profTraceTimerStop(timer);
     GetRawTime(&profileTimers.timeStop[timer]);
     profileTimers.timeDuration[timer] = profileTimers.timeStop[timer] - profileTimers.timeStart[timer];
     if (profileTimers.profileTimerType[timer] == PROFTIMER_TYPE_ADDUPLITTLETIMES)
@@ -177,3 +186,670 @@ void profTimerOutputRecordingsFunc()
 
 #endif
 
+/*=============================================================================
+    Frame trace:
+=============================================================================*/
+
+#ifdef _MSC_VER
+#define PROF_THREAD_LOCAL __declspec(thread)
+#else
+#define PROF_THREAD_LOCAL __thread
+#endif
+
+#define PROF_TRACE_MAX_NAMES    1024            // distinct names in a binary capture
+#define PROF_TRACE_NAME_HASH    2048            // pointer hash for the name table, power of 2
+
+typedef struct proftraceevent
+{
+    char *name;
+    udword start;                               // microseconds from the start of the capture
+    udword duration;
+} proftraceevent;
+
+typedef struct proftracethread
+{
+    char *name;
+    udword nEvents;                             // written this capture; the ring wraps at PROF_TRACE_RING_LENGTH
+    proftraceevent *events;
+    SDL_atomic_t claimed;                       // 1 while a running thread owns the slot
+    SDL_atomic_t writing;                       // 1 while the owner is adding an event
+} proftracethread;
+
+typedef struct proftracescope
+{
+    char *name;
+    sqword start;                               // 0 if the scope began outside a capture
+} proftracescope;
+
+volatile bool profTraceCapturing = FALSE;
+
+static sdword profTraceFramesLeft = 0;          // frames still to capture, from /profTrace
+static bool profTraceBinary = FALSE;
+static sqword profTraceCaptureStart = 0;
+static sqword profTraceFrameStart = 0;
+
+static proftracethread profTraceThread[PROF_TRACE_MAX_THREADS];
+static proftraceevent *profTraceEvents = NULL;  // every thread's ring in one block
+static SDL_atomic_t profTraceNumberThreads;   // highest slot ever claimed + 1
+
+static char *profTraceTimerName[NUM_PROFILE_TIMERS] =
+{
+    "timer 0", "timer 1", "timer 2", "timer 3", "timer 4", "timer 5", "timer 6", "timer 7"
+};
+static sqword profTraceTimerStartTime[NUM_PROFILE_TIMERS];
+
+static PROF_THREAD_LOCAL sdword profTraceThreadIndex = 0;   // slot + 1, 0 until the thread first records
+static PROF_THREAD_LOCAL sdword profTraceDepth = 0;
+static PROF_THREAD_LOCAL proftracescope profTraceStack[PROF_TRACE_MAX_DEPTH];
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceSet
+    Description : Command-line handler for /profTrace <frames>
+    Inputs      : string - number of frames to capture once a game is running
+    Outputs     : arms the capture
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool profTraceSet(char *string)
+{
+    profTraceFramesLeft = atoi(string);
+    if (profTraceFramesLeft <= 0)
+    {
+        profTraceFramesLeft = 1;
+    }
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceBinarySet
+    Description : Command-line handler for /profTraceBinary
+    Inputs      :
+    Outputs     : writes the capture in the compact binary format instead of JSON
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool profTraceBinarySet(char *string)
+{
+    profTraceBinary = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceThreadClaim
+    Description : Claims a free trace slot for the calling thread.  A named
+                  thread gets back a slot an earlier thread of the same name
+                  released, so a thread started again (like the save thread
+                  on every save) keeps one row in the capture.  Otherwise a
+                  slot nobody has named is preferred, then any free one.
+    Inputs      : name - thread name, or NULL
+    Outputs     :
+    Return      : thread slot, or NULL if all PROF_TRACE_MAX_THREADS slots
+                  are held by running threads
+----------------------------------------------------------------------------*/
+static proftracethread *profTraceThreadClaim(char *name)
+{
+    proftracethread *thread;
+    sdword index, pass, nThreads;
+
+    for (pass = 0; pass < 3; pass++)
+    {
+        if (pass == 0 && name == NULL)
+        {
+            continue;
+        }
+        for (index = 0; index < PROF_TRACE_MAX_THREADS; index++)
+        {
+            thread = &profTraceThread[index];
+            if (pass == 0 && (thread->name == NULL || strcmp(thread->name, name) != 0))
+            {
+                continue;
+            }
+            if (pass == 1 && thread->name != NULL)
+            {
+                continue;
+            }
+            if (SDL_AtomicCAS(&thread->claimed, 0, 1))
+            {
+                profTraceThreadIndex = index + 1;
+                while ((nThreads = SDL_AtomicGet(&profTraceNumberThreads)) < index + 1 &&
+                       !SDL_AtomicCAS(&profTraceNumberThreads, nThreads, index + 1))
+                    ;
+                return thread;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceThreadGet
+    Description : Gets the trace slot of the calling thread, claiming one the
+                  first time a thread records anything.
+    Inputs      :
+    Outputs     :
+    Return      : thread slot, or NULL if none is free
+----------------------------------------------------------------------------*/
+static proftracethread *profTraceThreadGet(void)
+{
+    if (profTraceThreadIndex == 0)
+    {
+        return profTraceThreadClaim(NULL);
+    }
+    return &profTraceThread[profTraceThreadIndex - 1];
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceEmit
+    Description : Adds a complete event to the calling thread's ring
+    Inputs      : name - event name
+                  start, end - raw times the event began and ended
+    Outputs     :
+    Return      :
+    Notes       : The writing flag is raised before profTraceCapturing is
+                  checked, so once profTraceCaptureEnd has cleared the flag
+                  and seen every slot idle no thread can touch the rings.
+----------------------------------------------------------------------------*/
+static void profTraceEmit(char *name, sqword start, sqword end)
+{
+    proftracethread *thread = profTraceThreadGet();
+    proftraceevent *event;
+
+    if (thread == NULL)
+    {
+        return;
+    }
+
+    SDL_AtomicSet(&thread->writing, 1);
+    if (profTraceCapturing && thread->events != NULL)
+    {
+        event = &thread->events[thread->nEvents & (PROF_TRACE_RING_LENGTH - 1)];
+        event->name = name;
+        event->start = (udword)(start - profTraceCaptureStart);
+        event->duration = (udword)(end - start);
+        thread->nEvents++;
+    }
+    SDL_AtomicSet(&thread->writing, 0);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceThreadName
+    Description : Names the calling thread in the captures
+    Inputs      : name - thread name, must stay valid
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceThreadName(char *name)
+{
+    proftracethread *thread;
+
+    if (profTraceThreadIndex == 0)
+    {
+        thread = profTraceThreadClaim(name);
+    }
+    else
+    {
+        thread = &profTraceThread[profTraceThreadIndex - 1];
+    }
+    if (thread != NULL)
+    {
+        thread->name = name;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceThreadRelease
+    Description : Gives the calling thread's slot back.  Threads that named
+                  themselves call this just before they exit.  Events already
+                  recorded stay in the capture.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceThreadRelease(void)
+{
+    if (profTraceThreadIndex == 0)
+    {
+        return;
+    }
+    SDL_AtomicSet(&profTraceThread[profTraceThreadIndex - 1].claimed, 0);
+    profTraceThreadIndex = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceScopeBegin
+    Description : Opens a named scope on the calling thread.  Scopes nest and
+                  must be closed with profTraceScopeEnd on the same thread.
+    Inputs      : name - scope name, must stay valid until the capture is written
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceScopeBegin(char *name)
+{
+    proftracescope *scope;
+
+    if (profTraceDepth >= PROF_TRACE_MAX_DEPTH)
+    {                                           //too deep to record, just keep count
+        profTraceDepth++;
+        return;
+    }
+
+    scope = &profTraceStack[profTraceDepth++];
+    scope->name = name;
+    if (profTraceCapturing)
+    {
+        GetRawTime(&scope->start);
+    }
+    else
+    {
+        scope->start = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceScopeEnd
+    Description : Closes the innermost scope of the calling thread, recording
+                  it if it both began and ended during a capture.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceScopeEnd(void)
+{
+    proftracescope *scope;
+    sqword now;
+
+    dbgAssertOrIgnore(profTraceDepth > 0);
+    if (profTraceDepth <= 0)
+    {
+        return;
+    }
+
+    profTraceDepth--;
+    if (profTraceDepth >= PROF_TRACE_MAX_DEPTH)
+    {
+        return;
+    }
+
+    scope = &profTraceStack[profTraceDepth];
+    if (profTraceCapturing && scope->start >= profTraceCaptureStart)
+    {
+        GetRawTime(&now);
+        profTraceEmit(scope->name, scope->start, now);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceTimerLabel
+    Description : Names the trace events of one of the profile timer sites
+    Inputs      : timer - profile timer, label - name, must stay valid
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceTimerLabel(sdword timer,char *label)
+{
+    if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS) || (label == NULL)) return;
+    profTraceTimerName[timer] = label;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceTimerStart
+    Description : Trace side of PTSTART/PTSLAB.  The timer sites don't always
+                  pair up (AIShip ends timer 2 on several return paths), so
+                  they become complete events rather than scopes.
+    Inputs      : timer - profile timer, label - name or NULL to keep the old one
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceTimerStart(sdword timer,char *label)
+{
+    if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
+    if (label != NULL)
+    {
+        profTraceTimerName[timer] = label;
+    }
+    if (profTraceCapturing)
+    {
+        GetRawTime(&profTraceTimerStartTime[timer]);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceTimerStop
+    Description : Trace side of PTEND, records the time since the timer started
+    Inputs      : timer - profile timer
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceTimerStop(sdword timer)
+{
+    sqword now;
+
+    if ((timer < 0) || (timer >= NUM_PROFILE_TIMERS)) return;
+    if (profTraceCapturing && profTraceTimerStartTime[timer] >= profTraceCaptureStart)
+    {
+        GetRawTime(&now);
+        profTraceEmit(profTraceTimerName[timer], profTraceTimerStartTime[timer], now);
+        profTraceTimerStartTime[timer] = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceThreadNameGet
+    Description : Name of a thread slot for the capture files
+    Inputs      : index - thread slot
+    Outputs     :
+    Return      : thread name
+----------------------------------------------------------------------------*/
+static char *profTraceThreadNameGet(sdword index)
+{
+    static char defaultName[PROF_TRACE_MAX_THREADS][16];
+
+    if (profTraceThread[index].name != NULL)
+    {
+        return profTraceThread[index].name;
+    }
+    sprintf(defaultName[index], "thread %d", index);
+    return defaultName[index];
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceJSONStringWrite
+    Description : Writes a quoted JSON string
+    Inputs      : f - file, string - string to write
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void profTraceJSONStringWrite(FILE *f, char *string)
+{
+    fputc('"', f);
+    for ( ; *string; string++)
+    {
+        if (*string == '"' || *string == '\\')
+        {
+            fputc('\\', f);
+        }
+        if ((ubyte)*string >= ' ')
+        {
+            fputc(*string, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceJSONWrite
+    Description : Writes the capture as Chrome trace_event JSON
+    Inputs      : f - file, nThreads - thread slots in use
+    Outputs     :
+    Return      : number of events written
+----------------------------------------------------------------------------*/
+static udword profTraceJSONWrite(FILE *f, sdword nThreads)
+{
+    sdword index;
+    udword event, first, nWritten = 0;
+    proftracethread *thread;
+    proftraceevent *e;
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (index = 0; index < nThreads; index++)
+    {
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                index ? ",\n" : "", index);
+        profTraceJSONStringWrite(f, profTraceThreadNameGet(index));
+        fprintf(f, "}}");
+    }
+    for (index = 0; index < nThreads; index++)
+    {
+        thread = &profTraceThread[index];
+        first = thread->nEvents > PROF_TRACE_RING_LENGTH ? thread->nEvents - PROF_TRACE_RING_LENGTH : 0;
+        for (event = first; event < thread->nEvents; event++, nWritten++)
+        {
+            e = &thread->events[event & (PROF_TRACE_RING_LENGTH - 1)];
+            fprintf(f, ",\n{\"name\":");
+            profTraceJSONStringWrite(f, e->name);
+            fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%u,\"dur\":%u}", index, e->start, e->duration);
+        }
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return nWritten;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceNameIndex
+    Description : Finds or adds a name in the binary capture's name table
+    Inputs      : name - name to look up
+                  hash - pointer hash table, indices + 1
+                  names, nNames - name table
+    Outputs     : may add the name to the table
+    Return      : index of the name
+----------------------------------------------------------------------------*/
+static udword profTraceNameIndex(char *name, udword *hash, char **names, udword *nNames)
+{
+    udword slot = (udword)(((size_t)name >> 2) * 2654435761u) & (PROF_TRACE_NAME_HASH - 1);
+
+    while (hash[slot] != 0)
+    {
+        if (names[hash[slot] - 1] == name)
+        {
+            return hash[slot] - 1;
+        }
+        slot = (slot + 1) & (PROF_TRACE_NAME_HASH - 1);
+    }
+    if (*nNames >= PROF_TRACE_MAX_NAMES)
+    {                                           //table full, lump the rest together
+        return PROF_TRACE_MAX_NAMES - 1;
+    }
+    names[*nNames] = name;
+    hash[slot] = ++(*nNames);
+    return *nNames - 1;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceBinaryWrite
+    Description : Writes the capture in the compact binary format described in
+                  ProfileTimers.h
+    Inputs      : f - file, nThreads - thread slots in use
+    Outputs     :
+    Return      : number of events written
+----------------------------------------------------------------------------*/
+static udword profTraceBinaryWrite(FILE *f, sdword nThreads)
+{
+    udword *hash, *eventNames;
+    char **names;
+    udword nNames = 0, nEvents = 0, header[4], record[3], event, first, count, i;
+    udword threadName[PROF_TRACE_MAX_THREADS];
+    sdword index;
+    uword length;
+    proftracethread *thread;
+    proftraceevent *e;
+
+    hash = memAlloc(sizeof(udword) * PROF_TRACE_NAME_HASH, "ProfTraceHash", 0);
+    names = memAlloc(sizeof(char *) * PROF_TRACE_MAX_NAMES, "ProfTraceNames", 0);
+    eventNames = memAlloc(sizeof(udword) * PROF_TRACE_RING_LENGTH * nThreads, "ProfTraceEventNames", 0);
+    memset(hash, 0, sizeof(udword) * PROF_TRACE_NAME_HASH);
+
+    //build the name table first, it goes before the events
+    for (index = 0; index < nThreads; index++)
+    {
+        thread = &profTraceThread[index];
+        threadName[index] = profTraceNameIndex(profTraceThreadNameGet(index), hash, names, &nNames);
+        first = thread->nEvents > PROF_TRACE_RING_LENGTH ? thread->nEvents - PROF_TRACE_RING_LENGTH : 0;
+        for (event = first; event < thread->nEvents; event++)
+        {
+            e = &thread->events[event & (PROF_TRACE_RING_LENGTH - 1)];
+            eventNames[index * PROF_TRACE_RING_LENGTH + (event & (PROF_TRACE_RING_LENGTH - 1))] =
+                profTraceNameIndex(e->name, hash, names, &nNames);
+        }
+    }
+
+    memcpy(&header[0], "HWPT", 4);
+    header[1] = PROF_TRACE_BINARY_VERSION;
+    header[2] = nNames;
+    header[3] = nThreads;
+    fwrite(header, sizeof(header), 1, f);
+
+    for (i = 0; i < nNames; i++)
+    {
+        length = (uword)strlen(names[i]);
+        fwrite(&length, sizeof(length), 1, f);
+        fwrite(names[i], 1, length, f);
+    }
+
+    for (index = 0; index < nThreads; index++)
+    {
+        thread = &profTraceThread[index];
+        first = thread->nEvents > PROF_TRACE_RING_LENGTH ? thread->nEvents - PROF_TRACE_RING_LENGTH : 0;
+        count = thread->nEvents - first;
+        fwrite(&threadName[index], sizeof(udword), 1, f);
+        fwrite(&count, sizeof(udword), 1, f);
+        for (event = first; event < thread->nEvents; event++)
+        {
+            e = &thread->events[event & (PROF_TRACE_RING_LENGTH - 1)];
+            record[0] = eventNames[index * PROF_TRACE_RING_LENGTH + (event & (PROF_TRACE_RING_LENGTH - 1))];
+            record[1] = e->start;
+            record[2] = e->duration;
+            fwrite(record, sizeof(record), 1, f);
+        }
+        nEvents += count;
+    }
+
+    memFree(eventNames);
+    memFree(names);
+    memFree(hash);
+    return nEvents;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceCaptureBegin
+    Description : Starts recording on every thread
+    Inputs      :
+    Outputs     : allocates the rings the first time
+    Return      :
+----------------------------------------------------------------------------*/
+static void profTraceCaptureBegin(void)
+{
+    sdword index;
+
+    if (profTraceEvents == NULL)
+    {
+        profTraceEvents = memAlloc(sizeof(proftraceevent) * PROF_TRACE_RING_LENGTH * PROF_TRACE_MAX_THREADS,
+                                   "ProfTraceEvents", NonVolatile);
+    }
+    for (index = 0; index < PROF_TRACE_MAX_THREADS; index++)
+    {
+        profTraceThread[index].events = profTraceEvents + index * PROF_TRACE_RING_LENGTH;
+        profTraceThread[index].nEvents = 0;
+    }
+    profTraceThreadName("main");
+
+    GetRawTime(&profTraceCaptureStart);
+    profTraceFrameStart = profTraceCaptureStart;
+    profTraceCapturing = TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceCaptureEnd
+    Description : Stops recording, waits for other threads to finish any
+                  event they are adding and writes the capture to the user
+                  settings directory.
+    Inputs      :
+    Outputs     : writes PROF_TRACE_JSON_FILE or PROF_TRACE_BINARY_FILE
+    Return      :
+----------------------------------------------------------------------------*/
+static void profTraceCaptureEnd(void)
+{
+    char *fileName;
+    FILE *f;
+    sdword index, nThreads;
+    udword nEvents, nDropped = 0;
+
+    profTraceCapturing = FALSE;
+
+    nThreads = SDL_AtomicGet(&profTraceNumberThreads);
+    for (index = 0; index < nThreads; index++)
+    {                                           //wait out events other threads are part way through adding
+        while (!SDL_AtomicCAS(&profTraceThread[index].writing, 0, 0))
+        {
+            SDL_Delay(0);
+        }
+    }
+    for (index = 0; index < nThreads; index++)
+    {
+        if (profTraceThread[index].nEvents > PROF_TRACE_RING_LENGTH)
+        {
+            nDropped += profTraceThread[index].nEvents - PROF_TRACE_RING_LENGTH;
+        }
+    }
+
+    fileName = filePathPrepend(profTraceBinary ? PROF_TRACE_BINARY_FILE : PROF_TRACE_JSON_FILE, FF_UserSettingsPath);
+    if (!fileMakeDestinationDirectory(fileName) || (f = fopen(fileName, profTraceBinary ? "wb" : "wt")) == NULL)
+    {
+        dbgMessagef("profTraceCaptureEnd: couldn't open '%s'", fileName);
+        return;
+    }
+    nEvents = profTraceBinary ? profTraceBinaryWrite(f, nThreads) : profTraceJSONWrite(f, nThreads);
+    fclose(f);
+
+    dbgMessagef("Frame trace: %u events on %d threads written to '%s', %u dropped",
+                nEvents, nThreads, fileName, nDropped);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceFrame
+    Description : Frame boundary, called once per pass of the task list.
+                  Starts the capture asked for by /profTrace once a game is
+                  running, records the frame and finishes after the frame
+                  count runs out.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceFrame(void)
+{
+    sqword now;
+
+    if (!profTraceCapturing)
+    {
+        if (profTraceFramesLeft > 0 && gameIsRunning)
+        {
+            profTraceCaptureBegin();
+        }
+        return;
+    }
+
+    GetRawTime(&now);
+    profTraceEmit("frame", profTraceFrameStart, now);
+    profTraceFrameStart = now;
+
+    if (--profTraceFramesLeft <= 0)
+    {
+        profTraceCaptureEnd();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : profTraceClose
+    Description : Writes out a capture still in progress and frees the rings.
+                  Called at shutdown after the worker threads have stopped.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void profTraceClose(void)
+{
+    sdword index;
+
+    if (profTraceCapturing)
+    {
+        profTraceCaptureEnd();
+    }
+    profTraceFramesLeft = 0;
+
+    if (profTraceEvents != NULL)
+    {
+        for (index = 0; index < PROF_TRACE_MAX_THREADS; index++)
+        {
+            profTraceThread[index].events = NULL;
+        }
+        memFree(profTraceEvents);
+        profTraceEvents = NULL;
+    }
+}
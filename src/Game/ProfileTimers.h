@@ -34,6 +34,50 @@ typedef struct ProfileTimers
     bool recordTimersOn;
 } ProfileTimers;
 
+/*=============================================================================
+    Frame trace.  Records nested, named scopes on any thread into per-thread
+    ring buffers for a number of frames and writes them out as a Chrome
+    trace_event JSON file (load it in chrome://tracing or Perfetto) or as a
+    compact binary capture.  Available in all builds; when no capture is
+    running a scope costs a thread-local push and pop.
+=============================================================================*/
+
+#define PROF_TRACE_MAX_THREADS  8
+#define PROF_TRACE_RING_LENGTH  32768           // events kept per thread, oldest overwritten (power of 2)
+#define PROF_TRACE_MAX_DEPTH    32              // deepest scope nesting per thread
+
+#define PROF_TRACE_JSON_FILE    "ProfTrace.json"
+#define PROF_TRACE_BINARY_FILE  "ProfTrace.bin"
+
+//binary capture format, all little endian:
+//  header          "HWPT", udword version, udword nNames, udword nThreads
+//  nNames x        uword length, name characters (no terminator)
+//  nThreads x      udword thread name index, udword nEvents,
+//                  nEvents x { udword name index, udword start, udword duration }
+//times are in microseconds from the start of the capture
+#define PROF_TRACE_BINARY_VERSION   1
+
+extern volatile bool profTraceCapturing;
+
+bool profTraceSet(char *string);
+bool profTraceBinarySet(char *string);
+void profTraceClose(void);
+
+void profTraceFrame(void);
+void profTraceThreadName(char *name);
+void profTraceThreadRelease(void);
+
+void profTraceScopeBegin(char *name);
+void profTraceScopeEnd(void);
+
+void profTraceTimerLabel(sdword timer,char *label);
+void profTraceTimerStart(sdword timer,char *label);
+void profTraceTimerStop(sdword timer);
+
+//name must stay valid until the capture is written out (string literals, task names)
+#define PTSCOPE(name)   profTraceScopeBegin(name)
+#define PTSCOPEEND()    profTraceScopeEnd()
+
 #ifdef PROFILE_TIMERS
 
 extern ProfileTimers profileTimers;
@@ -88,21 +132,22 @@ void profTimerStopLittleFunc(sdword timer);
 #define profClose()
 #define profReset()
 
-#define profTimerStart(t)
-#define PTSTART(t)
+//the timer sites still feed the frame trace
+#define profTimerStart(t) profTraceTimerStart(t,NULL)
+#define PTSTART(t) profTraceTimerStart(t,NULL)
 
-#define profTimerStop(t)
-#define PTEND(t)
+#define profTimerStop(t) profTraceTimerStop(t)
+#define PTEND(t) profTraceTimerStop(t)
 #define PTENDLITTLE(t)
 
 #define profTimerStatsPrint(y)
 
-#define profTimerLabel(t,lab)
-#define PTLABEL(t,lab)
+#define profTimerLabel(t,lab) profTraceTimerLabel(t,lab)
+#define PTLABEL(t,lab) profTraceTimerLabel(t,lab)
 
-#define profTimerStartLabel(t,lab)
-#define PTSLAB(t,lab)
-#define PTSLABLITTLE(t,lab)
+#define profTimerStartLabel(t,lab) profTraceTimerStart(t,lab)
+#define PTSLAB(t,lab) profTraceTimerStart(t,lab)
+#define PTSLABLITTLE(t,lab) profTraceTimerLabel(t,lab)
 
 #define profTimerRecordOn()
 #define profTimerRecordOff()
@@ -0,0 +1,222 @@
+// =============================================================================
+//  QueueBench.c
+//  - headless packet queue stress test, pushes variable-size packets from a
+//    producer thread to the game thread and checks every one arrives intact
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "QueueBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "Debug.h"
+#include "main.h"
+#include "Queue.h"
+#include "TimeoutTimer.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool queueBenchEnabled = FALSE;
+static udword queueBenchPackets = QUEUEBENCH_DEFAULT_PACKETS;
+
+static Queue queueBenchQueue;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchSet
+    Description : Command-line handler for /queueBench <nPackets>
+    Inputs      : string - number of packets to push through the queue
+    Outputs     : enables the test and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool queueBenchSet(char *string)
+{
+    sscanf(string, "%u", &queueBenchPackets);
+    if (queueBenchPackets == 0)
+    {
+        queueBenchPackets = QUEUEBENCH_DEFAULT_PACKETS;
+    }
+    queueBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchRandom
+    Description : Steps a random number generator.  The producer and consumer
+                  each run their own copy from the same seed so the consumer
+                  knows what every packet should look like.
+    Inputs      : seed - generator state
+    Outputs     :
+    Return      : the next random number
+----------------------------------------------------------------------------*/
+static udword queueBenchRandom(udword *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return(*seed >> 8);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchPacketSize
+    Description : Picks the size of the next packet: mostly small command
+                  sized ones with the odd big one.
+    Inputs      : seed - generator state
+    Outputs     :
+    Return      : size of the packet
+----------------------------------------------------------------------------*/
+static udword queueBenchPacketSize(udword *seed)
+{
+    udword random = queueBenchRandom(seed);
+
+    if ((random & 15) == 0)
+    {
+        return(sizeof(udword) + (random >> 4) % (QUEUEBENCH_MAX_PACKET - sizeof(udword) + 1));
+    }
+    return(sizeof(udword) + (random >> 4) % 64);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchFill
+    Description : Fills a packet with its sequence number followed by bytes
+                  that depend on it.
+    Inputs      : packet - where to fill
+                  size - size of the packet
+                  sequence - number of the packet
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void queueBenchFill(ubyte *packet, udword size, udword sequence)
+{
+    udword index;
+
+    memcpy(packet, &sequence, sizeof(udword));
+    for (index = sizeof(udword); index < size; index++)
+    {
+        packet[index] = (ubyte)(sequence * 7 + index);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchProducer
+    Description : Producer thread.  Enqueues the packets as fast as it can,
+                  only backing off when far too many are waiting.
+    Inputs      : data - unused
+    Outputs     :
+    Return      : 0
+----------------------------------------------------------------------------*/
+static int queueBenchProducer(void *data)
+{
+    ubyte packet[QUEUEBENCH_MAX_PACKET];
+    udword sequence, size, seed = 0x2468ace;
+
+    (void)data;
+
+    for (sequence = 0; sequence < queueBenchPackets; sequence++)
+    {
+        while (queueNumberEntries(queueBenchQueue) >= QUEUEBENCH_MAX_ENTRIES)
+        {
+            SDL_Delay(0);
+        }
+        size = queueBenchPacketSize(&seed);
+        queueBenchFill(packet, size, sequence);
+        HWEnqueue(&queueBenchQueue, packet, size);
+    }
+    return 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueBenchRun
+    Description : Pushes the packets from a producer thread to this one
+                  through a queue that starts out small, stalling now and
+                  then so bursts build up and make it chain on segments.
+                  Every packet is checked for its size, order and contents.
+                  Called from main instead of the event loop when /queueBench
+                  is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword queueBenchRun(void)
+{
+    SDL_Thread *producer;
+    ubyte expected[QUEUEBENCH_MAX_PACKET];
+    ubyte *packet;
+    udword sequence = 0, size, expectedSize, batch = 0, nErrors = 0;
+    udword seed = 0x2468ace, batchSeed = 0x1357bdf;
+    sqword totalBytes = 0;
+    sqword timeStart, timeStop;
+    real64 seconds;
+
+    InitQueue(&queueBenchQueue, QUEUEBENCH_BUFFERSIZE);
+
+    GetRawTime(&timeStart);
+    producer = SDL_CreateThread(queueBenchProducer, "queuebench", NULL);
+    if (producer == NULL)
+    {
+        printf("QueueBench: couldn't start the producer thread\n");
+        CloseQueue(&queueBenchQueue);
+        return -1;
+    }
+
+    while (sequence < queueBenchPackets)
+    {
+        size = HWDequeue(&queueBenchQueue, &packet);
+        if (size == 0)
+        {
+            continue;
+        }
+
+        expectedSize = queueBenchPacketSize(&seed);
+        queueBenchFill(expected, expectedSize, sequence);
+        if (size != expectedSize || memcmp(packet, expected, size) != 0)
+        {
+            if (nErrors < 10)
+            {
+                printf("QueueBench: packet %u is wrong (%u bytes, expected %u)\n", sequence, size, expectedSize);
+            }
+            nErrors++;
+        }
+        totalBytes += size;
+        sequence++;
+
+        // hold on to a few packets at a time before giving their space back
+        if (++batch >= 1 + queueBenchRandom(&batchSeed) % QUEUEBENCH_MAX_BATCH)
+        {
+            HWDequeueDone(&queueBenchQueue);
+            batch = 0;
+        }
+        if (sequence % QUEUEBENCH_STALL_PERIOD == 0)
+        {
+            HWDequeueDone(&queueBenchQueue);
+            batch = 0;
+            SDL_Delay(2);
+        }
+    }
+    HWDequeueDone(&queueBenchQueue);
+
+    SDL_WaitThread(producer, NULL);
+    GetRawTime(&timeStop);
+    seconds = (real64)(timeStop - timeStart) / 1000000.0;
+
+    printf("QueueBench: %u packets, %.1f MB in %.3f s, %.0f packets/s, %.1f MB/s\n",
+           sequence, (real64)totalBytes / 1048576.0, seconds,
+           (real64)sequence / seconds, (real64)totalBytes / 1048576.0 / seconds);
+    printf("  started at %u bytes, %u segments chained, high water %u packets %u bytes, %u overruns\n",
+           QUEUEBENCH_BUFFERSIZE, queueNumberSegments(queueBenchQueue), queueHighWaterEntries(queueBenchQueue),
+           queueHighWaterSize(queueBenchQueue), queueNumberOverruns(queueBenchQueue));
+    printf("  %u packets wrong%s\n", nErrors, (nErrors || queueNumberEntries(queueBenchQueue)) ? ", FAILED" : "");
+
+    dbgAssertOrIgnore(queueNumberEntries(queueBenchQueue) == 0);
+    CloseQueue(&queueBenchQueue);
+
+    return (nErrors == 0 && queueNumberOverruns(queueBenchQueue) == 0) ? 0 : -1;
+}
@@ -0,0 +1,39 @@
+// =============================================================================
+//  QueueBench.h
+//  - headless packet queue stress test, pushes variable-size packets from a
+//    producer thread to the game thread and checks every one arrives intact
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___QUEUEBENCH_H
+#define ___QUEUEBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define QUEUEBENCH_DEFAULT_PACKETS  4000000
+#define QUEUEBENCH_BUFFERSIZE       4096            // first segment, small so bursts make it grow
+#define QUEUEBENCH_MAX_PACKET       1400            // biggest packet pushed, about a network packet
+#define QUEUEBENCH_MAX_ENTRIES      200000          // producer waits when this many packets are queued
+#define QUEUEBENCH_STALL_PERIOD     100000          // consumer stalls every this many packets
+#define QUEUEBENCH_MAX_BATCH        32              // most packets dequeued before HWDequeueDone
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool queueBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool queueBenchSet(char *string);
+
+sdword queueBenchRun(void);
+
+#endif
@@ -0,0 +1,33 @@
+// =============================================================================
+//  SSE.h
+//  - says whether the compiler targets SSE and SSE2, and pulls in their
+//    intrinsics if it does
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___SSE_H
+#define ___SSE_H
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+//both are always there on x86-64, and on 32-bit x86 when the compiler
+//targets them; no run-time check, so code that uses them needs a scalar
+//version for everything else
+#if defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+#define HW_SSE          1
+#include <xmmintrin.h>
+#else
+#define HW_SSE          0
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HW_SSE2         1
+#include <emmintrin.h>
+#else
+#define HW_SSE2         0
+#endif
+
+#endif
@@ -9,9 +9,20 @@
 #include "SaveGame.h"
 
 #include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include <SDL.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#endif
+
 #include "AIPlayer.h"
+#include "AISchedule.h"
+#include "AIThreat.h"
 #include "Blobs.h"
 #include "BTG.h"
 #include "CameraCommand.h"
@@ -24,20 +35,24 @@
 #include "LevelLoad.h"
 #include "Light.h"
 #include "LinkedList.h"
+#include "LZFast.h"
 #include "Memory.h"
 #include "MultiplayerGame.h"
 #include "Objectives.h"
 #include "Ping.h"
+#include "ProfileTimers.h"
 #include "Randy.h"
 #include "SalCapCorvette.h"
 #include "Select.h"
 #include "Sensors.h"
 #include "SinglePlayer.h"
 #include "SoundEvent.h"
+#include "SpaceQuery.h"
 #include "Star3d.h"
 #include "StringSupport.h"
 #include "Tactics.h"
 #include "Teams.h"
+#include "TimeoutTimer.h"
 #include "TradeMgr.h"
 #include "Tutor.h"
 #include "Universe.h"
@@ -54,7 +69,34 @@ void LoadConsMgr();
 GrowSelection SpaceObjRegistry;
 GrowSelection BlobRegistry;
 
-filehandle savefile = 0;
+#define SAVE_BufferGrowth       (256 * 1024)    // save stream buffer grows by at least this much
+
+//compress-and-write of one save, possibly on a background thread
+typedef struct
+{
+    ubyte *data;                    // save stream, malloc'd; freed by saveFileWrite
+    sdword rawLength;
+    sdword storedLength;            // filled in by saveFileWrite
+    sqword writeTime;
+    bool result;
+    char fileName[PATH_MAX];        // full path of the save
+} savewrite;
+
+bool saveBackgroundEnabled = TRUE;
+savestats saveStats;
+
+//save stream being built up by SaveGame
+static ubyte *saveBuffer       = NULL;
+static sdword saveBufferLength = 0;
+static sdword saveBufferSize   = 0;
+
+//save stream being read by PreLoadGame/LoadGame
+static ubyte *loadBuffer         = NULL;
+static sdword loadBufferLength   = 0;
+static sdword loadBufferPosition = 0;
+
+static savewrite saveWriteJob;
+static SDL_Thread *saveWriteThread = NULL;
 
 sdword savefilestatus        = 0;
 sdword saveGameVersionNumber = 0;
@@ -299,6 +341,53 @@ blob *BlobRegistryGetBlob(sdword id)
     return NULL;
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : saveBufferWrite
+    Description : Appends data to the save stream, growing it as needed.
+    Inputs      : data, length - what to append
+    Outputs     : sets savefilestatus if it runs out of memory
+    Return      :
+----------------------------------------------------------------------------*/
+static void saveBufferWrite(void *data, sdword length)
+{
+    sdword newSize;
+    ubyte *newBuffer;
+
+    if (saveBufferLength + length > saveBufferSize)
+    {
+        newSize = max(saveBufferSize * 2, saveBufferLength + length + SAVE_BufferGrowth);
+        newBuffer = realloc(saveBuffer, newSize);
+        if (newBuffer == NULL)
+        {
+            savefilestatus = 1;
+            return;
+        }
+        saveBuffer = newBuffer;
+        saveBufferSize = newSize;
+    }
+    memcpy(saveBuffer + saveBufferLength, data, length);
+    saveBufferLength += length;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadBufferRead
+    Description : Reads the next bit of the save stream being loaded.
+    Inputs      : length - how much to read
+    Outputs     : dest - filled in, or zeroed if there isn't that much left
+    Return      : TRUE if there was enough left
+----------------------------------------------------------------------------*/
+static bool loadBufferRead(void *dest, sdword length)
+{
+    if (loadBuffer == NULL || length < 0 || length > loadBufferLength - loadBufferPosition)
+    {
+        memset(dest, 0, max(length, 0));
+        return FALSE;
+    }
+    memcpy(dest, loadBuffer + loadBufferPosition, length);
+    loadBufferPosition += length;
+    return TRUE;
+}
+
 /*-----------------------------------------------------------------------------
     Name        : SaveThisChunk
     Description : saves thischunk
@@ -308,19 +397,20 @@ blob *BlobRegistryGetBlob(sdword id)
 ----------------------------------------------------------------------------*/
 void SaveThisChunk(SaveChunk *thischunk)
 {
-    FILE *fp;
-    dbgAssertOrIgnore(!fileUsingBigfile(savefile));
-    fp = fileStream(savefile);
-
-    if (fwrite(thischunk, sizeofSaveChunk(thischunk->contentsSize), 1, fp) != 1)
-    {
-        savefilestatus = 1;
-    }
+    saveBufferWrite(thischunk, sizeofSaveChunk(thischunk->contentsSize));
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : CreateChunk
+    Description : creates a chunk to save, in the frame arena.  Free it with
+                  memFree as soon as it's been saved.
+    Inputs      : type, contentsSize, contents (copied in if not NULL)
+    Outputs     :
+    Return      : the new chunk
+----------------------------------------------------------------------------*/
 SaveChunk *CreateChunk(TypeOfSaveChunk type,sdword contentsSize,void *contents)
 {
-    SaveChunk *chunk = memAlloc(sizeofSaveChunk(contentsSize),"savechunk",Pyrophoric);
+    SaveChunk *chunk = memFrameAlloc(sizeofSaveChunk(contentsSize),"savechunk");
 
     chunk->type = type;
     chunk->contentsSize = contentsSize;
@@ -339,12 +429,8 @@ SaveChunk *LoadNextChunk()
     SaveChunk readchunk;
     sdword num;
     SaveChunk *returnchunk;
-    FILE *fp;
 
-    dbgAssertOrIgnore(!fileUsingBigfile(savefile));
-    fp = fileStream(savefile);
-
-    num = fread(&readchunk,sizeof(SaveChunk),1,fp);
+    num = loadBufferRead(&readchunk,sizeof(SaveChunk));
     dbgAssertOrIgnore(num != 0);
 
     dbgAssertOrIgnore(readchunk.contentsSize >= 0);
@@ -355,7 +441,7 @@ SaveChunk *LoadNextChunk()
 
     if (readchunk.contentsSize > 0)
     {
-        num = fread(((ubyte *)returnchunk) + sizeof(SaveChunk),readchunk.contentsSize,1,fp);
+        num = loadBufferRead(((ubyte *)returnchunk) + sizeof(SaveChunk),readchunk.contentsSize);
         dbgAssertOrIgnore(num != 0);
     }
 
@@ -367,18 +453,14 @@ SaveChunk *LoadNextChunkSafe()
     SaveChunk readchunk;
     sdword num;
     SaveChunk *returnchunk;
-    FILE *fp;
 
-    dbgAssertOrIgnore(!fileUsingBigfile(savefile));
-    fp = fileStream(savefile);
-
-    num = fread(&readchunk,sizeof(SaveChunk),1,fp);
+    num = loadBufferRead(&readchunk,sizeof(SaveChunk));
     if (num == 0)
     {
         return NULL;
     }
 
-    if (readchunk.contentsSize < 0)
+    if ((readchunk.contentsSize < 0) || (readchunk.contentsSize > loadBufferLength - loadBufferPosition))
     {
         return NULL;
     }
@@ -389,7 +471,7 @@ SaveChunk *LoadNextChunkSafe()
 
     if (readchunk.contentsSize > 0)
     {
-        num = fread(((ubyte *)returnchunk) + sizeof(SaveChunk),readchunk.contentsSize,1,fp);
+        num = loadBufferRead(((ubyte *)returnchunk) + sizeof(SaveChunk),readchunk.contentsSize);
         if (num == 0)
         {
             memFree(returnchunk);
@@ -554,29 +636,22 @@ void LoadLighting(void)
 void SaveVersionInfo(void)
 {
     sdword version = SAVE_VERSION_NUMBER;
-    FILE *fp;
-
-    dbgAssertOrIgnore(!fileUsingBigfile(savefile));
-    fp = fileStream(savefile);
 
-    if (fwrite(&version, sizeof(sdword), 1, fp) != 1)
-    {
-        savefilestatus = 1;
-    }
+    saveBufferWrite(&version, sizeof(sdword));
 }
 
-sdword LoadVersionInfo(void)
+/*-----------------------------------------------------------------------------
+    Name        : saveVersionCheck
+    Description : checks whether this binary can load a save game version
+    Inputs      : version - save game version number
+    Outputs     : sets saveGameVersionNumber
+    Return      : VERIFYSAVEFILE_OK or VERIFYSAVEFILE_BADVERSION
+----------------------------------------------------------------------------*/
+static sdword saveVersionCheck(sdword version)
 {
-    FILE *fp;
     udword i;
 
-    dbgAssertOrIgnore(!fileUsingBigfile(savefile));
-    fp = fileStream(savefile);
-
-    if (fread(&saveGameVersionNumber, sizeof(sdword), 1, fp) == 0)
-    {
-        return VERIFYSAVEFILE_ERROROPENING;
-    }
+    saveGameVersionNumber = version;
 
     for (i = 0; i < sizeof(supportedVersionNumbers)/sizeof(sdword); ++i)
     {
@@ -589,6 +664,18 @@ sdword LoadVersionInfo(void)
     return VERIFYSAVEFILE_BADVERSION;
 }
 
+sdword LoadVersionInfo(void)
+{
+    sdword version;
+
+    if (!loadBufferRead(&version, sizeof(sdword)))
+    {
+        return VERIFYSAVEFILE_ERROROPENING;
+    }
+
+    return saveVersionCheck(version);
+}
+
 void SavePreGameInfo(void)
 {
     sdword i;
@@ -667,22 +754,149 @@ void LoadPreGameInfo(void)
 }
 
 /*-----------------------------------------------------------------------------
-    Name        : SaveGame
-    Description :
-    Inputs      :
+    Name        : saveFileWrite
+    Description : Compresses a save stream and writes it out.  It's written to
+                  a temporary file that's then renamed over the save, so a
+                  save that fails part way doesn't wipe out the old one.
+                  Doesn't touch anything but the savewrite, so it can run on
+                  any thread.
+    Inputs      : job - save stream and where to write it
+    Outputs     : frees job->data, fills in the rest of job
+    Return      :
+----------------------------------------------------------------------------*/
+static void saveFileWrite(savewrite *job)
+{
+    SaveFileHeader header;
+    char tempName[PATH_MAX + 8];
+    ubyte *stored;
+    sdword storedLength = -1;
+    sqword timeStart, timeStop;
+    FILE *fp;
+
+    GetRawTime(&timeStart);
+
+    header.magic = SAVE_FILE_MAGIC;
+    header.version = SAVE_VERSION_NUMBER;
+    header.flags = 0;
+    header.rawLength = job->rawLength;
+
+    stored = malloc(job->rawLength);
+    if (stored != NULL)
+    {
+        storedLength = lzfCompressBuffer((char *)job->data, job->rawLength, (char *)stored, job->rawLength);
+    }
+    if (storedLength < 0)
+    {                                                       //didn't compress, store it as is
+        free(stored);
+        stored = job->data;
+        storedLength = job->rawLength;
+        bitSet(header.flags, SAVE_FILE_STORED);
+    }
+    else
+    {
+        free(job->data);
+    }
+    job->data = NULL;
+    header.storedLength = storedLength;
+
+    job->result = FALSE;
+    sprintf(tempName, "%s.tmp", job->fileName);
+    fp = fopen(tempName, "wb");
+    if (fp != NULL)
+    {
+        job->result = (fwrite(&header, sizeof(SaveFileHeader), 1, fp) == 1) &&
+                      (fwrite(stored, storedLength, 1, fp) == 1);
+        if (fclose(fp) != 0)
+        {
+            job->result = FALSE;
+        }
+        if (job->result)
+        {
+#ifdef _WIN32
+            job->result = (MoveFileEx(tempName, job->fileName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+            job->result = (rename(tempName, job->fileName) == 0);
+#endif
+        }
+        if (!job->result)
+        {
+            remove(tempName);
+        }
+    }
+    free(stored);
+
+    GetRawTime(&timeStop);
+    job->storedLength = storedLength;
+    job->writeTime = timeStop - timeStart;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : saveWriteThreadFunction
+    Description : Background thread that writes one save.
+    Inputs      : data - the savewrite
     Outputs     :
-    Return      : TRUE on success
+    Return      : 0
 ----------------------------------------------------------------------------*/
-bool SaveGame(char *filename)
+static int saveWriteThreadFunction(void *data)
 {
-    sdword i;
+    profTraceThreadName("save");
+
+    PTSCOPE("save write");
+    saveFileWrite((savewrite *)data);
+    PTSCOPEEND();
 
-    savefile = fileOpen(filename, FF_WriteMode | FF_ReturnNULLOnFail | FF_UserSettingsPath);
-    if (savefile == (filehandle)NULL)
+    profTraceThreadRelease();
+    return 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : saveWriteFinish
+    Description : Records the results of a save once it's been written.
+    Inputs      : job - the finished savewrite
+    Outputs     : updates saveStats
+    Return      :
+----------------------------------------------------------------------------*/
+static void saveWriteFinish(savewrite *job)
+{
+    saveStats.storedLength = job->storedLength;
+    saveStats.writeTime = job->writeTime;
+    if (!job->result)
     {
-        return FALSE;
+        dbgMessagef("SaveGame: couldn't write %s", job->fileName);
     }
-    savefilestatus = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : SaveGameWait
+    Description : Waits for a save being written in the background to finish.
+                  Anything that reads saves or needs the last one on disk
+                  should call this first.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void SaveGameWait(void)
+{
+    if (saveWriteThread == NULL)
+    {
+        return;
+    }
+
+    SDL_WaitThread(saveWriteThread, NULL);
+    saveWriteThread = NULL;
+    saveWriteFinish(&saveWriteJob);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : SaveGameContents
+    Description : Saves everything to the save stream.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void SaveGameContents(void)
+{
+    sdword i;
 
     SaveVersionInfo();
     SavePreGameInfo();
@@ -735,18 +949,205 @@ bool SaveGame(char *filename)
     SaveInfoNumber(smGhostMode);
 
     SaveConsMgrDetermOptional();                // added for V1.04 patch
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : saveGameWrite
+    Description : Saves the game into memory, then compresses and writes it
+                  out either right away or on a background thread.
+    Inputs      : filename - save game file name
+                  background - TRUE to write it out in the background
+    Outputs     : updates saveStats
+    Return      : TRUE on success (or if it's being written in the background)
+----------------------------------------------------------------------------*/
+static bool saveGameWrite(char *filename, bool background)
+{
+    sqword timeStart, timeStop;
+    char *fullName;
+    bool result;
+
+    GetRawTime(&timeStart);
+
+    SaveGameWait();                                         //one at a time
 
-    fileClose(savefile);
-    savefile = 0;
+    fullName = filePathPrepend(filename, FF_UserSettingsPath);
+    fileNameCorrectCase(fullName);
+    if ((strlen(fullName) >= PATH_MAX) || !fileMakeDestinationDirectory(fullName))
+    {
+        return FALSE;
+    }
+    strcpy(saveWriteJob.fileName, fullName);
+
+    //start out big enough for a save like the last one
+    saveBufferSize = saveStats.rawLength + SAVE_BufferGrowth;
+    saveBuffer = malloc(saveBufferSize);
+    saveBufferLength = 0;
+    savefilestatus = (saveBuffer == NULL);
+
+    if (!savefilestatus)
+    {
+        SaveGameContents();
+    }
+
+    saveWriteJob.data = saveBuffer;
+    saveWriteJob.rawLength = saveBufferLength;
+    saveBuffer = NULL;
+    saveBufferLength = saveBufferSize = 0;
 
     if (savefilestatus)
     {
-        fileDelete(filename);
+        free(saveWriteJob.data);
+        saveWriteJob.data = NULL;
         savefilestatus = 0;
         return FALSE;
     }
-    
-    return TRUE;        // save successful
+    saveStats.rawLength = saveWriteJob.rawLength;
+
+    if (background)
+    {
+        saveWriteThread = SDL_CreateThread(saveWriteThreadFunction, "save", &saveWriteJob);
+    }
+    if (saveWriteThread != NULL)
+    {
+        result = TRUE;
+    }
+    else
+    {
+        saveFileWrite(&saveWriteJob);
+        saveWriteFinish(&saveWriteJob);
+        result = saveWriteJob.result;
+    }
+
+    GetRawTime(&timeStop);
+    saveStats.nSaves++;
+    saveStats.stallTime = timeStop - timeStart;
+    saveStats.stallTimeMax = max(saveStats.stallTimeMax, saveStats.stallTime);
+    saveStats.stallTimeTotal += saveStats.stallTime;
+
+    dbgMessagef("SaveGame: %s, %d bytes, %.2f ms on the game thread%s",
+                filename, saveStats.rawLength, (real64)saveStats.stallTime / 1000.0,
+                (saveWriteThread != NULL) ? " (writing in the background)" : "");
+
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : SaveGame
+    Description : Saves the game and waits for it to be written.
+    Inputs      : filename - save game file name
+    Outputs     :
+    Return      : TRUE on success
+----------------------------------------------------------------------------*/
+bool SaveGame(char *filename)
+{
+    return saveGameWrite(filename, FALSE);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : SaveGameBackground
+    Description : Saves the game, leaving it to be compressed and written on a
+                  background thread (unless saveBackgroundEnabled is off).
+                  For autosaves that shouldn't hold up the game.
+    Inputs      : filename - save game file name
+    Outputs     :
+    Return      : FALSE if it couldn't be saved; a failure to write it out is
+                  only reported to the debug log
+----------------------------------------------------------------------------*/
+bool SaveGameBackground(char *filename)
+{
+    return saveGameWrite(filename, saveBackgroundEnabled);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadGameFileRead
+    Description : Reads a whole save game file into memory, expanding it if
+                  it's compressed, ready for LoadVersionInfo and the rest.
+    Inputs      : filename - save game file name
+    Outputs     : sets up loadBuffer
+    Return      : VERIFYSAVEFILE_OK or VERIFYSAVEFILE_ERROROPENING
+----------------------------------------------------------------------------*/
+static sdword loadGameFileRead(char *filename)
+{
+    filehandle handle;
+    SaveFileHeader header;
+    ubyte *stored;
+    sdword length;
+    FILE *fp;
+
+    handle = fileOpen(filename, FF_ReturnNULLOnFail | FF_UserSettingsPath);
+    if (handle == 0)
+    {
+        return VERIFYSAVEFILE_ERROROPENING;
+    }
+
+    dbgAssertOrIgnore(!fileUsingBigfile(handle));
+    fp = fileStream(handle);
+    fseek(fp, 0, SEEK_END);
+    length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    stored = malloc(max(length, 1));
+    if ((stored == NULL) || (length <= 0) || (fread(stored, length, 1, fp) != 1))
+    {
+        fileClose(handle);
+        free(stored);
+        return VERIFYSAVEFILE_ERROROPENING;
+    }
+    fileClose(handle);
+
+    if ((length >= (sdword)sizeof(SaveFileHeader)) && (((SaveFileHeader *)stored)->magic == SAVE_FILE_MAGIC))
+    {
+        memcpy(&header, stored, sizeof(SaveFileHeader));
+        if ((header.storedLength != length - (sdword)sizeof(SaveFileHeader)) || (header.rawLength < 0))
+        {
+            free(stored);
+            return VERIFYSAVEFILE_ERROROPENING;
+        }
+
+        if (bitTest(header.flags, SAVE_FILE_STORED))
+        {
+            memmove(stored, stored + sizeof(SaveFileHeader), header.storedLength);
+            loadBuffer = stored;
+            loadBufferLength = header.storedLength;
+        }
+        else
+        {
+            loadBuffer = malloc(max(header.rawLength, 1));
+            if ((loadBuffer == NULL) ||
+                (lzfExpandBuffer((char *)stored + sizeof(SaveFileHeader), header.storedLength,
+                                 (char *)loadBuffer, header.rawLength) != header.rawLength))
+            {
+                free(loadBuffer);
+                loadBuffer = NULL;
+                free(stored);
+                return VERIFYSAVEFILE_ERROROPENING;
+            }
+            free(stored);
+            loadBufferLength = header.rawLength;
+        }
+    }
+    else
+    {                                                       //from before saves were compressed
+        loadBuffer = stored;
+        loadBufferLength = length;
+    }
+    loadBufferPosition = 0;
+
+    return VERIFYSAVEFILE_OK;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : loadGameFileClose
+    Description : Frees the save game read by loadGameFileRead.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void loadGameFileClose(void)
+{
+    free(loadBuffer);
+    loadBuffer = NULL;
+    loadBufferLength = loadBufferPosition = 0;
 }
 
 /*-----------------------------------------------------------------------------
@@ -758,20 +1159,32 @@ bool SaveGame(char *filename)
 ----------------------------------------------------------------------------*/
 sdword VerifySaveFile(char *filename)
 {
-    sdword verify;
+    filehandle handle;
+    SaveFileHeader header;
+    sdword length;
 
-    savefile = fileOpen(filename, FF_ReturnNULLOnFail | FF_UserSettingsPath);
+    SaveGameWait();
 
-    if (savefile == 0)
+    handle = fileOpen(filename, FF_ReturnNULLOnFail | FF_UserSettingsPath);
+
+    if (handle == 0)
     {
         return VERIFYSAVEFILE_ERROROPENING;
     }
 
-    verify = LoadVersionInfo();
-    fileClose(savefile);
-    savefile = 0;
+    dbgAssertOrIgnore(!fileUsingBigfile(handle));
+    length = fread(&header, 1, sizeof(SaveFileHeader), fileStream(handle));
+    fileClose(handle);
 
-    return verify;
+    if ((length >= (sdword)sizeof(SaveFileHeader)) && (header.magic == SAVE_FILE_MAGIC))
+    {
+        return saveVersionCheck(header.version);
+    }
+    if (length >= (sdword)sizeof(sdword))
+    {                                                       //from before saves were compressed
+        return saveVersionCheck((sdword)header.magic);
+    }
+    return VERIFYSAVEFILE_ERROROPENING;
 }
 
 /*-----------------------------------------------------------------------------
@@ -785,8 +1198,13 @@ void PreLoadGame(char *filename)
 {
     sdword verify;
 
-    savefile = fileOpen(filename, FF_UserSettingsPath);
-    verify = LoadVersionInfo();
+    SaveGameWait();
+
+    verify = loadGameFileRead(filename);
+    if (verify == VERIFYSAVEFILE_OK)
+    {
+        verify = LoadVersionInfo();
+    }
     if (verify != VERIFYSAVEFILE_OK)
     {
         dbgFatalf(DBG_Loc,"Error %d loading game %s",verify,filename);
@@ -806,7 +1224,7 @@ void LoadGame(char *filename)
 {
     sdword i;
 
-    dbgAssertOrIgnore(savefile);
+    dbgAssertOrIgnore(loadBuffer != NULL);
 
     SpaceObjRegistryInit();
     BlobRegistryInit();
@@ -837,6 +1255,11 @@ void LoadGame(char *filename)
     {
         tutLoadTutorialGame();
     }
+
+    //unfinished computer player and KAS updates aren't saved, so they all
+    //start over with a fresh threat grid
+    aischReset();
+    aithReset();
     
     LoadMaxSelectionAndFix(&selSelected);
     for (i=0;i<SEL_NumberHotKeyGroups;i++)
@@ -860,8 +1283,7 @@ void LoadGame(char *filename)
 
     listInit(&universe.effectList);
 
-    fileClose(savefile);
-    savefile = 0;
+    loadGameFileClose();
 }
 
 /*=============================================================================
@@ -2377,7 +2799,7 @@ Bullet *LoadBullet(SaveChunk *chunk)
 
     VerifyChunk(chunk,BASIC_STRUCTURE|SAVE_SPACEOBJ|OBJ_BulletType,sizeof(Bullet));
 
-    bullet = memAlloc(sizeof(Bullet),"Bullet",0);
+    bullet = memObjAlloc(&univBulletPool);
 
     memcpy(bullet,chunkContents(chunk),chunk->contentsSize);
 
@@ -2525,7 +2947,7 @@ Missile *LoadMissile(SaveChunk *chunk)
 
     VerifyChunk(chunk,BASIC_STRUCTURE|SAVE_SPACEOBJ|OBJ_MissileType,sizeof(Missile));
 
-    missile = memAlloc(sizeof(Missile),"Missile",0);
+    missile = memObjAlloc(&univMissilePool);
 
     memcpy(missile,chunkContents(chunk),chunk->contentsSize);
 
@@ -2843,6 +3265,7 @@ void ShipListAddCB(LinkedList *list,SpaceObj *obj)
 #define ship ((Ship *)obj)
     dbgAssertOrIgnore(ship->objtype == OBJ_ShipType);
     listAddNode(list,&ship->shiplink,obj);
+    univShipIndexDirty();
 #undef ship
 }
 
@@ -2859,6 +3282,7 @@ void ResourceListAddCB(LinkedList *list,SpaceObj *obj)
 #define resource ((Resource *)obj)
     dbgAssertOrIgnore(resource->flags & SOF_Resource);
     listAddNode(list,&resource->resourcelink,obj);
+    spqSetDirty(SPQ_Resources);
 #undef resource
 }
 
@@ -3600,9 +4024,12 @@ void Save_CameraCommand(CameraCommand *cameracommand)
     savecc->dontFocusOnMe = (CameraStackEntry *)ConvertPointerInListToNum(&savecc->camerastack,savecc->dontFocusOnMe);
 
     SaveThisChunk(chunk);
+    memFree(chunk);
 
     infocontents.info = num;
-    SaveThisChunk(CreateChunk(INFO_CHUNK,sizeof(InfoChunkContents),&infocontents));
+    chunk = CreateChunk(INFO_CHUNK,sizeof(InfoChunkContents),&infocontents);
+    SaveThisChunk(chunk);
+    memFree(chunk);
 
     while (node != NULL)
     {
@@ -3615,8 +4042,6 @@ void Save_CameraCommand(CameraCommand *cameracommand)
     }
 
     dbgAssertOrIgnore(cur == num);
-
-    memFree(chunk);
 }
 
 void Load_CameraCommand(CameraCommand *cameracommand)
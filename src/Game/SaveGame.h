@@ -76,6 +76,31 @@ typedef struct
     sdword info;
 } InfoChunkContents;
 
+// saves are written as a SaveFileHeader followed by the LZFast-compressed
+// save stream.  Files without the header are from before saves were compressed.
+#define SAVE_FILE_MAGIC                 0x5a535748  // 'HWSZ'
+#define SAVE_FILE_STORED                0x00000001  // stream didn't compress, stored as is
+
+typedef struct
+{
+    udword magic;
+    sdword version;                 // copy of the stream's version so it can be checked without expanding it
+    udword flags;
+    sdword rawLength;               // length of the save stream
+    sdword storedLength;            // length of what follows the header
+} SaveFileHeader;
+
+typedef struct
+{
+    udword nSaves;
+    sdword rawLength;               // of the last save
+    sdword storedLength;
+    sqword stallTime;               // microseconds the game thread spent in the last save
+    sqword stallTimeMax;
+    sqword stallTimeTotal;
+    sqword writeTime;               // microseconds spent compressing and writing the last save
+} savestats;
+
 #define chunkContents(c) ((void *) (((ubyte *)c) + sizeof(SaveChunk)))
 
 #define sizeofSaveChunk(n) (sizeof(SaveChunk) + n)
@@ -89,7 +114,12 @@ typedef struct
     dbgAssertOrIgnore(c);                       \
     dbgAssertOrIgnore((c)->type == (t));
 
+extern bool saveBackgroundEnabled;
+extern savestats saveStats;
+
 bool SaveGame(char *filename);
+bool SaveGameBackground(char *filename);
+void SaveGameWait(void);
 void LoadGame(char *filename);
 void PreLoadGame(char *filename);
 
@@ -21,6 +21,7 @@
 #include "SpeechEvent.h"
 #include "Tweak.h"
 #include "Universe.h"
+#include "UnivUpdate.h"
 
 /*-----------------------------------------------------------------------------
     Name        : AddSpaceObjToSelectionBeforeIndex
@@ -1586,28 +1587,17 @@ SelectCommand *selectAllCurrentPlayersHyperspacingShips(void)
 SelectCommand *selectAllPlayersShips(struct Player *player)
 {
     SelectCommand *selection;
-    sdword i = 0;
-    Node *objnode;
-    Ship *ship;
+    sdword numShips;
+    Ship **playerShips;
 
-    selection = memAlloc(sizeofSelectCommand(universe.ShipList.num),"selectall",0);
+    numShips = univShipsOfPlayer(player->playerIndex, &playerShips);
 
-    i = 0;
-    objnode = universe.ShipList.head;
-    while (objnode != NULL)
+    selection = memAlloc(sizeofSelectCommand(numShips),"selectall",0);
+    if (numShips > 0)
     {
-        ship = (Ship *)listGetStructOfNode(objnode);
-        dbgAssertOrIgnore(ship->objtype == OBJ_ShipType);
-
-        if (ship->playerowner == player)
-        {
-            selection->ShipPtr[i++] = ship;
-        }
-
-        objnode = objnode->next;
+        memcpy(selection->ShipPtr, playerShips, sizeof(ShipPtr) * numShips);
     }
-
-    selection->numShips = i;
+    selection->numShips = numShips;
 
     return selection;
 }
@@ -0,0 +1,430 @@
+// =============================================================================
+//  SimBench.c
+//  - headless simulation benchmark, replays a packet recording through
+//    univUpdate as fast as possible
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "SimBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "CommandNetwork.h"
+#include "Captaincy.h"
+#include "Debug.h"
+#include "File.h"
+#include "Globals.h"
+#include "Jobs.h"
+#include "main.h"
+#include "mainswitches.h"
+#include "NetCheck.h"
+#include "ProfileTimers.h"
+#include "SaveGame.h"
+#include "ScenPick.h"
+#include "SinglePlayer.h"
+#include "StringSupport.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "UnivUpdate.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool simBenchEnabled = FALSE;
+char simBenchFileName[SIMBENCH_FILENAME_LEN] = "";
+udword simBenchFrameLimit = 0;                  // 0 means run until the recording runs out
+char simBenchCompareFileName[SIMBENCH_FILENAME_LEN] = "";
+
+static FILE *simBenchChecksumFile = NULL;
+static FILE *simBenchCompareFile = NULL;        // checksums of an earlier run to check against
+static udword simBenchFramesCompared = 0;
+static bool simBenchMismatch = FALSE;
+static udword simBenchFrames = 0;
+static sqword simBenchUpdateTime = 0;
+
+#ifdef PROFILE_TIMERS
+static sqword simBenchPhaseTime[NUM_PROFILE_TIMERS];
+#endif
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchFileSet
+    Description : Command-line handler for /simBench <file.pkts>
+    Inputs      : string - name of the packet recording to replay
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool simBenchFileSet(char *string)
+{
+    memStrncpy(simBenchFileName, string, SIMBENCH_FILENAME_LEN - 1);
+    simBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchFramesSet
+    Description : Command-line handler for /simBenchFrames <n>
+    Inputs      : string - maximum number of universe updates to run
+    Outputs     :
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool simBenchFramesSet(char *string)
+{
+    sscanf(string, "%u", &simBenchFrameLimit);
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchCompareSet
+    Description : Command-line handler for /simBenchCompare <file>
+    Inputs      : string - checksum file of an earlier run of the same
+                  recording, for instance one with /noJobs
+    Outputs     :
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool simBenchCompareSet(char *string)
+{
+    memStrncpy(simBenchCompareFileName, string, SIMBENCH_FILENAME_LEN - 1);
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchScenarioSelect
+    Description : Picks the scenario the recording was made on, as the game
+                  picker would have done.
+    Inputs      : mapName - tpGameCreated.MapName from the recording header
+    Outputs     : sets spCurrentSelected
+    Return      : FALSE if no such scenario is available
+----------------------------------------------------------------------------*/
+static bool simBenchScenarioSelect(char *mapName)
+{
+    sdword index;
+
+    for (index = 0; index < spScenarioListLength; index++)
+    {
+        if (!strcasecmp(spScenarios[index].fileSpec, mapName))
+        {
+            spCurrentSelected = index;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchGameStart
+    Description : Starts the recorded game without any front end, following
+                  the packet playback path of utyNewGameStart.
+    Inputs      :
+    Outputs     :
+    Return      : FALSE if the recording could not be set up
+----------------------------------------------------------------------------*/
+static bool simBenchGameStart(void)
+{
+    udword i;
+
+    if (!fileExists(simBenchFileName, FF_IgnoreBIG))
+    {
+        printf("SimBench: can't find packet recording '%s'\n", simBenchFileName);
+        return FALSE;
+    }
+
+    strcpy(recordPacketFileName, simBenchFileName);
+    playPackets = TRUE;
+    transferCaptaincyDisabled = TRUE;
+    multiPlayerGame = FALSE;
+    singlePlayerGame = FALSE;
+
+    netcheckInit();
+    recPackPlayInit();                                      // sets numPlayers, curPlayer and tpGameCreated
+
+    if (!simBenchScenarioSelect(tpGameCreated.MapName))
+    {
+        printf("SimBench: recording is of unknown map '%s'\n", tpGameCreated.MapName);
+        return FALSE;
+    }
+
+    for (i = 0; i < numPlayers; i++)
+    {
+        if (ComputerPlayerEnabled[i])
+        {
+            sprintf(playerNames[i], "%s %i", strGetString(strComputerName), i);
+        }
+        else
+        {
+            strcpy(playerNames[i], utyName);
+        }
+    }
+
+    singlePlayerInit();
+    gameStart(NULL);
+
+    return gameIsRunning;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : benchSinglePlayerStart
+    Description : Starts the first single player mission without any front
+                  end, for the headless benchmarks that just need a universe
+                  with ships and effects loaded.
+    Inputs      :
+    Outputs     :
+    Return      : FALSE if the mission didn't start
+----------------------------------------------------------------------------*/
+bool benchSinglePlayerStart(void)
+{
+    singlePlayerGame = TRUE;
+    tutorial = TUTORIAL_SINGLEPLAYER;
+    numPlayers = 2;
+    curPlayer = 0;
+    strcpy(playerNames[0], "Player");
+
+    spResetMissionSequenceToBeginning();
+    singlePlayerInit();
+    gameStart(NULL);
+
+    return gameIsRunning;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchCompare
+    Description : Checks a frame's checksum line against the same line of
+                  the earlier run.  Stops comparing at the first difference,
+                  or if the earlier run stopped sooner.
+    Inputs      : line - this frame's line of the checksum file
+    Outputs     : sets simBenchMismatch if they differ
+    Return      :
+----------------------------------------------------------------------------*/
+static void simBenchCompare(char *line)
+{
+    char expected[SIMBENCH_LINE_LEN];
+
+    if (fgets(expected, SIMBENCH_LINE_LEN, simBenchCompareFile) == NULL)
+    {
+        printf("SimBench: %s ends after %u frames\n", simBenchCompareFileName, simBenchFramesCompared);
+    }
+    else if (strcmp(line, expected))
+    {
+        printf("SimBench: frame %u differs from %s\n  got      %s  expected %s",
+               universe.univUpdateCounter, simBenchCompareFileName, line, expected);
+        simBenchMismatch = TRUE;
+    }
+    else
+    {
+        simBenchFramesCompared++;
+        return;
+    }
+
+    fclose(simBenchCompareFile);
+    simBenchCompareFile = NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchUpdate
+    Description : Runs and times one universe update, accumulates the time
+                  spent in each of the profile timer regions and logs the
+                  universe checksum for the frame.
+    Inputs      :
+    Outputs     :
+    Return      : TRUE if the game ended during this update
+----------------------------------------------------------------------------*/
+static bool simBenchUpdate(void)
+{
+    sqword timeStart, timeStop;
+    sdword numShips;
+    bool gameOver;
+    char line[SIMBENCH_LINE_LEN];
+    union
+    {
+        real32 f;
+        udword u;
+    } checksum;
+#ifdef PROFILE_TIMERS
+    sdword i;
+
+    memset(profileTimers.timeDuration, 0, sizeof(profileTimers.timeDuration));
+    memset(profileTimers.timeTotalDuration, 0, sizeof(profileTimers.timeTotalDuration));
+#endif
+
+    GetRawTime(&timeStart);
+    gameOver = univUpdate(UNIVERSE_UPDATE_PERIOD);
+    GetRawTime(&timeStop);
+
+    simBenchUpdateTime += timeStop - timeStart;
+    simBenchFrames++;
+
+#ifdef PROFILE_TIMERS
+    for (i = 0; i < NUM_PROFILE_TIMERS; i++)
+    {
+        if (profileTimers.profileTimerType[i] == PROFTIMER_TYPE_ADDUPLITTLETIMES)
+        {
+            simBenchPhaseTime[i] += profileTimers.timeTotalDuration[i];
+        }
+        else
+        {
+            simBenchPhaseTime[i] += profileTimers.timeDuration[i];
+        }
+    }
+#endif
+
+    if ((simBenchChecksumFile != NULL) || (simBenchCompareFile != NULL))
+    {
+        checksum.f = univGetChecksum(&numShips);
+        sprintf(line, "%u\t%08x\t%f\t%d\t%08x\n",
+                universe.univUpdateCounter, checksum.u, checksum.f, numShips, univCalcShipChecksum());
+        if (simBenchChecksumFile != NULL)
+        {
+            fputs(line, simBenchChecksumFile);
+        }
+        if (simBenchCompareFile != NULL)
+        {
+            simBenchCompare(line);
+        }
+    }
+
+    return gameOver;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchReport
+    Description : Prints the benchmark results to stdout.
+    Inputs      : nPackets - number of sync packets replayed
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void simBenchReport(udword nPackets)
+{
+    real64 seconds = (real64)simBenchUpdateTime / 1000000.0;
+    real64 ticksPerSecond = (seconds > 0.0) ? (real64)simBenchFrames / seconds : 0.0;
+#ifdef PROFILE_TIMERS
+    sdword i;
+#endif
+
+    printf("SimBench: %s\n", simBenchFileName);
+    printf("  %u frames from %u sync packets in %.3f s\n", simBenchFrames, nPackets, seconds);
+    printf("  %.1f ticks/sec (%.1fx real time)\n", ticksPerSecond, ticksPerSecond / UNIVERSE_UPDATE_RATE);
+    printf("  %u job workers%s\n", jobNumberWorkers(), jobEnabled ? "" : " (disabled)");
+    if (simBenchCompareFileName[0])
+    {
+        printf("  %u frames the same as %s%s\n", simBenchFramesCompared, simBenchCompareFileName,
+               simBenchMismatch ? ", FAILED" : "");
+    }
+    if (saveStats.nSaves != 0)
+    {                                                       //with /autosavedebug
+        printf("  %u saves, %.3f ms mean / %.3f ms max on the game thread%s\n", saveStats.nSaves,
+               (real64)saveStats.stallTimeTotal / 1000.0 / saveStats.nSaves, (real64)saveStats.stallTimeMax / 1000.0,
+               saveBackgroundEnabled ? "" : " (written on the game thread)");
+    }
+
+#ifdef PROFILE_TIMERS
+    for (i = 0; i < NUM_PROFILE_TIMERS; i++)
+    {
+        if (profileTimers.timeLabel[i][0] == 0)
+        {
+            continue;
+        }
+        printf("  %-16s %10.3f ms %8.4f ms/frame %5.1f%%\n",
+               profileTimers.timeLabel[i],
+               (real64)simBenchPhaseTime[i] / 1000.0,
+               simBenchFrames ? (real64)simBenchPhaseTime[i] / 1000.0 / simBenchFrames : 0.0,
+               simBenchUpdateTime ? 100.0 * (real64)simBenchPhaseTime[i] / (real64)simBenchUpdateTime : 0.0);
+    }
+#else
+    printf("  (per-phase times need a build with PROFILE_TIMERS)\n");
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : simBenchRun
+    Description : Replays the packet recording through univUpdate in a tight
+                  loop with no rendering, sound or frame pacing.  Called from
+                  main instead of the event loop when /simBench is given.
+    Inputs      :
+    Outputs     : writes per-frame checksums to SIMBENCH_CHECKSUMFILE, and
+                  checks them against simBenchCompareFileName if given
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword simBenchRun(void)
+{
+    udword nPackets = 0;
+    udword repeat;
+    char *fileNameFull;
+
+    if (!simBenchGameStart())
+    {
+        return -1;
+    }
+
+    fileNameFull = filePathPrepend(SIMBENCH_CHECKSUMFILE, FF_UserSettingsPath);
+    if (fileMakeDestinationDirectory(fileNameFull))
+    {
+        simBenchChecksumFile = fopen(fileNameFull, "wt");
+    }
+    if (simBenchCompareFileName[0])
+    {
+        simBenchCompareFile = fopen(simBenchCompareFileName, "rt");
+        if (simBenchCompareFile == NULL)
+        {
+            printf("SimBench: can't open checksum file '%s'\n", simBenchCompareFileName);
+            return -1;
+        }
+    }
+    simBenchFramesCompared = 0;
+    simBenchMismatch = FALSE;
+
+    simBenchFrames = 0;
+    simBenchUpdateTime = 0;
+#ifdef PROFILE_TIMERS
+    memset(simBenchPhaseTime, 0, sizeof(simBenchPhaseTime));
+#endif
+
+    for (;;)
+    {
+        if ((simBenchFrameLimit != 0) && (simBenchFrames >= simBenchFrameLimit))
+        {
+            break;
+        }
+        if (clWaitSyncPacket(&universe.mainCommandLayer) == NO_PACKET)
+        {                                                   //recording ran out
+            break;
+        }
+        nPackets++;
+
+        netCheck();
+
+        //universeUpdateTask does two updates for every sync packet
+        for (repeat = 0; repeat < 2; repeat++)
+        {
+            if (simBenchUpdate() || !gameIsRunning)
+            {
+                goto done;
+            }
+        }
+    }
+done:
+
+    if (simBenchChecksumFile != NULL)
+    {
+        fclose(simBenchChecksumFile);
+        simBenchChecksumFile = NULL;
+    }
+    if (simBenchCompareFile != NULL)
+    {
+        fclose(simBenchCompareFile);
+        simBenchCompareFile = NULL;
+    }
+
+    recPackPlayClose();
+
+    simBenchReport(nPackets);
+
+    return(simBenchMismatch ? -1 : 0);
+}
@@ -0,0 +1,43 @@
+// =============================================================================
+//  SimBench.h
+//  - headless simulation benchmark, replays a packet recording through
+//    univUpdate as fast as possible
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___SIMBENCH_H
+#define ___SIMBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define SIMBENCH_CHECKSUMFILE       "SimBenchChecksums.txt"
+#define SIMBENCH_FILENAME_LEN       50
+#define SIMBENCH_LINE_LEN           128             // longest line of the checksum file
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool simBenchEnabled;
+extern char simBenchFileName[SIMBENCH_FILENAME_LEN];
+extern udword simBenchFrameLimit;
+extern char simBenchCompareFileName[SIMBENCH_FILENAME_LEN];
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool simBenchFileSet(char *string);
+bool simBenchFramesSet(char *string);
+bool simBenchCompareSet(char *string);
+
+sdword simBenchRun(void);
+
+bool benchSinglePlayerStart(void);
+
+#endif
@@ -48,6 +48,7 @@
 #include "Sensors.h"
 #include "SoundEvent.h"
 #include "SoundEventDefs.h"
+#include "SpaceQuery.h"
 #include "StatScript.h"
 #include "StringSupport.h"
 #include "TaskBar.h"
@@ -159,6 +160,7 @@ real32 AdvancedFleetStrengthForLevel[NUMBER_SINGLEPLAYER_MISSIONS+1];
 sdword SINGLEPLAYER_DEBUGLEVEL  =   0;
 sdword SINGLEPLAYER_STARTINGRUS = 200;
 sdword warpLevel                =   0;
+sdword spWarpLevelOverride      =   0;  // used instead of the WarpTo file when set (load benchmark)
 
 
 fibfileheader *spHyperspaceRollCallHandle = NULL;
@@ -1428,6 +1430,7 @@ void PutShipOutsideAt(Ship *ship,vector *createat,vector *createvelocity,real32
     collAddSpaceObjToCollBlobs((SpaceObj *)ship);
     listAddNode(&universe.SpaceObjList,&(ship->objlink),ship);
     listAddNode(&universe.ShipList,&(ship->shiplink),ship);
+    univShipIndexDirty();
     listAddNode(&universe.ImpactableList,&(ship->impactablelink),ship);
     bitClear(ship->flags, SOF_Hide);
     ship->posinfo.position = *createat;
@@ -3480,6 +3483,8 @@ void RotatePlayersFleetAbout(Player *player,vector about,real32 deg)
 
         objnode = objnode->next;
     }
+
+    spqSetDirty(SPQ_Ships);                                 //ships may have swung farther than a grid cell
 }
 
 /*-----------------------------------------------------------------------------
@@ -3517,6 +3522,11 @@ sdword WarpToLevelEnabled()
     sdword status;
     sdword warpLevel;
 
+    if (spWarpLevelOverride > 1)
+    {
+        return spWarpLevelOverride;
+    }
+
     if (fileExists(WARP_FILENAME,0))
     {
         fh = fileOpen(WARP_FILENAME,FF_TextMode);
@@ -252,6 +252,7 @@ extern char CurrentLevelName[];
 =============================================================================*/
 
 extern sdword SINGLEPLAYER_STARTINGRUS;
+extern sdword spWarpLevelOverride;
 extern char spMissionsDir[];
 extern char spMissionsFile[];
 
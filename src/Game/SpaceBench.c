@@ -0,0 +1,298 @@
+// =============================================================================
+//  SpaceBench.c
+//  - headless spatial query benchmark, fills a mission with asteroids and
+//    times range and nearest queries against walking the resource list
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "SpaceBench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "AIUtilities.h"
+#include "Globals.h"
+#include "main.h"
+#include "Sensors.h"
+#include "SimBench.h"
+#include "SpaceQuery.h"
+#include "TimeoutTimer.h"
+#include "Universe.h"
+#include "UnivUpdate.h"
+#include "utility.h"
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool spaceBenchEnabled = FALSE;
+static udword spaceBenchQueries = SPACEBENCH_DEFAULT_QUERIES;
+
+//universe sizes the queries are timed at, asteroids are added to reach each one
+static udword spaceBenchSizes[] = {1000, 5000, 10000};
+
+//own random numbers so the layout is the same every run and the game's
+//random number streams aren't disturbed
+static udword spaceBenchSeed = 0x7654321;
+
+//the kinds of query timed
+typedef enum
+{
+    SBQ_Sphere,
+    SBQ_Box,
+    SBQ_Nearest,
+    SBQ_NumberQueries
+} sbquery;
+
+static char *spaceBenchQueryNames[SBQ_NumberQueries] = {"sphere", "box", "nearest"};
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchSet
+    Description : Command-line handler for /spaceBench <nQueries>
+    Inputs      : string - number of queries of each kind to time
+    Outputs     : enables the benchmark and headless mode
+    Return      : TRUE
+----------------------------------------------------------------------------*/
+bool spaceBenchSet(char *string)
+{
+    sscanf(string, "%u", &spaceBenchQueries);
+    if (spaceBenchQueries == 0)
+    {
+        spaceBenchQueries = SPACEBENCH_DEFAULT_QUERIES;
+    }
+    spaceBenchEnabled = TRUE;
+    mainHeadless = TRUE;
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchRandom
+    Description : Returns a random number from low to high
+    Inputs      : low, high - range of the number
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static real32 spaceBenchRandom(real32 low, real32 high)
+{
+    spaceBenchSeed = spaceBenchSeed * 1664525 + 1013904223;
+    return(low + (high - low) * (real32)(spaceBenchSeed >> 8) / (real32)(1 << 24));
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchRandomPoint
+    Description : Picks a random point in the mission sphere's bounding box
+    Inputs      :
+    Outputs     : point - where to put it
+    Return      :
+----------------------------------------------------------------------------*/
+static void spaceBenchRandomPoint(vector *point)
+{
+    point->x = spaceBenchRandom(-smUniverseSizeX, smUniverseSizeX) * 0.9f;
+    point->y = spaceBenchRandom(-smUniverseSizeY, smUniverseSizeY) * 0.9f;
+    point->z = spaceBenchRandom(-smUniverseSizeZ, smUniverseSizeZ) * 0.9f;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchWalk
+    Description : Answers a query the way the game used to, by walking the
+                  whole resource list.
+    Inputs      : query - kind of query
+                  point - centre of the query
+                  found - where to put up to SPACEBENCH_NEAREST of the
+                    objects found, for comparing
+    Outputs     :
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+static sdword spaceBenchWalk(sbquery query, vector *point, SpaceObj **found)
+{
+    Node *node;
+    SpaceObj *obj;
+    real32 distSq[SPACEBENCH_NEAREST], thisDistSq;
+    real32 radiusSq = SPACEBENCH_QUERY_RADIUS * SPACEBENCH_QUERY_RADIUS;
+    sdword nFound = 0, index;
+
+    for (node = universe.ResourceList.head; node != NULL; node = node->next)
+    {
+        obj = (SpaceObj *)listGetStructOfNode(node);
+        switch (query)
+        {
+            case SBQ_Sphere:
+                if (aiuFindDistanceSquared(*point, obj->posinfo.position) <= radiusSq)
+                {
+                    if (nFound < SPACEBENCH_NEAREST)
+                    {
+                        found[nFound] = obj;
+                    }
+                    nFound++;
+                }
+                break;
+            case SBQ_Box:
+                if (isBetweenInclusive(obj->posinfo.position.x - point->x, -SPACEBENCH_QUERY_RADIUS, SPACEBENCH_QUERY_RADIUS) &&
+                    isBetweenInclusive(obj->posinfo.position.y - point->y, -SPACEBENCH_QUERY_RADIUS, SPACEBENCH_QUERY_RADIUS) &&
+                    isBetweenInclusive(obj->posinfo.position.z - point->z, -SPACEBENCH_QUERY_RADIUS, SPACEBENCH_QUERY_RADIUS))
+                {
+                    if (nFound < SPACEBENCH_NEAREST)
+                    {
+                        found[nFound] = obj;
+                    }
+                    nFound++;
+                }
+                break;
+            case SBQ_Nearest:
+                //insertion sort into the nearest so far; ties go to the
+                //earlier object in the list, like spqNearest
+                thisDistSq = aiuFindDistanceSquared(*point, obj->posinfo.position);
+                for (index = nFound; index > 0 && distSq[index - 1] > thisDistSq; index--)
+                {
+                    if (index < SPACEBENCH_NEAREST)
+                    {
+                        distSq[index] = distSq[index - 1];
+                        found[index] = found[index - 1];
+                    }
+                }
+                if (index < SPACEBENCH_NEAREST)
+                {
+                    distSq[index] = thisDistSq;
+                    found[index] = obj;
+                    nFound = min(nFound + 1, SPACEBENCH_NEAREST);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return(nFound);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchQuery
+    Description : Answers a query with the spatial query service
+    Inputs      : query - kind of query
+                  point - centre of the query
+                  found - where to put up to SPACEBENCH_NEAREST of the
+                    objects found, for comparing
+    Outputs     :
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+static sdword spaceBenchQuery(sbquery query, vector *point, SpaceObj **found)
+{
+    SpaceObj **results;
+    sdword nFound;
+
+    switch (query)
+    {
+        case SBQ_Sphere:
+            nFound = spqSphere(SPQ_Resources, point, SPACEBENCH_QUERY_RADIUS, NULL, NULL, &results);
+            break;
+        case SBQ_Box:
+            nFound = spqBox(SPQ_Resources, point, SPACEBENCH_QUERY_RADIUS, NULL, NULL, &results);
+            break;
+        case SBQ_Nearest:
+            nFound = spqNearest(SPQ_Resources, point, SPACEBENCH_NEAREST, NULL, NULL, &results);
+            break;
+        default:
+            return(0);
+    }
+    memcpy(found, results, sizeof(SpaceObj *) * min(nFound, SPACEBENCH_NEAREST));
+    return(nFound);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchTime
+    Description : Times spaceBenchQueries random queries of one kind, both
+                  ways, and checks that they found the same objects.
+    Inputs      : query - kind of query
+                  walkRate, gridRate - where to return the queries/second
+    Outputs     :
+    Return      : number of queries that didn't match
+----------------------------------------------------------------------------*/
+static udword spaceBenchTime(sbquery query, real64 *walkRate, real64 *gridRate)
+{
+    SpaceObj *walkFound[SPACEBENCH_NEAREST], *gridFound[SPACEBENCH_NEAREST];
+    sdword walkNumber, gridNumber;
+    sqword walkTime = 0, gridTime = 0, timeStart, timeStop;
+    udword index, nMismatches = 0;
+    vector point;
+
+    for (index = 0; index < spaceBenchQueries; index++)
+    {
+        spaceBenchRandomPoint(&point);
+
+        GetRawTime(&timeStart);
+        walkNumber = spaceBenchWalk(query, &point, walkFound);
+        GetRawTime(&timeStop);
+        walkTime += timeStop - timeStart;
+
+        GetRawTime(&timeStart);
+        gridNumber = spaceBenchQuery(query, &point, gridFound);
+        GetRawTime(&timeStop);
+        gridTime += timeStop - timeStart;
+
+        if (walkNumber != gridNumber ||
+            memcmp(walkFound, gridFound, sizeof(SpaceObj *) * min(walkNumber, SPACEBENCH_NEAREST)) != 0)
+        {
+            nMismatches++;
+        }
+    }
+
+    *walkRate = (real64)spaceBenchQueries * 1000000.0 / (real64)max(walkTime, 1);
+    *gridRate = (real64)spaceBenchQueries * 1000000.0 / (real64)max(gridTime, 1);
+    return(nMismatches);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spaceBenchRun
+    Description : Fills the first mission with more and more asteroids and
+                  times sphere, box and nearest queries over the resources
+                  with the spatial query service and by walking the list.
+                  Called from main instead of the event loop when
+                  /spaceBench is given.
+    Inputs      :
+    Outputs     :
+    Return      : process exit code, 0 on success
+----------------------------------------------------------------------------*/
+sdword spaceBenchRun(void)
+{
+    real64 walkRate, gridRate;
+    udword size, nMismatches, totalMismatches = 0;
+    sdword query;
+    vector position;
+
+    if (!benchSinglePlayerStart())
+    {
+        printf("SpaceBench: mission didn't start\n");
+        return -1;
+    }
+
+    printf("SpaceBench: %u queries of each kind, radius %.0f\n", spaceBenchQueries, SPACEBENCH_QUERY_RADIUS);
+    for (size = 0; size < sizeof(spaceBenchSizes) / sizeof(spaceBenchSizes[0]); size++)
+    {
+        while ((udword)universe.ResourceList.num < spaceBenchSizes[size])
+        {
+            spaceBenchRandomPoint(&position);
+            if (univAddAsteroid(Asteroid1 + universe.ResourceList.num % (NUM_ASTEROIDTYPES - Asteroid1), &position) == NULL)
+            {
+                break;
+            }
+        }
+        printf("  %d resources:\n", universe.ResourceList.num);
+
+        for (query = 0; query < SBQ_NumberQueries; query++)
+        {
+            nMismatches = spaceBenchTime((sbquery)query, &walkRate, &gridRate);
+            totalMismatches += nMismatches;
+            printf("    %-8s list walk %10.0f/s, grid %10.0f/s, %5.1fx%s\n", spaceBenchQueryNames[query],
+                   walkRate, gridRate, gridRate / walkRate, nMismatches ? " MISMATCHED" : "");
+        }
+    }
+
+    gameEnd();
+    gameIsRunning = FALSE;
+
+    return (totalMismatches == 0) ? 0 : -1;
+}
@@ -0,0 +1,36 @@
+// =============================================================================
+//  SpaceBench.h
+//  - headless spatial query benchmark, fills a mission with asteroids and
+//    times range and nearest queries against walking the resource list
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___SPACEBENCH_H
+#define ___SPACEBENCH_H
+
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define SPACEBENCH_DEFAULT_QUERIES  20000
+#define SPACEBENCH_QUERY_RADIUS     8000.0f         // radius/half size of the range queries
+#define SPACEBENCH_NEAREST          4               // objects asked for by the nearest queries
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool spaceBenchEnabled;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+bool spaceBenchSet(char *string);
+
+sdword spaceBenchRun(void);
+
+#endif
@@ -0,0 +1,698 @@
+// =============================================================================
+//  SpaceQuery.c
+//  - spatial range queries over the universe's ships and resources, backed
+//    by a hashed uniform grid that is rebuilt once per universe update
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#include "SpaceQuery.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AIUtilities.h"
+#include "Alliance.h"
+#include "Debug.h"
+#include "Memory.h"
+#include "ProximitySensor.h"
+#include "Universe.h"
+
+/*=============================================================================
+    Private types:
+=============================================================================*/
+
+typedef struct
+{
+    SpaceObj *obj;
+    sdword ordinal;                 // position in the object list
+    sdword cell[3];                 // grid cell it was in when the grid was built
+} spqentry;
+
+typedef struct
+{
+    bool valid;
+    udword updateCounter;           // universe.univUpdateCounter when the grid was built
+    udword listNum;                 // list->num when the grid was built
+    sdword numEntries;
+    udword numAllocated;
+    spqentry *entries;              // grouped by hash bucket, list order within a bucket
+    sdword bucketStart[SPQ_HASH_SIZE + 1];
+    sdword minCell[3], maxCell[3];  // range of cells with anything in them
+} spqgrid;
+
+typedef struct
+{
+    real32 distanceSquared;
+    sdword ordinal;
+    SpaceObj *obj;
+} spqnear;
+
+//geometry test for a gather
+typedef bool (*spqtest)(vector *position, void *context);
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+#define SPQ_GROWBATCH           250
+
+static spqgrid spqGrids[SPQ_NumberSets];
+
+//scratch space for query results, grown as needed
+static spqentry **spqCandidates = NULL;
+static SpaceObj **spqResults = NULL;
+static spqnear *spqNears = NULL;
+static sdword spqScratchAllocated = 0;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : spqSetDirty
+    Description : Marks a set's grid out of date.  Call this whenever an
+                  object is added to or removed from the set's list, or
+                  is placed more than a cell away from where it was.
+    Inputs      : set - set of objects that changed
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void spqSetDirty(spqset set)
+{
+    spqGrids[set].valid = FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqClose
+    Description : Frees the grids and scratch space
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void spqClose(void)
+{
+    sdword set;
+
+    for (set = 0; set < SPQ_NumberSets; set++)
+    {
+        if (spqGrids[set].entries)
+        {
+            memFree(spqGrids[set].entries);
+        }
+        memset(&spqGrids[set], 0, sizeof(spqgrid));
+    }
+    if (spqCandidates)
+    {
+        memFree(spqCandidates);
+        memFree(spqResults);
+        memFree(spqNears);
+        spqCandidates = NULL;
+        spqResults = NULL;
+        spqNears = NULL;
+    }
+    spqScratchAllocated = 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqList
+    Description : Returns the list of objects a set is made from
+    Inputs      : set - set of objects
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static LinkedList *spqList(spqset set)
+{
+    switch (set)
+    {
+        case SPQ_Ships:
+            return &universe.ShipList;
+        case SPQ_Resources:
+            return &universe.ResourceList;
+        default:
+            dbgAssertOrIgnore(FALSE);
+            return &universe.ShipList;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqCellCoordinate
+    Description : Finds the grid coordinate of a position along one axis
+    Inputs      : position - position along the axis
+    Outputs     :
+    Return      : grid coordinate, clamped to +/- SPQ_MAX_CELL
+----------------------------------------------------------------------------*/
+static sdword spqCellCoordinate(real32 position)
+{
+    real64 cell = floor((real64)position / (real64)SPQ_CELL_SIZE);
+
+    if (!(cell > -SPQ_MAX_CELL))
+    {
+        return -SPQ_MAX_CELL;               // also catches NaN
+    }
+    if (cell > SPQ_MAX_CELL)
+    {
+        return SPQ_MAX_CELL;
+    }
+    return (sdword)cell;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqHash
+    Description : Hashes a grid cell to a bucket
+    Inputs      : x, y, z - grid cell
+    Outputs     :
+    Return      : bucket number
+----------------------------------------------------------------------------*/
+static udword spqHash(sdword x, sdword y, sdword z)
+{
+    return (((udword)x * 73856093u) ^ ((udword)y * 19349663u) ^ ((udword)z * 83492791u)) & (SPQ_HASH_SIZE - 1);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqScratchReserve
+    Description : Makes sure the query scratch space can hold a whole set
+    Inputs      : number - most objects a query can find
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void spqScratchReserve(sdword number)
+{
+    if (number <= spqScratchAllocated)
+    {
+        return;
+    }
+
+    number += SPQ_GROWBATCH;
+    if (spqCandidates)
+    {
+        spqCandidates = memRealloc(spqCandidates, sizeof(spqentry *) * number, "SpaceQuery", NonVolatile);
+        spqResults = memRealloc(spqResults, sizeof(SpaceObj *) * number, "SpaceQuery", NonVolatile);
+        spqNears = memRealloc(spqNears, sizeof(spqnear) * number, "SpaceQuery", NonVolatile);
+    }
+    else
+    {
+        spqCandidates = memAlloc(sizeof(spqentry *) * number, "SpaceQuery", NonVolatile);
+        spqResults = memAlloc(sizeof(SpaceObj *) * number, "SpaceQuery", NonVolatile);
+        spqNears = memAlloc(sizeof(spqnear) * number, "SpaceQuery", NonVolatile);
+    }
+    spqScratchAllocated = number;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqGridBuild
+    Description : Rebuilds a set's grid if it's out of date: the first time
+                  it's used in each universe update, or after objects were
+                  added or removed.  The objects are counting-sorted into
+                  their buckets so each bucket is in list order.  Nothing
+                  has to say when objects move; queries look one cell
+                  beyond the range they test (see SPQ_CELL_SIZE) and test
+                  each object's current position.
+    Inputs      : set - set of objects
+    Outputs     :
+    Return      : the grid
+----------------------------------------------------------------------------*/
+static spqgrid *spqGridBuild(spqset set)
+{
+    spqgrid *grid = &spqGrids[set];
+    LinkedList *list = spqList(set);
+    sdword cursor[SPQ_HASH_SIZE];
+    spqentry entry;
+    Node *node;
+    SpaceObj *obj;
+    sdword index, axis, newnumber;
+    udword bucket;
+
+    //an object added or removed without an spqSetDirty still changes the count
+    if (grid->valid && grid->listNum == list->num && grid->updateCounter == universe.univUpdateCounter)
+    {
+        return grid;
+    }
+
+    if (list->num > grid->numAllocated)
+    {
+        newnumber = list->num + SPQ_GROWBATCH;
+        if (grid->entries)
+        {
+            grid->entries = memRealloc(grid->entries, sizeof(spqentry) * newnumber, "SpaceQuery", NonVolatile);
+        }
+        else
+        {
+            grid->entries = memAlloc(sizeof(spqentry) * newnumber, "SpaceQuery", NonVolatile);
+        }
+        grid->numAllocated = newnumber;
+    }
+    spqScratchReserve(list->num);
+
+    memset(grid->bucketStart, 0, sizeof(grid->bucketStart));
+    for (axis = 0; axis < 3; axis++)
+    {
+        grid->minCell[axis] = SPQ_MAX_CELL;
+        grid->maxCell[axis] = -SPQ_MAX_CELL;
+    }
+
+    for (node = list->head; node != NULL; node = node->next)
+    {
+        obj = (SpaceObj *)listGetStructOfNode(node);
+        grid->bucketStart[spqHash(spqCellCoordinate(obj->posinfo.position.x),
+                                  spqCellCoordinate(obj->posinfo.position.y),
+                                  spqCellCoordinate(obj->posinfo.position.z))]++;
+    }
+    for (bucket = 0, index = 0; bucket <= SPQ_HASH_SIZE; bucket++)
+    {
+        newnumber = grid->bucketStart[bucket];
+        grid->bucketStart[bucket] = index;
+        index += newnumber;
+    }
+    memcpy(cursor, grid->bucketStart, sizeof(cursor));
+
+    for (node = list->head, index = 0; node != NULL; node = node->next, index++)
+    {
+        obj = (SpaceObj *)listGetStructOfNode(node);
+        entry.obj = obj;
+        entry.ordinal = index;
+        entry.cell[0] = spqCellCoordinate(obj->posinfo.position.x);
+        entry.cell[1] = spqCellCoordinate(obj->posinfo.position.y);
+        entry.cell[2] = spqCellCoordinate(obj->posinfo.position.z);
+        for (axis = 0; axis < 3; axis++)
+        {
+            grid->minCell[axis] = min(grid->minCell[axis], entry.cell[axis]);
+            grid->maxCell[axis] = max(grid->maxCell[axis], entry.cell[axis]);
+        }
+        grid->entries[cursor[spqHash(entry.cell[0], entry.cell[1], entry.cell[2])]++] = entry;
+    }
+
+    grid->numEntries = index;
+    grid->listNum = list->num;
+    grid->updateCounter = universe.univUpdateCounter;
+    grid->valid = TRUE;
+    return grid;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqOrdinalCompare
+    Description : qsort callback to put candidates in list order
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static int spqOrdinalCompare(const void *p1, const void *p2)
+{
+    return (*(spqentry **)p1)->ordinal - (*(spqentry **)p2)->ordinal;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqGather
+    Description : Finds the objects in a set that pass a geometry test and
+                  then a filter.  Only the grid cells overlapping the test's
+                  bounding box, and one cell more all round for objects
+                  that have moved since the grid was built, are looked at,
+                  unless there are more of them than objects, in which case
+                  every object is.  The candidates are put in list order
+                  before they're filtered so filters that use random
+                  numbers stay deterministic.
+    Inputs      : set - set of objects
+                  lo, hi - bounding box of the test
+                  test, testContext - geometry test
+                  filter, context - optional filter
+    Outputs     : results - set to the objects found
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+static sdword spqGather(spqset set, vector *lo, vector *hi, spqtest test, void *testContext,
+                        spqfilter filter, void *context, SpaceObj ***results)
+{
+    spqgrid *grid = spqGridBuild(set);
+    sdword cellLo[3], cellHi[3];
+    sdword x, y, z, axis, index, numCandidates = 0, numResults = 0;
+    real32 numCells = 1.0f;
+    spqentry *entry, *end;
+    udword bucket;
+
+    *results = spqResults;
+    if (grid->numEntries == 0)
+    {
+        return 0;
+    }
+
+    cellLo[0] = spqCellCoordinate(lo->x); cellHi[0] = spqCellCoordinate(hi->x);
+    cellLo[1] = spqCellCoordinate(lo->y); cellHi[1] = spqCellCoordinate(hi->y);
+    cellLo[2] = spqCellCoordinate(lo->z); cellHi[2] = spqCellCoordinate(hi->z);
+    for (axis = 0; axis < 3; axis++)
+    {
+        cellLo[axis] = max(cellLo[axis] - 1, grid->minCell[axis]);
+        cellHi[axis] = min(cellHi[axis] + 1, grid->maxCell[axis]);
+        if (cellLo[axis] > cellHi[axis])
+        {
+            return 0;
+        }
+        numCells *= (real32)(cellHi[axis] - cellLo[axis] + 1);
+    }
+
+    if (numCells > (real32)grid->numEntries)
+    {                                                       //cheaper to look at everything
+        for (index = 0; index < grid->numEntries; index++)
+        {
+            entry = &grid->entries[index];
+            if (test(&entry->obj->posinfo.position, testContext))
+            {
+                spqCandidates[numCandidates++] = entry;
+            }
+        }
+    }
+    else
+    {
+        for (x = cellLo[0]; x <= cellHi[0]; x++)
+        {
+            for (y = cellLo[1]; y <= cellHi[1]; y++)
+            {
+                for (z = cellLo[2]; z <= cellHi[2]; z++)
+                {
+                    bucket = spqHash(x, y, z);
+                    end = &grid->entries[grid->bucketStart[bucket + 1]];
+                    for (entry = &grid->entries[grid->bucketStart[bucket]]; entry < end; entry++)
+                    {
+                        if (entry->cell[0] == x && entry->cell[1] == y && entry->cell[2] == z &&
+                            test(&entry->obj->posinfo.position, testContext))
+                        {
+                            spqCandidates[numCandidates++] = entry;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (numCandidates > 1)
+    {
+        qsort(spqCandidates, numCandidates, sizeof(spqentry *), spqOrdinalCompare);
+    }
+
+    for (index = 0; index < numCandidates; index++)
+    {
+        if (filter == NULL || filter(spqCandidates[index]->obj, context))
+        {
+            spqResults[numResults++] = spqCandidates[index]->obj;
+        }
+    }
+    return numResults;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqSphereTest, spqBoxTest, spqVolumeTest
+    Description : Geometry tests for spqGather.  They do exactly the same
+                  math as the list walks they replaced so the same objects
+                  come out.
+    Inputs      : position - object position
+                  context - the sphere, box or Volume
+    Outputs     :
+    Return      : TRUE if the position is inside
+----------------------------------------------------------------------------*/
+static bool spqSphereTest(vector *position, void *context)
+{
+    VolumeSphere *sphere = (VolumeSphere *)context;
+
+    return aiuFindDistanceSquared(*position, sphere->center) <= sphere->radius * sphere->radius;
+}
+
+static bool spqBoxTest(vector *position, void *context)
+{
+    VolumeSphere *box = (VolumeSphere *)context;
+    vector diff;
+
+    vecSub(diff, *position, box->center);
+    return isBetweenInclusive(diff.x, -box->radius, box->radius) &&
+           isBetweenInclusive(diff.y, -box->radius, box->radius) &&
+           isBetweenInclusive(diff.z, -box->radius, box->radius);
+}
+
+static bool spqVolumeTest(vector *position, void *context)
+{
+    return volPointInside((Volume *)context, position) != 0;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqSphere
+    Description : Finds the objects in a set within a sphere
+    Inputs      : set - set of objects
+                  centre, radius - the sphere (inclusive)
+                  filter, context - optional filter
+    Outputs     : results - set to the objects found, in list order
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+sdword spqSphere(spqset set, vector *centre, real32 radius, spqfilter filter, void *context, SpaceObj ***results)
+{
+    VolumeSphere sphere;
+    vector lo, hi;
+
+    sphere.center = *centre;
+    sphere.radius = radius;
+    radius = (real32)fabs(radius);
+    lo.x = centre->x - radius; lo.y = centre->y - radius; lo.z = centre->z - radius;
+    hi.x = centre->x + radius; hi.y = centre->y + radius; hi.z = centre->z + radius;
+
+    return spqGather(set, &lo, &hi, spqSphereTest, &sphere, filter, context, results);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqBox
+    Description : Finds the objects in a set within an axis-aligned cube
+    Inputs      : set - set of objects
+                  centre, halfSize - the cube (inclusive)
+                  filter, context - optional filter
+    Outputs     : results - set to the objects found, in list order
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+sdword spqBox(spqset set, vector *centre, real32 halfSize, spqfilter filter, void *context, SpaceObj ***results)
+{
+    VolumeSphere box;
+    vector lo, hi;
+
+    box.center = *centre;
+    box.radius = halfSize;
+    lo.x = centre->x - halfSize; lo.y = centre->y - halfSize; lo.z = centre->z - halfSize;
+    hi.x = centre->x + halfSize; hi.y = centre->y + halfSize; hi.z = centre->z + halfSize;
+
+    return spqGather(set, &lo, &hi, spqBoxTest, &box, filter, context, results);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqVolume
+    Description : Finds the objects in a set within a mission script Volume
+    Inputs      : set - set of objects
+                  volume - the volume, as tested by volPointInside
+                  filter, context - optional filter
+    Outputs     : results - set to the objects found, in list order
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+sdword spqVolume(spqset set, Volume *volume, spqfilter filter, void *context, SpaceObj ***results)
+{
+    vector lo, hi;
+    real32 radius;
+
+    switch (volume->type)
+    {
+        case VOLUME_AA_BOX:
+            lo.x = volume->attribs.aaBox.x0; hi.x = volume->attribs.aaBox.x1;
+            lo.y = volume->attribs.aaBox.y0; hi.y = volume->attribs.aaBox.y1;
+            lo.z = volume->attribs.aaBox.z0; hi.z = volume->attribs.aaBox.z1;
+            break;
+
+        case VOLUME_SPHERE:
+            radius = (real32)fabs(volume->attribs.sphere.radius);
+            lo.x = volume->attribs.sphere.center.x - radius; hi.x = volume->attribs.sphere.center.x + radius;
+            lo.y = volume->attribs.sphere.center.y - radius; hi.y = volume->attribs.sphere.center.y + radius;
+            lo.z = volume->attribs.sphere.center.z - radius; hi.z = volume->attribs.sphere.center.z + radius;
+            break;
+
+        default:
+            *results = spqResults;
+            return 0;
+    }
+
+    return spqGather(set, &lo, &hi, spqVolumeTest, volume, filter, context, results);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqNearConsider
+    Description : Adds an object to the k nearest found so far if it's
+                  nearer than the farthest of them.  Ties go to the object
+                  earlier in the list, like a list walk with a < test.
+    Inputs      : nears, numNears, k - nearest so far, sorted
+                  entry - object to consider
+                  point - point to measure from
+                  filter, context - optional filter
+    Outputs     :
+    Return      : new number of nearest
+----------------------------------------------------------------------------*/
+static sdword spqNearConsider(spqnear *nears, sdword numNears, sdword k, spqentry *entry, vector *point,
+                              spqfilter filter, void *context)
+{
+    vector diff;
+    real32 distanceSquared;
+    sdword index;
+
+    vecSub(diff, entry->obj->posinfo.position, *point);
+    distanceSquared = vecMagnitudeSquared(diff);
+
+    if (numNears == k &&
+        (distanceSquared > nears[k - 1].distanceSquared ||
+         (distanceSquared == nears[k - 1].distanceSquared && entry->ordinal > nears[k - 1].ordinal)))
+    {
+        return numNears;
+    }
+    if (filter != NULL && !filter(entry->obj, context))
+    {
+        return numNears;
+    }
+
+    index = (numNears < k) ? numNears++ : k - 1;
+    while (index > 0 &&
+           (nears[index - 1].distanceSquared > distanceSquared ||
+            (nears[index - 1].distanceSquared == distanceSquared && nears[index - 1].ordinal > entry->ordinal)))
+    {
+        nears[index] = nears[index - 1];
+        index--;
+    }
+    nears[index].distanceSquared = distanceSquared;
+    nears[index].ordinal = entry->ordinal;
+    nears[index].obj = entry->obj;
+    return numNears;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqNearest
+    Description : Finds the k objects in a set nearest to a point by
+                  searching rings of grid cells outward from the point
+                  until nothing farther out can be nearer.  The filter is
+                  called in no particular order, so it must not have side
+                  effects.
+    Inputs      : set - set of objects
+                  point - point to measure from
+                  k - most objects to find
+                  filter, context - optional filter
+    Outputs     : results - set to the objects found, nearest first
+    Return      : number of objects found
+----------------------------------------------------------------------------*/
+sdword spqNearest(spqset set, vector *point, sdword k, spqfilter filter, void *context, SpaceObj ***results)
+{
+    spqgrid *grid = spqGridBuild(set);
+    sdword centre[3], ring, maxRing, axis, x, y, z, step;
+    sdword index, numNears = 0, numVisited = 0, ringCells;
+    real32 bound;
+    spqentry *entry, *end;
+    udword bucket;
+
+    *results = spqResults;
+    k = min(k, grid->numEntries);
+    if (k <= 0)
+    {
+        return 0;
+    }
+
+    centre[0] = spqCellCoordinate(point->x);
+    centre[1] = spqCellCoordinate(point->y);
+    centre[2] = spqCellCoordinate(point->z);
+    maxRing = 0;
+    for (axis = 0; axis < 3; axis++)
+    {
+        maxRing = max(maxRing, centre[axis] - grid->minCell[axis]);
+        maxRing = max(maxRing, grid->maxCell[axis] - centre[axis]);
+    }
+
+    for (ring = 0; ring <= maxRing; ring++)
+    {
+        ringCells = (ring == 0) ? 1 : 24 * ring * ring + 2;
+        numVisited += ringCells;
+        if (numVisited > grid->numEntries)
+        {                                                   //cheaper to look at everything that's left
+            numNears = 0;
+            for (index = 0; index < grid->numEntries; index++)
+            {
+                numNears = spqNearConsider(spqNears, numNears, k, &grid->entries[index], point, filter, context);
+            }
+            break;
+        }
+
+        for (x = centre[0] - ring; x <= centre[0] + ring; x++)
+        {
+            if (x < grid->minCell[0] || x > grid->maxCell[0])
+            {
+                continue;
+            }
+            for (y = centre[1] - ring; y <= centre[1] + ring; y++)
+            {
+                if (y < grid->minCell[1] || y > grid->maxCell[1])
+                {
+                    continue;
+                }
+                //only the shell of the cube: the ends along z unless x or y is on the shell
+                step = (abs(x - centre[0]) == ring || abs(y - centre[1]) == ring || ring == 0) ? 1 : 2 * ring;
+                for (z = centre[2] - ring; z <= centre[2] + ring; z += step)
+                {
+                    if (z < grid->minCell[2] || z > grid->maxCell[2])
+                    {
+                        continue;
+                    }
+                    bucket = spqHash(x, y, z);
+                    end = &grid->entries[grid->bucketStart[bucket + 1]];
+                    for (entry = &grid->entries[grid->bucketStart[bucket]]; entry < end; entry++)
+                    {
+                        if (entry->cell[0] == x && entry->cell[1] == y && entry->cell[2] == z)
+                        {
+                            numNears = spqNearConsider(spqNears, numNears, k, entry, point, filter, context);
+                        }
+                    }
+                }
+            }
+        }
+
+        //anything filed in a cell outside this ring is in a cell at least
+        //ring cells out now, so at least ring - 1 cells away (shaved a
+        //little so rounding can't make a tie look farther)
+        bound = (real32)(ring - 1) * SPQ_CELL_SIZE * 0.9999f;
+        if (numNears == k && ring > 0 && spqNears[k - 1].distanceSquared < bound * bound)
+        {
+            break;
+        }
+    }
+
+    for (index = 0; index < numNears; index++)
+    {
+        spqResults[index] = spqNears[index].obj;
+    }
+    return numNears;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : spqShipFilter
+    Description : Ready-made filter for the ship set
+    Inputs      : obj - ship
+                  context - spqshipfilter
+    Outputs     :
+    Return      : TRUE if the ship passes
+----------------------------------------------------------------------------*/
+bool spqShipFilter(SpaceObj *obj, void *context)
+{
+    spqshipfilter *shipFilter = (spqshipfilter *)context;
+    Ship *ship = (Ship *)obj;
+
+    if (ship->flags & shipFilter->notFlags)
+    {
+        return FALSE;
+    }
+    if (shipFilter->owner != NULL && ship->playerowner != shipFilter->owner)
+    {
+        return FALSE;
+    }
+    if (shipFilter->enemyOf != NULL && allianceIsShipAlly(ship, shipFilter->enemyOf))
+    {
+        return FALSE;
+    }
+    if (shipFilter->visibleTo != NULL && bitTest(ship->flags, SOF_Cloaked) &&
+        !proximityCanPlayerSeeShip(shipFilter->visibleTo, ship))
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
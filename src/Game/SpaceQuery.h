@@ -0,0 +1,72 @@
+// =============================================================================
+//  SpaceQuery.h
+//  - spatial range queries over the universe's ships and resources, backed
+//    by a hashed uniform grid that is rebuilt once per universe update
+// =============================================================================
+//  Created 10/16/2026
+// =============================================================================
+
+#ifndef ___SPACEQUERY_H
+#define ___SPACEQUERY_H
+
+#include "SpaceObj.h"
+#include "Types.h"
+#include "Vector.h"
+#include "Volume.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+//objects are filed by where they were when the grid was built, at their
+//set's first query in each universe update, and are found as long as
+//they've since moved less than a cell, far more than a ship moves in an
+//update.  Code that places an object farther away part way through an
+//update (NIS jumps and seeks, hyperspace arrivals) calls spqSetDirty.
+#define SPQ_CELL_SIZE           5000.0f         // size of a grid cell
+#define SPQ_HASH_SIZE           4096            // grid cells hashed into this many buckets (power of 2)
+#define SPQ_MAX_CELL            (1 << 20)       // grid coordinates are clamped to +/- this
+
+//sets of objects that can be queried
+typedef enum
+{
+    SPQ_Ships,                  // universe.ShipList
+    SPQ_Resources,              // universe.ResourceList
+    SPQ_NumberSets
+} spqset;
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//called for every object found, in list order, to decide whether to keep it.
+//Filters must not add or remove objects or run queries of their own.
+typedef bool (*spqfilter)(SpaceObj *obj, void *context);
+
+//context for spqShipFilter
+typedef struct
+{
+    udword notFlags;            // skip ships with any of these SOF_ flags
+    struct Player *owner;       // only ships belonging to this player, if not NULL
+    struct Player *enemyOf;     // only ships this player isn't allied with, if not NULL
+    struct Player *visibleTo;   // skip cloaked ships this player can't see, if not NULL
+} spqshipfilter;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void spqSetDirty(spqset set);
+void spqClose(void);
+
+//All of these return the number of objects found and point *results at them.
+//The results are in list order (nearest first for spqNearest) and are good
+//until the next query.
+sdword spqSphere(spqset set, vector *centre, real32 radius, spqfilter filter, void *context, SpaceObj ***results);
+sdword spqBox(spqset set, vector *centre, real32 halfSize, spqfilter filter, void *context, SpaceObj ***results);
+sdword spqVolume(spqset set, Volume *volume, spqfilter filter, void *context, SpaceObj ***results);
+sdword spqNearest(spqset set, vector *point, sdword k, spqfilter filter, void *context, SpaceObj ***results);
+
+bool spqShipFilter(SpaceObj *obj, void *context);
+
+#endif
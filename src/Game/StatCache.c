@@ -0,0 +1,612 @@
+// =============================================================================
+//  StatCache.c
+//  - parsed static scripts kept between runs, so ship, gun and dock scripts
+//    don't have to be read and parsed again on every load
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#include "StatCache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Color.h"
+#include "CRC32.h"
+#include "Debug.h"
+#include "File.h"
+#include "Formation.h"
+#include "Memory.h"
+#include "Tactics.h"
+
+#ifdef _MSC_VER
+    #define strcasecmp  _stricmp
+#else
+    #include <strings.h>
+#endif
+
+/*=============================================================================
+    Overview:
+
+    The script readers in StatScript.c look a script up here by name and by
+    fileStampGet before opening it.  On a hit they replay the recorded
+    lines instead of reading and parsing the file; on a miss they record
+    every line parseLine returns and add the lot when the file is closed.
+    Field values set by one of the converters below are also kept, already
+    converted, the first time they are set so later loads can copy them
+    straight into place.  Only callbacks that always write the same
+    fixed-size value for the same text are listed; anything that reads
+    what's already there, allocates or indexes by the value is always
+    called.
+
+    Everything is saved to STATCACHE_FILENAME in the user settings
+    directory on shutdown if anything changed, and read back in one piece
+    on startup.  The whole file is thrown away if it was written by a
+    different build.  Main thread only.
+=============================================================================*/
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+typedef struct
+{
+    setVarCback setVarCB;
+    uword size;                                 // bytes it writes at dataToFillIn
+}
+statcacheconverter;
+
+//layout of the cache file: header, file records, lines, strings
+typedef struct
+{
+    udword magic;
+    udword key;                                 // statCacheKey of the build that wrote it
+    udword numFiles;
+    udword numLines;
+    udword stringsLength;
+}
+statcacheheader;
+
+typedef struct
+{
+    udword name;                                // offset in the strings
+    udword stamp;
+    udword firstLine;
+    udword numLines;
+}
+statcacherecord;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+bool statCacheEnabled = TRUE;
+statcachestats statCacheStats;
+
+static statcacheconverter statCacheConverters[] =
+{
+    { scriptSetRGBCB,                   sizeof(color) },
+    { scriptSetRGBACB,                  sizeof(color) },
+    { scriptSetReal32CB,                sizeof(real32) },
+    { scriptSetReal32SqrCB,             sizeof(real32) },
+    { scriptSetSbyteCB,                 sizeof(sbyte) },
+    { scriptSetUbyteCB,                 sizeof(ubyte) },
+    { scriptSetSwordCB,                 sizeof(sword) },
+    { scriptSetUwordCB,                 sizeof(uword) },
+    { scriptSetSdwordCB,                sizeof(sdword) },
+    { scriptSetUdwordCB,                sizeof(udword) },
+    { scriptSetBool8,                   sizeof(bool8) },
+    { scriptSetBool,                    sizeof(bool) },
+    { scriptSetCosAngCB,                sizeof(real32) },
+    { scriptSetCosAngSqrCB,             sizeof(real32) },
+    { scriptSetSinAngCB,                sizeof(real32) },
+    { scriptSetTanAngCB,                sizeof(real32) },
+    { scriptSetAngCB,                   sizeof(real32) },
+    { scriptSetGunTypeCB,               sizeof(ShipClass) },
+    { scriptSetGunSoundTypeCB,          sizeof(ShipClass) },
+    { scriptSetBulletTypeCB,            sizeof(ShipClass) },
+    { scriptSetShipTypeCB,              sizeof(ShipClass) },
+    { scriptSetShipRaceCB,              sizeof(ShipClass) },
+    { scriptSetShipClassCB,             sizeof(ShipClass) },
+    { scriptSetVectorCB,                sizeof(vector) },
+    { scriptSetLWToHWMonkeyVectorCB,    sizeof(vector) },
+    { scriptSetFormationCB,             sizeof(TypeOfFormation) },
+    { scriptSetTacticsCB,               sizeof(TacticsType) },
+};
+
+#define STATCACHE_NumConverters (sizeof(statCacheConverters) / sizeof(statCacheConverters[0]))
+
+static statCacheFile **statCacheFiles = NULL;
+static udword statCacheNumFiles = 0;
+static udword statCacheMaxFiles = 0;
+static sdword statCacheHashTable[STATCACHE_HashSize];   // index in statCacheFiles, or -1
+
+static void *statCacheBlock = NULL;                     // the cache file as read from disk
+static bool statCacheRunning = FALSE;
+static bool statCacheDirty = FALSE;
+
+/*=============================================================================
+    Private functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheKey
+    Description : Identifies the layout of the cache and the build that made
+                  it.  Converted values are only good for the build that
+                  converted them (the enums behind the type names, the
+                  sizes of the fields), so any rebuild of this module
+                  throws the cache away.
+    Inputs      :
+    Outputs     :
+    Return      : CRC to put in and expect in the cache file header
+----------------------------------------------------------------------------*/
+static udword statCacheKey(void)
+{
+    char keyString[256];
+    sdword length;
+    udword index;
+
+    length = sprintf(keyString, "%d %d %s %s", STATCACHE_VERSION, (sdword)sizeof(statCacheLine), __DATE__, __TIME__);
+    for (index = 0; index < STATCACHE_NumConverters; index++)
+    {
+        length += sprintf(keyString + length, " %d", statCacheConverters[index].size);
+    }
+    dbgAssertOrIgnore(length < (sdword)sizeof(keyString));
+
+    return crc32Compute((ubyte *)keyString, length);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheHash
+    Description : Case-insensitive hash of a script's file name.
+    Inputs      : fileName
+    Outputs     :
+    Return      : hash table slot to start looking in
+----------------------------------------------------------------------------*/
+static udword statCacheHash(char *fileName)
+{
+    udword hash = 2166136261u;
+    char c;
+
+    for (; *fileName; fileName++)
+    {
+        c = *fileName;
+        if (c >= 'A' && c <= 'Z')
+        {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ (ubyte)c) * 16777619u;
+    }
+    return (hash ^ (hash >> 16)) & (STATCACHE_HashSize - 1);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheSlot
+    Description : Finds the hash table slot of a script, or the empty slot it
+                  would go in.
+    Inputs      : fileName
+    Outputs     :
+    Return      : index in statCacheHashTable
+----------------------------------------------------------------------------*/
+static udword statCacheSlot(char *fileName)
+{
+    udword slot = statCacheHash(fileName);
+
+    while (statCacheHashTable[slot] != -1 &&
+           strcasecmp(statCacheFiles[statCacheHashTable[slot]]->fileName, fileName) != 0)
+    {
+        slot = (slot + 1) & (STATCACHE_HashSize - 1);
+    }
+    return slot;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheInsert
+    Description : Adds a script to the file list and the hash table.
+    Inputs      : file - record, which the cache takes over
+                  slot - empty slot from statCacheSlot
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void statCacheInsert(statCacheFile *file, udword slot)
+{
+    if (statCacheNumFiles == statCacheMaxFiles)
+    {
+        statCacheMaxFiles += 256;
+        statCacheFiles = memRealloc(statCacheFiles, statCacheMaxFiles * sizeof(statCacheFile *), "statCacheFiles", NonVolatile);
+    }
+    statCacheHashTable[slot] = statCacheNumFiles;
+    statCacheFiles[statCacheNumFiles++] = file;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheFileFree
+    Description : Frees a script record and whatever it owns.
+    Inputs      : file
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void statCacheFileFree(statCacheFile *file)
+{
+    if (!file->loaded)
+    {
+        memFree(file->fileName);
+        memFree(file->lines);
+        memFree(file->strings);
+    }
+    memFree(file);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheLoad
+    Description : Reads the cache file saved by the last run, if it's there
+                  and was written by this build.
+    Inputs      :
+    Outputs     : fills in the file list
+    Return      :
+----------------------------------------------------------------------------*/
+static void statCacheLoad(void)
+{
+    statcacheheader *header;
+    statcacherecord *records;
+    statCacheLine *lines;
+    char *strings;
+    statCacheFile *file;
+    sdword length;
+    udword index, slot;
+
+    if (!fileExists(STATCACHE_FILENAME, FF_UserSettingsPath))
+    {
+        return;
+    }
+    length = fileLoadAlloc(STATCACHE_FILENAME, &statCacheBlock, FF_UserSettingsPath|NonVolatile);
+
+    header = (statcacheheader *)statCacheBlock;
+    if (length < (sdword)sizeof(statcacheheader) ||
+        header->magic != STATCACHE_MAGIC ||
+        header->key != statCacheKey() ||
+        header->numFiles > STATCACHE_HashSize / 2 ||
+        header->stringsLength == 0 ||
+        (udword)length != sizeof(statcacheheader) + header->numFiles * sizeof(statcacherecord) +
+                          header->numLines * sizeof(statCacheLine) + header->stringsLength)
+    {
+        goto discard;
+    }
+    records = (statcacherecord *)(header + 1);
+    lines = (statCacheLine *)(records + header->numFiles);
+    strings = (char *)(lines + header->numLines);
+    if (strings[header->stringsLength - 1] != 0)
+    {
+        goto discard;
+    }
+
+    for (index = 0; index < header->numLines; index++)
+    {
+        if (lines[index].name >= header->stringsLength ||
+            lines[index].value >= header->stringsLength ||
+            strlen(strings + lines[index].name) + strlen(strings + lines[index].value) + 2 > STATCACHE_LineLength)
+        {
+            goto discard;
+        }
+        if (lines[index].convert != 0 && lines[index].convert != STATCACHE_NoConvert &&
+            (lines[index].convert > STATCACHE_NumConverters ||
+             lines[index].convertSize != statCacheConverters[lines[index].convert - 1].size))
+        {
+            goto discard;
+        }
+    }
+    for (index = 0; index < header->numFiles; index++)
+    {
+        if (records[index].name >= header->stringsLength ||
+            records[index].firstLine > header->numLines ||
+            records[index].numLines > header->numLines - records[index].firstLine)
+        {
+            goto discard;
+        }
+    }
+
+    for (index = 0; index < header->numFiles; index++)
+    {
+        slot = statCacheSlot(strings + records[index].name);
+        if (statCacheHashTable[slot] != -1)
+        {                                                   //shouldn't happen, first one wins
+            continue;
+        }
+        file = memAlloc(sizeof(statCacheFile), "statCacheFile", NonVolatile);
+        file->fileName = strings + records[index].name;
+        file->stamp = records[index].stamp;
+        file->numLines = records[index].numLines;
+        file->lines = lines + records[index].firstLine;
+        file->strings = strings;
+        file->loaded = TRUE;
+        statCacheInsert(file, slot);
+    }
+    return;
+
+discard:
+    dbgMessagef("statCacheLoad: '%s' is out of date, rebuilding it", STATCACHE_FILENAME);
+    memFree(statCacheBlock);
+    statCacheBlock = NULL;
+    statCacheDirty = TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheSave
+    Description : Writes all the scripts in the cache out in one block.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void statCacheSave(void)
+{
+    statcacheheader *header;
+    statcacherecord *records;
+    statCacheLine *lines, *line;
+    statCacheFile *file;
+    char *strings, *fileName;
+    udword numLines = 0, stringsLength = 0, length;
+    udword index, lineIndex, stringIndex, offset;
+    FILE *fp;
+
+    for (index = 0; index < statCacheNumFiles; index++)
+    {
+        file = statCacheFiles[index];
+        numLines += file->numLines;
+        stringsLength += strlen(file->fileName) + 1;
+        for (lineIndex = 0; lineIndex < file->numLines; lineIndex++)
+        {
+            stringsLength += strlen(file->strings + file->lines[lineIndex].name) + 1;
+            stringsLength += strlen(file->strings + file->lines[lineIndex].value) + 1;
+        }
+    }
+
+    length = sizeof(statcacheheader) + statCacheNumFiles * sizeof(statcacherecord) +
+             numLines * sizeof(statCacheLine) + stringsLength;
+    header = memAlloc(length, "statCacheSave", 0);
+    records = (statcacherecord *)(header + 1);
+    lines = (statCacheLine *)(records + statCacheNumFiles);
+    strings = (char *)(lines + numLines);
+
+    header->magic = STATCACHE_MAGIC;
+    header->key = statCacheKey();
+    header->numFiles = statCacheNumFiles;
+    header->numLines = numLines;
+    header->stringsLength = stringsLength;
+
+    lineIndex = 0;
+    stringIndex = 0;
+    for (index = 0; index < statCacheNumFiles; index++)
+    {
+        file = statCacheFiles[index];
+
+        records[index].name = stringIndex;
+        records[index].stamp = file->stamp;
+        records[index].firstLine = lineIndex;
+        records[index].numLines = file->numLines;
+        strcpy(strings + stringIndex, file->fileName);
+        stringIndex += strlen(file->fileName) + 1;
+
+        for (offset = 0; offset < file->numLines; offset++, lineIndex++)
+        {
+            line = &lines[lineIndex];
+            *line = file->lines[offset];
+            strcpy(strings + stringIndex, file->strings + file->lines[offset].name);
+            line->name = stringIndex;
+            stringIndex += strlen(strings + stringIndex) + 1;
+            strcpy(strings + stringIndex, file->strings + file->lines[offset].value);
+            line->value = stringIndex;
+            stringIndex += strlen(strings + stringIndex) + 1;
+        }
+    }
+    dbgAssertOrIgnore(lineIndex == numLines && stringIndex == stringsLength);
+
+    fileName = filePathPrepend(STATCACHE_FILENAME, FF_UserSettingsPath);
+    if (fileMakeDestinationDirectory(fileName) && (fp = fopen(fileName, "wb")) != NULL)
+    {
+        if (fwrite(header, 1, length, fp) != length)
+        {                                                   //a short file won't pass statCacheLoad
+            dbgMessagef("statCacheSave: couldn't write '%s'", fileName);
+        }
+        fclose(fp);
+    }
+
+    memFree(header);
+}
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheStartup
+    Description : Starts the cache and reads in the one saved by the last
+                  run.  Call once the file system is set up.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void statCacheStartup(void)
+{
+#ifdef HW_BUILD_FOR_DEBUGGING
+    udword index;
+
+    for (index = 0; index < STATCACHE_NumConverters; index++)
+    {
+        dbgAssertOrIgnore(statCacheConverters[index].size <= STATCACHE_CONVERTED);
+    }
+#endif
+
+    memset(statCacheHashTable, 0xff, sizeof(statCacheHashTable));
+    memset(&statCacheStats, 0, sizeof(statCacheStats));
+    statCacheRunning = TRUE;
+    statCacheDirty = FALSE;
+
+    if (statCacheEnabled)
+    {
+        statCacheLoad();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheShutdown
+    Description : Saves the cache if anything was added to it and frees it.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void statCacheShutdown(void)
+{
+    udword index;
+
+    if (!statCacheRunning)
+    {
+        return;
+    }
+    statCacheRunning = FALSE;
+
+    dbgMessagef("statCache: %d scripts cached, %d hits, %d misses, %d fields converted",
+                statCacheNumFiles, statCacheStats.nHits, statCacheStats.nMisses, statCacheStats.nConverted);
+
+    if (statCacheEnabled && statCacheDirty)
+    {
+        statCacheSave();
+    }
+
+    for (index = 0; index < statCacheNumFiles; index++)
+    {
+        statCacheFileFree(statCacheFiles[index]);
+    }
+    if (statCacheFiles != NULL)
+    {
+        memFree(statCacheFiles);
+        statCacheFiles = NULL;
+    }
+    statCacheNumFiles = statCacheMaxFiles = 0;
+
+    if (statCacheBlock != NULL)
+    {
+        memFree(statCacheBlock);
+        statCacheBlock = NULL;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheFind
+    Description : Looks for a script in the cache.
+    Inputs      : fileName - name of the script as passed to fileOpen
+                  stamp - fileStampGet of it
+    Outputs     :
+    Return      : the cached lines, or NULL if it isn't cached or the script
+                  has changed since
+----------------------------------------------------------------------------*/
+statCacheFile *statCacheFind(char *fileName, udword stamp)
+{
+    sdword index;
+
+    if (!statCacheRunning || !statCacheEnabled)
+    {
+        return NULL;
+    }
+
+    index = statCacheHashTable[statCacheSlot(fileName)];
+    if (index == -1 || statCacheFiles[index]->stamp != stamp)
+    {
+        return NULL;
+    }
+
+    statCacheStats.nHits++;
+    return statCacheFiles[index];
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheAdd
+    Description : Adds a freshly parsed script, replacing any out of date
+                  copy of it.
+    Inputs      : fileName - name of the script as passed to fileOpen
+                  stamp - fileStampGet of it
+                  lines, numLines - the lines parseLine returned
+                  strings - names and values the lines point into
+    Outputs     : The cache takes over lines and strings, which must have
+                  come from memAlloc.
+    Return      :
+----------------------------------------------------------------------------*/
+void statCacheAdd(char *fileName, udword stamp, statCacheLine *lines, udword numLines, char *strings)
+{
+    statCacheFile *file;
+    udword slot;
+    sdword index;
+
+    if (!statCacheRunning || !statCacheEnabled)
+    {
+        goto discard;
+    }
+
+    slot = statCacheSlot(fileName);
+    index = statCacheHashTable[slot];
+    if (index == -1 && statCacheNumFiles >= STATCACHE_HashSize / 2)
+    {                                                       //full up
+        goto discard;
+    }
+
+    statCacheStats.nMisses++;
+    statCacheDirty = TRUE;
+
+    file = memAlloc(sizeof(statCacheFile), "statCacheFile", NonVolatile);
+    file->fileName = memStringDupeNV(fileName);
+    file->stamp = stamp;
+    file->numLines = numLines;
+    file->lines = lines;
+    file->strings = strings;
+    file->loaded = FALSE;
+
+    if (index == -1)
+    {
+        statCacheInsert(file, slot);
+    }
+    else
+    {
+        statCacheFileFree(statCacheFiles[index]);
+        statCacheFiles[index] = file;
+    }
+    return;
+
+discard:
+    memFree(lines);
+    memFree(strings);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheChanged
+    Description : Notes that a cached line has picked up a converted value,
+                  so the cache needs saving.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void statCacheChanged(void)
+{
+    statCacheDirty = TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : statCacheConverter
+    Description : Finds out if field values set by a callback can be kept
+                  ready-converted.
+    Inputs      : setVarCB - callback from a script table
+    Outputs     : size - number of bytes it sets
+    Return      : converter number to keep in statCacheLine.convert, or 0
+----------------------------------------------------------------------------*/
+uword statCacheConverter(setVarCback setVarCB, uword *size)
+{
+    udword index;
+
+    for (index = 0; index < STATCACHE_NumConverters; index++)
+    {
+        if (statCacheConverters[index].setVarCB == setVarCB)
+        {
+            *size = statCacheConverters[index].size;
+            return (uword)(index + 1);
+        }
+    }
+    return 0;
+}
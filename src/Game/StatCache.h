@@ -0,0 +1,82 @@
+// =============================================================================
+//  StatCache.h
+//  - parsed static scripts kept between runs, so ship, gun and dock scripts
+//    don't have to be read and parsed again on every load
+// =============================================================================
+//  Created 10/17/2026
+// =============================================================================
+
+#ifndef ___STATCACHE_H
+#define ___STATCACHE_H
+
+#include "StatScript.h"
+#include "Types.h"
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define STATCACHE_FILENAME      "StatScript.cache"
+#define STATCACHE_MAGIC         0x48435353      // "SSCH"
+#define STATCACHE_VERSION       1
+#define STATCACHE_CONVERTED     16              // largest field kept ready-converted, in bytes
+#define STATCACHE_NoConvert     0xffff          // statCacheLine.convert when the value can't be kept converted
+#define STATCACHE_LineLength    650             // longest script line, MAX_LINE_CHARS in StatScript.c
+#define STATCACHE_HashSize      4096            // must be a power of 2
+
+/*=============================================================================
+    Type definitions:
+=============================================================================*/
+
+//one "name value" line of a script
+typedef struct
+{
+    udword name;                                // offsets in the file's strings
+    udword value;
+    uword convert;                              // converter that made converted[], 0 if not tried yet
+    uword convertSize;
+    udword converted[STATCACHE_CONVERTED / sizeof(udword)];
+}
+statCacheLine;
+
+//all the lines of one script, as parseLine returned them
+typedef struct
+{
+    char *fileName;
+    udword stamp;                               // fileStampGet of the script when it was parsed
+    udword numLines;
+    statCacheLine *lines;
+    char *strings;
+    bool loaded;                                // lines and strings are in the block read from disk
+}
+statCacheFile;
+
+typedef struct
+{
+    udword nHits;                               // scripts replayed from the cache
+    udword nMisses;                             // scripts parsed and added to it
+    udword nConverted;                          // field values set without calling the callback
+}
+statcachestats;
+
+/*=============================================================================
+    Data:
+=============================================================================*/
+
+extern bool statCacheEnabled;
+extern statcachestats statCacheStats;
+
+/*=============================================================================
+    Functions:
+=============================================================================*/
+
+void statCacheStartup(void);
+void statCacheShutdown(void);
+
+statCacheFile *statCacheFind(char *fileName, udword stamp);
+void statCacheAdd(char *fileName, udword stamp, statCacheLine *lines, udword numLines, char *strings);
+void statCacheChanged(void);
+
+uword statCacheConverter(setVarCback setVarCB, uword *size);
+
+#endif
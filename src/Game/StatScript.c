@@ -24,6 +24,7 @@
 #include "Mothership.h"
 #include "MultiplayerGame.h"
 #include "SpaceObj.h"
+#include "StatCache.h"
 #include "Tactics.h"
 #include "texreg.h"
 #include "Tweak.h"
@@ -77,6 +78,43 @@ char globalScriptFileName[50];  //file name of file loaded in a script callback
 
 #define MAX_LINE_CHARS 650
 
+#define SCRIPT_INDEX_SEEDS      32              // hash seeds tried at each table size before doubling it
+#define SCRIPT_INDEX_MAXSLOTS   65536
+#define SCRIPT_TABLES_HASHSIZE  512             // must be a power of 2
+
+#define scriptTableName(table, stride, entry)   (*(char **)((ubyte *)(table) + (entry) * (stride)))
+
+/*=============================================================================
+    Private Types:
+=============================================================================*/
+
+//hash of the field names in a script table, so finding one is a single probe
+typedef struct
+{
+    void *table;                                // scriptStructEntry[] or scriptEntry[]
+    udword seed;
+    udword mask;                                // number of slots - 1
+    sword *slot;                                // table entry in each slot (or -1), NULL to search the table
+}
+scripttableindex;
+
+//a script being read, either from the file or from the cache
+typedef struct
+{
+    filehandle fh;                              // 0 when replaying from the cache
+    statCacheFile *cached;                      // lines being replayed, or NULL
+    udword nextLine;
+    statCacheLine *line;                        // line last read, if it's cached or being recorded
+    udword stamp;                               // non-zero while recording the lines for the cache
+    char fileName[80];
+    statCacheLine *lines;
+    udword numLines, maxLines;
+    char *strings;
+    udword stringsLength, maxStrings;
+    char buffer[MAX_LINE_CHARS];
+}
+scriptfile;
+
 /*=============================================================================
     Private Function prototypes:
 =============================================================================*/
@@ -90,6 +128,11 @@ void scriptSetNAVLightCB(char *directory,char *field,void *dataToFillIn);
     Private Data:
 =============================================================================*/
 
+extern sdword memModuleInit;
+
+static scripttableindex scriptTableIndices[SCRIPT_TABLES_HASHSIZE];
+static udword scriptTableIndexCount = 0;
+
 static GunStatic gunStaticTemplate;
 
 static scriptStructEntry StaticGunInfoScriptTable[] =
@@ -162,6 +205,145 @@ static scriptStructEntry StaticNavLightInfoScriptTable[] =
     Private Functions:
 =============================================================================*/
 
+/*-----------------------------------------------------------------------------
+    Name        : scriptNameHash
+    Description : Seeded hash of a field name (FNV-1a).
+    Inputs      : name, seed
+    Outputs     :
+    Return      : hash value
+----------------------------------------------------------------------------*/
+static udword scriptNameHash(char *name,udword seed)
+{
+    udword hash = 2166136261u ^ (seed * 2654435761u);
+
+    for (; *name; name++)
+    {
+        hash = (hash ^ (ubyte)*name) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptTableIndexBuild
+    Description : Finds a seed and table size for which every field name in
+                  a script table hashes to a different slot.  If a name is in
+                  the table twice the first one is used, as the linear search
+                  used to.
+    Inputs      : index - index to fill in
+                  table, stride - script table and the size of its entries
+    Outputs     : fills in index; index->slot is left NULL if no perfect
+                  hash was found
+    Return      :
+----------------------------------------------------------------------------*/
+static void scriptTableIndexBuild(scripttableindex *index,void *table,udword stride)
+{
+    udword numEntries, numSlots, seed, entry, slot;
+    char *name;
+
+    index->table = table;
+    index->seed = 0;
+    index->mask = 0;
+    index->slot = NULL;
+
+    for (numEntries = 0; scriptTableName(table, stride, numEntries) != NULL; numEntries++)
+    {
+        ;
+    }
+    if (numEntries == 0)
+    {
+        return;
+    }
+
+    for (numSlots = 4; numSlots < numEntries * 2; numSlots <<= 1)
+    {
+        ;
+    }
+    for (; numSlots <= SCRIPT_INDEX_MAXSLOTS; numSlots <<= 1)
+    {
+        index->slot = memRealloc(index->slot, numSlots * sizeof(sword), "scriptTableIndex", NonVolatile);
+        for (seed = 0; seed < SCRIPT_INDEX_SEEDS; seed++)
+        {
+            memset(index->slot, 0xff, numSlots * sizeof(sword));
+            for (entry = 0; entry < numEntries; entry++)
+            {
+                name = scriptTableName(table, stride, entry);
+                slot = scriptNameHash(name, seed) & (numSlots - 1);
+                if (index->slot[slot] == -1)
+                {
+                    index->slot[slot] = (sword)entry;
+                }
+                else if (strcmp(scriptTableName(table, stride, index->slot[slot]), name) != 0)
+                {                                           //collision, try another seed
+                    break;
+                }
+            }
+            if (entry == numEntries)
+            {
+                index->seed = seed;
+                index->mask = numSlots - 1;
+                return;
+            }
+        }
+    }
+
+    memFree(index->slot);
+    index->slot = NULL;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptTableFind
+    Description : Looks up a field name in a script table, building the
+                  table's hash the first time it's searched.
+    Inputs      : table, stride - script table and the size of its entries
+                  name - field name to look for
+    Outputs     :
+    Return      : pointer to the table entry, or NULL if it isn't there
+----------------------------------------------------------------------------*/
+static void *scriptTableFind(void *table,udword stride,char *name)
+{
+    scripttableindex *index = NULL;
+    udword slot;
+    sdword entry;
+
+    if (memModuleInit)
+    {                                                       //options are read before the memory manager starts
+        slot = (((udword)(size_t)table >> 3) * 2654435761u) & (SCRIPT_TABLES_HASHSIZE - 1);
+        while (scriptTableIndices[slot].table != NULL && scriptTableIndices[slot].table != table)
+        {
+            slot = (slot + 1) & (SCRIPT_TABLES_HASHSIZE - 1);
+        }
+        if (scriptTableIndices[slot].table == table)
+        {
+            index = &scriptTableIndices[slot];
+        }
+        else if (scriptTableIndexCount < SCRIPT_TABLES_HASHSIZE / 2)
+        {
+            index = &scriptTableIndices[slot];
+            scriptTableIndexBuild(index, table, stride);
+            scriptTableIndexCount++;
+        }
+    }
+
+    if (index == NULL || index->slot == NULL)
+    {
+        for (entry = 0; scriptTableName(table, stride, entry) != NULL; entry++)
+        {
+            if (strcmp(name, scriptTableName(table, stride, entry)) == 0)
+            {
+                return (ubyte *)table + entry * stride;
+            }
+        }
+        return NULL;
+    }
+
+    entry = index->slot[scriptNameHash(name, index->seed) & index->mask];
+    if (entry == -1 || strcmp(name, scriptTableName(table, stride, entry)) != 0)
+    {
+        return NULL;
+    }
+    return (ubyte *)table + entry * stride;
+}
+
 /*-----------------------------------------------------------------------------
     Name        : findStructEntry
     Description : looks through a scriptStructEntry table, and finds an entry
@@ -172,17 +354,7 @@ static scriptStructEntry StaticNavLightInfoScriptTable[] =
 ----------------------------------------------------------------------------*/
 scriptStructEntry *findStructEntry(scriptStructEntry info[],char *name)
 {
-    scriptStructEntry *curentry = info;
-
-    while (curentry->name != NULL)
-    {
-        if (strcmp(name,curentry->name) == 0)
-        {
-            return curentry;
-        }
-        curentry++;
-    }
-    return NULL;
+    return (scriptStructEntry *)scriptTableFind(info, sizeof(scriptStructEntry), name);
 }
 
 /*-----------------------------------------------------------------------------
@@ -195,17 +367,7 @@ scriptStructEntry *findStructEntry(scriptStructEntry info[],char *name)
 ----------------------------------------------------------------------------*/
 scriptEntry *findEntry(scriptEntry info[],char *name)
 {
-    scriptEntry *curentry = info;
-
-    while (curentry->name != NULL)
-    {
-        if (strcmp(name,curentry->name) == 0)
-        {
-            return curentry;
-        }
-        curentry++;
-    }
-    return NULL;
+    return (scriptEntry *)scriptTableFind(info, sizeof(scriptEntry), name);
 }
 
 /*=============================================================================
@@ -758,6 +920,240 @@ bool parseLine(char *line,char **returnName,char **returnValue)
     return TRUE;
 }
 
+/*=============================================================================
+    Script reading: scripts are replayed from the stat cache when it has an
+    up to date copy, otherwise they are parsed and recorded for it.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptFileOpen
+    Description : Starts reading a script, from the stat cache if it's there.
+    Inputs      : sf - reader to start
+                  fileName - script to read
+                  flags - fileOpen flags to open it with
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void scriptFileOpen(scriptfile *sf,char *fileName,udword flags)
+{
+    sf->fh = 0;
+    sf->cached = NULL;
+    sf->nextLine = 0;
+    sf->line = NULL;
+    sf->stamp = 0;
+
+    if (statCacheEnabled)
+    {
+        sf->stamp = fileStampGet(fileName, flags);
+        if (sf->stamp != 0)
+        {
+            sf->cached = statCacheFind(fileName, sf->stamp);
+            if (sf->cached != NULL)
+            {
+                sf->stamp = 0;
+                return;
+            }
+
+            strcpy(sf->fileName, fileName);
+            sf->numLines = 0;
+            sf->maxLines = 64;
+            sf->lines = memAlloc(sf->maxLines * sizeof(statCacheLine), "statCacheLines", NonVolatile);
+            sf->stringsLength = 0;
+            sf->maxStrings = 2048;
+            sf->strings = memAlloc(sf->maxStrings, "statCacheStrings", NonVolatile);
+        }
+    }
+
+    sf->fh = fileOpen(fileName, flags);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptLineRecord
+    Description : Adds a line to the ones being recorded for the stat cache.
+    Inputs      : sf - reader
+                  name, value - as parsed from the line
+    Outputs     :
+    Return      : the recorded line
+----------------------------------------------------------------------------*/
+static statCacheLine *scriptLineRecord(scriptfile *sf,char *name,char *value)
+{
+    statCacheLine *line;
+    udword nameLength = strlen(name) + 1;
+    udword valueLength = strlen(value) + 1;
+
+    if (sf->numLines == sf->maxLines)
+    {
+        sf->maxLines *= 2;
+        sf->lines = memRealloc(sf->lines, sf->maxLines * sizeof(statCacheLine), "statCacheLines", NonVolatile);
+    }
+    while (sf->stringsLength + nameLength + valueLength > sf->maxStrings)
+    {
+        sf->maxStrings *= 2;
+        sf->strings = memRealloc(sf->strings, sf->maxStrings, "statCacheStrings", NonVolatile);
+    }
+
+    line = &sf->lines[sf->numLines++];
+    memset(line, 0, sizeof(statCacheLine));
+    line->name = sf->stringsLength;
+    memcpy(sf->strings + sf->stringsLength, name, nameLength);
+    sf->stringsLength += nameLength;
+    line->value = sf->stringsLength;
+    memcpy(sf->strings + sf->stringsLength, value, valueLength);
+    sf->stringsLength += valueLength;
+
+    return line;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptLineRead
+    Description : Gets the next "name value" line of a script.
+    Inputs      : sf - reader
+    Outputs     : name, value - point into the reader's buffer, which the
+                  caller may modify
+    Return      : FALSE at the end of the script
+----------------------------------------------------------------------------*/
+static bool scriptLineRead(scriptfile *sf,char **name,char **value)
+{
+    statCacheLine *line;
+    udword nameLength;
+
+    if (sf->cached != NULL)
+    {
+        if (sf->nextLine >= sf->cached->numLines)
+        {
+            sf->line = NULL;
+            return FALSE;
+        }
+        line = sf->line = &sf->cached->lines[sf->nextLine++];
+        nameLength = strlen(sf->cached->strings + line->name) + 1;
+        memcpy(sf->buffer, sf->cached->strings + line->name, nameLength);
+        *name = sf->buffer;
+        *value = sf->buffer + nameLength;
+        strcpy(*value, sf->cached->strings + line->value);
+        return TRUE;
+    }
+
+    for (;;)
+    {
+        if (fileLineRead(sf->fh, sf->buffer, MAX_LINE_CHARS) == FR_EndOfFile)
+        {
+            sf->line = NULL;
+            return FALSE;
+        }
+        if (parseLine(sf->buffer, name, value))
+        {
+            if (sf->stamp != 0)
+            {
+                sf->line = scriptLineRecord(sf, *name, *value);
+            }
+            return TRUE;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptLineConvert
+    Description : Runs a field's callback on scratch memory to see if it sets
+                  a fixed value, and keeps that value with the line if so.
+    Inputs      : line - cached line the value came from
+                  convert, size - from statCacheConverter
+                  setVarCB, directory, value - as for the callback
+    Outputs     : line->converted
+    Return      : TRUE if the value can be copied from line->converted
+----------------------------------------------------------------------------*/
+static bool scriptLineConvert(statCacheLine *line,uword convert,uword size,setVarCback setVarCB,char *directory,char *value)
+{
+    udword zeros[STATCACHE_CONVERTED / sizeof(udword)];
+    udword ones[STATCACHE_CONVERTED / sizeof(udword)];
+    char field[MAX_LINE_CHARS];
+
+    memset(zeros, 0x00, sizeof(zeros));
+    memset(ones, 0xff, sizeof(ones));
+    strcpy(field, value);
+    setVarCB(directory, field, zeros);
+    strcpy(field, value);
+    setVarCB(directory, field, ones);
+
+    if (memcmp(zeros, ones, size) != 0)
+    {                                                       //didn't set the whole field (a bad number, say)
+        line->convert = STATCACHE_NoConvert;
+        return FALSE;
+    }
+    line->convert = convert;
+    line->convertSize = size;
+    memcpy(line->converted, zeros, size);
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptLineSet
+    Description : Sets a field from the line just read, copying the converted
+                  value from the stat cache if it has one.
+    Inputs      : sf - reader the line came from
+                  setVarCB, directory, value, dataToFillIn - as for the callback
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void scriptLineSet(scriptfile *sf,setVarCback setVarCB,char *directory,char *value,void *dataToFillIn)
+{
+    statCacheLine *line = sf->line;
+    uword convert, size;
+
+    if (line != NULL && line->convert != STATCACHE_NoConvert &&
+        (convert = statCacheConverter(setVarCB, &size)) != 0)
+    {
+        if (line->convert == convert)
+        {
+            memcpy(dataToFillIn, line->converted, size);
+            statCacheStats.nConverted++;
+            return;
+        }
+        if (line->convert == 0)
+        {
+            if (sf->cached != NULL)
+            {
+                statCacheChanged();
+            }
+            if (scriptLineConvert(line, convert, size, setVarCB, directory, value))
+            {
+                memcpy(dataToFillIn, line->converted, size);
+                return;
+            }
+        }
+    }
+
+    setVarCB(directory, value, dataToFillIn);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : scriptFileClose
+    Description : Finishes reading a script.  If it was being recorded, the
+                  rest of it is read too so the stat cache gets all of it.
+    Inputs      : sf - reader
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void scriptFileClose(scriptfile *sf)
+{
+    char *name, *value;
+
+    if (sf->fh == 0)
+    {
+        return;
+    }
+
+    if (sf->stamp != 0)
+    {
+        while (scriptLineRead(sf, &name, &value))
+        {
+            ;
+        }
+        statCacheAdd(sf->fileName, sf->stamp, sf->lines, sf->numLines, sf->strings);
+    }
+
+    fileClose(sf->fh);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : scriptSetStruct
     Description : This generalized routine, you give a filename of a script file
@@ -778,11 +1174,9 @@ bool parseLine(char *line,char **returnName,char **returnValue)
 ----------------------------------------------------------------------------*/
 void scriptSetStruct(char *directory,char *filename,scriptStructEntry info[],ubyte *structureToFillIn)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
-    sdword status;
     scriptStructEntry *foundentry;
 
     if (directory != NULL)
@@ -795,29 +1189,19 @@ void scriptSetStruct(char *directory,char *filename,scriptStructEntry info[],uby
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode|FF_IgnorePrepend);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode|FF_IgnorePrepend);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        foundentry = findStructEntry(info,name);
+        if (foundentry != NULL)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            foundentry = findStructEntry(info,name);
-            if (foundentry != NULL)
-            {
-                strcpy(globalScriptFileName,filename);
-                foundentry->setVarCB(directory,value,structureToFillIn + (foundentry->offset1 - foundentry->offset2) );
-            }
+            strcpy(globalScriptFileName,filename);
+            scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn + (foundentry->offset1 - foundentry->offset2));
         }
     }
 
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 /*-----------------------------------------------------------------------------
@@ -839,11 +1223,9 @@ void scriptSetStruct(char *directory,char *filename,scriptStructEntry info[],uby
 ----------------------------------------------------------------------------*/
 void scriptSet(char *directory,char *filename,scriptEntry info[])
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
-    sdword status;
     scriptEntry *foundentry;
 
     if (directory != NULL)
@@ -856,29 +1238,19 @@ void scriptSet(char *directory,char *filename,scriptEntry info[])
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode|FF_IgnorePrepend);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode|FF_IgnorePrepend);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        foundentry = findEntry(info,name);
+        if (foundentry != NULL)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            foundentry = findEntry(info,name);
-            if (foundentry != NULL)
-            {
-                strcpy(globalScriptFileName,filename);
-                foundentry->setVarCB(directory,value,foundentry->dataPtr);
-            }
+            strcpy(globalScriptFileName,filename);
+            scriptLineSet(&sf,foundentry->setVarCB,directory,value,foundentry->dataPtr);
         }
     }
 
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 /*-----------------------------------------------------------------------------
@@ -946,11 +1318,9 @@ extern real32 ASTEROID_HARVEST_RANGE;
 ----------------------------------------------------------------------------*/
 void scriptSetGunStatics(char *directory,char *filename,struct ShipStaticInfo *shipstatinfo)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
-    sdword status;
     scriptStructEntry *foundentry;
     sdword numGuns=0;
     sdword state = 0;
@@ -972,113 +1342,103 @@ void scriptSetGunStatics(char *directory,char *filename,struct ShipStaticInfo *s
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        switch (state)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            switch (state)
-            {
-                case SETGUNSTATE_START:
-                    if (strcmp(name,"NUMBER_OF_GUNS") == 0)
+            case SETGUNSTATE_START:
+                if (strcmp(name,"NUMBER_OF_GUNS") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numGuns);
+                    if (numGuns <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numGuns);
-                        if (numGuns <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofgunstaticinfo = sizeofGunStaticInfo(numGuns);
+                    sizeofgunstaticinfo = sizeofGunStaticInfo(numGuns);
 
-                        gunstaticinfo = memAlloc(sizeofgunstaticinfo,"gunstaticinfo",NonVolatile);
-                        memset(gunstaticinfo,0,sizeofgunstaticinfo);
-                        gunstaticinfo->numGuns = numGuns;
+                    gunstaticinfo = memAlloc(sizeofgunstaticinfo,"gunstaticinfo",NonVolatile);
+                    memset(gunstaticinfo,0,sizeofgunstaticinfo);
+                    gunstaticinfo->numGuns = numGuns;
 
-                        shipstatinfo->gunStaticInfo = gunstaticinfo;
+                    shipstatinfo->gunStaticInfo = gunstaticinfo;
 
-                        state = SETGUNSTATE_LOOKINGFORGUN;
-                    }
-                    break;
+                    state = SETGUNSTATE_LOOKINGFORGUN;
+                }
+                break;
 
-                case SETGUNSTATE_LOOKINGFORGUN:
-                    if (strcmp(name,"GUN") == 0)
-                    {
-                        scriptSetSdwordCB(directory,value,&processingGun);
-                        dbgAssertOrIgnore(processingGun >= 0);
-                        dbgAssertOrIgnore(processingGun < numGuns);
-                        gunstaticinfo->gunstatics[processingGun].slaveDriver = -1;
-                        state = SETGUNSTATE_LEFTBRACKET;
-                    }
-                    break;
+            case SETGUNSTATE_LOOKINGFORGUN:
+                if (strcmp(name,"GUN") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&processingGun);
+                    dbgAssertOrIgnore(processingGun >= 0);
+                    dbgAssertOrIgnore(processingGun < numGuns);
+                    gunstaticinfo->gunstatics[processingGun].slaveDriver = -1;
+                    state = SETGUNSTATE_LEFTBRACKET;
+                }
+                break;
+
+            case SETGUNSTATE_LEFTBRACKET:
+                if (name[0] == '{')
+                {
+                    state = SETGUNSTATE_GETGUNINFO;
+                }
+                break;
 
-                case SETGUNSTATE_LEFTBRACKET:
-                    if (name[0] == '{')
+            case SETGUNSTATE_GETGUNINFO:
+                if (name[0] == '}')
+                {
+                    state = SETGUNSTATE_LOOKINGFORGUN;
+                    if(shipstatinfo->shipclass == CLASS_Fighter)
                     {
-                        state = SETGUNSTATE_GETGUNINFO;
-                    }
-                    break;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Evasive];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Neutral];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Aggressive];
 
-                case SETGUNSTATE_GETGUNINFO:
-                    if (name[0] == '}')
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Evasive];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Neutral];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Aggressive];
+                    }
+                    else if(shipstatinfo->shipclass == CLASS_Corvette)
                     {
-                        state = SETGUNSTATE_LOOKINGFORGUN;
-                        if(shipstatinfo->shipclass == CLASS_Fighter)
-                        {
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Evasive];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Neutral];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Fighter][Aggressive];
-
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Evasive];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Neutral];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Fighter][Aggressive];
-                        }
-                        else if(shipstatinfo->shipclass == CLASS_Corvette)
-                        {
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Evasive];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Neutral];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Aggressive];
-
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Evasive];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Neutral];
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Aggressive];
-                        }
-                        else
-                        {
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
-                            gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
-                            gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
-                        }
-
-                        processingGun = -1;
-                        numGunsProcessed++;
-                        break;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Evasive];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Neutral];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo * tacticsInfo.DamageBonus[Tactics_Corvette][Aggressive];
+
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Evasive];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=   gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Neutral];
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi * tacticsInfo.DamageBonus[Tactics_Corvette][Aggressive];
                     }
                     else
                     {
-                        foundentry = findStructEntry(StaticGunInfoScriptTable,name);
-                        if (foundentry != NULL)
-                        {
-                            structureToFillIn = (ubyte *)&gunstaticinfo->gunstatics[processingGun];
-                            foundentry->setVarCB(directory,value,structureToFillIn + (foundentry->offset1 - foundentry->offset2) );
-                        }
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Evasive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Neutral]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageLo[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageLo;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Evasive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Neutral]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
+                        gunstaticinfo->gunstatics[processingGun].gunDamageHi[Aggressive]=gunstaticinfo->gunstatics[processingGun].baseGunDamageHi;
                     }
-                    break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
+                    processingGun = -1;
+                    numGunsProcessed++;
                     break;
-            }
+                }
+                else
+                {
+                    foundentry = findStructEntry(StaticGunInfoScriptTable,name);
+                    if (foundentry != NULL)
+                    {
+                        structureToFillIn = (ubyte *)&gunstaticinfo->gunstatics[processingGun];
+                        scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn + (foundentry->offset1 - foundentry->offset2));
+                    }
+                }
+                break;
+
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
@@ -1155,7 +1515,7 @@ void scriptSetGunStatics(char *directory,char *filename,struct ShipStaticInfo *s
     }
 
 done:
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 // Reads in the parameters for the nav light.
@@ -1194,8 +1554,7 @@ void scriptSetNAVLightCB(char *directory,char *field,void *dataToFillIn)
 ----------------------------------------------------------------------------*/
 void scriptSetNAVLightStatics(char *directory,char *filename,struct ShipStaticInfo *shipstatinfo)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
     sdword numNavLights;
@@ -1204,7 +1563,6 @@ void scriptSetNAVLightStatics(char *directory,char *filename,struct ShipStaticIn
     scriptStructEntry *foundentry;
     ubyte *structureToFillIn;
     sdword state = 0;
-    sdword status;
     sdword processingNAVLight = 0;
 
     // Set this just in case we don't find any nav lights.
@@ -1220,67 +1578,57 @@ void scriptSetNAVLightStatics(char *directory,char *filename,struct ShipStaticIn
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        switch (state)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            switch (state)
-            {
-                case SETNAVLIGHTSTATE_START:
-                    if (strcmp(name,"NUMBER_OF_NAV_LIGHTS") == 0)
+            case SETNAVLIGHTSTATE_START:
+                if (strcmp(name,"NUMBER_OF_NAV_LIGHTS") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numNavLights);
+                    if (numNavLights <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numNavLights);
-                        if (numNavLights <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofnavlightstaticinfo = sizeofNavLightStaticInfo(numNavLights);
+                    sizeofnavlightstaticinfo = sizeofNavLightStaticInfo(numNavLights);
 
-                        navlightstaticinfo = memAlloc(sizeofnavlightstaticinfo,"navlightstaticinfo",NonVolatile);
-                        memset(navlightstaticinfo,0,sizeofnavlightstaticinfo);
-                        navlightstaticinfo->numNAVLights = numNavLights;
+                    navlightstaticinfo = memAlloc(sizeofnavlightstaticinfo,"navlightstaticinfo",NonVolatile);
+                    memset(navlightstaticinfo,0,sizeofnavlightstaticinfo);
+                    navlightstaticinfo->numNAVLights = numNavLights;
 
-                        shipstatinfo->navlightStaticInfo = navlightstaticinfo;
+                    shipstatinfo->navlightStaticInfo = navlightstaticinfo;
 
-                        state = SETNAVLIGHTSTATE_SET;
-                    }
-                    break;
+                    state = SETNAVLIGHTSTATE_SET;
+                }
+                break;
 
-                case SETNAVLIGHTSTATE_SET:
-                    foundentry = findStructEntry(StaticNavLightInfoScriptTable,name);
-                    if (foundentry != NULL)
+            case SETNAVLIGHTSTATE_SET:
+                foundentry = findStructEntry(StaticNavLightInfoScriptTable,name);
+                if (foundentry != NULL)
+                {
+                    dbgAssertOrIgnore(processingNAVLight < numNavLights);
+                    dbgAssertOrIgnore(numNavLights > 0);
+                    structureToFillIn = (ubyte *)&navlightstaticinfo->navlightstatics[processingNAVLight];
+                    scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn);
+                    processingNAVLight++;
+                    if (processingNAVLight >= numNavLights)
                     {
-                        dbgAssertOrIgnore(processingNAVLight < numNavLights);
-                        dbgAssertOrIgnore(numNavLights > 0);
-                        structureToFillIn = (ubyte *)&navlightstaticinfo->navlightstatics[processingNAVLight];
-                        foundentry->setVarCB(directory,value,structureToFillIn);
-                        processingNAVLight++;
-                        if (processingNAVLight >= numNavLights)
-                        {
-                            goto done;
-                        }
+                        goto done;
                     }
-                    break;
+                }
+                break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
-                    break;
-            }
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
 done:
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 void scriptSetDockPointCB(char *directory,char *field,void *dataToFillIn)
@@ -1314,8 +1662,7 @@ void scriptSetDockPointCB(char *directory,char *field,void *dataToFillIn)
 ----------------------------------------------------------------------------*/
 void scriptSetDockStatics(char *directory,char *filename,struct ShipStaticInfo *shipstatinfo)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
     sdword numDockPoints;
@@ -1324,7 +1671,6 @@ void scriptSetDockStatics(char *directory,char *filename,struct ShipStaticInfo *
     scriptStructEntry *foundentry;
     ubyte *structureToFillIn;
     sdword state = 0;
-    sdword status;
     sdword processingDockPoint = 0;
 
     if (directory != NULL)
@@ -1337,67 +1683,57 @@ void scriptSetDockStatics(char *directory,char *filename,struct ShipStaticInfo *
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
-        {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
+        switch (state)
         {
-            switch (state)
-            {
-                case SETDOCKSTATE_START:
-                    if (strcmp(name,"NUMBER_OF_DOCK_POINTS") == 0)
+            case SETDOCKSTATE_START:
+                if (strcmp(name,"NUMBER_OF_DOCK_POINTS") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numDockPoints);
+                    if (numDockPoints <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numDockPoints);
-                        if (numDockPoints <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofdockstaticinfo = sizeofDockStaticInfo(numDockPoints);
+                    sizeofdockstaticinfo = sizeofDockStaticInfo(numDockPoints);
 
-                        dockstaticinfo = memAlloc(sizeofdockstaticinfo,"dockstaticinfo",NonVolatile);
-                        memset(dockstaticinfo,0,sizeofdockstaticinfo);
-                        dockstaticinfo->numDockPoints = numDockPoints;
+                    dockstaticinfo = memAlloc(sizeofdockstaticinfo,"dockstaticinfo",NonVolatile);
+                    memset(dockstaticinfo,0,sizeofdockstaticinfo);
+                    dockstaticinfo->numDockPoints = numDockPoints;
 
-                        shipstatinfo->dockStaticInfo = dockstaticinfo;
+                    shipstatinfo->dockStaticInfo = dockstaticinfo;
 
-                        state = SETDOCKSTATE_SET;
-                    }
-                    break;
+                    state = SETDOCKSTATE_SET;
+                }
+                break;
 
-                case SETDOCKSTATE_SET:
-                    foundentry = findStructEntry(StaticDockInfoScriptTable,name);
-                    if (foundentry != NULL)
+            case SETDOCKSTATE_SET:
+                foundentry = findStructEntry(StaticDockInfoScriptTable,name);
+                if (foundentry != NULL)
+                {
+                    dbgAssertOrIgnore(processingDockPoint < numDockPoints);
+                    dbgAssertOrIgnore(numDockPoints > 0);
+                    structureToFillIn = (ubyte *)&dockstaticinfo->dockstaticpoints[processingDockPoint];
+                    scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn);
+                    processingDockPoint++;
+                    if (processingDockPoint >= numDockPoints)
                     {
-                        dbgAssertOrIgnore(processingDockPoint < numDockPoints);
-                        dbgAssertOrIgnore(numDockPoints > 0);
-                        structureToFillIn = (ubyte *)&dockstaticinfo->dockstaticpoints[processingDockPoint];
-                        foundentry->setVarCB(directory,value,structureToFillIn);
-                        processingDockPoint++;
-                        if (processingDockPoint >= numDockPoints)
-                        {
-                            goto done;
-                        }
+                        goto done;
                     }
-                    break;
+                }
+                break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
-                    break;
-            }
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
 done:
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 /************ Overide Docking script setting *******************/
@@ -1455,8 +1791,7 @@ void scriptSetDockOverideCB(char *directory,char *field,void *dataToFillIn)
 ----------------------------------------------------------------------------*/
 void scriptSetDockOverideStatics(char *directory,char *filename,struct ShipStaticInfo *shipstatinfo)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
     sdword numDockOveridePoints;
@@ -1465,7 +1800,6 @@ void scriptSetDockOverideStatics(char *directory,char *filename,struct ShipStati
     scriptStructEntry *foundentry;
     ubyte *structureToFillIn;
     sdword state = 0;
-    sdword status;
     sdword processingDockOveridePoint = 0;
 
     if (directory != NULL)
@@ -1478,67 +1812,57 @@ void scriptSetDockOverideStatics(char *directory,char *filename,struct ShipStati
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
-        {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
+        switch (state)
         {
-            switch (state)
-            {
-                case SETDOCKSTATE_START:
-                    if (strcmp(name,"NUMBER_OF_DOCK_OVERIDES") == 0)
+            case SETDOCKSTATE_START:
+                if (strcmp(name,"NUMBER_OF_DOCK_OVERIDES") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numDockOveridePoints);
+                    if (numDockOveridePoints <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numDockOveridePoints);
-                        if (numDockOveridePoints <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofdockoveridestaticinfo = sizeof(DockOverideInfo) + (numDockOveridePoints - 1)*sizeof(DockStaticOveride);
+                    sizeofdockoveridestaticinfo = sizeof(DockOverideInfo) + (numDockOveridePoints - 1)*sizeof(DockStaticOveride);
 
-                        dockoverideinfo = memAlloc(sizeofdockoveridestaticinfo,"dockoverideinfo",NonVolatile);
-                        memset(dockoverideinfo,0,sizeofdockoveridestaticinfo);
-                        dockoverideinfo->numDockOverides = numDockOveridePoints;
+                    dockoverideinfo = memAlloc(sizeofdockoveridestaticinfo,"dockoverideinfo",NonVolatile);
+                    memset(dockoverideinfo,0,sizeofdockoveridestaticinfo);
+                    dockoverideinfo->numDockOverides = numDockOveridePoints;
 
-                        shipstatinfo->dockOverideInfo = dockoverideinfo;
+                    shipstatinfo->dockOverideInfo = dockoverideinfo;
 
-                        state = SETDOCKSTATE_SET;
-                    }
-                    break;
+                    state = SETDOCKSTATE_SET;
+                }
+                break;
 
-                case SETDOCKSTATE_SET:
-                    foundentry = findStructEntry(StaticDockOverideInfoScriptTable,name);
-                    if (foundentry != NULL)
+            case SETDOCKSTATE_SET:
+                foundentry = findStructEntry(StaticDockOverideInfoScriptTable,name);
+                if (foundentry != NULL)
+                {
+                    dbgAssertOrIgnore(processingDockOveridePoint < numDockOveridePoints);
+                    dbgAssertOrIgnore(numDockOveridePoints > 0);
+                    structureToFillIn = (ubyte *)&dockoverideinfo->dockOverides[processingDockOveridePoint];
+                    scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn);
+                    processingDockOveridePoint++;
+                    if (processingDockOveridePoint >= numDockOveridePoints)
                     {
-                        dbgAssertOrIgnore(processingDockOveridePoint < numDockOveridePoints);
-                        dbgAssertOrIgnore(numDockOveridePoints > 0);
-                        structureToFillIn = (ubyte *)&dockoverideinfo->dockOverides[processingDockOveridePoint];
-                        foundentry->setVarCB(directory,value,structureToFillIn);
-                        processingDockOveridePoint++;
-                        if (processingDockOveridePoint >= numDockOveridePoints)
-                        {
-                            goto done;
-                        }
+                        goto done;
                     }
-                    break;
+                }
+                break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
-                    break;
-            }
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
 done:
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 
@@ -1589,8 +1913,7 @@ void scriptSetSalvagePointCB(char *directory,char *field,void *dataToFillIn)
 
 void scriptSetSalvageStatics(char *directory,char *filename,struct StaticInfoHealthGuidanceShipDerelict *statinfo)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
     sdword numSalvagePoints;
@@ -1599,7 +1922,6 @@ void scriptSetSalvageStatics(char *directory,char *filename,struct StaticInfoHea
     scriptStructEntry *foundentry;
     ubyte *structureToFillIn;
     sdword state = 0;
-    sdword status;
     sdword processingSalvagePoint = 0;
 
     if (directory != NULL)
@@ -1612,89 +1934,79 @@ void scriptSetSalvageStatics(char *directory,char *filename,struct StaticInfoHea
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        switch (state)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            switch (state)
-            {
-                case SETSALVAGESTATE_START:
-                    if (strcmp(name,"NUMBER_OF_SALVAGE_POINTS") == 0)
+            case SETSALVAGESTATE_START:
+                if (strcmp(name,"NUMBER_OF_SALVAGE_POINTS") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numSalvagePoints);
+                    if (numSalvagePoints <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numSalvagePoints);
-                        if (numSalvagePoints <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofsalvagestaticinfo = sizeofSalvageStaticInfo(numSalvagePoints);
+                    sizeofsalvagestaticinfo = sizeofSalvageStaticInfo(numSalvagePoints);
 
-                        salvagestaticinfo = memAlloc(sizeofsalvagestaticinfo,"salvagestaticinfo",NonVolatile);
-                        memset(salvagestaticinfo,0,sizeofsalvagestaticinfo);
-                        salvagestaticinfo->numSalvagePoints = numSalvagePoints;
+                    salvagestaticinfo = memAlloc(sizeofsalvagestaticinfo,"salvagestaticinfo",NonVolatile);
+                    memset(salvagestaticinfo,0,sizeofsalvagestaticinfo);
+                    salvagestaticinfo->numSalvagePoints = numSalvagePoints;
 
-                        statinfo->salvageStaticInfo = salvagestaticinfo;
+                    statinfo->salvageStaticInfo = salvagestaticinfo;
 
-                        state = SETSALVAGESTATE_SET_NUM;
-                    }
-                    break;
-                case SETSALVAGESTATE_SET_NUM:
-                    if (strcmp(name,"NUM_NEEDED_FOR_SALVAGE") == 0)
-                    {
-                        scriptSetSdwordCB(directory,value,&salvagestaticinfo->numNeededForSalvage);
-                        state = SETSALVAGESTATE_SET_BIG;
-                    }
-                    break;
-                case SETSALVAGESTATE_SET_BIG:
-                    if (strcmp(name,"NEED_BIGR1") == 0)
-                    {
-                        scriptSetBool(directory,value,&salvagestaticinfo->needBigR1);
-                        state = SETSALVAGESTATE_SET_BIG2;
-                    }
-                    break;
-                case SETSALVAGESTATE_SET_BIG2:
-                    if (strcmp(name,"NEED_BIGR2") == 0)
-                    {
-                        scriptSetBool(directory,value,&salvagestaticinfo->needBigR2);
-                        state = SETSALVAGESTATE_SET_BIG3;
-                    }
-                    break;
-                case SETSALVAGESTATE_SET_BIG3:
-                    if (strcmp(name,"WILL_FIT_CARRIER") == 0)
-                    {
-                        scriptSetBool(directory,value,&salvagestaticinfo->willFitCarrier);
-                        state = SETSALVAGESTATE_SET;
-                    }
-                    break;
-                case SETSALVAGESTATE_SET:
-                    foundentry = findStructEntry(StaticSalvageInfoScriptTable,name);
-                    if (foundentry != NULL)
+                    state = SETSALVAGESTATE_SET_NUM;
+                }
+                break;
+            case SETSALVAGESTATE_SET_NUM:
+                if (strcmp(name,"NUM_NEEDED_FOR_SALVAGE") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&salvagestaticinfo->numNeededForSalvage);
+                    state = SETSALVAGESTATE_SET_BIG;
+                }
+                break;
+            case SETSALVAGESTATE_SET_BIG:
+                if (strcmp(name,"NEED_BIGR1") == 0)
+                {
+                    scriptSetBool(directory,value,&salvagestaticinfo->needBigR1);
+                    state = SETSALVAGESTATE_SET_BIG2;
+                }
+                break;
+            case SETSALVAGESTATE_SET_BIG2:
+                if (strcmp(name,"NEED_BIGR2") == 0)
+                {
+                    scriptSetBool(directory,value,&salvagestaticinfo->needBigR2);
+                    state = SETSALVAGESTATE_SET_BIG3;
+                }
+                break;
+            case SETSALVAGESTATE_SET_BIG3:
+                if (strcmp(name,"WILL_FIT_CARRIER") == 0)
+                {
+                    scriptSetBool(directory,value,&salvagestaticinfo->willFitCarrier);
+                    state = SETSALVAGESTATE_SET;
+                }
+                break;
+            case SETSALVAGESTATE_SET:
+                foundentry = findStructEntry(StaticSalvageInfoScriptTable,name);
+                if (foundentry != NULL)
+                {
+                    dbgAssertOrIgnore(processingSalvagePoint < numSalvagePoints);
+                    dbgAssertOrIgnore(numSalvagePoints > 0);
+                    structureToFillIn = (ubyte *)&salvagestaticinfo->salvageStaticPoints[processingSalvagePoint];
+                    scriptLineSet(&sf,foundentry->setVarCB,directory,value,structureToFillIn);
+                    processingSalvagePoint++;
+                    if (processingSalvagePoint >= numSalvagePoints)
                     {
-                        dbgAssertOrIgnore(processingSalvagePoint < numSalvagePoints);
-                        dbgAssertOrIgnore(numSalvagePoints > 0);
-                        structureToFillIn = (ubyte *)&salvagestaticinfo->salvageStaticPoints[processingSalvagePoint];
-                        foundentry->setVarCB(directory,value,structureToFillIn);
-                        processingSalvagePoint++;
-                        if (processingSalvagePoint >= numSalvagePoints)
-                        {
-                            goto done;
-                        }
+                        goto done;
                     }
-                    break;
+                }
+                break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
-                    break;
-            }
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
@@ -1703,7 +2015,7 @@ done:
     {
         statinfo->salvageStaticInfo = NULL; //set to Null if not found
     }
-    fileClose(fh);
+    scriptFileClose(&sf);
 }
 
 
@@ -1722,11 +2034,9 @@ done:
 ----------------------------------------------------------------------------*/
 struct SphereStaticInfo *scriptSetSphereStaticInfo(char *directory,char *filename)
 {
-    filehandle fh;
-    char line[MAX_LINE_CHARS];
+    scriptfile sf;
     char *name, *value;
     char fullfilename[80];
-    sdword status;
     sdword state = 0;
     sdword numTables = 0;
     sdword curTable = -1;
@@ -1748,95 +2058,85 @@ struct SphereStaticInfo *scriptSetSphereStaticInfo(char *directory,char *filenam
         strcpy(fullfilename,filename);
     }
 
-    fh = fileOpen(fullfilename,FF_TextMode);
+    scriptFileOpen(&sf,fullfilename,FF_TextMode);
 
-    for (;;)
+    while (scriptLineRead(&sf,&name,&value))
     {
-        status = fileLineRead(fh,line,MAX_LINE_CHARS);
-
-        if (status == FR_EndOfFile)
+        switch (state)
         {
-            break;
-        }
-
-        if (parseLine(line,&name,&value))
-        {
-            switch (state)
-            {
-                case SPHERESTATE_START:
-                    if (strcmp(name,"NUMBER_SPHERE_TABLES") == 0)
+            case SPHERESTATE_START:
+                if (strcmp(name,"NUMBER_SPHERE_TABLES") == 0)
+                {
+                    scriptSetSdwordCB(directory,value,&numTables);
+                    if (numTables <= 0)
                     {
-                        scriptSetSdwordCB(directory,value,&numTables);
-                        if (numTables <= 0)
-                        {
-                            goto done;
-                        }
+                        goto done;
+                    }
 
-                        sizeofspherestaticinfo = sizeofSphereStaticInfo(numTables);
+                    sizeofspherestaticinfo = sizeofSphereStaticInfo(numTables);
 
-                        sphereStaticInfo = memAlloc(sizeofspherestaticinfo,"spherestatinfo",NonVolatile);
-                        memset(sphereStaticInfo,0,sizeofspherestaticinfo);
+                    sphereStaticInfo = memAlloc(sizeofspherestaticinfo,"spherestatinfo",NonVolatile);
+                    memset(sphereStaticInfo,0,sizeofspherestaticinfo);
 
-                        sphereStaticInfo->numTableEntries = numTables;
+                    sphereStaticInfo->numTableEntries = numTables;
 
-                        state = SPHERESTATE_LOOKINGFORTABLE;
-                    }
-                    break;
+                    state = SPHERESTATE_LOOKINGFORTABLE;
+                }
+                break;
 
-                case SPHERESTATE_LOOKINGFORTABLE:
-                    if (strcmp(name,"SPHERE_TABLE") == 0)
-                    {
+            case SPHERESTATE_LOOKINGFORTABLE:
+                if (strcmp(name,"SPHERE_TABLE") == 0)
+                {
 foundtable:
-                        curTable = nextTableToProcess++;
-                        curDeclination = 0;
+                    curTable = nextTableToProcess++;
+                    curDeclination = 0;
 
-                        scriptSetSdwordCB(directory,value,&numDeclinations);
-                        dbgAssertOrIgnore(numDeclinations > 0);
+                    scriptSetSdwordCB(directory,value,&numDeclinations);
+                    dbgAssertOrIgnore(numDeclinations > 0);
 
-                        sizeofspheretableentry = sizeofSphereTableEntry(numDeclinations);
+                    sizeofspheretableentry = sizeofSphereTableEntry(numDeclinations);
 
-                        sphereStaticInfo->sphereTableEntryPtrs[curTable] = spheretableentry = memAlloc(sizeofspheretableentry,"spheretabentry",NonVolatile);
-                        memset(spheretableentry,0,sizeofspheretableentry);
+                    sphereStaticInfo->sphereTableEntryPtrs[curTable] = spheretableentry = memAlloc(sizeofspheretableentry,"spheretabentry",NonVolatile);
+                    memset(spheretableentry,0,sizeofspheretableentry);
 
-                        spheretableentry->numDeclinations = numDeclinations;
+                    spheretableentry->numDeclinations = numDeclinations;
 
-                        state = SPHERESTATE_GETTABLE;
-                    }
-                    break;
+                    state = SPHERESTATE_GETTABLE;
+                }
+                break;
 
-                case SPHERESTATE_GETTABLE:
-                    dbgAssertOrIgnore(curTable > -1);
-                    dbgAssertOrIgnore(curTable < numTables);
-                    dbgAssertOrIgnore(spheretableentry);
-                    dbgAssertOrIgnore(curDeclination >= 0);
-                    if (strcmp(name,"SPHERE_TABLE") == 0)
+            case SPHERESTATE_GETTABLE:
+                dbgAssertOrIgnore(curTable > -1);
+                dbgAssertOrIgnore(curTable < numTables);
+                dbgAssertOrIgnore(spheretableentry);
+                dbgAssertOrIgnore(curDeclination >= 0);
+                if (strcmp(name,"SPHERE_TABLE") == 0)
+                {
+                    goto foundtable;
+                }
+                else
+                {
+                    if (strcmp(name,"Ships") == 0)
                     {
-                        goto foundtable;
+                        scriptSetSdwordCB(directory,value,&spheretableentry->numShipsCanHandle);
                     }
-                    else
+                    else if (strcmp(name,"Declination") == 0)
                     {
-                        if (strcmp(name,"Ships") == 0)
-                        {
-                            scriptSetSdwordCB(directory,value,&spheretableentry->numShipsCanHandle);
-                        }
-                        else if (strcmp(name,"Declination") == 0)
-                        {
-                            dbgAssertOrIgnore(curDeclination < numDeclinations);
-                            scriptSetSphereDeclinationCB(directory,value,&spheretableentry->sphereDeclinations[curDeclination]);
-                            curDeclination++;
-                        }
+                        dbgAssertOrIgnore(curDeclination < numDeclinations);
+                        scriptSetSphereDeclinationCB(directory,value,&spheretableentry->sphereDeclinations[curDeclination]);
+                        curDeclination++;
                     }
-                    break;
+                }
+                break;
 
-                default:
-                    dbgAssertOrIgnore(FALSE);
-                    break;
-            }
+            default:
+                dbgAssertOrIgnore(FALSE);
+                break;
         }
     }
 
 done:
-    fileClose(fh);
+    scriptFileClose(&sf);
     return sphereStaticInfo;
 }
 
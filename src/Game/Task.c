@@ -13,6 +13,7 @@
 #include "Debug.h"
 #include "Memory.h"
 #include "Demo.h"
+#include "ProfileTimers.h"
 #include "TitanInterfaceC.h"
 #include "Task.h"
 
@@ -310,6 +311,8 @@ sdword taskExecuteAllPending(sdword ticks)
     // Verify we're not in any task currently.
     dbgAssertOrIgnore(taskCurrentTask == -1);
 
+    profTraceFrame();                           //one pass of the task list is a frame
+
     for (taskCurrentTask = 0; taskCurrentTask < taskMaxTask; taskCurrentTask++)
     {
         if (taskData[taskCurrentTask] == NULL
@@ -367,8 +370,10 @@ sdword taskExecuteAllPending(sdword ticks)
         taskProcessIndex++;
         for (; taskNumberCalls > 0; taskNumberCalls--)
         {
+            PTSCOPE(taskData[taskCurrentTask]->name);
             taskData[taskCurrentTask]->function(
                 &taskData[taskCurrentTask]->context);
+            PTSCOPEEND();
             if (taskData[taskCurrentTask]->context == NULL) {
                 // Task has exited.
                 taskStop(taskCurrentTask);
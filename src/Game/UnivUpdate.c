@@ -28,6 +28,7 @@
 #include "glinc.h"
 #include "HS.h"
 #include "InfoOverlay.h"
+#include "Jobs.h"
 #include "LaunchMgr.h"
 #include "LevelLoad.h"
 #include "MadLinkIn.h"
@@ -50,6 +51,7 @@
 #include "Ships.h"
 #include "SinglePlayer.h"
 #include "SoundEvent.h"
+#include "SpaceQuery.h"
 #include "Star3d.h"
 #include "StatScript.h"
 #include "StringsOnly.h"
@@ -63,6 +65,8 @@
 
 #define DEBUG_COLLISIONS 0
 
+#define UNIV_JOB_GRAIN          64              //objects per batch when integrating in parallel
+
 vector defaultshipupvector = { 0.0f, 0.0f, 1.0f };
 vector defaultshiprightvector = { 0.0f, -1.0f, 0.0f };
 vector defaultshipheadingvector = { 1.0f, 0.0f, 0.0f };
@@ -73,6 +77,11 @@ IDToPtrTable ResourceIDToPtr;
 IDToPtrTable DerelictIDToPtr;
 IDToPtrTable MissileIDToPtr;
 
+//bullets and missiles come and go thousands of times a minute in a big
+//battle, so they get pools of their own
+memobjpool univBulletPool = memObjPoolDefine(sizeof(Bullet), "Bullet");
+memobjpool univMissilePool = memObjPoolDefine(sizeof(Missile), "Missile");
+
 /*=============================================================================
     Private functions:
 =============================================================================*/
@@ -255,10 +264,12 @@ void univInitSpaceObjPosRot(SpaceObj *obj,vector *position,bool randomOrientatio
 
 #define IDTOPTR_GROWBATCH       250
 
-void IDToPtrTableInit(IDToPtrTable *table)
+void IDToPtrTableInit(IDToPtrTable *table,memobjpool *pool)
 {
     table->numEntries = 0;
     table->objptrs = NULL;
+    table->pool = pool;
+    table->handles = NULL;
 }
 
 void IDToPtrTableClose(IDToPtrTable *table)
@@ -268,13 +279,20 @@ void IDToPtrTableClose(IDToPtrTable *table)
         memFree(table->objptrs);
         table->objptrs = NULL;
     }
+    if (table->handles)
+    {
+        memFree(table->handles);
+        table->handles = NULL;
+    }
     table->numEntries = 0;
 }
 
 void IDToPtrTableReset(IDToPtrTable *table)
 {
+    memobjpool *pool = table->pool;
+
     IDToPtrTableClose(table);
-    IDToPtrTableInit(table);
+    IDToPtrTableInit(table,pool);
 }
 
 void IDToPtrTableObjDied(IDToPtrTable *table,uword ID)
@@ -285,6 +303,10 @@ void IDToPtrTableObjDied(IDToPtrTable *table,uword ID)
     }
 
     table->objptrs[ID] = NULL;      // remove reference
+    if (table->handles)
+    {
+        table->handles[ID] = MEM_ObjHandleNull;
+    }
 }
 
 SpaceObjPtr IDToPtrTableIDToObj(IDToPtrTable *table,uword ID)
@@ -294,15 +316,54 @@ SpaceObjPtr IDToPtrTableIDToObj(IDToPtrTable *table,uword ID)
         return NULL;
     }
 
+    if (table->handles)
+    {
+        // a stale ID finds nothing rather than whatever reused the memory
+        return (SpaceObjPtr)memObjFromHandle(table->pool,table->handles[ID]);
+    }
+
     return table->objptrs[ID];
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : IDToPtrTableHandlesMake
+    Description : Makes the handles of a pooled table from its pointers, for
+                  a table that's just been grown or loaded
+    Inputs      : table, first - first entry to make a handle for
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void IDToPtrTableHandlesMake(IDToPtrTable *table,sdword first)
+{
+    sdword i;
+
+    if ((table->pool == NULL) || (table->numEntries == 0))
+    {
+        return;
+    }
+
+    if (table->handles)
+    {
+        table->handles = memRealloc(table->handles,sizeof(memobjhandle) * table->numEntries,"idtohandles",0);
+    }
+    else
+    {
+        table->handles = memAlloc(sizeof(memobjhandle) * table->numEntries,"idtohandles",0);
+    }
+
+    for (i=first;i<table->numEntries;i++)
+    {
+        table->handles[i] = table->objptrs[i] ? memObjHandle(table->objptrs[i]) : MEM_ObjHandleNull;
+    }
+}
+
 void IDToPtrTableAdd(IDToPtrTable *table,uword ID,SpaceObj *obj)
 {
     dbgAssertOrIgnore(obj);
 
     if (ID >= table->numEntries)
     {
+        sdword oldnumber = table->numEntries;
         sdword newnumber = table->numEntries+IDTOPTR_GROWBATCH;
 
         if (table->objptrs)
@@ -315,21 +376,251 @@ void IDToPtrTableAdd(IDToPtrTable *table,uword ID,SpaceObj *obj)
         }
         memset(&table->objptrs[table->numEntries],0,sizeof(SpaceObjPtr)*IDTOPTR_GROWBATCH);
         table->numEntries += IDTOPTR_GROWBATCH;
+        IDToPtrTableHandlesMake(table,oldnumber);
     }
 
     dbgAssertOrIgnore(ID < table->numEntries);
 
-    if (table->objptrs[ID])
+    if (IDToPtrTableIDToObj(table,ID))
     {
         dbgFatalf(DBG_Loc,"Obj with this ID %d already exists",ID);
     }
     else
     {
         table->objptrs[ID] = obj;
+        if (table->handles)
+        {
+            table->handles[ID] = memObjHandle(obj);
+        }
     }
     return;
 }
 
+/*=============================================================================
+    Ship indices:
+=============================================================================*/
+
+#define SHIPINDEX_GROWBATCH     250
+#define SHIPINDEX_NUM_PLAYERS   (MAX_MULTIPLAYER_PLAYERS + 1)   // includes the autogun player
+
+static bool shipIndexValid = FALSE;
+static udword shipIndexNumShips = 0;        // universe.ShipList.num when it was built
+static udword shipIndexAllocated = 0;
+static Ship **shipsByPlayer = NULL;         // grouped by owner
+static Ship **shipsByType = NULL;           // grouped by owner, then ShipType
+static Ship **shipsByClass = NULL;          // grouped by owner, then ShipClass
+static sdword shipsByPlayerStart[SHIPINDEX_NUM_PLAYERS + 1];
+static sdword shipsByTypeStart[SHIPINDEX_NUM_PLAYERS * TOTAL_NUM_SHIPS + 1];
+static sdword shipsByClassStart[SHIPINDEX_NUM_PLAYERS * NUM_CLASSES + 1];
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipIndexDirty
+    Description : Marks the ship indices and the ships' spatial query grid
+                  out of date.  Call this whenever a ship is added to or
+                  removed from universe.ShipList or changes owner.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void univShipIndexDirty(void)
+{
+    shipIndexValid = FALSE;
+    spqSetDirty(SPQ_Ships);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipIndexClose
+    Description : Frees the ship indices
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void univShipIndexClose(void)
+{
+    if (shipsByPlayer)
+    {
+        memFree(shipsByPlayer);
+        memFree(shipsByType);
+        memFree(shipsByClass);
+        shipsByPlayer = shipsByType = shipsByClass = NULL;
+    }
+    shipIndexAllocated = 0;
+    shipIndexValid = FALSE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipIndexStarts
+    Description : Turns counts per bucket into where each bucket starts
+    Inputs      : start - counts, numBuckets + 1 long
+                  numBuckets - number of buckets
+    Outputs     : start[i] is where bucket i starts, start[numBuckets] the total
+    Return      :
+----------------------------------------------------------------------------*/
+static void univShipIndexStarts(sdword *start, sdword numBuckets)
+{
+    sdword i, count, total = 0;
+
+    for (i = 0; i <= numBuckets; i++)
+    {
+        count = start[i];
+        start[i] = total;
+        total += count;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipIndexBuild
+    Description : Rebuilds the ship indices from universe.ShipList if they
+                  are out of date.  The ships are counting-sorted into their
+                  buckets so each bucket stays in ShipList order, which keeps
+                  the callers doing exactly what walking the list did.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void univShipIndexBuild(void)
+{
+    sdword playerCursor[SHIPINDEX_NUM_PLAYERS];
+    sdword typeCursor[SHIPINDEX_NUM_PLAYERS * TOTAL_NUM_SHIPS];
+    sdword classCursor[SHIPINDEX_NUM_PLAYERS * NUM_CLASSES];
+    sdword playerIndex;
+    udword newnumber;
+    Node *objnode;
+    Ship *ship;
+
+    //a ship added or removed without a univShipIndexDirty still changes the count
+    if (shipIndexValid && shipIndexNumShips == universe.ShipList.num)
+    {
+        return;
+    }
+
+    if (universe.ShipList.num > shipIndexAllocated)
+    {
+        newnumber = universe.ShipList.num + SHIPINDEX_GROWBATCH;
+        if (shipsByPlayer)
+        {
+            shipsByPlayer = memRealloc(shipsByPlayer, sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+            shipsByType = memRealloc(shipsByType, sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+            shipsByClass = memRealloc(shipsByClass, sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+        }
+        else
+        {
+            shipsByPlayer = memAlloc(sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+            shipsByType = memAlloc(sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+            shipsByClass = memAlloc(sizeof(Ship *) * newnumber, "ShipIndex", NonVolatile);
+        }
+        shipIndexAllocated = newnumber;
+    }
+
+    memset(shipsByPlayerStart, 0, sizeof(shipsByPlayerStart));
+    memset(shipsByTypeStart, 0, sizeof(shipsByTypeStart));
+    memset(shipsByClassStart, 0, sizeof(shipsByClassStart));
+
+    for (objnode = universe.ShipList.head; objnode != NULL; objnode = objnode->next)
+    {
+        ship = (Ship *)listGetStructOfNode(objnode);
+        playerIndex = ship->playerowner->playerIndex;
+        dbgAssertOrIgnore(playerIndex >= 0 && playerIndex < SHIPINDEX_NUM_PLAYERS);
+
+        shipsByPlayerStart[playerIndex]++;
+        shipsByTypeStart[playerIndex * TOTAL_NUM_SHIPS + ship->shiptype]++;
+        shipsByClassStart[playerIndex * NUM_CLASSES + ship->staticinfo->shipclass]++;
+    }
+
+    univShipIndexStarts(shipsByPlayerStart, SHIPINDEX_NUM_PLAYERS);
+    univShipIndexStarts(shipsByTypeStart, SHIPINDEX_NUM_PLAYERS * TOTAL_NUM_SHIPS);
+    univShipIndexStarts(shipsByClassStart, SHIPINDEX_NUM_PLAYERS * NUM_CLASSES);
+    memcpy(playerCursor, shipsByPlayerStart, sizeof(playerCursor));
+    memcpy(typeCursor, shipsByTypeStart, sizeof(typeCursor));
+    memcpy(classCursor, shipsByClassStart, sizeof(classCursor));
+
+    for (objnode = universe.ShipList.head; objnode != NULL; objnode = objnode->next)
+    {
+        ship = (Ship *)listGetStructOfNode(objnode);
+        playerIndex = ship->playerowner->playerIndex;
+
+        shipsByPlayer[playerCursor[playerIndex]++] = ship;
+        shipsByType[typeCursor[playerIndex * TOTAL_NUM_SHIPS + ship->shiptype]++] = ship;
+        shipsByClass[classCursor[playerIndex * NUM_CLASSES + ship->staticinfo->shipclass]++] = ship;
+    }
+
+    shipIndexNumShips = universe.ShipList.num;
+    shipIndexValid = TRUE;
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipsOfPlayer
+    Description : Finds all of a player's ships in universe.ShipList, in list
+                  order.  Like the list, this includes dead and hidden ships.
+                  The array is only good until the next ship is added,
+                  removed or changes owner.
+    Inputs      : playerIndex - owner of the ships
+    Outputs     : ships - set to the first of the ships
+    Return      : number of ships
+----------------------------------------------------------------------------*/
+sdword univShipsOfPlayer(sdword playerIndex, Ship ***ships)
+{
+    if (playerIndex < 0 || playerIndex >= SHIPINDEX_NUM_PLAYERS)
+    {
+        *ships = NULL;
+        return 0;
+    }
+
+    univShipIndexBuild();
+    *ships = shipsByPlayer + shipsByPlayerStart[playerIndex];
+    return shipsByPlayerStart[playerIndex + 1] - shipsByPlayerStart[playerIndex];
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipsOfPlayerType
+    Description : Like univShipsOfPlayer, for ships of one type only
+    Inputs      : playerIndex - owner of the ships
+                  shiptype - type of the ships
+    Outputs     : ships - set to the first of the ships
+    Return      : number of ships
+----------------------------------------------------------------------------*/
+sdword univShipsOfPlayerType(sdword playerIndex, ShipType shiptype, Ship ***ships)
+{
+    sdword bucket;
+
+    if (playerIndex < 0 || playerIndex >= SHIPINDEX_NUM_PLAYERS ||
+        (sdword)shiptype < 0 || (sdword)shiptype >= TOTAL_NUM_SHIPS)
+    {
+        *ships = NULL;
+        return 0;
+    }
+
+    univShipIndexBuild();
+    bucket = playerIndex * TOTAL_NUM_SHIPS + shiptype;
+    *ships = shipsByType + shipsByTypeStart[bucket];
+    return shipsByTypeStart[bucket + 1] - shipsByTypeStart[bucket];
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univShipsOfPlayerClass
+    Description : Like univShipsOfPlayer, for ships of one class only
+    Inputs      : playerIndex - owner of the ships
+                  shipclass - class of the ships
+    Outputs     : ships - set to the first of the ships
+    Return      : number of ships
+----------------------------------------------------------------------------*/
+sdword univShipsOfPlayerClass(sdword playerIndex, ShipClass shipclass, Ship ***ships)
+{
+    sdword bucket;
+
+    if (playerIndex < 0 || playerIndex >= SHIPINDEX_NUM_PLAYERS ||
+        (sdword)shipclass < 0 || (sdword)shipclass >= NUM_CLASSES)
+    {
+        *ships = NULL;
+        return 0;
+    }
+
+    univShipIndexBuild();
+    bucket = playerIndex * NUM_CLASSES + shipclass;
+    *ships = shipsByClass + shipsByClassStart[bucket];
+    return shipsByClassStart[bucket + 1] - shipsByClassStart[bucket];
+}
+
 /*=============================================================================
     Save Game Stuff
 =============================================================================*/
@@ -358,7 +649,7 @@ void SaveIDToPtrTable(IDToPtrTable *table)
 
     for (i=0;i<num;i++)
     {
-        savecontents->ID[i] = SpaceObjRegistryGetID(table->objptrs[i]);
+        savecontents->ID[i] = SpaceObjRegistryGetID(IDToPtrTableIDToObj(table,i));
     }
 
     SaveThisChunk(chunk);
@@ -394,6 +685,7 @@ void LoadIDToPtrTable(IDToPtrTable *table)
     {
         table->objptrs[i] = SpaceObjRegistryGetObj(loadcontents->ID[i]);
 }
+    IDToPtrTableHandlesMake(table,0);
 
     memFree(chunk);
 }
@@ -407,10 +699,10 @@ void LoadIDToPtrTable(IDToPtrTable *table)
 
 void univInitFastNetworkIDLookups(void)
 {
-    IDToPtrTableInit(&ShipIDToPtr);
-    IDToPtrTableInit(&ResourceIDToPtr);
-    IDToPtrTableInit(&DerelictIDToPtr);
-    IDToPtrTableInit(&MissileIDToPtr);
+    IDToPtrTableInit(&ShipIDToPtr,NULL);
+    IDToPtrTableInit(&ResourceIDToPtr,NULL);
+    IDToPtrTableInit(&DerelictIDToPtr,NULL);
+    IDToPtrTableInit(&MissileIDToPtr,&univMissilePool);
 }
 
 void univCloseFastNetworkIDLookups(void)
@@ -621,6 +913,7 @@ Asteroid *univAddAsteroid(AsteroidType asteroidtype,vector *astpos)
         collAddSpaceObjToCollBlobs((SpaceObj *)newAsteroid);
         listAddNode(&universe.SpaceObjList,&(newAsteroid->objlink),newAsteroid);
         listAddNode(&universe.ResourceList,&(newAsteroid->resourcelink),newAsteroid);
+        spqSetDirty(SPQ_Resources);
         listAddNode(&universe.ImpactableList,&(newAsteroid->impactablelink),newAsteroid);
     }
 
@@ -666,7 +959,7 @@ Missile *univAddMissile(ShipRace race)
     Missile *missile;
     sdword i;
 
-    missile = memAlloc(sizeof(Missile),"Missile",0);
+    missile = memObjAlloc(&univMissilePool);
     memset(missile,0,sizeof(Missile));
 
     missile->objtype = OBJ_MissileType;
@@ -975,6 +1268,7 @@ DustCloud *univAddDustCloud(DustCloudType dustcloudtype,vector *cloudpos)
     collAddSpaceObjToCollBlobs((SpaceObj *)newCloud);
     listAddNode(&universe.SpaceObjList,&(newCloud->objlink),newCloud);
     listAddNode(&universe.ResourceList,&(newCloud->resourcelink),newCloud);
+    spqSetDirty(SPQ_Resources);
     listAddNode(&universe.ImpactableList,&(newCloud->impactablelink),newCloud);
 
     return newCloud;
@@ -1026,6 +1320,7 @@ GasCloud *univAddGasCloud(GasCloudType gascloudtype,vector *cloudpos)
     collAddSpaceObjToCollBlobs((SpaceObj *)newCloud);
     listAddNode(&universe.SpaceObjList,&(newCloud->objlink),newCloud);
     listAddNode(&universe.ResourceList,&(newCloud->resourcelink),newCloud);
+    spqSetDirty(SPQ_Resources);
     listAddNode(&universe.ImpactableList,&(newCloud->impactablelink),newCloud);
 
     return newCloud;
@@ -1087,6 +1382,7 @@ Nebula* univAddNebula(NebulaType nebulatype,vector* nebpos, void* stub)
     collAddSpaceObjToCollBlobs((SpaceObj *)newNeb);
     listAddNode(&universe.SpaceObjList, &(newNeb->objlink), newNeb);
     listAddNode(&universe.ResourceList, &(newNeb->resourcelink), newNeb);
+    spqSetDirty(SPQ_Resources);
     listAddNode(&universe.ImpactableList, &(newNeb->impactablelink), newNeb);
 
     return newNeb;
@@ -1648,6 +1944,7 @@ Ship *univAddShip(ShipType shiptype,ShipRace shiprace,vector *shippos,struct Pla
     collAddSpaceObjToCollBlobs((SpaceObj *)newship);
     listAddNode(&universe.SpaceObjList,&(newship->objlink),newship);
     listAddNode(&universe.ShipList,&(newship->shiplink),newship);
+    univShipIndexDirty();
     listAddNode(&universe.ImpactableList,&(newship->impactablelink),newship);
 
     //special case - don't want cryotrays to be selectable
@@ -1686,31 +1983,81 @@ void univUpdateAllPosVelMinorObjs()
     }
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : univBulletsJob
+    Description : jobParallelFor function that moves a range of bullets
+    Inputs      : context - array of bullets
+                  first, last - range of bullets to move
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void univBulletsJob(void *context, sdword first, sdword last)
+{
+    Bullet **bullets = (Bullet **)context;
+    sdword index;
+
+    for (index = first; index < last; index++)
+    {
+        physUpdateBulletPosVel(bullets[index],universe.phystimeelapsed);
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : univUpdateAllPosVelBullets
-    Description : Exclusive physics updating for bulletes
+    Description : Exclusive physics updating for bulletes.  Bullets other
+                  than beams only move themselves, so they are moved in
+                  parallel first; beams (which aim their guns) and the
+                  clean-up of bullets that died are then done in list order.
+                  Bullets that died are found from their lifetimes at that
+                  point, like physUpdateBulletPosVel does, so a laser timed
+                  out by an earlier bullet's clean-up dies this frame just as
+                  it did when everything was done in one pass.
     Inputs      :
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void univUpdateAllPosVelBullets()
 {
-    Node *bulletnode = universe.BulletList.head;
+    Node *bulletnode;
     Node *deletenode;
     Bullet *bullet;
+    Bullet **moved;
+    sdword nMoved = 0;
+    bool died;
     bool addEffect = FALSE;
     etglod *etgLOD;
     sdword LOD;
     etgeffectstatic *stat;
     Effect *effect;
 
+    moved = memFrameAlloc(sizeof(Bullet *) * max(universe.BulletList.num, 1),"MovedBullets");
+    for (bulletnode = universe.BulletList.head; bulletnode != NULL; bulletnode = bulletnode->next)
+    {
+        bullet = (Bullet *)listGetStructOfNode(bulletnode);
+        if ((bullet->flags & SOF_DontApplyPhysics) == 0 && bullet->bulletType != BULLET_Beam)
+        {
+            moved[nMoved++] = bullet;
+        }
+    }
+    jobParallelFor(nMoved, UNIV_JOB_GRAIN, univBulletsJob, moved);
+    memFrameFree(moved);
+
+    bulletnode = universe.BulletList.head;
     while (bulletnode != NULL)
     {
         bullet = (Bullet *)listGetStructOfNode(bulletnode);
 
         if ((bullet->flags & SOF_DontApplyPhysics) == 0)
         {
-            if (physUpdateBulletPosVel(bullet,universe.phystimeelapsed))
+            if (bullet->bulletType == BULLET_Beam)
+            {
+                died = physUpdateBulletPosVel(bullet,universe.phystimeelapsed);
+            }
+            else
+            {
+                died = bullet->timelived > bullet->totallifetime;
+            }
+            if (died)
             {
                 //bullet has died so clean it up
 
@@ -1810,61 +2157,145 @@ void univUpdateAllPosVelBullets()
         bulletnode = bulletnode->next;
     }
 }
+/*-----------------------------------------------------------------------------
+    Name        : univMissilesJob
+    Description : jobParallelFor function that moves a range of missiles
+    Inputs      : context - array of missiles
+                  first, last - range of missiles to move
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void univMissilesJob(void *context, sdword first, sdword last)
+{
+    Missile **missiles = (Missile **)context;
+    sdword index;
+
+    for (index = first; index < last; index++)
+    {
+        physUpdateObjPosVelMissile(missiles[index],universe.phystimeelapsed);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : univMissilesMove
+    Description : Moves a run of guided missiles in parallel, then adds the
+                  ones their guidance said were done to the delete list, in
+                  order.
+    Inputs      : missiles - guided missiles
+                  deleteflags - what their guidance returned
+                  first, last - run of missiles to move
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void univMissilesMove(Missile **missiles, ubyte *deleteflags, sdword first, sdword last)
+{
+    sdword index;
+
+    jobParallelFor(last - first, UNIV_JOB_GRAIN, univMissilesJob, missiles + first);
+
+    for (index = first; index < last; index++)
+    {
+        if ((deleteflags[index]) && ((missiles[index]->flags & SOF_Dead) == 0))
+        {
+            AddMissileToDeleteMissileList(missiles[index], -1);
+        }
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : univUpdateAllPosVelMissiles
-    Description : Exclusive physics updating for misiles
+    Description : Exclusive physics updating for misiles.  Guidance is done
+                  in list order, but moving the missiles is put off and done
+                  in parallel for runs of missiles whose guidance only looks
+                  at ships.  A mine, or a missile after another missile, has
+                  everything guided before it moved first, so it sees the
+                  same missiles it would have if each missile had been moved
+                  right after it was guided.
     Inputs      :
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void univUpdateAllPosVelMissiles()
 {
-    Node *misnode = universe.MissileList.head;
+    Node *misnode;
     Missile *missile;
-    bool deleteflag;
+    Missile **guided;
+    ubyte *deleteflags;
+    sdword nGuided = 0, nMoved = 0;
 
-    while (misnode != NULL)
+    guided = memFrameAlloc(sizeof(Missile *) * max(universe.MissileList.num, 1),"GuidedMissiles");
+    deleteflags = memFrameAlloc(max(universe.MissileList.num, 1),"GuidedMissileFlags");
+
+    for (misnode = universe.MissileList.head; misnode != NULL; misnode = misnode->next)
     {
         missile = (Missile *)listGetStructOfNode(misnode);
 
         if ((missile->flags & SOF_DontApplyPhysics) == 0)
         {
+            if ((missile->missileType != MISSILE_Regular) ||
+                ((missile->target != NULL) && (missile->target->objtype == OBJ_MissileType)))
+            {   //guidance might look at other missiles; move the ones guided so far first
+                univMissilesMove(guided, deleteflags, nMoved, nGuided);
+                nMoved = nGuided;
+            }
+
             if(missile->missileType == MISSILE_Regular)
             {   //if missileType is a normal missile
-                deleteflag = aishipGuideMissile(missile);
+                deleteflags[nGuided] = aishipGuideMissile(missile);
             }
             else if(missile->missileType == MISSILE_Mine)
             {   //if missiletype is a mine
-                deleteflag = aishipGuideMine(missile);
+                deleteflags[nGuided] = aishipGuideMine(missile);
             }
             else
             {
-                deleteflag = FALSE;
+                deleteflags[nGuided] = FALSE;
                 dbgAssertOrIgnore(FALSE);
             }
-
-            physUpdateObjPosVelMissile(missile,universe.phystimeelapsed);
-            if ((deleteflag) && ((((SpaceObj *)missile)->flags & SOF_Dead) == 0))
-            {
-                AddMissileToDeleteMissileList(missile, -1);
-            }
+            guided[nGuided++] = missile;
         }
-        misnode = misnode->next;
     }
+    univMissilesMove(guided, deleteflags, nMoved, nGuided);
+
+    memFrameFree(deleteflags);
+    memFrameFree(guided);
 }
+
+/*-----------------------------------------------------------------------------
+    Name        : univDerelictsJob
+    Description : jobParallelFor function that moves a range of derelicts
+    Inputs      : context - array of derelicts
+                  first, last - range of derelicts to move
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void univDerelictsJob(void *context, sdword first, sdword last)
+{
+    Derelict **derelicts = (Derelict **)context;
+    sdword index;
+
+    for (index = first; index < last; index++)
+    {
+        physUpdateObjPosVelDerelicts(derelicts[index],universe.phystimeelapsed);
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : univUpdateAllPosVelDerelicts
-    Description : Exclusive physics updating for derelicts
+    Description : Exclusive physics updating for derelicts, in parallel
     Inputs      :
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void univUpdateAllPosVelDerelicts()
 {
-    Node *objnode = universe.DerelictList.head;
+    Node *objnode;
     Derelict *derelict;
+    Derelict **moved;
+    sdword nMoved = 0;
 
-    while (objnode != NULL)
+    moved = memFrameAlloc(sizeof(Derelict *) * max(universe.DerelictList.num, 1),"MovedDerelicts");
+    for (objnode = universe.DerelictList.head; objnode != NULL; objnode = objnode->next)
     {
         derelict = (Derelict *)listGetStructOfNode(objnode);
 
@@ -1872,27 +2303,31 @@ void univUpdateAllPosVelDerelicts()
         {
             if ((derelict->flags & SOF_NISShip) == 0)
             {
-                physUpdateObjPosVelDerelicts(derelict,universe.phystimeelapsed);
+                moved[nMoved++] = derelict;
             }
         }
-        objnode = objnode->next;
     }
+    jobParallelFor(nMoved, UNIV_JOB_GRAIN, univDerelictsJob, moved);
+    memFrameFree(moved);
 }
+
 /*-----------------------------------------------------------------------------
-    Name        : univUpdateAllPosVelResources
-    Description : Exclusive physics updating for resources
-    Inputs      :
+    Name        : univResourcesJob
+    Description : jobParallelFor function that updates a range of resources
+    Inputs      : context - array of resources
+                  first, last - range of resources to update
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
-void univUpdateAllPosVelResources()
+static void univResourcesJob(void *context, sdword first, sdword last)
 {
-    Node *objnode = universe.ResourceList.head;
+    Resource **resources = (Resource **)context;
     Resource *resource;
+    sdword index;
 
-    while (objnode != NULL)
+    for (index = first; index < last; index++)
     {
-        resource = (Resource *)listGetStructOfNode(objnode);
+        resource = resources[index];
 
         if ((resource->flags & (SOF_DontApplyPhysics|SOF_NISShip)) == 0)
         {
@@ -1903,9 +2338,29 @@ void univUpdateAllPosVelResources()
         {
             resource->resourceNotAccessible--;
         }
+    }
+}
 
-        objnode = objnode->next;
+/*-----------------------------------------------------------------------------
+    Name        : univUpdateAllPosVelResources
+    Description : Exclusive physics updating for resources, in parallel
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void univUpdateAllPosVelResources()
+{
+    Node *objnode;
+    Resource **resources;
+    sdword nResources = 0;
+
+    resources = memFrameAlloc(sizeof(Resource *) * max(universe.ResourceList.num, 1),"UpdateResources");
+    for (objnode = universe.ResourceList.head; objnode != NULL; objnode = objnode->next)
+    {
+        resources[nResources++] = (Resource *)listGetStructOfNode(objnode);
     }
+    jobParallelFor(nResources, UNIV_JOB_GRAIN, univResourcesJob, resources);
+    memFrameFree(resources);
 }
 
 /*-----------------------------------------------------------------------------
@@ -3682,6 +4137,7 @@ void univWipeShipOutOfExistence(Ship *ship)
     if (ship->shiplink.belongto != NULL)
     {
         listRemoveNode(&ship->shiplink);
+        univShipIndexDirty();
     }
     if (ship->impactablelink.belongto != NULL)
     {
@@ -3753,6 +4209,7 @@ void univRemoveShipFromOutside(Ship *ship)
     if (ship->shiplink.belongto != NULL)
     {
         listRemoveNode(&ship->shiplink);
+        univShipIndexDirty();
     }
     if (ship->impactablelink.belongto != NULL)
     {
@@ -4514,6 +4971,7 @@ void univReallyDeleteThisResourceRightNow(Resource *resource)
     else
     {
         listRemoveNode(&resource->resourcelink);
+        spqSetDirty(SPQ_Resources);
         listRemoveNode(&resource->impactablelink);
         univRemoveObjFromRenderList((SpaceObj *)resource);
         listDeleteNode(&resource->objlink);
@@ -4909,86 +5367,88 @@ bool univObjectOutsideWorld(SpaceObj *obj)
     return TRUE;
 }
 
+typedef struct
+{
+    real32 volumeRadius;
+    vector *volumePosition;
+} NearestResourceFilter;
+
 /*-----------------------------------------------------------------------------
-    Name        : univFindNearestResource
-    Description : finds the nearest resource to ship in optional volume specified by volumePosition and volumeRadius.
-                  If VolumeRadius == 0, then volume is ignored
-    Inputs      :
+    Name        : univNearestResourceFilter
+    Description : spqNearest filter for univFindNearestResource
+    Inputs      : obj - resource
+                  context - NearestResourceFilter
     Outputs     :
-    Return      : returns the nearest resource (or NULL if none found)
+    Return      : TRUE if the resource can be harvested
 ----------------------------------------------------------------------------*/
-Resource *univFindNearestResource(Ship *ship,real32 volumeRadius,vector *volumePosition)
+static bool univNearestResourceFilter(SpaceObj *obj, void *context)
 {
-    Node *objnode = universe.ResourceList.head;
+    NearestResourceFilter *filter = (NearestResourceFilter *)context;
+    Resource *resource = (Resource *)obj;
     vector diff;
-    real32 dist;
-    real32 mindist = (real32)1e20;
-    Resource *closestResource = NULL;
-    Resource *resource;
 
-    while (objnode != NULL)
+    dbgAssertOrIgnore(resource->flags & SOF_Resource);
+    if (nisIsRunning && (resource->health >= REALlyBig))
     {
-        resource = (Resource *)listGetStructOfNode(objnode);
-        dbgAssertOrIgnore(resource->flags & SOF_Resource);
-        if (nisIsRunning && (resource->health >= REALlyBig))
-        {
-            goto nextnode;       // don't pick NIS resources
-        }
+        return FALSE;       // don't pick NIS resources
+    }
 
-        if (ResourceMovingTooFast(resource))
-        {
-            goto nextnode;
-        }
+    if (ResourceMovingTooFast(resource))
+    {
+        return FALSE;
+    }
 
-        if (ResourceAlreadyBeingHarvested(&universe.mainCommandLayer,NULL,resource))
-        {
-            goto nextnode;
-        }
+    if (resource->resourceNotAccessible)
+    {
+        return FALSE;
+    }
 
-        if (resource->resourceNotAccessible)
-        {
-            goto nextnode;
-        }
+    if (filter->volumeRadius > 0.0f)
+    {
+        vecSub(diff,resource->posinfo.position,*filter->volumePosition);
 
-        if (volumeRadius > 0.0f)
+        if (!isBetweenInclusive(diff.x,-filter->volumeRadius,filter->volumeRadius) ||
+            !isBetweenInclusive(diff.y,-filter->volumeRadius,filter->volumeRadius) ||
+            !isBetweenInclusive(diff.z,-filter->volumeRadius,filter->volumeRadius))
         {
-            vecSub(diff,resource->posinfo.position,*volumePosition);
-
-            if (!isBetweenInclusive(diff.x,-volumeRadius,volumeRadius))
-            {
-                goto nextnode;
-            }
+            return FALSE;
+        }
+    }
 
-            if (!isBetweenInclusive(diff.y,-volumeRadius,volumeRadius))
-            {
-                goto nextnode;
-            }
+    if (univObjectOutsideWorld((SpaceObj *)resource))
+    {
+        return FALSE;
+    }
 
-            if (!isBetweenInclusive(diff.z,-volumeRadius,volumeRadius))
-            {
-                goto nextnode;
-            }
-        }
+    if (ResourceAlreadyBeingHarvested(&universe.mainCommandLayer,NULL,resource))
+    {
+        return FALSE;
+    }
 
-        if (univObjectOutsideWorld((SpaceObj *)resource))
-        {
-            goto nextnode;
-        }
+    return TRUE;
+}
 
-        vecSub(diff,resource->posinfo.position,ship->posinfo.position);
-        dist = vecMagnitudeSquared(diff);
+/*-----------------------------------------------------------------------------
+    Name        : univFindNearestResource
+    Description : finds the nearest resource to ship in optional volume specified by volumePosition and volumeRadius.
+                  If VolumeRadius == 0, then volume is ignored
+    Inputs      :
+    Outputs     :
+    Return      : returns the nearest resource (or NULL if none found)
+----------------------------------------------------------------------------*/
+Resource *univFindNearestResource(Ship *ship,real32 volumeRadius,vector *volumePosition)
+{
+    NearestResourceFilter filter;
+    SpaceObj **nearest;
 
-        if (dist < mindist)
-        {
-            mindist = dist;
-            closestResource = resource;
-        }
+    filter.volumeRadius = volumeRadius;
+    filter.volumePosition = volumePosition;
 
-nextnode:
-        objnode = objnode->next;
+    if (spqNearest(SPQ_Resources,&ship->posinfo.position,1,univNearestResourceFilter,&filter,&nearest) == 0)
+    {
+        return NULL;
     }
-
-    return closestResource;
+    return (Resource *)nearest[0];
 }
 
 /*-----------------------------------------------------------------------------
@@ -5739,6 +6199,15 @@ void univSetupShipsForControl()
     growSelectReset(&universe.HousekeepShipList);       // don't need to keep track of them anymore
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : getEnemiesWithinProximity
+    Description : Finds the enemy ships within a ship's retaliation zone
+    Inputs      : thisship - ship to look around
+                  retaliateZone - half size of the zone
+    Outputs     :
+    Return      : selection of the enemies from the frame arena, or NULL if
+                    there are none
+----------------------------------------------------------------------------*/
 SelectCommand *getEnemiesWithinProximity(Ship *thisship,real32 retaliateZone)
 {
     Player *playerowner = thisship->playerowner;
@@ -5759,7 +6228,7 @@ SelectCommand *getEnemiesWithinProximity(Ship *thisship,real32 retaliateZone)
         return NULL;      // traders get special status, not considered enemy to anyone
     }
 
-    select = memAlloc(sizeofSelectCommand(num),"se(selectenemies)",Pyrophoric);    // worst case scenario
+    select = memFrameAlloc(sizeofSelectCommand(num),"se(selectenemies)");    // worst case scenario
 
     while (objindex < num)
     {
@@ -5827,7 +6296,7 @@ nextnode:
 
     if (shipIndex == 0)
     {
-        memFree(select);
+        memFrameFree(select);
         return NULL;
     }
 
@@ -6101,7 +6570,7 @@ DONT_MOVE_ME_YET:
                                 }
 #endif
 
-                                memFree(attack);
+                                memFrameFree(attack);
                             }
                         }
                     }
@@ -6128,7 +6597,7 @@ DONT_MOVE_ME_YET:
                                     clPassiveAttack(&universe.mainCommandLayer,&selectone,attack);
                                 }
 #endif
-                               memFree(attack);
+                               memFrameFree(attack);
                             }
                         }
                     }
@@ -6174,7 +6643,7 @@ DONT_MOVE_ME_YET:
                                     ChangeOrderToPassiveAttack(command,attack);
                                 }
 #endif
-                                memFree(attack);
+                                memFrameFree(attack);
                             }
                         }
                     }
@@ -6226,8 +6695,10 @@ void univupdateReset()
     listInit(&universe.MinorSpaceObjList);
     listInit(&universe.effectList);
     listInit(&universe.ShipList);
+    univShipIndexDirty();
     listInit(&universe.BulletList);
     listInit(&universe.ResourceList);
+    spqSetDirty(SPQ_Resources);
     listInit(&universe.DerelictList);
     listInit(&universe.ImpactableList);
     listInit(&universe.MissileList);
@@ -6636,6 +7107,8 @@ void univupdateCloseAllObjectsAndMissionSpheres()
     sdword i;
 
     univCloseFastNetworkIDLookups();
+    univShipIndexClose();
+    spqClose();
     growSelectClose(&universe.HousekeepShipList);
     growSelectClose(&ClampedShipList);
 
@@ -6720,13 +7193,16 @@ void univupdateCloseAllObjectsAndMissionSpheres()
 
     listInit(&universe.effectList);
     listInit(&universe.ShipList);
+    univShipIndexDirty();
     listInit(&universe.BulletList);
     listInit(&universe.ResourceList);
+    spqSetDirty(SPQ_Resources);
     listInit(&universe.DerelictList);
     listInit(&universe.ImpactableList);
     listInit(&universe.MissileList);
 
     bobListDelete(&universe.collBlobList);
+    collReset();
 
     listDeleteAll(&universe.MineFormationList);
     listDeleteAll(&universe.ResourceVolumeList);
@@ -7255,13 +7731,13 @@ void univCheckRegrowResources(void)
 }
 
 /*-----------------------------------------------------------------------------
-    Name        : univUpdate
+    Name        : univUpdateMain
     Description : Updates the mission sphere ships and objects
     Inputs      : phystimeelapsed, time since last time it was updated
     Outputs     :
     Return      : TRUE if done (game over)
 ----------------------------------------------------------------------------*/
-bool univUpdate(real32 phystimeelapsed)
+static bool univUpdateMain(real32 phystimeelapsed)
 {
 #ifdef _WIN32
 #define TMP_SAVEDGAMES_PATH "SavedGames\\"
@@ -7277,7 +7753,7 @@ bool univUpdate(real32 phystimeelapsed)
         if (multiPlayerGame)
         {
             sprintf(savegamename,TMP_SAVEDGAMES_PATH "AutoSave%f",universe.totaltimeelapsed);
-            SaveGame(savegamename);
+            SaveGameBackground(savegamename);
             clCommandMessage(strGetString(strSavedGame));
         }
         else
@@ -7293,7 +7769,7 @@ bool univUpdate(real32 phystimeelapsed)
                 {
                     sprintf(savegamename,TMP_SAVEDGAMES_PATH "AutoSaveDebug%d",savenumber);
                     savenumber = (savenumber+1) & 7;
-                    SaveGame(savegamename);
+                    SaveGameBackground(savegamename);
                     clCommandMessage(strGetString(strSavedGame));
                 }
             }
@@ -7576,6 +8052,24 @@ bool univUpdate(real32 phystimeelapsed)
     return FALSE;
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : univUpdate
+    Description : Updates the mission sphere ships and objects
+    Inputs      : phystimeelapsed, time since last time it was updated
+    Outputs     : releases everything allocated from the frame arena during
+                    the update
+    Return      : TRUE if done (game over)
+----------------------------------------------------------------------------*/
+bool univUpdate(real32 phystimeelapsed)
+{
+    memframemark mark = memFrameMark();
+    bool result;
+
+    result = univUpdateMain(phystimeelapsed);
+    memFrameReset(&mark);
+    return(result);
+}
+
 void univKillPlayer(sdword i,sdword playerdeathtype)
 {
     char filename[50];
@@ -10,6 +10,7 @@
 #define ___UNIVUPDATE_H
 
 #include "LinkedList.h"
+#include "Memory.h"
 #include "ShipSelect.h"
 #include "SpaceObj.h"
 #include "Types.h"
@@ -50,6 +51,8 @@ typedef struct IDToPtrTable
 {
     sdword numEntries;
     SpaceObjPtr *objptrs;
+    memobjpool *pool;           // if the objects come from a pool, lookups go through
+    memobjhandle *handles;      // these so an ID never finds an object after it's freed
 } IDToPtrTable;
 
 /*=============================================================================
@@ -63,6 +66,7 @@ void univupdateClose();
 void univupdateCloseAllObjectsAndMissionSpheres();
 
 bool univUpdate(real32 phystimeelapsed);
+void univUpdateAllPosVelEffects(void);
 
 void univRotateObjYaw(SpaceObjRot *robj,real32 rot);
 void univRotateObjPitch(SpaceObjRot *robj,real32 rot);
@@ -108,6 +112,12 @@ void univHideShipFromSpheres(Ship *ship);           //hides from all mission sph
 void univUnhideJustAboutEverything(void);
 void univHideJustAboutEverything(void);
 
+void univShipIndexDirty(void);
+void univShipIndexClose(void);
+sdword univShipsOfPlayer(sdword playerIndex, Ship ***ships);
+sdword univShipsOfPlayerType(sdword playerIndex, ShipType shiptype, Ship ***ships);
+sdword univShipsOfPlayerClass(sdword playerIndex, ShipClass shipclass, Ship ***ships);
+
 void univGetResourceStatistics(sdword *resourceValue,sdword *numHarvestableResources,sdword *numAsteroid0s);
 Resource *univFindNearestResource(Ship *ship,real32 volumeRadius,vector *volumePosition);
 
@@ -211,4 +221,7 @@ extern IDToPtrTable ResourceIDToPtr;
 extern IDToPtrTable DerelictIDToPtr;
 extern IDToPtrTable MissileIDToPtr;
 
+extern memobjpool univBulletPool;
+extern memobjpool univMissilePool;
+
 #endif
@@ -1,4 +1,5 @@
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "Debug.h"
@@ -6,37 +7,92 @@
 #include "Queue.h"
 
 #define QUEUE_WRAPAROUND_FLAG   0xffffffffL
+#define QUEUE_MIN_SEGMENT       64
+
+//bytes a packet takes in a segment; packets are kept udword aligned
+#define QUEUE_RECORD_SIZE(n)    (sizeof(udword) + (((n) + 3) & ~3))
+
+/*-----------------------------------------------------------------------------
+    Name        : queueSegmentReset
+    Description : Empties a segment and unlinks it from any that follow
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void queueSegmentReset(QueueSegment *segment)
+{
+    segment->next = NULL;
+    SDL_AtomicSet(&segment->head, 0);
+    SDL_AtomicSet(&segment->tail, 0);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : queueFreeChained
+    Description : Frees the segments the producer chained on, from the oldest
+                  one still in use.  The first segment is kept.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+static void queueFreeChained(Queue *queue)
+{
+    QueueSegment *segment, *next;
+
+    for (segment = queue->doneSegment; segment != NULL; segment = next)
+    {
+        next = segment->next;
+        if (segment != &queue->first)
+        {
+            free(segment);
+        }
+    }
+}
 
 /*-----------------------------------------------------------------------------
     Name        : ResetQueue
-    Description : Resets the Queue
+    Description : Resets the Queue, going back to the first segment.  Frees
+                  any chained segments, so the caller must hold the queue
+                  lock if a producer may still be running.
     Inputs      :
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void ResetQueue(Queue *queue)
 {
-    queue->head = 0;
-    queue->tail = 0;
-    queue->num = 0;
-    queue->totalsize = 0;
+    queueFreeChained(queue);
+    queueSegmentReset(&queue->first);
+    queue->writeSegment = queue->readSegment = queue->doneSegment = &queue->first;
+    queue->readPosition = 0;
+    SDL_AtomicSet(&queue->num, 0);
+    SDL_AtomicSet(&queue->totalsize, 0);
     queue->totaltotalsize = 0;
     queue->overruns = 0;
+    queue->numSegments = 0;
+    queue->highWaterEntries = 0;
+    queue->highWaterSize = 0;
 }
 
 /*-----------------------------------------------------------------------------
     Name        : InitQueue
     Description : Initializes the Queue
-    Inputs      :
+    Inputs      : buffersize - size of the first segment, rounded up to a
+                    power of two
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void InitQueue(Queue *queue,udword buffersize)
 {
+    udword size;
+
+    for (size = QUEUE_MIN_SEGMENT; size < buffersize; size <<= 1)
+        ;
+
     queue->mutex = SDL_CreateMutex();
     dbgAssertOrIgnore(queue->mutex != NULL);
-    queue->buffer = memAlloc(buffersize,"qbuffer",NonVolatile);
-    queue->buffersize = buffersize;
+    queue->first.buffer = memAlloc(size,"qbuffer",NonVolatile);
+    queue->first.size = size;
+    queue->buffersize = size;
+    queue->doneSegment = NULL;
     ResetQueue(queue);
 }
 
@@ -49,15 +105,17 @@ void InitQueue(Queue *queue,udword buffersize)
 ----------------------------------------------------------------------------*/
 void CloseQueue(Queue *queue)
 {
+    queueFreeChained(queue);
+    queue->doneSegment = NULL;
     SDL_DestroyMutex(queue->mutex);
     queue->mutex = NULL;
-    memFree(queue->buffer);
-    queue->buffer = NULL;
+    memFree(queue->first.buffer);
+    queue->first.buffer = NULL;
 }
 
 /*-----------------------------------------------------------------------------
     Name        : LockQueue
-    Description : Locks the Queue for exclusive access
+    Description : Locks the Queue against other producers
     Inputs      :
     Outputs     :
     Return      :
@@ -69,7 +127,7 @@ void LockQueue(Queue *queue)
 
 /*-----------------------------------------------------------------------------
     Name        : UnLockQueue
-    Description : Unlocks the queue, so other tasks can access it
+    Description : Unlocks the queue, so other producers can access it
     Inputs      :
     Outputs     :
     Return      :
@@ -79,96 +137,174 @@ void UnLockQueue(Queue *queue)
     dbgAssertAlwaysDo(SDL_mutexV(queue->mutex) != -1);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : queueSegmentChain
+    Description : Called by the producer when its segment is full.  Chains on
+                  a new segment twice the size (or big enough for the
+                  packet) and moves the producer there.  It's allocated with
+                  malloc because the producer is usually not the game thread.
+    Inputs      : sizeinQ - bytes the packet needs
+    Outputs     :
+    Return      : the new segment, or NULL if out of memory
+----------------------------------------------------------------------------*/
+static QueueSegment *queueSegmentChain(Queue *queue,udword sizeinQ)
+{
+    QueueSegment *segment;
+    udword size = queue->writeSegment->size;
+
+    if (size < QUEUE_MAX_SEGMENT)
+    {
+        size <<= 1;
+    }
+    while (size < sizeinQ)
+    {
+        size <<= 1;
+    }
+
+    segment = malloc(sizeof(QueueSegment) + size);
+    if (segment == NULL)
+    {
+        return NULL;
+    }
+    segment->buffer = (ubyte *)(segment + 1);
+    segment->size = size;
+    queueSegmentReset(segment);
+
+    //once the consumer sees this it will move on after reading out the old segment
+    SDL_AtomicSetPtr((void **)&queue->writeSegment->next, segment);
+    queue->writeSegment = segment;
+    queue->numSegments++;
+
+    return segment;
+}
+
 /*-----------------------------------------------------------------------------
     Name        : Enqueue
-    Description : Enqueue's data
+    Description : Enqueue's data.  Only one thread may enqueue at a time.
     Inputs      : packet, sizeofPacket
     Outputs     :
     Return      :
 ----------------------------------------------------------------------------*/
 void HWEnqueue(Queue *queue,ubyte *packet,udword sizeofPacket)
 {
+    QueueSegment *segment = queue->writeSegment;
     ubyte *writeto;
-    udword sizeinQ = sizeof(udword) + sizeofPacket;
+    udword sizeinQ = QUEUE_RECORD_SIZE(sizeofPacket);
+    udword head, position, skip, num, totalsize;
     dbgAssertOrIgnore(sizeofPacket > 0);
 
-    if ((queue->totalsize+sizeinQ) > queue->buffersize)
+    head = (udword)SDL_AtomicGet(&segment->head);
+    position = head & (segment->size - 1);
+    skip = (segment->size - position < sizeinQ) ? segment->size - position : 0;
+
+    if (head + skip + sizeinQ - (udword)SDL_AtomicGet(&segment->tail) > segment->size)
     {
-        queue->overruns++;
-        return;
+        // full, so chain on a bigger segment rather than drop the packet
+        segment = queueSegmentChain(queue,sizeinQ);
+        if (segment == NULL)
+        {
+            queue->overruns++;
+            return;
+        }
+        head = position = skip = 0;
     }
 
-    if ((queue->head+sizeinQ) > queue->buffersize)
+    if (skip)
     {
         // we are going over end of buffer, so wrap around
-        writeto = &queue->buffer[queue->head];
-        *((udword *)writeto) = QUEUE_WRAPAROUND_FLAG;           // flag to indicate this is an invalid Q entry, and user should wrap to beginning
-        queue->head = 0;
+        *((udword *)&segment->buffer[position]) = QUEUE_WRAPAROUND_FLAG;   // flag to indicate this is an invalid Q entry, and user should wrap to beginning
+        position = 0;
     }
 
-    writeto = &queue->buffer[queue->head];
-
-    // Replaced *((udword *)writeto)++ = sizeofPacket;
-    // to resolve compile issue with GCC v4.
-    // Believe that this is correct, but unable to test fully.
+    writeto = &segment->buffer[position];
     *((udword *)writeto) = sizeofPacket;
-    writeto += sizeof(udword);
+    memcpy(writeto + sizeof(udword),packet,sizeofPacket);
 
-    queue->head += sizeinQ;
-    if ((queue->head+sizeof(udword)) > queue->buffersize)
-    {
-        queue->head = 0;
-    }
+    // publish it; the consumer can read it from here on
+    SDL_AtomicSet(&segment->head,(int)(head + skip + sizeinQ));
 
-    queue->totalsize += sizeinQ;
+    num = (udword)SDL_AtomicAdd(&queue->num,1) + 1;
+    totalsize = (udword)SDL_AtomicAdd(&queue->totalsize,(int)sizeinQ) + sizeinQ;
     queue->totaltotalsize += sizeinQ;
-
-    memcpy(writeto,packet,sizeofPacket);
-    
-    queue->num++;
+    if (num > queue->highWaterEntries)
+    {
+        queue->highWaterEntries = num;
+    }
+    if (totalsize > queue->highWaterSize)
+    {
+        queue->highWaterSize = totalsize;
+    }
 }
 
 /*-----------------------------------------------------------------------------
-    Name        : Dequeue
-    Description : Dequeue's data
-    Inputs      :
+    Name        : queueRead
+    Description : Finds the next packet for the consumer, moving on to the
+                  next segment when the producer has and this one is read out.
+    Inputs      : dequeue - TRUE to take the packet off the queue
     Outputs     : packet pointer
-    Return      : size of data returned
+    Return      : size of data returned, 0 if the queue is empty
 ----------------------------------------------------------------------------*/
-udword HWDequeue(Queue *queue,ubyte **packet)
+static udword queueRead(Queue *queue,ubyte **packet,bool dequeue)
 {
+    QueueSegment *segment = queue->readSegment, *next;
+    udword position = queue->readPosition;
+    udword sizeofPacket, sizeinQ;
     ubyte *readfrom;
-    udword sizeofPacket;
-    udword sizeinQ;
 
-    if (queue->num == 0)
+    if (SDL_AtomicGet(&queue->num) == 0)
     {
         return 0;
     }
 
-    readfrom = &queue->buffer[queue->tail];
+    for (;;)
+    {
+        // next has to be read before head: once it's set, head won't change
+        next = (QueueSegment *)SDL_AtomicGetPtr((void **)&segment->next);
+        if (position != (udword)SDL_AtomicGet(&segment->head))
+        {
+            break;
+        }
+        if (next == NULL)
+        {
+            return 0;
+        }
+        segment = queue->readSegment = next;
+        position = queue->readPosition = 0;
+    }
+
+    readfrom = &segment->buffer[position & (segment->size - 1)];
     if (*((udword *)readfrom) == QUEUE_WRAPAROUND_FLAG)
     {
-        readfrom = &queue->buffer[0];
-        queue->tail = 0;
+        position += segment->size - (position & (segment->size - 1));
+        readfrom = &segment->buffer[0];
     }
 
     sizeofPacket = *((udword *)readfrom);
-    readfrom += sizeof(udword);
-    *packet = readfrom;
-    sizeinQ = sizeof(udword) + sizeofPacket;
-    queue->tail += sizeinQ;
-    if ((queue->tail+sizeof(udword)) > queue->buffersize)
+    *packet = readfrom + sizeof(udword);
+
+    if (dequeue)
     {
-        queue->tail = 0;
+        sizeinQ = QUEUE_RECORD_SIZE(sizeofPacket);
+        queue->readPosition = position + sizeinQ;
+        SDL_AtomicAdd(&queue->totalsize,-(int)sizeinQ);
+        SDL_AtomicAdd(&queue->num,-1);
     }
-    queue->totalsize -= sizeinQ;
-
-    queue->num--;
 
     return sizeofPacket;
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : Dequeue
+    Description : Dequeue's data.  The packet stays valid until HWDequeueDone.
+    Inputs      :
+    Outputs     : packet pointer
+    Return      : size of data returned
+----------------------------------------------------------------------------*/
+udword HWDequeue(Queue *queue,ubyte **packet)
+{
+    return queueRead(queue,packet,TRUE);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : Peekqueue
     Description : Peek at the next data in the queue without actually dequeueing
@@ -178,25 +314,30 @@ udword HWDequeue(Queue *queue,ubyte **packet)
 ----------------------------------------------------------------------------*/
 udword Peekqueue(Queue *queue,ubyte **packet)
 {
-    ubyte *readfrom;
-    udword sizeofPacket;
-    //udword sizeinQ;
+    return queueRead(queue,packet,FALSE);
+}
 
-    if (queue->num == 0)
-    {
-        return 0;
-    }
+/*-----------------------------------------------------------------------------
+    Name        : HWDequeueDone
+    Description : Gives the space of the packets dequeued so far back to the
+                  producer and frees the segments they were read out of.
+                  Packets dequeued before this mustn't be used after it.
+    Inputs      :
+    Outputs     :
+    Return      :
+----------------------------------------------------------------------------*/
+void HWDequeueDone(Queue *queue)
+{
+    QueueSegment *segment;
 
-    readfrom = &queue->buffer[queue->tail];
-    if (*((udword *)readfrom) == QUEUE_WRAPAROUND_FLAG)
+    while (queue->doneSegment != queue->readSegment)
     {
-        readfrom = &queue->buffer[0];
+        segment = queue->doneSegment;
+        queue->doneSegment = segment->next;
+        if (segment != &queue->first)
+        {
+            free(segment);
+        }
     }
-
-    sizeofPacket = *((udword *)readfrom);
-    readfrom += sizeof(udword);
-    *packet = readfrom;
-
-    return sizeofPacket;
+    SDL_AtomicSet(&queue->readSegment->tail,(int)queue->readPosition);
 }
-
@@ -1,26 +1,58 @@
-
 #ifndef ___QUEUE_H
 #define ___QUEUE_H
 
 #include <SDL.h>
 #include "Types.h"
 
+/*=============================================================================
+    Notes:
+
+    A Queue is a lock-free ring buffer of variable-sized packets for one
+    producer thread and one consumer thread.  When a burst fills the ring
+    the producer chains on a bigger segment instead of dropping packets;
+    the consumer follows it there once it has read everything before it.
+
+    If several threads enqueue, they must serialise their HWEnqueue calls
+    with LockQueue/UnLockQueue.  The consumer doesn't lock: packets it gets
+    from HWDequeue/Peekqueue stay where they are until it calls
+    HWDequeueDone, which gives their space back to the producer.
+=============================================================================*/
+
+/*=============================================================================
+    Definitions:
+=============================================================================*/
+
+#define QUEUE_MAX_SEGMENT       (16 * 1024 * 1024)  // segments stop doubling at this size
+
 /*=============================================================================
     Types:
 =============================================================================*/
 
-typedef struct
+typedef struct QueueSegment
 {
-    //void *mutex;
-    SDL_mutex *mutex;
+    struct QueueSegment *next;  // segment the producer moved on to, set by the producer
     ubyte *buffer;
-    udword buffersize;
-    udword head;
-    udword tail;
-    udword num;
-    udword totalsize;
+    udword size;                // power of two
+    SDL_atomic_t head;          // bytes written, set by the producer
+    SDL_atomic_t tail;          // bytes given back, set by the consumer
+} QueueSegment;
+
+typedef struct
+{
+    SDL_mutex *mutex;           // serialises producers
+    QueueSegment first;         // made by InitQueue, kept until CloseQueue
+    QueueSegment *writeSegment; // producer's segment
+    QueueSegment *readSegment;  // consumer's segment
+    QueueSegment *doneSegment;  // oldest segment not given back yet
+    udword readPosition;        // consumer's position in readSegment
+    udword buffersize;          // size of the first segment
+    SDL_atomic_t num;
+    SDL_atomic_t totalsize;
     udword totaltotalsize;
     udword overruns;
+    udword numSegments;         // segments chained since the queue was reset
+    udword highWaterEntries;    // most packets queued at once
+    udword highWaterSize;       // most bytes queued at once
 } Queue;
 
 /*=============================================================================
@@ -33,6 +65,7 @@ void ResetQueue(Queue *queue);
 void HWEnqueue(Queue *queue,ubyte *packet,udword sizeofPacket);
 udword HWDequeue(Queue *queue,ubyte **packet);
 udword Peekqueue(Queue *queue,ubyte **packet);
+void HWDequeueDone(Queue *queue);
 void LockQueue(Queue *queue);
 void UnLockQueue(Queue *queue);
 
@@ -40,8 +73,10 @@ void UnLockQueue(Queue *queue);
     Macros:
 =============================================================================*/
 
-#define queueNumberEntries(q) ((q).num)
+#define queueNumberEntries(q) ((udword)SDL_AtomicGet(&(q).num))
 #define queueNumberOverruns(q) ((q).overruns)
+#define queueNumberSegments(q) ((q).numSegments)
+#define queueHighWaterEntries(q) ((q).highWaterEntries)
+#define queueHighWaterSize(q) ((q).highWaterSize)
 
 #endif
-
@@ -95,8 +95,25 @@ void TTimerStart(TTimer *timer,real32 timeout)
     timer->timeoutTicks = (udword) (timeout * UTY_TimerResolutionMax);
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : GetRawTime
+    Description : Reads the high resolution performance counter.  Used by the
+                  profile timers, which divide durations by 1000 for display.
+    Inputs      :
+    Outputs     : time - current time in microseconds
+    Return      :
+----------------------------------------------------------------------------*/
 void GetRawTime(sqword *time)
 {
-    *time = SDL_GetTicks();
+    static Uint64 frequency = 0;
+    Uint64 counter;
+
+    if (frequency == 0)
+    {
+        frequency = SDL_GetPerformanceFrequency();
+    }
+
+    counter = SDL_GetPerformanceCounter();
+    *time = (sqword)((counter / frequency) * 1000000 + ((counter % frequency) * 1000000) / frequency);
 }
 
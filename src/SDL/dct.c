@@ -1,13 +1,190 @@
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include "fqcodec.h"
+#include "fqeffect.h"
 #include "dct.h"
-#include "mixfft.h"
+#include "SSE.h"
 
 #ifndef PI
 #define PI		3.14159265358979323846F
 #endif
 
+// The iDCT of len points runs a complex FFT of len/4 points
+#define FFT_MAXSIZE		(FQ_DSIZE >> 2)
+#define FFT_PLANS		3
+
+// Precomputed FFT of one power of two size: the bit reversal table, then
+// for each radix-4 pass of quarter size L the twiddles W^k, W^2k and W^3k
+// (k < L) as six runs of L floats, so the SSE loop can load them straight.
+// Nothing in here changes once it's built, so idct can run on any thread.
+typedef struct {
+	udword n;
+	udword radix2;
+	unsigned short bitrev[FFT_MAXSIZE];
+	float tw[6 * FFT_MAXSIZE];
+} FFTPLAN;
+
+static FFTPLAN gPlans[FFT_PLANS];
+static udword gNumPlans = 0;
+
+static FFTPLAN *fftPlan(udword n) {
+	udword i;
+
+	for (i = 0; i < gNumPlans; i++) {
+		if (gPlans[i].n == n) {
+			return &gPlans[i];
+		}
+	}
+	return NULL;
+}
+
+static void fftPlanInit(FFTPLAN *p, udword n) {
+	udword bits, i, j, k, t, L, o;
+	double a;
+
+	for (bits = 0; (1UL << bits) < n; bits++)
+		;
+
+	for (i = 0; i < n; i++) {
+		for (j = 0, t = i, k = 0; k < bits; k++, t >>= 1) {
+			j = (j << 1) | (t & 1);
+		}
+		p->bitrev[i] = (unsigned short)j;
+	}
+
+	// an odd power of two needs one radix-2 pass first
+	p->radix2 = bits & 1;
+
+	for (o = 0, L = p->radix2 ? 2 : 1; L < n; o += 6 * L, L <<= 2) {
+		for (k = 0; k < L; k++) {
+			for (j = 1; j <= 3; j++) {
+				a = -2.0 * 3.14159265358979323846 * (double)(j * k) / (double)(4 * L);
+				p->tw[o + (2 * j - 2) * L + k] = (float)cos(a);
+				p->tw[o + (2 * j - 1) * L + k] = (float)sin(a);
+			}
+		}
+	}
+
+	p->n = n;
+}
+
+// Forward complex FFT, y = sum x[m] * exp(-2 pi i k m / n), decimation in
+// time from bit reversed input.
+static void fftRun(FFTPLAN *p, float *xRe, float *xIm, float *yRe, float *yIm) {
+	udword n = p->n, i, g, k, L;
+	float *tw = p->tw;
+	float *w1r, *w1i, *w2r, *w2i, *w3r, *w3i;
+	float ar, ai, br, bi, cr, ci, dr, di, s0r, s0i, s1r, s1i, s2r, s2i, s3r, s3i;
+	float *yr, *yi;
+#if HW_SSE
+	__m128 var, vai, vbr, vbi, vcr, vci, vdr, vdi, vs0r, vs0i, vs1r, vs1i, vs2r, vs2i, vs3r, vs3i, vt;
+#endif
+
+	for (i = 0; i < n; i++) {
+		yRe[p->bitrev[i]] = xRe[i];
+		yIm[p->bitrev[i]] = xIm[i];
+	}
+
+	L = 1;
+	if (p->radix2) {
+		for (i = 0; i < n; i += 2) {
+			ar = yRe[i];
+			ai = yIm[i];
+			yRe[i] = ar + yRe[i + 1];
+			yIm[i] = ai + yIm[i + 1];
+			yRe[i + 1] = ar - yRe[i + 1];
+			yIm[i + 1] = ai - yIm[i + 1];
+		}
+		L = 2;
+	}
+
+	for (; L < n; tw += 6 * L, L <<= 2) {
+		w1r = tw;
+		w1i = tw + L;
+		w2r = tw + 2 * L;
+		w2i = tw + 3 * L;
+		w3r = tw + 4 * L;
+		w3i = tw + 5 * L;
+
+		for (g = 0; g < n; g += 4 * L) {
+			yr = yRe + g;
+			yi = yIm + g;
+			k = 0;
+#if HW_SSE
+			if (fqVector) {
+				for (; k + 4 <= L; k += 4) {
+					var = _mm_loadu_ps(&yr[k]);
+					vai = _mm_loadu_ps(&yi[k]);
+
+					vt = _mm_loadu_ps(&yr[k + L]);
+					vbi = _mm_loadu_ps(&yi[k + L]);
+					vbr = _mm_sub_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w2r[k])), _mm_mul_ps(vbi, _mm_loadu_ps(&w2i[k])));
+					vbi = _mm_add_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w2i[k])), _mm_mul_ps(vbi, _mm_loadu_ps(&w2r[k])));
+
+					vt = _mm_loadu_ps(&yr[k + 2 * L]);
+					vci = _mm_loadu_ps(&yi[k + 2 * L]);
+					vcr = _mm_sub_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w1r[k])), _mm_mul_ps(vci, _mm_loadu_ps(&w1i[k])));
+					vci = _mm_add_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w1i[k])), _mm_mul_ps(vci, _mm_loadu_ps(&w1r[k])));
+
+					vt = _mm_loadu_ps(&yr[k + 3 * L]);
+					vdi = _mm_loadu_ps(&yi[k + 3 * L]);
+					vdr = _mm_sub_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w3r[k])), _mm_mul_ps(vdi, _mm_loadu_ps(&w3i[k])));
+					vdi = _mm_add_ps(_mm_mul_ps(vt, _mm_loadu_ps(&w3i[k])), _mm_mul_ps(vdi, _mm_loadu_ps(&w3r[k])));
+
+					vs0r = _mm_add_ps(var, vbr);
+					vs0i = _mm_add_ps(vai, vbi);
+					vs1r = _mm_sub_ps(var, vbr);
+					vs1i = _mm_sub_ps(vai, vbi);
+					vs2r = _mm_add_ps(vcr, vdr);
+					vs2i = _mm_add_ps(vci, vdi);
+					vs3r = _mm_sub_ps(vcr, vdr);
+					vs3i = _mm_sub_ps(vci, vdi);
+
+					_mm_storeu_ps(&yr[k], _mm_add_ps(vs0r, vs2r));
+					_mm_storeu_ps(&yi[k], _mm_add_ps(vs0i, vs2i));
+					_mm_storeu_ps(&yr[k + L], _mm_add_ps(vs1r, vs3i));
+					_mm_storeu_ps(&yi[k + L], _mm_sub_ps(vs1i, vs3r));
+					_mm_storeu_ps(&yr[k + 2 * L], _mm_sub_ps(vs0r, vs2r));
+					_mm_storeu_ps(&yi[k + 2 * L], _mm_sub_ps(vs0i, vs2i));
+					_mm_storeu_ps(&yr[k + 3 * L], _mm_sub_ps(vs1r, vs3i));
+					_mm_storeu_ps(&yi[k + 3 * L], _mm_add_ps(vs1i, vs3r));
+				}
+			}
+#endif
+			for (; k < L; k++) {
+				ar = yr[k];
+				ai = yi[k];
+				br = yr[k + L] * w2r[k] - yi[k + L] * w2i[k];
+				bi = yr[k + L] * w2i[k] + yi[k + L] * w2r[k];
+				cr = yr[k + 2 * L] * w1r[k] - yi[k + 2 * L] * w1i[k];
+				ci = yr[k + 2 * L] * w1i[k] + yi[k + 2 * L] * w1r[k];
+				dr = yr[k + 3 * L] * w3r[k] - yi[k + 3 * L] * w3i[k];
+				di = yr[k + 3 * L] * w3i[k] + yi[k + 3 * L] * w3r[k];
+
+				s0r = ar + br;
+				s0i = ai + bi;
+				s1r = ar - br;
+				s1i = ai - bi;
+				s2r = cr + dr;
+				s2i = ci + di;
+				s3r = cr - dr;
+				s3i = ci - di;
+
+				// the odd outputs take (c - d) times -i
+				yr[k] = s0r + s2r;
+				yi[k] = s0i + s2i;
+				yr[k + L] = s1r + s3i;
+				yi[k + L] = s1i - s3r;
+				yr[k + 2 * L] = s0r - s2r;
+				yi[k + 2 * L] = s0i - s2i;
+				yr[k + 3 * L] = s1r - s3i;
+				yi[k + 3 * L] = s1i + s3r;
+			}
+		}
+	}
+}
+
 int Initdct(float *buf, udword len) {
 	udword i;
 	float f;
@@ -18,41 +195,85 @@ int Initdct(float *buf, udword len) {
 		buf[i + (len >> 2)] = cos(f);
 	}
 
+	if ((len > FQ_DSIZE) || (len & (len - 1))) {
+		return ERR;
+	}
+	if ((fftPlan(len >> 2) == NULL) && (gNumPlans < FFT_PLANS)) {
+		fftPlanInit(&gPlans[gNumPlans], len >> 2);
+		gNumPlans++;
+	}
+
 	return OK;
 }
 
 int idct(float *a, float *b, float *c, udword len) {
-	udword i, j;
-	float aa[len], ab[len], ac[len], ad[len], ae[len];
+	udword i;
+	float aa[FFT_MAXSIZE], ab[FFT_MAXSIZE], ac[FFT_MAXSIZE], ad[FFT_MAXSIZE], ae[FQ_DSIZE];
+	FFTPLAN *plan = fftPlan(len >> 2);
 
 	udword hlen = len / 2;
 	udword qlen = len / 4;
 	udword q3len = qlen * 3;
 	float factor = 8.0 / sqrt(len);
+	float *cs = c, *cc = c + qlen;
+#if HW_SSE
+	__m128 vf = _mm_set1_ps(factor), ve, vo, vs, vc, vt;
+#endif
+
+	if (plan == NULL) {
+		return ERR;
+	}
 
-	memset(aa, 0, len << 2);
-	memset(ab, 0, len << 2);
-	memset(ac, 0, len << 2);
-	memset(ad, 0, len << 2);
-	memset(ae, 0, len << 2);
+	// every entry of aa/ab and ae is written before it's read
+	i = 0;
+#if HW_SSE
+	if (fqVector) {
+		for (; i + 4 <= qlen; i += 4) {
+			ve = _mm_loadu_ps(&a[i * 2]);
+			vt = _mm_loadu_ps(&a[i * 2 + 4]);
+			ve = _mm_mul_ps(_mm_shuffle_ps(ve, vt, _MM_SHUFFLE(2, 0, 2, 0)), vf);
 
-	for (i = 0; i < qlen; i++) {
-		float x = a[i * 2] * factor * c[i + qlen];
-		float w = a[hlen - (i * 2) - 1] * factor * c[i];
-		float u = a[i * 2] * factor * c[i] * -1;
-		float t = a[hlen - (i * 2) - 1] * factor * c[i + qlen];
+			// a[hlen - 1 - 2i] for the four i, read backwards
+			vo = _mm_loadu_ps(&a[hlen - (i * 2) - 8]);
+			vt = _mm_loadu_ps(&a[hlen - (i * 2) - 4]);
+			vo = _mm_shuffle_ps(vo, vt, _MM_SHUFFLE(3, 1, 3, 1));
+			vo = _mm_mul_ps(_mm_shuffle_ps(vo, vo, _MM_SHUFFLE(0, 1, 2, 3)), vf);
 
-		aa[i] = x + w;
-		ab[i] = u + t;
+			vs = _mm_loadu_ps(&cs[i]);
+			vc = _mm_loadu_ps(&cc[i]);
+			_mm_storeu_ps(&aa[i], _mm_add_ps(_mm_mul_ps(ve, vc), _mm_mul_ps(vo, vs)));
+			_mm_storeu_ps(&ab[i], _mm_sub_ps(_mm_mul_ps(vo, vc), _mm_mul_ps(ve, vs)));
+		}
+	}
+#endif
+	for (; i < qlen; i++) {
+		float e = a[i * 2] * factor;
+		float o = a[hlen - (i * 2) - 1] * factor;
+
+		aa[i] = e * cc[i] + o * cs[i];
+		ab[i] = o * cc[i] - e * cs[i];
 	}
 
-	fft(qlen, aa, ab, ac, ad);
+	fftRun(plan, aa, ab, ac, ad);
 
-	for (i=0; i < qlen; i++) {
-		float y = ac[i] * c[i + qlen];
-		float x = ad[i] * c[i];
-		float v = ac[i] * c[i] * -1;
-		float u = ad[i] * c[i + qlen];
+	i = 0;
+#if HW_SSE
+	if (fqVector) {
+		for (; i + 4 <= qlen; i += 4) {
+			ve = _mm_loadu_ps(&ac[i]);
+			vo = _mm_loadu_ps(&ad[i]);
+			vs = _mm_loadu_ps(&cs[i]);
+			vc = _mm_loadu_ps(&cc[i]);
+			_mm_storeu_ps(&ac[i], _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ve, vc), _mm_mul_ps(vo, vs)), vf));
+			_mm_storeu_ps(&ad[i], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(vo, vc), _mm_mul_ps(ve, vs)), vf));
+		}
+	}
+#endif
+	for (; i < qlen; i++) {
+		float y = ac[i] * cc[i];
+		float x = ad[i] * cs[i];
+		float v = ac[i] * cs[i] * -1;
+		float u = ad[i] * cc[i];
 
 		ac[i] = (y + x) * factor;
 		ad[i] = (v + u) * factor;
@@ -2,7 +2,9 @@
 #include <string.h>
 #include <math.h>
 #include "fqcodec.h"
+#include "fqeffect.h"
 #include "dct.h"
+#include "SSE.h"
 
 #define iclamp(x, a, b) (x > a ? a : (x < b ? b : x)) 
 
@@ -18,11 +20,28 @@ static float gCHBlock[FQ_HSIZE];
 static float gCBlock[FQ_SIZE];
 static float gCDBlock[FQ_DSIZE];
 
+static int gTablesInit = 0;
+
 static void fqWriteTBlockBuf(float *aLBlock, float *aRBlock, short nChan, short *pBuf, udword nSize) {
-	udword i;
+	udword i = 0;
+#if HW_SSE2
+	__m128 fmax = _mm_set1_ps(32767.0f), fmin = _mm_set1_ps(-32768.0f);
+	__m128i l, r;
+#endif
 
 	if ((pBuf != 0) && (nSize > 0)) {
-		for (i = 0; i < nSize; i += 2) {
+#if HW_SSE2
+		// 4 frames at a time; clamping before the convert keeps big values
+		// from wrapping, and the convert rounds to nearest like rint
+		if (fqVector) {
+			for (; i + 8 <= nSize; i += 8) {
+				l = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&aLBlock[i/2]), fmin), fmax));
+				r = (nChan <= 1) ? l : _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&aRBlock[i/2]), fmin), fmax));
+				_mm_storeu_si128((__m128i *)&pBuf[i], _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+			}
+		}
+#endif
+		for (; i < nSize; i += 2) {
 			pBuf[i] = iclamp(rint(aLBlock[i/2]), 32767, -32768);
 			if (nChan <= 1) {
 				pBuf[i + 1] = pBuf[i];
@@ -41,12 +60,25 @@ int fqWriteTBlock(float *aLBlock, float *aRBlock, short nChan, void *pBuf1, udwo
 
 int fqDecOver(float *aFPBlock, float *aFSBlock, float *aTPBlock, float *aTSBlock, float *aCBlock, float *aWBlock, udword nSize) {
 	float buf[FQ_DSIZE];
-	udword h = nSize >> 1, i;
+	udword h = nSize >> 1, i = 0;
+#if HW_SSE2
+	__m128 wl, wh;
+#endif
 
 	memcpy(aTPBlock, aTSBlock, nSize * sizeof(float));
 	idct(aFPBlock, buf, aCBlock, nSize);
 	idct(aFSBlock, aTSBlock, aCBlock, nSize);
-	for(i = 0; i < h; i++) {
+#if HW_SSE2
+	if (fqVector) {
+		for(; i + 4 <= h; i += 4) {
+			wl = _mm_loadu_ps(&aWBlock[i]);
+			wh = _mm_loadu_ps(&aWBlock[i + h]);
+			_mm_storeu_ps(&aTPBlock[i + h], _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&aTPBlock[i + h]), wh), _mm_mul_ps(_mm_loadu_ps(&buf[i]), wl)));
+			_mm_storeu_ps(&aTSBlock[i], _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&buf[i + h]), wh), _mm_mul_ps(_mm_loadu_ps(&aTSBlock[i]), wl)));
+		}
+	}
+#endif
+	for(; i < h; i++) {
 		aTPBlock[i + h] = (aTPBlock[i + h] * aWBlock[i + h]) + (buf[i] * aWBlock[i]);
 		aTSBlock[i] = (buf[i + h] * aWBlock[i + h]) + (aTSBlock[i] * aWBlock[i]);
 	}
@@ -60,15 +92,19 @@ int fqDecBlock(float *aFPBlock, float *aFSBlock, float *aTPBlock, float *aTSBloc
 
 	if(nMode == 0) {
 		memset(aTSBlock, 0, FQ_DSIZE * sizeof(float));
-		for (i = 0; i < FQ_HSIZE; i++)
-			gWHBlock[i] = sin(PI / FQ_HSIZE * i);
-		for (i = 0; i < FQ_SIZE; i++)
-			gWBlock[i] = sin(PI / FQ_SIZE * i);
-		for (i = 0; i < FQ_DSIZE; i++)
-			gWDBlock[i] = sin(PI / FQ_DSIZE * i);
-		Initdct(gCHBlock, FQ_HSIZE);
-		Initdct(gCBlock, FQ_SIZE);
-		Initdct(gCDBlock, FQ_DSIZE);
+		// the windows and iDCT plans are shared by every decoder, so only
+		// build them the first time through
+		if (!gTablesInit) {
+			for (i = 0; i < FQ_HSIZE; i++)
+				gWHBlock[i] = sin(PI / FQ_HSIZE * i);
+			for (i = 0; i < FQ_SIZE; i++)
+				gWBlock[i] = sin(PI / FQ_SIZE * i);
+			for (i = 0; i < FQ_DSIZE; i++)
+				gWDBlock[i] = sin(PI / FQ_DSIZE * i);
+			if ((Initdct(gCHBlock, FQ_HSIZE) != OK) || (Initdct(gCBlock, FQ_SIZE) != OK) || (Initdct(gCDBlock, FQ_DSIZE) != OK))
+				return ERR;
+			gTablesInit = 1;
+		}
 	} else {
 		if(nFact == 4) {
 			fqDecOver(aFPBlock, aFSBlock, aTPBlock, aTSBlock, gCHBlock, gWHBlock, FQ_HSIZE);
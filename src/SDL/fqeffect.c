@@ -4,6 +4,7 @@
 #include <math.h>
 #include "fqcodec.h"
 #include "fqeffect.h"
+#include "SSE.h"
 
 #define rmin(x,y) ((x>y)?(y):(x))
 
@@ -17,6 +18,9 @@ double (*pSqrtF)(double) = sqrt;
 int (*pRandF)(int) = rrand;
 int nRandP;
 
+// Use the SSE block loops where there are any (cleared to time the scalar ones)
+int fqVector = HW_SSE;
+
 static float gauss = 0.0;
 static char gotgauss = 0;
 
@@ -63,41 +67,89 @@ int fqSize(udword nSize) {
 }
 
 int fqAdd(float *aPBlock, float *aSBlock) {
-	udword i;
-
-	for (i = 0; i < nBSize; i++)
+	udword i = 0;
+
+#if HW_SSE
+	if (fqVector)
+		for (; i + 4 <= nBSize; i += 4)
+			_mm_storeu_ps(&aPBlock[i], _mm_add_ps(_mm_loadu_ps(&aPBlock[i]), _mm_loadu_ps(&aSBlock[i])));
+#endif
+	for (; i < nBSize; i++)
 		aPBlock[i] += aSBlock[i];
 
 	return OK;
 }
 
 int fqScale(float *aBlock, float fLev) {
-	udword i;
+	udword i = 0;
 
 	if (fLev == 0.0)
 		memset(aBlock, 0, nBSize << 2);
-	else if (fLev != 1.0)
-		for (i = 0; i < nBSize; i++)
+	else if (fLev != 1.0) {
+#if HW_SSE
+		if (fqVector) {
+			__m128 lev = _mm_set1_ps(fLev);
+			for (; i + 4 <= nBSize; i += 4)
+				_mm_storeu_ps(&aBlock[i], _mm_mul_ps(_mm_loadu_ps(&aBlock[i]), lev));
+		}
+#endif
+		for (; i < nBSize; i++)
 			aBlock[i] *= fLev;
+	}
 
 	return OK;
 }
 
 int fqMix(float *aPBlock, float *aSBlock, float fLev) {
-	udword i;
+	udword i = 0;
 
 	if (fLev > 0.0) {
+#if HW_SSE
+		if (fqVector) {
+			__m128 lev = _mm_set1_ps(fLev);
+			for (; i + 4 <= nBSize; i += 4)
+				_mm_storeu_ps(&aPBlock[i], _mm_add_ps(_mm_loadu_ps(&aPBlock[i]), _mm_mul_ps(_mm_loadu_ps(&aSBlock[i]), lev)));
+		}
+#endif
 		if (fLev == 1.0)
-			for (i = 0; i < nBSize; i++)
+			for (; i < nBSize; i++)
 				aPBlock[i] += aSBlock[i];
 		else
-			for (i = 0; i < nBSize; i++)
+			for (; i < nBSize; i++)
 				aPBlock[i] += aSBlock[i] * fLev;
 	}
 
 	return OK;
 }
 
+// Same as fqMix into the left and right blocks, reading the source once
+int fqMixStereo(float *aLBlock, float *aRBlock, float *aSBlock, float fLevL, float fLevR) {
+	udword i = 0;
+
+	if (fLevL <= 0.0 || fLevR <= 0.0) {
+		fqMix(aLBlock, aSBlock, fLevL);
+		fqMix(aRBlock, aSBlock, fLevR);
+		return OK;
+	}
+
+#if HW_SSE
+	if (fqVector) {
+		__m128 levL = _mm_set1_ps(fLevL), levR = _mm_set1_ps(fLevR), s;
+		for (; i + 4 <= nBSize; i += 4) {
+			s = _mm_loadu_ps(&aSBlock[i]);
+			_mm_storeu_ps(&aLBlock[i], _mm_add_ps(_mm_loadu_ps(&aLBlock[i]), _mm_mul_ps(s, levL)));
+			_mm_storeu_ps(&aRBlock[i], _mm_add_ps(_mm_loadu_ps(&aRBlock[i]), _mm_mul_ps(s, levR)));
+		}
+	}
+#endif
+	for (; i < nBSize; i++) {
+		aLBlock[i] += aSBlock[i] * fLevL;
+		aRBlock[i] += aSBlock[i] * fLevR;
+	}
+
+	return OK;
+}
+
 int fqPitchShift(float *aBlock, float fShift) {
 	udword i, ipos;
 	float pos, buf[FQ_DSIZE];
@@ -125,9 +177,19 @@ int fqEqualize(float *aBlock, float *aEq) {
 	for (i = 0; i < FQ_EQNUM - 1; i++) {
 		if (aEq[i] <= 0.0)
 			memset(&aBlock[aEQBlock[i]], 0, (aEQBlock[i + 1] - aEQBlock[i]) << 2);
-		else if (aEq[i] != 1.0)
-			for (j = aEQBlock[i]; j < aEQBlock[i + 1]; j++)
+		else if (aEq[i] != 1.0) {
+			j = aEQBlock[i];
+#if HW_SSE
+			// the bands from 4 up are whole multiples of 4 floats
+			if (fqVector) {
+				__m128 lev = _mm_set1_ps(aEq[i]);
+				for (; j + 4 <= aEQBlock[i + 1]; j += 4)
+					_mm_storeu_ps(&aBlock[j], _mm_mul_ps(_mm_loadu_ps(&aBlock[j]), lev));
+			}
+#endif
+			for (; j < aEQBlock[i + 1]; j++)
 				aBlock[j] *= aEq[i];
+		}
 	}
 
 	return OK;
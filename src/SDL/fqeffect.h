@@ -61,6 +61,9 @@ typedef struct
 extern "C" {
 #endif
 
+// Data
+extern int fqVector;
+
 // Functions
 int fqRand(int (*pFunc)(int),int nParam);
 double fqSqrt(double (*pFunc)(double));
@@ -71,6 +74,7 @@ int fqAdd(float *aPBlock,float *aSBlock);
 //int fqMax(float *aPBlock,float *aSBlock);
 int fqScale(float *aBlock,float fLev);
 int fqMix(float *aPBlock,float *aSBlock,float fLev);
+int fqMixStereo(float *aLBlock,float *aRBlock,float *aSBlock,float fLevL,float fLevR);
 //int fqFilter(float *aBlock,udword nMinFreq,udword nMaxFreq);
 //int fqAddNoise(float *aBlock,float fLev,udword nMinFreq,udword nMaxFreq);
 //int fqGenNoise(float *aBlock,float fLev,udword nMinFreq,udword nMaxFreq);
@@ -12,18 +12,24 @@
 #include <time.h>
 #include <SDL.h>
 
+#include "AIBench.h"
 #include "AIPlayer.h"
+#include "AIThreat.h"
 #include "AutoLOD.h"
 #include "avi.h"
 // #include "bink.h"
 #include "BTG.h"
+#include "BlobBench.h"
 #include "Camera.h"
 #include "Captaincy.h"
 #include "ColPick.h"
 #include "CommandLayer.h"
 #include "ConsMgr.h"
+#include "Cull.h"
+#include "CullBench.h"
 #include "Debug.h"
 #include "Demo.h"
+#include "EffectBench.h"
 #include "FEReg.h"
 #include "File.h"
 #include "FontReg.h"
@@ -31,27 +37,39 @@
 #include "glinc.h"
 #include "Globals.h"
 #include "HorseRace.h"
+#include "Jobs.h"
 #include "Key.h"
 #include "LaunchMgr.h"
+#include "LoadBench.h"
 #include "main.h"
 #include "mainrgn.h"
 #include "Memory.h"
+#include "MeshBench.h"
+#include "MixBench.h"
 #include "mouse.h"
 #include "MultiplayerGame.h"
 #include "NIS.h"
 #include "ObjTypes.h"
 #include "Options.h"
 #include "Particle.h"
+#include "ParticleBench.h"
 #include "PiePlate.h"
+#include "Prefetch.h"
+#include "ProfileTimers.h"
+#include "QueueBench.h"
 #include "regkey.h"
 #include "render.h"
 #include "ResearchAPI.h"
 #include "ResearchGUI.h"
 #include "resource.h"
 #include "rinit.h"
+#include "SaveGame.h"
 #include "Sensors.h"
+#include "SimBench.h"
 #include "SoundEvent.h"
+#include "SpaceBench.h"
 #include "soundlow.h"
+#include "StatCache.h"
 #include "StringSupport.h"
 #include "Subtitle.h"
 #include "Tactics.h"
@@ -96,6 +114,8 @@ bool windowNeedsDeleting = FALSE;
 
 bool mainNoPerspective = FALSE;
 
+bool mainHeadless = FALSE;              //no window, GL context or sound (simulation benchmark)
+
 bool systemActive = FALSE;              //active flag for the program
 
 #ifndef _MACOSX
@@ -124,6 +144,7 @@ void *ghInstance = NULL;
 extern bool CompareBigfiles;
 extern bool IgnoreBigfiles;
 extern bool LogFileLoads;
+extern bool MapBigfiles;
 
 //command-line switches and parameters
 bool mainNoDrawPixels = FALSE;
@@ -153,6 +174,7 @@ bool mainOnlyPacking = FALSE;
 bool gShowDamage = TRUE;
 bool DebugWindow = FALSE;
 sdword MemoryHeapSize = MEM_HeapSizeDefault;
+char memTraceBenchFileName[PATH_MAX] = "";
 #if MAIN_MOUSE_FREE
 bool startupClipMouse = TRUE;
 #endif
@@ -347,6 +369,12 @@ bool HeapSizeSet(char *string)
     return TRUE;
 }
 
+bool MemTraceBenchSet(char *string)
+{
+    memStrncpy(memTraceBenchFileName, string, PATH_MAX - 1);
+    return TRUE;
+}
+
 
 bool EnableFileLoadLog(char *string)
 {
@@ -643,6 +671,14 @@ commandoption commandOptions[] =
 
     entryComment("SYSTEM OPTIONS"), //-----------------------------------------------------
     entryFnParam("/heap",           HeapSizeSet,                        " <n> - Sets size of global memory heap to [n]."),
+#if MEM_TRACE
+    entryVr("/memTrace",            memTraceEnabled, TRUE,              " - log every heap allocation and free to " MEM_TraceFileName "."),
+#endif
+#ifdef HW_BUILD_FOR_DEBUGGING
+    entryFnParam("/memTraceBench",  MemTraceBenchSet,                   " <fileName> - replay a /memTrace log through the heap allocator and report timings."),
+#else
+    entryFnParamHidden("/memTraceBench", MemTraceBenchSet,              " <fileName> - replay a /memTrace log through the heap allocator and report timings."),
+#endif
     entryFnParam("/bigoverride",    fileOverrideBigPathSet,             " <path> - Sets path to search for opening files."),
     entryFnParam("/CDpath",         fileCDROMPathSet,                   " <path> - Sets path to CD-ROM in case of ambiguity."),
     entryFnParam("/settingspath",   fileUserSettingsPathSet,            " <path> - Sets the path to store settings, saved games, and screenshots (defaults to ~/.homeworld)."),
@@ -654,6 +690,13 @@ commandoption commandOptions[] =
 #endif
 #endif
     entryVr("/ignoreBigfiles",      IgnoreBigfiles, TRUE,               " - don't use anything from bigfile(s)"),
+    entryVr("/mapBigfiles",         MapBigfiles, TRUE,                  " - memory-map bigfile(s) and read data straight from the mapping"),
+    entryVr("/noPrefetch",          pfEnabled, FALSE,                   " - don't stream level data in on background threads"),
+    entryVr("/noJobs",              jobEnabled, FALSE,                  " - don't split up the universe update across worker threads"),
+    entryVr("/noSaveThread",        saveBackgroundEnabled, FALSE,       " - write autosaves on the game thread instead of in the background"),
+    entryVr("/noStatCache",         statCacheEnabled, FALSE,            " - parse ship and gun scripts every time instead of keeping them between runs"),
+    entryVr("/noAIGrid",            aithEnabled, FALSE,                 " - computer players scan for nearby enemies instead of checking the threat grid first"),
+    entryVr("/noCull",              cullEnabled, FALSE,                 " - box test every object in view instead of culling the render list in one pass first"),
 #ifdef HW_BUILD_FOR_DEBUGGING
     entryFV("/logFileLoads",        EnableFileLoadLog,LogFileLoads,TRUE," - create log of data files loaded"),
 #endif
@@ -672,6 +715,8 @@ commandoption commandOptions[] =
     entryVr("/dsoundCoop",          coopDSound, TRUE,                   " - switches to co-operative mode of DirectSound (if supported) to allow sharing with other applications."),
     entryVr("/waveout",             useWaveout, TRUE,                   " - forces mixer to write to Waveout even if a DirectSound supported object is available."),
     entryVr("/reverseStereo",       reverseStereo, TRUE,                " - swap the left and right audio channels."),
+    entryVr("/noMixThread",         mixThreadEnabled, FALSE,            " - mix sound in the audio callback instead of ahead on a thread of its own."),
+    entryVr("/noMixCache",          mixCacheEnabled, FALSE,             " - decode short sound effects every time they play instead of keeping them."),
 
     entryComment("DETAIL OPTIONS"), //-----------------------------------------------------
     entryFn("/rasterSkip",          EnableRasterSkip,                   " - enable interlaced display with software renderer."),
@@ -827,10 +872,42 @@ commandoption commandOptions[] =
 #ifdef HW_BUILD_FOR_DEBUGGING
     entryFV("/packetRecord",        EnablePacketRecord, recordPackets, TRUE, " - record packets of this multiplayer game"),
     entryFV("/packetPlay",          EnablePacketPlay, playPackets, TRUE," <fileName> - play back packet recording"),
+    entryFnParam("/simBench",       simBenchFileSet,                    " <fileName> - replay packet recording headless as fast as possible and report timings"),
+    entryFnParam("/simBenchFrames", simBenchFramesSet,                  " <n> - stop the simulation benchmark after [n] universe updates"),
+    entryFnParam("/simBenchCompare", simBenchCompareSet,                " <fileName> - check each frame's checksums against an earlier run's, e.g. one with /noJobs, and fail on the first difference"),
+    entryFn("/loadBench",           loadBenchSet,                       " - load every single player mission headless and report load stage timings"),
+    entryFn("/effectBench",         effectBenchSet,                     " - run every loaded effect script headless and report effect updates per second"),
+    entryFnParam("/particleBench",  partBenchSet,                       " <n> - update [n] particle systems headless and report the cost per particle"),
+    entryFnParam("/blobBench",      blobBenchSet,                       " <n> - add [n] asteroids to a mission headless and time rebuilding the collision blobs"),
+    entryFnParam("/spaceBench",     spaceBenchSet,                      " <n> - time [n] spatial queries of each kind headless at 1000, 5000 and 10000 asteroids"),
+    entryFnParam("/queueBench",     queueBenchSet,                      " <n> - push [n] packets between two threads through a packet queue headless and check them"),
+    entryFnParam("/meshBench",      meshBenchSet,                       " <n> - draw every ship mesh in a mission [n] times in immediate mode and from retained arrays and count the GL calls"),
+    entryFnParam("/mixBench",       mixBenchSet,                        " <n> - mix [n] blocks of sound headless at each voice count and report how many voices fit in real time"),
+    entryFnParam("/aiBench",        aiBenchSet,                         " <n> - run [n] universe updates of a 7 computer player skirmish headless and time the computer players"),
+    entryFnParam("/aiBenchMap",     aiBenchMapSet,                      " <map> - play the computer player benchmark on [map] instead of the biggest map"),
+    entryFnParam("/aiBenchQuota",   aiBenchQuotaSet,                    " <n> - run the computer player benchmark with a work quota of [n] units a frame instead of the game's, 0 for no limit"),
+    entryFnParam("/cullBench",      cullBenchSet,                       " <n> - cull a synthetic battle from [n] camera positions headless, batched and one box at a time, and check they agree"),
 #else
     entryFVHidden("/packetRecord",  EnablePacketRecord, recordPackets, TRUE, " - record packets of this multiplayer game"),
     entryFVHidden("/packetPlay",    EnablePacketPlay, playPackets, TRUE," <fileName> - play back packet recording"),
-#endif
+    entryFnParamHidden("/simBench", simBenchFileSet,                    " <fileName> - replay packet recording headless as fast as possible and report timings"),
+    entryFnParamHidden("/simBenchFrames", simBenchFramesSet,            " <n> - stop the simulation benchmark after [n] universe updates"),
+    entryFnParamHidden("/simBenchCompare", simBenchCompareSet,          " <fileName> - check each frame's checksums against an earlier run's, e.g. one with /noJobs, and fail on the first difference"),
+    entryFnHidden("/loadBench",     loadBenchSet,                       " - load every single player mission headless and report load stage timings"),
+    entryFnHidden("/effectBench",   effectBenchSet,                     " - run every loaded effect script headless and report effect updates per second"),
+    entryFnParamHidden("/particleBench", partBenchSet,                  " <n> - update [n] particle systems headless and report the cost per particle"),
+    entryFnParamHidden("/blobBench", blobBenchSet,                      " <n> - add [n] asteroids to a mission headless and time rebuilding the collision blobs"),
+    entryFnParamHidden("/spaceBench", spaceBenchSet,                    " <n> - time [n] spatial queries of each kind headless at 1000, 5000 and 10000 asteroids"),
+    entryFnParamHidden("/queueBench", queueBenchSet,                    " <n> - push [n] packets between two threads through a packet queue headless and check them"),
+    entryFnParamHidden("/meshBench", meshBenchSet,                      " <n> - draw every ship mesh in a mission [n] times in immediate mode and from retained arrays and count the GL calls"),
+    entryFnParamHidden("/mixBench", mixBenchSet,                        " <n> - mix [n] blocks of sound headless at each voice count and report how many voices fit in real time"),
+    entryFnParamHidden("/aiBench", aiBenchSet,                          " <n> - run [n] universe updates of a 7 computer player skirmish headless and time the computer players"),
+    entryFnParamHidden("/aiBenchMap", aiBenchMapSet,                    " <map> - play the computer player benchmark on [map] instead of the biggest map"),
+    entryFnParamHidden("/aiBenchQuota", aiBenchQuotaSet,                " <n> - run the computer player benchmark with a work quota of [n] units a frame instead of the game's, 0 for no limit"),
+    entryFnParamHidden("/cullBench", cullBenchSet,                      " <n> - cull a synthetic battle from [n] camera positions headless, batched and one box at a time, and check they agree"),
+#endif
+    entryFnParam("/profTrace",      profTraceSet,                       " <n> - capture [n] frames of timing scopes once a game starts and write a Chrome trace (ProfTrace.json)"),
+    entryFn("/profTraceBinary",     profTraceBinarySet,                 " - write the /profTrace capture in the compact binary format (ProfTrace.bin)"),
 
     //entryVr("/compareBigfiles",     CompareBigfiles, TRUE,              " - file by file, use most recent (bigfile/filesystem)"),
 #if DEM_AUTO_DEMO
@@ -2174,6 +2251,14 @@ int main (int argc, char* argv[])
         errorString = utyGameSystemsPreInit();
     }
 
+    //allocator benchmark only needs the memory module
+    if ((errorString == NULL) && (memTraceBenchFileName[0] != 0))
+    {
+        event_res = memTraceBench(memTraceBenchFileName);
+        (void)utyGameSystemsPreShutdown();
+        return event_res;
+    }
+
     //startup the game window
     if (errorString == NULL)
     {
@@ -2184,7 +2269,7 @@ int main (int argc, char* argv[])
         }
 #endif
         preInit = TRUE;
-        if (!InitWindow())
+        if ((!mainHeadless) && (!InitWindow()))
         {
             errorString = ersWindowInit;
         }
@@ -2204,7 +2289,11 @@ int main (int argc, char* argv[])
     if (errorString == NULL)
     {
 #ifndef HW_GAME_DEMO
-        if (enableAVI && fullScreen)
+        if (mainHeadless)
+        {
+            windowNeedsDeleting = FALSE;
+        }
+        else if (enableAVI && fullScreen)
         {
             windowNeedsDeleting = TRUE;
             //set display mode
@@ -2234,7 +2323,51 @@ int main (int argc, char* argv[])
         }
     }
 
-    if (errorString == NULL)
+    if ((errorString == NULL) && simBenchEnabled)
+    {
+        event_res = simBenchRun();
+    }
+    else if ((errorString == NULL) && loadBenchEnabled)
+    {
+        event_res = loadBenchRun();
+    }
+    else if ((errorString == NULL) && effectBenchEnabled)
+    {
+        event_res = effectBenchRun();
+    }
+    else if ((errorString == NULL) && partBenchEnabled)
+    {
+        event_res = partBenchRun();
+    }
+    else if ((errorString == NULL) && blobBenchEnabled)
+    {
+        event_res = blobBenchRun();
+    }
+    else if ((errorString == NULL) && spaceBenchEnabled)
+    {
+        event_res = spaceBenchRun();
+    }
+    else if ((errorString == NULL) && queueBenchEnabled)
+    {
+        event_res = queueBenchRun();
+    }
+    else if ((errorString == NULL) && meshBenchEnabled)
+    {
+        event_res = meshBenchRun();
+    }
+    else if ((errorString == NULL) && mixBenchEnabled)
+    {
+        event_res = mixBenchRun();
+    }
+    else if ((errorString == NULL) && aiBenchEnabled)
+    {
+        event_res = aiBenchRun();
+    }
+    else if ((errorString == NULL) && cullBenchEnabled)
+    {
+        event_res = cullBenchRun();
+    }
+    else if (errorString == NULL)
     {
         preInit = FALSE;
 
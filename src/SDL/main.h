@@ -126,6 +126,8 @@ extern char mainGLToSelect[];
 extern bool mainNoPerspective;
 extern bool systemActive;
 
+extern bool mainHeadless;
+
 /*=============================================================================
     Functions:
 =============================================================================*/
@@ -1,14 +0,0 @@
-#ifndef ___MIXFFT_H
-#define ___MIXFFT_H
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-void fft(long n,float *xRe,float *xIm,float *yRe,float *yIm);
-
-#ifdef __cplusplus
-}		// extern "C"
-#endif
-
-#endif
@@ -23,6 +23,7 @@
 #include "Clouds.h"
 #include "Collision.h"
 #include "CommandNetwork.h"
+#include "Cull.h"
 #include "Debug.h"
 #include "DefenseFighter.h"
 #include "Demo.h"
@@ -220,6 +221,9 @@ asteroid0data asteroid0Data[ASTEROID0DATA_SIZE];
 //frame counter
 udword rndFrameCount;
 
+//bumped every time a GL context is made, so buffer objects can tell they're stale
+udword rndGLContextSerial = 0;
+
 //frame rate data and definitions
 #if RND_FRAME_RATE
 #define RND_FrameRatePeriod         2.0f
@@ -1032,6 +1036,7 @@ bool setupPixelFormat()
     printf("GL Extensions:\n%s\n", gl_extensions);
 
     useVBO = glCheckExtension("GL_ARB_vertex_buffer_object");
+    rndGLContextSerial++;
 
 	return TRUE;
 }
@@ -1202,6 +1207,8 @@ sdword rndInit(rndinitdata *initData)
 void rndClose(void)
 {
     Uint32 flags = SDL_WasInit(SDL_INIT_EVERYTHING);
+
+    cullClose();
     if (!(flags & SDL_INIT_VIDEO))
         return;
     if (stararray) {
@@ -1542,6 +1549,53 @@ bool rndShipVisibleUsingCoordSys(SpaceObj* spaceobj, Camera* camera)
     return result;
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : rndShipVisibleCulled
+    Description : rndShipVisible, answered from the cull pass when it could
+                  tell for sure
+    Inputs      : spaceobj - the spaceobject to consider
+                  camera - current camera object
+                  cull - index of the object's cull results, or CULL_NoResult
+    Outputs     :
+    Return      : TRUE if ship is visible, else FALSE
+----------------------------------------------------------------------------*/
+static bool rndShipVisibleCulled(SpaceObj* spaceobj, Camera* camera, sdword cull)
+{
+    if (cull != CULL_NoResult)
+    {
+        switch (cullVerdictGet(cull))
+        {
+            case CULL_Outside:
+                return FALSE;
+            case CULL_Inside:
+                return TRUE;
+            default:
+                break;
+        }
+    }
+    return rndShipVisible(spaceobj, camera);
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : rndLevelGet
+    Description : lodLevelGet, using the distance from the cull pass if it
+                  has one
+    Inputs      : spaceobj - the object
+                  camera - current camera object
+                  cull - index of the object's cull results, or CULL_NoResult
+    Outputs     : updates the object's currentLOD and camera distance
+    Return      : lod structure for current level of detail
+----------------------------------------------------------------------------*/
+static lod *rndLevelGet(SpaceObj* spaceobj, Camera* camera, sdword cull)
+{
+    if (cull != CULL_NoResult)
+    {
+        spaceobj->cameraDistanceSquared = cullCameraDistanceGet(cull, &spaceobj->cameraDistanceVector);
+        return lodLevelGetAtDistance((void *)spaceobj);
+    }
+    return lodLevelGet((void *)spaceobj, &camera->eyeposition, &((SpaceObjRotImp *)spaceobj)->collInfo.collPosition);
+}
+
 /*-----------------------------------------------------------------------------
     Name        : rndFade
     Description : configures the rendering pipeline for fading ships out of existence
@@ -2338,8 +2392,10 @@ void rndMainViewRenderFunction(Camera *camera)
     extern sdword trailsRendered;
     sdword colorScheme;
     bool displayEffect = FALSE;
+    sdword cull;
 
     sdword asteroid0Count;
+    sdword minorIndex;
 
     real32 scaledOffset[3];
     static real32 cameraOffset[3] = {0.0f, 0.0f, 0.0f};
@@ -2517,11 +2573,15 @@ void rndMainViewRenderFunction(Camera *camera)
     trailsRendered = shipTrails = 0;
     alodSetPolys(0);
 
+    //frustum and LOD distances for the whole list in one go
+    cullRenderList(&rndCameraMatrix, &rndProjectionMatrix, &camera->eyeposition);
+
     objnode = universe.RenderList.head;
 
     while (objnode != NULL)
     {
         spaceobj = (SpaceObj *)listGetStructOfNode(objnode);
+        cull = cullResultFind(spaceobj);
 
         g_WireframeHack = FALSE;
         rndPerspectiveCorrection(FALSE);
@@ -2602,7 +2662,7 @@ dontdraw2:;
 #endif
 
                         glPushMatrix();
-                        level = lodLevelGet((void *)spaceobj, &camera->eyeposition, &((SpaceObjRotImp *)spaceobj)->collInfo.collPosition);
+                        level = rndLevelGet(spaceobj, camera, cull);
 
                         if (taskTimeElapsed-((Ship *)spaceobj)->flashtimer < FLASH_TIMER)
                         {
@@ -2704,7 +2764,7 @@ dontdraw2:;
                                     g_WireframeHack = (bool8)((((Ship *)spaceobj)->playerowner == universe.curPlayerPtr) || proximityCanPlayerSeeShip(universe.curPlayerPtr,((Ship *)spaceobj)));
                                 }
 
-                                if (rndShipVisible(spaceobj, camera))
+                                if (rndShipVisibleCulled(spaceobj, camera, cull))
                                 {
                                     bool result = rndFade(spaceobj, camera);
                                     Ship* ship = (Ship*)spaceobj;
@@ -2996,7 +3056,7 @@ dontdraw2:;
 #endif
 
                     glPushMatrix();
-                    level = lodLevelGet((void *)spaceobj, &camera->eyeposition, &((SpaceObjRotImp *)spaceobj)->collInfo.collPosition);
+                    level = rndLevelGet(spaceobj, camera, cull);
 
                     if (taskTimeElapsed-((Ship *)spaceobj)->flashtimer < FLASH_TIMER)
                     {
@@ -3051,7 +3111,7 @@ dontdraw2:;
                                 //fall through
 renderDefault:
                             default:
-                                if (rndShipVisible(spaceobj, camera))
+                                if (rndShipVisibleCulled(spaceobj, camera, cull))
                                 {
                                     rndFade(spaceobj, camera);
 
@@ -3146,11 +3206,18 @@ renderDefault:
 
     asteroid0Count = 0;
 
+    cullMinorRenderList(&rndCameraMatrix, &rndProjectionMatrix);
+
     objnode = universe.MinorRenderList.head;
-    while (objnode != NULL)
+    for (minorIndex = 0; objnode != NULL; minorIndex++, objnode = objnode->next)
     {
         spaceobj = (SpaceObj*)listGetStructOfNode(objnode);
 
+        if (!cullMinorVisible(minorIndex))
+        {
+            continue;
+        }
+
         switch (spaceobj->objtype)
         {
         case OBJ_AsteroidType:
@@ -3167,8 +3234,6 @@ renderDefault:
         default:
             dbgFatalf(DBG_Loc, "MinorRenderList contains invalid object type %d", spaceobj->objtype);
         }
-
-        objnode = objnode->next;
     }
     if (asteroid0Count != 0)
     {
@@ -3835,6 +3900,7 @@ void rndDrawScissorBars(bool scissorEnabled)
 DEFINE_TASK(rndRenderTask)
 {
     static sdword index;
+    static memframemark mark;
 #ifdef PROFILE_TIMERS
     static sdword y;
 #endif
@@ -3845,6 +3911,8 @@ DEFINE_TASK(rndRenderTask)
 
     while (1)
     {
+        mark = memFrameMark();
+
         primErrorMessagePrint();
 
         speechEventUpdate();
@@ -3894,7 +3962,9 @@ DEFINE_TASK(rndRenderTask)
         primErrorMessagePrint();
         //default rendering scheme is primitives on. any
         //functions which want it off should set it back on when done
+        PTSCOPE("regions");
         regFunctionsDraw();                                 //render all regions
+        PTSCOPEEND();
         primErrorMessagePrint();
         rndFrameCount++;                                    //update frame count
         //draw partial scissor window, if applicable
@@ -4022,7 +4092,9 @@ DEFINE_TASK(rndRenderTask)
             }
             else if (!feDontFlush)
             {
+                PTSCOPE("flush");
                 rndFlush();
+                PTSCOPEEND();
             }
             feDontFlush = FALSE;
         }
@@ -4033,6 +4105,7 @@ afterTheSwap:
         rndGLStateSaving = FALSE;                           //done saving the file for now
 #endif //RND_GL_STATE_DEBUG
         tutPointersDrawnThisFrame = FALSE;
+        memFrameReset(&mark);                               //release this frame's temporary allocations
         taskYield(0);                                       //hold off to next frame
     }
     taskEnd;
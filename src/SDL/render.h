@@ -95,6 +95,7 @@ typedef void (*renderfunction)(Camera *camera);
 =============================================================================*/
 extern rendercallback rndPreObjectCallback, rndPostObjectCallback;
 extern udword rndFrameCount;
+extern udword rndGLContextSerial;
 extern real32 rndAspectRatio;                                      //aspect ratio of rendering context
 extern bool8  rndFogOn;
 extern hmatrix rndCameraMatrix;
@@ -9,6 +9,7 @@
 =============================================================================*/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "fquant.h"
 #include "soundcmn.h"
@@ -19,6 +20,7 @@
 #include "FastMath.h"
 #include "main.h"
 #include "Globals.h"
+#include "ProfileTimers.h"
 
 #define MIX_BLOCK_SIZE			FQ_SIZE * sizeof(short) * 2 // 256 samples, 16-bit, stereo = 1024 bytes
 
@@ -32,15 +34,35 @@
 #define WO_MIX_BUFFER_AHEAD		(WO_NUM_BUFFER_BLOCKS * MIX_BLOCK_SIZE)
 #define WO_MIX_SLEEP			0L
 
+#define MIX_RING_BLOCKS			16		// blocks the mixer thread can render ahead into, power of 2
+#define MIX_RING_IDLE			50		// ms the mixer thread waits for room before applying commands anyway
+
+#define MIX_CACHE_PATCHES		32		// one-shot patches the decode cache keeps
+#define MIX_CACHE_BLOCKS		64		// longest patch it takes, approx 0.75 sec at 22kHz
+
 #define MIX_PANIC_THRES			22L // approx 4 fps - 1000/(11.60997732426*fps)
 #define MIX_PANIC_DUR			16L	// approx 4 seconds - dur*fps
 
 /* function prototypes */
 void isoundmixerthreadSDL(void *dummy);
 void isoundmixerqueueSDL();
-sdword isoundmixerprocess(void *pBuf1, udword nSize1, void *pBuf2, udword nSize2);
 sdword isoundmixerdecodeEffect(sbyte *readptr, real32 *writeptr1, real32 *writeptr2, ubyte *exponent, sdword size, uword bitrate, EFFECT *effect);
 #define isoundmixerdecode(a, b, c, d, e, f)		isoundmixerdecodeEffect(a, b, c, d, e, f, NULL);
+static sdword isoundmixerdecodepatch(CHANNEL *pchan);
+static void isoundmixercacheflush(void);
+
+/* decoded blocks of a one-shot patch, as fqDequantBlock left them */
+typedef struct
+{
+	PATCH			*ppatch;
+	sbyte			*dataoffset;	// checked too, in case a patch gets reused
+	sdword			size;			// coefficients decoded per half block
+	udword			numblocks;
+	udword			numfilled;		// blocks decoded so far, from the start
+	udword			lastused;		// mixerticks
+	real32			*coefs;			// 2 * size per block
+	ubyte			*exponents;		// FQ_SIZE per block, the exponent state after it
+} DECODECACHE;
 
 /* variables */
 struct fake_wavehdr {
@@ -66,6 +88,26 @@ sdword dctsize = FQ_HSIZE;	// DCT block size
 
 sdword dctpanicmode = SOUND_MODE_NORM;	// DCT panic mode, normal by default
 
+bool mixThreadEnabled = TRUE;			// mix ahead on a thread of its own, off with /noMixThread
+udword mixUnderruns = 0;				// blocks the audio callback had to play silence for
+
+static SDL_Thread *mixThread = NULL;
+static SDL_threadID mixThreadID;
+static SDL_sem *mixFreeSem = NULL;		// blocks of the ring the mixer thread may fill
+static SDL_atomic_t mixBlocksReady;		// blocks of the ring filled and not yet played
+static SDL_atomic_t mixThreadQuit;
+static udword mixWriteBlock = 0;		// mixer thread only
+static udword mixReadBlock = 0;			// audio callback only
+static udword mixReadOffset = 0;
+static udword mixBlocksMixed = 0;
+static Uint8 mixRing[MIX_RING_BLOCKS * MIX_BLOCK_SIZE];
+
+bool mixCacheEnabled = TRUE;			// keep decoded one-shot patches around, off with /noMixCache
+udword mixCacheHits = 0;
+udword mixCacheMisses = 0;
+
+static DECODECACHE mixCache[MIX_CACHE_PATCHES];	// mixer only
+
 real32 timebufferL[FQ_DSIZE], timebufferR[FQ_DSIZE], temptimeL[FQ_DSIZE], temptimeR[FQ_DSIZE];
 real32 mixbuffer1L[FQ_SIZE], mixbuffer1R[FQ_SIZE], mixbuffer2L[FQ_SIZE], mixbuffer2R[FQ_SIZE];
 
@@ -115,6 +157,23 @@ void soundMixerGetMode(sdword *mode)	// mode SOUND_MODE_NORM or SOUND_MODE_AUTO
 }
 
 void soundMixerSetMode(sdword mode)		// mode SOUND_MODE_NORM or SOUND_MODE_AUTO or SOUND_MODE_LOW
+{
+	SOUNDCOMMAND command;
+
+	if (isoundmixerdirect())
+	{
+		isoundmixersetmode(mode);
+		return;
+	}
+
+	// the block size can't change under the mixer thread
+	command.command = SND_CMD_MIXMODE;
+	command.handle = SOUND_DEFAULT;
+	command.param[0] = mode;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+}
+
+void isoundmixersetmode(sdword mode)
 {
 #ifndef _MACOSX_FIX_SOUND
 
@@ -222,6 +281,31 @@ sdword isoundmixerinit(SDL_AudioSpec *aspec)
 void isoundmixerrestore(void)
 {
 	mixer.timeout = 0;
+
+	if (mixThread != NULL)
+	{
+		SDL_AtomicSet(&mixThreadQuit, 1);
+		SDL_SemPost(mixFreeSem);
+		SDL_WaitThread(mixThread, NULL);
+
+		// make sure the callback isn't reading the ring
+		SDL_LockAudio();
+		mixThread = NULL;
+		SDL_UnlockAudio();
+
+		SDL_DestroySemaphore(mixFreeSem);
+		mixFreeSem = NULL;
+
+		// anything posted since is for this thread to do now
+		SNDcommandsapply();
+
+		dbgMessagef("Mixer thread mixed %u blocks ahead, %u underruns", mixBlocksMixed, mixUnderruns);
+	}
+
+	// the banks go after this
+	SDL_LockAudio();
+	isoundmixercacheflush();
+	SDL_UnlockAudio();
 }
 
 
@@ -644,8 +728,7 @@ sdword isoundmixerprocess(void *pBuf1, udword nSize1, void *pBuf2, udword nSize2
 			}
 
 
-			amountread = isoundmixerdecode(pchan->currentpos, pchan->mixbuffer1, pchan->mixbuffer2, pchan->exponentblockL,
-							pchan->fqsize, pchan->ppatch->bitrate);
+			amountread = isoundmixerdecodepatch(pchan);
 			pchan->currentpos += amountread;
 
 			if (pchan->looping)
@@ -749,10 +832,8 @@ sdword isoundmixerprocess(void *pBuf1, udword nSize1, void *pBuf2, udword nSize2
 
 			if (!pchan->mute)
 			{
-				fqMix(mixbuffer1L,pchan->mixbuffer1,pchan->volfactorL);
-				fqMix(mixbuffer2L,pchan->mixbuffer2,pchan->volfactorL);
-				fqMix(mixbuffer1R,pchan->mixbuffer1,pchan->volfactorR);
-				fqMix(mixbuffer2R,pchan->mixbuffer2,pchan->volfactorR);
+				fqMixStereo(mixbuffer1L,mixbuffer1R,pchan->mixbuffer1,pchan->volfactorL,pchan->volfactorR);
+				fqMixStereo(mixbuffer2L,mixbuffer2R,pchan->mixbuffer2,pchan->volfactorL,pchan->volfactorR);
 			}
 		}
 		
@@ -817,6 +898,176 @@ sdword isoundmixerdecodeEffect(sbyte *readptr, real32 *writeptr1, real32 *writep
 #endif 
 }
 
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixercacheflush
+	Description	: Frees the decode cache.  The mixer mustn't be running.
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+static void isoundmixercacheflush(void)
+{
+	sdword i;
+
+	for (i = 0; i < MIX_CACHE_PATCHES; i++)
+	{
+		free(mixCache[i].coefs);
+		free(mixCache[i].exponents);
+	}
+	memset(mixCache, 0, sizeof(mixCache));
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixercacheslot
+	Description	: Finds the decode cache entry for a one-shot patch that's
+					starting to play, setting up a new one in the place of
+					the least recently used if it hasn't got one.  Looping
+					patches aren't cached: after the first time round their
+					exponent state depends on where the loop came from.
+	Inputs		: pchan - channel at the start of its patch
+					size - coefficients it decodes per half block
+	Outputs		:
+	Return		: the entry, or SOUND_DEFAULT if the patch isn't cached
+----------------------------------------------------------------------------*/	
+static sdword isoundmixercacheslot(CHANNEL *pchan, sdword size)
+{
+	PATCH *ppatch = pchan->ppatch;
+	DECODECACHE *pcache;
+	udword numblocks, blockbytes = ppatch->bitrate >> 3;
+	sdword i, slot = 0;
+
+	if (!mixCacheEnabled || pchan->looping || (blockbytes == 0))
+	{
+		return (SOUND_DEFAULT);
+	}
+
+	numblocks = (ppatch->datasize - ppatch->dataoffset + blockbytes - 1) / blockbytes;
+	if ((numblocks == 0) || (numblocks > MIX_CACHE_BLOCKS))
+	{
+		return (SOUND_DEFAULT);
+	}
+
+	for (i = 0; i < MIX_CACHE_PATCHES; i++)
+	{
+		pcache = &mixCache[i];
+		if ((pcache->ppatch == ppatch) && (pcache->dataoffset == (sbyte *)ppatch->dataoffset))
+		{
+			if (pcache->size == size)
+			{
+				pcache->lastused = mixerticks;
+				return (i);
+			}
+			// panic mode changed the block size, so start it again
+			slot = i;
+			break;
+		}
+		if (pcache->lastused < mixCache[slot].lastused)
+		{
+			slot = i;
+		}
+	}
+
+	pcache = &mixCache[slot];
+	free(pcache->coefs);
+	free(pcache->exponents);
+	memset(pcache, 0, sizeof(DECODECACHE));
+
+	// this can be the mixer thread, so not from the memory module
+	pcache->coefs = malloc(numblocks * 2 * size * sizeof(real32));
+	pcache->exponents = malloc(numblocks * FQ_SIZE);
+	if ((pcache->coefs == NULL) || (pcache->exponents == NULL))
+	{
+		free(pcache->coefs);
+		free(pcache->exponents);
+		memset(pcache, 0, sizeof(DECODECACHE));
+		return (SOUND_DEFAULT);
+	}
+
+	pcache->ppatch = ppatch;
+	pcache->dataoffset = (sbyte *)ppatch->dataoffset;
+	pcache->size = size;
+	pcache->numblocks = numblocks;
+	pcache->lastused = mixerticks;
+
+	return (slot);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixerdecodepatch
+	Description	: Decodes the next block of an SFX channel.  Blocks of short
+					one-shot patches are kept the first time they're decoded,
+					so the gunfire and explosions that get played over and
+					over only get copied after that.  The exponent state is
+					kept with each block, so a channel can go back to
+					decoding at any point.
+	Inputs		: pchan - channel to decode
+	Outputs		: pchan->mixbuffer1, mixbuffer2 and exponentblockL
+	Return		: bytes of patch data used
+----------------------------------------------------------------------------*/	
+static sdword isoundmixerdecodepatch(CHANNEL *pchan)
+{
+	PATCH *ppatch = pchan->ppatch;
+	DECODECACHE *pcache;
+	real32 *coefs;
+	udword block, blockbytes = ppatch->bitrate >> 3;
+	sdword size = (pchan->fqsize > dctsize) ? dctsize : pchan->fqsize;
+	sdword amountread;
+
+	if (pchan->currentpos == (sbyte *)ppatch->dataoffset)
+	{
+		pchan->cacheslot = isoundmixercacheslot(pchan, size);
+	}
+
+	if (pchan->cacheslot == SOUND_DEFAULT)
+	{
+		return (isoundmixerdecodeEffect(pchan->currentpos, pchan->mixbuffer1, pchan->mixbuffer2, pchan->exponentblockL,
+						pchan->fqsize, ppatch->bitrate, NULL));
+	}
+
+	pcache = &mixCache[pchan->cacheslot];
+	block = (pchan->currentpos - (sbyte *)ppatch->dataoffset) / blockbytes;
+
+	if ((pcache->ppatch != ppatch) || (pcache->size != size) || (block >= pcache->numblocks))
+	{
+		// the entry has gone to another patch or block size since
+		pchan->cacheslot = SOUND_DEFAULT;
+		return (isoundmixerdecodeEffect(pchan->currentpos, pchan->mixbuffer1, pchan->mixbuffer2, pchan->exponentblockL,
+						pchan->fqsize, ppatch->bitrate, NULL));
+	}
+
+	coefs = &pcache->coefs[block * 2 * size];
+
+	if (block < pcache->numfilled)
+	{
+		memcpy(pchan->mixbuffer1, coefs, size * sizeof(real32));
+		memset(&pchan->mixbuffer1[size], 0, (FQ_SIZE - size) * sizeof(real32));
+		memcpy(pchan->mixbuffer2, &coefs[size], size * sizeof(real32));
+		memset(&pchan->mixbuffer2[size], 0, (FQ_SIZE - size) * sizeof(real32));
+		memcpy(pchan->exponentblockL, &pcache->exponents[block * FQ_SIZE], FQ_SIZE);
+		pcache->lastused = mixerticks;
+		mixCacheHits++;
+		return (blockbytes);
+	}
+
+	amountread = isoundmixerdecode(pchan->currentpos, pchan->mixbuffer1, pchan->mixbuffer2, pchan->exponentblockL,
+					pchan->fqsize, ppatch->bitrate);
+	mixCacheMisses++;
+
+	// a channel that's caught up with the decoded blocks adds the next one
+	if (block == pcache->numfilled)
+	{
+		memcpy(coefs, pchan->mixbuffer1, size * sizeof(real32));
+		memcpy(&coefs[size], pchan->mixbuffer2, size * sizeof(real32));
+		memcpy(&pcache->exponents[block * FQ_SIZE], pchan->exponentblockL, FQ_SIZE);
+		pcache->numfilled++;
+	}
+
+	return (amountread);
+}
+
+
 /*-----------------------------------------------------------------------------
 	Name		:
 	Description	:
@@ -878,7 +1129,15 @@ void isoundmixerqueueSDL(Uint8 *stream, int len)
 #endif
 }
 
-void soundfeedercb(void *userdata, Uint8 *stream, int len)
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixerfeed
+	Description	: Mixes sound into a buffer and steps the mixer through
+					starting, fading out and stopping.
+	Inputs		: stream, len - buffer to fill
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+static void isoundmixerfeed(Uint8 *stream, int len)
 {
 	memset(stream, 0, len);
 	if (mixer.status >= SOUND_PLAYING) {
@@ -912,3 +1171,161 @@ void soundfeedercb(void *userdata, Uint8 *stream, int len)
 		SDL_PauseAudio(TRUE);
 	}
 }
+
+
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixerthread
+	Description	: Mixes blocks into the ring ahead of the audio callback,
+					making the changes queued for the channels before each
+					one.  While the device is paused the ring stays full and
+					this just keeps the command queue drained.
+	Inputs		:
+	Outputs		:
+	Return		: 0
+----------------------------------------------------------------------------*/	
+static int isoundmixerthread(void *data)
+{
+	Uint8 *block;
+
+	(void)data;
+	profTraceThreadName("mixer");
+
+	while (!SDL_AtomicGet(&mixThreadQuit))
+	{
+		if (SDL_SemWaitTimeout(mixFreeSem, MIX_RING_IDLE) != 0)
+		{
+			SNDcommandsapply();
+			continue;
+		}
+		if (SDL_AtomicGet(&mixThreadQuit))
+		{
+			break;
+		}
+
+		PTSCOPE("mixer");
+		SNDcommandsapply();
+
+		block = &mixRing[(mixWriteBlock & (MIX_RING_BLOCKS - 1)) * MIX_BLOCK_SIZE];
+		isoundmixerfeed(block, MIX_BLOCK_SIZE);
+		mixWriteBlock++;
+		mixBlocksMixed++;
+
+		// hands the block to the callback
+		SDL_AtomicAdd(&mixBlocksReady, 1);
+		PTSCOPEEND();
+	}
+
+	profTraceThreadRelease();
+	return 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixerstart
+	Description	: Starts the mixer thread.  It keeps about two callbacks'
+					worth of blocks mixed ahead.
+	Inputs		: aspec - the audio format SDL opened the device with
+	Outputs		:
+	Return		: SOUND_OK if the thread is running, SOUND_ERR if mixing is
+					left to the audio callback
+----------------------------------------------------------------------------*/	
+sdword isoundmixerstart(SDL_AudioSpec *aspec)
+{
+	udword ahead;
+
+	if (!mixThreadEnabled)
+	{
+		return (SOUND_ERR);
+	}
+
+	ahead = 2 * ((aspec->size + MIX_BLOCK_SIZE - 1) / MIX_BLOCK_SIZE);
+	if (ahead > MIX_RING_BLOCKS)
+	{
+		ahead = MIX_RING_BLOCKS;
+	}
+
+	mixWriteBlock = mixReadBlock = mixReadOffset = 0;
+	SDL_AtomicSet(&mixBlocksReady, 0);
+	SDL_AtomicSet(&mixThreadQuit, 0);
+
+	mixFreeSem = SDL_CreateSemaphore(ahead);
+	if (mixFreeSem == NULL)
+	{
+		return (SOUND_ERR);
+	}
+
+	mixThread = SDL_CreateThread(isoundmixerthread, "mixer", NULL);
+	if (mixThread == NULL)
+	{
+		dbgMessagef("Couldn't start the mixer thread: %s", SDL_GetError());
+		SDL_DestroySemaphore(mixFreeSem);
+		mixFreeSem = NULL;
+		return (SOUND_ERR);
+	}
+	mixThreadID = SDL_GetThreadID(mixThread);
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: isoundmixerdirect
+	Description	: Tells the caller whether it may change the channels itself
+					or has to post the change to the mixer thread.
+	Inputs		:
+	Outputs		:
+	Return		: TRUE if there's no mixer thread or this is it
+----------------------------------------------------------------------------*/	
+bool isoundmixerdirect(void)
+{
+	return ((mixThread == NULL) || (SDL_ThreadID() == mixThreadID));
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: soundfeedercb
+	Description	: SDL audio callback.  Copies out the blocks the mixer thread
+					has mixed, or mixes them here if there's no thread.
+	Inputs		: stream, len - buffer to fill
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+void soundfeedercb(void *userdata, Uint8 *stream, int len)
+{
+	udword size;
+
+	if (mixThread == NULL)
+	{
+		isoundmixerfeed(stream, len);
+		return;
+	}
+
+	while (len > 0)
+	{
+		if (SDL_AtomicGet(&mixBlocksReady) == 0)
+		{
+			// the mixer thread fell behind
+			memset(stream, 0, len);
+			mixUnderruns++;
+			return;
+		}
+
+		size = MIX_BLOCK_SIZE - mixReadOffset;
+		if (size > (udword)len)
+		{
+			size = len;
+		}
+		memcpy(stream, &mixRing[(mixReadBlock & (MIX_RING_BLOCKS - 1)) * MIX_BLOCK_SIZE + mixReadOffset], size);
+		stream += size;
+		len -= size;
+		mixReadOffset += size;
+
+		if (mixReadOffset == MIX_BLOCK_SIZE)
+		{
+			mixReadOffset = 0;
+			mixReadBlock++;
+			SDL_AtomicAdd(&mixBlocksReady, -1);
+			SDL_SemPost(mixFreeSem);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #ifndef ___SOUNDCMN_H
 #define ___SOUNDCMN_H
 
+#include <stddef.h>
 #include <SDL.h>
 
 #include "File.h"
@@ -10,6 +11,17 @@
 
 #define NUM_FADE_BLOCKS		20
 
+#define SOUND_COMMAND_QUEUE_SIZE	4096	// first segment of the mixer command queue
+
+/* channel changes posted to the mixer thread */
+#define SND_CMD_STOP		0
+#define SND_CMD_VOLUME		1
+#define SND_CMD_PAN			2
+#define SND_CMD_FREQUENCY	3
+#define SND_CMD_HEADING		4
+#define SND_CMD_MIXMODE		5
+#define SND_CMD_EQUALIZE	6
+
 #define DELAY_BUF_SIZE		(18 * FQ_SIZE) // approx 200 msec delay buffer
 #define SND_BLOCK_TIME      ((float)FQ_SLICE / 1000.0F) // approx 11.6 msec (in secs)
 
@@ -90,6 +102,7 @@ typedef struct
 	sdword			looping;
 
 	sdword			numchannels;	//new
+	sdword			cacheslot;		//mixer decode cache entry, SOUND_DEFAULT for none
 
 	sbyte			*freqdata;
 	sbyte			*currentpos;
@@ -220,9 +233,24 @@ typedef struct
 	udword timeout;
 } SOUNDCOMPONENT;
 
+typedef struct
+{
+	sdword			command;	/* SND_CMD_... */
+	sdword			handle;
+	sdword			param[3];	/* volume, pan, heading, bands or mixer mode */
+	real32			fparam[2];	/* fade time, frequency or doppler factors */
+	real32			eq[SOUND_EQ_SIZE];	/* only posted with SND_CMD_EQUALIZE */
+} SOUNDCOMMAND;
+
+#define SOUND_COMMAND_SIZE		((udword)offsetof(SOUNDCOMMAND, eq))
+
 /* functions */
 sdword isoundmixerinit(SDL_AudioSpec *aspec);
+sdword isoundmixerstart(SDL_AudioSpec *aspec);
 void isoundmixerrestore(void);
+sdword isoundmixerprocess(void *pBuf1, udword nSize1, void *pBuf2, udword nSize2);
+bool isoundmixerdirect(void);
+void isoundmixersetmode(sdword mode);
 int isoundstreamupdate(void *dummy);
 
 sdword SNDreleasebuffer(CHANNEL *pchan);
@@ -230,6 +258,8 @@ sdword SNDchannel(sdword handle);
 void SNDcalcvolpan(CHANNEL *pchan);
 
 sdword SNDcreatehandle(sdword channel);
+void SNDcommandpost(SOUNDCOMMAND *pcommand, udword size);
+void SNDcommandsapply(void);
 PATCH *SNDgetpatch(void *bankaddress, sdword patnum);
 
 sdword smixCreateDSoundBuffer(SDLWAVEFORMAT *pcmwf);
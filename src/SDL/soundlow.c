@@ -13,6 +13,7 @@
 #include "Debug.h"
 #include "soundlow.h"
 #include "File.h"
+#include "Queue.h"
 #include "soundcmn.h"
 #include "main.h"
 
@@ -37,6 +38,12 @@ void musicEventUpdateVolume(void);
 
 /* internal functions */
 sdword SNDgetchannel(sword patchnum, sdword priority);
+static sdword SNDstop(sdword handle, real32 fadetime);
+static sdword SNDvolume(sdword handle, sword vol, real32 fadetime);
+static sdword SNDpan(sdword handle, sword pan, real32 fadetime);
+static sdword SNDfrequency(sdword handle, real32 freq);
+static sdword SNDequalize(sdword handle, real32 *eq);
+static sdword SNDshipheading(sdword handle, sword heading, sdword highband, sdword lowband, real32 velfactor, real32 shipfactor);
 
 
 /* variables */
@@ -58,6 +65,10 @@ BANKPOINTERS bankpointers[4];
 SOUNDCOMPONENT	mixer;
 SOUNDCOMPONENT	streamer;
 
+/* channel changes for the mixer thread; the game and stream threads post
+   them under the queue lock, the mixer reads them without locking */
+static Queue soundcommands;
+
 sdword soundnumvoices=SOUND_DEF_VOICES;
 
 sdword soundvoicemode=SOUND_MODE_NORM;	// voice panic mode, normal by default
@@ -235,6 +246,8 @@ sdword soundinit(bool mode)
 	    dbgMessagef("Unable to init mixer subsystem");
 	    result = SOUND_ERR;
 	} else {
+	    InitQueue(&soundcommands, SOUND_COMMAND_QUEUE_SIZE);
+	    isoundmixerstart(&aspec);
 	    soundinited = TRUE;
 	    SDL_PauseAudio(FALSE);
 	    mixer.status = SOUND_PLAYING;
@@ -288,6 +301,8 @@ void soundrestore(void)
 
 	isoundmixerrestore();
 
+	CloseQueue(&soundcommands);
+
 	return;
 }
 
@@ -644,17 +659,12 @@ sdword soundplayFPRVL(sword patnum, real32 freq, sword pan, sdword priority, swo
 	Outputs		:
 	Return		:
 ----------------------------------------------------------------------------*/
-sdword soundstop(sdword handle, real32 fadetime)
+static sdword SNDstop(sdword handle, real32 fadetime)
 {
 	CHANNEL *pchan;
 	sdword channel;
 	sdword fadeblocks = 0;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
 	channel = SNDchannel(handle);
 
 	if (channel < SOUND_OK)
@@ -751,34 +761,19 @@ sdword soundrestart(sdword handle)
 
 
 /*-----------------------------------------------------------------------------
-	Name		: soundvolume
-	Description	:
+	Name		: SNDvolume
+	Description	: Mixer side of soundvolumeF
 	Inputs		: handle - the handle to a sound returned by soundplay
 				  vol - the volume to set this sound to (range of SOUND_MIN_VOL - SOUND_MAX_VOL)
 	Outputs		:
 	Return		: SOUND_OK if successful, SOUND_ERR on error
 ----------------------------------------------------------------------------*/	
-sdword soundvolumeF(sdword handle, sword vol, real32 fadetime)
+static sdword SNDvolume(sdword handle, sword vol, real32 fadetime)
 {
 	CHANNEL *pchan;
 	sdword channel;
 	sdword fadeblocks = 0;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
-	if (vol > SOUND_VOL_MAX)
-	{
-		vol = SOUND_VOL_MAX;
-	}
-	else if (vol <= SOUND_VOL_MIN)
-	{
-		soundstop(handle, TRUE);
-		return (SOUND_OK);
-	}
-
 	channel = SNDchannel(handle);
 
 	if (channel < SOUND_OK)
@@ -840,17 +835,12 @@ dbgAssertOrIgnore(pchan->volticksleft != 0);
 	Outputs		:
 	Return		:
 ----------------------------------------------------------------------------*/	
-sdword soundpanF(sdword handle, sword pan, real32 fadetime)
+static sdword SNDpan(sdword handle, sword pan, real32 fadetime)
 {
 	CHANNEL *pchan;
 	sdword channel;
 	sdword fadeblocks = 0;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
 	channel = SNDchannel(handle);
 
 	if (channel < SOUND_OK)
@@ -911,22 +901,17 @@ sdword soundpanF(sdword handle, sword pan, real32 fadetime)
 
 
 /*-----------------------------------------------------------------------------
-	Name		: soundfrequency
-	Description	:
+	Name		: SNDfrequency
+	Description	: Mixer side of soundfrequency
 	Inputs		:
 	Outputs		:
 	Return		:
 ----------------------------------------------------------------------------*/	
-sdword soundfrequency(sdword handle, real32 freq)
+static sdword SNDfrequency(sdword handle, real32 freq)
 {
 	CHANNEL *pchan;
 	sdword channel;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
 	channel = SNDchannel(handle);
 
 	if (channel < SOUND_OK)
@@ -965,28 +950,18 @@ sdword soundfrequency(sdword handle, real32 freq)
 
 
 /*-----------------------------------------------------------------------------
-	Name		: soundequalize
-	Description	:
+	Name		: SNDequalize
+	Description	: Mixer side of soundequalize
 	Inputs		: handle - the handle to a sound returned by soundplay
 				  eq - array[SOUND_EQ_SIZE] of floats range of 0.0 to 1.0
 	Outputs		:
 	Return		: SOUND_OK if successful, SOUND_ERR on error
 ----------------------------------------------------------------------------*/	
-sdword soundequalize(sdword handle, real32 *eq)
+static sdword SNDequalize(sdword handle, real32 *eq)
 {
 	CHANNEL *pchan;
 	sdword channel, i;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
-	if (eq == NULL)
-	{
-		return (SOUND_ERR);
-	}
-
 	channel = SNDchannel(handle);
 
 	if (channel < 0)
@@ -1020,7 +995,7 @@ sdword soundequalize(sdword handle, real32 *eq)
 	Outputs		:
 	Return		:
 ----------------------------------------------------------------------------*/	
-sdword soundshipheading(sdword handle, sword heading, sdword highband, sdword lowband, real32 velfactor, real32 shipfactor)
+static sdword SNDshipheading(sdword handle, sword heading, sdword highband, sdword lowband, real32 velfactor, real32 shipfactor)
 {
 	CHANNEL *pchan;
 	sdword channel;
@@ -1029,11 +1004,6 @@ sdword soundshipheading(sdword handle, sword heading, sdword highband, sdword lo
 	real32 diff;
 	sdword i;
 
-	if (!soundinited)
-	{
-		return (SOUND_ERR);
-	}
-	
 	channel = SNDchannel(handle);
 
 	if (channel < SOUND_OK)
@@ -1083,6 +1053,334 @@ sdword soundshipheading(sdword handle, sword heading, sdword highband, sdword lo
 
 
 
+/*-----------------------------------------------------------------------------
+	Name		: SNDcommandchannel
+	Description	: Checks a handle before a change to its channel is posted.
+					Like soundover it looks at the channel without stopping
+					the mixer, so the mixer checks the handle again.
+	Inputs		: handle - the handle to a sound returned by soundplay
+	Outputs		:
+	Return		: SOUND_OK if the handle is still current, SOUND_ERR if not
+----------------------------------------------------------------------------*/	
+static sdword SNDcommandchannel(sdword handle)
+{
+	sdword channel;
+
+	channel = SNDchannel(handle);
+
+	if ((channel < SOUND_OK) || (channels[channel].handle != handle))
+	{
+		return (SOUND_ERR);
+	}
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: SNDcommandpost
+	Description	: Queues a change for the mixer thread to make before it
+					mixes its next block.
+	Inputs		: pcommand - the change
+				  size - SOUND_COMMAND_SIZE, or sizeof(SOUNDCOMMAND) if it
+					carries an EQ
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+void SNDcommandpost(SOUNDCOMMAND *pcommand, udword size)
+{
+	LockQueue(&soundcommands);
+	HWEnqueue(&soundcommands, (ubyte *)pcommand, size);
+	UnLockQueue(&soundcommands);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: SNDcommandsapply
+	Description	: Makes all the queued changes.  Called by the mixer thread
+					only, it never waits on the producers.
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+void SNDcommandsapply(void)
+{
+	SOUNDCOMMAND *pcommand;
+	bool bApplied = FALSE;
+
+	while (HWDequeue(&soundcommands, (ubyte **)&pcommand) != 0)
+	{
+		switch (pcommand->command)
+		{
+			case SND_CMD_STOP:
+				SNDstop(pcommand->handle, pcommand->fparam[0]);
+				break;
+			case SND_CMD_VOLUME:
+				SNDvolume(pcommand->handle, (sword)pcommand->param[0], pcommand->fparam[0]);
+				break;
+			case SND_CMD_PAN:
+				SNDpan(pcommand->handle, (sword)pcommand->param[0], pcommand->fparam[0]);
+				break;
+			case SND_CMD_FREQUENCY:
+				SNDfrequency(pcommand->handle, pcommand->fparam[0]);
+				break;
+			case SND_CMD_EQUALIZE:
+				SNDequalize(pcommand->handle, pcommand->eq);
+				break;
+			case SND_CMD_HEADING:
+				SNDshipheading(pcommand->handle, (sword)pcommand->param[0], pcommand->param[1], pcommand->param[2],
+							   pcommand->fparam[0], pcommand->fparam[1]);
+				break;
+			case SND_CMD_MIXMODE:
+				isoundmixersetmode(pcommand->param[0]);
+				break;
+			default:
+				dbgAssertOrIgnore(FALSE);
+				break;
+		}
+		bApplied = TRUE;
+	}
+
+	if (bApplied)
+	{
+		HWDequeueDone(&soundcommands);
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		:
+	Description	:
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/
+sdword soundstop(sdword handle, real32 fadetime)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDstop(handle, fadetime));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_STOP;
+	command.handle = handle;
+	command.fparam[0] = fadetime;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: soundvolume
+	Description	:
+	Inputs		: handle - the handle to a sound returned by soundplay
+				  vol - the volume to set this sound to (range of SOUND_MIN_VOL - SOUND_MAX_VOL)
+	Outputs		:
+	Return		: SOUND_OK if successful, SOUND_ERR on error
+----------------------------------------------------------------------------*/	
+sdword soundvolumeF(sdword handle, sword vol, real32 fadetime)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+	
+	if (vol > SOUND_VOL_MAX)
+	{
+		vol = SOUND_VOL_MAX;
+	}
+	else if (vol <= SOUND_VOL_MIN)
+	{
+		soundstop(handle, TRUE);
+		return (SOUND_OK);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDvolume(handle, vol, fadetime));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_VOLUME;
+	command.handle = handle;
+	command.param[0] = vol;
+	command.fparam[0] = fadetime;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		:
+	Description	:
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+sdword soundpanF(sdword handle, sword pan, real32 fadetime)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDpan(handle, pan, fadetime));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_PAN;
+	command.handle = handle;
+	command.param[0] = pan;
+	command.fparam[0] = fadetime;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: soundfrequency
+	Description	:
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+sdword soundfrequency(sdword handle, real32 freq)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDfrequency(handle, freq));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_FREQUENCY;
+	command.handle = handle;
+	command.fparam[0] = freq;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		: soundequalize
+	Description	:
+	Inputs		: handle - the handle to a sound returned by soundplay
+				  eq - array[SOUND_EQ_SIZE] of floats range of 0.0 to 1.0
+	Outputs		:
+	Return		: SOUND_OK if successful, SOUND_ERR on error
+----------------------------------------------------------------------------*/	
+sdword soundequalize(sdword handle, real32 *eq)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+	
+	if (eq == NULL)
+	{
+		return (SOUND_ERR);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDequalize(handle, eq));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_EQUALIZE;
+	command.handle = handle;
+	memcpy(command.eq, eq, sizeof(command.eq));
+	SNDcommandpost(&command, sizeof(command));
+
+	return (SOUND_OK);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Name		:
+	Description	:
+	Inputs		:
+	Outputs		:
+	Return		:
+----------------------------------------------------------------------------*/	
+sdword soundshipheading(sdword handle, sword heading, sdword highband, sdword lowband, real32 velfactor, real32 shipfactor)
+{
+	SOUNDCOMMAND command;
+
+	if (!soundinited)
+	{
+		return (SOUND_ERR);
+	}
+
+	if (isoundmixerdirect())
+	{
+		return (SNDshipheading(handle, heading, highband, lowband, velfactor, shipfactor));
+	}
+
+	if (SNDcommandchannel(handle) != SOUND_OK)
+	{
+		return (SOUND_ERR);
+	}
+
+	command.command = SND_CMD_HEADING;
+	command.handle = handle;
+	command.param[0] = heading;
+	command.param[1] = highband;
+	command.param[2] = lowband;
+	command.fparam[0] = velfactor;
+	command.fparam[1] = shipfactor;
+	SNDcommandpost(&command, SOUND_COMMAND_SIZE);
+
+	return (SOUND_OK);
+}
+
+
 /*-----------------------------------------------------------------------------
 	Name		:
 	Description	:
@@ -1098,6 +1396,7 @@ sdword SNDresetchannel(CHANNEL *pchan)
 	pchan->priority = SOUND_PRIORITY_NORMAL;
 	pchan->handle = SOUND_DEFAULT;
 	pchan->numchannels = SOUND_MONO;
+	pchan->cacheslot = SOUND_DEFAULT;
 	pchan->volfactorL = 1.0f;
 	pchan->volfactorR = 1.0f;
 	
@@ -1416,13 +1715,14 @@ sdword splayFPRVL(void *bankaddress, sdword patnum, real32 *eq, real32 freq, swo
 		pchan->volume = vol;
 	}
 
-	soundvolume(handle, vol);
+	/* not playing yet, so these don't need to go through the mixer */
+	SNDvolume(handle, vol, 0);
 	
-	soundpan(handle, pan);
+	SNDpan(handle, pan, 0);
 
 	SNDcalcvolpan(pchan);
 
-	soundfrequency(handle, freq);
+	SNDfrequency(handle, freq);
 	
 // NEWLOOP
 	if (startatloop)
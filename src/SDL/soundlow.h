@@ -144,6 +144,12 @@ void soundGetVoiceLimits(sdword *min,sdword *max);
 void soundGetNumVoices(sdword *num,sdword *mode);	// mode SOUND_MODE_NORM or SOUND_MODE_AUTO
 void soundSetNumVoices(sdword num,sdword mode);		// mode SOUND_MODE_NORM or SOUND_MODE_AUTO
 
+// Mixer thread (mixer.c)
+extern bool mixThreadEnabled;
+extern bool mixCacheEnabled;
+extern udword mixCacheHits;
+extern udword mixCacheMisses;
+
 // DCT mode functions (mixer.c)
 void soundMixerGetMode(sdword *mode);	// mode SOUND_MODE_NORM or SOUND_MODE_AUTO or SOUND_MODE_LOW
 void soundMixerSetMode(sdword mode);	// mode SOUND_MODE_NORM or SOUND_MODE_AUTO or SOUND_MODE_LOW
@@ -25,6 +25,7 @@
 #include "main.h"
 #include "utility.h"
 #include "HorseRace.h"
+#include "Prefetch.h"
 
 #include "Universe.h"
 
@@ -150,7 +151,10 @@ void trStartup(void)
     trNoPalStartup();                                       //must come before trReset
     trReset();                                              //reset the newly-allocated texture registry
 
-    glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
+    if (!mainHeadless)
+    {
+        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
+    }
 }
 
 /*-----------------------------------------------------------------------------
@@ -1795,6 +1799,55 @@ void trBufferColorRGB(color *dest, color *source,
     }
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : trLIFFileNameCreate
+    Description : Creates the name of the .LiF file a registered texture is
+                    loaded from.
+    Inputs      : reg - texture to make the name of
+    Outputs     : fullName - where to put the name
+    Return      : void
+----------------------------------------------------------------------------*/
+static void trLIFFileNameCreate(texreg *reg, char *fullName)
+{
+    if (bitTest(reg->flags, TRF_SharedFileName))
+    {
+        strcpy(fullName, (char *)memchr(reg->fileName, 0, SWORD_Max) + 1);
+    }
+    else
+    {
+        strcpy(fullName, reg->fileName);
+    }
+    strcat(fullName, ".LiF");                               //create full filename
+}
+
+/*-----------------------------------------------------------------------------
+    Name        : trMeshSortListPrefetch
+    Description : Asks for the files trMeshSortListLoad will load for a mesh
+                    to be streamed in ahead of time.
+    Inputs      : sortList - which mesh to prefetch
+    Outputs     :
+    Return      : void
+----------------------------------------------------------------------------*/
+static void trMeshSortListPrefetch(trmeshsort *sortList)
+{
+    sdword index;
+    texreg *reg;
+    char fullName[PATH_MAX];
+
+    for (index = 0; index < sortList->nTextures; index++)
+    {
+        if (trPending(sortList->textureList[index]))
+        {
+            reg = &trTextureRegistry[sortList->textureList[index]];
+            if (reg->sharedFrom == TR_NotShared)
+            {
+                trLIFFileNameCreate(reg, fullName);
+                pfRequest(fullName, PF_LoadAlloc);
+            }
+        }
+    }
+}
+
 /*-----------------------------------------------------------------------------
     Name        : trMeshSortListLoad
     Description : Load a list of texture associated with a particular mesh.
@@ -1870,15 +1923,7 @@ void trMeshSortListLoad(trmeshsort *sortList)
                 continue;
             }
             //load in the image from pre-quantized .LiF file
-            if (bitTest(reg->flags, TRF_SharedFileName))
-            {
-                strcpy(fullName, (char *)memchr(reg->fileName, 0, SWORD_Max) + 1);
-            }
-            else
-            {
-                strcpy(fullName, reg->fileName);
-            }
-            strcat(fullName, ".LiF");                       //create full filename
+            trLIFFileNameCreate(reg, fullName);
             lifFile = trLIFFileLoad(fullName, 0);           //load in the file
 
             bitClear(reg->flags, TRF_TeamColor0);
@@ -2994,6 +3039,10 @@ void trRegistryRefresh(void)
         if (trMeshSortList[index].nTextures)
             texes++;
     }
+    for (index = 0; index < trMeshSortLength; index++)
+    {                                                       //start streaming the files in the order they'll be loaded
+        trMeshSortListPrefetch(&trMeshSortList[index]);
+    }
     HorseRaceBeginBar(TEXTURE2_BAR);  //texture barnumber = second parm
     for (index = 0; index < trMeshSortLength; index++)
     {                                                       //for each mesh-sort list
@@ -3037,6 +3086,47 @@ abortloading:
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+    Name        : trRegistryFilesRead
+    Description : Reads the image files of all pending textures in the
+                    registry, without creating any textures.  Used to time
+                    level loads when running headless.
+    Inputs      : void
+    Outputs     : textures remain pending
+    Return      : number of files read
+----------------------------------------------------------------------------*/
+sdword trRegistryFilesRead(void)
+{
+    sdword index, nRead = 0;
+    texreg *reg;
+    char fullName[PATH_MAX];
+    lifheader *lifFile;
+
+    for (index = 0; index <= trHighestAllocated; index++)
+    {
+        if (trAllocated(index) && trPending(index) && trTextureRegistry[index].sharedFrom == TR_NotShared)
+        {
+            trLIFFileNameCreate(&trTextureRegistry[index], fullName);
+            pfRequest(fullName, PF_LoadAlloc);
+        }
+    }
+    for (index = 0; index <= trHighestAllocated; index++)
+    {
+        reg = &trTextureRegistry[index];
+        if (trAllocated(index) && trPending(index) && reg->sharedFrom == TR_NotShared)
+        {
+            trLIFFileNameCreate(reg, fullName);
+            if (fileExists(fullName, 0))
+            {
+                lifFile = trLIFFileLoad(fullName, 0);
+                memFree(lifFile);
+                nRead++;
+            }
+        }
+    }
+    return nRead;
+}
+
 /*-----------------------------------------------------------------------------
     Name        : trClearCurrent
     Description : clear the current texture (assign it to an invalid handle)
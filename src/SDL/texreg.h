@@ -344,6 +344,8 @@ void trInternalTexturesDelete(trhandle handle);
 
 //'refresh' the texture registry which will load in all the textures requested.
 void trRegistryRefresh(void);
+//read the files trRegistryRefresh would load, without touching GL
+sdword trRegistryFilesRead(void);
 
 //'unregister' a texture handle, i.e. decrement it's usage count
 sdword trTextureUnregister(trhandle handle);
@@ -47,10 +47,12 @@
 #include "HorseRace.h"
 #include "HS.h"
 #include "InfoOverlay.h"
+#include "Jobs.h"
 #include "Key.h"
 #include "KeyBindings.h"
 #include "LaunchMgr.h"
 #include "LevelLoad.h"
+#include "LoadBench.h"
 #include "Light.h"
 #include "mainrgn.h"
 #include "Memory.h"
@@ -65,6 +67,8 @@
 #include "PiePlate.h"
 #include "Ping.h"
 #include "PlugScreen.h"
+#include "Prefetch.h"
+#include "ProfileTimers.h"
 #include "prim3d.h"
 #include "Randy.h"
 #include "regkey.h"
@@ -81,6 +85,7 @@
 #include "SinglePlayer.h"
 #include "SoundEvent.h"
 #include "SpaceObj.h"
+#include "StatCache.h"
 #include "Stats.h"
 #include "StatScript.h"
 #include "StringSupport.h"
@@ -1551,12 +1556,14 @@ void gameStart(char *loadfilename)
         utyTeaserEnd();
     }
 */
-    tbStartup();                                            //start the task bar
+    if (!mainHeadless)
+    {
+        tbStartup();                                        //start the task bar
+        utySet(SSA_TaskBar);
+    }
 
     wkTradeStuffActive = FALSE;
 
-    utySet(SSA_TaskBar);
-
     //reset deterministic build process
     cmDeterministicReset();
 
@@ -1763,11 +1770,14 @@ void gameStart(char *loadfilename)
             universeFlagEverythingNeeded();
     }
 
+    loadBenchStage(LB_PreInit);
+
     /* pause sound engine */
     soundEventPause(TRUE);
 
     //load in all the ships, register all the textures
     universeStaticInit();
+    loadBenchStage(LB_StaticInfo);
     if (hrAbortLoadingGame)
     {
         goto abortloading;
@@ -1958,6 +1968,7 @@ void gameStart(char *loadfilename)
     {
         soundEventPlayMusic(SongNumber);
     }
+    loadBenchStage(LB_LevelInit);
 
     if (etgHasBeenStarted)
     {                                                       //if effects already started
@@ -1974,6 +1985,12 @@ void gameStart(char *loadfilename)
     //clear out any persistent subtitles
     subReset();
     subTexturesReset();
+    loadBenchStage(LB_Effects);
+
+    if (mainHeadless)
+    {                                                       //no GL context to upload textures to
+        goto abortloading;
+    }
 
     trRegistryRefresh();                                    //refresh registry - load in all textures
     if (hrAbortLoadingGame)
@@ -1997,6 +2014,7 @@ void gameStart(char *loadfilename)
     }
 
 abortloading:
+    loadBenchStage(LB_Textures);
 
     if (hrAbortLoadingGame)
     {                                                       //if loading was aborted
@@ -2007,7 +2025,7 @@ abortloading:
 
     bobInitProperties();
 
-    if (!hrAbortLoadingGame)
+    if ((!hrAbortLoadingGame) && (!mainHeadless))
     {
         rndSetClearColor(universe.backgroundColor|0xff000000);
     }
@@ -2023,6 +2041,10 @@ abortloading:
     // reset any spurious joystick motion that's been recorded
     cameraJoystickReset();
 
+    //free anything streamed in but not used
+    pfFlush();
+    loadBenchStage(LB_Other);
+
     gameIsRunning = TRUE;
 }
 
@@ -2152,14 +2174,25 @@ void gameEnd(void)
     {
         autodownloadmapReset();
         KeepAliveReset();
+        LockQueue(&ProcessCmdPktQ);
         ResetQueue(&ProcessCmdPktQ);
+        UnLockQueue(&ProcessCmdPktQ);
+        LockQueue(&ProcessSyncPktQ);
         ResetQueue(&ProcessSyncPktQ);
+        UnLockQueue(&ProcessSyncPktQ);
+        LockQueue(&ProcessRequestedSyncPktQ);
         ResetQueue(&ProcessRequestedSyncPktQ);
+        UnLockQueue(&ProcessRequestedSyncPktQ);
+        LockQueue(&ProcessCaptaincyPktQ);
         ResetQueue(&ProcessCaptaincyPktQ);
+        UnLockQueue(&ProcessCaptaincyPktQ);
         ResetLastSyncPktsQ();
     }
 
-    rndSetClearColor(colBlack);
+    if (!mainHeadless)
+    {
+        rndSetClearColor(colBlack);
+    }
 
     trTextureDeleteAllUnregistered();
     mrReset();                                              //reset the state of the main viewport region
@@ -3831,6 +3864,9 @@ char* utyGameSystemsPreInit(void)
     utySet(SSA_MemoryModule);
 
     bigOpenAllBigFiles();
+    pfStartup();                                            //level load streaming threads
+    jobStartup();                                           //universe update worker threads
+    statCacheStartup();                                     //parsed scripts from the last run
 
 #if 0       // ShortCircuitWON done in titaninterface.cpp now
     if (ShortCircuitWON)
@@ -3980,8 +4016,11 @@ char *utyGameSystemsInit(void)
     utySet(SSA_Region);
 
     // initialize sound engine
-    soundEventInit();
-    utySet2(SS2_SoundEngine);
+    if (!mainHeadless)
+    {
+        soundEventInit();
+        utySet2(SS2_SoundEngine);
+    }
 
 #ifndef HW_GAME_DEMO
     /* Intro playing requires a window, which we have not made yet thanks to
@@ -4050,34 +4089,37 @@ DONE_INTROS:
 
     utilPlayingIntro = FALSE;
 
-    renderData.width = MAIN_WindowWidth;                    //setup data for
-    renderData.height = MAIN_WindowHeight;                  //initializing the
-    /*renderData.hWnd = ghMainWindow;*/                         //rendering system
-    renderData.hWnd = 0;                                    //rendering system
-    if (rndInit(&renderData) != OKAY)                       //startup the rendering system
+    if (!mainHeadless)
     {
-        //fallback to 640x480@16 rGL+sw, and fatally exit if that doesn't work either
-        mainRestoreSoftware();
-    }
+        renderData.width = MAIN_WindowWidth;                //setup data for
+        renderData.height = MAIN_WindowHeight;              //initializing the
+        /*renderData.hWnd = ghMainWindow;*/                     //rendering system
+        renderData.hWnd = 0;                                //rendering system
+        if (rndInit(&renderData) != OKAY)                   //startup the rendering system
+        {
+            //fallback to 640x480@16 rGL+sw, and fatally exit if that doesn't work either
+            mainRestoreSoftware();
+        }
 
-    if (mouseStartup() != OKAY)
-    {
-        return("Unable to start mouse.");
-    }
-    utySet(SSA_Mouse);
+        if (mouseStartup() != OKAY)
+        {
+            return("Unable to start mouse.");
+        }
+        utySet(SSA_Mouse);
 
-    //create a region for the main window
-    mrStartup();
-    utySet(SSA_MainRegion);
+        //create a region for the main window
+        mrStartup();
+        utySet(SSA_MainRegion);
 
-    // Startup the information overlay, must occur after mrStartup()
-    ioStartup();
-    utySet2(SS2_InfoOverlay);
+        // Startup the information overlay, must occur after mrStartup()
+        ioStartup();
+        utySet2(SS2_InfoOverlay);
 
-    utySet(SSA_Render);
-    lightStartup();
-    utySet(SSA_Lights);
-    utyRenderTask = taskStart(rndRenderTask, 1.0f, TF_OncePerFrame);
+        utySet(SSA_Render);
+        lightStartup();
+        utySet(SSA_Lights);
+        utyRenderTask = taskStart(rndRenderTask, 1.0f, TF_OncePerFrame);
+    }
     trStartup();
     utySet(SSA_TextureRegistry);
 
@@ -4116,18 +4158,21 @@ DONE_INTROS:
     //startup transformer module
     transStartup();
 
-    if (feStartup() != OKAY)
-    {                                                       //start the front end
-        return("Unable to start front end.");
-    }
-    utySet(SSA_FEFlow);
+    if (!mainHeadless)
+    {
+        if (feStartup() != OKAY)
+        {                                                   //start the front end
+            return("Unable to start front end.");
+        }
+        utySet(SSA_FEFlow);
 #if MAIN_MOUSE_FREE
-    utyClipMouse(startupClipMouse);                         //clip mouse to window if needed
+        utyClipMouse(startupClipMouse);                     //clip mouse to window if needed
 #endif
-    utySet(SSA_MouseClipped);
+        utySet(SSA_MouseClipped);
 
-    utyFrontEndDataLoad();
-    utySet(SSA_FrontEndData);
+        utyFrontEndDataLoad();
+        utySet(SSA_FrontEndData);
+    }
 
     tacticsStartUp();
 
@@ -4226,6 +4271,13 @@ DONE_INTROS:
     //clear out the task timer.  Make sure this is the last call in this function.
     utyTaskTimerClear();
 
+    if (mainHeadless)
+    {                                                       //no window, front end or sound to start
+        utySystemStarted = TRUE;
+        utySet(SS2_SystemStarted);
+        return(NULL);
+    }
+
 #if FEF_TEXTURES_DISABLABLE
     if (fetEnableTextures)
 #endif
@@ -4309,6 +4361,10 @@ char* utyGameSystemsPreShutdown(void)
         utyClear(SSA_FontReg);
     }
 
+    SaveGameWait();
+    statCacheShutdown();
+    jobShutdown();
+    pfShutdown();
     bigCloseAllBigFiles();
 
     keyClose();
@@ -4659,6 +4715,11 @@ char *utyGameSystemsShutdown(void)
     //shutdown transformer module
     transShutdown();
 
+    SaveGameWait();
+    statCacheShutdown();
+    jobShutdown();
+    pfShutdown();
+    profTraceClose();
     bigCloseAllBigFiles();
 
     keyClose();
@@ -136,6 +136,7 @@ void DDDFrigateDied(Ship *ship)
                 deleteme->whoKilledMe = ship->whoKilledMe;
                 univDeleteDeadShip(deleteme,EDT_AccumDamage);
                 listRemoveNode(&deleteme->shiplink);
+                univShipIndexDirty();
                 listRemoveNode(&deleteme->impactablelink);
 
 #if ETG_DISABLEABLE
@@ -166,6 +167,7 @@ void DDDFrigateSwitchSides(Ship *dddf,sdword player)
         if (ship != NULL)
         {
             ship->playerowner = &universe.players[player];
+            univShipIndexDirty();
             if (player)
                 ship->attributes |= ATTRIBUTES_Defector;
             else
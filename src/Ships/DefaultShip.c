@@ -153,6 +153,7 @@ void MiningBaseDied(Ship *ship)
             deleteme->whoKilledMe = ship->whoKilledMe;
             univDeleteDeadShip(deleteme,EDT_AccumDamage);
             listRemoveNode(&deleteme->shiplink);
+            univShipIndexDirty();
             listRemoveNode(&deleteme->impactablelink);
 
 #if ETG_DISABLEABLE
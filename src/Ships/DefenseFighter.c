@@ -133,7 +133,7 @@ void defensefightertargetbullet(Ship *ship, Bullet *bullettotarget)
 
     bitSet(bullettotarget->SpecialEffectFlag, 0x0002);   //set the flag
 
-    laser = memAlloc(sizeof(Bullet),"Bullet",0);
+    laser = memObjAlloc(&univBulletPool);     // freed with the other bullets, back into the pool
     memset(laser,0,sizeof(Bullet));      // for safety
 
     laser->objtype = OBJ_BulletType;
@@ -0,0 +1,254 @@
+//
+//  LZFast Compression Module
+//
+//  Byte-aligned LZ77 variant for bigfile contents.  It compresses a little
+//  worse than LZSS but decodes straight from memory several times faster:
+//  there's no bit-level IO and matches are copied a word at a time.
+//
+//  The compressor keeps all of its state on the stack/heap of the caller, so
+//  several files can be compressed at once from different threads.
+//
+//  Stream format, a sequence of:
+//      token       high nibble = literal count, low nibble = match length - LZF_MIN_MATCH
+//                  (a nibble of 15 is followed by extra bytes that are added to it,
+//                   continuing for as long as the byte read is 255)
+//      literals
+//      offset      2 bytes, little endian, distance back to the match (1..65535)
+//      match length extension bytes
+//  The last sequence has literals only and ends at the end of the input.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "LZFast.h"
+
+#define LZF_MIN_MATCH        4
+#define LZF_MAX_OFFSET       65535
+#define LZF_HASH_BITS        14
+#define LZF_HASH_SIZE        ( 1 << LZF_HASH_BITS )
+#define LZF_LAST_LITERALS    8      // the tail of the input is always stored as literals
+#define LZF_COPY_SLOP        8      // output needed past a match for word copies
+
+typedef unsigned char uchar;
+
+static unsigned int lzfRead32(const uchar *p)
+{
+    unsigned int value;
+
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static unsigned int lzfHash(const uchar *p)
+{
+    return (lzfRead32(p) * 2654435761u) >> (32 - LZF_HASH_BITS);
+}
+
+//
+//  Writes a length that didn't fit in its token nibble.
+//
+//  returns
+//      new output position, or NULL if it doesn't fit
+//
+static uchar *lzfLengthWrite(uchar *op, uchar *oend, int length)
+{
+    for ( ; length >= 255; length -= 255)
+    {
+        if (op >= oend)
+            return NULL;
+        *op++ = 255;
+    }
+    if (op >= oend)
+        return NULL;
+    *op++ = (uchar)length;
+    return op;
+}
+
+//
+//  Writes one sequence: the literals from anchor, then a match (if matchLength is nonzero).
+//
+//  returns
+//      new output position, or NULL if it doesn't fit
+//
+static uchar *lzfSequenceWrite(uchar *op, uchar *oend, const uchar *anchor, int literalLength, int offset, int matchLength)
+{
+    uchar *token;
+    int matchCode = matchLength ? matchLength - LZF_MIN_MATCH : 0;
+
+    if (op >= oend)
+        return NULL;
+    token = op++;
+    *token = (uchar)(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+    if (literalLength >= 15 && (op = lzfLengthWrite(op, oend, literalLength - 15)) == NULL)
+        return NULL;
+    if (oend - op < literalLength)
+        return NULL;
+    memcpy(op, anchor, literalLength);
+    op += literalLength;
+
+    if (matchLength)
+    {
+        if (oend - op < 2)
+            return NULL;
+        *op++ = (uchar)(offset & 0xff);
+        *op++ = (uchar)(offset >> 8);
+        if (matchCode >= 15 && (op = lzfLengthWrite(op, oend, matchCode - 15)) == NULL)
+            return NULL;
+    }
+    return op;
+}
+
+//
+//  Compresses a memory buffer to another memory buffer.
+//
+//  returns
+//      -1 if the output buffer is too small (i.e. the data doesn't compress) or memory ran out
+//      size of compressed data in output if successful
+//
+int lzfCompressBuffer(char *input, int inputSize, char *output, int outputSize)
+{
+    const uchar *in = (const uchar *)input;
+    const uchar *ip = in, *anchor = in, *ref;
+    const uchar *limit = in + inputSize - LZF_LAST_LITERALS;
+    uchar *op = (uchar *)output, *oend = op + outputSize;
+    int *hashTable;
+    unsigned int hash;
+    int refPosition, matchLength, step;
+
+    hashTable = malloc(LZF_HASH_SIZE * sizeof(int));
+    if (hashTable == NULL)
+        return -1;
+    memset(hashTable, 0xff, LZF_HASH_SIZE * sizeof(int));
+
+    while (inputSize >= LZF_LAST_LITERALS && ip + LZF_MIN_MATCH <= limit)
+    {
+        hash = lzfHash(ip);
+        refPosition = hashTable[hash];
+        hashTable[hash] = (int)(ip - in);
+        ref = in + refPosition;
+
+        if (refPosition < 0 || ip - ref > LZF_MAX_OFFSET || lzfRead32(ref) != lzfRead32(ip))
+        {
+            // skip ahead faster the longer we go without a match so
+            // incompressible data doesn't take forever
+            step = 1 + (int)((ip - anchor) >> 6);
+            ip += step;
+            continue;
+        }
+
+        matchLength = LZF_MIN_MATCH;
+        while (ip + matchLength < limit && ref[matchLength] == ip[matchLength])
+            matchLength++;
+
+        op = lzfSequenceWrite(op, oend, anchor, (int)(ip - anchor), (int)(ip - ref), matchLength);
+        if (op == NULL)
+        {
+            free(hashTable);
+            return -1;
+        }
+
+        ip += matchLength;
+        anchor = ip;
+        if (ip - 2 + LZF_MIN_MATCH <= limit)
+            hashTable[lzfHash(ip - 2)] = (int)(ip - 2 - in);
+    }
+
+    free(hashTable);
+
+    op = lzfSequenceWrite(op, oend, anchor, (int)(in + inputSize - anchor), 0, 0);
+    if (op == NULL)
+        return -1;
+    return (int)(op - (uchar *)output);
+}
+
+//
+//  Expands a memory buffer to another memory buffer.  Every read and write
+//  is checked against the buffer ends, so a damaged stream can't overrun.
+//
+//  returns
+//      -1 if the input is corrupt or doesn't fit in the output
+//      size of expanded data in output if successful
+//
+int lzfExpandBuffer(char *input, int inputSize, char *output, int outputSize)
+{
+    const uchar *ip = (const uchar *)input, *iend = ip + inputSize;
+    uchar *op = (uchar *)output, *oend = op + outputSize;
+    const uchar *match;
+    unsigned int token, extra, offset;
+    size_t length;
+
+    for ( ; ; )
+    {
+        if (ip >= iend)
+            return -1;
+        token = *ip++;
+
+        // literals
+        length = token >> 4;
+        if (length == 15)
+        {
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                extra = *ip++;
+                length += extra;
+            } while (extra == 255);
+        }
+        if (length > (size_t)(iend - ip) || length > (size_t)(oend - op))
+            return -1;
+        memcpy(op, ip, length);
+        op += length;
+        ip += length;
+
+        if (ip == iend)
+            break;      // the last sequence has no match
+
+        // match
+        if (iend - ip < 2)
+            return -1;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (unsigned int)(op - (uchar *)output))
+            return -1;
+
+        length = token & 15;
+        if (length == 15)
+        {
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                extra = *ip++;
+                length += extra;
+            } while (extra == 255);
+        }
+        length += LZF_MIN_MATCH;
+        if (length > (size_t)(oend - op))
+            return -1;
+
+        match = op - offset;
+        if (offset >= 8 && length + LZF_COPY_SLOP <= (size_t)(oend - op))
+        {
+            // whole words; may write up to 7 bytes past the match, which the
+            // following sequences overwrite
+            uchar *copyEnd = op + length;
+            do
+            {
+                memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+            } while (op < copyEnd);
+            op = copyEnd;
+        }
+        else
+        {
+            // overlapping (run-length style) or right at the end of the output
+            while (length--)
+                *op++ = *match++;
+        }
+    }
+
+    return (int)(op - (uchar *)output);
+}
@@ -0,0 +1,7 @@
+#ifndef ___LZFAST_H
+#define ___LZFAST_H
+
+int  lzfCompressBuffer(char *input, int inputSize, char *output, int outputSize);
+int  lzfExpandBuffer(char *input, int inputSize, char *output, int outputSize);
+
+#endif
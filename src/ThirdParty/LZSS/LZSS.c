@@ -62,9 +62,19 @@ char *Usage           = "in-file out-file\n\n";
  * in order.
 */
 
-unsigned char window[ WINDOW_SIZE ];
+/*
+ * Both are per-thread so the bigfile tools can compress several files at
+ * once.
+ */
+#ifdef _MSC_VER
+#define LZSS_THREAD_LOCAL __declspec(thread)
+#else
+#define LZSS_THREAD_LOCAL __thread
+#endif
 
-struct tree_s {
+static LZSS_THREAD_LOCAL unsigned char window[ WINDOW_SIZE ];
+
+static LZSS_THREAD_LOCAL struct tree_s {
     int parent;
     int smaller_child;
     int larger_child;
@@ -427,8 +437,12 @@ int lzssCompressBuffer(char *input, int inputSize, char *output, int outputSize)
 //      -1 if there was an error
 //      size of expanded data in output if successful
 //
+//  Uses its own window rather than the global one so the bigfile prefetch
+//  workers can expand several buffers at once.
+//
 int lzssExpandBuffer(char *input, int inputSize, char *output, int outputSize)
 {
+    unsigned char window[ WINDOW_SIZE ];
     int i;
     int current_position;
     int c;
@@ -38,7 +38,8 @@ void usage(void) {
 
     printf("\nAdditional options, as they apply to the primary options:\n");
     printf("         AFDUVX\n");
-    printf("-c[0|1]  **      Compress files               (default: 1)\n");
+    printf("-c[0|1|2] **     Compress files               (default: 1)\n");
+    printf("                 (0 none, 1 LZSS, 2 LZFast: faster loading, needs a current game)\n");
     printf("-m[0|1]  **   *  Move files to/from bigfile   (default: 0)\n");
     printf("-n[0|1]  *    *  Only newer files             (default: 0)\n");
     printf("-o[0|1]       *  Overwrite existing files     (default: 1)\n");
@@ -1,9 +1,10 @@
 #include <stdio.h>
+#include "../../src/Game/BigFile.h"
 #include "options.h"
 
 char OptCommand;	    // a|d|v|x (add|delete|view|extract)
 
-int  OptCompression;	// true/false
+int  OptCompression;	// BF_COMPRESSION_
 int  OptPathnames;      // true/false
 int  OptNewer;	        // true/false
 int  OptMove;           // true/false
@@ -11,7 +12,7 @@ int  OptOverwrite;		// true/false
 
 void optDefaultsSet(void) {
 	OptCommand     = 'a';
-	OptCompression = 1;
+	OptCompression = BF_COMPRESSION_LZSS;
 	OptMove        = 0;
 	OptNewer       = 0;
 	OptOverwrite   = 1;
@@ -39,7 +40,7 @@ int optProcessArgument(char *arg)
             break;
             
         case 'c':
-            optSetBoolean(arg, &OptCompression);
+            optSetCompression(arg, &OptCompression);
             break;
             
         case 'm':
@@ -79,3 +80,16 @@ void optSetBoolean(char *arg, int *option) {
         *option = 0;
     }
 }
+
+void optSetCompression(char *arg, int *option) {
+    // arg = "-c"<0|1|2>
+    char value = arg[2];
+
+    if (value >= '0' && value <= '0' + BF_COMPRESSION_MAX) {
+        *option = (int)(value - '0');
+    }
+    else {
+        printf("WARNING: Invalid option setting \"%s\"; using \"-c0\"\n", arg);
+        *option = 0;
+    }
+}
@@ -4,6 +4,7 @@
 void optDefaultsSet(void);
 int  optProcessArgument(char *arg);
 void optSetBoolean(char *arg, int *option);
+void optSetCompression(char *arg, int *option);
 
 #endif
 